@@ -0,0 +1,144 @@
+/**
+ * @file adc.h
+ * @brief ADC1-3 continuous scan into double-buffered DMA blocks
+ *
+ * Conversions are started by TIM8 update events at a rate derived from
+ * the 16 MHz timer clock, so samples are evenly spaced without CPU work.
+ * Each ADC writes through a circular DMA stream into a buffer of two
+ * blocks; the half-transfer and transfer-complete interrupts hand the
+ * finished block to the callback while the DMA fills the other one. The
+ * CPU never sees single samples.
+ *
+ * Independent mode scans up to 16 channels per trigger on one ADC;
+ * ADC1-3 can run side by side at the same rate. The dual and triple
+ * interleaved modes convert one channel on ADC1+2(+3) in turn, free
+ * running at up to 3 * ADCCLK / (sample time + 12), and deliver the
+ * samples in conversion order through ADC1's stream.
+ *
+ * DMA2 streams: ADC1 stream 4, ADC2 stream 2, ADC3 stream 1.
+ */
+
+#ifndef ADC_H
+#define ADC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ADCCLK is PCLK2 / 2 */
+#define ADC_CLOCK_HZ            8000000UL
+
+/* Regular sequence length */
+#define ADC_MAX_CHANNELS        16
+
+/* Internal channels, ADC1 only */
+#define ADC_CHANNEL_TEMP        16
+#define ADC_CHANNEL_VREFINT     17
+
+/* The temperature sensor needs at least 10 us of sampling */
+#define ADC_INTERNAL_SAMPLE     ADC_SAMPLE_112
+
+/* Largest buffer a DMA stream can cycle through, in samples */
+#define ADC_MAX_BUFFER          65534U
+
+/* Error codes */
+typedef enum {
+    ADC_OK = 0,
+    ADC_ERROR_PARAM,
+    ADC_ERROR_BUSY,         /* Unit running, or another unit runs at a different rate */
+    ADC_ERROR_RATE          /* A scan takes longer than the trigger period */
+} Adc_Error;
+
+typedef enum {
+    ADC_MODE_INDEPENDENT = 0,
+    ADC_MODE_DUAL_INTERLEAVED,
+    ADC_MODE_TRIPLE_INTERLEAVED
+} Adc_Mode;
+
+/* Sampling time in ADC clock cycles, SMPRx encoding */
+typedef enum {
+    ADC_SAMPLE_3 = 0,
+    ADC_SAMPLE_15,
+    ADC_SAMPLE_28,
+    ADC_SAMPLE_56,
+    ADC_SAMPLE_84,
+    ADC_SAMPLE_112,
+    ADC_SAMPLE_144,
+    ADC_SAMPLE_480
+} Adc_SampleTime;
+
+/**
+ * Called from the DMA interrupt with a finished block. The block is
+ * overwritten one block period later, so copy or reduce it before then.
+ * Samples are in scan order, one scan after the other.
+ */
+typedef void (*Adc_BlockCallback)(uint8_t unit, const uint16_t* samples, uint16_t count);
+
+typedef struct {
+    Adc_Mode mode;
+    uint8_t unit;                       /* 1-3, independent mode only */
+    uint8_t channels[ADC_MAX_CHANNELS]; /* Scan order; interleaved modes use channels[0] */
+    uint8_t channelCount;
+    Adc_SampleTime sampleTime;
+    uint32_t rateHz;                    /* Scans per second, independent mode */
+    uint16_t* buffer;                   /* 2 * blockSamples, SRAM (DMA2 cannot reach CCM) */
+    uint16_t blockSamples;              /* Samples per callback, whole scans (even when interleaved) */
+    Adc_BlockCallback callback;
+} Adc_Config;
+
+typedef struct {
+    uint32_t blocks;        /* Callbacks made */
+    uint32_t overruns;      /* ADC data lost before the DMA read it, restarted */
+    uint32_t dmaErrors;
+    uint32_t rateMilliHz;   /* Actual scan (or interleaved sample) rate */
+    bool running;
+} Adc_Stats;
+
+/**
+ * @brief Fill a config with an ADC1 scan of the temperature sensor and
+ *        VREFINT at 1 kHz
+ * @param config: Config to fill; buffer and callback are left NULL
+ * @return None
+ */
+void Adc_DefaultConfig(Adc_Config* config);
+
+/**
+ * @brief Configure the ADC(s), the DMA stream and the trigger, and start
+ *        converting. Interleaved modes take ADC1-3 as needed.
+ * @param config: Scan setup, copied
+ * @return ADC_OK, ADC_ERROR_PARAM, ADC_ERROR_BUSY or ADC_ERROR_RATE
+ */
+Adc_Error Adc_Start(const Adc_Config* config);
+
+/**
+ * @brief Stop a unit (1 for the interleaved modes). The trigger timer
+ *        stops with the last running unit.
+ * @param unit: 1-3
+ * @return None
+ */
+void Adc_Stop(uint8_t unit);
+
+/**
+ * @brief Read a unit's counters
+ * @param unit: 1-3
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Adc_GetStats(uint8_t unit, Adc_Stats* stats);
+
+/**
+ * @brief Analog supply from a VREFINT sample and its factory calibration
+ * @param vrefRaw: VREFINT conversion result
+ * @return VDDA in mV, 0 if vrefRaw is 0
+ */
+uint32_t Adc_VddaMillivolts(uint16_t vrefRaw);
+
+/**
+ * @brief Die temperature from a sensor sample, using the two factory
+ *        calibration points and VREFINT to correct for VDDA
+ * @param tempRaw: Temperature sensor conversion result
+ * @param vrefRaw: VREFINT result from the same scan
+ * @return Temperature in hundredths of a degree Celsius
+ */
+int32_t Adc_TemperatureCentiC(uint16_t tempRaw, uint16_t vrefRaw);
+
+#endif /* ADC_H */
@@ -0,0 +1,241 @@
+/**
+ * @file at.h
+ * @brief Non-blocking AT command engine for ESP8266/ESP32 Wi-Fi modules
+ *
+ * Commands wait in a queue and go out from At_Process, each with its own
+ * timeout and the final line that completes it ("OK" unless the request
+ * names another, e.g. "SEND OK"); "ERROR", "FAIL" and "SEND FAIL" always
+ * end a command. Lines in between ("+CIFSR:...", "STATUS:2") go to the
+ * command's onLine callback. A request marked pipelined may be sent while
+ * other pipelined commands are still waiting for their results, which the
+ * module returns in order; any other command waits until nothing is in
+ * flight and holds back the queue until it completes. When the module
+ * answers "busy p..." to pipelined commands it had no room for, they are
+ * sent again after the oldest one completes.
+ *
+ * Lines the module sends on its own (URCs: "ready", "WIFI CONNECTED",
+ * "WIFI GOT IP", "WIFI DISCONNECT", "<link>,CONNECT", "<link>,CLOSED")
+ * go to onUrc whenever they arrive, also between a command and its
+ * result. "+IPD,<link>,<length>:" payloads, binary and possibly holding
+ * CR/LF, bypass the line buffer: they are copied straight from the
+ * receive ring into a pbuf chain that onData takes over.
+ *
+ * A payload request (AT+CIPSEND) carries a pbuf chain, written from its
+ * segments at the module's '>' prompt.
+ *
+ * For bulk transfers a single connection (AT+CIPMUX=0, AT+CIPSTART) can be
+ * switched to transparent mode, where bytes pass through as they are with
+ * no AT+CIPSEND round trip per packet. At_StreamOpen queues AT+CIPMODE=1
+ * and AT+CIPSEND; from the module's '>' the engine stops parsing, the port
+ * switches to bulk transfers (DMA both ways on the target) and the data
+ * goes through At_StreamWrite/At_StreamPeek/At_StreamConsume. Queued
+ * commands wait. At_StreamClose escapes back to command mode: once output
+ * has drained and the line has been quiet for AT_ESCAPE_GUARD_MS, "+++"
+ * goes out alone, then after AT_ESCAPE_WAIT_MS the engine parses again and
+ * AT+CIPMODE=0 completes the close.
+ *
+ * Transparent throughput is bound by the line, 10 bits a byte. From the
+ * 16 MHz clock USART3 reaches 2 Mbaud with UART_OVERSAMPLING_8, 200 KB/s
+ * each way: switch the module with AT+UART_CUR=2000000,8,1,0,3, then
+ * UART_InitConfig with UART_HWCONTROL_RTS_CTS so neither side overruns
+ * the other.
+ *
+ * The engine reaches the module through an At_Port, so it runs on the
+ * UART driver's rings (at_uart_port) on the target and on a pseudo-
+ * terminal on the host (Sim/at_test_main.c against Tools/fake_esp.py).
+ * Callbacks run inside At_Process.
+ */
+
+#ifndef AT_H
+#define AT_H
+
+#include "pbuf.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AT_QUEUE_SIZE           8       /* Power of two */
+#define AT_PIPELINE_DEPTH       4       /* Pipelined commands in flight at once */
+#define AT_COMMAND_MAX          96      /* Command text, "\r\n" included */
+#define AT_LINE_MAX             128     /* Longer lines are cut */
+#define AT_MAX_LINKS            5       /* ESP multiplexed connections 0-4 */
+#define AT_IPD_MAX              1460    /* Largest +IPD payload the module sends (one TCP MSS) */
+#define AT_ESCAPE_GUARD_MS      50      /* Quiet line before "+++" (the module packs data every 20 ms) */
+#define AT_ESCAPE_WAIT_MS       1100    /* After "+++", before the module takes commands (1 s) */
+
+/* Error codes */
+typedef enum {
+    AT_OK = 0,
+    AT_ERROR_PARAM,
+    AT_ERROR_FULL,                      /* Queue full */
+    AT_ERROR_STATE                      /* Not possible in the current stream state */
+} At_Error;
+
+/* How a command ended */
+typedef enum {
+    AT_RESULT_OK = 0,                   /* The expected final line */
+    AT_RESULT_ERROR,                    /* ERROR, FAIL or SEND FAIL */
+    AT_RESULT_TIMEOUT
+} At_Result;
+
+/* Unsolicited result codes */
+typedef enum {
+    AT_URC_READY = 0,                   /* Module (re)started */
+    AT_URC_WIFI_CONNECTED,
+    AT_URC_WIFI_GOT_IP,
+    AT_URC_WIFI_DISCONNECT,
+    AT_URC_CONNECT,                     /* link: connection opened */
+    AT_URC_CONNECT_FAIL,
+    AT_URC_CLOSED                       /* link: connection closed */
+} At_Urc;
+
+/* Transparent mode */
+typedef enum {
+    AT_STREAM_OFF = 0,                  /* Command mode */
+    AT_STREAM_OPENING,                  /* AT+CIPMODE=1 and AT+CIPSEND queued or in flight */
+    AT_STREAM_DATA,                     /* Bytes pass through */
+    AT_STREAM_CLOSING                   /* Escaping: drain, guard time, "+++", wait */
+} At_StreamState;
+
+/* Link of a URC without one (single connection mode, Wi-Fi events) */
+#define AT_NO_LINK              0xFF
+
+/**
+ * Byte access to the module. peek/consume let the engine parse received
+ * bytes where they are; write must take whole commands, so writeFree
+ * reports its room. stream and writeIdle are for transparent mode.
+ */
+typedef struct {
+    uint16_t (*peek)(const uint8_t** data);     /* Contiguous received bytes */
+    void (*consume)(uint16_t size);
+    uint16_t (*write)(const uint8_t* data, uint16_t size);     /* Bytes taken */
+    uint16_t (*writeFree)(void);
+    uint32_t (*millis)(void);
+    void (*stream)(bool on);                    /* Optional: bulk transfers in data mode */
+    bool (*writeIdle)(void);                    /* Optional: everything written has left */
+    bool (*writeChain)(PBuf* chain);            /* Optional: takes and frees a whole chain */
+} At_Port;
+
+typedef void (*At_DoneCallback)(At_Result result, void* context);
+typedef void (*At_LineCallback)(const char* line, uint16_t length, void* context);
+typedef void (*At_UrcCallback)(At_Urc urc, uint8_t link);
+/* The chain's reference passes to the callback, which must free it */
+typedef void (*At_DataCallback)(uint8_t link, PBuf* data);
+
+typedef struct {
+    const char* command;        /* Without "\r\n"; copied */
+    const char* expect;         /* Final line on success; NULL for "OK" ("SEND OK" with a payload) */
+    uint32_t timeoutMs;         /* From sending to the final line */
+    bool pipelined;             /* May overlap other pipelined commands; not with a payload */
+    PBuf* payload;              /* Written at the '>' prompt; the reference passes to the engine */
+    At_LineCallback onLine;     /* Optional */
+    At_DoneCallback onDone;     /* Optional */
+    void* context;
+} At_Request;
+
+typedef struct {
+    const At_Port* port;
+    At_UrcCallback onUrc;       /* Optional */
+    At_DataCallback onData;     /* Optional; without it payloads are dropped */
+} At_Config;
+
+typedef struct {
+    uint32_t commands;          /* Completed, any result */
+    uint32_t errors;
+    uint32_t timeouts;
+    uint32_t resent;            /* Pipelined commands sent again after "busy p..." */
+    uint32_t urcs;
+    uint32_t ipdBytes;          /* Delivered to onData */
+    uint32_t ipdDropped;        /* Payload bytes lost for lack of pbufs or onData */
+    uint32_t unexpected;        /* Lines with no command waiting */
+    uint32_t longLines;         /* Lines cut at AT_LINE_MAX */
+    uint32_t streamTx;          /* Transparent bytes taken by At_StreamWrite */
+    uint32_t streamRx;          /* Transparent bytes consumed */
+    uint32_t streamDropped;     /* Received but not consumed before the escape ended */
+} At_Stats;
+
+/* USART3 through the UART driver's rings (UART_StartReceiveIT first),
+ * filled and drained by DMA in data mode */
+extern const At_Port at_uart_port;
+
+/**
+ * @brief Reset the engine: empty queue, line buffer and counters
+ * @param config: Copied
+ * @return AT_OK or AT_ERROR_PARAM
+ */
+At_Error At_Init(const At_Config* config);
+
+/**
+ * @brief Queue a command
+ * @param request: Copied, command text included
+ * @return AT_OK, AT_ERROR_PARAM (text too long, pipelined payload) or
+ *         AT_ERROR_FULL; on an error the payload stays the caller's
+ */
+At_Error At_Send(const At_Request* request);
+
+/**
+ * @brief Parse received bytes, dispatch lines and payloads, expire
+ *        timeouts and send what the queue and the port allow. Call from
+ *        the main loop.
+ * @param None
+ * @return true while commands are queued or in flight, or an escape runs
+ */
+bool At_Process(void);
+
+/**
+ * @brief Switch the connection to transparent mode: queue AT+CIPMODE=1 and
+ *        AT+CIPSEND. Needs AT+CIPMUX=0 and the connection up.
+ * @param onDone: Optional; AT_RESULT_OK once in data mode (may write from
+ *        the callback), otherwise the mode stays AT_STREAM_OFF
+ * @param context: For onDone
+ * @return AT_OK, AT_ERROR_STATE unless in command mode, AT_ERROR_FULL
+ *         without two free queue slots
+ */
+At_Error At_StreamOpen(At_DoneCallback onDone, void* context);
+
+/**
+ * @brief Escape from data mode back to command mode; bytes received until
+ *        the escape ends can still be read
+ * @param onDone: Optional; called with the result of AT+CIPMODE=0, queued
+ *        now and sent after the escape
+ * @param context: For onDone
+ * @return AT_OK, AT_ERROR_STATE unless in data mode, AT_ERROR_FULL
+ */
+At_Error At_StreamClose(At_DoneCallback onDone, void* context);
+
+/**
+ * @brief Queue bytes for the connection in data mode
+ * @param data: Bytes
+ * @param size: Number of bytes
+ * @return Bytes taken, as far as the port has room; 0 outside data mode
+ */
+uint16_t At_StreamWrite(const uint8_t* data, uint16_t size);
+
+/**
+ * @brief Bytes received from the connection, in place
+ * @param data: Set to the oldest bytes
+ * @return Contiguous bytes available, 0 in command mode
+ */
+uint16_t At_StreamPeek(const uint8_t** data);
+
+/**
+ * @brief Drop bytes after At_StreamPeek
+ * @param size: Up to the count At_StreamPeek returned
+ * @return None
+ */
+void At_StreamConsume(uint16_t size);
+
+/**
+ * @brief Current transparent mode state
+ * @param None
+ * @return At_StreamState
+ */
+At_StreamState At_GetStreamState(void);
+
+/**
+ * @brief Read the counters
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void At_GetStats(At_Stats* stats);
+
+#endif /* AT_H */
@@ -0,0 +1,211 @@
+/**
+ * @file at_match.h
+ * @brief Zero-copy matcher for ESP-AT response lines
+ *
+ * Tells apart the final results, URCs and information lines an ESP-AT
+ * module sends while the bytes stream in, one table step per byte, with
+ * no line buffer and no NUL: At_MatchByte as each byte is taken from the
+ * receive ring, At_MatchEnd at the LF. The result is a token, the link of
+ * "<link>,CONNECT" style lines and the offset of the payload after a
+ * prefix pattern ("+CIPSTATUS:" -> 11).
+ *
+ * The patterns are a prefix trie compiled into a DFA by
+ * Tools/at_match_table.py (Src/at_match_table.c): branching and accepting
+ * trie nodes are states with a row per byte class, the runs between them
+ * are compared byte for byte. A whole-line pattern beats a prefix, the
+ * longer of two prefixes wins. at_match_patterns[] is the same list for a
+ * linear scan with the same result, which 'atmbench' times against it.
+ */
+
+#ifndef AT_MATCH_H
+#define AT_MATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Set by Tools/at_match_table.py; Src/at_match_table.c checks them */
+#define AT_MATCH_CLASSES        29
+#define AT_MATCH_STATES         98
+#define AT_MATCH_PATTERNS       49
+
+#define AT_MATCH_ROOT           1
+#define AT_MATCH_LINKED         0x80    /* Token flag: the line starts "<link>," */
+#define AT_MATCH_PREFIX         0x01    /* Pattern flag: the rest of the line is payload */
+#define AT_MATCH_NO_LINK        0xFF    /* As AT_NO_LINK */
+
+/* Line tokens, named after their patterns in Tools/at_match_table.py */
+typedef enum {
+    AT_TOKEN_NONE = 0,          /* No pattern: an unknown line */
+    /* Final results */
+    AT_TOKEN_OK,
+    AT_TOKEN_SEND_OK,
+    AT_TOKEN_ERROR,
+    AT_TOKEN_FAIL,
+    AT_TOKEN_SEND_FAIL,
+    AT_TOKEN_BUSY,              /* "busy p...", "busy s..." */
+    AT_TOKEN_ECHO,              /* Command echo, "AT..." */
+    /* URCs, in At_Urc order */
+    AT_TOKEN_READY,
+    AT_TOKEN_WIFI_CONNECTED,
+    AT_TOKEN_WIFI_GOT_IP,
+    AT_TOKEN_WIFI_DISCONNECT,
+    AT_TOKEN_CONNECT,
+    AT_TOKEN_CONNECT_FAIL,
+    AT_TOKEN_CLOSED,
+    /* Unsolicited, with a payload */
+    AT_TOKEN_IPD,
+    AT_TOKEN_STA_CONNECTED,
+    AT_TOKEN_STA_DISCONNECTED,
+    AT_TOKEN_DIST_STA_IP,
+    AT_TOKEN_LINK_CONN,
+    /* Information and diagnostics */
+    AT_TOKEN_RECV,
+    AT_TOKEN_ALREADY_CONNECTED,
+    AT_TOKEN_LINK_INVALID,
+    AT_TOKEN_NO_CHANGE,
+    AT_TOKEN_DNS_FAIL,
+    AT_TOKEN_ERR_CODE,
+    AT_TOKEN_STATUS,
+    AT_TOKEN_CIPSTATUS,
+    AT_TOKEN_CIFSR,
+    AT_TOKEN_CWJAP,
+    AT_TOKEN_CWLAP,
+    AT_TOKEN_CWMODE,
+    AT_TOKEN_CWSTATE,
+    AT_TOKEN_CIPMUX,
+    AT_TOKEN_CIPSTA,
+    AT_TOKEN_CIPSTAMAC,
+    AT_TOKEN_CIPDOMAIN,
+    AT_TOKEN_CIPSNTPTIME,
+    AT_TOKEN_CIPRECVDATA,
+    AT_TOKEN_CIPRECVLEN,
+    AT_TOKEN_CIPMODE,
+    AT_TOKEN_PING,
+    AT_TOKEN_UART_CUR,
+    AT_TOKEN_VERSION,
+    AT_TOKEN_SDK_VERSION,
+    AT_TOKEN_COMPILE_TIME,
+    AT_TOKEN_BIN_VERSION,
+    AT_TOKEN_COUNT
+} At_Token;
+
+/* Pattern of the linear scan; "<link>," is not part of text */
+typedef struct {
+    const char* text;
+    uint8_t token;
+    uint8_t flags;              /* AT_MATCH_PREFIX, AT_MATCH_LINKED */
+} At_MatchPattern;
+
+/* Matching state of the line being received */
+typedef struct {
+    uint16_t length;            /* Bytes fed */
+    uint16_t label;             /* Next label byte in at_match_chars */
+    uint8_t left;               /* Label bytes still to compare */
+    uint8_t state;
+    uint8_t first;              /* First byte, the link of "<link>," lines */
+} At_Matcher;
+
+typedef struct {
+    uint8_t token;              /* At_Token */
+    uint8_t link;               /* AT_MATCH_NO_LINK unless the line starts "<link>," */
+    uint16_t payload;           /* After the pattern: length for whole lines, 0 for unknown */
+    uint16_t length;            /* Without CR and LF */
+} At_Match;
+
+/* Tables in flash, Src/at_match_table.c */
+extern const uint8_t at_match_class[256];
+extern const uint8_t at_match_next[AT_MATCH_STATES][AT_MATCH_CLASSES];
+extern const uint8_t at_match_fail[AT_MATCH_STATES];
+extern const uint8_t at_match_token[AT_MATCH_STATES];
+extern const uint8_t at_match_depth[AT_MATCH_STATES];
+extern const uint16_t at_match_label[AT_MATCH_STATES];
+extern const uint8_t at_match_length[AT_MATCH_STATES];
+extern const char at_match_chars[];
+extern const At_MatchPattern at_match_patterns[AT_MATCH_PATTERNS];
+
+/**
+ * @brief Start a line
+ * @param m: Matcher
+ * @return None
+ */
+static inline void At_MatchReset(At_Matcher* m) {
+    m->length = 0;
+    m->left = 0;
+    m->state = AT_MATCH_ROOT;
+}
+
+/**
+ * @brief Feed one byte of the line, CR and LF excluded
+ * @param m: Matcher
+ * @param c: Byte
+ * @return None
+ */
+static inline void At_MatchByte(At_Matcher* m, uint8_t c) {
+    if (m->length++ == 0) {
+        m->first = c;
+    }
+    if (m->left != 0) {
+        if ((char)c == at_match_chars[m->label]) {
+            m->label++;
+            m->left--;
+        } else {
+            m->state = at_match_fail[m->state];
+            m->left = 0;
+        }
+    } else {
+        uint8_t s = at_match_next[m->state][at_match_class[c]];
+        m->state = s;
+        m->label = at_match_label[s];
+        m->left = at_match_length[s];
+    }
+}
+
+/**
+ * @brief The token of the bytes fed so far, as if the line ended here
+ * @param m: Matcher
+ * @return At_Token, without AT_MATCH_LINKED
+ */
+static inline uint8_t At_MatchToken(const At_Matcher* m) {
+    return at_match_token[(m->left != 0) ? at_match_fail[m->state] : m->state] &
+           (uint8_t)~AT_MATCH_LINKED;
+}
+
+/**
+ * @brief Result of the line fed so far
+ * @param m: Matcher
+ * @param match: Filled in
+ * @return None
+ */
+void At_MatchEnd(const At_Matcher* m, At_Match* match);
+
+/**
+ * @brief Match lines straight from a buffer, e.g. the contiguous part of
+ *        a receive ring, carrying a partial line over to the next call
+ * @param m: Matcher, At_MatchReset once before the first line
+ * @param data: Advanced past the bytes used, the LF included
+ * @param end: End of the bytes available
+ * @param match: Filled in at the end of a line
+ * @return true when a line ended (the matcher is ready for the next one),
+ *         false when the bytes ran out first
+ */
+bool At_MatchFeed(At_Matcher* m, const uint8_t** data, const uint8_t* end, At_Match* match);
+
+/**
+ * @brief One step of timing the matcher against a strncmp chain over the
+ *        same patterns on generated modem traffic: step 0 runs the trie and
+ *        prints the header and its row, step 1 the chain, its row and the
+ *        comparison. Prints through FMT_Print.
+ * @param step: 0 or 1
+ * @return true while a step remains
+ */
+bool At_MatchBenchmarkStep(uint32_t step);
+
+/**
+ * @brief Run both steps of At_MatchBenchmarkStep(), waiting for the TX
+ *        ring between them
+ * @param None
+ * @return None
+ */
+void At_MatchRunBenchmark(void);
+
+#endif /* AT_MATCH_H */
@@ -0,0 +1,88 @@
+/**
+ * @file binlog.h
+ * @brief Deferred binary logging
+ *
+ * BINLOG() stores only a format-string ID, a cycle timestamp and the raw
+ * arguments into a lock-free ring. The format strings themselves live in the
+ * non-loaded .binlog_fmt section of the ELF and never reach flash; the host
+ * decoder (Tools/binlog_decode.py) reads them back from the ELF and rebuilds
+ * the text. Nothing is formatted on the device.
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+
+/* Records held until BinLog_Process() drains them, power of two */
+#define BINLOG_RING_SLOTS   64
+
+/* Arguments per record */
+#define BINLOG_MAX_ARGS     4
+
+/* Frame ID reserved for the "records dropped" marker */
+#define BINLOG_ID_DROPPED   0
+
+/* Count of records lost because the ring was full */
+extern volatile uint32_t binlog_dropped;
+
+/* Argument counting, 0 .. BINLOG_MAX_ARGS */
+#define BINLOG_NARGS(...)   BINLOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define BINLOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+/* Every argument travels as a 32-bit word, missing ones are padded */
+#define BINLOG_ARGS_0()             0, 0, 0, 0
+#define BINLOG_ARGS_1(a)            (uint32_t)(a), 0, 0, 0
+#define BINLOG_ARGS_2(a, b)         (uint32_t)(a), (uint32_t)(b), 0, 0
+#define BINLOG_ARGS_3(a, b, c)      (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0
+#define BINLOG_ARGS_4(a, b, c, d)   (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+#define BINLOG_CAT(a, b)            BINLOG_CAT_(a, b)
+#define BINLOG_CAT_(a, b)           a##b
+
+/**
+ * @brief Log a printf-style message without formatting it. Safe to call
+ *        from ISRs. Supported conversions: %d %i %u %x %X %c %f (pass floats
+ *        through BinLog_Float) and %s for strings that live in flash.
+ */
+#define BINLOG(fmt, ...) do { \
+        static const char binlog_fmt[] __attribute__((section(".binlog_fmt"), used)) = fmt; \
+        BinLog_Write(binlog_fmt, BINLOG_NARGS(__VA_ARGS__), \
+                     BINLOG_CAT(BINLOG_ARGS_, BINLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)); \
+    } while (0)
+
+/**
+ * @brief Reinterpret a float as the 32-bit word BINLOG() transports
+ * @param value: Float argument
+ * @return IEEE-754 bit pattern
+ */
+static inline uint32_t BinLog_Float(float value) {
+    union { float f; uint32_t u; } bits = { .f = value };
+    return bits.u;
+}
+
+/**
+ * @brief Start the DWT cycle counter used for timestamps and empty the ring
+ * @param None
+ * @return None
+ */
+void BinLog_Init(void);
+
+/**
+ * @brief Commit one record to the ring. Use the BINLOG() macro instead.
+ * @param fmt: Format string placed in .binlog_fmt
+ * @param nargs: Number of valid arguments
+ * @param a0..a3: Arguments
+ * @return None
+ */
+void BinLog_Write(const char* fmt, uint32_t nargs,
+                  uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/**
+ * @brief Encode committed records and queue them on the UART TX ring. Call
+ *        from the main loop; stops early when the TX ring is full.
+ * @param None
+ * @return Number of records sent
+ */
+uint16_t BinLog_Process(void);
+
+#endif /* BINLOG_H */
@@ -0,0 +1,150 @@
+/**
+ * @file detect.h
+ * @brief Streaming anomaly detection on ADC scan blocks: EWMA baseline,
+ *        z-score and CUSUM triggers, hysteresis, rate-limited events with
+ *        pre- and post-trigger captures
+ *
+ * Detect_AdcBlock has the Adc_BlockCallback signature, so a scan can feed
+ * the detector straight from the DMA interrupt; Detect_Process takes any
+ * block of whole scans. Per channel the detector keeps an exponentially
+ * weighted mean and variance (weight 2^-baselineShift) and scores every
+ * sample as u = (x - mean) / sigma. An event starts when |u| reaches
+ * zEnter, or when a two-sided CUSUM of u (drift cusumDrift) passes
+ * cusumLimit, which catches small steps that a z threshold misses. While
+ * an event is active the baseline is frozen; it ends after holdScans in a
+ * row below zExit (hysteresis), or after relearnScans, when the level has
+ * evidently moved and the baseline restarts from it.
+ *
+ * Every scan goes into a per-channel history ring in CCM RAM. A trigger
+ * reserves an event slot, and once postScans more scans have arrived the
+ * channel's preScans + postScans samples around it are copied out and the
+ * event is ready for Detect_Poll in the main loop. A token bucket
+ * (eventBurst tokens, one more every scansPerEvent scans) limits the event
+ * rate; triggers without a token are only counted. Only the events go
+ * uplink, so a quiet channel costs nothing.
+ */
+
+#ifndef DETECT_H
+#define DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DETECT_MAX_CHANNELS     16
+
+/* Scans of history per channel, power of 2 */
+#define DETECT_HISTORY          256
+
+/* Largest preScans + postScans */
+#define DETECT_MAX_CAPTURE      192
+
+/* Events reserved or waiting for Detect_Poll, power of 2 */
+#define DETECT_QUEUE            4
+
+/* Event fields before the capture, as packed for the uplink */
+#define DETECT_EVENT_HEADER     22
+
+/* Error codes */
+typedef enum {
+    DETECT_OK = 0,
+    DETECT_ERROR_PARAM
+} Detect_Error;
+
+typedef enum {
+    DETECT_REASON_Z = 0,        /* |u| reached zEnter */
+    DETECT_REASON_CUSUM_UP,     /* Sustained rise */
+    DETECT_REASON_CUSUM_DOWN    /* Sustained fall */
+} Detect_Reason;
+
+typedef struct {
+    uint8_t channels;           /* Samples per scan, 1 .. DETECT_MAX_CHANNELS */
+    uint8_t baselineShift;      /* EWMA weight 2^-shift, 1 .. 15 */
+    uint16_t warmupScans;       /* Baseline only, no triggers; at least preScans */
+    float zEnter;
+    float zExit;                /* Below zEnter */
+    float cusumDrift;           /* Subtracted per scan, in sigmas */
+    float cusumLimit;           /* In sigmas */
+    float minSigma;             /* Floor in counts, so a quiet channel does not trigger on 1 LSB */
+    uint16_t holdScans;         /* Below zExit for this long ends an event */
+    uint16_t relearnScans;      /* An event this long restarts the baseline */
+    uint16_t preScans;          /* Captured before the trigger scan */
+    uint16_t postScans;         /* From the trigger scan on, at least 1 */
+    uint16_t eventBurst;        /* Token bucket size */
+    uint32_t scansPerEvent;     /* One token per this many scans */
+} Detect_Config;
+
+typedef struct {
+    uint32_t sequence;          /* Events emitted before this one */
+    uint32_t scan;              /* Trigger scan, counted from Detect_Init */
+    uint8_t channel;
+    uint8_t reason;             /* Detect_Reason */
+    uint16_t pre;               /* Samples before the trigger in capture */
+    uint16_t count;             /* pre + post */
+    float score;                /* u at the trigger, or the CUSUM sum */
+    float mean;                 /* Baseline at the trigger */
+    float sigma;
+    uint16_t capture[DETECT_MAX_CAPTURE];
+} Detect_Event;
+
+typedef struct {
+    uint32_t scans;
+    uint32_t triggers;          /* Events started on any channel */
+    uint32_t events;            /* Ready for, or taken by, Detect_Poll */
+    uint32_t suppressed;        /* No token */
+    uint32_t dropped;           /* No free event slot */
+    uint32_t relearns;
+    uint32_t active;            /* Channel mask, event in progress */
+    uint32_t rawBytes;          /* Every sample as 16 bits */
+    uint32_t eventBytes;        /* Event headers and captures */
+} Detect_Stats;
+
+/**
+ * @brief Fill a config for a 1 kHz scan: 256-scan baseline, 6 sigma
+ *        z trigger, CUSUM for steps, 64 + 128 scan captures, a burst of 4
+ *        events and one more every 10 s
+ * @param config: Config to fill
+ * @param channels: Samples per scan
+ * @return None
+ */
+void Detect_DefaultConfig(Detect_Config* config, uint8_t channels);
+
+/**
+ * @brief Set up the detector and clear its history, baselines and events;
+ *        not while Detect_Process may run
+ * @param config: Copied
+ * @return DETECT_OK or DETECT_ERROR_PARAM
+ */
+Detect_Error Detect_Init(const Detect_Config* config);
+
+/**
+ * @brief Feed whole scans; call from a single context
+ * @param samples: Scans in channel order, one after the other
+ * @param count: Samples, a multiple of channels
+ * @return None
+ */
+void Detect_Process(const uint16_t* samples, uint16_t count);
+
+/**
+ * @brief Detect_Process as an Adc_BlockCallback
+ * @param unit: Ignored
+ * @param samples: Block from the ADC DMA
+ * @param count: Samples in the block
+ * @return None
+ */
+void Detect_AdcBlock(uint8_t unit, const uint16_t* samples, uint16_t count);
+
+/**
+ * @brief Take the oldest finished event
+ * @param event: Receives it
+ * @return true if there was one
+ */
+bool Detect_Poll(Detect_Event* event);
+
+/**
+ * @brief Read the counters
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Detect_GetStats(Detect_Stats* stats);
+
+#endif /* DETECT_H */
@@ -0,0 +1,164 @@
+/**
+ * @file fft.h
+ * @brief In-place complex FFT in Q15, Q31 and float32, with windowing and
+ *        spectral features (RMS, peak frequency, band energies)
+ *
+ * Data is interleaved complex, re then im, 2 * size values. The transform
+ * is decimation in frequency, radix-2 or radix-4; radix-4 on a size that
+ * is not a power of 4 starts with one radix-2 stage. The radix-4 butterfly
+ * writes its middle outputs swapped, so both radixes leave the spectrum in
+ * plain bit-reversed order and one table restores natural order.
+ *
+ * Twiddles for FFT_MAX_SIZE (k < 3/4 of the circle) and the bit-reversal
+ * table are const, in flash (Src/fft_tables.c, from Tools/fft_tables.py);
+ * smaller sizes stride through them. About 17 KB for all three formats.
+ *
+ * Fixed point: every radix-2 stage halves and every radix-4 stage quarters
+ * (SHADD16/SHSUB16 and the exchanging SHASX/SHSAX in Q15, two samples per
+ * instruction), so the result is the DFT divided by size and cannot
+ * overflow for inputs of magnitude up to 1.0. Twiddle products are SMUAD
+ * and SMUSDX. Float is not scaled.
+ *
+ * For a real signal: Fft_LoadX removes the block mean, applies the window
+ * and fills the complex buffer; Fft_X transforms it; Fft_PowerX turns bins
+ * 0 .. size/2 into one-sided power (mean square per bin, in units of full
+ * scale for fixed point); Fft_GetFeatures reduces that to a few numbers.
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FFT_MIN_SIZE            16
+#define FFT_MAX_SIZE            1024
+
+/* Twiddle pairs in the tables */
+#define FFT_TWIDDLES            (3 * FFT_MAX_SIZE / 4)
+
+/* Bands Fft_GetFeatures reports */
+#define FFT_MAX_BANDS           8
+
+/* Error codes */
+typedef enum {
+    FFT_OK = 0,
+    FFT_ERROR_PARAM
+} Fft_Error;
+
+typedef enum {
+    FFT_RADIX_2 = 2,
+    FFT_RADIX_4 = 4
+} Fft_Radix;
+
+/* Windows are computed from the Q15 cosine twiddles, the same in every
+ * format */
+typedef enum {
+    FFT_WINDOW_RECT = 0,
+    FFT_WINDOW_HANN,
+    FFT_WINDOW_HAMMING
+} Fft_Window;
+
+typedef struct {
+    uint16_t size;
+    uint8_t log2Size;
+    uint8_t radix;
+    uint16_t stride;        /* FFT_MAX_SIZE / size, twiddle step */
+    Fft_Window window;
+    float coherentGain;     /* Mean of the window */
+    float powerGain;        /* Mean of the window squared */
+} Fft_Plan;
+
+typedef struct {
+    float rms;              /* Of the signal without its mean, bins 1 .. size/2 */
+    float peakHz;           /* Strongest bin above DC, parabolic interpolation */
+    float peakAmplitude;    /* Sine amplitude at that bin, window corrected */
+    uint16_t peakBin;
+    uint8_t bandCount;
+    float band[FFT_MAX_BANDS];  /* Mean square per band */
+} Fft_Features;
+
+/* Tables in flash, Src/fft_tables.c: (cos, sin) of 2 pi k / FFT_MAX_SIZE */
+extern const int16_t fft_twiddle_q15[2 * FFT_TWIDDLES];
+extern const int32_t fft_twiddle_q31[2 * FFT_TWIDDLES];
+extern const float fft_twiddle_f32[2 * FFT_TWIDDLES];
+extern const uint16_t fft_bit_reverse[FFT_MAX_SIZE];
+
+/**
+ * @brief Prepare a transform size and window
+ * @param plan: Filled in
+ * @param size: Power of 2, FFT_MIN_SIZE .. FFT_MAX_SIZE
+ * @param radix: FFT_RADIX_2 or FFT_RADIX_4
+ * @param window: Applied by Fft_LoadX
+ * @return FFT_OK or FFT_ERROR_PARAM
+ */
+Fft_Error Fft_Init(Fft_Plan* plan, uint16_t size, Fft_Radix radix, Fft_Window window);
+
+/**
+ * @brief Remove the mean from size real samples, window them and store
+ *        them as complex values with zero imaginary part
+ * @param plan: Plan
+ * @param samples: size real samples
+ * @param x: 2 * size values
+ * @return None
+ */
+void Fft_LoadQ15(const Fft_Plan* plan, const int16_t* samples, int16_t* x);
+void Fft_LoadQ31(const Fft_Plan* plan, const int32_t* samples, int32_t* x);
+void Fft_LoadF32(const Fft_Plan* plan, const float* samples, float* x);
+
+/**
+ * @brief Forward transform in place, natural order out
+ * @param plan: Plan
+ * @param x: 2 * size values, interleaved complex
+ * @return None
+ */
+void Fft_Q15(const Fft_Plan* plan, int16_t* x);
+void Fft_Q31(const Fft_Plan* plan, int32_t* x);
+void Fft_F32(const Fft_Plan* plan, float* x);
+
+/**
+ * @brief One-sided power spectrum of a real signal's transform: bins 1 ..
+ *        size/2 - 1 are doubled, so the bins sum to the mean square of
+ *        the windowed signal
+ * @param plan: Plan
+ * @param x: Output of Fft_X
+ * @param power: size/2 + 1 values; may be x itself
+ * @return None
+ */
+void Fft_PowerQ15(const Fft_Plan* plan, const int16_t* x, float* power);
+void Fft_PowerQ31(const Fft_Plan* plan, const int32_t* x, float* power);
+void Fft_PowerF32(const Fft_Plan* plan, const float* x, float* power);
+
+/**
+ * @brief Reduce a power spectrum to features, corrected for the window
+ * @param plan: Plan
+ * @param power: From Fft_PowerX
+ * @param sampleRateHz: Sample rate of the input
+ * @param edgesHz: bandCount + 1 ascending edges; band i is [edges[i], edges[i+1])
+ * @param bandCount: 0 .. FFT_MAX_BANDS
+ * @param features: Filled in
+ * @return FFT_OK or FFT_ERROR_PARAM
+ */
+Fft_Error Fft_GetFeatures(const Fft_Plan* plan, const float* power, float sampleRateHz,
+                          const float* edgesHz, uint8_t bandCount, Fft_Features* features);
+
+/**
+ * @brief One step of timing every size, format and radix on a fixed
+ *        two-tone signal: step 0 prints the signal and header records, each
+ *        later step runs one plan and prints its "@fft" record with cycles,
+ *        an output checksum (fixed point) and the features, for
+ *        Tools/fft_ref.py. Prints through FMT_Print.
+ * @param step: Step index, counting from 0
+ * @return true while plans remain
+ */
+bool Fft_BenchmarkStep(uint32_t step);
+
+/**
+ * @brief Run every step of Fft_BenchmarkStep(), waiting for each step's
+ *        output to leave. Blocks until sent.
+ * @param None
+ * @return None
+ */
+void Fft_RunBenchmark(void);
+
+#endif /* FFT_H */
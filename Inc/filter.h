@@ -0,0 +1,168 @@
+/**
+ * @file filter.h
+ * @brief Block FIR, decimating FIR and biquad cascade filters in Q15, Q31
+ *        and float32
+ *
+ * FIR state is a mirrored circular buffer of 2 * numTaps samples: each
+ * input is written at pos and pos + numTaps, so the last numTaps inputs
+ * are always contiguous at state + pos, oldest first, and no block ever
+ * shifts the history. The Q15 kernels take two taps per __SMLALD (dual
+ * 16x16 multiply into a 64-bit accumulator), four per loop pass; Q31 and
+ * float unroll by four as well. With a decimation factor M only every M-th
+ * input produces an output, and only those pay for the dot product.
+ *
+ * Biquads are direct form I in fixed point (the Q15 stage keeps its x and
+ * y history as packed pairs for __SMLALD) and transposed direct form II in
+ * float. Each stage filters the whole block before the next one, so its
+ * coefficients and state stay in registers.
+ *
+ * Fixed-point results are exact sums of products, shifted right
+ * (truncating) and saturated; Tools/filter_ref.py reproduces them bit for
+ * bit. The 64-bit sums cannot overflow while the absolute coefficients of
+ * a FIR add up to less than 2.0. Filters may run in place (in == out).
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Error codes */
+typedef enum {
+    FILTER_OK = 0,
+    FILTER_ERROR_PARAM
+} Filter_Error;
+
+/* FIR coefficients are in time-reversed order: coeffs[0] multiplies the
+ * oldest sample of the window, coeffs[numTaps - 1] the newest input.
+ * State holds 2 * numTaps samples, zeroed by Init. */
+typedef struct {
+    const int16_t* coeffs;      /* Q15 */
+    int16_t* state;
+    uint16_t numTaps;
+    uint16_t pos;
+    uint8_t decimation;
+    uint8_t phase;
+} Filter_FirQ15;
+
+typedef struct {
+    const int32_t* coeffs;      /* Q31 */
+    int32_t* state;
+    uint16_t numTaps;
+    uint16_t pos;
+    uint8_t decimation;
+    uint8_t phase;
+} Filter_FirQ31;
+
+typedef struct {
+    const float* coeffs;
+    float* state;
+    uint16_t numTaps;
+    uint16_t pos;
+    uint8_t decimation;
+    uint8_t phase;
+} Filter_FirF32;
+
+/* Biquad coefficients are five per stage, {b0, b1, b2, a1, a2}, for
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ * (feedback terms negated against the textbook form). Fixed-point
+ * coefficients are scaled by 2^-postShift so that |a1| up to 2^postShift
+ * fits: Q15 coefficients with postShift 1 are Q14. */
+typedef struct {
+    const int16_t* coeffs;
+    int16_t* state;             /* 4 per stage: x1, x2, y1, y2 */
+    uint8_t stages;
+    uint8_t postShift;
+} Filter_BiquadQ15;
+
+typedef struct {
+    const int32_t* coeffs;
+    int32_t* state;             /* 4 per stage: x1, x2, y1, y2 */
+    uint8_t stages;
+    uint8_t postShift;
+} Filter_BiquadQ31;
+
+typedef struct {
+    const float* coeffs;
+    float* state;               /* 2 per stage: d1, d2 */
+    uint8_t stages;
+} Filter_BiquadF32;
+
+/**
+ * @brief Set up a FIR and clear its history
+ * @param f: Filter
+ * @param coeffs: numTaps coefficients, time-reversed, kept by reference
+ * @param numTaps: 1 or more
+ * @param state: 2 * numTaps samples
+ * @param decimation: Inputs per output, 1 for a plain FIR
+ * @return FILTER_OK or FILTER_ERROR_PARAM
+ */
+Filter_Error Filter_FirQ15Init(Filter_FirQ15* f, const int16_t* coeffs, uint16_t numTaps,
+                               int16_t* state, uint8_t decimation);
+Filter_Error Filter_FirQ31Init(Filter_FirQ31* f, const int32_t* coeffs, uint16_t numTaps,
+                               int32_t* state, uint8_t decimation);
+Filter_Error Filter_FirF32Init(Filter_FirF32* f, const float* coeffs, uint16_t numTaps,
+                               float* state, uint8_t decimation);
+
+/**
+ * @brief Filter a block. The decimation phase carries over between
+ *        calls, so blocks need not be multiples of the factor.
+ * @param f: Filter
+ * @param in: count input samples
+ * @param out: Receives up to count / decimation + 1 samples; may be in
+ * @param count: Input samples
+ * @return Output samples written
+ */
+uint16_t Filter_FirQ15Process(Filter_FirQ15* f, const int16_t* in, int16_t* out, uint16_t count);
+uint16_t Filter_FirQ31Process(Filter_FirQ31* f, const int32_t* in, int32_t* out, uint16_t count);
+uint16_t Filter_FirF32Process(Filter_FirF32* f, const float* in, float* out, uint16_t count);
+
+/**
+ * @brief Set up a biquad cascade and clear its state
+ * @param f: Filter
+ * @param coeffs: 5 * stages coefficients, kept by reference
+ * @param stages: 1 or more
+ * @param state: 4 * stages (2 * stages for float) values
+ * @param postShift: Coefficient scale, below 15 (Q15) or 31 (Q31)
+ * @return FILTER_OK or FILTER_ERROR_PARAM
+ */
+Filter_Error Filter_BiquadQ15Init(Filter_BiquadQ15* f, const int16_t* coeffs, uint8_t stages,
+                                  int16_t* state, uint8_t postShift);
+Filter_Error Filter_BiquadQ31Init(Filter_BiquadQ31* f, const int32_t* coeffs, uint8_t stages,
+                                  int32_t* state, uint8_t postShift);
+Filter_Error Filter_BiquadF32Init(Filter_BiquadF32* f, const float* coeffs, uint8_t stages,
+                                  float* state);
+
+/**
+ * @brief Filter a block through all stages
+ * @param f: Filter
+ * @param in: count input samples
+ * @param out: count output samples; may be in
+ * @param count: Samples
+ * @return None
+ */
+void Filter_BiquadQ15Process(Filter_BiquadQ15* f, const int16_t* in, int16_t* out, uint16_t count);
+void Filter_BiquadQ31Process(Filter_BiquadQ31* f, const int32_t* in, int32_t* out, uint16_t count);
+void Filter_BiquadF32Process(Filter_BiquadF32* f, const float* in, float* out, uint16_t count);
+
+/**
+ * @brief One step of running every kernel on a fixed pseudo-random block:
+ *        step 0 prints the input and header records, each later step runs
+ *        one kernel and prints its "@filt" record with cycles per input
+ *        sample and a checksum (fixed point) or mean and mean square (float)
+ *        of the output, for Tools/filter_ref.py. Prints through FMT_Print.
+ * @param step: Step index, counting from 0
+ * @return true while kernels remain
+ */
+bool Filter_BenchmarkStep(uint32_t step);
+
+/**
+ * @brief Run every step of Filter_BenchmarkStep(), waiting for each step's
+ *        output to leave. Blocks until sent.
+ * @param None
+ * @return None
+ */
+void Filter_RunBenchmark(void);
+
+#endif /* FILTER_H */
@@ -0,0 +1,122 @@
+/**
+ * @file fmt.h
+ * @brief Small reentrant formatter used instead of newlib sprintf
+ *
+ * No heap, no static state and no _reent, so every function here may be
+ * called from ISRs. Supported conversions: %d %i %u %x %X %c %s %p %f %%
+ * with the '-' and '0' flags, a field width and a precision. The l, h and
+ * hh length modifiers are accepted; all integers are 32-bit.
+ */
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/* Buffer sizes for the fast-path helpers, including the terminator */
+#define FMT_DEC_SIZE    12      /* "-2147483648" */
+#define FMT_HEX_SIZE    9       /* "FFFFFFFF" */
+#define FMT_FLOAT_SIZE  32      /* 20 integer digits, '.', 9 decimals, sign */
+
+/* Largest number of decimals FMT_Fixed and FMT_Float produce */
+#define FMT_MAX_DECIMALS    9
+
+/* Receives formatted output in chunks when writing to a stream */
+typedef void (*FMT_Sink)(void* context, const char* data, uint16_t length);
+
+/**
+ * @brief snprintf replacement: format into buf, always NUL-terminated
+ * @param buf: Destination buffer
+ * @param size: Size of buf in bytes
+ * @param fmt: Format string
+ * @return Length of the full output, which is >= size if it was truncated
+ */
+int FMT_Format(char* buf, size_t size, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief va_list variant of FMT_Format
+ */
+int FMT_VFormat(char* buf, size_t size, const char* fmt, va_list args);
+
+/**
+ * @brief Format through a sink, using scratch as the staging buffer
+ * @param sink: Called each time scratch fills up, and once at the end
+ * @param context: Passed through to sink
+ * @param scratch: Staging buffer
+ * @param size: Size of scratch
+ * @param fmt: Format string
+ * @param args: Arguments
+ * @return Number of characters produced
+ */
+int FMT_VFormatTo(FMT_Sink sink, void* context, char* scratch, uint16_t size,
+                  const char* fmt, va_list args);
+
+/**
+ * @brief Format straight into the UART TX ring without blocking. Output
+ *        that does not fit in the ring is dropped.
+ * @param fmt: Format string
+ * @return Number of characters produced
+ */
+int FMT_Print(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Unsigned decimal
+ * @param out: At least FMT_DEC_SIZE bytes
+ * @param value: Value to convert
+ * @return Number of characters written (terminator excluded)
+ */
+uint8_t FMT_U32Dec(char* out, uint32_t value);
+
+/**
+ * @brief Signed decimal
+ * @param out: At least FMT_DEC_SIZE bytes
+ * @param value: Value to convert
+ * @return Number of characters written (terminator excluded)
+ */
+uint8_t FMT_I32Dec(char* out, int32_t value);
+
+/**
+ * @brief Hexadecimal without prefix
+ * @param out: At least FMT_HEX_SIZE bytes
+ * @param value: Value to convert
+ * @param minDigits: Zero-pad to this many digits (at most 8)
+ * @param upper: Use A-F instead of a-f
+ * @return Number of characters written (terminator excluded)
+ */
+uint8_t FMT_U32Hex(char* out, uint32_t value, uint8_t minDigits, bool upper);
+
+/**
+ * @brief Signed fixed-point value, e.g. Q15 with fracBits = 15
+ * @param out: At least FMT_FLOAT_SIZE bytes
+ * @param value: Raw fixed-point value
+ * @param fracBits: Number of fractional bits (0 .. 31)
+ * @param decimals: Digits after the point, rounded (0 .. FMT_MAX_DECIMALS)
+ * @return Number of characters written (terminator excluded)
+ */
+uint8_t FMT_Fixed(char* out, int32_t value, uint8_t fracBits, uint8_t decimals);
+
+/**
+ * @brief Single-precision float in plain notation, computed with the FPU
+ *        only (no double arithmetic)
+ * @param out: At least FMT_FLOAT_SIZE bytes
+ * @param value: Value to convert; nan, inf and |value| >= 1e19 print as
+ *        "nan", "inf" and "ovf"
+ * @param decimals: Digits after the point, rounded (0 .. FMT_MAX_DECIMALS)
+ * @return Number of characters written (terminator excluded)
+ */
+uint8_t FMT_Float(char* out, float value, uint8_t decimals);
+
+/**
+ * @brief Compare FMT_Format against newlib sprintf on one of the format
+ *        strings the firmware uses, in DWT cycles, and print its table row
+ *        through the TX ring. Step 0 also prints the table header.
+ * @param step: Format string index, counting from 0
+ * @return true while format strings remain
+ */
+bool FMT_RunBenchmark(uint32_t step);
+
+#endif /* FMT_H */
@@ -0,0 +1,129 @@
+/**
+ * @file i2c.h
+ * @brief Interrupt and DMA driven I2C master with per-bus transaction queues
+ *
+ * A transaction addresses one device: an optional write (typically the
+ * register address), then an optional read after a repeated START. Callers
+ * own the transaction structs and may link any number of them through
+ * next and submit the chain at once; the interrupt handlers then run the
+ * whole sweep back to back: START, address and the DMA transfer of each
+ * phase, about six interrupts per transaction and no task-level work.
+ * The callback of each transaction runs from the interrupt when it is
+ * done, so a sweep usually sets one only on its last entry.
+ *
+ * NACKs end a transaction. Bus errors, lost arbitration and timeouts reset
+ * the peripheral, clock a stuck slave free (nine SCL pulses and a STOP)
+ * and retry up to I2C_MAX_RETRIES times.
+ *
+ * Pins (AF4, open drain): I2C1 PB8/PB9, I2C2 PF1/PF0, I2C3 PA8/PC9.
+ * DMA1: I2C1 RX stream 0 / TX 6, I2C2 RX 2 / TX 7, I2C3 RX 2 / TX 4.
+ * I2C2 and I2C3 share the RX stream, so their DMA reads take turns.
+ */
+
+#ifndef I2C_H
+#define I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_BUSES               3
+
+/* Bus clock choices */
+#define I2C_SPEED_STANDARD      100000UL
+#define I2C_SPEED_FAST          400000UL
+
+/* Attempts after the first for bus errors, arbitration loss and timeouts */
+#define I2C_MAX_RETRIES         2
+
+/* A transaction that has not finished after this long is aborted */
+#define I2C_TIMEOUT_MS          20
+
+/* Error codes */
+typedef enum {
+    I2C_OK = 0,
+    I2C_ERROR_PARAM,
+    I2C_ERROR_NOT_READY     /* Bus not initialised */
+} I2C_Error;
+
+/* Transaction state, final once the callback runs */
+typedef enum {
+    I2C_STATUS_IDLE = 0,
+    I2C_STATUS_PENDING,
+    I2C_STATUS_DONE,
+    I2C_STATUS_NACK,
+    I2C_STATUS_BUS_ERROR,
+    I2C_STATUS_ARB_LOST,
+    I2C_STATUS_TIMEOUT
+} I2C_Status;
+
+struct I2C_Transaction;
+typedef void (*I2C_Callback)(struct I2C_Transaction* txn);
+
+/* Data buffers are read and written by DMA1: SRAM only, not CCM */
+typedef struct I2C_Transaction {
+    uint8_t address;                /* 7-bit device address */
+    const uint8_t* txData;
+    uint16_t txLength;              /* 0 to read only; 0 and 0 probes the address */
+    uint8_t* rxData;
+    uint16_t rxLength;
+    I2C_Callback callback;          /* May be NULL; runs in interrupt context */
+    void* context;                  /* For the caller */
+    volatile I2C_Status status;
+    uint8_t retries;                /* Retries used */
+    struct I2C_Transaction* next;   /* Chain link, owned by the driver once submitted */
+} I2C_Transaction;
+
+typedef struct {
+    uint32_t transactions;  /* Finished, any status */
+    uint32_t nacks;
+    uint32_t busErrors;
+    uint32_t arbitrationLost;
+    uint32_t timeouts;
+    uint32_t recoveries;    /* Peripheral resets with bus clearing */
+    uint32_t interrupts;    /* Event, error and DMA interrupts taken */
+} I2C_Stats;
+
+/**
+ * @brief Configure the pins, the peripheral and its DMA streams, and
+ *        clear the bus. Drops anything still queued.
+ * @param bus: 1-3
+ * @param speedHz: 10 kHz to I2C_SPEED_FAST; fast mode rounds down to
+ *        what the 16 MHz PCLK1 divides to (381 kHz for 400 kHz)
+ * @return I2C_OK or I2C_ERROR_PARAM
+ */
+I2C_Error I2C_Init(uint8_t bus, uint32_t speedHz);
+
+/**
+ * @brief Queue a transaction, or a chain linked through next, and start
+ *        the bus if it is idle. The structs must stay valid until their
+ *        status is final.
+ * @param bus: 1-3
+ * @param txn: First transaction of the chain
+ * @return I2C_OK, I2C_ERROR_PARAM or I2C_ERROR_NOT_READY
+ */
+I2C_Error I2C_Submit(uint8_t bus, I2C_Transaction* txn);
+
+/**
+ * @brief Whether a bus has queued or running transactions
+ * @param bus: 1-3
+ * @return true while busy
+ */
+bool I2C_IsBusy(uint8_t bus);
+
+/**
+ * @brief Abort transactions that exceeded I2C_TIMEOUT_MS. A stuck bus
+ *        raises no interrupts, so call this from the main loop.
+ * @param None
+ * @return None
+ */
+void I2C_Process(void);
+
+/**
+ * @brief Read a bus's counters
+ * @param bus: 1-3
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void I2C_GetStats(uint8_t bus, I2C_Stats* stats);
+
+#endif /* I2C_H */
@@ -0,0 +1,95 @@
+/**
+ * @file imu.h
+ * @brief IMU FIFO burst reader: watermark interrupt to pbuf chain
+ *
+ * The IMU's FIFO watermark output is wired to EXTI line IMU_EXTI_LINE.
+ * Each interrupt allocates a pbuf chain for one burst and queues one SPI
+ * transfer for the register address plus one per segment, all under a
+ * single chip select, so the DMA writes the FIFO contents straight into
+ * the pool segments. The finished chain goes to the callback, which owns
+ * it from then on: the processing pipeline works on the same segments
+ * and frees them when done.
+ *
+ * If the interrupt line is still asserted after a burst (the FIFO refilled
+ * while it was read) the next burst starts at once. Imu_Process() retries
+ * a burst skipped because the pool was empty.
+ *
+ * Setting up the IMU itself (ODR, FIFO mode, watermark, interrupt pin) is
+ * device specific and done with Spi_Submit() before Imu_Start().
+ */
+
+#ifndef IMU_H
+#define IMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pbuf.h"
+#include "spi.h"
+
+/* EXTI line of the watermark interrupt; the pin is P<intPort>4 */
+#define IMU_EXTI_LINE           4
+
+/* Bit 7 of the register address selects a read on most IMUs */
+#define IMU_READ_BIT            0x80U
+
+/* Pool segments one burst may span */
+#define IMU_MAX_SEGMENTS        4
+
+/* Error codes */
+typedef enum {
+    IMU_OK = 0,
+    IMU_ERROR_PARAM,
+    IMU_ERROR_BUSY
+} Imu_Error;
+
+/* Receives a finished burst, and the reference to it, in interrupt context */
+typedef void (*Imu_BurstCallback)(PBuf* burst);
+
+typedef struct {
+    const Spi_Device* device;   /* Added with Spi_AddDevice, bus initialised */
+    uint8_t fifoRegister;       /* FIFO data register, read as fifoRegister | IMU_READ_BIT */
+    uint16_t burstBytes;        /* Bytes per watermark, whole samples */
+    uint16_t headroom;          /* Kept free in front of the data for later headers */
+    char intPort;               /* 'A'-'K' */
+    bool activeHigh;            /* Interrupt polarity */
+    Imu_BurstCallback callback;
+} Imu_Config;
+
+typedef struct {
+    uint32_t bursts;        /* Delivered to the callback */
+    uint32_t bytes;
+    uint32_t noBuffer;      /* Bursts postponed because the pool was empty */
+    uint32_t errors;        /* Transfers that failed; their chain is freed */
+    bool running;
+} Imu_Stats;
+
+/**
+ * @brief Arm the watermark interrupt and start reading bursts
+ * @param config: Copied
+ * @return IMU_OK, IMU_ERROR_PARAM or IMU_ERROR_BUSY
+ */
+Imu_Error Imu_Start(const Imu_Config* config);
+
+/**
+ * @brief Disarm the interrupt; a burst in progress is still delivered
+ * @param None
+ * @return None
+ */
+void Imu_Stop(void);
+
+/**
+ * @brief Start a burst the interrupt could not, once the pool has room
+ *        again. Call from the main loop.
+ * @param None
+ * @return None
+ */
+void Imu_Process(void);
+
+/**
+ * @brief Read the counters
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Imu_GetStats(Imu_Stats* stats);
+
+#endif /* IMU_H */
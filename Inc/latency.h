@@ -0,0 +1,178 @@
+/* @latency.h */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Histogram bins: exact below 32 cycles, then 16 bins per power of two
+ * (at most 1/16 relative error) up to 2^24 cycles, 1 s at 16 MHz */
+#define LATENCY_HIST_SUB_BITS   4
+#define LATENCY_HIST_BINS       336
+
+/* Samples per event and load unless configured otherwise */
+#define LATENCY_DEFAULT_SAMPLES 1000
+
+/* Report lines start with this, see Tools/latency_report.py */
+#define LATENCY_PREFIX          "@lat"
+
+/* Build label in the report, override with -DLATENCY_BUILD_ID=\"...\" */
+#ifndef LATENCY_BUILD_ID
+#define LATENCY_BUILD_ID        __DATE__ " " __TIME__
+#endif
+
+/* Software-triggered EXTI line; no pin is attached to it */
+#define LATENCY_EXTI_LINE       1
+
+/* The flash load programs the last sector (23, bank 2), which the linker
+ * scripts keep out of the FLASH region */
+#define LATENCY_FLASH_BASE      0x081E0000UL
+#define LATENCY_FLASH_SIZE      0x20000UL
+#define LATENCY_FLASH_SNB       0x1BU       /* SNB encoding of sector 23 */
+
+/* Scheduler churn: TIM3 ticks at this rate and each tick pends a PendSV
+ * that spends LATENCY_CHURN_CYCLES, standing in for a context switch */
+#define LATENCY_CHURN_HZ        20000
+#define LATENCY_CHURN_CYCLES    400
+
+typedef enum {
+    LATENCY_EVENT_TIMER = 0,    /* TIM2 compare match, time known from CCR1 */
+    LATENCY_EVENT_EXTI,         /* EXTI->SWIER write */
+    LATENCY_EVENT_UART_RX,      /* Looped-back byte reaching RXNE (PD8-PD9 jumper) */
+    LATENCY_EVENT_COUNT
+} Latency_Event;
+
+typedef enum {
+    LATENCY_LOAD_NONE = 0,
+    LATENCY_LOAD_FLASH,         /* Word programming in the foreground */
+    LATENCY_LOAD_UART_TX,       /* TX ring kept full, one interrupt per byte */
+    LATENCY_LOAD_CHURN,         /* Periodic PendSV "context switches" */
+    LATENCY_LOAD_COUNT
+} Latency_Load;
+
+typedef enum {
+    LATENCY_STAGE_ENTRY = 0,    /* Event to first instruction of the handler */
+    LATENCY_STAGE_WAKEUP,       /* Handler to the deferred (PendSV) task */
+    LATENCY_STAGE_COUNT
+} Latency_Stage;
+
+typedef struct {
+    uint32_t bins[LATENCY_HIST_BINS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} Latency_Hist;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+    uint32_t mean;
+} Latency_Summary;
+
+typedef struct {
+    uint16_t samples;           /* Per event and load */
+    uint8_t eventMask;          /* 1 << Latency_Event */
+    uint8_t loadMask;           /* 1 << Latency_Load */
+} Latency_Config;
+
+/**
+ * @brief Empty a histogram
+ * @param hist: Histogram to reset
+ * @return None
+ */
+void Latency_HistReset(Latency_Hist* hist);
+
+/**
+ * @brief Count one sample
+ * @param hist: Histogram to update
+ * @param cycles: Sample value, clamped to the last bin
+ * @return None
+ */
+void Latency_HistAdd(Latency_Hist* hist, uint32_t cycles);
+
+/**
+ * @brief Bin a value falls in
+ * @param cycles: Sample value
+ * @return Bin index, 0 .. LATENCY_HIST_BINS - 1
+ */
+uint16_t Latency_HistBin(uint32_t cycles);
+
+/**
+ * @brief Largest value that falls in a bin
+ * @param bin: Bin index
+ * @return Upper bound in cycles
+ */
+uint32_t Latency_HistBinMax(uint16_t bin);
+
+/**
+ * @brief Value below which the given share of samples lie, as the upper
+ *        bound of its bin, clamped to the exact minimum and maximum
+ * @param hist: Histogram to read
+ * @param permyriad: Share in 1/10000 (9990 for p99.9)
+ * @return Cycles, 0 if the histogram is empty
+ */
+uint32_t Latency_HistPercentile(const Latency_Hist* hist, uint16_t permyriad);
+
+/**
+ * @brief Compute count, min, p50/p90/p99/p99.9, max and mean
+ * @param hist: Histogram to read
+ * @param summary: Filled with the results
+ * @return None
+ */
+void Latency_HistSummarize(const Latency_Hist* hist, Latency_Summary* summary);
+
+/**
+ * @brief Fill a configuration with all events, all loads and
+ *        LATENCY_DEFAULT_SAMPLES samples
+ * @param config: Configuration to fill
+ * @return None
+ */
+void Latency_DefaultConfig(Latency_Config* config);
+
+/**
+ * @brief Measure one event under one background load
+ * @param event: Event to trigger
+ * @param load: Background load to run meanwhile
+ * @param samples: Number of events
+ * @param entry: Filled with event to handler entry, in cycles
+ * @param wakeup: Filled with handler entry to PendSV task, in cycles
+ * @return Events that never arrived, or -1 if the combination cannot be
+ *         measured (UART RX without loopback, or under UART TX load)
+ */
+int32_t Latency_RunCase(Latency_Event event, Latency_Load load, uint16_t samples,
+                        Latency_Hist* entry, Latency_Hist* wakeup);
+
+/**
+ * @brief Begin a run: set up the timers and EXTI, calibrate the loopback
+ *        and queue the begin and header records in the TX ring
+ * @param config: What to run, copied; NULL for the default
+ * @return None
+ */
+void Latency_Start(const Latency_Config* config);
+
+/**
+ * @brief Run the next case, or print the next piece of the last case's
+ *        histograms, or finish the run. Call only when the TX ring is empty:
+ *        the UART cases and loads use it.
+ * @param None
+ * @return true while there is more to do
+ */
+bool Latency_Step(void);
+
+/**
+ * @brief Run every configured event under every configured load and print
+ *        summaries and histograms. Uses TIM2, TIM3, EXTI line 1, PendSV and
+ *        flash sector 23; restores the UART receive mode afterwards.
+ * @param config: What to run, NULL for the default
+ * @return Number of records printed
+ */
+uint32_t Latency_Run(const Latency_Config* config);
+
+#endif /* LATENCY_H */
@@ -0,0 +1,153 @@
+/**
+ * @file lz.h
+ * @brief Streaming LZ77 compressor for uplink payloads, and the matching
+ *        decompressor for inbound data
+ *
+ * The compressor takes bytes as they are produced (Lz_Write) and hands
+ * out compressed bytes as the consumer has room (Lz_Compress, or
+ * Lz_Process straight into the UART TX ring), so nothing waits for a
+ * whole payload. Its state is static: a buffer of twice the largest
+ * window and a hash table of 2^LZ_HASH_BITS 16-bit positions, both in
+ * CCM RAM. Matches are found through the hash of the next three bytes,
+ * one candidate per hash as in LZ4: greedy, no chains, so the cost per
+ * byte is a hash, one compare and a copy.
+ *
+ * The stream is byte aligned:
+ *
+ *   LZ_MAGIC, window bits        once, at the start
+ *   0lllllll                     l + 1 literal bytes follow (1-128)
+ *   1mmmoooo oooooooo            match: offset - 1 = o (12 bits), length
+ *                                m + 3 (3-9); m = 7 adds a third byte,
+ *   1111oooo oooooooo eeeeeeee   length e + 10 (10-265)
+ *
+ * A match may overlap the bytes it produces (offset < length), which
+ * codes runs. Lz_Flush codes everything written so far without waiting
+ * for more; the stream then simply continues. The decompressor writes
+ * into one contiguous buffer and takes its matches from the output
+ * itself, so it needs no window of its own. Tools/lz_codec.py compresses
+ * and decompresses the same format on the host.
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LZ_MAGIC                0x5A        /* 'Z' */
+#define LZ_MIN_WINDOW_BITS      8           /* 256 bytes */
+
+/* Largest window Lz_Init accepts; the buffer is twice that. Lower it to
+ * save RAM, up to 12 (4 KB, the offset field's limit). */
+#ifndef LZ_MAX_WINDOW_BITS
+#define LZ_MAX_WINDOW_BITS      12
+#endif
+
+#define LZ_HASH_BITS            10
+#define LZ_MIN_MATCH            3
+#define LZ_MAX_MATCH            (LZ_MIN_MATCH + 7 + 255)
+#define LZ_MAX_LITERALS         128
+
+#if LZ_MAX_WINDOW_BITS < LZ_MIN_WINDOW_BITS || LZ_MAX_WINDOW_BITS > 12
+#error "LZ_MAX_WINDOW_BITS must be 8 to 12"
+#endif
+
+/* Error codes */
+typedef enum {
+    LZ_OK = 0,
+    LZ_ERROR_PARAM,
+    LZ_ERROR_FORMAT,            /* Bad header, or a match before the start of the output */
+    LZ_ERROR_OVERFLOW           /* Output buffer full */
+} Lz_Error;
+
+/**
+ * @brief Start a compressed stream: empties the buffer and queues the
+ *        stream header
+ * @param windowBits: LZ_MIN_WINDOW_BITS .. LZ_MAX_WINDOW_BITS
+ * @return LZ_OK or LZ_ERROR_PARAM
+ */
+Lz_Error Lz_Init(uint8_t windowBits);
+
+/**
+ * @brief Queue bytes for compression; the compressor and Lz_Write must run
+ *        in the same context
+ * @param data: Bytes to compress
+ * @param size: Number of bytes
+ * @return Bytes taken, fewer than size when the buffer is full until
+ *         Lz_Compress has coded more
+ */
+uint16_t Lz_Write(const uint8_t* data, uint16_t size);
+
+/**
+ * @brief Code queued bytes into out. Waits for LZ_MAX_MATCH bytes of
+ *        look-ahead unless flushing; never splits a token.
+ * @param out: Destination
+ * @param size: Room in out; below 3 bytes only literals make progress
+ * @return Bytes written, 0 when there is nothing to code yet
+ */
+uint16_t Lz_Compress(uint8_t* out, uint16_t size);
+
+/**
+ * @brief Have the next Lz_Compress calls code every byte written so far
+ * @param None
+ * @return None
+ */
+void Lz_Flush(void);
+
+/**
+ * @brief Whether everything written has been coded and handed out
+ * @param None
+ * @return true when idle
+ */
+bool Lz_IsIdle(void);
+
+/**
+ * @brief Compress into the free space of the UART TX ring. Call from the
+ *        main loop.
+ * @param None
+ * @return Bytes queued on the UART
+ */
+uint16_t Lz_Process(void);
+
+/**
+ * @brief Start decompressing a stream into a buffer
+ * @param out: Receives the decompressed bytes
+ * @param capacity: Size of out
+ * @return None
+ */
+void Lz_DecodeStart(uint8_t* out, uint32_t capacity);
+
+/**
+ * @brief Decompress the next part of the stream, split anywhere
+ * @param data: Compressed bytes
+ * @param size: Number of bytes
+ * @return LZ_OK, or the first error, which sticks until Lz_DecodeStart
+ */
+Lz_Error Lz_Decode(const uint8_t* data, uint32_t size);
+
+/**
+ * @brief Bytes decompressed since Lz_DecodeStart
+ * @param None
+ * @return Size of the output so far
+ */
+uint32_t Lz_DecodedSize(void);
+
+/**
+ * @brief One step of the benchmark: step 0 generates the telemetry text and
+ *        prints the header, each later step compresses and decompresses it
+ *        at one window size, from 256 bytes up, and prints cycles per byte,
+ *        MB/s at 180 MHz and the ratio through FMT_Print
+ * @param step: Step index, counting from 0
+ * @return true while window sizes remain
+ */
+bool Lz_BenchmarkStep(uint32_t step);
+
+/**
+ * @brief Run every step of Lz_BenchmarkStep(), waiting for the TX ring
+ *        between them
+ * @param None
+ * @return None
+ */
+void Lz_RunBenchmark(void);
+
+#endif /* LZ_H */
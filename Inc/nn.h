@@ -0,0 +1,170 @@
+/**
+ * @file nn.h
+ * @brief int8 inference for small sequential models: dense, 1D
+ *        convolution, max and average pooling, and table activations
+ *
+ * A model is one const blob in flash (Src/nn_model.c from
+ * Tools/nn_model.py, or any 4-byte aligned array): an Nn_ModelHeader, then
+ * layerCount Nn_LayerDesc, then the weights, biases and tables they point
+ * at by byte offset. Nn_Load checks every offset and shape against the
+ * blob and plans the activations into a caller-supplied arena; nothing is
+ * copied out of flash and nothing is allocated.
+ *
+ * Tensors are length x channels, channels fastest. Layers run in order,
+ * each output at the opposite end of the arena from its input, so the
+ * arena needs the largest input plus output of any one layer.
+ *
+ * Quantization is per tensor, asymmetric for activations (int8 with a zero
+ * point) and symmetric for weights. The bias is int32 with -zero * (row
+ * sum of the weights) folded in by the generator, so the kernels multiply
+ * raw int8 values: four per word, SXTB16 spreading bytes 0/2 and 1/3 into
+ * halfword pairs for SMLAD, two output rows per pass sharing the input
+ * words. The accumulator is rescaled by multiplier / 2^(31 + shift),
+ * rounded to nearest, offset by the output zero point and clamped to
+ * [actMin, actMax] (ReLU is actMin = outZero). Max pooling compares four
+ * channels per SSUB8/SEL. Tools/nn_ref.py reproduces every layer bit for
+ * bit.
+ */
+
+#ifndef NN_H
+#define NN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NN_MAGIC                0x31304E4EUL    /* "NN01" */
+#define NN_VERSION              1
+#define NN_MAX_LAYERS           16
+
+/* Error codes */
+typedef enum {
+    NN_OK = 0,
+    NN_ERROR_PARAM,
+    NN_ERROR_FORMAT,        /* Bad magic, offset, shape or parameter in the blob */
+    NN_ERROR_ARENA          /* Arena too small for the plan */
+} Nn_Error;
+
+typedef enum {
+    NN_LAYER_DENSE = 0,     /* units outputs from the whole (flattened) input */
+    NN_LAYER_CONV1D,        /* units channels, kernel x channels window, no padding */
+    NN_LAYER_MAXPOOL,       /* kernel window per channel */
+    NN_LAYER_AVGPOOL,       /* Rounded mean, same quantization as the input */
+    NN_LAYER_LUT            /* 256-byte table indexed by value + 128 */
+} Nn_LayerType;
+
+/* Blob header, 20 bytes, little endian */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t layerCount;
+    uint16_t inputLength;
+    uint16_t inputChannels;
+    int8_t inputZero;
+    uint8_t reserved[3];
+    uint32_t size;          /* Whole blob in bytes */
+} Nn_ModelHeader;
+
+/* Layer record, 28 bytes; offsets are from the start of the blob */
+typedef struct {
+    uint8_t type;           /* Nn_LayerType */
+    int8_t outZero;
+    int8_t actMin;
+    int8_t actMax;
+    uint16_t units;         /* Dense outputs or conv channels */
+    uint16_t kernel;        /* Conv and pool window */
+    uint16_t stride;
+    uint16_t reserved;
+    int32_t multiplier;     /* Q31, positive */
+    uint32_t shift;         /* Extra right shift, 0 .. 31 */
+    uint32_t weights;       /* int8 [units][kernel][channels], or the LUT table */
+    uint32_t bias;          /* int32 [units], 4-byte aligned */
+} Nn_LayerDesc;
+
+/* A layer as planned by Nn_Load */
+typedef struct {
+    const Nn_LayerDesc* desc;
+    const int8_t* weights;
+    const int32_t* bias;
+    uint16_t inLength;
+    uint16_t inChannels;
+    uint16_t outLength;
+    uint16_t outChannels;
+    uint32_t inOffset;      /* Arena offsets */
+    uint32_t outOffset;
+    uint32_t macs;          /* Multiply-accumulates per run */
+} Nn_Layer;
+
+typedef struct {
+    const Nn_ModelHeader* header;
+    Nn_Layer layer[NN_MAX_LAYERS];
+    uint8_t layerCount;
+    int8_t* arena;
+    uint32_t arenaUsed;
+} Nn_Model;
+
+/* Example model: accelerometer window of 64 x 3 in, 5 class scores out */
+extern const uint8_t nn_model_accel[];
+extern const uint32_t nn_model_accel_size;
+
+/**
+ * @brief Check a model blob and plan its activations
+ * @param model: Receives the plan
+ * @param blob: Model, 4-byte aligned, kept in place
+ * @param size: Blob bytes
+ * @param arena: Activation memory, 4-byte aligned
+ * @param arenaSize: Arena bytes
+ * @return NN_OK, NN_ERROR_PARAM, NN_ERROR_FORMAT or NN_ERROR_ARENA
+ */
+Nn_Error Nn_Load(Nn_Model* model, const void* blob, uint32_t size, int8_t* arena,
+                 uint32_t arenaSize);
+
+/**
+ * @brief Where the input tensor goes, inputLength x inputChannels
+ * @param model: Loaded model
+ * @return Input buffer in the arena
+ */
+int8_t* Nn_GetInput(const Nn_Model* model);
+
+/**
+ * @brief Output of a layer, valid until a later layer overwrites it
+ * @param model: Loaded model
+ * @param index: Layer
+ * @return outLength x outChannels values in the arena
+ */
+const int8_t* Nn_GetOutput(const Nn_Model* model, uint8_t index);
+
+/**
+ * @brief Run one layer on the output of the previous one (or the input)
+ * @param model: Loaded model
+ * @param index: Layer
+ * @return None
+ */
+void Nn_RunLayer(const Nn_Model* model, uint8_t index);
+
+/**
+ * @brief Run every layer on the input
+ * @param model: Loaded model
+ * @return Output of the last layer
+ */
+const int8_t* Nn_Invoke(const Nn_Model* model);
+
+/**
+ * @brief One step of timing the example model: step 0 loads it and prints
+ *        the header records, each later step runs one layer and prints its
+ *        "@nn" record with an output checksum, and the last step times the
+ *        whole model and prints its output, for Tools/nn_ref.py. Prints
+ *        through FMT_Print.
+ * @param step: Step index, counting from 0
+ * @return true while layers remain
+ */
+bool Nn_BenchmarkStep(uint32_t step);
+
+/**
+ * @brief Run every step of Nn_BenchmarkStep(), waiting for each step's
+ *        output to leave. Blocks until sent.
+ * @param None
+ * @return None
+ */
+void Nn_RunBenchmark(void);
+
+#endif /* NN_H */
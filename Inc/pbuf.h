@@ -0,0 +1,168 @@
+/**
+ * @file pbuf.h
+ * @brief Reference counted buffer chains shared by the UART, network and
+ *        storage layers
+ *
+ * A payload lives in one or more fixed-size segments taken from a static
+ * pool. Every layer works on the same segments: a header is prepended by
+ * moving the payload pointer into reserved headroom, a second consumer takes
+ * a reference instead of a copy, and the transmit path walks the chain as a
+ * scatter-gather list.
+ */
+
+#ifndef PBUF_H
+#define PBUF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Payload bytes per segment */
+#define PBUF_SEGMENT_SIZE   128
+
+/* Segments in the pool. The pool sits in SRAM, not CCMRAM, so the DMA
+ * controllers can read it directly. */
+#define PBUF_POOL_SIZE      32
+
+/* Default headroom reserved for protocol headers (AT+CIPSEND, MQTT, ...) */
+#define PBUF_HEADROOM       32
+
+/* Error codes */
+typedef enum {
+    PBUF_OK = 0,
+    PBUF_ERROR_PARAM,
+    PBUF_ERROR_NO_MEMORY,
+    PBUF_ERROR_NO_ROOM
+} PBuf_Error;
+
+/* One segment of a chain */
+typedef struct PBuf {
+    struct PBuf* next;      /* Next segment in the chain, NULL at the end */
+    uint8_t* payload;       /* First valid byte inside data[] */
+    uint16_t len;           /* Valid bytes in this segment */
+    uint16_t totLen;        /* Valid bytes in this and all following segments */
+    volatile uint8_t ref;   /* References held on this segment */
+    uint8_t data[PBUF_SEGMENT_SIZE];
+} PBuf;
+
+/* Scatter-gather cursor over a chain */
+typedef struct {
+    const PBuf* segment;
+} PBuf_Iterator;
+
+/**
+ * @brief Build the free list. Call once before any other PBuf function.
+ * @param None
+ * @return None
+ */
+void PBuf_Init(void);
+
+/**
+ * @brief Allocate a chain able to hold length bytes after headroom bytes of
+ *        reserved space in the first segment. Safe to call from ISRs.
+ * @param length: Payload bytes, spread over as many segments as needed
+ * @param headroom: Bytes kept free in front of the payload (< PBUF_SEGMENT_SIZE)
+ * @return Head of the chain with ref = 1, or NULL if the length cannot fit
+ *         in the pool or the pool is exhausted
+ */
+PBuf* PBuf_Alloc(uint16_t length, uint16_t headroom);
+
+/**
+ * @brief Take an additional reference, e.g. to hand the same payload to the
+ *        uplink and the local log. Safe to call from ISRs.
+ * @param p: Head of the chain
+ * @return None
+ */
+void PBuf_Ref(PBuf* p);
+
+/**
+ * @brief Drop one reference. Segments whose count reaches zero go back to the
+ *        pool; the walk stops at the first segment still referenced elsewhere.
+ *        Safe to call from ISRs.
+ * @param p: Head of the chain
+ * @return Number of segments returned to the pool
+ */
+uint8_t PBuf_Free(PBuf* p);
+
+/**
+ * @brief Move the start of the payload. A positive delta prepends a header
+ *        into the headroom, a negative delta strips one.
+ * @param p: Head of the chain
+ * @param delta: Bytes to add to (or remove from) the front
+ * @return PBUF_OK, or PBUF_ERROR_NO_ROOM if the headroom or data is too short
+ */
+PBuf_Error PBuf_Header(PBuf* p, int16_t delta);
+
+/**
+ * @brief Shrink a chain to its first length bytes, returning unused tail
+ *        segments to the pool
+ * @param p: Head of the chain
+ * @param length: New total length, not larger than p->totLen
+ * @return PBUF_OK, or PBUF_ERROR_PARAM
+ */
+PBuf_Error PBuf_Trim(PBuf* p, uint16_t length);
+
+/**
+ * @brief Append tail to head. The caller's reference to tail is handed over
+ *        to the chain.
+ * @param head: Chain to extend
+ * @param tail: Chain to append
+ * @return PBUF_OK, or PBUF_ERROR_PARAM
+ */
+PBuf_Error PBuf_Cat(PBuf* head, PBuf* tail);
+
+/**
+ * @brief Append tail to head and take a new reference on it, so the caller
+ *        keeps its own reference (and must still free it)
+ * @param head: Chain to extend
+ * @param tail: Chain to append
+ * @return PBUF_OK, or PBUF_ERROR_PARAM
+ */
+PBuf_Error PBuf_Chain(PBuf* head, PBuf* tail);
+
+/**
+ * @brief Copy bytes into a chain starting at offset (for producers that
+ *        cannot write into the segments directly)
+ * @param p: Head of the chain
+ * @param offset: Byte offset from the start of the payload
+ * @param src: Source bytes
+ * @param length: Number of bytes
+ * @return Bytes written
+ */
+uint16_t PBuf_Write(PBuf* p, uint16_t offset, const void* src, uint16_t length);
+
+/**
+ * @brief Copy bytes out of a chain starting at offset
+ * @param p: Head of the chain
+ * @param offset: Byte offset from the start of the payload
+ * @param dst: Destination buffer
+ * @param length: Number of bytes
+ * @return Bytes read
+ */
+uint16_t PBuf_Read(const PBuf* p, uint16_t offset, void* dst, uint16_t length);
+
+/**
+ * @brief Start a scatter-gather walk over a chain
+ * @param it: Iterator to initialise
+ * @param p: Head of the chain
+ * @return None
+ */
+void PBuf_IterInit(PBuf_Iterator* it, const PBuf* p);
+
+/**
+ * @brief Return the next non-empty segment as an address/length pair that a
+ *        DMA stream can be programmed with directly
+ * @param it: Iterator
+ * @param addr: Receives the segment's first payload byte
+ * @param len: Receives the segment's payload length
+ * @return 1 if a segment was returned, 0 at the end of the chain
+ */
+uint8_t PBuf_IterNext(PBuf_Iterator* it, const uint8_t** addr, uint16_t* len);
+
+/**
+ * @brief Segments currently in the pool
+ * @param None
+ * @return Free segment count
+ */
+uint8_t PBuf_GetFreeCount(void);
+
+#endif /* PBUF_H */
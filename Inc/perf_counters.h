@@ -0,0 +1,172 @@
+/**
+ * @file perf_counters.h
+ * @brief DWT performance counters accumulated per code region
+ *
+ * Besides CYCCNT the DWT counts, in 8 bits each:
+ *   CPI   extra cycles of multi-cycle instructions and instruction fetch
+ *         stalls (flash wait states show up here)
+ *   EXC   cycles spent entering and leaving exceptions
+ *   SLEEP cycles asleep (WFI/WFE)
+ *   LSU   extra cycles of loads and stores
+ *   FOLD  instructions folded away (zero-cycle IT, NOP)
+ * so that instructions = cycles - CPI - EXC - SLEEP - LSU + FOLD.
+ *
+ * Every counter advances at most once per cycle, so the 8-bit values are
+ * exact as long as they are folded into the 64-bit totals at least every
+ * 256 cycles. That happens on every region enter, exit and switch, and
+ * optionally from a TIM6 poll. Longer intervals are counted as wrapRisk:
+ * the affected totals may be short by multiples of 256.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Named regions, including PERFCNT_REGION_OTHER */
+#define PERFCNT_MAX_REGIONS     16
+
+/* Nested PerfCnt_Enter() calls, counting interrupt handlers that use them */
+#define PERFCNT_MAX_DEPTH       8
+
+/* Everything outside a region is charged here */
+#define PERFCNT_REGION_OTHER    0
+
+/* Poll rate limit for the TIM6 accumulation */
+#define PERFCNT_MAX_POLL_HZ     100000
+
+/* Flash sweep configurations: wait states 0-7, ART on and off */
+#define PERFCNT_SWEEP_STEPS     16
+
+/* Error codes */
+typedef enum {
+    PERFCNT_OK = 0,
+    PERFCNT_ERROR_PARAM,
+    PERFCNT_ERROR_FULL,
+    PERFCNT_ERROR_DEPTH
+} PerfCnt_Error;
+
+/* The 8-bit DWT counters */
+typedef enum {
+    PERFCNT_CPI = 0,
+    PERFCNT_EXC,
+    PERFCNT_SLEEP,
+    PERFCNT_LSU,
+    PERFCNT_FOLD,
+    PERFCNT_EVENT_COUNT
+} PerfCnt_Event;
+
+typedef struct {
+    uint64_t cycles;
+    uint64_t events[PERFCNT_EVENT_COUNT];
+    uint32_t entries;       /* PerfCnt_Enter()/PerfCnt_Switch() into the region */
+    uint32_t wrapRisk;      /* Intervals of 256+ cycles folded into the totals */
+} PerfCnt_Totals;
+
+/**
+ * @brief Enable CYCCNT and the five event counters, clear all totals and
+ *        regions and start charging PERFCNT_REGION_OTHER
+ * @param None
+ * @return None
+ */
+void PerfCnt_Init(void);
+
+/**
+ * @brief Register a region (code path or task)
+ * @param name: Label for the report, must stay valid
+ * @param id: Receives the region ID
+ * @return PERFCNT_OK, PERFCNT_ERROR_PARAM or PERFCNT_ERROR_FULL
+ */
+PerfCnt_Error PerfCnt_AddRegion(const char* name, uint8_t* id);
+
+/**
+ * @brief Start charging a region until the matching PerfCnt_Exit().
+ *        Nested regions are charged their own cycles only. Safe from ISRs.
+ * @param id: Region ID
+ * @return PERFCNT_OK, PERFCNT_ERROR_PARAM or PERFCNT_ERROR_DEPTH
+ */
+PerfCnt_Error PerfCnt_Enter(uint8_t id);
+
+/**
+ * @brief Return to the region that was active before the last
+ *        PerfCnt_Enter()
+ * @param None
+ * @return PERFCNT_OK, or PERFCNT_ERROR_DEPTH without a matching enter
+ */
+PerfCnt_Error PerfCnt_Exit(void);
+
+/**
+ * @brief Replace the innermost region, for a scheduler to charge tasks
+ *        from its context switch
+ * @param id: Region ID of the task now running
+ * @return PERFCNT_OK or PERFCNT_ERROR_PARAM
+ */
+PerfCnt_Error PerfCnt_Switch(uint8_t id);
+
+/**
+ * @brief Fold the counters into the current region now
+ * @param None
+ * @return None
+ */
+void PerfCnt_Accumulate(void);
+
+/**
+ * @brief Accumulate from the TIM6 interrupt. Each poll costs about 60
+ *        cycles, charged to the region it interrupts; 50 kHz and above keep
+ *        all but SLEEP exact in practice.
+ * @param hz: Poll rate, 1 .. PERFCNT_MAX_POLL_HZ
+ * @return PERFCNT_OK or PERFCNT_ERROR_PARAM
+ */
+PerfCnt_Error PerfCnt_StartPolling(uint32_t hz);
+
+/**
+ * @brief Stop the TIM6 poll
+ * @param None
+ * @return None
+ */
+void PerfCnt_StopPolling(void);
+
+/**
+ * @brief Zero the totals of every region, keeping the regions
+ * @param None
+ * @return None
+ */
+void PerfCnt_Reset(void);
+
+/**
+ * @brief Totals of a region, folded up to the last accumulation
+ * @param id: Region ID
+ * @return Totals, NULL for an unknown ID
+ */
+const PerfCnt_Totals* PerfCnt_GetTotals(uint8_t id);
+
+/**
+ * @brief Instructions executed, derived from the totals
+ * @param totals: Region totals
+ * @return cycles - CPI - EXC - SLEEP - LSU + FOLD, at least 0
+ */
+uint64_t PerfCnt_Instructions(const PerfCnt_Totals* totals);
+
+/**
+ * @brief Print cycles, instructions, CPI and the share of each stall
+ *        counter per region, one row per call through FMT_Print: the
+ *        header on row 0, then each region, then the total line
+ * @param row: Row index, counting from 0; row 0 takes a fresh snapshot
+ * @return true while rows remain
+ */
+bool PerfCnt_Report(uint32_t row);
+
+/**
+ * @brief Run a fixed flash-resident workload at one flash latency from
+ *        0 to 7 wait states, with the ART prefetch and caches on (steps
+ *        0-7) or off (steps 8-15), and print its cycles and CPI stall
+ *        share. Step 0 prints the header and is the 1.00x reference, so
+ *        run the steps in order. FLASH->ACR is restored afterwards.
+ * @param step: 0 .. PERFCNT_SWEEP_STEPS - 1
+ * @return PERFCNT_OK, PERFCNT_ERROR_PARAM or PERFCNT_ERROR_FULL (no region
+ *         left for the sweep)
+ */
+PerfCnt_Error PerfCnt_FlashSweep(uint8_t step);
+
+#endif /* PERF_COUNTERS_H */
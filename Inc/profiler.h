@@ -0,0 +1,103 @@
+/**
+ * @file profiler.h
+ * @brief Statistical PC-sampling profiler
+ *
+ * TIM7 interrupts at the highest priority at a dithered 1-10 kHz rate. Each
+ * interrupt reads the PC and LR stacked by the exception entry and counts
+ * the pair in an open-addressing hash table. Profiler_Dump() prints the
+ * table as "@prof" lines; Tools/profile_report.py symbolizes them against
+ * the ELF into a flat profile, folded stacks or a flame graph.
+ *
+ * The stacked LR is the caller only while the sampled function has not
+ * called anything yet, so the caller level of the flame graph is a hint.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Distinct (PC, LR) pairs the table holds, 2^PROFILER_SLOTS_BITS */
+#define PROFILER_SLOTS_BITS     9
+#define PROFILER_SLOTS          (1U << PROFILER_SLOTS_BITS)
+
+/* Slots tried before a sample counts as lost */
+#define PROFILER_MAX_PROBE      16
+
+/* Sampling rate limits and the rate used by the main loop command */
+#define PROFILER_MIN_HZ         1000
+#define PROFILER_MAX_HZ         10000
+#define PROFILER_DEFAULT_HZ     2000
+
+/* Report lines start with this, see Tools/profile_report.py */
+#define PROFILER_PREFIX         "@prof"
+
+/* Error codes */
+typedef enum {
+    PROFILER_OK = 0,
+    PROFILER_ERROR_PARAM,
+    PROFILER_ERROR_BUSY
+} Profiler_Error;
+
+/* One table entry, free while count is 0 */
+typedef struct {
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t count;
+} Profiler_Slot;
+
+typedef struct {
+    uint32_t rateHz;
+    uint32_t samples;       /* Timer interrupts taken */
+    uint32_t lost;          /* Samples that found no free slot */
+    uint16_t used;          /* Occupied slots */
+} Profiler_Stats;
+
+/**
+ * @brief Start sampling. The table keeps its counts; call
+ *        Profiler_Reset() first for a fresh profile.
+ * @param rateHz: Mean sampling rate, PROFILER_MIN_HZ .. PROFILER_MAX_HZ
+ * @return PROFILER_OK, PROFILER_ERROR_PARAM for a bad rate,
+ *         PROFILER_ERROR_BUSY if already running
+ */
+Profiler_Error Profiler_Start(uint32_t rateHz);
+
+/**
+ * @brief Stop the sampling timer
+ * @param None
+ * @return None
+ */
+void Profiler_Stop(void);
+
+/**
+ * @brief Whether the sampling timer is running
+ * @param None
+ * @return true between Profiler_Start() and Profiler_Stop()
+ */
+bool Profiler_IsRunning(void);
+
+/**
+ * @brief Empty the table and zero the statistics
+ * @param None
+ * @return None
+ */
+void Profiler_Reset(void);
+
+/**
+ * @brief Read the sample statistics
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Profiler_GetStats(Profiler_Stats* stats);
+
+/**
+ * @brief Print every occupied slot as "@prof <pc> <lr> <count>" between
+ *        "@prof-begin" and "@prof-end" lines, a few slots per step through
+ *        FMT_Print. Stop the profiler first for a consistent snapshot.
+ * @param step: Step index, counting from 0; step 0 starts over
+ * @return true while slots remain
+ */
+bool Profiler_Dump(uint32_t step);
+
+#endif /* PROFILER_H */
@@ -0,0 +1,34 @@
+/* @retarget.h */
+
+#ifndef RETARGET_H
+#define RETARGET_H
+
+#include <stdint.h>
+
+/* What a stdio stream does when the UART ring cannot take (or give) data */
+typedef enum {
+    RETARGET_BLOCKING = 0,  /* Wait for ring space / received bytes */
+    RETARGET_NONBLOCKING    /* Drop output that does not fit, reads fail with EAGAIN */
+} Retarget_Policy;
+
+/* Output bytes dropped by non-blocking streams */
+extern volatile uint32_t retarget_dropped;
+
+/**
+ * @brief Route stdin/stdout/stderr through the UART rings and set up stdio
+ *        buffering: stdout line-buffered so each line reaches the TX ring in
+ *        one _write call, stderr and stdin unbuffered. Call after UART_Init.
+ * @param None
+ * @return None
+ */
+void Retarget_Init(void);
+
+/**
+ * @brief Choose blocking or non-blocking behaviour for one stream
+ * @param fd: 0 (stdin), 1 (stdout) or 2 (stderr)
+ * @param policy: RETARGET_BLOCKING or RETARGET_NONBLOCKING
+ * @return None
+ */
+void Retarget_SetPolicy(int fd, Retarget_Policy policy);
+
+#endif /* RETARGET_H */
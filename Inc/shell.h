@@ -0,0 +1,126 @@
+/**
+ * @file shell.h
+ * @brief Non-blocking line-editing command shell on the UART rings
+ *
+ * Shell_Process() is called from the main loop and never waits: it takes
+ * what is in the RX ring, edits the line (backspace, Ctrl-U, Ctrl-C, tab
+ * completion, up/down history) and echoes into the TX ring. Enter runs the
+ * command.
+ *
+ * Commands are registered anywhere with SHELL_COMMAND(), which places a
+ * descriptor in the "shell_cmd" linker section; the shell walks the
+ * section, so adding a command needs no central list. A handler that has
+ * more output than fits in the TX ring returns SHELL_MORE and is called
+ * again, with the same arguments, once the ring has drained to
+ * SHELL_TX_RESERVE free bytes. Handlers print with FMT_Print() and do
+ * not wait: a benchmark runs one configuration per call, and a handler
+ * that needs the line quiet (to change the baud rate, say) returns
+ * SHELL_MORE until UART_IsTxIdle().
+ *
+ * Ctrl-C typed while a command runs stops it between two handler calls,
+ * along with whatever was typed ahead of it. A handler that leaves
+ * hardware set up between calls registers its cleanup with
+ * Shell_SetAbortHandler().
+ */
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Longest command line, without the terminator */
+#define SHELL_LINE_MAX          79
+
+/* Words per command line, including the command name */
+#define SHELL_MAX_ARGS          8
+
+/* Lines kept for up/down recall */
+#define SHELL_HISTORY           4
+
+/* Free TX ring space a handler call may fill without dropping output */
+#define SHELL_TX_RESERVE        256
+
+/* Received bytes handled per Shell_Process() call */
+#define SHELL_RX_BUDGET         32
+
+#define SHELL_PROMPT            "> "
+
+/* Handler results */
+typedef enum {
+    SHELL_OK = 0,
+    SHELL_MORE,             /* Call again for the next part of the output */
+    SHELL_ERROR_USAGE,      /* The shell prints the usage line */
+    SHELL_ERROR_FAILED      /* The handler has printed why */
+} Shell_Status;
+
+typedef Shell_Status (*Shell_Handler)(int argc, char* argv[]);
+
+/* Undoes a stopped command's setup */
+typedef void (*Shell_AbortHandler)(void);
+
+typedef struct {
+    const char* name;
+    const char* usage;      /* Arguments after the name, "" for none */
+    const char* help;       /* One line for "help" */
+    Shell_Handler handler;
+} Shell_Command;
+
+/* Register a command. The descriptor is named after the handler, so one
+ * handler can back only one command per file. */
+#define SHELL_COMMAND(name, usage, help, handler)                          \
+    static const Shell_Command shell_cmd_##handler                         \
+        __attribute__((section("shell_cmd"), used,                         \
+                       aligned(__alignof__(Shell_Command)))) =             \
+        { name, usage, help, handler }
+
+/**
+ * @brief Reset the line editor, start the RX interrupt if it is not
+ *        running yet and print the prompt
+ * @param None
+ * @return None
+ */
+void Shell_Init(void);
+
+/**
+ * @brief Handle up to SHELL_RX_BUDGET received bytes, or continue a
+ *        command that returned SHELL_MORE. Never blocks: long commands
+ *        do one step per handler call.
+ * @param None
+ * @return true while a command is still producing output
+ */
+bool Shell_Process(void);
+
+/**
+ * @brief Number of earlier calls of the running handler for the current
+ *        command line, 0 on the first. Lets SHELL_MORE handlers reset
+ *        their cursor.
+ * @param None
+ * @return Call index
+ */
+uint32_t Shell_GetStep(void);
+
+/**
+ * @brief Set what runs if Ctrl-C stops the running command, before the
+ *        prompt. Cleared when the command ends.
+ * @param abort: Cleanup, NULL for none
+ * @return None
+ */
+void Shell_SetAbortHandler(Shell_AbortHandler abort);
+
+/**
+ * @brief Look up a registered command
+ * @param name: Command name
+ * @return Descriptor, NULL if there is none of that name
+ */
+const Shell_Command* Shell_Find(const char* name);
+
+/**
+ * @brief Parse a decimal or 0x-prefixed hexadecimal number
+ * @param text: Argument
+ * @param value: Receives the value
+ * @return true if text was a complete number that fits in 32 bits
+ */
+bool Shell_ParseU32(const char* text, uint32_t* value);
+
+#endif /* SHELL_H */
@@ -0,0 +1,126 @@
+/**
+ * @file spi.h
+ * @brief SPI1-SPI6 master with queued full-duplex DMA transfers
+ *
+ * Each bus keeps a queue of transfers. A transfer names its device, whose
+ * chip select the driver drives low for the transfer and, with
+ * SPI_HOLD_CS, keeps low into the next one, so a command and a long read
+ * can target different buffers without a gap in the chip select. The DMA
+ * keeps DR fed and drained with the receive stream at the higher
+ * priority, so bytes follow each other without gaps at SCK = PCLK / 2;
+ * only the receive stream interrupts, once per transfer.
+ *
+ * Every bus and both APB buses run at 16 MHz in the reset clock setup,
+ * which caps SCK at 8 MHz. SPI1/4/5/6 reach 42 MHz once APB2 runs at
+ * 84 MHz; raise SPI_APB2_HZ/SPI_APB1_HZ with the clock tree.
+ *
+ * DMA2: SPI1 RX stream 0 / TX 3, SPI4 RX 0 / TX 1, SPI5 RX 5 / TX 6,
+ * SPI6 RX 6 / TX 5. SPI1 and SPI4, and SPI5 and SPI6, exclude each other;
+ * SPI4 also shares stream 1 with ADC3. The DMA1 streams of SPI2 and SPI3
+ * belong to USART3 and the I2C buses, so those two move one byte per
+ * interrupt and suit slow devices only.
+ */
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPI_BUSES               6
+
+/* Kernel clocks: SPI2/3 on APB1, the others on APB2 */
+#define SPI_APB1_HZ             16000000UL
+#define SPI_APB2_HZ             16000000UL
+
+/* Transfer flags */
+#define SPI_HOLD_CS             0x01U   /* Leave the chip select low afterwards */
+
+/* Error codes */
+typedef enum {
+    SPI_OK = 0,
+    SPI_ERROR_PARAM,
+    SPI_ERROR_BUSY,         /* DMA streams in use by the partner bus */
+    SPI_ERROR_NOT_READY     /* Bus not initialised */
+} Spi_Error;
+
+typedef enum {
+    SPI_STATUS_IDLE = 0,
+    SPI_STATUS_PENDING,
+    SPI_STATUS_DONE,
+    SPI_STATUS_DMA_ERROR
+} Spi_Status;
+
+typedef struct {
+    uint8_t bus;            /* 1-6 */
+    char csPort;            /* 'A'-'K' */
+    uint8_t csPin;
+    uint8_t mode;           /* SPI mode 0-3: CPOL << 1 | CPHA */
+    uint32_t maxHz;         /* Fastest clock the device takes */
+    uint16_t cr1;           /* Filled in by Spi_AddDevice */
+} Spi_Device;
+
+struct Spi_Transfer;
+typedef void (*Spi_Callback)(struct Spi_Transfer* xfer);
+
+/* Buffers are accessed by DMA: SRAM or flash, not CCM */
+typedef struct Spi_Transfer {
+    const Spi_Device* device;
+    const uint8_t* txData;          /* NULL clocks out 0xFF */
+    uint8_t* rxData;                /* NULL discards what comes in */
+    uint16_t length;
+    uint8_t flags;                  /* SPI_HOLD_CS */
+    Spi_Callback callback;          /* May be NULL; runs in interrupt context */
+    void* context;                  /* For the caller */
+    volatile Spi_Status status;
+    struct Spi_Transfer* next;      /* Chain link, owned by the driver once submitted */
+} Spi_Transfer;
+
+typedef struct {
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t dmaErrors;
+} Spi_Stats;
+
+/**
+ * @brief Configure a bus's pins (SPI1 PA5/PA6/PB5, SPI2 PB10/PC2/PC3,
+ *        SPI3 PC10/PC11/PC12, SPI4 PE2/PE5/PE6, SPI5 PF7/PF8/PF9,
+ *        SPI6 PG13/PG12/PG14 as SCK/MISO/MOSI), the peripheral and its
+ *        DMA streams
+ * @param bus: 1-6
+ * @return SPI_OK, SPI_ERROR_PARAM or SPI_ERROR_BUSY
+ */
+Spi_Error Spi_Init(uint8_t bus);
+
+/**
+ * @brief Set up a device's chip select as a high output and work out its
+ *        clock divider (the fastest that does not exceed maxHz)
+ * @param device: Device, must stay valid while it has transfers queued
+ * @return SPI_OK or SPI_ERROR_PARAM
+ */
+Spi_Error Spi_AddDevice(Spi_Device* device);
+
+/**
+ * @brief Queue a transfer, or a chain linked through next, and start the
+ *        bus if it is idle. Safe to call from ISRs and callbacks.
+ * @param xfer: First transfer; all must be on the same bus
+ * @return SPI_OK, SPI_ERROR_PARAM or SPI_ERROR_NOT_READY
+ */
+Spi_Error Spi_Submit(Spi_Transfer* xfer);
+
+/**
+ * @brief Whether a bus has queued or running transfers
+ * @param bus: 1-6
+ * @return true while busy
+ */
+bool Spi_IsBusy(uint8_t bus);
+
+/**
+ * @brief Read a bus's counters
+ * @param bus: 1-6
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Spi_GetStats(uint8_t bus, Spi_Stats* stats);
+
+#endif /* SPI_H */
@@ -0,0 +1,88 @@
+/* @stack_monitor.h */
+
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Value written into every unused stack word at boot */
+#define STACKMON_PAINT_PATTERN   0xA5A5A5A5UL
+
+/* One MPU region per monitored stack; the F429 MPU has 8 regions */
+#define STACKMON_MAX_STACKS      8
+
+/* No-access MPU region placed at the lowest address of each stack.
+ * Stack bases must be aligned to this size. */
+#define STACKMON_GUARD_SIZE      32
+
+/* Error codes */
+typedef enum {
+    STACKMON_OK = 0,
+    STACKMON_ERROR_PARAM,
+    STACKMON_ERROR_ALIGN,
+    STACKMON_ERROR_FULL
+} StackMon_Error;
+
+/* Per-stack bookkeeping */
+typedef struct {
+    const char* name;
+    uint32_t* base;         /* Lowest address, guard region lives here */
+    uint32_t size;          /* Total size in bytes including the guard */
+    uint32_t peakUsed;      /* Deepest usage seen by the last scan, in bytes */
+    uint32_t* mark;         /* Lowest word found overwritten so far */
+} StackMon_Stack;
+
+/* Set by MemManage_Handler when a guard region is hit */
+extern volatile uint8_t stackmon_overflow;
+
+/**
+ * @brief Paint the unused part of the main stack, install its MPU guard
+ *        region and enable the MPU. Call first thing in main().
+ * @param None
+ * @return STACKMON_OK on success
+ */
+StackMon_Error StackMon_Init(void);
+
+/**
+ * @brief Paint a task stack, protect its lowest 32 bytes with an MPU guard
+ *        and add it to the high-watermark scan
+ * @param name: Label shown in the report
+ * @param base: Lowest address of the stack, aligned to STACKMON_GUARD_SIZE
+ * @param size: Size in bytes, multiple of 4 and larger than the guard
+ * @return STACKMON_OK, or an error if the stack cannot be monitored
+ */
+StackMon_Error StackMon_RegisterTask(const char* name, uint32_t* base, uint32_t size);
+
+/**
+ * @brief Rescan all stacks for their high-watermark. The scan only walks the
+ *        words that were still untouched last time, so it is cheap enough to
+ *        call from the idle loop.
+ * @param None
+ * @return None
+ */
+void StackMon_Update(void);
+
+/**
+ * @brief Number of registered stacks (the main stack is index 0)
+ * @param None
+ * @return Stack count
+ */
+uint8_t StackMon_GetCount(void);
+
+/**
+ * @brief Access the bookkeeping of one stack
+ * @param index: 0 .. StackMon_GetCount() - 1
+ * @return Pointer to the entry, or NULL if index is out of range
+ */
+const StackMon_Stack* StackMon_GetStack(uint8_t index);
+
+/**
+ * @brief Print peak usage of the stacks on the debug UART, one row per call
+ *        through FMT_Print: the header on row 0, then each stack
+ * @param row: Row index, counting from 0; row 0 rescans first
+ * @return true while rows remain
+ */
+bool StackMon_Report(uint32_t row);
+
+#endif /* STACK_MONITOR_H */
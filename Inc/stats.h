@@ -0,0 +1,108 @@
+/**
+ * @file stats.h
+ * @brief Streaming mean, variance, RMS, min and max over sliding or
+ *        tumbling windows for many channels at once
+ *
+ * Samples arrive as frames, one int16 per channel, and are accumulated
+ * into the current pane: per channel an exact sum and sum of squares and
+ * the running min and max. Two channels are handled per word; min and max
+ * take SSUB16 and SEL for both at once. When a pane is full its summary
+ * (mean, sum of squared deviations, min, max) goes into a ring, and a
+ * window is the last `panes` of them: sliding windows move by one pane,
+ * tumbling windows are consecutive groups of `panes`. A snapshot merges
+ * the window's pane summaries, two-pass over the pane means, so the
+ * variance stays accurate however large the mean.
+ *
+ * The per-channel state is laid out as one array per field (structure of
+ * arrays) in CCM RAM, out of the way of DMA traffic in SRAM.
+ *
+ * Stats_Snapshot() reads only closed panes and may run in the main loop
+ * while an interrupt keeps feeding samples: it checks the pane counter
+ * afterwards and copies again in the rare case the ring moved under it.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#define STATS_MAX_CHANNELS      32
+
+/* Panes per window; the ring holds twice as many */
+#define STATS_MAX_PANES         16
+
+/* Error codes */
+typedef enum {
+    STATS_OK = 0,
+    STATS_ERROR_PARAM,
+    STATS_ERROR_EMPTY,      /* No complete window yet */
+    STATS_ERROR_BUSY        /* Panes closed faster than a snapshot could copy them */
+} Stats_Error;
+
+typedef enum {
+    STATS_SLIDING = 0,
+    STATS_TUMBLING
+} Stats_Mode;
+
+typedef struct {
+    uint8_t channels;       /* 1 .. STATS_MAX_CHANNELS */
+    uint16_t paneSamples;   /* Frames per pane, 1 .. 65535 */
+    uint8_t panes;          /* Per window, 1 .. STATS_MAX_PANES */
+    Stats_Mode mode;
+} Stats_Config;
+
+typedef struct {
+    float mean;
+    float variance;         /* Population variance over the window */
+    float rms;
+    int16_t min;
+    int16_t max;
+} Stats_Channel;
+
+typedef struct {
+    uint32_t endPane;       /* Panes closed before the window ended */
+    uint32_t samples;       /* Per channel */
+} Stats_Window;
+
+/**
+ * @brief Set up the engine and clear all state; not while Stats_Update
+ *        may run
+ * @param config: Copied
+ * @return STATS_OK or STATS_ERROR_PARAM
+ */
+Stats_Error Stats_Init(const Stats_Config* config);
+
+/**
+ * @brief Add one frame. Call from a single context, e.g. the ADC block
+ *        callback.
+ * @param frame: One sample per channel
+ * @return None
+ */
+void Stats_Update(const int16_t* frame);
+
+/**
+ * @brief Add consecutive frames, such as an ADC scan block
+ * @param frames: count frames of `channels` samples each
+ * @param count: Frames
+ * @return None
+ */
+void Stats_UpdateBlock(const int16_t* frames, uint16_t count);
+
+/**
+ * @brief Panes closed so far; a new tumbling window is complete every
+ *        `panes` of them, a sliding window moves on with each
+ * @param None
+ * @return Pane count
+ */
+uint32_t Stats_GetPaneCount(void);
+
+/**
+ * @brief Statistics of the latest complete window, consistent across all
+ *        channels; acquisition keeps running
+ * @param channels: Receives one entry per channel
+ * @param window: Receives the window position; may be NULL
+ * @return STATS_OK, STATS_ERROR_EMPTY or STATS_ERROR_BUSY
+ */
+Stats_Error Stats_Snapshot(Stats_Channel* channels, Stats_Window* window);
+
+#endif /* STATS_H */
@@ -0,0 +1,182 @@
+/**
+ * @file trace.h
+ * @brief Event trace for timeline views
+ *
+ * ISR entry and exit, task switches, queue operations and user markers are
+ * stored as fixed 8-byte records (cycle timestamp, type, ID, 16-bit
+ * argument) in a RAM ring. Recording is inline and costs about 20 cycles;
+ * nothing is encoded until Trace_Process() streams the ring over the UART
+ * in COBS frames, which Tools/trace_convert.py turns into Chrome/Perfetto
+ * JSON or CTF.
+ *
+ * The UART carries roughly 2000 events per second at 115200 baud, so do not
+ * instrument the SysTick or the USART3 TX interrupt, whose own output would
+ * keep the ring full.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx.h"
+
+/* Compile the TRACE_*() macros to nothing with -DTRACE_ENABLED=0 */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED       1
+#endif
+
+/* Records held until Trace_Process() drains them, power of two */
+#define TRACE_RING_SLOTS    256
+
+/* Events per wire frame */
+#define TRACE_FRAME_EVENTS  16
+
+/* Task, queue, marker and IRQ names registered with Trace_SetName() */
+#define TRACE_MAX_NAMES     24
+
+/* Record types */
+typedef enum {
+    TRACE_EV_ISR_ENTER = 1,     /* id: exception number (IPSR) */
+    TRACE_EV_ISR_EXIT,          /* id: exception number (IPSR) */
+    TRACE_EV_TASK_SWITCH,       /* id: next task, arg: previous task */
+    TRACE_EV_QUEUE_SEND,        /* id: queue, arg: items queued afterwards */
+    TRACE_EV_QUEUE_RECV,        /* id: queue, arg: items queued afterwards */
+    TRACE_EV_MARK,              /* id: marker, arg: value */
+    TRACE_EV_BEGIN,             /* id: marker, opens a span */
+    TRACE_EV_END                /* id: marker, closes the span */
+} Trace_Type;
+
+/* What an ID passed to Trace_SetName() refers to */
+typedef enum {
+    TRACE_NAME_TASK = 0,
+    TRACE_NAME_QUEUE,
+    TRACE_NAME_MARK,
+    TRACE_NAME_IRQ
+} Trace_NameKind;
+
+/* Queue and marker IDs used by the drivers; applications start at _USER */
+#define TRACE_QUEUE_UART_RX 0
+#define TRACE_QUEUE_USER    8
+#define TRACE_MARK_COMMAND  0
+#define TRACE_MARK_USER     8
+
+/* One record: info is type | id << 8 | arg << 16 */
+typedef struct {
+    uint32_t timestamp;         /* DWT->CYCCNT */
+    uint32_t info;
+} Trace_Event;
+
+extern Trace_Event trace_ring[TRACE_RING_SLOTS];
+extern volatile uint32_t trace_head;        /* Next slot to fill */
+extern volatile uint32_t trace_tail;        /* Next slot to send */
+extern volatile uint32_t trace_dropped;     /* Records lost to a full ring */
+extern volatile uint8_t trace_enabled;
+
+/**
+ * @brief Store one record. Safe from any priority; use the TRACE_*()
+ *        macros instead of calling this directly.
+ * @param type: Trace_Type
+ * @param id: 8-bit ID
+ * @param arg: 16-bit argument
+ * @return None
+ */
+static inline void Trace_Record(uint32_t type, uint32_t id, uint32_t arg) {
+    if (!trace_enabled) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t head = trace_head;
+    if (head - trace_tail < TRACE_RING_SLOTS) {
+        Trace_Event* ev = &trace_ring[head & (TRACE_RING_SLOTS - 1)];
+        ev->timestamp = DWT->CYCCNT;
+        ev->info = type | (id << 8) | (arg << 16);
+        trace_head = head + 1;
+    } else {
+        trace_dropped++;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+#if TRACE_ENABLED
+#define TRACE_ISR_ENTER()               Trace_Record(TRACE_EV_ISR_ENTER, __get_IPSR() & 0xFF, 0)
+#define TRACE_ISR_EXIT()                Trace_Record(TRACE_EV_ISR_EXIT, __get_IPSR() & 0xFF, 0)
+#define TRACE_TASK_SWITCH(next, prev)   Trace_Record(TRACE_EV_TASK_SWITCH, (uint8_t)(next), (uint16_t)(prev))
+#define TRACE_QUEUE_SEND(queue, count)  Trace_Record(TRACE_EV_QUEUE_SEND, (uint8_t)(queue), (uint16_t)(count))
+#define TRACE_QUEUE_RECV(queue, count)  Trace_Record(TRACE_EV_QUEUE_RECV, (uint8_t)(queue), (uint16_t)(count))
+#define TRACE_MARK(id, value)           Trace_Record(TRACE_EV_MARK, (uint8_t)(id), (uint16_t)(value))
+#define TRACE_BEGIN(id)                 Trace_Record(TRACE_EV_BEGIN, (uint8_t)(id), 0)
+#define TRACE_END(id)                   Trace_Record(TRACE_EV_END, (uint8_t)(id), 0)
+#else
+#define TRACE_ISR_ENTER()               ((void)0)
+#define TRACE_ISR_EXIT()                ((void)0)
+#define TRACE_TASK_SWITCH(next, prev)   ((void)0)
+#define TRACE_QUEUE_SEND(queue, count)  ((void)0)
+#define TRACE_QUEUE_RECV(queue, count)  ((void)0)
+#define TRACE_MARK(id, value)           ((void)0)
+#define TRACE_BEGIN(id)                 ((void)0)
+#define TRACE_END(id)                   ((void)0)
+#endif
+
+/**
+ * @brief Start the DWT cycle counter (without resetting it), empty the ring
+ *        and register the driver names. Recording stays off until
+ *        Trace_Start().
+ * @param None
+ * @return None
+ */
+void Trace_Init(void);
+
+/**
+ * @brief Name a task, queue, marker or IRQ for the host converter. The
+ *        string must stay valid; names are resent on every Trace_Start().
+ * @param kind: What the ID refers to
+ * @param id: 8-bit ID (exception number for TRACE_NAME_IRQ)
+ * @param name: Name, at most 32 characters are sent
+ * @return true if stored, false if the table is full
+ */
+bool Trace_SetName(Trace_NameKind kind, uint8_t id, const char* name);
+
+/**
+ * @brief Empty the ring, queue the stream header and the names, and start
+ *        recording
+ * @param None
+ * @return None
+ */
+void Trace_Start(void);
+
+/**
+ * @brief Stop recording; records already in the ring are still sent
+ * @param None
+ * @return None
+ */
+void Trace_Stop(void);
+
+/**
+ * @brief Whether recording is on
+ * @param None
+ * @return true between Trace_Start() and Trace_Stop()
+ */
+bool Trace_IsRunning(void);
+
+/**
+ * @brief Encode pending records and queue them on the UART TX ring. Call
+ *        from the main loop; stops early when the TX ring is full.
+ * @param None
+ * @return Number of records sent
+ */
+uint16_t Trace_Process(void);
+
+/**
+ * @brief Measure what one TRACE_MARK() costs with recording on. Leaves
+ *        the ring empty and recording as it was.
+ * @param None
+ * @return Cycles per record
+ */
+uint32_t Trace_MeasureCost(void);
+
+#endif /* TRACE_H */
@@ -0,0 +1,138 @@
+/**
+ * @file tscomp.h
+ * @brief Time-series compression into fixed-size packets: delta-of-delta
+ *        timestamps, zigzag varint deltas for integer channels and XOR
+ *        coding for float channels
+ *
+ * Each sample is a timestamp and one 32-bit word per channel. The
+ * timestamp is coded as the change in its delta (0, one byte, for a
+ * regular rate). An integer channel codes value - previous, zigzagged so
+ * small negative steps stay small, as a varint: 7 bits per byte, high bit
+ * set on all but the last. A float channel, as in Gorilla, XORs the bits
+ * with the previous value; the result is coded byte-aligned rather than
+ * bit-packed, as a control byte (trailing zero bytes << 4 | significant
+ * bytes, 0x00 for no change) and the significant bytes, low first.
+ * Everything is bytes, so the encoder is a few shifts and stores per value.
+ *
+ * Packets are always packetSize bytes, so they can go straight to a radio
+ * module's fixed frames:
+ *
+ *   0     TSC_MAGIC
+ *   1     sequence, wraps
+ *   2-3   bytes used, header included (little endian)
+ *   4-5   samples
+ *   6     channels
+ *   7     0
+ *   8-9   float channel mask
+ *   10..  samples, then zero padding up to packetSize
+ *
+ * Every packet starts from zero (first timestamp and values coded against
+ * 0, first delta against 0), so packets decode on their own and a lost
+ * one costs only its samples. A packet is sent when the next sample does
+ * not fit, when it has been open for flushTicks timestamp ticks (checked
+ * in Tsc_Add and Tsc_Poll), or on Tsc_Flush. Tools/tscomp_decode.py
+ * decodes a stream of packets.
+ */
+
+#ifndef TSCOMP_H
+#define TSCOMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TSC_MAGIC               0x54        /* 'T' */
+#define TSC_HEADER_SIZE         10
+#define TSC_MAX_CHANNELS        16
+#define TSC_MIN_PACKET          32
+#define TSC_MAX_PACKET          256
+
+/* Longest sample: the timestamp and every value as 5-byte varints */
+#define TSC_MAX_SAMPLE(channels)    (5U * (1U + (channels)))
+
+/* Error codes */
+typedef enum {
+    TSC_OK = 0,
+    TSC_ERROR_PARAM
+} Tsc_Error;
+
+/**
+ * Called with every finished packet, from Tsc_Add, Tsc_Poll or Tsc_Flush.
+ * The packet is reused afterwards, so send or copy it before returning.
+ */
+typedef void (*Tsc_PacketCallback)(const uint8_t* packet, uint16_t size);
+
+typedef struct {
+    uint8_t channels;           /* 1 .. TSC_MAX_CHANNELS */
+    uint16_t floatMask;         /* Bit c set: channel c holds float bits (Tsc_Float) */
+    uint16_t packetSize;        /* TSC_MIN_PACKET .. TSC_MAX_PACKET, and room for one sample */
+    uint32_t flushTicks;        /* Latest send after a packet's first sample; 0 when full only */
+    Tsc_PacketCallback callback;
+} Tsc_Config;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t packets;
+    uint32_t latencyFlushes;    /* Packets sent part full for flushTicks */
+    uint32_t usedBytes;         /* Headers and samples */
+    uint32_t sentBytes;         /* Whole packets */
+} Tsc_Stats;
+
+/**
+ * @brief Reinterpret a float as the word a float channel takes
+ * @param value: Sample
+ * @return IEEE-754 bit pattern
+ */
+static inline uint32_t Tsc_Float(float value) {
+    union { float f; uint32_t u; } bits = { .f = value };
+    return bits.u;
+}
+
+/**
+ * @brief Set up the encoder and start an empty packet; drops any samples
+ *        not yet sent
+ * @param config: Copied
+ * @return TSC_OK or TSC_ERROR_PARAM
+ */
+Tsc_Error Tsc_Init(const Tsc_Config* config);
+
+/**
+ * @brief Add one sample; call from a single context
+ * @param timestamp: Any unit, non-decreasing apart from wrapping
+ * @param values: One word per channel: int32 values, or Tsc_Float bits
+ * @return None
+ */
+void Tsc_Add(uint32_t timestamp, const uint32_t* values);
+
+/**
+ * @brief Send the open packet if it has waited flushTicks; for quiet
+ *        periods with no Tsc_Add
+ * @param now: Current time in timestamp ticks
+ * @return None
+ */
+void Tsc_Poll(uint32_t now);
+
+/**
+ * @brief Send the open packet now, if it holds any samples
+ * @param None
+ * @return None
+ */
+void Tsc_Flush(void);
+
+/**
+ * @brief Read the counters
+ * @param stats: Filled with the current values
+ * @return None
+ */
+void Tsc_GetStats(Tsc_Stats* stats);
+
+/**
+ * @brief One step of encoding a generated accelerometer stream: each step
+ *        adds a chunk of samples, and the last two print cycles per sample,
+ *        bytes per sample and the sample rate that fits 115200 baud through
+ *        FMT_Print. Reinitializes the encoder on step 0.
+ * @param step: Step index, counting from 0
+ * @return true while steps remain
+ */
+bool Tsc_BenchmarkStep(uint32_t step);
+
+#endif /* TSCOMP_H */
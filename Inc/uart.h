@@ -10,6 +10,7 @@
 #define UART_H
 
 #include "stm32f4xx.h"
+#include "pbuf.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -63,6 +64,14 @@ typedef struct {
 #define UART_HWCONTROL_CTS      2
 #define UART_HWCONTROL_RTS_CTS  3
 
+/* Transmit and receive rings, served by interrupt or DMA; sizes must be
+ * powers of two */
+#define UART_TX_RING_SIZE       1024
+#define UART_RX_RING_SIZE       1024
+
+/* Bytes lost because the RX ring was full */
+extern volatile uint32_t uart_rx_overflows;
+
 /* Function prototypes */
 
 UART_Error UART_InitConfig(UART_Config* config);
@@ -83,5 +92,81 @@ void UART_Init(uint32_t baud);
 /* Send a null-terminated string via UART */
 void UART_SendString(const char* str);
 
+/* Queue bytes on the interrupt-driven TX ring without waiting.
+ * Returns the number of bytes accepted (less than size if the ring is full). */
+uint16_t UART_WriteAsync(const uint8_t* data, uint16_t size);
+
+/* Free space on the TX ring in bytes */
+uint16_t UART_GetTxFree(void);
+
+/* True once the TX ring is empty */
+bool UART_IsTxIdle(void);
+
+/* Empty the RX ring and start filling it from the RXNE interrupt.
+ * UART_IsDataAvailable/UART_ReceiveByte read from the ring from then on. */
+void UART_StartReceiveIT(void);
+
+/* Copy up to size received bytes out of the RX ring without waiting.
+ * Returns the number of bytes copied. */
+uint16_t UART_ReadAsync(uint8_t* buffer, uint16_t size);
+
+/* Bytes waiting in the RX ring */
+uint16_t UART_GetRxCount(void);
+
+/* Point data at the oldest received bytes, left in the RX ring for parsing
+ * in place. Returns how many are contiguous (up to the ring's wrap). */
+uint16_t UART_PeekRx(const uint8_t** data);
+
+/* As UART_PeekRx, starting offset bytes past the oldest. Returns 0 once
+ * offset reaches the end of what was received. */
+uint16_t UART_PeekRxAt(uint16_t offset, const uint8_t** data);
+
+/* Drop size bytes from the front of the RX ring, after UART_PeekRx */
+void UART_ConsumeRx(uint16_t size);
+
+/* Stop the RXNE interrupt; DR is left for polled reads again */
+void UART_StopReceiveIT(void);
+
+/* Start a DMA transfer of size bytes from data (DMA1 Stream 3). The buffer
+ * must stay valid and in SRAM (not CCM) until UART_IsTxDmaBusy() is false.
+ * Returns UART_ERROR_BUSY while a transfer or the TX ring is still active. */
+UART_Error UART_WriteDMA(const uint8_t* data, uint16_t size);
+
+/* Send a PBuf chain by DMA straight from its segments, one transfer per
+ * segment, and free it once the last has gone out. The chain's reference
+ * passes to the driver on UART_OK. Returns UART_ERROR_BUSY while a
+ * transfer or the TX ring is still active; the chain is then left alone. */
+UART_Error UART_WriteChainDMA(PBuf* chain);
+
+/* True until the last byte of a DMA transfer has been handed to the USART */
+bool UART_IsTxDmaBusy(void);
+
+/* Drain the TX ring by DMA (DMA1 Stream 3) instead of the TXE interrupt,
+ * in blocks of up to half the ring; UART_WriteAsync is used as before.
+ * For sustained output at high baud rates, where an interrupt per byte
+ * would take most of the core. Bytes already queued are kept. */
+void UART_StartTransmitDMA(void);
+
+/* Back to the TXE interrupt once the block in flight has gone out */
+void UART_StopTransmitDMA(void);
+
+/* Fill the RX ring by DMA (DMA1 Stream 1) instead of the RXNE interrupt;
+ * UART_PeekRx/UART_ConsumeRx/UART_ReadAsync are used as before. Unlike
+ * UART_StartReceiveIT the ring is not emptied, so nothing is lost when
+ * switching. A transfer ends at the ring's wrap or at the reader's tail:
+ * with the ring full the stream waits for the reader, RXNE stays set and,
+ * with UART_HWCONTROL_RTS, RTS holds the sender off instead of overrunning. */
+void UART_StartReceiveDMA(void);
+
+/* Stop the RX stream, keeping what it stored; DR is left for polled reads
+ * or UART_StartReceiveIT */
+void UART_StopReceiveDMA(void);
+
+/* Called from the USART3 interrupt each time a byte has been put in the RX
+ * ring, e.g. to wake the reader, and in DMA mode each time a transfer into
+ * the ring ends. NULL to remove. */
+typedef void (*UART_RxCallback)(void);
+void UART_SetRxCallback(UART_RxCallback callback);
+
 #endif
 
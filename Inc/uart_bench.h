@@ -0,0 +1,115 @@
+/* @uart_bench.h */
+
+#ifndef UART_BENCH_H
+#define UART_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Largest chunk handed to one driver call, also the payload buffer size */
+#define UART_BENCH_MAX_CHUNK    4096
+
+/* Bytes sent per case unless the chunk is larger */
+#define UART_BENCH_DEFAULT_BYTES 4096
+
+/* Record lines start with this so a host script can pick them out of
+ * the payload traffic: "@ub-begin <format> <loopback>", "@ub <record>",
+ * "@ub-end <count>" */
+#define UART_BENCH_PREFIX       "@ub"
+
+typedef enum {
+    UART_BENCH_POLLING = 0,     /* UART_Transmit, CPU waits on TXE */
+    UART_BENCH_IRQ,             /* UART_WriteAsync, TX ring emptied by the ISR */
+    UART_BENCH_DMA,             /* UART_WriteDMA, DMA1 Stream 3 */
+    UART_BENCH_MODE_COUNT
+} UartBench_Mode;
+
+typedef enum {
+    UART_BENCH_CSV = 0,
+    UART_BENCH_JSON             /* One object per line */
+} UartBench_Format;
+
+typedef struct {
+    const uint32_t* bauds;
+    uint8_t baudCount;
+    const uint16_t* chunks;
+    uint8_t chunkCount;
+    uint8_t modeMask;           /* 1 << UartBench_Mode */
+    uint32_t bytesPerCase;
+    uint32_t consoleBaud;       /* Records are sent at this rate between cases */
+    UartBench_Format format;
+} UartBench_Config;
+
+typedef struct {
+    UartBench_Mode mode;
+    uint32_t baud;
+    uint16_t chunk;
+    uint32_t bytes;
+    uint32_t elapsedUs;         /* First call to TC after the last byte */
+    uint32_t throughput;        /* Bytes per second */
+    uint16_t linePermille;      /* Throughput against the 10-bit frame rate */
+    uint16_t cpuPermille;       /* Share of elapsed time not spent idle */
+    uint32_t callCycles;        /* Average cycles inside one driver call */
+    uint32_t calls;
+    bool loopback;              /* RX figures are only valid with TX wired to RX */
+    uint32_t rxLost;            /* Sent bytes that never reached the reader */
+} UartBench_Result;
+
+/**
+ * @brief Fill a configuration with the full matrix: 115200/460800/921600
+ *        baud, 1 to 4096 byte chunks, all three modes, CSV at 115200
+ * @param config: Configuration to fill
+ * @return None
+ */
+void UartBench_DefaultConfig(UartBench_Config* config);
+
+/**
+ * @brief Run one case at the current baud rate (set with UART_Init). With
+ *        PD8 (TX) jumpered to PD9 (RX) the looped-back bytes measure RX loss
+ *        while transmitting.
+ * @param mode: Driver path to measure
+ * @param chunk: Bytes per driver call, at most UART_BENCH_MAX_CHUNK
+ * @param bytes: Total bytes to send
+ * @param result: Filled with the measurements
+ * @return None
+ */
+void UartBench_RunCase(UartBench_Mode mode, uint16_t chunk, uint32_t bytes, UartBench_Result* result);
+
+/**
+ * @brief Format one result as a CSV or JSON record (without prefix)
+ * @param buf: Destination
+ * @param size: Size of buf
+ * @param result: Result to format
+ * @param format: UART_BENCH_CSV or UART_BENCH_JSON
+ * @return Length written, as FMT_Format
+ */
+int UartBench_FormatResult(char* buf, size_t size, const UartBench_Result* result,
+                           UartBench_Format format);
+
+/**
+ * @brief Begin a run: set up the console, detect the loopback jumper and
+ *        queue the begin (and CSV header) records in the TX ring
+ * @param config: Matrix to run, copied; NULL for the default
+ * @return None
+ */
+void UartBench_Start(const UartBench_Config* config);
+
+/**
+ * @brief Run the next case of the matrix and queue its record, or the end
+ *        record once all cases are done. Call only when the TX ring is
+ *        empty and the last byte has left: cases change the baud rate.
+ * @param None
+ * @return true while cases remain
+ */
+bool UartBench_Step(void);
+
+/**
+ * @brief Run the whole matrix and send one record per case, no input needed.
+ *        Parse the output with Tools/uart_bench.py.
+ * @param config: Matrix to run, NULL for the default
+ * @return Number of cases run
+ */
+uint32_t UartBench_Run(const UartBench_Config* config);
+
+#endif /* UART_BENCH_H */
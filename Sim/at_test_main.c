@@ -0,0 +1,381 @@
+/**
+ * @file at_test_main.c
+ * @brief Runs the AT command engine (Src/at.c) against a modem on a
+ *        terminal, normally the fake one in Tools/fake_esp.py, which
+ *        starts this program with the path of its pseudo-terminal:
+ *        bring-up with pipelined commands, joining and connecting with
+ *        their URCs, binary payloads out and echoed back as +IPD, a
+ *        pipelined burst, an error, a timeout, the close, a send on the
+ *        single connection with AT+CIPDINFO=1, and a bulk transfer both
+ *        ways in transparent mode with the "+++" escape.
+ *        Exits 0 if every step ends as expected.
+ *
+ *   fake_esp.py [--busy] [--split] -- at_test
+ *   at_test /dev/pts/N
+ */
+
+#include "at.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RX_SIZE         512
+#define STEP_MS         5000
+#define SMALL           300
+#define LARGE           2000
+#define BURST           6
+#define STREAM_BYTES    65536
+#define STREAM_CHUNK    1024
+
+typedef struct {
+    const char* name;
+    At_Result result;
+    bool done;
+    uint16_t lines;
+} Command;
+
+static int fd = -1;
+static uint8_t rx[RX_SIZE];
+static uint16_t rx_head;
+static uint16_t rx_tail;
+
+static uint8_t sent[2][LARGE];
+static uint8_t received[2][LARGE];
+static uint32_t received_len[2];
+static uint8_t stream_out[STREAM_BYTES];
+static uint8_t stream_in[STREAM_BYTES];
+static uint32_t urcs[AT_URC_CLOSED + 1];
+static uint8_t urc_link[AT_URC_CLOSED + 1];
+static int failures;
+
+/* Port: the terminal, read into a small buffer the engine parses in place */
+
+static uint16_t PtyPeek(const uint8_t** data) {
+    if (rx_head == rx_tail) {
+        ssize_t n = read(fd, rx, sizeof(rx));
+        rx_head = 0;
+        rx_tail = (n > 0) ? (uint16_t)n : 0;
+    }
+    *data = rx + rx_head;
+    return (uint16_t)(rx_tail - rx_head);
+}
+
+static void PtyConsume(uint16_t size) {
+    rx_head += size;
+}
+
+static uint16_t PtyWrite(const uint8_t* data, uint16_t size) {
+    ssize_t n = write(fd, data, size);
+    return (n > 0) ? (uint16_t)n : 0;
+}
+
+static uint16_t PtyWriteFree(void) {
+    return 1024;
+}
+
+static uint32_t PtyMillis(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+/* Written bytes the other end has not read yet, so the escape's guard
+ * time starts when the line is really quiet */
+static bool PtyWriteIdle(void) {
+    int queued = 0;
+
+    ioctl(fd, TIOCOUTQ, &queued);
+    return queued == 0;
+}
+
+/* No writeChain: payloads are copied through PtyWrite */
+static const At_Port pty_port = {
+    PtyPeek, PtyConsume, PtyWrite, PtyWriteFree, PtyMillis, NULL, PtyWriteIdle, NULL
+};
+
+/* Callbacks */
+
+static void OnDone(At_Result result, void* context) {
+    Command* command = context;
+
+    command->result = result;
+    command->done = true;
+}
+
+static void OnLine(const char* line, uint16_t length, void* context) {
+    ((Command*)context)->lines++;
+}
+
+static void OnUrc(At_Urc urc, uint8_t link) {
+    urcs[urc]++;
+    urc_link[urc] = link;
+}
+
+static void OnData(uint8_t link, PBuf* data) {
+    /* The single connection shares link 0's buffers */
+    uint8_t slot = (link == AT_NO_LINK) ? 0 : link;
+
+    if (slot < 2 && received_len[slot] + data->totLen <= LARGE) {
+        PBuf_Read(data, 0, received[slot] + received_len[slot], data->totLen);
+        received_len[slot] += data->totLen;
+    }
+    PBuf_Free(data);
+}
+
+/* Steps */
+
+static void Check(bool ok, const char* what) {
+    printf("%-44s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void Queue(Command* command, const char* text, bool pipelined, uint32_t timeoutMs,
+                  PBuf* payload) {
+    At_Request request = {
+        .command = text, .timeoutMs = timeoutMs, .pipelined = pipelined, .payload = payload,
+        .onLine = OnLine, .onDone = OnDone, .context = command
+    };
+
+    memset(command, 0, sizeof(*command));
+    command->name = text;
+    if (At_Send(&request) != AT_OK) {
+        printf("%s: not queued\n", text);
+        exit(1);
+    }
+}
+
+static void Wait(void) {
+    struct pollfd p = { .fd = fd, .events = POLLIN };
+
+    poll(&p, 1, 1);
+}
+
+/* Until the queue is empty or the step's time runs out */
+static void Run(void) {
+    uint32_t start = PtyMillis();
+
+    while (At_Process() && PtyMillis() - start < STEP_MS) {
+        Wait();
+    }
+}
+
+static bool Ended(const Command* command, At_Result result) {
+    return command->done && command->result == result;
+}
+
+/* Binary, with CR/LF and result text inside */
+static PBuf* Payload(uint8_t link, uint16_t size) {
+    static const char trap[] = "\r\nOK\r\n+IPD,0,3:\r\nERROR\r\n";
+    PBuf* p = PBuf_Alloc(size, 0);
+
+    for (uint16_t i = 0; i < size; i++) {
+        sent[link][i] = (uint8_t)(i * 7U + link);
+    }
+    memcpy(sent[link] + size / 2, trap, sizeof(trap) - 1);
+    if (p != NULL) {
+        PBuf_Write(p, 0, sent[link], size);
+    }
+    return p;
+}
+
+static void Send(uint8_t link, uint16_t size, const char* label) {
+    Command command;
+    char text[32];
+    uint8_t before = PBuf_GetFreeCount();
+    uint8_t slot = (link == AT_NO_LINK) ? 0 : link;
+
+    if (link == AT_NO_LINK) {
+        snprintf(text, sizeof(text), "AT+CIPSEND=%u", size);
+    } else {
+        snprintf(text, sizeof(text), "AT+CIPSEND=%u,%u", link, size);
+    }
+    received_len[slot] = 0;
+    Queue(&command, text, false, 2000, Payload(slot, size));
+    Run();
+    /* The echo follows SEND OK */
+    uint32_t start = PtyMillis();
+    while (received_len[slot] < size && PtyMillis() - start < STEP_MS) {
+        At_Process();
+        Wait();
+    }
+    bool echoed = received_len[slot] == size && memcmp(received[slot], sent[slot], size) == 0;
+    Check(Ended(&command, AT_RESULT_OK), label);
+    Check(echoed, "  echoed back through +IPD");
+    Check(PBuf_GetFreeCount() == before, "  pbufs returned");
+}
+
+/* Transparent mode on a single connection: written and read back at once,
+ * the escape, then commands again */
+static void Stream(void) {
+    Command open;
+    Command close;
+    Command check;
+    const uint8_t* data;
+    uint16_t n;
+    uint32_t sent = 0;
+    uint32_t got = 0;
+
+    for (uint32_t i = 0; i < STREAM_BYTES; i++) {
+        stream_out[i] = (uint8_t)(i * 13U + (i >> 9));
+    }
+    /* Command text inside the data is only data */
+    memcpy(stream_out + STREAM_BYTES / 2, "\r\nOK\r\n+++AT\r\n", 14);
+
+    memset(&open, 0, sizeof(open));
+    Check(At_StreamOpen(OnDone, &open) == AT_OK, "transparent mode requested");
+    Check(At_StreamOpen(OnDone, &open) == AT_ERROR_STATE, "  only once");
+    Run();
+    Check(Ended(&open, AT_RESULT_OK) && At_GetStreamState() == AT_STREAM_DATA,
+          "  data mode at the '>'");
+
+    /* The escape starts right behind the last write, while the echo is
+     * still coming in, and what arrives until it ends is read */
+    memset(&close, 0, sizeof(close));
+    for (uint32_t start = PtyMillis(); !close.done && PtyMillis() - start < STEP_MS; ) {
+        bool idle = true;
+        if (sent < STREAM_BYTES) {
+            uint32_t size = STREAM_BYTES - sent;
+            n = At_StreamWrite(stream_out + sent, (uint16_t)(size < STREAM_CHUNK ? size : STREAM_CHUNK));
+            sent += n;
+            idle = n == 0;
+            if (sent == STREAM_BYTES) {
+                Check(At_StreamClose(OnDone, &close) == AT_OK, "  escape behind the last write");
+                Check(At_StreamWrite(stream_out, 1) == 0, "  no data once escaping");
+            }
+        }
+        while ((n = At_StreamPeek(&data)) != 0) {
+            if (got + n <= STREAM_BYTES) {
+                memcpy(stream_in + got, data, n);
+            }
+            got += n;
+            At_StreamConsume(n);
+            idle = false;
+        }
+        At_Process();
+        if (idle) {
+            Wait();
+        }
+    }
+    Check(got == STREAM_BYTES && memcmp(stream_in, stream_out, STREAM_BYTES) == 0,
+          "  64 KB out, echoed back unchanged");
+    Check(Ended(&close, AT_RESULT_OK) && At_GetStreamState() == AT_STREAM_OFF,
+          "  \"+++\", back to command mode");
+
+    Queue(&check, "AT+CIPSTATUS", false, 1000, NULL);
+    Run();
+    Check(Ended(&check, AT_RESULT_OK) && check.lines == 2, "  commands again after the escape");
+}
+
+int main(int argc, char* argv[]) {
+    struct termios tio;
+    Command cmds[AT_QUEUE_SIZE];
+    At_Stats stats;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s tty\n", argv[0]);
+        return 2;
+    }
+    fd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        perror(argv[1]);
+        return 2;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    PBuf_Init();
+    At_Config config = { .port = &pty_port, .onUrc = OnUrc, .onData = OnData };
+    At_Init(&config);
+
+    /* Echo is on until ATE0 takes effect */
+    Queue(&cmds[0], "AT", true, 1000, NULL);
+    Queue(&cmds[1], "ATE0", true, 1000, NULL);
+    Queue(&cmds[2], "AT+CWMODE=1", true, 1000, NULL);
+    Queue(&cmds[3], "AT+CIPMUX=1", true, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK) && Ended(&cmds[1], AT_RESULT_OK) &&
+          Ended(&cmds[2], AT_RESULT_OK) && Ended(&cmds[3], AT_RESULT_OK),
+          "bring-up, pipelined");
+
+    Queue(&cmds[0], "AT+CWJAP=\"lab\",\"secret\"", false, 3000, NULL);
+    Queue(&cmds[1], "AT+CIFSR", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK) && urcs[AT_URC_WIFI_CONNECTED] == 1 &&
+          urcs[AT_URC_WIFI_GOT_IP] == 1, "join, WIFI CONNECTED and GOT IP");
+    Check(Ended(&cmds[1], AT_RESULT_OK) && cmds[1].lines == 2, "address lines");
+
+    Queue(&cmds[0], "AT+CIPSTART=0,\"TCP\",\"10.0.0.1\",8080", false, 1000, NULL);
+    Queue(&cmds[1], "AT+CIPSTART=1,\"TCP\",\"10.0.0.1\",8080", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK) && Ended(&cmds[1], AT_RESULT_OK) &&
+          urcs[AT_URC_CONNECT] == 2 && urc_link[AT_URC_CONNECT] == 1, "connect links 0 and 1");
+
+    Send(0, SMALL, "send 300 bytes on link 0");
+    Send(1, LARGE, "send 2000 bytes on link 1");
+
+    for (uint8_t i = 0; i < BURST; i++) {
+        Queue(&cmds[i], "AT+CIPSTATUS", true, 1000, NULL);
+    }
+    Run();
+    bool burst = true;
+    for (uint8_t i = 0; i < BURST; i++) {
+        burst = burst && Ended(&cmds[i], AT_RESULT_OK) && cmds[i].lines == 3;
+    }
+    Check(burst, "pipelined status burst");
+
+    Queue(&cmds[0], "AT+NOSUCH", false, 1000, NULL);
+    Queue(&cmds[1], "AT+TESTHANG", false, 200, NULL);
+    Queue(&cmds[2], "AT", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_ERROR), "unknown command, ERROR");
+    Check(Ended(&cmds[1], AT_RESULT_TIMEOUT), "no answer, timeout");
+    Check(Ended(&cmds[2], AT_RESULT_OK), "next command after the timeout");
+
+    Queue(&cmds[0], "AT+CIPCLOSE=0", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK) && urcs[AT_URC_CLOSED] == 1 &&
+          urc_link[AT_URC_CLOSED] == 0, "close link 0");
+
+    /* Transparent mode needs the single connection mode */
+    Queue(&cmds[0], "AT+CIPCLOSE=1", false, 1000, NULL);
+    Queue(&cmds[1], "AT+CIPMUX=0", false, 1000, NULL);
+    Queue(&cmds[2], "AT+CIPSTART=\"TCP\",\"10.0.0.1\",8080", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK) && Ended(&cmds[1], AT_RESULT_OK) &&
+          Ended(&cmds[2], AT_RESULT_OK) && urcs[AT_URC_CONNECT] == 3 &&
+          urc_link[AT_URC_CONNECT] == AT_NO_LINK, "single connection");
+
+    /* "+IPD,<length>,<ip>,<port>:" */
+    Queue(&cmds[0], "AT+CIPDINFO=1", false, 1000, NULL);
+    Run();
+    Check(Ended(&cmds[0], AT_RESULT_OK), "remote address in +IPD");
+    Send(AT_NO_LINK, SMALL, "  send 300 bytes");
+    Stream();
+
+    bool disconnected = false;
+    Queue(&cmds[0], "AT+CWQAP", false, 1000, NULL);
+    Run();
+    for (uint32_t start = PtyMillis(); !disconnected && PtyMillis() - start < 1000; ) {
+        At_Process();
+        Wait();
+        disconnected = urcs[AT_URC_WIFI_DISCONNECT] == 1;
+    }
+    Check(Ended(&cmds[0], AT_RESULT_OK) && disconnected, "leave, WIFI DISCONNECT");
+
+    At_GetStats(&stats);
+    printf("commands %u  errors %u  timeouts %u  resent %u  urcs %u  ipd %u bytes  "
+           "dropped %u  unexpected %u  long %u  stream %u/%u bytes\n", stats.commands, stats.errors,
+           stats.timeouts, stats.resent, stats.urcs, stats.ipdBytes, stats.ipdDropped,
+           stats.unexpected, stats.longLines, stats.streamTx, stats.streamRx);
+    printf("%s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file fft_bench_main.c
+ * @brief Runs the FFT benchmark (Src/fft_bench.c) on the host, with the
+ *        DSP intrinsics from sim_cmsis.h: the fixed-point checksums must
+ *        match the target's, the cycle counts are the counted clock's.
+ *        Pipe stdout into Tools/fft_ref.py.
+ *
+ *   fft_bench
+ */
+
+#include "sim.h"
+#include "uart.h"
+#include "fft.h"
+#include "systick.h"
+
+int main(void) {
+    Sim_Config config;
+
+    Sim_DefaultConfig(&config);
+    config.timeScale = 0.0;
+    if (Sim_Init(&config) != 0) {
+        return 1;
+    }
+
+    SysTick_Init();
+    UART_Init(115200);
+    Fft_RunBenchmark();
+
+    Sim_Exit(0);
+}
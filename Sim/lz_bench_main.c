@@ -0,0 +1,181 @@
+/**
+ * @file lz_bench_main.c
+ * @brief Runs the LZ compressor and decompressor (Src/lz.c) on files on
+ *        the host: the compressed stream is what the target would send,
+ *        for Tools/lz_codec.py to check, and the host MB/s are reported
+ *        next to the ratio. The target's figures come from 'lzbench'.
+ *
+ *   lz_bench [-w bits] input [-o output.lz] [--repeat n]
+ *   lz_bench -d input.lz [-o output] [--check original]
+ */
+
+#include "lz.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PIECE           64          /* Write and compress sizes, as Lz_Process uses */
+#define MAX_OUTPUT      (64UL << 20)
+
+static uint8_t* ReadFile(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    uint8_t* data;
+
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != *size) {
+        perror(path);
+        exit(1);
+    }
+    fclose(f);
+    return data;
+}
+
+static void WriteFile(const char* path, const uint8_t* data, size_t size) {
+    FILE* f = fopen(path, "wb");
+
+    if (f == NULL || fwrite(data, 1, size, f) != size || fclose(f) != 0) {
+        perror(path);
+        exit(1);
+    }
+}
+
+static double Seconds(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Worst case: every byte a literal, runs cut at PIECE - 1 by the output pieces */
+#define BOUND(len)      ((len) + (len) / (PIECE - 1) + 2 * PIECE)
+
+static size_t Compress(uint8_t windowBits, const uint8_t* in, size_t len, uint8_t* out) {
+    size_t done = 0;
+    size_t size = 0;
+
+    Lz_Init(windowBits);
+    if (len == 0) {
+        Lz_Flush();
+    }
+    for (;;) {
+        if (done < len) {
+            done += Lz_Write(in + done, (uint16_t)((len - done < PIECE) ? len - done : PIECE));
+            if (done == len) {
+                Lz_Flush();
+            }
+        }
+        uint16_t n = Lz_Compress(out + size, PIECE);
+        size += n;
+        if (done == len && n == 0 && Lz_IsIdle()) {
+            return size;
+        }
+    }
+}
+
+/* Fed in uneven pieces so tokens split across calls */
+static Lz_Error Decompress(const uint8_t* in, size_t size, uint8_t* out, size_t capacity) {
+    Lz_Error result = LZ_OK;
+
+    Lz_DecodeStart(out, (uint32_t)capacity);
+    for (size_t at = 0, piece = 1; at < size && result == LZ_OK; at += piece, piece = piece % 61 + 7) {
+        if (piece > size - at) {
+            piece = size - at;
+        }
+        result = Lz_Decode(in + at, (uint32_t)piece);
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    const char* in_path = NULL;
+    const char* out_path = NULL;
+    const char* check_path = NULL;
+    unsigned long bits = 10;
+    unsigned long repeat = 20;
+    int decompress = 0;
+    size_t len, size;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            bits = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            decompress = 1;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            check_path = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-' && in_path == NULL) {
+            in_path = argv[i];
+        } else {
+            in_path = NULL;
+            break;
+        }
+    }
+    if (in_path == NULL || repeat == 0) {
+        fprintf(stderr, "usage: %s [-w bits] input [-o output.lz] [--repeat n]\n"
+                "       %s -d input.lz [-o output] [--check original]\n", argv[0], argv[0]);
+        return 2;
+    }
+    uint8_t* in = ReadFile(in_path, &len);
+
+    if (decompress) {
+        uint8_t* out = malloc(MAX_OUTPUT);
+        Lz_Error result = Decompress(in, len, out, MAX_OUTPUT);
+        size = Lz_DecodedSize();
+        if (result != LZ_OK) {
+            fprintf(stderr, "%s: error %d after %zu bytes out\n", in_path, result, size);
+            return 1;
+        }
+        if (out_path != NULL) {
+            WriteFile(out_path, out, size);
+        }
+        printf("%s: %zu bytes -> %zu\n", in_path, len, size);
+        if (check_path != NULL) {
+            size_t expected_len;
+            uint8_t* expected = ReadFile(check_path, &expected_len);
+            int same = expected_len == size && memcmp(expected, out, size) == 0;
+            printf("  %s %s\n", same ? "matches" : "DIFFERS FROM", check_path);
+            return same ? 0 : 1;
+        }
+        return 0;
+    }
+
+    if (Lz_Init((uint8_t)bits) != LZ_OK) {
+        fprintf(stderr, "window bits must be %d to %d\n", LZ_MIN_WINDOW_BITS, LZ_MAX_WINDOW_BITS);
+        return 2;
+    }
+    uint8_t* out = malloc(BOUND(len));
+    double start = Seconds();
+    for (unsigned long r = 0; r < repeat; r++) {
+        size = Compress((uint8_t)bits, in, len, out);
+    }
+    double compress = (Seconds() - start) / (double)repeat;
+
+    uint8_t* back = malloc(len + 1);
+    Lz_Error result = LZ_OK;
+    start = Seconds();
+    for (unsigned long r = 0; r < repeat && result == LZ_OK; r++) {
+        result = Decompress(out, size, back, len);
+    }
+    double decompress_s = (Seconds() - start) / (double)repeat;
+    int same = result == LZ_OK && Lz_DecodedSize() == len && memcmp(in, back, len) == 0;
+
+    if (out_path != NULL) {
+        WriteFile(out_path, out, size);
+    }
+    printf("%s: %zu bytes -> %zu with a %lu-byte window, ratio %.2f\n", in_path, len, size,
+           1UL << bits, size ? (double)len / (double)size : 0.0);
+    printf("  host: compress %.1f MB/s, decompress %.1f MB/s, round trip %s\n",
+           (double)len / compress / 1e6, (double)len / decompress_s / 1e6, same ? "ok" : "FAILED");
+    return same ? 0 : 1;
+}
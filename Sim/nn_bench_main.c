@@ -0,0 +1,30 @@
+/**
+ * @file nn_bench_main.c
+ * @brief Runs the int8 inference benchmark (Src/nn_bench.c) on the
+ *        host, with the SIMD intrinsics from sim_cmsis.h: the layer
+ *        checksums must match the target's, the cycle counts are the
+ *        counted clock's. Pipe stdout into Tools/nn_ref.py.
+ *
+ *   nn_bench
+ */
+
+#include "sim.h"
+#include "uart.h"
+#include "nn.h"
+#include "systick.h"
+
+int main(void) {
+    Sim_Config config;
+
+    Sim_DefaultConfig(&config);
+    config.timeScale = 0.0;
+    if (Sim_Init(&config) != 0) {
+        return 1;
+    }
+
+    SysTick_Init();
+    UART_Init(115200);
+    Nn_RunBenchmark();
+
+    Sim_Exit(0);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file sim.h
+ * @brief Host simulation of the STM32F429 peripherals used by the drivers
+ *
+ * The peripheral address ranges are mapped at their real addresses, so the
+ * unmodified driver sources talk to plain memory. Pages holding modelled
+ * registers (USART3, DMA1/2, SysTick/NVIC/SCB, DWT) are kept inaccessible: every
+ * access faults, the model brings the register up to the current simulated
+ * time, lets the instruction complete, then applies its side effects.
+ * RCC and GPIO are plain memory. Interrupts are delivered by calling the
+ * firmware handlers from a periodic host timer signal.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The simulated core runs at the reset HSI clock like the firmware assumes */
+#define SIM_CPU_HZ          16000000UL
+
+/* Bytes waiting to be shifted into the USART3 receiver */
+#define SIM_RX_QUEUE_SIZE   65536
+
+typedef struct {
+    double timeScale;       /* Simulated seconds per host second (1.0 = real time),
+                             * 0 = counted clock: a fixed cost per register access
+                             * and per idle timer tick, independent of the host */
+    uint32_t timeLimitMs;   /* Exit after this much simulated time, 0 = run forever */
+    uint32_t timerUs;       /* Host period of the interrupt delivery timer */
+    int txFd;               /* USART3 output is written here, -1 to discard */
+    uint32_t remoteBaud;    /* Baud rate of the virtual device on the other end */
+    int loopback;           /* TX wired to RX, like a PD8-PD9 jumper */
+} Sim_Config;
+
+typedef struct {
+    uint64_t registerAccesses;  /* Trapped accesses to modelled registers */
+    uint64_t interrupts;        /* Handler invocations, SysTick included */
+    uint32_t uartTxBytes;       /* Bytes that left the TX shift register */
+    uint32_t uartRxBytes;       /* Bytes that reached DR */
+    uint32_t uartRxOverruns;    /* Bytes lost because RXNE was still set (ORE) */
+    uint32_t uartRxFramingErrors; /* Bytes received with a baud mismatch (FE) */
+} Sim_Stats;
+
+typedef void (*Sim_IrqHandler)(void);
+typedef void (*Sim_TxHook)(uint8_t byte, uint64_t timeNs);
+
+/**
+ * @brief Fill a configuration with the defaults: real time, no limit,
+ *        50 us timer, TX to stdout, remote end at 115200 baud, no loopback
+ * @param config: Configuration to fill
+ * @return None
+ */
+void Sim_DefaultConfig(Sim_Config* config);
+
+/**
+ * @brief Map the peripherals, reset the models and start simulated time.
+ *        Must run before any driver code touches a register.
+ * @param config: Configuration, NULL for the defaults
+ * @return 0 on success, -1 if the address ranges could not be mapped
+ */
+int Sim_Init(const Sim_Config* config);
+
+/**
+ * @brief Simulated time since Sim_Init
+ * @return Nanoseconds
+ */
+uint64_t Sim_Now(void);
+
+/**
+ * @brief Simulated core cycles since Sim_Init, the clock behind DWT->CYCCNT
+ * @return Cycles at SIM_CPU_HZ
+ */
+uint64_t Sim_Cycles(void);
+
+/**
+ * @brief Replace the handler called for an interrupt; by default the
+ *        firmware's handlers are called (SysTick_Handler, USART3_IRQHandler,
+ *        DMA1_Stream3_IRQHandler...) when they are linked in
+ * @param irq: IRQn_Type value (SysTick_IRQn or a device interrupt)
+ * @param handler: Function to call, NULL to ignore the interrupt
+ * @return None
+ */
+void Sim_SetIrqHandler(int irq, Sim_IrqHandler handler);
+
+/**
+ * @brief Queue bytes for the remote end to send to USART3. They arrive
+ *        back to back, one frame time apart at the remote baud rate.
+ * @param data: Bytes to send
+ * @param length: Number of bytes
+ * @return Number of bytes queued (less than length if the queue is full)
+ */
+size_t Sim_UartInject(const uint8_t* data, size_t length);
+
+/**
+ * @brief Change the remote baud rate; frames received at a rate more than
+ *        3% away from the USART3 setting are flagged with FE
+ * @param baud: New remote baud rate
+ * @return None
+ */
+void Sim_UartSetRemoteBaud(uint32_t baud);
+
+/**
+ * @brief Wire USART3 TX back to its own RX; each byte arrives as its stop
+ *        bit ends, in addition to anything injected
+ * @param enable: 1 to connect, 0 to disconnect
+ * @return None
+ */
+void Sim_UartSetLoopback(int enable);
+
+/**
+ * @brief Bytes queued by Sim_UartInject that have not arrived yet
+ * @return Byte count
+ */
+size_t Sim_UartRxPending(void);
+
+/**
+ * @brief Call a function for every transmitted byte, with the simulated time
+ *        its stop bit finished; runs in signal context
+ * @param hook: Function to call, NULL to remove
+ * @return None
+ */
+void Sim_UartSetTxHook(Sim_TxHook hook);
+
+/**
+ * @brief Copy the simulation counters
+ * @param stats: Destination
+ * @return None
+ */
+void Sim_GetStats(Sim_Stats* stats);
+
+/**
+ * @brief Stop the interrupt timer and exit the process
+ * @param code: Exit status
+ * @return Does not return
+ */
+void Sim_Exit(int code) __attribute__((noreturn));
+
+#endif /* SIM_H */
@@ -0,0 +1,153 @@
+/**
+ * @file sim_cmsis.h
+ * @brief Forced include (-include) for the host build: replaces the CMSIS
+ *        core intrinsics that are ARM instructions with calls into the
+ *        simulator, so the firmware sources compile unchanged on the host.
+ */
+
+#ifndef SIM_CMSIS_H
+#define SIM_CMSIS_H
+
+#include <stdint.h>
+
+/* Park the ARM inline-asm versions under other names; they are static
+ * inline and never called, so they are never emitted */
+#define __enable_irq    cmsis_arm_enable_irq
+#define __disable_irq   cmsis_arm_disable_irq
+#define __get_PRIMASK   cmsis_arm_get_PRIMASK
+#define __set_PRIMASK   cmsis_arm_set_PRIMASK
+#define __get_IPSR      cmsis_arm_get_IPSR
+#define __get_MSP       cmsis_arm_get_MSP
+#define __set_MSP       cmsis_arm_set_MSP
+#define __ISB           cmsis_arm_ISB
+#define __DSB           cmsis_arm_DSB
+#define __DMB           cmsis_arm_DMB
+#define __LDREXB        cmsis_arm_LDREXB
+#define __LDREXH        cmsis_arm_LDREXH
+#define __LDREXW        cmsis_arm_LDREXW
+#define __STREXB        cmsis_arm_STREXB
+#define __STREXH        cmsis_arm_STREXH
+#define __STREXW        cmsis_arm_STREXW
+#define __CLREX         cmsis_arm_CLREX
+
+#include "cmsis_gcc.h"
+
+#undef __enable_irq
+#undef __disable_irq
+#undef __get_PRIMASK
+#undef __set_PRIMASK
+#undef __get_IPSR
+#undef __get_MSP
+#undef __set_MSP
+#undef __ISB
+#undef __DSB
+#undef __DMB
+#undef __LDREXB
+#undef __LDREXH
+#undef __LDREXW
+#undef __STREXB
+#undef __STREXH
+#undef __STREXW
+#undef __CLREX
+
+/* These are macros around single instructions in cmsis_gcc.h */
+#undef __NOP
+#undef __WFI
+#undef __WFE
+#undef __SEV
+#undef __BKPT
+
+/* Implemented in sim_core.c */
+void Sim_EnableIrq(void);
+void Sim_DisableIrq(void);
+uint32_t Sim_GetPrimask(void);
+void Sim_SetPrimask(uint32_t primask);
+uint32_t Sim_GetIpsr(void);
+void Sim_WaitForInterrupt(void);
+void Sim_Breakpoint(void);
+uint32_t Sim_LoadExclusive(volatile void* addr, uint32_t size);
+uint32_t Sim_StoreExclusive(uint32_t value, volatile void* addr, uint32_t size);
+void Sim_ClearExclusive(void);
+
+#define __enable_irq()          Sim_EnableIrq()
+#define __disable_irq()         Sim_DisableIrq()
+#define __get_PRIMASK()         Sim_GetPrimask()
+#define __set_PRIMASK(x)        Sim_SetPrimask(x)
+#define __get_IPSR()            Sim_GetIpsr()
+#define __get_MSP()             ((uint32_t)(uintptr_t)__builtin_frame_address(0))
+#define __set_MSP(x)            ((void)(x))
+#define __ISB()                 __sync_synchronize()
+#define __DSB()                 __sync_synchronize()
+#define __DMB()                 __sync_synchronize()
+#define __NOP()                 __asm volatile ("nop")
+#define __WFI()                 Sim_WaitForInterrupt()
+#define __WFE()                 Sim_WaitForInterrupt()
+#define __SEV()                 ((void)0)
+#define __BKPT(value)           Sim_Breakpoint()
+#define __LDREXB(p)             ((uint8_t)Sim_LoadExclusive((p), 1))
+#define __LDREXH(p)             ((uint16_t)Sim_LoadExclusive((p), 2))
+#define __LDREXW(p)             Sim_LoadExclusive((p), 4)
+#define __STREXB(v, p)          Sim_StoreExclusive((v), (p), 1)
+#define __STREXH(v, p)          Sim_StoreExclusive((v), (p), 2)
+#define __STREXW(v, p)          Sim_StoreExclusive((v), (p), 4)
+#define __CLREX()               Sim_ClearExclusive()
+
+/* The SIMD (DSP extension) block of cmsis_gcc.h is compiled out on the
+ * host; these stand in for the instructions the firmware uses, with the
+ * same results */
+static inline uint64_t Sim_Smlald(uint32_t op1, uint32_t op2, uint64_t acc) {
+    int64_t sum = (int64_t)(int16_t)op1 * (int16_t)op2 +
+                  (int64_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return acc + (uint64_t)sum;
+}
+
+static inline uint32_t Sim_Halving(int32_t lo, int32_t hi) {
+    return ((uint32_t)(lo >> 1) & 0xFFFFU) | ((uint32_t)(hi >> 1) << 16);
+}
+
+#define SIM_LO(x)               ((int32_t)(int16_t)(x))
+#define SIM_HI(x)               ((int32_t)(int16_t)((x) >> 16))
+
+/* The APSR.GE lane flags as a byte mask, set by SSUB16/SSUB8 for SEL */
+static uint32_t sim_ge;
+
+static inline uint32_t Sim_Ssub16(uint32_t op1, uint32_t op2) {
+    int32_t lo = SIM_LO(op1) - SIM_LO(op2);
+    int32_t hi = SIM_HI(op1) - SIM_HI(op2);
+    sim_ge = ((lo >= 0) ? 0x0000FFFFUL : 0) | ((hi >= 0) ? 0xFFFF0000UL : 0);
+    return ((uint32_t)lo & 0xFFFFU) | ((uint32_t)hi << 16);
+}
+
+static inline uint32_t Sim_Ssub8(uint32_t op1, uint32_t op2) {
+    uint32_t result = 0;
+    sim_ge = 0;
+    for (uint32_t lane = 0; lane < 32U; lane += 8U) {
+        int32_t diff = (int8_t)(op1 >> lane) - (int8_t)(op2 >> lane);
+        sim_ge |= (diff >= 0) ? 0xFFUL << lane : 0;
+        result |= ((uint32_t)diff & 0xFFU) << lane;
+    }
+    return result;
+}
+
+static inline uint32_t Sim_Sel(uint32_t op1, uint32_t op2) {
+    return (op1 & sim_ge) | (op2 & ~sim_ge);
+}
+
+#define __SMLALD(op1, op2, acc) Sim_Smlald((op1), (op2), (acc))
+#define __SMUAD(op1, op2)       ((uint32_t)(SIM_LO(op1) * SIM_LO(op2) + SIM_HI(op1) * SIM_HI(op2)))
+#define __SMUSDX(op1, op2)      ((uint32_t)(SIM_LO(op1) * SIM_HI(op2) - SIM_HI(op1) * SIM_LO(op2)))
+#define __SHADD16(op1, op2)     Sim_Halving(SIM_LO(op1) + SIM_LO(op2), SIM_HI(op1) + SIM_HI(op2))
+#define __SHSUB16(op1, op2)     Sim_Halving(SIM_LO(op1) - SIM_LO(op2), SIM_HI(op1) - SIM_HI(op2))
+#define __SHASX(op1, op2)       Sim_Halving(SIM_LO(op1) - SIM_HI(op2), SIM_HI(op1) + SIM_LO(op2))
+#define __SHSAX(op1, op2)       Sim_Halving(SIM_LO(op1) + SIM_HI(op2), SIM_HI(op1) - SIM_LO(op2))
+#define __SSUB16(op1, op2)      Sim_Ssub16((op1), (op2))
+#define __SSUB8(op1, op2)       Sim_Ssub8((op1), (op2))
+#define __SEL(op1, op2)         Sim_Sel((op1), (op2))
+#define __SXTB16(op1)           ((((uint32_t)(int8_t)(op1)) & 0xFFFFU) | \
+                                 ((uint32_t)(int8_t)((op1) >> 16) << 16))
+#define __SMLAD(op1, op2, acc)  ((uint32_t)(SIM_LO(op1) * SIM_LO(op2) + SIM_HI(op1) * SIM_HI(op2) + \
+                                            (int32_t)(acc)))
+#define __PKHBT(op1, op2, shift) ((((uint32_t)(op1)) & 0x0000FFFFUL) | \
+                                  (((uint32_t)(op2) << (shift)) & 0xFFFF0000UL))
+
+#endif /* SIM_CMSIS_H */
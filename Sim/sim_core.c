@@ -0,0 +1,639 @@
+/**
+ * @file sim_core.c
+ * @brief Address space, access trapping, simulated time and interrupt
+ *        delivery for the host simulation
+ *
+ * An access to a trapped page raises SIGSEGV. The handler runs the models
+ * up to now, lets the device refresh the register, makes the page
+ * accessible and sets the x86 trap flag. The faulting instruction then
+ * completes against the real memory and SIGTRAP fires right after it,
+ * where the device applies the side effects and the page is locked again.
+ * The timer signal is held off between the two so no interrupt handler
+ * can run in the middle of an access.
+ */
+
+#include "sim_internal.h"
+#include "stm32f4xx.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#define SIM_PAGE_SIZE       4096U
+#define SIM_EFLAGS_TF       0x100
+#define SIM_PF_WRITE        0x2
+#define SIM_IRQ_LINES       91
+
+/* Simulated cost of one register access in a handler or critical section,
+ * roughly a peripheral bus access plus the surrounding instructions */
+#define SIM_ACCESS_CYCLES   16U
+
+/* Counted clock: after this many timer ticks in a row without a register
+ * access the firmware is taken to be spinning on RAM (ring indices, the tick
+ * counter) and time skips to the next device event, at least
+ * SIM_IDLE_CYCLES. Fewer are as likely the host descheduling us. */
+#define SIM_IDLE_TICKS      3U
+#define SIM_IDLE_CYCLES     160U
+
+/* Address ranges the firmware can touch: APB1/APB2/AHB1 and the private
+ * peripheral bus (SysTick, NVIC, SCB, DWT) */
+typedef struct {
+    uint32_t base;
+    uint32_t size;
+    uint8_t* shadow;        /* Second mapping used by the models */
+} Sim_Region;
+
+static Sim_Region regions[] = {
+    { 0x40000000U, 0x00080000U, NULL },
+    { 0xE0000000U, 0x00100000U, NULL }
+};
+
+#define SIM_REGION_COUNT    (sizeof(regions) / sizeof(regions[0]))
+
+/* Access in flight between SIGSEGV and SIGTRAP */
+static struct {
+    int active;
+    uintptr_t page;
+    const Sim_Device* device;
+    uint32_t offset;
+    int isWrite;
+    uint32_t old;
+    int unblockTimer;
+} trap;
+
+static Sim_Device devices[SIM_MAX_DEVICES];
+static int device_count = 0;
+
+static Sim_Config config;
+static struct timespec start_time;
+static volatile uint64_t model_cycles = 0;
+static volatile uint64_t counted_cycles = 0;
+static uint64_t idle_mark = 0;
+static uint32_t idle_ticks = 0;
+static sigset_t timer_set;
+
+/* Firmware-visible core state */
+static volatile uint32_t sim_primask = 0;
+static volatile uint32_t sim_ipsr = 0;
+static volatile int sim_exclusive = 0;
+static volatile int dispatch_again = 0;
+
+static Sim_IrqHandler handlers[16 + SIM_IRQ_LINES];
+static int (*irq_levels[SIM_IRQ_LINES])(int irq);
+
+static volatile uint64_t sim_interrupts = 0;
+volatile uint64_t sim_register_accesses = 0;
+
+/* The firmware's handlers when linked in, as in the startup vector table */
+#define SIM_WEAK_HANDLER(name) extern void name(void) __attribute__((weak))
+SIM_WEAK_HANDLER(SysTick_Handler);
+SIM_WEAK_HANDLER(PendSV_Handler);
+SIM_WEAK_HANDLER(USART3_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream0_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream1_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream2_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream3_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream4_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream5_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream6_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Stream7_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream0_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream1_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream2_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream3_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream4_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream5_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream6_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Stream7_IRQHandler);
+
+static const struct {
+    int irq;
+    Sim_IrqHandler handler;
+} default_handlers[] = {
+    { SysTick_IRQn, SysTick_Handler },
+    { PendSV_IRQn, PendSV_Handler },
+    { USART3_IRQn, USART3_IRQHandler },
+    { DMA1_Stream0_IRQn, DMA1_Stream0_IRQHandler },
+    { DMA1_Stream1_IRQn, DMA1_Stream1_IRQHandler },
+    { DMA1_Stream2_IRQn, DMA1_Stream2_IRQHandler },
+    { DMA1_Stream3_IRQn, DMA1_Stream3_IRQHandler },
+    { DMA1_Stream4_IRQn, DMA1_Stream4_IRQHandler },
+    { DMA1_Stream5_IRQn, DMA1_Stream5_IRQHandler },
+    { DMA1_Stream6_IRQn, DMA1_Stream6_IRQHandler },
+    { DMA1_Stream7_IRQn, DMA1_Stream7_IRQHandler },
+    { DMA2_Stream0_IRQn, DMA2_Stream0_IRQHandler },
+    { DMA2_Stream1_IRQn, DMA2_Stream1_IRQHandler },
+    { DMA2_Stream2_IRQn, DMA2_Stream2_IRQHandler },
+    { DMA2_Stream3_IRQn, DMA2_Stream3_IRQHandler },
+    { DMA2_Stream4_IRQn, DMA2_Stream4_IRQHandler },
+    { DMA2_Stream5_IRQn, DMA2_Stream5_IRQHandler },
+    { DMA2_Stream6_IRQn, DMA2_Stream6_IRQHandler },
+    { DMA2_Stream7_IRQn, DMA2_Stream7_IRQHandler }
+};
+
+void Sim_DefaultConfig(Sim_Config* cfg) {
+    cfg->timeScale = 1.0;
+    cfg->timeLimitMs = 0;
+    cfg->timerUs = 50;
+    cfg->txFd = STDOUT_FILENO;
+    cfg->remoteBaud = 115200;
+    cfg->loopback = 0;
+}
+
+static Sim_Region* Sim_FindRegion(uintptr_t addr) {
+    for (size_t i = 0; i < SIM_REGION_COUNT; i++) {
+        if (addr >= regions[i].base && addr - regions[i].base < regions[i].size) {
+            return &regions[i];
+        }
+    }
+    return NULL;
+}
+
+static const Sim_Device* Sim_FindDevice(uint32_t addr) {
+    for (int i = 0; i < device_count; i++) {
+        if (addr >= devices[i].base && addr - devices[i].base < devices[i].size) {
+            return &devices[i];
+        }
+    }
+    return NULL;
+}
+
+volatile uint32_t* Sim_Reg(uint32_t addr) {
+    Sim_Region* region = Sim_FindRegion(addr);
+    if (region == NULL) {
+        abort();
+    }
+    return (volatile uint32_t*)(region->shadow + ((addr & ~3U) - region->base));
+}
+
+void Sim_RegisterDevice(const Sim_Device* device) {
+    if (device_count >= SIM_MAX_DEVICES) {
+        abort();
+    }
+    devices[device_count++] = *device;
+
+    Sim_SetIrqSource(device->irq, device->irqLevel);
+
+    /* Lock every page the block touches */
+    uint32_t first = device->base & ~(SIM_PAGE_SIZE - 1);
+    uint32_t end = device->base + device->size;
+    for (uint32_t page = first; page < end; page += SIM_PAGE_SIZE) {
+        mprotect((void*)(uintptr_t)page, SIM_PAGE_SIZE, PROT_NONE);
+    }
+}
+
+void Sim_SetIrqSource(int irq, int (*level)(int irq)) {
+    if (irq >= 0 && irq < SIM_IRQ_LINES) {
+        irq_levels[irq] = level;
+    }
+}
+
+/* Time */
+
+/* Where simulated time should be now: derived from the host clock, or with
+ * a time scale of 0 from the counted clock, which only moves with register
+ * accesses and idle ticks and so repeats exactly from run to run */
+static uint64_t Sim_TargetCycles(void) {
+    struct timespec now;
+
+    if (config.timeScale == 0.0) {
+        return counted_cycles;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    double seconds = (double)(now.tv_sec - start_time.tv_sec) +
+                     (double)(now.tv_nsec - start_time.tv_nsec) * 1e-9;
+    return (uint64_t)(seconds * config.timeScale * (double)SIM_CPU_HZ);
+}
+
+uint64_t Sim_ModelCycles(void) {
+    return model_cycles;
+}
+
+uint64_t Sim_Cycles(void) {
+    return model_cycles;
+}
+
+uint64_t Sim_Now(void) {
+    return (uint64_t)((double)model_cycles * (1e9 / (double)SIM_CPU_HZ));
+}
+
+/* Interrupt delivery */
+
+void Sim_SetIrqHandler(int irq, Sim_IrqHandler handler) {
+    if (irq >= -16 && irq < SIM_IRQ_LINES) {
+        handlers[irq + 16] = handler;
+    }
+}
+
+/* Returns the next interrupt to take, lowest exception number first like
+ * equal-priority interrupts on the NVIC, or SIM_NO_IRQ */
+static int Sim_NextIrq(void) {
+    if (handlers[SysTick_IRQn + 16] != NULL && Sim_NvicTakePending(SysTick_IRQn)) {
+        return SysTick_IRQn;
+    }
+
+    for (int irq = 0; irq < SIM_IRQ_LINES; irq++) {
+        if (handlers[irq + 16] == NULL || !Sim_NvicIsEnabled(irq)) {
+            continue;
+        }
+        if (Sim_NvicTakePending(irq) || (irq_levels[irq] != NULL && irq_levels[irq](irq))) {
+            return irq;
+        }
+    }
+
+    if (handlers[PendSV_IRQn + 16] != NULL && Sim_NvicTakePending(PendSV_IRQn)) {
+        return PendSV_IRQn;
+    }
+    return SIM_NO_IRQ;
+}
+
+/* Whether a dispatch would call anything, without taking pending bits */
+static int Sim_IrqReady(void) {
+    if ((handlers[SysTick_IRQn + 16] != NULL && Sim_NvicIsPending(SysTick_IRQn)) ||
+        (handlers[PendSV_IRQn + 16] != NULL && Sim_NvicIsPending(PendSV_IRQn))) {
+        return 1;
+    }
+    for (int irq = 0; irq < SIM_IRQ_LINES; irq++) {
+        if (handlers[irq + 16] == NULL || !Sim_NvicIsEnabled(irq)) {
+            continue;
+        }
+        if (Sim_NvicIsPending(irq) || (irq_levels[irq] != NULL && irq_levels[irq](irq))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Whether an interrupt that becomes ready could be taken right away. Inside
+ * a handler it cannot, and stopping time there would stall a handler that
+ * polls a flag, so only thread mode with interrupts unmasked stops. */
+static int Sim_CanTakeIrq(void) {
+    return sim_primask == 0 && sim_ipsr == 0;
+}
+
+/* Run the models event by event up to the host clock. Stops early at the
+ * first event that leaves an interrupt ready when stopAtIrq is set, so the
+ * handler runs before the next event (a byte arriving while RXNE is still
+ * set) instead of finding both at once.
+ * Where interrupts cannot be taken each register access moves the models
+ * by a fixed SIM_ACCESS_CYCLES instead: the host timer period, signal
+ * overhead and scheduling jitter would otherwise show up as overruns no
+ * real handler or critical section would cause. The backlog is worked off
+ * event by event once interrupts can be taken again. */
+static uint64_t Sim_NextEvent(uint64_t limit) {
+    uint64_t next = limit;
+
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].nextEvent != NULL) {
+            uint64_t event = devices[i].nextEvent();
+            if (event > model_cycles && event < next) {
+                next = event;
+            }
+        }
+    }
+    return next;
+}
+
+static void Sim_Advance(int stopAtIrq) {
+    uint64_t target = Sim_TargetCycles();
+
+    if (!stopAtIrq && model_cycles + SIM_ACCESS_CYCLES < target) {
+        target = model_cycles + SIM_ACCESS_CYCLES;
+    }
+
+    while (model_cycles < target) {
+        uint64_t next = Sim_NextEvent(target);
+
+        model_cycles = next;
+        for (int i = 0; i < device_count; i++) {
+            if (devices[i].advance != NULL) {
+                devices[i].advance(next);
+            }
+        }
+
+        if (stopAtIrq && Sim_IrqReady()) {
+            break;
+        }
+    }
+}
+
+void Sim_Poke(void) {
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].advance != NULL) {
+            devices[i].advance(model_cycles);
+        }
+    }
+}
+
+static void Sim_CallHandler(int irq) {
+    uint32_t savedIpsr = sim_ipsr;
+    uint32_t savedPrimask = sim_primask;
+
+    /* Exception entry clears the exclusive monitor */
+    sim_exclusive = 0;
+    sim_ipsr = (uint32_t)(irq + 16);
+    sim_primask = 0;
+    sim_interrupts++;
+
+    handlers[irq + 16]();
+
+    sim_ipsr = savedIpsr;
+    sim_primask = savedPrimask;
+}
+
+static void Sim_CheckLimit(void) {
+    if (config.timeLimitMs != 0 &&
+        model_cycles >= (uint64_t)config.timeLimitMs * (SIM_CPU_HZ / 1000)) {
+        Sim_Exit(0);
+    }
+}
+
+static void Sim_Dispatch(void) {
+    uint64_t target = Sim_TargetCycles();
+
+    do {
+        dispatch_again = 0;
+
+        int irq;
+        while ((irq = Sim_NextIrq()) != SIM_NO_IRQ) {
+            Sim_CallHandler(irq);
+        }
+        Sim_CheckLimit();
+
+        Sim_Advance(1);
+    } while (dispatch_again || model_cycles < target || Sim_IrqReady());
+}
+
+void Sim_RequestDispatch(void) {
+    /* Stays pending until the timer signal is unblocked */
+    raise(SIGALRM);
+}
+
+static void Sim_OnTimer(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    (void)info;
+    (void)context;
+
+    if (sim_register_accesses != idle_mark) {
+        idle_ticks = 0;
+    } else if (++idle_ticks >= SIM_IDLE_TICKS) {
+        uint64_t least = counted_cycles + SIM_IDLE_CYCLES;
+        uint64_t event = Sim_NextEvent(UINT64_MAX);
+        counted_cycles = (event != UINT64_MAX && event > least) ? event : least;
+    }
+    idle_mark = sim_register_accesses;
+
+    /* A handler that re-enabled interrupts; no preemption at equal priority */
+    if (sim_ipsr != 0) {
+        dispatch_again = 1;
+        return;
+    }
+
+    Sim_Dispatch();
+}
+
+/* Access trapping */
+
+static void Sim_OnFault(int sig, siginfo_t* info, void* context) {
+    ucontext_t* uc = (ucontext_t*)context;
+    uintptr_t addr = (uintptr_t)info->si_addr;
+
+    if (trap.active || Sim_FindRegion(addr) == NULL) {
+        /* A real crash: fault again with the default action */
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    uint32_t target = (uint32_t)addr & ~3U;
+    const Sim_Device* device = Sim_FindDevice(target);
+
+    trap.active = 1;
+    trap.page = addr & ~(uintptr_t)(SIM_PAGE_SIZE - 1);
+    trap.device = device;
+    trap.isWrite = (uc->uc_mcontext.gregs[REG_ERR] & SIM_PF_WRITE) != 0;
+    trap.old = *Sim_Reg(target);
+    trap.unblockTimer = !sigismember(&uc->uc_sigmask, SIGALRM);
+    counted_cycles += SIM_ACCESS_CYCLES;
+
+    Sim_Advance(trap.unblockTimer && Sim_CanTakeIrq());
+    if (device != NULL) {
+        trap.offset = target - device->base;
+        if (device->preAccess != NULL) {
+            device->preAccess(trap.offset, trap.isWrite);
+        }
+        trap.old = *Sim_Reg(target);
+    }
+
+    mprotect((void*)trap.page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    sigaddset(&uc->uc_sigmask, SIGALRM);
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+    sim_register_accesses++;
+}
+
+static void Sim_OnStep(int sig, siginfo_t* info, void* context) {
+    ucontext_t* uc = (ucontext_t*)context;
+    (void)info;
+
+    if (!trap.active) {
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+    mprotect((void*)trap.page, SIM_PAGE_SIZE, PROT_NONE);
+    trap.active = 0;
+
+    if (trap.device != NULL && trap.device->postAccess != NULL) {
+        trap.device->postAccess(trap.offset, trap.isWrite, trap.old);
+    }
+
+    if (trap.unblockTimer) {
+        sigdelset(&uc->uc_sigmask, SIGALRM);
+        /* The access may have raised an interrupt (e.g. TXEIE set with TXE) */
+        if (Sim_IrqReady()) {
+            Sim_RequestDispatch();
+        }
+    }
+}
+
+/* CMSIS intrinsics, see sim_cmsis.h */
+
+void Sim_DisableIrq(void) {
+    sigprocmask(SIG_BLOCK, &timer_set, NULL);
+    sim_primask = 1;
+}
+
+void Sim_EnableIrq(void) {
+    sim_primask = 0;
+    sigprocmask(SIG_UNBLOCK, &timer_set, NULL);
+}
+
+uint32_t Sim_GetPrimask(void) {
+    return sim_primask;
+}
+
+void Sim_SetPrimask(uint32_t primask) {
+    if (primask & 1U) {
+        Sim_DisableIrq();
+    } else {
+        Sim_EnableIrq();
+    }
+}
+
+uint32_t Sim_GetIpsr(void) {
+    return sim_ipsr;
+}
+
+void Sim_WaitForInterrupt(void) {
+    if (sim_primask || sim_ipsr != 0) {
+        /* Would wake on a pending interrupt without taking it */
+        struct timespec pause = { 0, (long)config.timerUs * 1000L };
+        nanosleep(&pause, NULL);
+        return;
+    }
+
+    sigset_t mask;
+    sigprocmask(SIG_BLOCK, NULL, &mask);
+    sigdelset(&mask, SIGALRM);
+    sigsuspend(&mask);
+}
+
+void Sim_Breakpoint(void) {
+    fprintf(stderr, "sim: breakpoint at %llu ns\n", (unsigned long long)Sim_Now());
+    abort();
+}
+
+uint32_t Sim_LoadExclusive(volatile void* addr, uint32_t size) {
+    sim_exclusive = 1;
+    switch (size) {
+        case 1:  return *(volatile uint8_t*)addr;
+        case 2:  return *(volatile uint16_t*)addr;
+        default: return *(volatile uint32_t*)addr;
+    }
+}
+
+uint32_t Sim_StoreExclusive(uint32_t value, volatile void* addr, uint32_t size) {
+    sigset_t saved;
+    sigprocmask(SIG_BLOCK, &timer_set, &saved);
+
+    /* An interrupt since the load cleared the monitor */
+    uint32_t failed = sim_exclusive ? 0U : 1U;
+    if (!failed) {
+        switch (size) {
+            case 1:  *(volatile uint8_t*)addr = (uint8_t)value; break;
+            case 2:  *(volatile uint16_t*)addr = (uint16_t)value; break;
+            default: *(volatile uint32_t*)addr = value; break;
+        }
+    }
+    sim_exclusive = 0;
+
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    return failed;
+}
+
+void Sim_ClearExclusive(void) {
+    sim_exclusive = 0;
+}
+
+/* Setup */
+
+static int Sim_MapRegion(Sim_Region* region) {
+    int fd = memfd_create("sim-periph", 0);
+    if (fd < 0 || ftruncate(fd, region->size) != 0) {
+        return -1;
+    }
+
+    void* view = mmap((void*)(uintptr_t)region->base, region->size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    if (view != (void*)(uintptr_t)region->base) {
+        return -1;
+    }
+
+    void* shadow = mmap(NULL, region->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shadow == MAP_FAILED) {
+        return -1;
+    }
+
+    region->shadow = (uint8_t*)shadow;
+    return 0;
+}
+
+static void Sim_Handle(int sig, void (*fn)(int, siginfo_t*, void*)) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = fn;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGALRM);
+    sigaction(sig, &sa, NULL);
+}
+
+int Sim_Init(const Sim_Config* cfg) {
+    if (cfg != NULL) {
+        config = *cfg;
+    } else {
+        Sim_DefaultConfig(&config);
+    }
+    if (config.timeScale < 0.0) {
+        config.timeScale = 1.0;
+    }
+    if (config.timerUs == 0) {
+        config.timerUs = 50;
+    }
+
+    for (size_t i = 0; i < SIM_REGION_COUNT; i++) {
+        if (Sim_MapRegion(&regions[i]) != 0) {
+            perror("sim: mapping peripheral space");
+            return -1;
+        }
+    }
+
+    sigemptyset(&timer_set);
+    sigaddset(&timer_set, SIGALRM);
+
+    for (size_t i = 0; i < sizeof(default_handlers) / sizeof(default_handlers[0]); i++) {
+        handlers[default_handlers[i].irq + 16] = default_handlers[i].handler;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    Sim_Handle(SIGSEGV, Sim_OnFault);
+    Sim_Handle(SIGTRAP, Sim_OnStep);
+    Sim_Handle(SIGALRM, Sim_OnTimer);
+
+    Sim_ScsInit();
+    Sim_DmaInit();
+    Sim_UsartInit(&config);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = config.timerUs;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    return 0;
+}
+
+void Sim_GetStats(Sim_Stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->registerAccesses = sim_register_accesses;
+    stats->interrupts = sim_interrupts;
+    Sim_UsartStats(stats);
+}
+
+void Sim_Exit(int code) {
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_REAL, &off, NULL);
+
+    fflush(NULL);
+    _exit(code);
+}
@@ -0,0 +1,270 @@
+/**
+ * @file sim_dma.c
+ * @brief DMA1/DMA2 model: streams move one item per peripheral request
+ *        (Sim_DmaRequest), with NDTR, MINC, circular and double-buffer
+ *        modes, half/complete flags and stream interrupts. Transfers take
+ *        no simulated time.
+ *
+ * Memory addresses in M0AR/M1AR are used as host pointers, so DMA buffers
+ * must live below 4 GB; the Makefile links without PIE so statics do.
+ */
+
+#include "sim_internal.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DMA_CONTROLLERS     2
+#define DMA_STREAMS         8
+#define DMA_STREAM_OFFSET   0x10U
+#define DMA_STREAM_STRIDE   0x18U
+
+/* Stream registers, offsets inside a stream block */
+#define DMA_SCR             0x00U
+#define DMA_SNDTR           0x04U
+#define DMA_SM0AR           0x0CU
+#define DMA_SM1AR           0x10U
+
+/* Flag bits of one stream inside LISR/HISR, shifted by Dma_FlagShift */
+#define DMA_FLAG_FE         0x01U
+#define DMA_FLAG_DME        0x04U
+#define DMA_FLAG_TE         0x08U
+#define DMA_FLAG_HT         0x10U
+#define DMA_FLAG_TC         0x20U
+
+typedef struct {
+    uint16_t remaining;     /* NDTR as the hardware counts it */
+    uint16_t total;         /* NDTR at enable, reloaded in circular mode */
+    uint16_t index;         /* Items moved in the current pass */
+    uint8_t flags;          /* DMA_FLAG_* */
+} Dma_Stream;
+
+typedef struct {
+    uint32_t base;
+    Dma_Stream streams[DMA_STREAMS];
+} Dma_Controller;
+
+static Dma_Controller controllers[DMA_CONTROLLERS] = {
+    { DMA1_BASE, { { 0 } } },
+    { DMA2_BASE, { { 0 } } }
+};
+
+static const int stream_irqs[DMA_CONTROLLERS][DMA_STREAMS] = {
+    { DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+      DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn },
+    { DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+      DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn }
+};
+
+/* Position of a stream's flags in LISR/HISR and the clear registers */
+static const uint8_t flag_shift[4] = { 0U, 6U, 16U, 22U };
+
+static volatile uint32_t* StreamReg(const Dma_Controller* dma, int stream, uint32_t offset) {
+    return Sim_Reg(dma->base + DMA_STREAM_OFFSET + (uint32_t)stream * DMA_STREAM_STRIDE + offset);
+}
+
+static void Dma_Publish(const Dma_Controller* dma) {
+    uint32_t isr[2] = { 0U, 0U };
+
+    for (int s = 0; s < DMA_STREAMS; s++) {
+        isr[s / 4] |= (uint32_t)dma->streams[s].flags << flag_shift[s % 4];
+        *StreamReg(dma, s, DMA_SNDTR) = dma->streams[s].remaining;
+    }
+    *Sim_Reg(dma->base + 0x00U) = isr[0];
+    *Sim_Reg(dma->base + 0x04U) = isr[1];
+}
+
+static void* Dma_Pointer(uint32_t addr) {
+    /* Only meaningful for buffers the host placed below 4 GB */
+    if (addr < 0x10000U) {
+        fprintf(stderr, "sim: DMA to invalid address 0x%08lx\n", (unsigned long)addr);
+        abort();
+    }
+    return (void*)(uintptr_t)addr;
+}
+
+static uint32_t Dma_Load(uint32_t addr, uint32_t size) {
+    void* p = Dma_Pointer(addr);
+    switch (size) {
+        case 1:  return *(volatile uint8_t*)p;
+        case 2:  return *(volatile uint16_t*)p;
+        default: return *(volatile uint32_t*)p;
+    }
+}
+
+static void Dma_Store(uint32_t addr, uint32_t size, uint32_t value) {
+    void* p = Dma_Pointer(addr);
+    switch (size) {
+        case 1:  *(volatile uint8_t*)p = (uint8_t)value; break;
+        case 2:  *(volatile uint16_t*)p = (uint16_t)value; break;
+        default: *(volatile uint32_t*)p = value; break;
+    }
+}
+
+/* Counts one item done; returns 0 once the stream has stopped */
+static int Dma_Step(Dma_Controller* dma, int s) {
+    Dma_Stream* st = &dma->streams[s];
+    volatile uint32_t* cr = StreamReg(dma, s, DMA_SCR);
+
+    st->index++;
+    st->remaining--;
+
+    if (st->remaining == st->total / 2U) {
+        st->flags |= DMA_FLAG_HT;
+    }
+    if (st->remaining != 0) {
+        return 1;
+    }
+
+    st->flags |= DMA_FLAG_TC;
+    if (*cr & (DMA_SxCR_CIRC | DMA_SxCR_DBM)) {
+        st->remaining = st->total;
+        st->index = 0;
+        if (*cr & DMA_SxCR_DBM) {
+            *cr ^= DMA_SxCR_CT;     /* Switch to the other buffer */
+        }
+        return 1;
+    }
+
+    *cr &= ~DMA_SxCR_EN;
+    return 0;
+}
+
+int Sim_DmaRequest(int controller, int stream, uint32_t channel, uint32_t* data) {
+    if (controller < 1 || controller > DMA_CONTROLLERS || stream < 0 || stream >= DMA_STREAMS) {
+        return 0;
+    }
+
+    Dma_Controller* dma = &controllers[controller - 1];
+    Dma_Stream* st = &dma->streams[stream];
+    uint32_t cr = *StreamReg(dma, stream, DMA_SCR);
+
+    if (!(cr & DMA_SxCR_EN) || ((cr & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos) != channel ||
+        st->remaining == 0) {
+        return 0;
+    }
+
+    uint32_t size = 1U << ((cr & DMA_SxCR_MSIZE) >> DMA_SxCR_MSIZE_Pos);
+    uint32_t bank = (cr & DMA_SxCR_CT) ? DMA_SM1AR : DMA_SM0AR;
+    uint32_t addr = *StreamReg(dma, stream, bank);
+    if (cr & DMA_SxCR_MINC) {
+        addr += (uint32_t)st->index * size;
+    }
+
+    if (cr & DMA_SxCR_DIR_0) {
+        *data = Dma_Load(addr, size);       /* Memory to peripheral */
+    } else {
+        Dma_Store(addr, size, *data);       /* Peripheral to memory */
+    }
+
+    Dma_Step(dma, stream);
+    Dma_Publish(dma);
+    return 1;
+}
+
+/* Memory-to-memory streams (DMA2 only) need no requests: run to the end */
+static void Dma_RunMemToMem(Dma_Controller* dma, int s) {
+    volatile uint32_t* cr = StreamReg(dma, s, DMA_SCR);
+    uint32_t size = 1U << ((*cr & DMA_SxCR_MSIZE) >> DMA_SxCR_MSIZE_Pos);
+    uint32_t src = *StreamReg(dma, s, 0x08U);
+    uint32_t dst = *StreamReg(dma, s, DMA_SM0AR);
+
+    do {
+        uint32_t i = dma->streams[s].index;
+        uint32_t value = Dma_Load(src + ((*cr & DMA_SxCR_PINC) ? i * size : 0U), size);
+        Dma_Store(dst + ((*cr & DMA_SxCR_MINC) ? i * size : 0U), size, value);
+    } while (Dma_Step(dma, s));
+}
+
+static Dma_Controller* Dma_Find(uint32_t offset, int* stream) {
+    /* Both controllers share one device spanning DMA1_BASE..DMA2_BASE+0x400 */
+    Dma_Controller* dma = &controllers[offset >= (DMA2_BASE - DMA1_BASE) ? 1 : 0];
+    uint32_t local = offset - (dma->base - DMA1_BASE);
+
+    *stream = -1;
+    if (local >= DMA_STREAM_OFFSET) {
+        *stream = (int)((local - DMA_STREAM_OFFSET) / DMA_STREAM_STRIDE);
+        if (*stream >= DMA_STREAMS) {
+            *stream = -1;
+        }
+    }
+    return dma;
+}
+
+static void Dma_PreAccess(uint32_t offset, int isWrite) {
+    int stream;
+    Dma_Publish(Dma_Find(offset, &stream));
+}
+
+static void Dma_PostAccess(uint32_t offset, int isWrite, uint32_t old) {
+    int stream;
+    Dma_Controller* dma = Dma_Find(offset, &stream);
+    uint32_t local = offset - (dma->base - DMA1_BASE);
+
+    if (!isWrite) {
+        return;
+    }
+
+    if (local == 0x08U || local == 0x0CU) {
+        /* LIFCR/HIFCR: write 1 to clear */
+        uint32_t value = *Sim_Reg(DMA1_BASE + offset);
+        int first = (local == 0x08U) ? 0 : 4;
+        for (int s = 0; s < 4; s++) {
+            dma->streams[first + s].flags &= (uint8_t)~(value >> flag_shift[s]);
+        }
+        *Sim_Reg(DMA1_BASE + offset) = 0;
+    } else if (stream >= 0) {
+        uint32_t reg = (local - DMA_STREAM_OFFSET) % DMA_STREAM_STRIDE;
+        Dma_Stream* st = &dma->streams[stream];
+        uint32_t cr = *StreamReg(dma, stream, DMA_SCR);
+
+        if (reg == DMA_SNDTR) {
+            /* Writable only while the stream is disabled */
+            if (!(cr & DMA_SxCR_EN)) {
+                st->remaining = (uint16_t)*StreamReg(dma, stream, DMA_SNDTR);
+            }
+        } else if (reg == DMA_SCR && (cr & DMA_SxCR_EN) && !(old & DMA_SxCR_EN)) {
+            st->total = st->remaining;
+            st->index = 0;
+            if ((cr & DMA_SxCR_DIR) == DMA_SxCR_DIR_1) {
+                Dma_RunMemToMem(dma, stream);
+            }
+            Dma_Publish(dma);
+            /* A peripheral may already be requesting (TXE with DMAT set) */
+            Sim_Poke();
+        }
+    }
+
+    Dma_Publish(dma);
+}
+
+static int Dma_IrqLevel(int irq) {
+    for (int c = 0; c < DMA_CONTROLLERS; c++) {
+        for (int s = 0; s < DMA_STREAMS; s++) {
+            if (stream_irqs[c][s] != irq) {
+                continue;
+            }
+            uint32_t cr = *StreamReg(&controllers[c], s, DMA_SCR);
+            uint8_t flags = controllers[c].streams[s].flags;
+            return ((cr & DMA_SxCR_TCIE) && (flags & DMA_FLAG_TC)) ||
+                   ((cr & DMA_SxCR_HTIE) && (flags & DMA_FLAG_HT)) ||
+                   ((cr & DMA_SxCR_TEIE) && (flags & DMA_FLAG_TE));
+        }
+    }
+    return 0;
+}
+
+void Sim_DmaInit(void) {
+    static const Sim_Device device = {
+        "DMA", DMA1_BASE, (DMA2_BASE - DMA1_BASE) + 0x400U, SIM_NO_IRQ,
+        Dma_PreAccess, Dma_PostAccess, NULL, NULL, NULL
+    };
+
+    Sim_RegisterDevice(&device);
+
+    for (int c = 0; c < DMA_CONTROLLERS; c++) {
+        for (int s = 0; s < DMA_STREAMS; s++) {
+            Sim_SetIrqSource(stream_irqs[c][s], Dma_IrqLevel);
+        }
+    }
+}
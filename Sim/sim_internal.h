@@ -0,0 +1,73 @@
+/**
+ * @file sim_internal.h
+ * @brief Interface between the simulator core and the peripheral models
+ */
+
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include "sim.h"
+
+#define SIM_MAX_DEVICES     8
+#define SIM_NO_IRQ          (-100)
+
+/* A modelled register block. Hooks run in signal context with the timer
+ * signal blocked; offset is the word-aligned offset into the block. */
+typedef struct {
+    const char* name;
+    uint32_t base;
+    uint32_t size;
+    int irq;                                    /* IRQn_Type, SIM_NO_IRQ if none */
+
+    /* Bring memory up to date before the access (register reads) */
+    void (*preAccess)(uint32_t offset, int isWrite);
+    /* React to the completed access; old is the word before a write */
+    void (*postAccess)(uint32_t offset, int isWrite, uint32_t old);
+    /* Cycle of the next internal event (wrap, end of frame), UINT64_MAX if none */
+    uint64_t (*nextEvent)(void);
+    /* Run the model up to the given cycle count */
+    void (*advance)(uint64_t cycles);
+    /* Level of the interrupt line after advance */
+    int (*irqLevel)(int irq);
+} Sim_Device;
+
+/* Models reach their registers through a second, always writable mapping
+ * of the same memory; the firmware's view at the real address is the one
+ * that traps */
+volatile uint32_t* Sim_Reg(uint32_t addr);
+
+void Sim_RegisterDevice(const Sim_Device* device);
+
+/* Another level-triggered line for a device with several (DMA streams) */
+void Sim_SetIrqSource(int irq, int (*level)(int irq));
+
+/* Let every model react at the current time to a change made by another
+ * one, e.g. a DMA stream being enabled while the USART requests data */
+void Sim_Poke(void);
+/* Time the models have been run up to; lags the host clock while an
+ * interrupt raised by an earlier event waits to be taken */
+uint64_t Sim_ModelCycles(void);
+void Sim_RequestDispatch(void);
+
+/* sim_scs.c */
+void Sim_ScsInit(void);
+int Sim_NvicIsEnabled(int irq);
+int Sim_NvicTakePending(int irq);
+int Sim_NvicIsPending(int irq);
+void Sim_NvicSetPending(int irq);
+
+/* sim_dma.c */
+void Sim_DmaInit(void);
+/* A peripheral request for one data item on controller (1 or 2), stream
+ * and channel. Memory-to-peripheral fills *data, peripheral-to-memory
+ * stores it. Returns 1 if the stream was set up to take the request. */
+int Sim_DmaRequest(int controller, int stream, uint32_t channel, uint32_t* data);
+
+/* sim_usart.c */
+void Sim_UsartInit(const Sim_Config* config);
+void Sim_UsartStats(Sim_Stats* stats);
+
+/* sim_core.c */
+extern volatile uint64_t sim_register_accesses;
+
+#endif /* SIM_INTERNAL_H */
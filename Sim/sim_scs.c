@@ -0,0 +1,297 @@
+/**
+ * @file sim_scs.c
+ * @brief System control space models: SysTick, NVIC enable/pending state,
+ *        SCB interrupt control and the DWT cycle counter
+ */
+
+#include "sim_internal.h"
+#include "stm32f4xx.h"
+
+#define SCS_BASE_ADDR       0xE000E000U
+#define SCS_SYSTICK_CTRL    0x010U
+#define SCS_SYSTICK_LOAD    0x014U
+#define SCS_SYSTICK_VAL     0x018U
+#define SCS_SYSTICK_CALIB   0x01CU
+#define SCS_NVIC_ISER       0x100U
+#define SCS_NVIC_ICER       0x180U
+#define SCS_NVIC_ISPR       0x200U
+#define SCS_NVIC_ICPR       0x280U
+#define SCS_NVIC_WORDS      3U
+#define SCS_SCB_CPUID       0xD00U
+#define SCS_SCB_ICSR        0xD04U
+#define SCS_NVIC_STIR       0xF00U
+
+#define DWT_BASE_ADDR       0xE0001000U
+#define DWT_CTRL_OFFSET     0x000U
+#define DWT_CYCCNT_OFFSET   0x004U
+
+/* Cortex-M4 r0p1, as read on the F429 */
+#define SIM_CPUID           0x410FC241U
+/* DWT_CTRL.NUMCOMP = 4 */
+#define SIM_DWT_CTRL_RESET  0x40000000U
+
+/* More wraps than this in one advance means the host stalled; the excess
+ * is dropped instead of replaying a burst of SysTick handlers */
+#define SYSTICK_MAX_CATCHUP 1000U
+
+static struct {
+    uint64_t zeroAt;        /* Cycle at which the counter next reaches 0 */
+    uint32_t pending;       /* Wraps whose handler has not run yet */
+    int countFlag;
+} systick;
+
+static uint32_t nvic_enabled[SCS_NVIC_WORDS];
+static uint32_t nvic_pending[SCS_NVIC_WORDS];
+static int pendsv_pending = 0;
+
+static struct {
+    int running;
+    uint32_t value;         /* CYCCNT at syncCycle */
+    uint64_t syncCycle;
+} cyccnt;
+
+static volatile uint32_t* ScsReg(uint32_t offset) {
+    return Sim_Reg(SCS_BASE_ADDR + offset);
+}
+
+/* SysTick */
+
+static int SysTick_Enabled(void) {
+    return (*ScsReg(SCS_SYSTICK_CTRL) & SysTick_CTRL_ENABLE_Msk) != 0;
+}
+
+static uint64_t SysTick_Period(void) {
+    return (uint64_t)(*ScsReg(SCS_SYSTICK_LOAD) & SysTick_LOAD_RELOAD_Msk) + 1U;
+}
+
+static void SysTick_Advance(uint64_t now) {
+    if (!SysTick_Enabled() || now < systick.zeroAt) {
+        return;
+    }
+
+    uint64_t period = SysTick_Period();
+    uint64_t wraps = (now - systick.zeroAt) / period + 1U;
+    systick.zeroAt += wraps * period;
+    systick.countFlag = 1;
+
+    if (*ScsReg(SCS_SYSTICK_CTRL) & SysTick_CTRL_TICKINT_Msk) {
+        /* The NVIC keeps one pending bit; counting wraps instead keeps
+         * systick_counter in step with simulated time across host jitter */
+        systick.pending += (wraps > SYSTICK_MAX_CATCHUP) ? SYSTICK_MAX_CATCHUP : (uint32_t)wraps;
+    }
+}
+
+static uint32_t SysTick_Value(uint64_t now) {
+    if (!SysTick_Enabled()) {
+        return *ScsReg(SCS_SYSTICK_VAL);
+    }
+    if (now >= systick.zeroAt) {
+        return 0;  /* Wrap not applied yet */
+    }
+    return (uint32_t)((systick.zeroAt - now) % SysTick_Period());
+}
+
+/* NVIC */
+
+static void Nvic_Publish(void) {
+    for (uint32_t i = 0; i < SCS_NVIC_WORDS; i++) {
+        *ScsReg(SCS_NVIC_ISER + i * 4U) = nvic_enabled[i];
+        *ScsReg(SCS_NVIC_ICER + i * 4U) = nvic_enabled[i];
+        *ScsReg(SCS_NVIC_ISPR + i * 4U) = nvic_pending[i];
+        *ScsReg(SCS_NVIC_ICPR + i * 4U) = nvic_pending[i];
+    }
+
+    uint32_t icsr = *ScsReg(SCS_SCB_ICSR) & ~(SCB_ICSR_PENDSTSET_Msk | SCB_ICSR_PENDSVSET_Msk);
+    if (systick.pending != 0) {
+        icsr |= SCB_ICSR_PENDSTSET_Msk;
+    }
+    if (pendsv_pending) {
+        icsr |= SCB_ICSR_PENDSVSET_Msk;
+    }
+    *ScsReg(SCS_SCB_ICSR) = icsr;
+}
+
+int Sim_NvicIsEnabled(int irq) {
+    return (nvic_enabled[irq >> 5] >> (irq & 31)) & 1U;
+}
+
+void Sim_NvicSetPending(int irq) {
+    if (irq >= 0 && (uint32_t)irq < SCS_NVIC_WORDS * 32U) {
+        nvic_pending[irq >> 5] |= 1U << (irq & 31);
+    }
+}
+
+int Sim_NvicTakePending(int irq) {
+    if (irq == SysTick_IRQn) {
+        if (systick.pending == 0) {
+            return 0;
+        }
+        systick.pending--;
+        return 1;
+    }
+    if (irq == PendSV_IRQn) {
+        int taken = pendsv_pending;
+        pendsv_pending = 0;
+        return taken;
+    }
+
+    uint32_t bit = 1U << (irq & 31);
+    if (nvic_pending[irq >> 5] & bit) {
+        nvic_pending[irq >> 5] &= ~bit;
+        return 1;
+    }
+    return 0;
+}
+
+int Sim_NvicIsPending(int irq) {
+    if (irq == SysTick_IRQn) {
+        return systick.pending != 0;
+    }
+    if (irq == PendSV_IRQn) {
+        return pendsv_pending;
+    }
+    return (nvic_pending[irq >> 5] >> (irq & 31)) & 1U;
+}
+
+/* Register hooks */
+
+static void Scs_PreAccess(uint32_t offset, int isWrite) {
+    uint64_t now = Sim_ModelCycles();
+    (void)isWrite;
+
+    if (offset == SCS_SYSTICK_VAL) {
+        *ScsReg(SCS_SYSTICK_VAL) = SysTick_Value(now);
+    } else if (offset == SCS_SYSTICK_CTRL) {
+        uint32_t ctrl = *ScsReg(SCS_SYSTICK_CTRL) & ~SysTick_CTRL_COUNTFLAG_Msk;
+        if (systick.countFlag) {
+            ctrl |= SysTick_CTRL_COUNTFLAG_Msk;
+        }
+        *ScsReg(SCS_SYSTICK_CTRL) = ctrl;
+    }
+
+    Nvic_Publish();
+}
+
+static void Scs_PostAccess(uint32_t offset, int isWrite, uint32_t old) {
+    uint64_t now = Sim_ModelCycles();
+    uint32_t value = *ScsReg(offset);
+
+    if (!isWrite) {
+        if (offset == SCS_SYSTICK_CTRL) {
+            systick.countFlag = 0;  /* Cleared by reading */
+        }
+        return;
+    }
+
+    if (offset == SCS_SYSTICK_CTRL) {
+        if ((value & SysTick_CTRL_ENABLE_Msk) && !(old & SysTick_CTRL_ENABLE_Msk)) {
+            /* Counts down from the current value, a value of 0 reloads first */
+            uint32_t current = *ScsReg(SCS_SYSTICK_VAL);
+            systick.zeroAt = now + ((current != 0) ? current : SysTick_Period());
+        }
+    } else if (offset == SCS_SYSTICK_VAL) {
+        /* Any write clears the counter and COUNTFLAG */
+        *ScsReg(SCS_SYSTICK_VAL) = 0;
+        systick.countFlag = 0;
+        systick.zeroAt = now + SysTick_Period();
+    } else if (offset == SCS_SYSTICK_CALIB || offset == SCS_SCB_CPUID) {
+        *ScsReg(offset) = old;  /* Read-only */
+    } else if (offset >= SCS_NVIC_ISER && offset < SCS_NVIC_ISER + SCS_NVIC_WORDS * 4U) {
+        nvic_enabled[(offset - SCS_NVIC_ISER) / 4U] |= value;
+    } else if (offset >= SCS_NVIC_ICER && offset < SCS_NVIC_ICER + SCS_NVIC_WORDS * 4U) {
+        nvic_enabled[(offset - SCS_NVIC_ICER) / 4U] &= ~value;
+    } else if (offset >= SCS_NVIC_ISPR && offset < SCS_NVIC_ISPR + SCS_NVIC_WORDS * 4U) {
+        nvic_pending[(offset - SCS_NVIC_ISPR) / 4U] |= value;
+    } else if (offset >= SCS_NVIC_ICPR && offset < SCS_NVIC_ICPR + SCS_NVIC_WORDS * 4U) {
+        nvic_pending[(offset - SCS_NVIC_ICPR) / 4U] &= ~value;
+    } else if (offset == SCS_NVIC_STIR) {
+        Sim_NvicSetPending((int)(value & 0x1FFU));
+    } else if (offset == SCS_SCB_ICSR) {
+        if (value & SCB_ICSR_PENDSTSET_Msk) {
+            systick.pending++;
+        }
+        if (value & SCB_ICSR_PENDSTCLR_Msk) {
+            systick.pending = 0;
+        }
+        if (value & SCB_ICSR_PENDSVSET_Msk) {
+            pendsv_pending = 1;
+        }
+        if (value & SCB_ICSR_PENDSVCLR_Msk) {
+            pendsv_pending = 0;
+        }
+    }
+
+    Nvic_Publish();
+}
+
+static uint64_t Scs_NextEvent(void) {
+    return SysTick_Enabled() ? systick.zeroAt : UINT64_MAX;
+}
+
+static void Scs_Advance(uint64_t now) {
+    SysTick_Advance(now);
+}
+
+/* DWT */
+
+static int Dwt_Enabled(void) {
+    return (*Sim_Reg(DWT_BASE_ADDR + DWT_CTRL_OFFSET) & DWT_CTRL_CYCCNTENA_Msk) &&
+           (*ScsReg(0xDFCU) & CoreDebug_DEMCR_TRCENA_Msk);
+}
+
+static uint32_t Dwt_Cyccnt(uint64_t now) {
+    if (!cyccnt.running) {
+        return cyccnt.value;
+    }
+    return cyccnt.value + (uint32_t)(now - cyccnt.syncCycle);
+}
+
+static void Dwt_PreAccess(uint32_t offset, int isWrite) {
+    (void)isWrite;
+    if (offset == DWT_CYCCNT_OFFSET) {
+        *Sim_Reg(DWT_BASE_ADDR + DWT_CYCCNT_OFFSET) = Dwt_Cyccnt(Sim_ModelCycles());
+    }
+}
+
+static void Dwt_PostAccess(uint32_t offset, int isWrite, uint32_t old) {
+    uint64_t now = Sim_ModelCycles();
+    (void)old;
+
+    if (!isWrite) {
+        return;
+    }
+
+    if (offset == DWT_CYCCNT_OFFSET) {
+        cyccnt.value = *Sim_Reg(DWT_BASE_ADDR + DWT_CYCCNT_OFFSET);
+        cyccnt.syncCycle = now;
+    } else if (offset == DWT_CTRL_OFFSET) {
+        /* NUMCOMP is read-only */
+        volatile uint32_t* ctrl = Sim_Reg(DWT_BASE_ADDR + DWT_CTRL_OFFSET);
+        *ctrl = (*ctrl & 0x0FFFFFFFU) | SIM_DWT_CTRL_RESET;
+
+        int running = Dwt_Enabled();
+        if (running != cyccnt.running) {
+            cyccnt.value = Dwt_Cyccnt(now);
+            cyccnt.syncCycle = now;
+            cyccnt.running = running;
+        }
+    }
+}
+
+void Sim_ScsInit(void) {
+    static const Sim_Device scs = {
+        "SCS", SCS_BASE_ADDR, 0x1000U, SIM_NO_IRQ,
+        Scs_PreAccess, Scs_PostAccess, Scs_NextEvent, Scs_Advance, NULL
+    };
+    static const Sim_Device dwt = {
+        "DWT", DWT_BASE_ADDR, 0x1000U, SIM_NO_IRQ,
+        Dwt_PreAccess, Dwt_PostAccess, NULL, NULL, NULL
+    };
+
+    *ScsReg(SCS_SYSTICK_CALIB) = 0x40000000U | (SIM_CPU_HZ / 800U - 1U);  /* SKEW, 10 ms at HCLK/8 */
+    *ScsReg(SCS_SCB_CPUID) = SIM_CPUID;
+    *Sim_Reg(DWT_BASE_ADDR + DWT_CTRL_OFFSET) = SIM_DWT_CTRL_RESET;
+
+    Sim_RegisterDevice(&scs);
+    Sim_RegisterDevice(&dwt);
+}
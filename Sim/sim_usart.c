@@ -0,0 +1,334 @@
+/**
+ * @file sim_usart.c
+ * @brief USART3 model: TDR/shift register pipeline with frame timing taken
+ *        from BRR/CR1/CR2, a virtual remote end that sends queued bytes at
+ *        its own baud rate, and the SR flags (TXE, TC, RXNE, ORE, FE).
+ *        With DMAT/DMAR set, TXE and RXNE raise requests on DMA1 Stream 3
+ *        and Stream 1 (channel 4) instead of waiting for the CPU. With
+ *        RTSE set the remote end honours RTS: it holds its next frame
+ *        while RXNE is set.
+ */
+
+#include "sim_internal.h"
+#include "stm32f4xx.h"
+#include <signal.h>
+#include <unistd.h>
+
+#define USART3_BASE_ADDR    0x40004800U
+#define USART_SR_OFFSET     0x00U
+#define USART_DR_OFFSET     0x04U
+#define USART_CR1_OFFSET    0x0CU
+#define USART_CR3_OFFSET    0x14U
+
+/* DMA1 channel 4 streams wired to USART3 (RM0090 table 42) */
+#define USART3_DMA_CHANNEL  4U
+#define USART3_DMA_TX       3
+#define USART3_DMA_RX       1
+
+/* Largest rate mismatch a 16x oversampling receiver tolerates (RM0090) */
+#define USART_BAUD_TOLERANCE_PCT 3U
+
+/* Flags written to 0 by software clear, the rest of SR is read-only */
+#define USART_SR_RC_W0      (USART_SR_RXNE | USART_SR_TC | USART_SR_LBD | USART_SR_CTS)
+#define USART_SR_ERRORS     (USART_SR_PE | USART_SR_FE | USART_SR_NE | USART_SR_ORE)
+
+static struct {
+    uint32_t sr;
+    uint8_t rdr;
+    int tdrFull;
+    uint8_t tdr;
+    int shifting;
+    uint8_t shift;
+    uint64_t shiftDone;     /* Cycle at which the stop bit of shift ends */
+    int srJustRead;         /* SR read, then DR access clears the error flags */
+
+    uint8_t queue[SIM_RX_QUEUE_SIZE];
+    volatile size_t queueHead;  /* Written by Sim_UartInject */
+    volatile size_t queueTail;  /* Written by the model */
+    uint64_t nextArrival;   /* Cycle at which the head of the queue has arrived */
+    uint32_t remoteBaud;
+} usart;
+
+static int tx_fd = -1;
+static int loopback = 0;
+static Sim_TxHook tx_hook = NULL;
+static Sim_Stats counters;
+
+static volatile uint32_t* UsartReg(uint32_t offset) {
+    return Sim_Reg(USART3_BASE_ADDR + offset);
+}
+
+/* Core cycles per bit as programmed in BRR */
+static uint32_t Usart_BitCycles(void) {
+    uint32_t brr = *UsartReg(offsetof(USART_TypeDef, BRR)) & 0xFFFFU;
+    uint32_t cycles = brr;
+
+    if (*UsartReg(USART_CR1_OFFSET) & USART_CR1_OVER8) {
+        /* DIV_Fraction[3] is unused with 8x oversampling */
+        cycles = ((brr >> 4) << 3) | (brr & 0x7U);
+    }
+    return (cycles != 0) ? cycles : 16U;
+}
+
+static uint64_t Usart_FrameCycles(void) {
+    uint32_t cr1 = *UsartReg(USART_CR1_OFFSET);
+    uint32_t stop = (*UsartReg(offsetof(USART_TypeDef, CR2)) & USART_CR2_STOP) >> USART_CR2_STOP_Pos;
+    uint32_t halfBits = 2U * (1U + ((cr1 & USART_CR1_M) ? 9U : 8U));
+
+    /* STOP: 00 = 1, 01 = 0.5, 10 = 2, 11 = 1.5 stop bits */
+    static const uint32_t stopHalfBits[4] = { 2U, 1U, 4U, 3U };
+    halfBits += stopHalfBits[stop & 3U];
+
+    return (uint64_t)Usart_BitCycles() * halfBits / 2U;
+}
+
+static int Usart_Enabled(uint32_t mask) {
+    uint32_t cr1 = *UsartReg(USART_CR1_OFFSET);
+    return (cr1 & USART_CR1_UE) && (cr1 & mask) == mask;
+}
+
+static void Usart_Receive(uint8_t byte);
+
+/* RXNE with DMAR set: the DMA reads DR, which clears RXNE like a CPU read */
+static void Usart_ServiceRxDma(void) {
+    uint32_t data = usart.rdr;
+
+    if ((usart.sr & USART_SR_RXNE) && (*UsartReg(USART_CR3_OFFSET) & USART_CR3_DMAR) &&
+        Sim_DmaRequest(1, USART3_DMA_RX, USART3_DMA_CHANNEL, &data)) {
+        usart.sr &= ~USART_SR_RXNE;
+    }
+}
+
+static void Usart_Emit(uint8_t byte, uint64_t cycles) {
+    counters.uartTxBytes++;
+    if (loopback) {
+        Usart_Receive(byte);
+    }
+    if (tx_fd >= 0) {
+        ssize_t written = write(tx_fd, &byte, 1);
+        (void)written;
+    }
+    if (tx_hook != NULL) {
+        tx_hook(byte, (uint64_t)((double)cycles * (1e9 / (double)SIM_CPU_HZ)));
+    }
+}
+
+static void Usart_Receive(uint8_t byte) {
+    if (!Usart_Enabled(USART_CR1_RE)) {
+        return;  /* Nobody is sampling the line */
+    }
+
+    if (usart.sr & USART_SR_RXNE) {
+        /* The shift register contents are lost, DR keeps the old byte */
+        usart.sr |= USART_SR_ORE;
+        counters.uartRxOverruns++;
+        return;
+    }
+
+    uint32_t local = Usart_BitCycles();
+    uint32_t remote = (uint32_t)(SIM_CPU_HZ / usart.remoteBaud);
+    uint32_t diff = (local > remote) ? local - remote : remote - local;
+
+    usart.rdr = byte;
+    usart.sr |= USART_SR_RXNE;
+    if (!loopback && diff * 100U > remote * USART_BAUD_TOLERANCE_PCT) {
+        usart.sr |= USART_SR_FE;
+        counters.uartRxFramingErrors++;
+    }
+    counters.uartRxBytes++;
+
+    Usart_ServiceRxDma();
+}
+
+/* A byte written to DR, by the CPU or the DMA */
+static void Usart_Transmit(uint8_t byte) {
+    if (!Usart_Enabled(USART_CR1_TE)) {
+        return;
+    }
+
+    if (!usart.shifting) {
+        usart.shift = byte;
+        usart.shifting = 1;
+        usart.shiftDone = Sim_ModelCycles() + Usart_FrameCycles();
+    } else {
+        /* A write with TXE clear overwrites TDR */
+        usart.tdr = byte;
+        usart.tdrFull = 1;
+        usart.sr &= ~USART_SR_TXE;
+    }
+    usart.sr &= ~USART_SR_TC;
+}
+
+/* TXE with DMAT set requests the next byte until TDR is full */
+static void Usart_ServiceTxDma(void) {
+    uint32_t data;
+
+    while ((*UsartReg(USART_CR3_OFFSET) & USART_CR3_DMAT) && !usart.tdrFull &&
+           Sim_DmaRequest(1, USART3_DMA_TX, USART3_DMA_CHANNEL, &data)) {
+        Usart_Transmit((uint8_t)data);
+    }
+}
+
+static uint64_t Usart_NextEvent(void) {
+    uint64_t next = UINT64_MAX;
+
+    if (usart.shifting) {
+        next = usart.shiftDone;
+    }
+    if (usart.queueTail != usart.queueHead && usart.nextArrival < next) {
+        next = usart.nextArrival;
+    }
+    return next;
+}
+
+static void Usart_Advance(uint64_t now) {
+    /* Transmitter: the stop bit of the shift register ends, TDR moves in */
+    while (usart.shifting && now >= usart.shiftDone) {
+        uint64_t done = usart.shiftDone;
+        Usart_Emit(usart.shift, done);
+
+        if (usart.tdrFull) {
+            usart.shift = usart.tdr;
+            usart.tdrFull = 0;
+            usart.shiftDone = done + Usart_FrameCycles();
+        } else {
+            usart.shifting = 0;
+            usart.sr |= USART_SR_TC;
+        }
+    }
+    if (!usart.tdrFull) {
+        usart.sr |= USART_SR_TXE;
+    }
+    Usart_ServiceTxDma();
+
+    /* Receiver: the remote end sends back to back at its own rate */
+    uint64_t frame = (uint64_t)SIM_CPU_HZ * 10U / usart.remoteBaud;
+    while (usart.queueTail != usart.queueHead && now >= usart.nextArrival) {
+        if ((*UsartReg(USART_CR3_OFFSET) & USART_CR3_RTSE) && (usart.sr & USART_SR_RXNE)) {
+            /* RTS is off: the frame starts once DR has been read */
+            usart.nextArrival = now + frame;
+            break;
+        }
+        Usart_Receive(usart.queue[usart.queueTail % SIM_RX_QUEUE_SIZE]);
+        usart.queueTail++;
+        usart.nextArrival += frame;
+    }
+}
+
+static int Usart_IrqLevel(int irq) {
+    uint32_t cr1 = *UsartReg(USART_CR1_OFFSET);
+    uint32_t cr3 = *UsartReg(offsetof(USART_TypeDef, CR3));
+
+    return ((cr1 & USART_CR1_RXNEIE) && (usart.sr & (USART_SR_RXNE | USART_SR_ORE))) ||
+           ((cr1 & USART_CR1_TXEIE) && (usart.sr & USART_SR_TXE)) ||
+           ((cr1 & USART_CR1_TCIE) && (usart.sr & USART_SR_TC)) ||
+           ((cr3 & USART_CR3_EIE) && (usart.sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)));
+}
+
+static void Usart_PreAccess(uint32_t offset, int isWrite) {
+    (void)isWrite;
+
+    *UsartReg(USART_SR_OFFSET) = usart.sr;
+    if (offset == USART_DR_OFFSET) {
+        *UsartReg(USART_DR_OFFSET) = usart.rdr;
+    }
+}
+
+static void Usart_PostAccess(uint32_t offset, int isWrite, uint32_t old) {
+    (void)old;
+
+    if (offset == USART_SR_OFFSET) {
+        if (isWrite) {
+            uint32_t value = *UsartReg(USART_SR_OFFSET);
+            usart.sr &= value | ~USART_SR_RC_W0;
+        } else {
+            usart.srJustRead = 1;
+        }
+    } else if (offset == USART_DR_OFFSET) {
+        if (isWrite) {
+            Usart_Transmit((uint8_t)*UsartReg(USART_DR_OFFSET));
+        } else {
+            usart.sr &= ~USART_SR_RXNE;
+            if (usart.srJustRead) {
+                usart.sr &= ~USART_SR_ERRORS;
+            }
+        }
+        usart.srJustRead = 0;
+    } else if (offset == USART_CR1_OFFSET && isWrite) {
+        if (!(*UsartReg(USART_CR1_OFFSET) & USART_CR1_UE)) {
+            /* Disabling the USART abandons the frame in progress */
+            usart.shifting = 0;
+            usart.tdrFull = 0;
+            usart.sr |= USART_SR_TXE | USART_SR_TC;
+        }
+    } else if (offset == USART_CR3_OFFSET && isWrite) {
+        Usart_ServiceTxDma();
+        Usart_ServiceRxDma();
+    }
+
+    *UsartReg(USART_SR_OFFSET) = usart.sr;
+}
+
+size_t Sim_UartInject(const uint8_t* data, size_t length) {
+    sigset_t timer, saved;
+    sigemptyset(&timer);
+    sigaddset(&timer, SIGALRM);
+    sigprocmask(SIG_BLOCK, &timer, &saved);
+
+    uint64_t now = Sim_ModelCycles();
+    if (usart.queueTail == usart.queueHead && usart.nextArrival < now) {
+        /* Line was idle, the first byte starts now */
+        usart.nextArrival = now + (uint64_t)SIM_CPU_HZ * 10U / usart.remoteBaud;
+    }
+
+    size_t queued = 0;
+    while (queued < length && usart.queueHead - usart.queueTail < SIM_RX_QUEUE_SIZE) {
+        usart.queue[usart.queueHead % SIM_RX_QUEUE_SIZE] = data[queued++];
+        usart.queueHead++;
+    }
+
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    return queued;
+}
+
+void Sim_UartSetLoopback(int enable) {
+    loopback = enable;
+}
+
+void Sim_UartSetRemoteBaud(uint32_t baud) {
+    if (baud != 0) {
+        usart.remoteBaud = baud;
+    }
+}
+
+size_t Sim_UartRxPending(void) {
+    return usart.queueHead - usart.queueTail;
+}
+
+void Sim_UartSetTxHook(Sim_TxHook hook) {
+    tx_hook = hook;
+}
+
+void Sim_UsartStats(Sim_Stats* stats) {
+    stats->uartTxBytes = counters.uartTxBytes;
+    stats->uartRxBytes = counters.uartRxBytes;
+    stats->uartRxOverruns = counters.uartRxOverruns;
+    stats->uartRxFramingErrors = counters.uartRxFramingErrors;
+}
+
+void Sim_UsartInit(const Sim_Config* config) {
+    static const Sim_Device device = {
+        "USART3", USART3_BASE_ADDR, 0x400U, USART3_IRQn,
+        Usart_PreAccess, Usart_PostAccess, Usart_NextEvent, Usart_Advance, Usart_IrqLevel
+    };
+
+    tx_fd = config->txFd;
+    loopback = config->loopback;
+    usart.remoteBaud = (config->remoteBaud != 0) ? config->remoteBaud : 115200U;
+
+    /* Reset state: transmitter idle */
+    usart.sr = USART_SR_TXE | USART_SR_TC;
+    *UsartReg(USART_SR_OFFSET) = usart.sr;
+
+    Sim_RegisterDevice(&device);
+}
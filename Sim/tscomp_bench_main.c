@@ -0,0 +1,161 @@
+/**
+ * @file tscomp_bench_main.c
+ * @brief Runs the time-series encoder (Src/tscomp.c) over a trace CSV on
+ *        the host: writes the packets for Tools/tscomp_decode.py to check
+ *        and reports the compression and the host encoding time. The
+ *        target's cycles per sample come from the tscbench shell command.
+ *
+ *   tscomp_bench trace.csv [--packet bytes] [--flush ticks] [--repeat n] [-o packets.bin]
+ *
+ * The CSV is as written by Tools/tscomp_trace.py: a header row of
+ * "timestamp,name,...", ":f" after the float channel names.
+ */
+
+#include "tscomp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LINE    1024
+
+static uint32_t* trace;         /* Per sample: timestamp, then one word per channel */
+static uint32_t trace_samples;
+static uint8_t trace_channels;
+static uint16_t trace_floats;
+
+static FILE* packet_file;
+
+static void Packet(const uint8_t* packet, uint16_t size) {
+    if (packet_file != NULL) {
+        fwrite(packet, 1, size, packet_file);
+    }
+}
+
+static int ReadTrace(const char* path) {
+    char line[MAX_LINE];
+    uint32_t capacity = 0;
+    FILE* f = fopen(path, "r");
+
+    if (f == NULL || fgets(line, sizeof(line), f) == NULL) {
+        perror(path);
+        return -1;
+    }
+    strtok(line, ",\r\n");    /* The timestamp column */
+    for (char* name; (name = strtok(NULL, ",\r\n")) != NULL;) {
+        size_t length = strlen(name);
+        if (trace_channels == TSC_MAX_CHANNELS) {
+            fprintf(stderr, "%s: more than %d channels\n", path, TSC_MAX_CHANNELS);
+            return -1;
+        }
+        if (length > 2 && strcmp(name + length - 2, ":f") == 0) {
+            trace_floats |= (uint16_t)(1U << trace_channels);
+        }
+        trace_channels++;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (trace_samples == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            trace = realloc(trace, (size_t)capacity * (1U + trace_channels) * sizeof(uint32_t));
+        }
+        uint32_t* row = trace + (size_t)trace_samples * (1U + trace_channels);
+        char* p = line;
+        char* end;
+
+        row[0] = (uint32_t)strtoull(p, &end, 10);
+        for (uint8_t c = 0; c < trace_channels; c++) {
+            if (end == p || *end != ',') {
+                fprintf(stderr, "%s:%lu: expected %u values\n", path,
+                        (unsigned long)trace_samples + 2, trace_channels);
+                return -1;
+            }
+            p = end + 1;
+            if (trace_floats & (1U << c)) {
+                row[1 + c] = Tsc_Float(strtof(p, &end));
+            } else {
+                row[1 + c] = (uint32_t)strtol(p, &end, 10);
+            }
+        }
+        trace_samples++;
+    }
+    fclose(f);
+    return trace_samples ? 0 : -1;
+}
+
+static void Encode(const Tsc_Config* config) {
+    Tsc_Init(config);
+    for (uint32_t n = 0; n < trace_samples; n++) {
+        const uint32_t* row = trace + (size_t)n * (1U + trace_channels);
+        Tsc_Add(row[0], row + 1);
+    }
+    Tsc_Flush();
+}
+
+int main(int argc, char* argv[]) {
+    Tsc_Config config = { 0, 0, 128, 0, Packet };
+    const char* trace_path = NULL;
+    const char* out_path = NULL;
+    unsigned long repeat = 20;
+    struct timespec start, end;
+    Tsc_Stats stats;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--packet") == 0 && i + 1 < argc) {
+            config.packetSize = (uint16_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--flush") == 0 && i + 1 < argc) {
+            config.flushTicks = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] != '-' && trace_path == NULL) {
+            trace_path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s trace.csv [--packet bytes] [--flush ticks] "
+                    "[--repeat n] [-o packets.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (trace_path == NULL || ReadTrace(trace_path) != 0) {
+        fprintf(stderr, "%s: no samples\n", trace_path ? trace_path : argv[0]);
+        return 1;
+    }
+    config.channels = trace_channels;
+    config.floatMask = trace_floats;
+    if (Tsc_Init(&config) != TSC_OK) {
+        fprintf(stderr, "packet size %u does not fit %u channels\n", config.packetSize,
+                trace_channels);
+        return 1;
+    }
+
+    /* Timed with no output, then once more into the file */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long r = 0; r < repeat; r++) {
+        Encode(&config);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = ((double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec))
+                / ((double)repeat * trace_samples);
+
+    if (out_path != NULL && (packet_file = fopen(out_path, "wb")) == NULL) {
+        perror(out_path);
+        return 1;
+    }
+    Encode(&config);
+    Tsc_GetStats(&stats);
+    if (packet_file != NULL) {
+        fclose(packet_file);
+    }
+
+    uint32_t raw = stats.samples * 4U * (1U + trace_channels);
+    printf("%s: %u samples x %u channels (float mask %04x), %.1f ns/sample on the host\n",
+           trace_path, stats.samples, trace_channels, trace_floats, ns);
+    printf("  %u packets of %u bytes (%u used, %u on latency), %.2f bytes/sample, "
+           "ratio %.2f against 32-bit words\n", stats.packets, config.packetSize,
+           stats.usedBytes, stats.latencyFlushes, (double)stats.sentBytes / stats.samples,
+           (double)raw / stats.sentBytes);
+    printf("  %.0f samples/s fit 115200 baud (%.0f as 32-bit words)\n",
+           11520.0 * stats.samples / stats.sentBytes, 11520.0 * stats.samples / raw);
+    return 0;
+}
@@ -0,0 +1,605 @@
+/* @adc.c */
+#include "adc.h"
+#include "fmt.h"
+#include "shell.h"
+#include "systick.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* TIM8 runs from APB2, which is HCLK at the reset clock setup */
+#define ADC_TIMER_HZ            16000000UL
+
+/* EXTSEL code for TIM8 TRGO, EXTEN for rising edges */
+#define ADC_EXTSEL_TIM8_TRGO    14U
+#define ADC_EXTEN_RISING        1U
+
+/* CCR MULTI codes (RM0090 13.13.16) */
+#define ADC_MULTI_DUAL_INTERLEAVED      0x07U
+#define ADC_MULTI_TRIPLE_INTERLEAVED    0x17U
+
+/* Multi-mode DMA mode 2: two 12-bit results per 32-bit transfer, oldest in
+ * the low half, which keeps the halfword stream in conversion order */
+#define ADC_CCR_DMA_MODE2       2U
+
+/* Interleave delay limits in ADC clock cycles */
+#define ADC_DELAY_MIN           5U
+#define ADC_DELAY_MAX           20U
+
+/* Flags of one stream in DMA2 LISR/HISR, shifted down to bit 0 */
+#define ADC_DMA_FEIF            (1UL << 0)
+#define ADC_DMA_DMEIF           (1UL << 2)
+#define ADC_DMA_TEIF            (1UL << 3)
+#define ADC_DMA_HTIF            (1UL << 4)
+#define ADC_DMA_TCIF            (1UL << 5)
+#define ADC_DMA_ALL             (ADC_DMA_FEIF | ADC_DMA_DMEIF | ADC_DMA_TEIF | \
+                                 ADC_DMA_HTIF | ADC_DMA_TCIF)
+
+/* Factory calibration values (RM0090 13.10, datasheet 6.3.22/6.3.24),
+ * measured at VDDA = 3.3 V */
+#define ADC_TS_CAL1             (*(const uint16_t*)0x1FFF7A2CUL)    /* 30 C */
+#define ADC_TS_CAL2             (*(const uint16_t*)0x1FFF7A2EUL)    /* 110 C */
+#define ADC_VREFINT_CAL         (*(const uint16_t*)0x1FFF7A2AUL)
+#define ADC_CAL_MV              3300UL
+
+/* Fixed hardware of each unit; DMA2 request channels per RM0090 table 43 */
+typedef struct {
+    ADC_TypeDef* adc;
+    DMA_Stream_TypeDef* stream;
+    uint8_t streamIndex;
+    uint8_t dmaChannel;
+    IRQn_Type irq;
+    uint32_t clock;             /* RCC_APB2ENR bit */
+} Adc_Hw;
+
+static const Adc_Hw adc_hw[3] = {
+    { ADC1, DMA2_Stream4, 4, 0, DMA2_Stream4_IRQn, RCC_APB2ENR_ADC1EN },
+    { ADC2, DMA2_Stream2, 2, 1, DMA2_Stream2_IRQn, RCC_APB2ENR_ADC2EN },
+    { ADC3, DMA2_Stream1, 1, 2, DMA2_Stream1_IRQn, RCC_APB2ENR_ADC3EN },
+};
+
+typedef struct {
+    GPIO_TypeDef* port;
+    uint8_t pin;
+} Adc_Pin;
+
+/* External inputs of ADC1 and ADC2 */
+static const Adc_Pin pins_adc12[16] = {
+    { GPIOA, 0 }, { GPIOA, 1 }, { GPIOA, 2 }, { GPIOA, 3 },
+    { GPIOA, 4 }, { GPIOA, 5 }, { GPIOA, 6 }, { GPIOA, 7 },
+    { GPIOB, 0 }, { GPIOB, 1 }, { GPIOC, 0 }, { GPIOC, 1 },
+    { GPIOC, 2 }, { GPIOC, 3 }, { GPIOC, 4 }, { GPIOC, 5 },
+};
+
+/* ADC3 has IN4-IN9, IN14 and IN15 on port F */
+static const Adc_Pin pins_adc3[16] = {
+    { GPIOA, 0 }, { GPIOA, 1 }, { GPIOA, 2 }, { GPIOA, 3 },
+    { GPIOF, 6 }, { GPIOF, 7 }, { GPIOF, 8 }, { GPIOF, 9 },
+    { GPIOF, 10 }, { GPIOF, 3 }, { GPIOC, 0 }, { GPIOC, 1 },
+    { GPIOC, 2 }, { GPIOC, 3 }, { GPIOF, 4 }, { GPIOF, 5 },
+};
+
+/* Sampling cycles per Adc_SampleTime; a conversion adds 12 */
+static const uint16_t sample_cycles[8] = { 3, 15, 28, 56, 84, 112, 144, 480 };
+
+/* Bit position of each stream's flags in LISR/HISR */
+static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+typedef struct {
+    Adc_BlockCallback callback;
+    uint16_t* buffer;
+    uint16_t blockSamples;
+    uint8_t adcs;               /* ADCs feeding this stream */
+    volatile bool running;
+    volatile uint32_t blocks;
+    volatile uint32_t overruns;
+    volatile uint32_t dmaErrors;
+    uint32_t rateMilliHz;
+} Adc_Unit;
+
+static Adc_Unit units[3];
+static Adc_Mode active_mode = ADC_MODE_INDEPENDENT;
+static uint32_t trigger_hz = 0;         /* TIM8 rate while any scan runs */
+static uint32_t trigger_mhz = 0;        /* The rate it actually achieves */
+
+static uint32_t Adc_DmaFlags(uint8_t stream) {
+    volatile uint32_t* isr = (stream < 4) ? &DMA2->LISR : &DMA2->HISR;
+    return (*isr >> flag_shift[stream & 3]) & ADC_DMA_ALL;
+}
+
+static void Adc_DmaClear(uint8_t stream, uint32_t flags) {
+    volatile uint32_t* ifcr = (stream < 4) ? &DMA2->LIFCR : &DMA2->HIFCR;
+    *ifcr = flags << flag_shift[stream & 3];
+}
+
+static void Adc_ConfigurePin(uint8_t unit, uint8_t channel) {
+    if (channel >= 16) {
+        return;
+    }
+    const Adc_Pin* pin = (unit == 3) ? &pins_adc3[channel] : &pins_adc12[channel];
+    RCC->AHB1ENR |= 1UL << (((uint32_t)pin->port - GPIOA_BASE) / 0x400UL);
+    pin->port->MODER |= 3UL << (pin->pin * 2U);      /* Analog */
+    pin->port->PUPDR &= ~(3UL << (pin->pin * 2U));
+}
+
+/* Sample time of one channel, raised for the internal ones */
+static Adc_SampleTime Adc_ChannelSample(uint8_t channel, Adc_SampleTime sampleTime) {
+    if (channel >= ADC_CHANNEL_TEMP && sampleTime < ADC_INTERNAL_SAMPLE) {
+        return ADC_INTERNAL_SAMPLE;
+    }
+    return sampleTime;
+}
+
+static void Adc_SetSample(ADC_TypeDef* adc, uint8_t channel, Adc_SampleTime sampleTime) {
+    if (channel < 10) {
+        adc->SMPR2 = (adc->SMPR2 & ~(7UL << (channel * 3U))) | ((uint32_t)sampleTime << (channel * 3U));
+    } else {
+        uint32_t shift = (channel - 10U) * 3U;
+        adc->SMPR1 = (adc->SMPR1 & ~(7UL << shift)) | ((uint32_t)sampleTime << shift);
+    }
+}
+
+static void Adc_SetSequence(ADC_TypeDef* adc, const uint8_t* channels, uint8_t count) {
+    uint32_t sqr[3] = { 0, 0, 0 };     /* SQR3 holds SQ1-6, SQR2 SQ7-12, SQR1 SQ13-16 */
+
+    for (uint8_t i = 0; i < count; i++) {
+        sqr[i / 6] |= (uint32_t)channels[i] << ((i % 6) * 5U);
+    }
+    adc->SQR3 = sqr[0];
+    adc->SQR2 = sqr[1];
+    adc->SQR1 = sqr[2] | ((uint32_t)(count - 1) << ADC_SQR1_L_Pos);
+}
+
+/* Point the stream at the start of the buffer and enable it */
+static void Adc_DmaArm(uint8_t index, uint32_t source, bool words) {
+    const Adc_Hw* hw = &adc_hw[index];
+    Adc_Unit* unit = &units[index];
+    uint32_t size = words ? (DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1) : (DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0);
+
+    /* The stream only accepts a new setup once EN reads back as 0 */
+    hw->stream->CR &= ~DMA_SxCR_EN;
+    while (hw->stream->CR & DMA_SxCR_EN);
+    Adc_DmaClear(hw->streamIndex, ADC_DMA_ALL);
+
+    hw->stream->PAR = source;
+    hw->stream->M0AR = (uint32_t)unit->buffer;
+    hw->stream->NDTR = words ? unit->blockSamples : 2U * unit->blockSamples;
+    hw->stream->FCR = 0;    /* Direct mode */
+    hw->stream->CR = ((uint32_t)hw->dmaChannel << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | size |
+                     DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_HTIE | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    hw->stream->CR |= DMA_SxCR_EN;
+}
+
+/* TIM8 update events at rateHz; returns the exact rate in mHz */
+static uint32_t Adc_StartTrigger(uint32_t rateHz) {
+    uint32_t total = (ADC_TIMER_HZ + rateHz / 2) / rateHz;
+    uint32_t prescaler = total / 0x10000UL + 1;
+    uint32_t reload = (total + prescaler / 2) / prescaler;
+
+    RCC->APB2ENR |= RCC_APB2ENR_TIM8EN;
+    TIM8->CR1 = 0;
+    TIM8->CR2 = TIM_CR2_MMS_1;              /* TRGO on update */
+    TIM8->PSC = prescaler - 1;
+    TIM8->ARR = reload - 1;
+    TIM8->CNT = 0;
+    TIM8->EGR = TIM_EGR_UG;
+    TIM8->CR1 = TIM_CR1_CEN;
+
+    trigger_hz = rateHz;
+    return (uint32_t)((uint64_t)ADC_TIMER_HZ * 1000U / ((uint64_t)prescaler * reload));
+}
+
+static bool Adc_AnyRunning(void) {
+    return units[0].running || units[1].running || units[2].running;
+}
+
+static bool Adc_BufferOk(const Adc_Config* config) {
+    uint32_t addr = (uint32_t)config->buffer;
+
+    return config->buffer != NULL && config->callback != NULL && config->blockSamples != 0 &&
+           2UL * config->blockSamples <= ADC_MAX_BUFFER &&
+           !(addr >= 0x10000000UL && addr < 0x10010000UL);
+}
+
+void Adc_DefaultConfig(Adc_Config* config) {
+    if (config == NULL) {
+        return;
+    }
+    config->mode = ADC_MODE_INDEPENDENT;
+    config->unit = 1;
+    config->channels[0] = ADC_CHANNEL_TEMP;
+    config->channels[1] = ADC_CHANNEL_VREFINT;
+    config->channelCount = 2;
+    config->sampleTime = ADC_INTERNAL_SAMPLE;
+    config->rateHz = 1000;
+    config->buffer = NULL;
+    config->blockSamples = 64;
+    config->callback = NULL;
+}
+
+static Adc_Error Adc_StartIndependent(const Adc_Config* config) {
+    uint8_t index = (uint8_t)(config->unit - 1);
+    const Adc_Hw* hw = &adc_hw[index];
+    bool internal = false;
+    uint32_t scanCycles = 0;
+
+    if (config->unit < 1 || config->unit > 3 || config->rateHz == 0 ||
+        config->channelCount == 0 || config->channelCount > ADC_MAX_CHANNELS ||
+        config->blockSamples % config->channelCount != 0) {
+        return ADC_ERROR_PARAM;
+    }
+    for (uint8_t i = 0; i < config->channelCount; i++) {
+        uint8_t channel = config->channels[i];
+        if (channel > ADC_CHANNEL_VREFINT || (channel >= ADC_CHANNEL_TEMP && config->unit != 1)) {
+            return ADC_ERROR_PARAM;
+        }
+        internal |= (channel >= ADC_CHANNEL_TEMP);
+        scanCycles += sample_cycles[Adc_ChannelSample(channel, config->sampleTime)] + 12U;
+    }
+
+    /* The scan must end before the next trigger */
+    if ((uint64_t)scanCycles * config->rateHz >= ADC_CLOCK_HZ) {
+        return ADC_ERROR_RATE;
+    }
+
+    /* One trigger timer for all units */
+    if (units[index].running || (Adc_AnyRunning() && (active_mode != ADC_MODE_INDEPENDENT ||
+                                                      trigger_hz != config->rateHz))) {
+        return ADC_ERROR_BUSY;
+    }
+
+    Adc_Unit* unit = &units[index];
+    unit->callback = config->callback;
+    unit->buffer = config->buffer;
+    unit->blockSamples = config->blockSamples;
+    unit->adcs = 1;
+    unit->blocks = 0;
+    unit->overruns = 0;
+    unit->dmaErrors = 0;
+
+    RCC->APB2ENR |= hw->clock;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    /* ADCCLK = PCLK2 / 2, no multi-mode; other units may use the sensor */
+    ADC->CCR = (ADC->CCR & ~(ADC_CCR_ADCPRE | ADC_CCR_MULTI | ADC_CCR_DMA | ADC_CCR_DDS)) |
+               (internal ? ADC_CCR_TSVREFE : 0);
+
+    hw->adc->CR2 = 0;
+    hw->adc->SR = 0;
+    hw->adc->CR1 = ADC_CR1_SCAN | ADC_CR1_OVRIE;
+    for (uint8_t i = 0; i < config->channelCount; i++) {
+        uint8_t channel = config->channels[i];
+        Adc_ConfigurePin(config->unit, channel);
+        Adc_SetSample(hw->adc, channel, Adc_ChannelSample(channel, config->sampleTime));
+    }
+    Adc_SetSequence(hw->adc, config->channels, config->channelCount);
+
+    Adc_DmaArm(index, (uint32_t)&hw->adc->DR, false);
+    NVIC_EnableIRQ(hw->irq);
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    hw->adc->CR2 = ((uint32_t)ADC_EXTEN_RISING << ADC_CR2_EXTEN_Pos) |
+                   ((uint32_t)ADC_EXTSEL_TIM8_TRGO << ADC_CR2_EXTSEL_Pos) |
+                   ADC_CR2_DDS | ADC_CR2_DMA | ADC_CR2_ADON;
+
+    active_mode = ADC_MODE_INDEPENDENT;
+    unit->running = true;
+    if (trigger_hz == 0) {
+        trigger_mhz = Adc_StartTrigger(config->rateHz);
+    }
+    unit->rateMilliHz = trigger_mhz;
+
+    return ADC_OK;
+}
+
+static Adc_Error Adc_StartInterleaved(const Adc_Config* config) {
+    uint8_t adcs = (config->mode == ADC_MODE_TRIPLE_INTERLEAVED) ? 3 : 2;
+    uint8_t channel = config->channels[0];
+
+    /* Triple mode needs an input wired to all three ADCs */
+    if (config->channelCount != 1 || channel > 15 ||
+        (adcs == 3 && pins_adc3[channel].port != pins_adc12[channel].port) ||
+        config->blockSamples % (2U * adcs) != 0 || ((uint32_t)config->buffer & 3U) != 0) {
+        return ADC_ERROR_PARAM;
+    }
+    if (Adc_AnyRunning()) {
+        return ADC_ERROR_BUSY;
+    }
+
+    /* ADC n+1 starts `delay` cycles after ADC n; the smallest delay that
+     * still lets each ADC finish before its next turn gives the rate */
+    uint32_t conversion = sample_cycles[config->sampleTime] + 12U;
+    uint32_t delay = (conversion + adcs - 1) / adcs;
+    if (delay < ADC_DELAY_MIN) {
+        delay = ADC_DELAY_MIN;
+    }
+    if (delay > ADC_DELAY_MAX) {
+        return ADC_ERROR_RATE;
+    }
+
+    Adc_Unit* unit = &units[0];
+    unit->callback = config->callback;
+    unit->buffer = config->buffer;
+    unit->blockSamples = config->blockSamples;
+    unit->adcs = adcs;
+    unit->blocks = 0;
+    unit->overruns = 0;
+    unit->dmaErrors = 0;
+    unit->rateMilliHz = (uint32_t)((uint64_t)ADC_CLOCK_HZ * 1000U / delay);
+
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    for (uint8_t i = 0; i < adcs; i++) {
+        ADC_TypeDef* adc = adc_hw[i].adc;
+        RCC->APB2ENR |= adc_hw[i].clock;
+        adc->CR2 = 0;
+        adc->SR = 0;
+        adc->CR1 = ADC_CR1_OVRIE;
+        Adc_ConfigurePin((uint8_t)(i + 1), channel);
+        Adc_SetSample(adc, channel, config->sampleTime);
+        Adc_SetSequence(adc, &channel, 1);
+        adc->CR2 = ADC_CR2_CONT | ADC_CR2_ADON;
+    }
+
+    ADC->CCR = ((delay - ADC_DELAY_MIN) << ADC_CCR_DELAY_Pos) |
+               (ADC_CCR_DMA_MODE2 << ADC_CCR_DMA_Pos) | ADC_CCR_DDS |
+               ((adcs == 3) ? ADC_MULTI_TRIPLE_INTERLEAVED : ADC_MULTI_DUAL_INTERLEAVED);
+
+    Adc_DmaArm(0, (uint32_t)&ADC->CDR, true);
+    NVIC_EnableIRQ(adc_hw[0].irq);
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    active_mode = config->mode;
+    unit->running = true;
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+
+    return ADC_OK;
+}
+
+Adc_Error Adc_Start(const Adc_Config* config) {
+    if (config == NULL || !Adc_BufferOk(config) || config->sampleTime > ADC_SAMPLE_480) {
+        return ADC_ERROR_PARAM;
+    }
+    if (config->mode == ADC_MODE_INDEPENDENT) {
+        return Adc_StartIndependent(config);
+    }
+    if (config->mode == ADC_MODE_DUAL_INTERLEAVED || config->mode == ADC_MODE_TRIPLE_INTERLEAVED) {
+        return Adc_StartInterleaved(config);
+    }
+    return ADC_ERROR_PARAM;
+}
+
+void Adc_Stop(uint8_t unit) {
+    if (unit < 1 || unit > 3 || !units[unit - 1].running) {
+        return;
+    }
+    uint8_t index = (uint8_t)(unit - 1);
+    uint8_t adcs = units[index].adcs;
+
+    /* An interleaved unit owns ADC1 to ADC1+adcs-1 */
+    for (uint8_t i = index; i < index + adcs; i++) {
+        adc_hw[i].adc->CR2 = 0;
+        adc_hw[i].adc->CR1 = 0;
+    }
+    if (adcs > 1) {
+        ADC->CCR &= ~(ADC_CCR_MULTI | ADC_CCR_DMA | ADC_CCR_DDS | ADC_CCR_DELAY);
+    }
+
+    const Adc_Hw* hw = &adc_hw[index];
+    hw->stream->CR &= ~DMA_SxCR_EN;
+    while (hw->stream->CR & DMA_SxCR_EN);
+    Adc_DmaClear(hw->streamIndex, ADC_DMA_ALL);
+    NVIC_DisableIRQ(hw->irq);
+
+    units[index].running = false;
+    active_mode = ADC_MODE_INDEPENDENT;
+
+    if (!Adc_AnyRunning()) {
+        NVIC_DisableIRQ(ADC_IRQn);
+        TIM8->CR1 = 0;
+        trigger_hz = 0;
+    }
+}
+
+void Adc_GetStats(uint8_t unit, Adc_Stats* stats) {
+    if (stats == NULL || unit < 1 || unit > 3) {
+        return;
+    }
+    const Adc_Unit* u = &units[unit - 1];
+    stats->blocks = u->blocks;
+    stats->overruns = u->overruns;
+    stats->dmaErrors = u->dmaErrors;
+    stats->rateMilliHz = u->running ? u->rateMilliHz : 0;
+    stats->running = u->running;
+}
+
+uint32_t Adc_VddaMillivolts(uint16_t vrefRaw) {
+    if (vrefRaw == 0) {
+        return 0;
+    }
+    return (ADC_CAL_MV * ADC_VREFINT_CAL + vrefRaw / 2U) / vrefRaw;
+}
+
+int32_t Adc_TemperatureCentiC(uint16_t tempRaw, uint16_t vrefRaw) {
+    int32_t cal1 = ADC_TS_CAL1;
+    int32_t cal2 = ADC_TS_CAL2;
+
+    if (vrefRaw == 0 || cal2 == cal1) {
+        return 0;
+    }
+
+    /* Rescale to what the sensor would read at VDDA = 3.3 V, in 1/16 LSB */
+    int32_t scaled = (int32_t)(((uint32_t)tempRaw * ADC_VREFINT_CAL * 16U) / vrefRaw);
+    return 3000 + ((scaled - cal1 * 16) * 8000) / ((cal2 - cal1) * 16);
+}
+
+/* Restart the DMA from the top of the buffer after an overrun or a bus
+ * error; the next trigger starts a fresh scan */
+static void Adc_Recover(uint8_t index) {
+    Adc_Unit* unit = &units[index];
+
+    if (unit->adcs == 1) {
+        ADC_TypeDef* adc = adc_hw[index].adc;
+        adc->CR2 &= ~ADC_CR2_DMA;
+        Adc_DmaArm(index, (uint32_t)&adc->DR, false);
+        adc->SR &= ~ADC_SR_OVR;
+        adc->CR2 |= ADC_CR2_DMA;
+        return;
+    }
+
+    uint32_t ccr = ADC->CCR;
+    for (uint8_t i = 0; i < unit->adcs; i++) {
+        adc_hw[i].adc->CR2 &= ~ADC_CR2_CONT;
+    }
+    ADC->CCR = ccr & ~ADC_CCR_DMA;
+    Adc_DmaArm(0, (uint32_t)&ADC->CDR, true);
+    for (uint8_t i = 0; i < unit->adcs; i++) {
+        adc_hw[i].adc->SR &= ~ADC_SR_OVR;
+        adc_hw[i].adc->CR2 |= ADC_CR2_CONT;
+    }
+    ADC->CCR = ccr;
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+}
+
+static void Adc_DmaIrq(uint8_t index) {
+    Adc_Unit* unit = &units[index];
+    uint8_t stream = adc_hw[index].streamIndex;
+    uint32_t flags = Adc_DmaFlags(stream);
+
+    Adc_DmaClear(stream, flags);
+
+    /* A late interrupt can see both halves done; deliver them in order */
+    if (flags & ADC_DMA_HTIF) {
+        unit->blocks++;
+        unit->callback((uint8_t)(index + 1), unit->buffer, unit->blockSamples);
+    }
+    if (flags & ADC_DMA_TCIF) {
+        unit->blocks++;
+        unit->callback((uint8_t)(index + 1), unit->buffer + unit->blockSamples, unit->blockSamples);
+    }
+    if (flags & ADC_DMA_TEIF) {
+        unit->dmaErrors++;
+        Adc_Recover(index);
+    }
+}
+
+void DMA2_Stream4_IRQHandler(void) {
+    Adc_DmaIrq(0);
+}
+
+void DMA2_Stream2_IRQHandler(void) {
+    Adc_DmaIrq(1);
+}
+
+void DMA2_Stream1_IRQHandler(void) {
+    Adc_DmaIrq(2);
+}
+
+/* Shared by ADC1-3; only overruns are enabled */
+void ADC_IRQHandler(void) {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (!units[i].running) {
+            continue;
+        }
+        bool overrun = false;
+        for (uint8_t n = i; n < i + units[i].adcs; n++) {
+            overrun |= (adc_hw[n].adc->SR & ADC_SR_OVR) != 0;
+        }
+        if (overrun) {
+            units[i].overruns++;
+            Adc_Recover(i);
+        }
+    }
+}
+
+/* ---- Shell command ---- */
+
+#define ADC_DEMO_SCANS          16
+#define ADC_DEMO_BLOCKS         8
+#define ADC_DEMO_TIMEOUT_MS     1000
+
+static uint16_t adc_demo_buffer[2 * 2 * ADC_DEMO_SCANS];
+static volatile uint32_t adc_demo_temp;
+static volatile uint32_t adc_demo_vref;
+static volatile uint32_t adc_demo_blocks;
+
+/* Sums the temperature/VREFINT pairs of each block */
+static void Adc_DemoBlock(uint8_t unit, const uint16_t* samples, uint16_t count) {
+    uint32_t temp = 0;
+    uint32_t vref = 0;
+
+    for (uint16_t i = 0; i < count; i += 2) {
+        temp += samples[i];
+        vref += samples[i + 1];
+    }
+    if (adc_demo_blocks < ADC_DEMO_BLOCKS) {
+        adc_demo_temp += temp;
+        adc_demo_vref += vref;
+        adc_demo_blocks++;
+    }
+}
+
+/* Ctrl-C while waiting for the demo's blocks */
+static void Adc_DemoAbort(void) {
+    Adc_Stop(1);
+}
+
+static Shell_Status Adc_Cmd(int argc, char* argv[]) {
+    static uint32_t start_ms;
+    Adc_Stats stats;
+
+    if (argc == 2 && strcmp(argv[1], "stats") == 0) {
+        for (uint8_t unit = 1; unit <= 3; unit++) {
+            Adc_GetStats(unit, &stats);
+            FMT_Print("ADC%u %s  %lu blocks, %lu overruns, %lu DMA errors, %lu.%03lu Hz\r\n",
+                      unit, stats.running ? "on " : "off", stats.blocks, stats.overruns,
+                      stats.dmaErrors, stats.rateMilliHz / 1000, stats.rateMilliHz % 1000);
+        }
+        return SHELL_OK;
+    }
+    if (argc != 1) {
+        return SHELL_ERROR_USAGE;
+    }
+
+    /* Start a short temperature/VREFINT scan, then poll for its blocks */
+    if (Shell_GetStep() == 0) {
+        Adc_Config config;
+        Adc_DefaultConfig(&config);
+        config.buffer = adc_demo_buffer;
+        config.blockSamples = 2 * ADC_DEMO_SCANS;
+        config.callback = Adc_DemoBlock;
+
+        adc_demo_temp = 0;
+        adc_demo_vref = 0;
+        adc_demo_blocks = 0;
+        if (Adc_Start(&config) != ADC_OK) {
+            FMT_Print("ADC1 is in use\r\n");
+            return SHELL_ERROR_FAILED;
+        }
+        start_ms = systick_counter;
+        Shell_SetAbortHandler(Adc_DemoAbort);
+        return SHELL_MORE;
+    }
+
+    if (adc_demo_blocks < ADC_DEMO_BLOCKS) {
+        if (systick_counter - start_ms < ADC_DEMO_TIMEOUT_MS) {
+            return SHELL_MORE;
+        }
+        Adc_Stop(1);
+        FMT_Print("no data after %u ms\r\n", ADC_DEMO_TIMEOUT_MS);
+        return SHELL_ERROR_FAILED;
+    }
+
+    Adc_GetStats(1, &stats);
+    Adc_Stop(1);
+
+    uint32_t scans = ADC_DEMO_BLOCKS * ADC_DEMO_SCANS;
+    uint16_t temp = (uint16_t)(adc_demo_temp / scans);
+    uint16_t vref = (uint16_t)(adc_demo_vref / scans);
+    int32_t centi = Adc_TemperatureCentiC(temp, vref);
+    uint32_t magnitude = (uint32_t)((centi < 0) ? -centi : centi);
+    FMT_Print("%s%lu.%02lu C, VDDA %lu mV (%lu scans at %lu Hz, %lu overruns)\r\n",
+              (centi < 0) ? "-" : "", magnitude / 100, magnitude % 100,
+              Adc_VddaMillivolts(vref), scans, stats.rateMilliHz / 1000, stats.overruns);
+    return SHELL_OK;
+}
+SHELL_COMMAND("adc", "[stats]", "Die temperature and VDDA from a short ADC1 scan", Adc_Cmd);
@@ -0,0 +1,602 @@
+/* @at.c */
+#include "at.h"
+#include "at_match.h"
+#include "uart.h"
+#include "systick.h"
+#include <stddef.h>
+#include <string.h>
+
+#define AT_QUEUE_MASK           (AT_QUEUE_SIZE - 1U)
+#define AT_STREAM_TIMEOUT_MS    2000    /* AT+CIPMODE and AT+CIPSEND of transparent mode */
+
+/* Steps of At_StreamClose */
+typedef enum {
+    AT_ESCAPE_DRAIN = 0,        /* Output still leaving */
+    AT_ESCAPE_GUARD,            /* Quiet line before "+++" */
+    AT_ESCAPE_WAIT              /* "+++" sent, the module leaves data mode */
+} At_EscapeStep;
+
+typedef struct {
+    char command[AT_COMMAND_MAX];
+    const char* expect;
+    PBuf* payload;
+    At_LineCallback onLine;
+    At_DoneCallback onDone;
+    void* context;
+    uint32_t timeoutMs;
+    uint32_t sentAt;
+    uint16_t payloadSent;
+    uint8_t length;
+    bool pipelined;
+    bool prompted;              /* '>' seen, payload going out */
+    bool stream;                /* AT+CIPSEND of transparent mode: data from the '>' */
+} At_Slot;
+
+static At_Config at_config;
+static At_Stats at_stats;
+
+/* [head, sent) are in flight, oldest first; [sent, tail) wait */
+static At_Slot queue[AT_QUEUE_SIZE];
+static uint8_t queue_head;
+static uint8_t queue_sent;
+static uint8_t queue_tail;
+static uint8_t busy_skip;       /* "busy p..." still due for commands already resent */
+static bool busy_hold;          /* No pipelining until the oldest command completes */
+
+/* Lines are matched as they arrive; the copy is for onLine and +IPD */
+static At_Matcher matcher;
+static char line[AT_LINE_MAX];
+static uint16_t line_len;
+static bool line_long;
+
+/* +IPD payload being received; ipd_chain is NULL while dropping one */
+static PBuf* ipd_chain;
+static PBuf* ipd_segment;
+static uint16_t ipd_fill;       /* Bytes in ipd_segment */
+static uint16_t ipd_left;
+static uint8_t ipd_link;
+
+/* Transparent mode */
+static At_StreamState stream_state;
+static At_EscapeStep escape_step;
+static uint32_t escape_at;      /* Start of the current escape step */
+
+static uint32_t At_UartMillis(void) {
+    return systick_counter;
+}
+
+/* Data mode moves both directions by DMA: at 2 Mbaud an interrupt per byte
+ * would leave little of the core */
+static void At_UartStream(bool on) {
+    if (on) {
+        UART_StartReceiveDMA();
+        UART_StartTransmitDMA();
+    } else {
+        UART_StopTransmitDMA();
+        UART_StopReceiveDMA();
+        UART_StartReceiveIT();
+    }
+}
+
+static bool At_UartWriteIdle(void) {
+    return UART_IsTxIdle() && !UART_IsTxDmaBusy();
+}
+
+/* AT+CIPSEND payloads go by DMA from the segments, no copy into the ring */
+static bool At_UartWriteChain(PBuf* chain) {
+    return UART_WriteChainDMA(chain) == UART_OK;
+}
+
+const At_Port at_uart_port = {
+    UART_PeekRx, UART_ConsumeRx, UART_WriteAsync, UART_GetTxFree, At_UartMillis,
+    At_UartStream, At_UartWriteIdle, At_UartWriteChain
+};
+
+At_Error At_Init(const At_Config* config) {
+    if (config == NULL || config->port == NULL || config->port->peek == NULL ||
+        config->port->consume == NULL || config->port->write == NULL ||
+        config->port->writeFree == NULL || config->port->millis == NULL) {
+        return AT_ERROR_PARAM;
+    }
+
+    /* Payloads of a previous session */
+    for (uint8_t i = queue_head; i != queue_tail; i++) {
+        if (queue[i & AT_QUEUE_MASK].payload != NULL) {
+            PBuf_Free(queue[i & AT_QUEUE_MASK].payload);
+        }
+    }
+    if (ipd_chain != NULL) {
+        PBuf_Free(ipd_chain);
+    }
+
+    at_config = *config;
+    memset(&at_stats, 0, sizeof(at_stats));
+    queue_head = 0;
+    queue_sent = 0;
+    queue_tail = 0;
+    busy_skip = 0;
+    busy_hold = false;
+    At_MatchReset(&matcher);
+    line_len = 0;
+    line_long = false;
+    ipd_chain = NULL;
+    ipd_left = 0;
+    stream_state = AT_STREAM_OFF;
+    return AT_OK;
+}
+
+static At_Error At_Queue(const At_Request* request, bool stream) {
+    if (request == NULL || request->command == NULL ||
+        (request->payload != NULL && request->pipelined)) {
+        return AT_ERROR_PARAM;
+    }
+    size_t length = strlen(request->command);
+    if (length + 2 > AT_COMMAND_MAX) {
+        return AT_ERROR_PARAM;
+    }
+    if ((uint8_t)(queue_tail - queue_head) >= AT_QUEUE_SIZE) {
+        return AT_ERROR_FULL;
+    }
+
+    At_Slot* slot = &queue[queue_tail & AT_QUEUE_MASK];
+    memcpy(slot->command, request->command, length);
+    slot->command[length] = '\r';
+    slot->command[length + 1] = '\n';
+    slot->length = (uint8_t)(length + 2);
+    slot->expect = request->expect ? request->expect : (request->payload ? "SEND OK" : "OK");
+    slot->payload = request->payload;
+    slot->payloadSent = 0;
+    slot->onLine = request->onLine;
+    slot->onDone = request->onDone;
+    slot->context = request->context;
+    slot->timeoutMs = request->timeoutMs;
+    slot->pipelined = request->pipelined;
+    slot->stream = stream;
+    queue_tail++;
+    return AT_OK;
+}
+
+At_Error At_Send(const At_Request* request) {
+    return At_Queue(request, false);
+}
+
+static void At_Complete(At_Result result) {
+    At_Slot* slot = &queue[queue_head & AT_QUEUE_MASK];
+
+    if (slot->payload != NULL) {
+        PBuf_Free(slot->payload);
+        slot->payload = NULL;
+    }
+    at_stats.commands++;
+    if (result == AT_RESULT_ERROR) {
+        at_stats.errors++;
+    } else if (result == AT_RESULT_TIMEOUT) {
+        at_stats.timeouts++;
+    }
+    queue_head++;
+    busy_hold = false;
+    if (slot->stream && result != AT_RESULT_OK) {
+        stream_state = AT_STREAM_OFF;
+    }
+
+    /* The slot is free again, so the callback may queue the next command */
+    if (slot->onDone != NULL) {
+        slot->onDone(result, slot->context);
+    }
+}
+
+/* The module dropped the pipelined commands that arrived while it was busy
+ * with the oldest one: one "busy p..." each. Send them again after it. */
+static void At_Busy(void) {
+    uint8_t inflight = (uint8_t)(queue_sent - queue_head);
+
+    if (busy_skip != 0) {
+        busy_skip--;
+    } else if (inflight > 1) {
+        busy_skip = (uint8_t)(inflight - 2);
+        queue_sent = (uint8_t)(queue_head + 1);
+        busy_hold = true;
+        at_stats.resent += inflight - 1U;
+    }
+}
+
+static void At_Line(void) {
+    At_Match match;
+    bool waiting = queue_sent != queue_head;
+    At_Slot* slot = &queue[queue_head & AT_QUEUE_MASK];
+
+    At_MatchEnd(&matcher, &match);
+    if (line_long) {
+        at_stats.longLines++;
+    }
+
+    switch (match.token) {
+    case AT_TOKEN_ECHO:
+        return;
+    case AT_TOKEN_BUSY:
+        At_Busy();
+        return;
+    case AT_TOKEN_READY:
+    case AT_TOKEN_WIFI_CONNECTED:
+    case AT_TOKEN_WIFI_GOT_IP:
+    case AT_TOKEN_WIFI_DISCONNECT:
+    case AT_TOKEN_CONNECT:
+    case AT_TOKEN_CONNECT_FAIL:
+    case AT_TOKEN_CLOSED:
+        at_stats.urcs++;
+        if (at_config.onUrc != NULL) {
+            at_config.onUrc((At_Urc)(match.token - AT_TOKEN_READY), match.link);
+        }
+        return;
+    case AT_TOKEN_ERROR:
+    case AT_TOKEN_FAIL:
+    case AT_TOKEN_SEND_FAIL:
+        if (waiting) {
+            At_Complete(AT_RESULT_ERROR);
+            return;
+        }
+        break;
+    default:
+        /* "OK" only ends a command expecting it, not AT+CIPSEND */
+        if (waiting && slot->stream) {
+            /* "OK" before the '>': data mode starts at the prompt */
+            return;
+        }
+        if (waiting && strlen(slot->expect) == line_len &&
+            memcmp(slot->expect, line, line_len) == 0) {
+            At_Complete(AT_RESULT_OK);
+            return;
+        }
+        if (waiting) {
+            if (slot->onLine != NULL) {
+                slot->onLine(line, line_len, slot->context);
+            }
+            return;
+        }
+        break;
+    }
+    at_stats.unexpected++;
+}
+
+/* "+IPD,<link>,<length>" or "+IPD,<length>", and with AT+CIPDINFO=1
+ * ",<ip>,<port>" after them. Older firmware leaves the <ip> unquoted: a
+ * number ending in '.' is its first octet, not a length. */
+static bool At_IpdStart(void) {
+    At_Match match;
+    uint32_t values[2] = { 0, 0 };
+    uint8_t count = 0;
+
+    At_MatchEnd(&matcher, &match);
+    uint16_t i = match.payload;
+
+    while (count < 2 && i < line_len - 1) {
+        if (line[i] < '0' || line[i] > '9') {
+            /* A quoted <ip> ends the numbers */
+            break;
+        }
+        while (line[i] >= '0' && line[i] <= '9') {
+            values[count] = values[count] * 10U + (uint32_t)(line[i++] - '0');
+            if (values[count] > 0xFFFFU) {
+                return false;
+            }
+        }
+        if (line[i] == '.') {
+            break;
+        }
+        count++;
+        if (line[i] != ',') {
+            break;
+        }
+        i++;
+    }
+    if (count == 0 || line_long) {
+        return false;
+    }
+
+    ipd_link = (count == 2) ? (uint8_t)values[0] : AT_NO_LINK;
+    ipd_fill = 0;
+    ipd_chain = NULL;
+    if (values[count - 1] > AT_IPD_MAX) {
+        /* A corrupted length: skip no more than the module could have sent */
+        ipd_left = AT_IPD_MAX;
+    } else {
+        ipd_left = (uint16_t)values[count - 1];
+        if (ipd_left != 0 && at_config.onData != NULL) {
+            ipd_chain = PBuf_Alloc(ipd_left, 0);
+        }
+    }
+    ipd_segment = ipd_chain;
+    if (ipd_chain == NULL) {
+        at_stats.ipdDropped += ipd_left;
+    }
+    return true;
+}
+
+/* Straight from the receive ring into the chain's segments */
+static void At_IpdCopy(const uint8_t* data, uint16_t size) {
+    ipd_left -= size;
+    while (ipd_chain != NULL && size != 0) {
+        if (ipd_segment == NULL) {
+            /* Chain shorter than announced: drop it and the rest */
+            at_stats.ipdDropped += ipd_chain->totLen + size + ipd_left;
+            PBuf_Free(ipd_chain);
+            ipd_chain = NULL;
+            break;
+        }
+        uint16_t n = ipd_segment->len - ipd_fill;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(ipd_segment->payload + ipd_fill, data, n);
+        data += n;
+        size -= n;
+        ipd_fill += n;
+        if (ipd_fill == ipd_segment->len) {
+            ipd_segment = ipd_segment->next;
+            ipd_fill = 0;
+        }
+    }
+
+    if (ipd_left == 0 && ipd_chain != NULL) {
+        PBuf* chain = ipd_chain;
+        ipd_chain = NULL;
+        at_stats.ipdBytes += chain->totLen;
+        at_config.onData(ipd_link, chain);
+    }
+}
+
+/* The '>' of a transparent AT+CIPSEND: what follows is the connection's */
+static void At_StreamStart(void) {
+    stream_state = AT_STREAM_DATA;
+    if (at_config.port->stream != NULL) {
+        at_config.port->stream(true);
+    }
+    At_Complete(AT_RESULT_OK);
+}
+
+/* Returns the bytes used, all of them unless data mode started */
+static uint16_t At_Receive(const uint8_t* data, uint16_t size) {
+    const uint8_t* start = data;
+    const uint8_t* end = data + size;
+
+    while (data < end) {
+        if (ipd_left != 0) {
+            uint16_t n = (uint16_t)(end - data);
+            if (n > ipd_left) {
+                n = ipd_left;
+            }
+            At_IpdCopy(data, n);
+            data += n;
+            continue;
+        }
+
+        uint8_t c = *data++;
+        if (c == '\n') {
+            if (line_len != 0) {
+                At_Line();
+            }
+            At_MatchReset(&matcher);
+            line_len = 0;
+            line_long = false;
+        } else if (c == '\r' || (c == ' ' && line_len == 0)) {
+            /* CR before LF, and the space after the '>' prompt */
+        } else if (c == '>' && line_len == 0 && queue_sent != queue_head &&
+                   queue[queue_head & AT_QUEUE_MASK].payload != NULL) {
+            queue[queue_head & AT_QUEUE_MASK].prompted = true;
+        } else if (c == '>' && line_len == 0 && queue_sent != queue_head &&
+                   queue[queue_head & AT_QUEUE_MASK].stream) {
+            At_StreamStart();
+            return (uint16_t)(data - start);
+        } else {
+            At_MatchByte(&matcher, c);
+            if (line_len < AT_LINE_MAX) {
+                line[line_len++] = (char)c;
+            } else {
+                line_long = true;
+            }
+            if (c == ':' && At_MatchToken(&matcher) == AT_TOKEN_IPD && At_IpdStart()) {
+                At_MatchReset(&matcher);
+                line_len = 0;
+            }
+        }
+    }
+    return size;
+}
+
+/* From the segments into the port, as far as it has room */
+static void At_WritePayload(At_Slot* slot) {
+    const At_Port* port = at_config.port;
+    PBuf_Iterator it;
+    const uint8_t* addr;
+    uint16_t len;
+    uint16_t skip = slot->payloadSent;
+
+    /* The whole chain to the port if it takes one, else copied piecewise;
+     * a taken chain may be freed before the call returns */
+    if (skip == 0 && port->writeChain != NULL) {
+        uint16_t total = slot->payload->totLen;
+        if (port->writeChain(slot->payload)) {
+            slot->payloadSent = total;
+            slot->payload = NULL;
+            return;
+        }
+    }
+
+    PBuf_IterInit(&it, slot->payload);
+    while (PBuf_IterNext(&it, &addr, &len)) {
+        if (skip >= len) {
+            skip -= len;
+            continue;
+        }
+        uint16_t n = port->write(addr + skip, (uint16_t)(len - skip));
+        slot->payloadSent += n;
+        if (n != len - skip) {
+            return;
+        }
+        skip = 0;
+    }
+    PBuf_Free(slot->payload);
+    slot->payload = NULL;
+}
+
+/* Escape from data mode: "+++" alone, with a quiet line on both sides */
+static void At_Escape(uint32_t now) {
+    const At_Port* port = at_config.port;
+
+    switch (escape_step) {
+    case AT_ESCAPE_DRAIN:
+        if (port->writeIdle == NULL || port->writeIdle()) {
+            escape_at = now;
+            escape_step = AT_ESCAPE_GUARD;
+        }
+        break;
+    case AT_ESCAPE_GUARD:
+        if (now - escape_at >= AT_ESCAPE_GUARD_MS && port->writeFree() >= 3) {
+            port->write((const uint8_t*)"+++", 3);
+            escape_at = now;
+            escape_step = AT_ESCAPE_WAIT;
+        }
+        break;
+    case AT_ESCAPE_WAIT:
+        if (now - escape_at >= AT_ESCAPE_WAIT_MS) {
+            /* Whatever the connection sent and was not read is lost */
+            const uint8_t* data;
+            uint16_t size;
+            while ((size = port->peek(&data)) != 0) {
+                at_stats.streamDropped += size;
+                port->consume(size);
+            }
+            if (port->stream != NULL) {
+                port->stream(false);
+            }
+            At_MatchReset(&matcher);
+            line_len = 0;
+            line_long = false;
+            stream_state = AT_STREAM_OFF;
+        }
+        break;
+    }
+}
+
+bool At_Process(void) {
+    const At_Port* port = at_config.port;
+    const uint8_t* data;
+    uint16_t size;
+
+    if (port == NULL) {
+        return false;
+    }
+
+    uint32_t now = port->millis();
+    if (stream_state == AT_STREAM_CLOSING) {
+        At_Escape(now);
+        if (stream_state == AT_STREAM_CLOSING) {
+            return true;
+        }
+    }
+
+    while (stream_state != AT_STREAM_DATA && (size = port->peek(&data)) != 0) {
+        port->consume(At_Receive(data, size));
+    }
+    /* In data mode the bytes are the connection's and commands wait */
+    if (stream_state == AT_STREAM_DATA) {
+        return queue_tail != queue_head;
+    }
+
+    if (queue_sent != queue_head) {
+        At_Slot* slot = &queue[queue_head & AT_QUEUE_MASK];
+        if (slot->prompted && slot->payload != NULL) {
+            At_WritePayload(slot);
+        }
+        if (now - slot->sentAt >= slot->timeoutMs) {
+            At_Complete(AT_RESULT_TIMEOUT);
+        }
+    }
+
+    /* Whole commands only; a command that is not pipelined goes alone */
+    while (queue_sent != queue_tail) {
+        uint8_t inflight = (uint8_t)(queue_sent - queue_head);
+        At_Slot* slot = &queue[queue_sent & AT_QUEUE_MASK];
+        if (inflight != 0 && (busy_hold || !slot->pipelined || inflight >= AT_PIPELINE_DEPTH ||
+                              !queue[queue_head & AT_QUEUE_MASK].pipelined)) {
+            break;
+        }
+        if (port->writeFree() < slot->length) {
+            break;
+        }
+        port->write((const uint8_t*)slot->command, slot->length);
+        slot->sentAt = now;
+        slot->prompted = false;
+        queue_sent++;
+    }
+
+    return queue_tail != queue_head;
+}
+
+At_Error At_StreamOpen(At_DoneCallback onDone, void* context) {
+    At_Request mode = { .command = "AT+CIPMODE=1", .timeoutMs = AT_STREAM_TIMEOUT_MS };
+    At_Request send = {
+        .command = "AT+CIPSEND", .timeoutMs = AT_STREAM_TIMEOUT_MS,
+        .onDone = onDone, .context = context
+    };
+
+    if (at_config.port == NULL || stream_state != AT_STREAM_OFF) {
+        return AT_ERROR_STATE;
+    }
+    if ((uint8_t)(queue_tail - queue_head) > AT_QUEUE_SIZE - 2U) {
+        return AT_ERROR_FULL;
+    }
+    At_Queue(&mode, false);
+    At_Queue(&send, true);
+    stream_state = AT_STREAM_OPENING;
+    return AT_OK;
+}
+
+At_Error At_StreamClose(At_DoneCallback onDone, void* context) {
+    At_Request mode = {
+        .command = "AT+CIPMODE=0", .timeoutMs = AT_STREAM_TIMEOUT_MS,
+        .onDone = onDone, .context = context
+    };
+
+    if (stream_state != AT_STREAM_DATA) {
+        return AT_ERROR_STATE;
+    }
+    At_Error error = At_Queue(&mode, false);
+    if (error != AT_OK) {
+        return error;
+    }
+    stream_state = AT_STREAM_CLOSING;
+    escape_step = AT_ESCAPE_DRAIN;
+    return AT_OK;
+}
+
+uint16_t At_StreamWrite(const uint8_t* data, uint16_t size) {
+    if (stream_state != AT_STREAM_DATA || data == NULL) {
+        return 0;
+    }
+    uint16_t n = at_config.port->write(data, size);
+    at_stats.streamTx += n;
+    return n;
+}
+
+uint16_t At_StreamPeek(const uint8_t** data) {
+    if (stream_state != AT_STREAM_DATA && stream_state != AT_STREAM_CLOSING) {
+        return 0;
+    }
+    return at_config.port->peek(data);
+}
+
+void At_StreamConsume(uint16_t size) {
+    if (stream_state == AT_STREAM_DATA || stream_state == AT_STREAM_CLOSING) {
+        at_config.port->consume(size);
+        at_stats.streamRx += size;
+    }
+}
+
+At_StreamState At_GetStreamState(void) {
+    return stream_state;
+}
+
+void At_GetStats(At_Stats* stats) {
+    *stats = at_stats;
+}
@@ -0,0 +1,62 @@
+/* @at_match.c */
+#include "at_match.h"
+
+void At_MatchEnd(const At_Matcher* m, At_Match* match) {
+    uint8_t state = (m->left != 0) ? at_match_fail[m->state] : m->state;
+    uint8_t token = at_match_token[state];
+
+    match->token = token & (uint8_t)~AT_MATCH_LINKED;
+    match->link = (token & AT_MATCH_LINKED) ? (uint8_t)(m->first - '0') : AT_MATCH_NO_LINK;
+    match->payload = at_match_depth[state];
+    match->length = m->length;
+}
+
+/* At_MatchByte with the state in registers for the whole run */
+bool At_MatchFeed(At_Matcher* m, const uint8_t** data, const uint8_t* end, At_Match* match) {
+    const uint8_t* p = *data;
+    const char* label = at_match_chars + m->label;
+    uint16_t length = m->length;
+    uint8_t left = m->left;
+    uint8_t state = m->state;
+    uint8_t first = m->first;
+    bool ended = false;
+
+    while (p < end) {
+        uint8_t c = *p++;
+        if (c == '\n') {
+            ended = true;
+            break;
+        }
+        if (c == '\r') {
+            continue;
+        }
+        if (length++ == 0) {
+            first = c;
+        }
+        if (left != 0) {
+            if ((char)c == *label) {
+                label++;
+                left--;
+            } else {
+                state = at_match_fail[state];
+                left = 0;
+            }
+        } else {
+            state = at_match_next[state][at_match_class[c]];
+            label = at_match_chars + at_match_label[state];
+            left = at_match_length[state];
+        }
+    }
+
+    *data = p;
+    m->length = length;
+    m->label = (uint16_t)(label - at_match_chars);
+    m->left = left;
+    m->state = state;
+    m->first = first;
+    if (ended) {
+        At_MatchEnd(m, match);
+        At_MatchReset(m);
+    }
+    return ended;
+}
@@ -0,0 +1,219 @@
+/* @at_match_bench.c - Trie matcher against a strncmp chain on generated modem output */
+#include "at_match.h"
+#include "at.h"
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+#define ATMB_SEED               9001UL
+#define ATMB_CORPUS             4096
+#define ATMB_LINES              512
+#define ATMB_CPU_HZ             16000000UL
+#define ATMB_BAUD               921600UL        /* 10 bits a byte */
+
+static char corpus[ATMB_CORPUS];
+/* Token and link of each non-empty line, per matcher */
+static uint16_t trie_result[ATMB_LINES];
+static uint16_t scan_result[ATMB_LINES];
+
+static uint32_t Atmb_Random(uint32_t* seed, uint32_t range) {
+    *seed = *seed * 1664525UL + 1013904223UL;
+    return (*seed >> 16) % range;
+}
+
+/* A connection's worth of traffic: results after a blank line as the
+ * module sends them, URCs, status and scan lines, echoes, +IPD headers
+ * with short text payloads, and boot noise that matches nothing */
+static uint32_t Atmb_Corpus(void) {
+    uint32_t seed = ATMB_SEED;
+    uint32_t len = 0;
+
+    while (len + 128 < ATMB_CORPUS) {
+        char* p = corpus + len;
+        uint32_t room = ATMB_CORPUS - len;
+        uint32_t link = Atmb_Random(&seed, AT_MAX_LINKS);
+        int n;
+
+        switch (Atmb_Random(&seed, 16)) {
+        case 0:
+        case 1:
+        case 2:
+            n = FMT_Format(p, room, "\r\nOK\r\n");
+            break;
+        case 3:
+            n = FMT_Format(p, room, "\r\nRecv %lu bytes\r\n\r\nSEND OK\r\n",
+                           16 + Atmb_Random(&seed, 1000));
+            break;
+        case 4:
+            n = FMT_Format(p, room, "\r\n+IPD,%lu,10:temp=23.%lu\r\n", link,
+                           10 + Atmb_Random(&seed, 90));
+            break;
+        case 5:
+            n = FMT_Format(p, room, "%lu,CONNECT\r\n", link);
+            break;
+        case 6:
+            n = FMT_Format(p, room, "%lu,CLOSED\r\n", link);
+            break;
+        case 7:
+            n = FMT_Format(p, room, "STATUS:3\r\n+CIPSTATUS:%lu,\"TCP\",\"10.0.0.%lu\",8080,%lu,0\r\n",
+                           link, 1 + Atmb_Random(&seed, 254), 4000 + Atmb_Random(&seed, 999));
+            break;
+        case 8:
+            n = FMT_Format(p, room, "+CWLAP:(3,\"lab-%lu\",-%lu,\"de:ad:be:ef:00:%02lx\",%lu)\r\n",
+                           Atmb_Random(&seed, 10), 40 + Atmb_Random(&seed, 50),
+                           Atmb_Random(&seed, 256), 1 + Atmb_Random(&seed, 13));
+            break;
+        case 9:
+            n = FMT_Format(p, room, "AT+CIPSEND=%lu,%lu\r\n", link, 16 + Atmb_Random(&seed, 1000));
+            break;
+        case 10:
+            n = FMT_Format(p, room, "busy p...\r\n");
+            break;
+        case 11:
+            n = FMT_Format(p, room, "WIFI DISCONNECT\r\nWIFI CONNECTED\r\nWIFI GOT IP\r\n");
+            break;
+        case 12:
+            n = FMT_Format(p, room, "+CIFSR:STAIP,\"192.168.4.%lu\"\r\n", 2 + Atmb_Random(&seed, 250));
+            break;
+        case 13:
+            n = FMT_Format(p, room, "\r\nERROR\r\n");
+            break;
+        case 14:
+            n = FMT_Format(p, room, "AT version:1.7.4.0(May 11 2020 19:13:04)\r\n");
+            break;
+        default:
+            n = FMT_Format(p, room, "rf cal sector: %lu\r\n", 1000 + Atmb_Random(&seed, 24));
+            break;
+        }
+        len += (uint32_t)n;
+    }
+    return len;
+}
+
+/* The naive way: find the line end, then try every pattern in turn */
+static uint16_t Atmb_Scan(const char* line, uint16_t len) {
+    uint8_t link = AT_NO_LINK;
+
+    if (len > 2 && line[0] >= '0' && line[0] < '0' + AT_MAX_LINKS && line[1] == ',') {
+        link = (uint8_t)(line[0] - '0');
+    }
+    for (uint8_t i = 0; i < AT_MATCH_PATTERNS; i++) {
+        const At_MatchPattern* pattern = &at_match_patterns[i];
+        const char* start = line;
+        uint16_t n = len;
+        if (pattern->flags & AT_MATCH_LINKED) {
+            if (link == AT_NO_LINK) {
+                continue;
+            }
+            start += 2;
+            n -= 2;
+        }
+        size_t size = strlen(pattern->text);
+        if (((pattern->flags & AT_MATCH_PREFIX) ? n >= size : n == size) &&
+            strncmp(start, pattern->text, size) == 0) {
+            return (uint16_t)(pattern->token |
+                              ((pattern->flags & AT_MATCH_LINKED) ? link : AT_NO_LINK) << 8);
+        }
+    }
+    return AT_NO_LINK << 8;
+}
+
+static uint32_t Atmb_RunScan(uint32_t len) {
+    const char* p = corpus;
+    const char* end = corpus + len;
+    uint32_t lines = 0;
+
+    while (p < end) {
+        const char* lf = memchr(p, '\n', (size_t)(end - p));
+        uint16_t n = (uint16_t)(lf - p);
+        if (n != 0 && p[n - 1] == '\r') {
+            n--;
+        }
+        if (n != 0 && lines < ATMB_LINES) {
+            scan_result[lines++] = Atmb_Scan(p, n);
+        }
+        p = lf + 1;
+    }
+    return lines;
+}
+
+static uint32_t Atmb_RunTrie(uint32_t len) {
+    const uint8_t* p = (const uint8_t*)corpus;
+    const uint8_t* end = p + len;
+    At_Matcher matcher;
+    At_Match match;
+    uint32_t lines = 0;
+
+    At_MatchReset(&matcher);
+    while (At_MatchFeed(&matcher, &p, end, &match)) {
+        if (match.length != 0 && lines < ATMB_LINES) {
+            trie_result[lines++] = (uint16_t)(match.token | match.link << 8);
+        }
+    }
+    return lines;
+}
+
+static void Atmb_Report(const char* name, uint32_t cycles, uint32_t len) {
+    uint32_t cpb = (uint32_t)((uint64_t)cycles * 100U / len);
+    uint32_t bpc = (uint32_t)((uint64_t)len * 1000U / cycles);
+    /* Share of the core the matcher takes at the module's top UART rate */
+    uint32_t load = (uint32_t)((uint64_t)ATMB_BAUD / 10U * cycles * 1000U / len / ATMB_CPU_HZ);
+
+    FMT_Print("%-14s %8lu  %5lu.%02lu  %7lu.%03lu  %9lu.%lu%%\r\n", name, cycles,
+              cpb / 100, cpb % 100, bpc / 1000, bpc % 1000, load / 10, load % 10);
+}
+
+bool At_MatchBenchmarkStep(uint32_t step) {
+    static uint32_t len;
+    static uint32_t trieLines;
+    static uint32_t trieCycles;
+
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        len = Atmb_Corpus();
+        uint32_t start = DWT->CYCCNT;
+        trieLines = Atmb_RunTrie(len);
+        trieCycles = DWT->CYCCNT - start;
+
+        FMT_Print("atm: %lu lines, %lu bytes of modem output, %u patterns, %u-state trie\r\n",
+                  trieLines, len, AT_MATCH_PATTERNS, AT_MATCH_STATES);
+        FMT_Print("matcher          cycles  cycles/B  bytes/cycle  CPU at %lu baud\r\n", ATMB_BAUD);
+        Atmb_Report("trie", trieCycles, len);
+        return true;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    uint32_t scanLines = Atmb_RunScan(len);
+    uint32_t scanCycles = DWT->CYCCNT - start;
+
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < trieLines && i < scanLines; i++) {
+        mismatches += trie_result[i] != scan_result[i];
+    }
+    if (trieLines != scanLines) {
+        mismatches++;
+    }
+
+    Atmb_Report("strncmp chain", scanCycles, len);
+    uint32_t speedup = (uint32_t)((uint64_t)scanCycles * 100U / trieCycles);
+    FMT_Print("speedup %lu.%02lu, results %s\r\n", speedup / 100, speedup % 100,
+              mismatches ? "MISMATCH" : "agree");
+    return false;
+}
+
+void At_MatchRunBenchmark(void) {
+    for (uint32_t step = 0; At_MatchBenchmarkStep(step); step++) {
+        while (UART_GetTxFree() < SHELL_TX_RESERVE);
+    }
+}
+
+/* One matcher per call */
+static Shell_Status Atmb_Cmd(int argc, char* argv[]) {
+    return At_MatchBenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("atmbench", "", "AT response matcher against a strncmp chain, cycles and bytes/cycle",
+              Atmb_Cmd);
@@ -0,0 +1,378 @@
+/* @at_match_table.c - Generated by Tools/at_match_table.py, do not edit */
+#include "at_match.h"
+
+#if AT_MATCH_CLASSES != 29 || AT_MATCH_STATES != 98 || AT_MATCH_PATTERNS != 49
+#error "set AT_MATCH_CLASSES 29, AT_MATCH_STATES 98 and AT_MATCH_PATTERNS 49 in Inc/at_match.h"
+#endif
+
+/* 49 patterns, 98 states, 29 byte classes, 3973 bytes of tables */
+
+const uint8_t at_match_class[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  2,  0,  0,  0,  0,
+     3,  3,  3,  3,  3,  0,  0,  0,  0,  0,  4,  0,  0,  0,  0,  0,
+     0,  5,  6,  7,  8,  9, 10, 11,  0, 12, 13,  0, 14, 15, 16, 17,
+    18,  0, 19, 20, 21, 22,  0, 23,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0, 24, 25,  0,  0,  0,  0,  0,  0,  0,  0, 26,  0, 27,  0,
+     0,  0, 28,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+const uint8_t at_match_next[AT_MATCH_STATES][AT_MATCH_CLASSES] = {
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   6,   2,   0,   7,   8,   9,  10,  11,  12,   0,   0,   0,   0,   0,   0,  13,   0,  14,  15,   0,   0,  16,  17,  18,   3,   4,   5 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  19,   0,   0,  20,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,  21,  22,   0,   0,   0,  23,   0,  24,   0,   0,   0,  25,   0,  26,   0,  27,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  28,   0,   0,   0,   0,   0,   0,  29,   0,   0,   0,   0,   0,   0,   0 },
+    {  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  30,   0,   0,  31,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,  32,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  33,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,  34,  35,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  36,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,  37,  38,   0,   0,  39,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70 },
+    {  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,  40,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  41,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  42,   0,   0,   0,   0,   0 },
+    {  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72 },
+    {  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73 },
+    {  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74 },
+    {  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75 },
+    {   0,   0,   0,   0,   0,   0,   0,  43,  44,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  77,  45,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,  46,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  47,   0,   0,   0,   0,   0,   0,  48,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  49,   0,   0,   0,   0,   0,   0,   0,  50,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  51,  52,  53,   0,   0,   0,   0,  54,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81 },
+    {  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82 },
+    {  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,  55,   0,   0,   0,   0,   0,   0,  56,   0,   0,   0,  57,  58,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85 },
+    {  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86 },
+    {  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87 },
+    {  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88 },
+    {  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  59,   0,   0,   0,   0,  60,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,  61,   0,   0,   0,   0,   0,  62,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  63,   0,   0,   0,   0,  64,   0,   0,   0,   0,   0,   0,   0 },
+    {  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90 },
+    {  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91 },
+    {  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92 },
+    {  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93 },
+    {  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94 },
+    {   0,   0,   0,   0,  65,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  66,   0,   0,   0,   0,   0,  67,   0,   0,   0,   0,   0,   0,   0 },
+    {  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95 },
+    {  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96 },
+    {  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97 },
+    {  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68,  68 },
+    {  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69,  69 },
+    {  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70,  70 },
+    {  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71,  71 },
+    {  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72,  72 },
+    {  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73,  73 },
+    {  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74,  74 },
+    {  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75,  75 },
+    {  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76,  76 },
+    {  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77,  77 },
+    {  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78,  78 },
+    {  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79,  79 },
+    {  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80,  80 },
+    {  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81,  81 },
+    {  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82,  82 },
+    {  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83,  83 },
+    {  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84,  84 },
+    {  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85 },
+    {  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86,  86 },
+    {  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87 },
+    {  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88,  88 },
+    {  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89,  89 },
+    {  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90,  90 },
+    {  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91,  91 },
+    {  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92 },
+    {  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93,  93 },
+    {  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94 },
+    {  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  95 },
+    {  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96,  96 },
+    {  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97 },
+};
+
+const uint8_t at_match_fail[AT_MATCH_STATES] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  77,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,  68,  69,  70,  71,  72,  73,  74,  75,  76,  77,  78,  79,
+     80,  81,  82,  83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,
+     96,  97,
+};
+
+const uint8_t at_match_token[AT_MATCH_STATES] = {
+    AT_TOKEN_NONE,  /* 0 */
+    AT_TOKEN_NONE,  /* 1 */
+    AT_TOKEN_NONE,  /* 2 */
+    AT_TOKEN_LINK_INVALID,  /* 3 */
+    AT_TOKEN_NO_CHANGE,  /* 4 */
+    AT_TOKEN_READY,  /* 5 */
+    AT_TOKEN_NONE,  /* 6 */
+    AT_TOKEN_NONE,  /* 7 */
+    AT_TOKEN_BIN_VERSION,  /* 8 */
+    AT_TOKEN_NONE,  /* 9 */
+    AT_TOKEN_DNS_FAIL,  /* 10 */
+    AT_TOKEN_NONE,  /* 11 */
+    AT_TOKEN_FAIL,  /* 12 */
+    AT_TOKEN_OK,  /* 13 */
+    AT_TOKEN_RECV,  /* 14 */
+    AT_TOKEN_NONE,  /* 15 */
+    AT_TOKEN_NONE,  /* 16 */
+    AT_TOKEN_BUSY,  /* 17 */
+    AT_TOKEN_COMPILE_TIME,  /* 18 */
+    AT_TOKEN_CLOSED | AT_MATCH_LINKED,  /* 19 */
+    AT_TOKEN_CONNECT | AT_MATCH_LINKED,  /* 20 */
+    AT_TOKEN_NONE,  /* 21 */
+    AT_TOKEN_DIST_STA_IP,  /* 22 */
+    AT_TOKEN_IPD,  /* 23 */
+    AT_TOKEN_LINK_CONN,  /* 24 */
+    AT_TOKEN_PING,  /* 25 */
+    AT_TOKEN_NONE,  /* 26 */
+    AT_TOKEN_UART_CUR,  /* 27 */
+    AT_TOKEN_ALREADY_CONNECTED,  /* 28 */
+    AT_TOKEN_ECHO,  /* 29 */
+    AT_TOKEN_CLOSED,  /* 30 */
+    AT_TOKEN_CONNECT,  /* 31 */
+    AT_TOKEN_ERR_CODE,  /* 32 */
+    AT_TOKEN_ERROR,  /* 33 */
+    AT_TOKEN_SDK_VERSION,  /* 34 */
+    AT_TOKEN_NONE,  /* 35 */
+    AT_TOKEN_STATUS,  /* 36 */
+    AT_TOKEN_WIFI_CONNECTED,  /* 37 */
+    AT_TOKEN_WIFI_DISCONNECT,  /* 38 */
+    AT_TOKEN_WIFI_GOT_IP,  /* 39 */
+    AT_TOKEN_CONNECT_FAIL | AT_MATCH_LINKED,  /* 40 */
+    AT_TOKEN_NONE,  /* 41 */
+    AT_TOKEN_NONE,  /* 42 */
+    AT_TOKEN_STA_CONNECTED,  /* 43 */
+    AT_TOKEN_STA_DISCONNECTED,  /* 44 */
+    AT_TOKEN_VERSION,  /* 45 */
+    AT_TOKEN_CONNECT_FAIL,  /* 46 */
+    AT_TOKEN_SEND_FAIL,  /* 47 */
+    AT_TOKEN_SEND_OK,  /* 48 */
+    AT_TOKEN_CIFSR,  /* 49 */
+    AT_TOKEN_NONE,  /* 50 */
+    AT_TOKEN_CWJAP,  /* 51 */
+    AT_TOKEN_CWLAP,  /* 52 */
+    AT_TOKEN_CWMODE,  /* 53 */
+    AT_TOKEN_CWSTATE,  /* 54 */
+    AT_TOKEN_CIPDOMAIN,  /* 55 */
+    AT_TOKEN_NONE,  /* 56 */
+    AT_TOKEN_NONE,  /* 57 */
+    AT_TOKEN_NONE,  /* 58 */
+    AT_TOKEN_CIPMODE,  /* 59 */
+    AT_TOKEN_CIPMUX,  /* 60 */
+    AT_TOKEN_CIPRECVDATA,  /* 61 */
+    AT_TOKEN_CIPRECVLEN,  /* 62 */
+    AT_TOKEN_CIPSNTPTIME,  /* 63 */
+    AT_TOKEN_NONE,  /* 64 */
+    AT_TOKEN_CIPSTA,  /* 65 */
+    AT_TOKEN_CIPSTAMAC,  /* 66 */
+    AT_TOKEN_CIPSTATUS,  /* 67 */
+    AT_TOKEN_BIN_VERSION,  /* 68 */
+    AT_TOKEN_RECV,  /* 69 */
+    AT_TOKEN_BUSY,  /* 70 */
+    AT_TOKEN_COMPILE_TIME,  /* 71 */
+    AT_TOKEN_DIST_STA_IP,  /* 72 */
+    AT_TOKEN_IPD,  /* 73 */
+    AT_TOKEN_LINK_CONN,  /* 74 */
+    AT_TOKEN_PING,  /* 75 */
+    AT_TOKEN_UART_CUR,  /* 76 */
+    AT_TOKEN_ECHO,  /* 77 */
+    AT_TOKEN_ERR_CODE,  /* 78 */
+    AT_TOKEN_SDK_VERSION,  /* 79 */
+    AT_TOKEN_STATUS,  /* 80 */
+    AT_TOKEN_STA_CONNECTED,  /* 81 */
+    AT_TOKEN_STA_DISCONNECTED,  /* 82 */
+    AT_TOKEN_VERSION,  /* 83 */
+    AT_TOKEN_CIFSR,  /* 84 */
+    AT_TOKEN_CWJAP,  /* 85 */
+    AT_TOKEN_CWLAP,  /* 86 */
+    AT_TOKEN_CWMODE,  /* 87 */
+    AT_TOKEN_CWSTATE,  /* 88 */
+    AT_TOKEN_CIPDOMAIN,  /* 89 */
+    AT_TOKEN_CIPMODE,  /* 90 */
+    AT_TOKEN_CIPMUX,  /* 91 */
+    AT_TOKEN_CIPRECVDATA,  /* 92 */
+    AT_TOKEN_CIPRECVLEN,  /* 93 */
+    AT_TOKEN_CIPSNTPTIME,  /* 94 */
+    AT_TOKEN_CIPSTA,  /* 95 */
+    AT_TOKEN_CIPSTAMAC,  /* 96 */
+    AT_TOKEN_CIPSTATUS,  /* 97 */
+};
+
+const uint8_t at_match_depth[AT_MATCH_STATES] = {
+     0,  0,  0, 17,  9,  5,  0,  0, 11,  0,  8,  0,  4,  2,  5,  0,
+     0,  5, 12,  8,  9,  0, 13,  5, 11,  6,  0, 10, 17,  2,  6,  7,
+     9,  5, 12,  0,  7, 14, 15, 11, 14,  0,  0, 15, 18, 11, 12,  9,
+     7,  7,  0,  7,  7,  8,  9, 11,  0,  0,  0,  9,  8, 13, 12, 13,
+     0,  8, 11, 11, 11,  5,  5, 12, 13,  5, 11,  6, 10,  2,  9, 12,
+     7, 15, 18, 11,  7,  7,  7,  8,  9, 11,  9,  8, 13, 12, 13,  8,
+    11, 11,
+};
+
+/* Label of each state: the bytes after the edge into it */
+const uint16_t at_match_label[AT_MATCH_STATES] = {
+      0,   0,   0,   2,  18,  26,  30,  30,  30,  40,  40,  47,  49,  52,  53,  57,
+     57,  61,  65,  76,  80,  85,  85,  96,  99, 108, 112, 115, 123, 138, 138, 142,
+    147, 152, 153, 163, 166, 171, 179, 188, 193, 197, 197, 197, 206, 218, 226, 230,
+    233, 234, 237, 237, 240, 243, 247, 252, 258, 258, 261, 261, 264, 266, 270, 273,
+    280, 281, 281, 284, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287,
+    287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287, 287,
+    287, 287,
+};
+
+const uint8_t at_match_length[AT_MATCH_STATES] = {
+     0,  0,  2, 16,  8,  4,  0,  0, 10,  0,  7,  2,  3,  1,  4,  0,
+     4,  4, 11,  4,  5,  0, 11,  3,  9,  4,  3,  8, 15,  0,  4,  5,
+     5,  1, 10,  3,  5,  8,  9,  5,  4,  0,  0,  9, 12,  8,  4,  3,
+     1,  3,  0,  3,  3,  4,  5,  6,  0,  3,  0,  3,  2,  4,  3,  7,
+     1,  0,  3,  3,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,
+};
+
+const char at_match_chars[] =
+    ",C"                   /* 2 */
+    "ink is not valid"     /* 3 */
+    "o change"             /* 4 */
+    "eady"                 /* 5 */
+    "in version"           /* 8 */
+    "NS Fail"              /* 10 */
+    "RR"                   /* 11 */
+    "AIL"                  /* 12 */
+    "K"                    /* 13 */
+    "ecv "                 /* 14 */
+    "IFI "                 /* 16 */
+    "usy "                 /* 17 */
+    "ompile time"          /* 18 */
+    "OSED"                 /* 19 */
+    "NNECT"                /* 20 */
+    "IST_STA_IP:"          /* 22 */
+    "PD,"                  /* 23 */
+    "INK_CONN:"            /* 24 */
+    "ING:"                 /* 25 */
+    "TA_"                  /* 26 */
+    "ART_CUR:"             /* 27 */
+    "READY CONNECTED"      /* 28 */
+    "OSED"                 /* 30 */
+    "NNECT"                /* 31 */
+    "CODE:"                /* 32 */
+    "R"                    /* 33 */
+    "K version:"           /* 34 */
+    "ND "                  /* 35 */
+    "ATUS:"                /* 36 */
+    "ONNECTED"             /* 37 */
+    "ISCONNECT"            /* 38 */
+    "OT IP"                /* 39 */
+    "FAIL"                 /* 40 */
+    "ONNECTED:"            /* 43 */
+    "ISCONNECTED:"         /* 44 */
+    "version:"             /* 45 */
+    "FAIL"                 /* 46 */
+    "AIL"                  /* 47 */
+    "K"                    /* 48 */
+    "SR:"                  /* 49 */
+    "AP:"                  /* 51 */
+    "AP:"                  /* 52 */
+    "ODE:"                 /* 53 */
+    "TATE:"                /* 54 */
+    "OMAIN:"               /* 55 */
+    "ECV"                  /* 57 */
+    "DE:"                  /* 59 */
+    "X:"                   /* 60 */
+    "ATA:"                 /* 61 */
+    "EN:"                  /* 62 */
+    "TPTIME:"              /* 63 */
+    "A"                    /* 64 */
+    "AC:"                  /* 66 */
+    "US:";                 /* 67 */
+
+const At_MatchPattern at_match_patterns[AT_MATCH_PATTERNS] = {
+    { "OK", AT_TOKEN_OK, 0 },
+    { "SEND OK", AT_TOKEN_SEND_OK, 0 },
+    { "ERROR", AT_TOKEN_ERROR, 0 },
+    { "FAIL", AT_TOKEN_FAIL, 0 },
+    { "SEND FAIL", AT_TOKEN_SEND_FAIL, 0 },
+    { "ready", AT_TOKEN_READY, 0 },
+    { "WIFI CONNECTED", AT_TOKEN_WIFI_CONNECTED, 0 },
+    { "WIFI GOT IP", AT_TOKEN_WIFI_GOT_IP, 0 },
+    { "WIFI DISCONNECT", AT_TOKEN_WIFI_DISCONNECT, 0 },
+    { "CONNECT", AT_TOKEN_CONNECT, 0 },
+    { "CONNECT", AT_TOKEN_CONNECT, AT_MATCH_LINKED },
+    { "CONNECT FAIL", AT_TOKEN_CONNECT_FAIL, 0 },
+    { "CONNECT FAIL", AT_TOKEN_CONNECT_FAIL, AT_MATCH_LINKED },
+    { "CLOSED", AT_TOKEN_CLOSED, 0 },
+    { "CLOSED", AT_TOKEN_CLOSED, AT_MATCH_LINKED },
+    { "ALREADY CONNECTED", AT_TOKEN_ALREADY_CONNECTED, 0 },
+    { "link is not valid", AT_TOKEN_LINK_INVALID, 0 },
+    { "no change", AT_TOKEN_NO_CHANGE, 0 },
+    { "DNS Fail", AT_TOKEN_DNS_FAIL, 0 },
+    { "+STA_DISCONNECTED:", AT_TOKEN_STA_DISCONNECTED, AT_MATCH_PREFIX },
+    { "+STA_CONNECTED:", AT_TOKEN_STA_CONNECTED, AT_MATCH_PREFIX },
+    { "+DIST_STA_IP:", AT_TOKEN_DIST_STA_IP, AT_MATCH_PREFIX },
+    { "+CIPSNTPTIME:", AT_TOKEN_CIPSNTPTIME, AT_MATCH_PREFIX },
+    { "+CIPRECVDATA:", AT_TOKEN_CIPRECVDATA, AT_MATCH_PREFIX },
+    { "+CIPRECVLEN:", AT_TOKEN_CIPRECVLEN, AT_MATCH_PREFIX },
+    { "SDK version:", AT_TOKEN_SDK_VERSION, AT_MATCH_PREFIX },
+    { "compile time", AT_TOKEN_COMPILE_TIME, AT_MATCH_PREFIX },
+    { "+LINK_CONN:", AT_TOKEN_LINK_CONN, AT_MATCH_PREFIX },
+    { "+CIPSTATUS:", AT_TOKEN_CIPSTATUS, AT_MATCH_PREFIX },
+    { "+CIPSTAMAC:", AT_TOKEN_CIPSTAMAC, AT_MATCH_PREFIX },
+    { "+CIPDOMAIN:", AT_TOKEN_CIPDOMAIN, AT_MATCH_PREFIX },
+    { "AT version:", AT_TOKEN_VERSION, AT_MATCH_PREFIX },
+    { "Bin version", AT_TOKEN_BIN_VERSION, AT_MATCH_PREFIX },
+    { "+UART_CUR:", AT_TOKEN_UART_CUR, AT_MATCH_PREFIX },
+    { "ERR CODE:", AT_TOKEN_ERR_CODE, AT_MATCH_PREFIX },
+    { "+CWSTATE:", AT_TOKEN_CWSTATE, AT_MATCH_PREFIX },
+    { "+CIPMODE:", AT_TOKEN_CIPMODE, AT_MATCH_PREFIX },
+    { "+CWMODE:", AT_TOKEN_CWMODE, AT_MATCH_PREFIX },
+    { "+CIPMUX:", AT_TOKEN_CIPMUX, AT_MATCH_PREFIX },
+    { "+CIPSTA:", AT_TOKEN_CIPSTA, AT_MATCH_PREFIX },
+    { "STATUS:", AT_TOKEN_STATUS, AT_MATCH_PREFIX },
+    { "+CIFSR:", AT_TOKEN_CIFSR, AT_MATCH_PREFIX },
+    { "+CWJAP:", AT_TOKEN_CWJAP, AT_MATCH_PREFIX },
+    { "+CWLAP:", AT_TOKEN_CWLAP, AT_MATCH_PREFIX },
+    { "+PING:", AT_TOKEN_PING, AT_MATCH_PREFIX },
+    { "busy ", AT_TOKEN_BUSY, AT_MATCH_PREFIX },
+    { "+IPD,", AT_TOKEN_IPD, AT_MATCH_PREFIX },
+    { "Recv ", AT_TOKEN_RECV, AT_MATCH_PREFIX },
+    { "AT", AT_TOKEN_ECHO, AT_MATCH_PREFIX },
+};
@@ -0,0 +1,163 @@
+/* @binlog.c */
+#include "binlog.h"
+#include "uart.h"
+#include "stm32f4xx.h"
+
+/* Record header layout */
+#define BINLOG_HDR_VALID        0x80000000UL
+#define BINLOG_HDR_NARGS_POS    16
+#define BINLOG_HDR_ID_MSK       0x0000FFFFUL
+
+/* Largest wire frame: varint ID (3) + varint delta (5) + 4 varint args (20),
+ * plus COBS overhead and the two delimiters */
+#define BINLOG_PAYLOAD_MAX      28
+#define BINLOG_FRAME_MAX        (BINLOG_PAYLOAD_MAX + 3)
+
+typedef struct {
+    volatile uint32_t header;   /* Written last, marks the slot as committed */
+    uint32_t timestamp;         /* DWT->CYCCNT at the call */
+    uint32_t args[BINLOG_MAX_ARGS];
+} BinLog_Slot;
+
+volatile uint32_t binlog_dropped = 0;
+
+static BinLog_Slot ring[BINLOG_RING_SLOTS];
+static volatile uint32_t ring_head = 0;    /* Next slot to reserve */
+static volatile uint32_t ring_tail = 0;    /* Next slot to drain */
+static uint32_t last_timestamp = 0;
+static uint32_t reported_dropped = 0;
+
+void BinLog_Init(void) {
+    /* Cycle counter for timestamps */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < BINLOG_RING_SLOTS; i++) {
+        ring[i].header = 0;
+    }
+    ring_head = 0;
+    ring_tail = 0;
+    last_timestamp = 0;
+    binlog_dropped = 0;
+    reported_dropped = 0;
+}
+
+void BinLog_Write(const char* fmt, uint32_t nargs,
+                  uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    uint32_t head;
+
+    /* Reserve a slot. Any exception between LDREX and STREX clears the
+     * monitor, so a preempting writer simply makes us retry. */
+    do {
+        head = __LDREXW(&ring_head);
+        if (head - ring_tail >= BINLOG_RING_SLOTS) {
+            __CLREX();
+            binlog_dropped++;
+            return;
+        }
+    } while (__STREXW(head + 1, &ring_head));
+
+    BinLog_Slot* slot = &ring[head & (BINLOG_RING_SLOTS - 1)];
+    slot->timestamp = DWT->CYCCNT;
+    slot->args[0] = a0;
+    slot->args[1] = a1;
+    slot->args[2] = a2;
+    slot->args[3] = a3;
+
+    /* Publish only after the payload is in memory */
+    __DMB();
+    slot->header = BINLOG_HDR_VALID | (nargs << BINLOG_HDR_NARGS_POS) |
+                   ((uint32_t)fmt & BINLOG_HDR_ID_MSK);
+}
+
+static uint8_t BinLog_PutVarint(uint8_t* out, uint32_t value) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/* COBS-encode payload between two 0x00 delimiters so plain console text
+ * and log frames can share the UART */
+static uint8_t BinLog_Frame(uint8_t* out, const uint8_t* payload, uint8_t len) {
+    uint8_t n = 0;
+    out[n++] = 0x00;
+
+    uint8_t code_pos = n++;
+    uint8_t code = 1;
+    for (uint8_t i = 0; i < len; i++) {
+        if (payload[i] == 0) {
+            out[code_pos] = code;
+            code_pos = n++;
+            code = 1;
+        } else {
+            out[n++] = payload[i];
+            code++;
+        }
+    }
+    out[code_pos] = code;
+
+    out[n++] = 0x00;
+    return n;
+}
+
+static uint8_t BinLog_Encode(uint8_t* frame, uint32_t id, uint32_t timestamp,
+                             const uint32_t* args, uint32_t nargs) {
+    uint8_t payload[BINLOG_PAYLOAD_MAX];
+    uint8_t len = 0;
+
+    len += BinLog_PutVarint(&payload[len], id);
+    len += BinLog_PutVarint(&payload[len], timestamp - last_timestamp);
+    for (uint32_t i = 0; i < nargs; i++) {
+        len += BinLog_PutVarint(&payload[len], args[i]);
+    }
+
+    return BinLog_Frame(frame, payload, len);
+}
+
+uint16_t BinLog_Process(void) {
+    uint8_t frame[BINLOG_FRAME_MAX];
+    uint8_t len;
+    uint16_t sent = 0;
+
+    /* Tell the host how many records it is missing */
+    uint32_t dropped = binlog_dropped;
+    if (dropped != reported_dropped) {
+        uint32_t count = dropped - reported_dropped;
+        len = BinLog_Encode(frame, BINLOG_ID_DROPPED, last_timestamp, &count, 1);
+        if (UART_GetTxFree() < len) {
+            return 0;
+        }
+        UART_WriteAsync(frame, len);
+        reported_dropped = dropped;
+    }
+
+    while (ring_tail != ring_head) {
+        BinLog_Slot* slot = &ring[ring_tail & (BINLOG_RING_SLOTS - 1)];
+        uint32_t header = slot->header;
+
+        /* Reserved but not yet committed by a preempted writer */
+        if (!(header & BINLOG_HDR_VALID)) {
+            break;
+        }
+
+        uint32_t nargs = (header >> BINLOG_HDR_NARGS_POS) & 0x7;
+        len = BinLog_Encode(frame, header & BINLOG_HDR_ID_MSK, slot->timestamp,
+                            slot->args, nargs);
+        if (UART_GetTxFree() < len) {
+            break;
+        }
+        UART_WriteAsync(frame, len);
+
+        last_timestamp = slot->timestamp;
+        slot->header = 0;
+        ring_tail++;
+        sent++;
+    }
+
+    return sent;
+}
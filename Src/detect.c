@@ -0,0 +1,459 @@
+/* @detect.c */
+#include "detect.h"
+#include "adc.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Not loaded and not cleared by the startup code; Detect_Init clears it */
+#define DETECT_CCM              __attribute__((section(".ccm_noinit")))
+
+typedef struct {
+    float mean;
+    float variance;
+    float invSigma;         /* From the variance at the start of the block */
+    float up;               /* CUSUM sums, in sigmas */
+    float down;
+    uint16_t quiet;         /* Scans in a row below zExit while active */
+    uint16_t age;           /* Scans since the event started */
+    bool active;
+} Detect_Channel;
+
+static uint16_t history[DETECT_MAX_CHANNELS][DETECT_HISTORY] DETECT_CCM;
+static Detect_Event events[DETECT_QUEUE] DETECT_CCM;
+
+static Detect_Channel channel_state[DETECT_MAX_CHANNELS];
+static Detect_Config detect_config;
+static Detect_Stats detect_stats;
+static float alpha;
+static float min_variance;
+static uint32_t tokens;
+static uint32_t refill;     /* Scans until the next token */
+
+/* Event slots by sequence: [consumed, completed) are ready, [completed,
+ * reserved) wait for their post-trigger scans. Captures all have the same
+ * length, so they complete in trigger order. */
+static uint32_t reserved;
+static volatile uint32_t completed;
+static volatile uint32_t consumed;
+
+void Detect_DefaultConfig(Detect_Config* config, uint8_t channels) {
+    config->channels = channels;
+    config->baselineShift = 8;
+    config->warmupScans = 512;
+    config->zEnter = 6.0f;
+    config->zExit = 3.0f;
+    config->cusumDrift = 1.0f;
+    config->cusumLimit = 12.0f;
+    config->minSigma = 2.0f;
+    config->holdScans = 32;
+    config->relearnScans = 2000;
+    config->preScans = 64;
+    config->postScans = 128;
+    config->eventBurst = 4;
+    config->scansPerEvent = 10000;
+}
+
+Detect_Error Detect_Init(const Detect_Config* config) {
+    if (config == NULL || config->channels == 0 || config->channels > DETECT_MAX_CHANNELS ||
+        config->baselineShift == 0 || config->baselineShift > 15 ||
+        !(config->zExit > 0.0f && config->zExit < config->zEnter) ||
+        !(config->cusumLimit > 0.0f) || !(config->minSigma > 0.0f) || config->postScans == 0 ||
+        config->preScans + config->postScans > DETECT_MAX_CAPTURE ||
+        config->warmupScans < config->preScans || config->relearnScans <= config->holdScans ||
+        config->eventBurst == 0 ||
+        config->scansPerEvent == 0) {
+        return DETECT_ERROR_PARAM;
+    }
+    detect_config = *config;
+    alpha = 1.0f / (float)(1UL << config->baselineShift);
+    min_variance = config->minSigma * config->minSigma;
+
+    memset(history, 0, sizeof(history));
+    memset(events, 0, sizeof(events));
+    memset(channel_state, 0, sizeof(channel_state));
+    memset(&detect_stats, 0, sizeof(detect_stats));
+    tokens = config->eventBurst;
+    refill = config->scansPerEvent;
+    reserved = 0;
+    completed = 0;
+    consumed = 0;
+    return DETECT_OK;
+}
+
+static void Detect_Trigger(uint8_t c, Detect_Reason reason, float score, uint32_t scan) {
+    Detect_Channel* ch = &channel_state[c];
+
+    ch->active = true;
+    ch->quiet = 0;
+    ch->age = 0;
+    detect_stats.triggers++;
+    detect_stats.active |= 1UL << c;
+
+    if (tokens == 0) {
+        detect_stats.suppressed++;
+        return;
+    }
+    if (reserved - consumed == DETECT_QUEUE) {
+        detect_stats.dropped++;
+        return;
+    }
+    tokens--;
+
+    Detect_Event* e = &events[reserved % DETECT_QUEUE];
+    e->scan = scan;
+    e->channel = c;
+    e->reason = (uint8_t)reason;
+    e->pre = detect_config.preScans;
+    e->count = detect_config.preScans + detect_config.postScans;
+    e->score = score;
+    e->mean = ch->mean;
+    e->sigma = 1.0f / ch->invSigma;
+    reserved++;
+}
+
+static void Detect_End(uint8_t c) {
+    Detect_Channel* ch = &channel_state[c];
+
+    ch->active = false;
+    ch->up = 0.0f;
+    ch->down = 0.0f;
+    detect_stats.active &= ~(1UL << c);
+}
+
+/* One sample: score it, run the event state, and learn from it unless an
+ * event is active. a is the baseline weight. */
+static void Detect_Sample(uint8_t c, float x, float a, uint32_t scan, bool armed) {
+    Detect_Channel* ch = &channel_state[c];
+    float d = x - ch->mean;
+    float u = d * ch->invSigma;
+
+    if (armed) {
+        ch->up = fmaxf(0.0f, ch->up + u - detect_config.cusumDrift);
+        ch->down = fmaxf(0.0f, ch->down - u - detect_config.cusumDrift);
+
+        if (ch->active) {
+            ch->age++;
+            ch->quiet = (fabsf(u) < detect_config.zExit) ? ch->quiet + 1U : 0;
+            if (ch->quiet >= detect_config.holdScans) {
+                Detect_End(c);
+            } else if (ch->age >= detect_config.relearnScans) {
+                /* A new level, not an event: restart the baseline there */
+                ch->mean = x;
+                detect_stats.relearns++;
+                Detect_End(c);
+            }
+            return;
+        }
+
+        if (fabsf(u) >= detect_config.zEnter) {
+            Detect_Trigger(c, DETECT_REASON_Z, u, scan);
+            return;
+        }
+        if (ch->up > detect_config.cusumLimit) {
+            Detect_Trigger(c, DETECT_REASON_CUSUM_UP, ch->up, scan);
+            return;
+        }
+        if (ch->down > detect_config.cusumLimit) {
+            Detect_Trigger(c, DETECT_REASON_CUSUM_DOWN, ch->down, scan);
+            return;
+        }
+    }
+
+    /* EWMA mean and variance */
+    float step = a * d;
+    ch->mean += step;
+    ch->variance = (1.0f - a) * (ch->variance + d * step);
+}
+
+/* Copy out the captures whose last scan has arrived */
+static void Detect_Complete(uint32_t scans) {
+    uint16_t count = detect_config.preScans + detect_config.postScans;
+
+    while (completed != reserved) {
+        Detect_Event* e = &events[completed % DETECT_QUEUE];
+        if (scans - e->scan < detect_config.postScans) {
+            break;
+        }
+        const uint16_t* ring = history[e->channel];
+        uint32_t first = e->scan - detect_config.preScans;
+        for (uint16_t i = 0; i < count; i++) {
+            e->capture[i] = ring[(first + i) % DETECT_HISTORY];
+        }
+        e->sequence = detect_stats.events++;
+        detect_stats.eventBytes += DETECT_EVENT_HEADER + 2U * count;
+
+        /* The event is complete before the index says so */
+        __DMB();
+        completed++;
+    }
+}
+
+static void Detect_Scan(const uint16_t* scan) {
+    uint32_t n = detect_stats.scans;
+    uint32_t slot = n % DETECT_HISTORY;
+    bool armed = n >= detect_config.warmupScans;
+
+    /* A plain running mean until the EWMA weight is the smaller one, so
+     * the baseline settles within the warmup */
+    float a = (n + 1U < (1UL << detect_config.baselineShift)) ? 1.0f / (float)(n + 1U) : alpha;
+
+    for (uint8_t c = 0; c < detect_config.channels; c++) {
+        history[c][slot] = scan[c];
+        Detect_Sample(c, (float)scan[c], a, n, armed);
+    }
+    detect_stats.scans = n + 1U;
+
+    if (--refill == 0) {
+        refill = detect_config.scansPerEvent;
+        if (tokens < detect_config.eventBurst) {
+            tokens++;
+        }
+    }
+    Detect_Complete(n + 1U);
+}
+
+void Detect_Process(const uint16_t* samples, uint16_t count) {
+    uint8_t channels = detect_config.channels;
+
+    if (channels == 0) {
+        return;
+    }
+    /* One square root per channel and block, not per sample */
+    for (uint8_t c = 0; c < channels; c++) {
+        Detect_Channel* ch = &channel_state[c];
+        ch->invSigma = 1.0f / sqrtf(fmaxf(ch->variance, min_variance));
+    }
+    for (uint16_t i = 0; i + channels <= count; i += channels) {
+        Detect_Scan(samples + i);
+    }
+    detect_stats.rawBytes += 2U * count;
+}
+
+void Detect_AdcBlock(uint8_t unit, const uint16_t* samples, uint16_t count) {
+    Detect_Process(samples, count);
+}
+
+bool Detect_Poll(Detect_Event* event) {
+    uint32_t tail = consumed;
+
+    if (tail == completed) {
+        return false;
+    }
+    __DMB();
+    memcpy(event, &events[tail % DETECT_QUEUE], sizeof(*event));
+
+    /* The slot is reused only after the copy */
+    __DMB();
+    consumed = tail + 1U;
+    return true;
+}
+
+void Detect_GetStats(Detect_Stats* stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = detect_stats;
+    __set_PRIMASK(primask);
+}
+
+/* ---- Shell command ---- */
+
+#define DETECT_ADC_SCANS        32
+#define DETECT_ADC_RATE_HZ      1000
+
+#define DETECT_BENCH_CHANNELS   4
+#define DETECT_BENCH_SCANS      60000UL
+#define DETECT_BENCH_BLOCK      32
+#define DETECT_BENCH_STEP       4       /* Blocks per shell call, a few ms at 16 MHz */
+#define DETECT_BENCH_SEED       99UL
+
+/* SRAM: the ADC DMA cannot reach CCM */
+static uint16_t detect_adc_buffer[2 * DETECT_ADC_SCANS * ADC_MAX_CHANNELS];
+static bool detect_adc_running;
+
+static const char* const reason_names[] = { "z", "cusum+", "cusum-" };
+
+static void Detect_EventRange(const Detect_Event* e, uint16_t* min, uint16_t* max) {
+    *min = UINT16_MAX;
+    *max = 0;
+    for (uint16_t i = 0; i < e->count; i++) {
+        *min = (e->capture[i] < *min) ? e->capture[i] : *min;
+        *max = (e->capture[i] > *max) ? e->capture[i] : *max;
+    }
+}
+
+/* Roughly normal noise of about 8 counts: the sum of four LCG bytes */
+static int32_t Detect_BenchNoise(uint32_t* seed) {
+    int32_t sum = 0;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        *seed = *seed * 1664525UL + 1013904223UL;
+        sum += (int32_t)(*seed >> 24);
+    }
+    return (sum - 510) / 18;
+}
+
+/* Four channels at a nominal 1 kHz: a 3-scan spike on channel 0 at 10 s
+ * and a spike every 0.3 s from 45 s on, a 3 sigma step on channel 1 at
+ * 20 s, a 0.5 s vibration burst on channel 2 at 30 s, and a slow drift on
+ * channel 3 that the baseline should follow */
+static uint16_t Detect_BenchSample(uint32_t n, uint8_t c, uint32_t* seed) {
+    int32_t v = 2048 + 200 * c + Detect_BenchNoise(seed);
+
+    switch (c) {
+    case 0:
+        if ((n >= 10000 && n < 10003) || (n >= 45000 && n % 300 < 2)) {
+            v += 200;
+        }
+        break;
+    case 1:
+        v += (n >= 20000) ? 24 : 0;
+        break;
+    case 2:
+        if (n >= 30000 && n < 30500) {
+            int32_t phase = (int32_t)(n % 20);
+            v += ((phase < 10) ? phase : 20 - phase) * 30 - 150;
+        }
+        break;
+    default:
+        v += (int32_t)(n / 100);
+        break;
+    }
+    return (uint16_t)v;
+}
+
+/* One step of "detect bench": a waiting event, or up to
+ * DETECT_BENCH_STEP blocks, or the summary at the end */
+static bool Detect_BenchStep(uint32_t step) {
+    static uint16_t block[DETECT_BENCH_BLOCK * DETECT_BENCH_CHANNELS];
+    static Detect_Event event;
+    static bool held;
+    static uint32_t next;
+    static uint32_t seed;
+    static uint32_t cycles;
+    Detect_Stats stats;
+
+    if (step == 0) {
+        Detect_Config config;
+        Detect_DefaultConfig(&config, DETECT_BENCH_CHANNELS);
+        Detect_Init(&config);
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        held = false;
+        next = 0;
+        seed = DETECT_BENCH_SEED;
+        cycles = 0;
+    }
+
+    if (held || Detect_Poll(&event)) {
+        uint16_t min;
+        uint16_t max;
+        Detect_EventRange(&event, &min, &max);
+        FMT_Print("  #%lu scan %lu ch %u %s %.1f, mean %.1f sigma %.2f, %u samples %u..%u\r\n",
+                  event.sequence, event.scan, event.channel, reason_names[event.reason],
+                  event.score, event.mean, event.sigma, event.count, min, max);
+        held = false;
+        return true;
+    }
+
+    if (next < DETECT_BENCH_SCANS) {
+        /* Stop at the first block with an event, so none waits long enough
+         * to be dropped */
+        for (uint8_t b = 0; b < DETECT_BENCH_STEP && next < DETECT_BENCH_SCANS; b++) {
+            uint16_t* p = block;
+            for (uint32_t s = next; s < next + DETECT_BENCH_BLOCK; s++) {
+                for (uint8_t c = 0; c < DETECT_BENCH_CHANNELS; c++) {
+                    *p++ = Detect_BenchSample(s, c, &seed);
+                }
+            }
+            uint32_t start = DWT->CYCCNT;
+            Detect_Process(block, DETECT_BENCH_BLOCK * DETECT_BENCH_CHANNELS);
+            cycles += DWT->CYCCNT - start;
+            next += DETECT_BENCH_BLOCK;
+
+            if (Detect_Poll(&event)) {
+                held = true;
+                break;
+            }
+        }
+        return true;
+    }
+
+    Detect_GetStats(&stats);
+    uint32_t centi = (uint32_t)((uint64_t)cycles * 100U / stats.scans);
+    FMT_Print("detect: %lu scans x %u channels, %lu.%02lu cycles/scan\r\n", stats.scans,
+              DETECT_BENCH_CHANNELS, centi / 100, centi % 100);
+    FMT_Print("  %lu triggers, %lu events, %lu rate limited, %lu dropped, %lu relearns\r\n",
+              stats.triggers, stats.events, stats.suppressed, stats.dropped, stats.relearns);
+    FMT_Print("  uplink %lu of %lu bytes (1/%lu)\r\n", stats.eventBytes, stats.rawBytes,
+              stats.rawBytes / (stats.eventBytes ? stats.eventBytes : 1U));
+    return false;
+}
+
+static Shell_Status Detect_Cmd(int argc, char* argv[]) {
+    static Detect_Event event;
+
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        Adc_Config adc;
+        Detect_Config config;
+        uint32_t rate = DETECT_ADC_RATE_HZ;
+        if (argc > 3 || (argc == 3 && !Shell_ParseU32(argv[2], &rate))) {
+            return SHELL_ERROR_USAGE;
+        }
+        Adc_DefaultConfig(&adc);
+        adc.rateHz = rate;
+        adc.buffer = detect_adc_buffer;
+        adc.blockSamples = DETECT_ADC_SCANS * adc.channelCount;
+        adc.callback = Detect_AdcBlock;
+        Detect_DefaultConfig(&config, adc.channelCount);
+        if (detect_adc_running || Detect_Init(&config) != DETECT_OK || Adc_Start(&adc) != ADC_OK) {
+            FMT_Print("ADC1 is in use or the rate is out of range\r\n");
+            return SHELL_ERROR_FAILED;
+        }
+        detect_adc_running = true;
+        FMT_Print("detecting on ADC1 temperature and VREFINT at %lu Hz\r\n", rate);
+        return SHELL_OK;
+    }
+    if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+        if (detect_adc_running) {
+            Adc_Stop(1);
+            detect_adc_running = false;
+        }
+        return SHELL_OK;
+    }
+    if (argc == 2 && strcmp(argv[1], "bench") == 0) {
+        if (Shell_GetStep() == 0 && detect_adc_running) {
+            FMT_Print("stop the ADC first\r\n");
+            return SHELL_ERROR_FAILED;
+        }
+        return Detect_BenchStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+    }
+    if (argc != 1) {
+        return SHELL_ERROR_USAGE;
+    }
+
+    /* Counters first, then one waiting event per step */
+    if (Shell_GetStep() == 0) {
+        Detect_Stats stats;
+        Detect_GetStats(&stats);
+        FMT_Print("%lu scans, %lu triggers, %lu events, %lu rate limited, %lu dropped, "
+                  "active %04lx, uplink %lu of %lu bytes\r\n", stats.scans, stats.triggers,
+                  stats.events, stats.suppressed, stats.dropped, stats.active, stats.eventBytes,
+                  stats.rawBytes);
+    }
+    if (!Detect_Poll(&event)) {
+        return SHELL_OK;
+    }
+    uint16_t min;
+    uint16_t max;
+    Detect_EventRange(&event, &min, &max);
+    FMT_Print("#%lu scan %lu ch %u %s %.1f, mean %.1f sigma %.2f, %u samples %u..%u\r\n",
+              event.sequence, event.scan, event.channel, reason_names[event.reason], event.score,
+              event.mean, event.sigma, event.count, min, max);
+    return SHELL_MORE;
+}
+SHELL_COMMAND("detect", "[start [hz] | stop | bench]",
+              "Anomaly events on ADC1, or a run on a synthetic stream", Detect_Cmd);
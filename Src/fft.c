@@ -0,0 +1,455 @@
+/* @fft.c */
+#include "fft.h"
+#include "stm32f4xx.h"
+#include <math.h>
+#include <stddef.h>
+
+/* Q15 complex value as one word: re low, im high */
+#define FFT_WORD(x, i)          (((uint32_t*)(x))[i])
+#define FFT_TWIDDLE_Q15(k)      (((const uint32_t*)fft_twiddle_q15)[k])
+
+/* ---- Q15 ---- */
+
+/* d * conj-rotation by twiddle (cos, sin): (dr c + di s) + j (di c - dr s) */
+static inline uint32_t Fft_MulQ15(uint32_t d, uint32_t w) {
+    int32_t re = (int32_t)__SMUAD(d, w);
+    int32_t im = (int32_t)__SMUSDX(w, d);
+    return __PKHBT(re >> 15, im, 1);
+}
+
+static void Fft_Radix2Q15(int16_t* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t half = length >> 1;
+
+    for (uint16_t j = 0; j < half; j++) {
+        uint32_t w = FFT_TWIDDLE_Q15(j * stride);
+        for (uint16_t g = j; g < size; g += length) {
+            uint32_t a = FFT_WORD(x, g);
+            uint32_t b = FFT_WORD(x, g + half);
+            uint32_t d = __SHSUB16(a, b);
+            FFT_WORD(x, g) = __SHADD16(a, b);
+            FFT_WORD(x, g + half) = (j == 0) ? d : Fft_MulQ15(d, w);
+        }
+    }
+}
+
+static void Fft_Radix4Q15(int16_t* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t quarter = length >> 2;
+
+    for (uint16_t j = 0; j < quarter; j++) {
+        uint32_t w1 = FFT_TWIDDLE_Q15(j * stride);
+        uint32_t w2 = FFT_TWIDDLE_Q15(2U * j * stride);
+        uint32_t w3 = FFT_TWIDDLE_Q15(3U * j * stride);
+        for (uint16_t g = j; g < size; g += length) {
+            uint32_t a = FFT_WORD(x, g);
+            uint32_t b = FFT_WORD(x, g + quarter);
+            uint32_t c = FFT_WORD(x, g + 2U * quarter);
+            uint32_t d = FFT_WORD(x, g + 3U * quarter);
+            uint32_t t0 = __SHADD16(a, c);
+            uint32_t t1 = __SHSUB16(a, c);
+            uint32_t t2 = __SHADD16(b, d);
+            uint32_t t3 = __SHSUB16(b, d);
+            uint32_t y1 = __SHSAX(t1, t3);     /* t1 - j t3 */
+            uint32_t y2 = __SHSUB16(t0, t2);
+            uint32_t y3 = __SHASX(t1, t3);     /* t1 + j t3 */
+
+            /* Middle outputs swapped: bit-reversed rather than digit-reversed order */
+            FFT_WORD(x, g) = __SHADD16(t0, t2);
+            if (j == 0) {
+                FFT_WORD(x, g + quarter) = y2;
+                FFT_WORD(x, g + 2U * quarter) = y1;
+                FFT_WORD(x, g + 3U * quarter) = y3;
+            } else {
+                FFT_WORD(x, g + quarter) = Fft_MulQ15(y2, w2);
+                FFT_WORD(x, g + 2U * quarter) = Fft_MulQ15(y1, w1);
+                FFT_WORD(x, g + 3U * quarter) = Fft_MulQ15(y3, w3);
+            }
+        }
+    }
+}
+
+/* ---- Q31 ---- */
+
+static inline int32_t Fft_Half(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a + b) >> 1);
+}
+
+static inline int32_t Fft_HalfDiff(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a - b) >> 1);
+}
+
+/* Rotates x[i] by twiddle k */
+static inline void Fft_MulQ31(int32_t* x, uint32_t i, uint32_t k) {
+    int32_t dr = x[2 * i];
+    int32_t di = x[2 * i + 1];
+    int32_t c = fft_twiddle_q31[2 * k];
+    int32_t s = fft_twiddle_q31[2 * k + 1];
+    x[2 * i] = (int32_t)(((int64_t)dr * c + (int64_t)di * s) >> 31);
+    x[2 * i + 1] = (int32_t)(((int64_t)di * c - (int64_t)dr * s) >> 31);
+}
+
+static void Fft_Radix2Q31(int32_t* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t half = length >> 1;
+
+    for (uint16_t j = 0; j < half; j++) {
+        for (uint16_t g = j; g < size; g += length) {
+            int32_t* a = &x[2U * g];
+            int32_t* b = &x[2U * (g + half)];
+            int32_t ar = a[0], ai = a[1], br = b[0], bi = b[1];
+            a[0] = Fft_Half(ar, br);
+            a[1] = Fft_Half(ai, bi);
+            b[0] = Fft_HalfDiff(ar, br);
+            b[1] = Fft_HalfDiff(ai, bi);
+            if (j != 0) {
+                Fft_MulQ31(x, g + half, (uint32_t)j * stride);
+            }
+        }
+    }
+}
+
+static void Fft_Radix4Q31(int32_t* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t quarter = length >> 2;
+
+    for (uint16_t j = 0; j < quarter; j++) {
+        for (uint16_t g = j; g < size; g += length) {
+            int32_t* a = &x[2U * g];
+            int32_t* b = &x[2U * (g + quarter)];
+            int32_t* c = &x[2U * (g + 2U * quarter)];
+            int32_t* d = &x[2U * (g + 3U * quarter)];
+            int32_t t0r = Fft_Half(a[0], c[0]), t0i = Fft_Half(a[1], c[1]);
+            int32_t t1r = Fft_HalfDiff(a[0], c[0]), t1i = Fft_HalfDiff(a[1], c[1]);
+            int32_t t2r = Fft_Half(b[0], d[0]), t2i = Fft_Half(b[1], d[1]);
+            int32_t t3r = Fft_HalfDiff(b[0], d[0]), t3i = Fft_HalfDiff(b[1], d[1]);
+
+            a[0] = Fft_Half(t0r, t2r);
+            a[1] = Fft_Half(t0i, t2i);
+            b[0] = Fft_HalfDiff(t0r, t2r);
+            b[1] = Fft_HalfDiff(t0i, t2i);
+            c[0] = Fft_Half(t1r, t3i);
+            c[1] = Fft_HalfDiff(t1i, t3r);
+            d[0] = Fft_HalfDiff(t1r, t3i);
+            d[1] = Fft_Half(t1i, t3r);
+            if (j != 0) {
+                Fft_MulQ31(x, g + quarter, 2U * j * stride);
+                Fft_MulQ31(x, g + 2U * quarter, (uint32_t)j * stride);
+                Fft_MulQ31(x, g + 3U * quarter, 3U * j * stride);
+            }
+        }
+    }
+}
+
+/* ---- Float ---- */
+
+static inline void Fft_MulF32(float* x, uint32_t i, uint32_t k) {
+    float dr = x[2 * i];
+    float di = x[2 * i + 1];
+    float c = fft_twiddle_f32[2 * k];
+    float s = fft_twiddle_f32[2 * k + 1];
+    x[2 * i] = dr * c + di * s;
+    x[2 * i + 1] = di * c - dr * s;
+}
+
+static void Fft_Radix2F32(float* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t half = length >> 1;
+
+    for (uint16_t j = 0; j < half; j++) {
+        for (uint16_t g = j; g < size; g += length) {
+            float* a = &x[2U * g];
+            float* b = &x[2U * (g + half)];
+            float ar = a[0], ai = a[1], br = b[0], bi = b[1];
+            a[0] = ar + br;
+            a[1] = ai + bi;
+            b[0] = ar - br;
+            b[1] = ai - bi;
+            if (j != 0) {
+                Fft_MulF32(x, g + half, (uint32_t)j * stride);
+            }
+        }
+    }
+}
+
+static void Fft_Radix4F32(float* x, uint16_t size, uint16_t length, uint16_t stride) {
+    uint16_t quarter = length >> 2;
+
+    for (uint16_t j = 0; j < quarter; j++) {
+        for (uint16_t g = j; g < size; g += length) {
+            float* a = &x[2U * g];
+            float* b = &x[2U * (g + quarter)];
+            float* c = &x[2U * (g + 2U * quarter)];
+            float* d = &x[2U * (g + 3U * quarter)];
+            float t0r = a[0] + c[0], t0i = a[1] + c[1];
+            float t1r = a[0] - c[0], t1i = a[1] - c[1];
+            float t2r = b[0] + d[0], t2i = b[1] + d[1];
+            float t3r = b[0] - d[0], t3i = b[1] - d[1];
+
+            a[0] = t0r + t2r;
+            a[1] = t0i + t2i;
+            b[0] = t0r - t2r;
+            b[1] = t0i - t2i;
+            c[0] = t1r + t3i;
+            c[1] = t1i - t3r;
+            d[0] = t1r - t3i;
+            d[1] = t1i + t3r;
+            if (j != 0) {
+                Fft_MulF32(x, g + quarter, 2U * j * stride);
+                Fft_MulF32(x, g + 2U * quarter, (uint32_t)j * stride);
+                Fft_MulF32(x, g + 3U * quarter, 3U * j * stride);
+            }
+        }
+    }
+}
+
+/* ---- Common ---- */
+
+/* Swaps element i with its bit reverse; elements are `words` words wide */
+static void Fft_BitReverse(const Fft_Plan* plan, uint32_t* x, uint8_t words) {
+    uint8_t shift = (uint8_t)(__builtin_ctz(FFT_MAX_SIZE) - plan->log2Size);
+
+    for (uint16_t i = 1; i < plan->size - 1U; i++) {
+        uint16_t r = fft_bit_reverse[i] >> shift;
+        if (i < r) {
+            for (uint8_t w = 0; w < words; w++) {
+                uint32_t t = x[i * words + w];
+                x[i * words + w] = x[r * words + w];
+                x[r * words + w] = t;
+            }
+        }
+    }
+}
+
+/* Q15 window value for sample i: cos(2 pi i / size) from the twiddles,
+ * folded into the table's first half */
+static int32_t Fft_WindowQ15(const Fft_Plan* plan, uint16_t i) {
+    uint16_t k = (i <= plan->size / 2U) ? i : (uint16_t)(plan->size - i);
+    int32_t c = fft_twiddle_q15[2U * k * plan->stride];
+    int32_t w;
+
+    switch (plan->window) {
+        case FFT_WINDOW_HANN:
+            w = (32768 - c) >> 1;
+            break;
+        case FFT_WINDOW_HAMMING:
+            w = 17695 - ((15073 * c) >> 15);
+            break;
+        default:
+            return 32768;
+    }
+    return (w > 32767) ? 32767 : w;
+}
+
+Fft_Error Fft_Init(Fft_Plan* plan, uint16_t size, Fft_Radix radix, Fft_Window window) {
+    if (plan == NULL || size < FFT_MIN_SIZE || size > FFT_MAX_SIZE || (size & (size - 1U)) != 0 ||
+        (radix != FFT_RADIX_2 && radix != FFT_RADIX_4) || window > FFT_WINDOW_HAMMING) {
+        return FFT_ERROR_PARAM;
+    }
+    plan->size = size;
+    plan->log2Size = (uint8_t)__builtin_ctz(size);
+    plan->radix = (uint8_t)radix;
+    plan->stride = (uint16_t)(FFT_MAX_SIZE / size);
+    plan->window = window;
+
+    uint64_t sum = 0;
+    uint64_t squares = 0;
+    for (uint16_t i = 0; i < size; i++) {
+        uint32_t w = (uint32_t)Fft_WindowQ15(plan, i);
+        sum += w;
+        squares += (uint64_t)w * w;
+    }
+    plan->coherentGain = (float)sum / (32768.0f * size);
+    plan->powerGain = (float)squares / (32768.0f * 32768.0f * size);
+    return FFT_OK;
+}
+
+void Fft_LoadQ15(const Fft_Plan* plan, const int16_t* samples, int16_t* x) {
+    int32_t sum = 0;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        sum += samples[i];
+    }
+    int32_t mean = (sum + (int32_t)(plan->size / 2U)) >> plan->log2Size;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        int32_t v = (int32_t)__SSAT(samples[i] - mean, 16);
+        x[2U * i] = (int16_t)((v * Fft_WindowQ15(plan, i)) >> 15);
+        x[2U * i + 1U] = 0;
+    }
+}
+
+void Fft_LoadQ31(const Fft_Plan* plan, const int32_t* samples, int32_t* x) {
+    int64_t sum = 0;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        sum += samples[i];
+    }
+    int64_t mean = (sum + plan->size / 2U) >> plan->log2Size;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        int64_t v = samples[i] - mean;
+        v = (v > INT32_MAX) ? INT32_MAX : (v < INT32_MIN) ? INT32_MIN : v;
+        x[2U * i] = (int32_t)((v * Fft_WindowQ15(plan, i)) >> 15);
+        x[2U * i + 1U] = 0;
+    }
+}
+
+void Fft_LoadF32(const Fft_Plan* plan, const float* samples, float* x) {
+    float sum = 0.0f;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        sum += samples[i];
+    }
+    float mean = sum / plan->size;
+
+    for (uint16_t i = 0; i < plan->size; i++) {
+        x[2U * i] = (samples[i] - mean) * ((float)Fft_WindowQ15(plan, i) / 32768.0f);
+        x[2U * i + 1U] = 0.0f;
+    }
+}
+
+/* An odd number of radix-2 steps leaves one radix-2 stage in front of the
+ * radix-4 ones; its halves come out in bit-reversed order all the same */
+void Fft_Q15(const Fft_Plan* plan, int16_t* x) {
+    uint16_t length = plan->size;
+    uint16_t stride = plan->stride;
+
+    if (plan->radix == FFT_RADIX_2 || (plan->log2Size & 1U) != 0) {
+        Fft_Radix2Q15(x, plan->size, length, stride);
+        length >>= 1;
+        stride <<= 1;
+    }
+    if (plan->radix == FFT_RADIX_2) {
+        for (; length >= 2U; length >>= 1, stride <<= 1) {
+            Fft_Radix2Q15(x, plan->size, length, stride);
+        }
+    } else {
+        for (; length >= 4U; length >>= 2, stride <<= 2) {
+            Fft_Radix4Q15(x, plan->size, length, stride);
+        }
+    }
+    Fft_BitReverse(plan, (uint32_t*)x, 1);
+}
+
+void Fft_Q31(const Fft_Plan* plan, int32_t* x) {
+    uint16_t length = plan->size;
+    uint16_t stride = plan->stride;
+
+    if (plan->radix == FFT_RADIX_2 || (plan->log2Size & 1U) != 0) {
+        Fft_Radix2Q31(x, plan->size, length, stride);
+        length >>= 1;
+        stride <<= 1;
+    }
+    if (plan->radix == FFT_RADIX_2) {
+        for (; length >= 2U; length >>= 1, stride <<= 1) {
+            Fft_Radix2Q31(x, plan->size, length, stride);
+        }
+    } else {
+        for (; length >= 4U; length >>= 2, stride <<= 2) {
+            Fft_Radix4Q31(x, plan->size, length, stride);
+        }
+    }
+    Fft_BitReverse(plan, (uint32_t*)x, 2);
+}
+
+void Fft_F32(const Fft_Plan* plan, float* x) {
+    uint16_t length = plan->size;
+    uint16_t stride = plan->stride;
+
+    if (plan->radix == FFT_RADIX_2 || (plan->log2Size & 1U) != 0) {
+        Fft_Radix2F32(x, plan->size, length, stride);
+        length >>= 1;
+        stride <<= 1;
+    }
+    if (plan->radix == FFT_RADIX_2) {
+        for (; length >= 2U; length >>= 1, stride <<= 1) {
+            Fft_Radix2F32(x, plan->size, length, stride);
+        }
+    } else {
+        for (; length >= 4U; length >>= 2, stride <<= 2) {
+            Fft_Radix4F32(x, plan->size, length, stride);
+        }
+    }
+    Fft_BitReverse(plan, (uint32_t*)x, 2);
+}
+
+/* Bins are read before the same or a lower index of power is written, so
+ * power may overlay x */
+void Fft_PowerQ15(const Fft_Plan* plan, const int16_t* x, float* power) {
+    uint16_t last = plan->size / 2U;
+
+    for (uint16_t k = 0; k <= last; k++) {
+        int32_t re = x[2U * k];
+        int32_t im = x[2U * k + 1U];
+        float p = (float)((uint32_t)(re * re) + (uint32_t)(im * im)) * (1.0f / 1073741824.0f);
+        power[k] = (k == 0 || k == last) ? p : 2.0f * p;
+    }
+}
+
+void Fft_PowerQ31(const Fft_Plan* plan, const int32_t* x, float* power) {
+    uint16_t last = plan->size / 2U;
+
+    for (uint16_t k = 0; k <= last; k++) {
+        float re = (float)x[2U * k] * (1.0f / 2147483648.0f);
+        float im = (float)x[2U * k + 1U] * (1.0f / 2147483648.0f);
+        float p = re * re + im * im;
+        power[k] = (k == 0 || k == last) ? p : 2.0f * p;
+    }
+}
+
+void Fft_PowerF32(const Fft_Plan* plan, const float* x, float* power) {
+    uint16_t last = plan->size / 2U;
+    float scale = 1.0f / ((float)plan->size * plan->size);
+
+    for (uint16_t k = 0; k <= last; k++) {
+        float re = x[2U * k];
+        float im = x[2U * k + 1U];
+        float p = (re * re + im * im) * scale;
+        power[k] = (k == 0 || k == last) ? p : 2.0f * p;
+    }
+}
+
+Fft_Error Fft_GetFeatures(const Fft_Plan* plan, const float* power, float sampleRateHz,
+                          const float* edgesHz, uint8_t bandCount, Fft_Features* features) {
+    if (plan == NULL || power == NULL || features == NULL || bandCount > FFT_MAX_BANDS ||
+        (bandCount != 0 && edgesHz == NULL) || sampleRateHz <= 0.0f) {
+        return FFT_ERROR_PARAM;
+    }
+
+    uint16_t last = plan->size / 2U;
+    float binHz = sampleRateHz / plan->size;
+    float total = 0.0f;
+    uint16_t peak = 1;
+
+    for (uint16_t k = 1; k <= last; k++) {
+        total += power[k];
+        if (power[k] > power[peak]) {
+            peak = k;
+        }
+    }
+    features->rms = sqrtf(total / plan->powerGain);
+
+    /* Vertex of the parabola through the magnitudes around the peak */
+    float offset = 0.0f;
+    if (peak > 1 && peak < last) {
+        float a = sqrtf(power[peak - 1U]);
+        float b = sqrtf(power[peak]);
+        float c = sqrtf(power[peak + 1U]);
+        float denominator = a - 2.0f * b + c;
+        if (denominator < 0.0f) {
+            offset = 0.5f * (a - c) / denominator;
+        }
+    }
+    features->peakBin = peak;
+    features->peakHz = ((float)peak + offset) * binHz;
+    features->peakAmplitude = sqrtf(2.0f * power[peak]) / plan->coherentGain;
+
+    features->bandCount = bandCount;
+    for (uint8_t b = 0; b < bandCount; b++) {
+        float sum = 0.0f;
+        for (uint16_t k = 0; k <= last; k++) {
+            float hz = k * binHz;
+            if (hz >= edgesHz[b] && hz < edgesHz[b + 1U]) {
+                sum += power[k];
+            }
+        }
+        features->band[b] = sum / plan->powerGain;
+    }
+    return FFT_OK;
+}
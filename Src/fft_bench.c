@@ -0,0 +1,189 @@
+/* @fft_bench.c - Cycles and reference records for fft.c */
+#include "fft.h"
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+
+/* The signal: two tones from integer oscillators, a DC offset and LCG
+ * noise, in Q15. Tools/fft_ref.py rebuilds it from "@fft-signal". */
+#define FFTB_SEED               2024UL
+#define FFTB_RATE_HZ            3200
+#define FFTB_DC                 3277        /* 0.1 */
+#define FFTB_NOISE_SHIFT        22          /* About +-0.016 */
+#define FFTB_TONES              2
+#define FFTB_BANDS              5
+
+/* Oscillator y[n] = c y[n-1] - y[n-2] in Q30, c = 2 cos(w), y[1] = A sin(w):
+ * bin 50.3 of 1024 at 0.5 and bin 120 at 0.125 */
+static const int32_t tones[FFTB_TONES][2] = {
+    { 2046011824, 163080048 },
+    { 1591180426, 90135117 },
+};
+
+static const float edges_hz[FFTB_BANDS + 1] = { 0.0f, 100.0f, 200.0f, 400.0f, 800.0f, 1600.0f };
+static const uint16_t sizes[] = { 256, 512, 1024 };
+
+/* Size x format x radix */
+#define FFTB_PLANS              (sizeof(sizes) / sizeof(sizes[0]) * 3 * 2)
+
+static int16_t in_q15[FFT_MAX_SIZE];
+static int32_t in_q31[FFT_MAX_SIZE];
+static float in_f32[FFT_MAX_SIZE];
+
+static union {
+    int16_t q15[2 * FFT_MAX_SIZE];
+    int32_t q31[2 * FFT_MAX_SIZE];
+    float f32[2 * FFT_MAX_SIZE];
+} work;
+
+static void Fftb_MakeSignal(void) {
+    int64_t y1[FFTB_TONES];
+    int64_t y2[FFTB_TONES] = { 0 };
+    uint32_t seed = FFTB_SEED;
+
+    for (uint8_t t = 0; t < FFTB_TONES; t++) {
+        y1[t] = tones[t][1];
+    }
+    for (uint16_t i = 0; i < FFT_MAX_SIZE; i++) {
+        int32_t v = FFTB_DC;
+        for (uint8_t t = 0; t < FFTB_TONES; t++) {
+            v += (int32_t)(y2[t] >> 15);
+            int64_t next = ((tones[t][0] * y1[t]) >> 30) - y2[t];
+            y2[t] = y1[t];
+            y1[t] = next;
+        }
+        seed = seed * 1664525UL + 1013904223UL;
+        v += (int32_t)seed >> FFTB_NOISE_SHIFT;
+
+        in_q15[i] = (int16_t)__SSAT(v, 16);
+        in_q31[i] = (int32_t)in_q15[i] * 65536;
+        in_f32[i] = (float)in_q15[i] / 32768.0f;
+    }
+}
+
+/* FNV-1a over the output bytes, little endian */
+static uint32_t Fftb_Checksum(const void* data, uint32_t bytes) {
+    const uint8_t* p = data;
+    uint32_t hash = 0x811C9DC5UL;
+
+    while (bytes--) {
+        hash = (hash ^ *p++) * 0x01000193UL;
+    }
+    return hash;
+}
+
+static void Fftb_Run(uint8_t format, const Fft_Plan* plan) {
+    static const char* const names[] = { "q15", "q31", "f32" };
+    uint32_t cycles[4];
+    uint32_t checksum = 0;
+    float* power = work.f32;
+    Fft_Features features;
+    char line[192];
+    uint32_t t = DWT->CYCCNT;
+
+    /* Load, transform, power and features, each timed on its own */
+    if (format == 0) {
+        Fft_LoadQ15(plan, in_q15, work.q15);
+        cycles[0] = DWT->CYCCNT - t;
+        t = DWT->CYCCNT;
+        Fft_Q15(plan, work.q15);
+        cycles[1] = DWT->CYCCNT - t;
+        checksum = Fftb_Checksum(work.q15, 4U * plan->size);
+        t = DWT->CYCCNT;
+        Fft_PowerQ15(plan, work.q15, power);
+    } else if (format == 1) {
+        Fft_LoadQ31(plan, in_q31, work.q31);
+        cycles[0] = DWT->CYCCNT - t;
+        t = DWT->CYCCNT;
+        Fft_Q31(plan, work.q31);
+        cycles[1] = DWT->CYCCNT - t;
+        checksum = Fftb_Checksum(work.q31, 8U * plan->size);
+        t = DWT->CYCCNT;
+        Fft_PowerQ31(plan, work.q31, power);
+    } else {
+        Fft_LoadF32(plan, in_f32, work.f32);
+        cycles[0] = DWT->CYCCNT - t;
+        t = DWT->CYCCNT;
+        Fft_F32(plan, work.f32);
+        cycles[1] = DWT->CYCCNT - t;
+        t = DWT->CYCCNT;
+        Fft_PowerF32(plan, work.f32, power);
+    }
+    cycles[2] = DWT->CYCCNT - t;
+    t = DWT->CYCCNT;
+    Fft_GetFeatures(plan, power, (float)FFTB_RATE_HZ, edges_hz, FFTB_BANDS, &features);
+    cycles[3] = DWT->CYCCNT - t;
+
+    int len = FMT_Format(line, sizeof(line), "@fft %s,%u,%u,%lu,%lu,%lu,%lu,", names[format],
+                         plan->radix, plan->size, cycles[0], cycles[1], cycles[2], cycles[3]);
+    if (format != 2) {
+        len += FMT_Format(line + len, sizeof(line) - len, "%08lx,", checksum);
+    } else {
+        len += FMT_Format(line + len, sizeof(line) - len, "-,");
+    }
+    len += FMT_Format(line + len, sizeof(line) - len, "%.6f,%.3f,%.6f,", features.rms,
+                      features.peakHz, features.peakAmplitude);
+    for (uint8_t b = 0; b < features.bandCount; b++) {
+        len += FMT_Format(line + len, sizeof(line) - len, (b == 0) ? "%.9f" : ";%.9f",
+                          features.band[b]);
+    }
+    FMT_Print("%s\r\n", line);
+}
+
+bool Fft_BenchmarkStep(uint32_t step) {
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        Fftb_MakeSignal();
+
+        FMT_Print("@fft-begin %u %u %u\r\n", FFT_MAX_SIZE, FFTB_RATE_HZ, FFT_WINDOW_HANN);
+        FMT_Print("@fft-signal %lu %d %u", FFTB_SEED, FFTB_DC, FFTB_NOISE_SHIFT);
+        for (uint8_t t = 0; t < FFTB_TONES; t++) {
+            FMT_Print(" %ld %ld", tones[t][0], tones[t][1]);
+        }
+        FMT_Print("\r\n@fft-bands");
+        for (uint8_t b = 0; b <= FFTB_BANDS; b++) {
+            FMT_Print(" %u", (unsigned)edges_hz[b]);
+        }
+        FMT_Print("\r\n@fft-header format,radix,size,load,fft,power,features,checksum,"
+                  "rms,peak_hz,peak_amplitude,bands\r\n");
+        return true;
+    }
+
+    /* Sizes, then formats, then radix 2 and 4 */
+    uint32_t plan_index = step - 1;
+    uint8_t s = (uint8_t)(plan_index / (3 * 2));
+    if (s >= sizeof(sizes) / sizeof(sizes[0])) {
+        return false;
+    }
+    uint8_t format = (uint8_t)(plan_index / 2 % 3);
+    Fft_Radix radix = (plan_index % 2 == 0) ? FFT_RADIX_2 : FFT_RADIX_4;
+
+    Fft_Plan plan;
+    Fft_Init(&plan, sizes[s], radix, FFT_WINDOW_HANN);
+    Fftb_Run(format, &plan);
+
+    if (plan_index + 1 < FFTB_PLANS) {
+        return true;
+    }
+    FMT_Print("@fft-end\r\n");
+    return false;
+}
+
+void Fft_RunBenchmark(void) {
+    uint32_t step = 0;
+    bool more;
+
+    do {
+        more = Fft_BenchmarkStep(step++);
+        while (!UART_IsTxIdle() || !(USART3->SR & USART_SR_TC));
+    } while (more);
+}
+
+/* One plan per call */
+static Shell_Status Fftb_Cmd(int argc, char* argv[]) {
+    return Fft_BenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("fftbench", "", "FFT cycles per stage and spectral features, for fft_ref.py", Fftb_Cmd);
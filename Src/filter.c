@@ -0,0 +1,330 @@
+/* @filter.c */
+#include "filter.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Two Q15 samples as one word for the dual MAC; FIR windows start at any
+ * sample, and the M4 allows unaligned LDR */
+#define FILTER_PAIR(p)          __UNALIGNED_UINT32_READ(p)
+
+static inline int16_t Filter_Sat16(int64_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+static inline int32_t Filter_Sat32(int64_t value) {
+    if (value > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)value;
+}
+
+/* Window and coefficients, oldest first */
+static int16_t Filter_DotQ15(const int16_t* x, const int16_t* c, uint16_t taps) {
+    uint64_t acc = 0;
+
+    for (uint16_t n = taps >> 2; n != 0; n--) {
+        acc = __SMLALD(FILTER_PAIR(c), FILTER_PAIR(x), acc);
+        acc = __SMLALD(FILTER_PAIR(c + 2), FILTER_PAIR(x + 2), acc);
+        c += 4;
+        x += 4;
+    }
+    for (uint16_t n = taps & 3U; n != 0; n--) {
+        acc += (uint64_t)(int64_t)((int32_t)*c++ * *x++);
+    }
+    return Filter_Sat16((int64_t)acc >> 15);
+}
+
+static int32_t Filter_DotQ31(const int32_t* x, const int32_t* c, uint16_t taps) {
+    int64_t acc = 0;
+
+    for (uint16_t n = taps >> 2; n != 0; n--) {
+        acc += (int64_t)c[0] * x[0];
+        acc += (int64_t)c[1] * x[1];
+        acc += (int64_t)c[2] * x[2];
+        acc += (int64_t)c[3] * x[3];
+        c += 4;
+        x += 4;
+    }
+    for (uint16_t n = taps & 3U; n != 0; n--) {
+        acc += (int64_t)*c++ * *x++;
+    }
+    return Filter_Sat32(acc >> 31);
+}
+
+/* Four partial sums hide the FPU multiply-add latency */
+static float Filter_DotF32(const float* x, const float* c, uint16_t taps) {
+    float acc0 = 0.0f;
+    float acc1 = 0.0f;
+    float acc2 = 0.0f;
+    float acc3 = 0.0f;
+
+    for (uint16_t n = taps >> 2; n != 0; n--) {
+        acc0 += c[0] * x[0];
+        acc1 += c[1] * x[1];
+        acc2 += c[2] * x[2];
+        acc3 += c[3] * x[3];
+        c += 4;
+        x += 4;
+    }
+    for (uint16_t n = taps & 3U; n != 0; n--) {
+        acc0 += *c++ * *x++;
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+Filter_Error Filter_FirQ15Init(Filter_FirQ15* f, const int16_t* coeffs, uint16_t numTaps,
+                               int16_t* state, uint8_t decimation) {
+    if (f == NULL || coeffs == NULL || state == NULL || numTaps == 0 || decimation == 0) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->numTaps = numTaps;
+    f->pos = 0;
+    f->decimation = decimation;
+    f->phase = 0;
+    memset(state, 0, 2U * numTaps * sizeof(*state));
+    return FILTER_OK;
+}
+
+Filter_Error Filter_FirQ31Init(Filter_FirQ31* f, const int32_t* coeffs, uint16_t numTaps,
+                               int32_t* state, uint8_t decimation) {
+    if (f == NULL || coeffs == NULL || state == NULL || numTaps == 0 || decimation == 0) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->numTaps = numTaps;
+    f->pos = 0;
+    f->decimation = decimation;
+    f->phase = 0;
+    memset(state, 0, 2U * numTaps * sizeof(*state));
+    return FILTER_OK;
+}
+
+Filter_Error Filter_FirF32Init(Filter_FirF32* f, const float* coeffs, uint16_t numTaps,
+                               float* state, uint8_t decimation) {
+    if (f == NULL || coeffs == NULL || state == NULL || numTaps == 0 || decimation == 0) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->numTaps = numTaps;
+    f->pos = 0;
+    f->decimation = decimation;
+    f->phase = 0;
+    memset(state, 0, 2U * numTaps * sizeof(*state));
+    return FILTER_OK;
+}
+
+/* The three FIR loops differ only in the sample type and the dot product */
+uint16_t Filter_FirQ15Process(Filter_FirQ15* f, const int16_t* in, int16_t* out, uint16_t count) {
+    int16_t* state = f->state;
+    uint16_t taps = f->numTaps;
+    uint16_t pos = f->pos;
+    uint8_t phase = f->phase;
+    uint16_t produced = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        int16_t x = in[i];
+        state[pos] = x;
+        state[pos + taps] = x;
+        pos = (pos + 1U == taps) ? 0 : (uint16_t)(pos + 1U);
+        if (++phase == f->decimation) {
+            phase = 0;
+            out[produced++] = Filter_DotQ15(state + pos, f->coeffs, taps);
+        }
+    }
+    f->pos = pos;
+    f->phase = phase;
+    return produced;
+}
+
+uint16_t Filter_FirQ31Process(Filter_FirQ31* f, const int32_t* in, int32_t* out, uint16_t count) {
+    int32_t* state = f->state;
+    uint16_t taps = f->numTaps;
+    uint16_t pos = f->pos;
+    uint8_t phase = f->phase;
+    uint16_t produced = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t x = in[i];
+        state[pos] = x;
+        state[pos + taps] = x;
+        pos = (pos + 1U == taps) ? 0 : (uint16_t)(pos + 1U);
+        if (++phase == f->decimation) {
+            phase = 0;
+            out[produced++] = Filter_DotQ31(state + pos, f->coeffs, taps);
+        }
+    }
+    f->pos = pos;
+    f->phase = phase;
+    return produced;
+}
+
+uint16_t Filter_FirF32Process(Filter_FirF32* f, const float* in, float* out, uint16_t count) {
+    float* state = f->state;
+    uint16_t taps = f->numTaps;
+    uint16_t pos = f->pos;
+    uint8_t phase = f->phase;
+    uint16_t produced = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        float x = in[i];
+        state[pos] = x;
+        state[pos + taps] = x;
+        pos = (pos + 1U == taps) ? 0 : (uint16_t)(pos + 1U);
+        if (++phase == f->decimation) {
+            phase = 0;
+            out[produced++] = Filter_DotF32(state + pos, f->coeffs, taps);
+        }
+    }
+    f->pos = pos;
+    f->phase = phase;
+    return produced;
+}
+
+Filter_Error Filter_BiquadQ15Init(Filter_BiquadQ15* f, const int16_t* coeffs, uint8_t stages,
+                                  int16_t* state, uint8_t postShift) {
+    if (f == NULL || coeffs == NULL || state == NULL || stages == 0 || postShift >= 15) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->stages = stages;
+    f->postShift = postShift;
+    memset(state, 0, 4U * stages * sizeof(*state));
+    return FILTER_OK;
+}
+
+Filter_Error Filter_BiquadQ31Init(Filter_BiquadQ31* f, const int32_t* coeffs, uint8_t stages,
+                                  int32_t* state, uint8_t postShift) {
+    if (f == NULL || coeffs == NULL || state == NULL || stages == 0 || postShift >= 31) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->stages = stages;
+    f->postShift = postShift;
+    memset(state, 0, 4U * stages * sizeof(*state));
+    return FILTER_OK;
+}
+
+Filter_Error Filter_BiquadF32Init(Filter_BiquadF32* f, const float* coeffs, uint8_t stages,
+                                  float* state) {
+    if (f == NULL || coeffs == NULL || state == NULL || stages == 0) {
+        return FILTER_ERROR_PARAM;
+    }
+    f->coeffs = coeffs;
+    f->state = state;
+    f->stages = stages;
+    memset(state, 0, 2U * stages * sizeof(*state));
+    return FILTER_OK;
+}
+
+void Filter_BiquadQ15Process(Filter_BiquadQ15* f, const int16_t* in, int16_t* out, uint16_t count) {
+    const int16_t* c = f->coeffs;
+    int16_t* s = f->state;
+    uint8_t shift = (uint8_t)(15U - f->postShift);
+    const int16_t* src = in;
+
+    for (uint8_t stage = 0; stage < f->stages; stage++) {
+        int32_t b0 = c[0];
+        uint32_t b12 = FILTER_PAIR(c + 1);
+        uint32_t a12 = FILTER_PAIR(c + 3);
+        uint32_t xs = __PKHBT(s[0], s[1], 16);     /* x1 low, x2 high */
+        uint32_t ys = __PKHBT(s[2], s[3], 16);
+
+        for (uint16_t i = 0; i < count; i++) {
+            int16_t x0 = src[i];
+            uint64_t acc = (uint64_t)(int64_t)(b0 * x0);
+            acc = __SMLALD(b12, xs, acc);
+            acc = __SMLALD(a12, ys, acc);
+            int16_t y0 = Filter_Sat16((int64_t)acc >> shift);
+
+            /* The new sample goes low, the old x1 becomes x2 */
+            xs = __PKHBT(x0, xs, 16);
+            ys = __PKHBT(y0, ys, 16);
+            out[i] = y0;
+        }
+
+        s[0] = (int16_t)xs;
+        s[1] = (int16_t)(xs >> 16);
+        s[2] = (int16_t)ys;
+        s[3] = (int16_t)(ys >> 16);
+        src = out;
+        c += 5;
+        s += 4;
+    }
+}
+
+void Filter_BiquadQ31Process(Filter_BiquadQ31* f, const int32_t* in, int32_t* out, uint16_t count) {
+    const int32_t* c = f->coeffs;
+    int32_t* s = f->state;
+    uint8_t shift = (uint8_t)(31U - f->postShift);
+    const int32_t* src = in;
+
+    for (uint8_t stage = 0; stage < f->stages; stage++) {
+        int32_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        int32_t x1 = s[0], x2 = s[1], y1 = s[2], y2 = s[3];
+
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t x0 = src[i];
+            int64_t acc = (int64_t)b0 * x0;
+            acc += (int64_t)b1 * x1;
+            acc += (int64_t)b2 * x2;
+            acc += (int64_t)a1 * y1;
+            acc += (int64_t)a2 * y2;
+            int32_t y0 = Filter_Sat32(acc >> shift);
+
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            out[i] = y0;
+        }
+
+        s[0] = x1;
+        s[1] = x2;
+        s[2] = y1;
+        s[3] = y2;
+        src = out;
+        c += 5;
+        s += 4;
+    }
+}
+
+void Filter_BiquadF32Process(Filter_BiquadF32* f, const float* in, float* out, uint16_t count) {
+    const float* c = f->coeffs;
+    float* s = f->state;
+    const float* src = in;
+
+    for (uint8_t stage = 0; stage < f->stages; stage++) {
+        float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float d1 = s[0], d2 = s[1];
+
+        for (uint16_t i = 0; i < count; i++) {
+            float x = src[i];
+            float y = b0 * x + d1;
+            d1 = b1 * x + a1 * y + d2;
+            d2 = b2 * x + a2 * y;
+            out[i] = y;
+        }
+
+        s[0] = d1;
+        s[1] = d2;
+        src = out;
+        c += 5;
+        s += 2;
+    }
+}
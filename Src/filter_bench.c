@@ -0,0 +1,212 @@
+/* @filter_bench.c - Cycles per sample and reference records for filter.c */
+#include "filter.h"
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+
+/* The test signal and filters; Tools/filter_ref.py rebuilds them from the
+ * "@filt-begin" and "@filt-biquad" lines */
+#define FILT_BLOCK              256
+#define FILT_SEED               12345UL
+#define FILT_TAPS               32
+#define FILT_DECIMATION         4
+#define FILT_STAGES             2
+#define FILT_POST_SHIFT         1
+
+/* FIR, decimating FIR and biquad, each in three formats */
+#define FILT_KERNELS            9
+
+/* 4th-order Butterworth lowpass at fs/10 as two sections, Q14 */
+static const int16_t biquad_q14[FILT_STAGES * 5] = {
+    1277, 2554, 1277, 21642, -10367,
+    1014, 2028, 1014, 17180, -4852,
+};
+
+static int16_t in_q15[FILT_BLOCK];
+static int16_t out_q15[FILT_BLOCK];
+static int32_t in_q31[FILT_BLOCK];
+static int32_t out_q31[FILT_BLOCK];
+static float in_f32[FILT_BLOCK];
+static float out_f32[FILT_BLOCK];
+
+static int16_t fir_q15[FILT_TAPS];
+static int32_t fir_q31[FILT_TAPS];
+static float fir_f32[FILT_TAPS];
+static int32_t biquad_q31[FILT_STAGES * 5];
+static float biquad_f32[FILT_STAGES * 5];
+
+static union {
+    int16_t q15[2 * FILT_TAPS];
+    int32_t q31[2 * FILT_TAPS];
+    float f32[2 * FILT_TAPS];
+} state;
+
+/* Pseudo-random input at half scale, the same sequence in all formats */
+static void Filt_MakeInput(void) {
+    uint32_t seed = FILT_SEED;
+
+    for (uint16_t i = 0; i < FILT_BLOCK; i++) {
+        seed = seed * 1664525UL + 1013904223UL;
+        in_q31[i] = (int32_t)seed >> 1;
+        in_q15[i] = (int16_t)(in_q31[i] >> 16);
+        in_f32[i] = (float)in_q15[i] / 32768.0f;
+    }
+}
+
+/* Parabolic-window lowpass with unity DC gain (just below, in Q15/Q31) */
+static void Filt_MakeCoefficients(void) {
+    uint32_t total = 0;
+
+    for (uint32_t k = 0; k < FILT_TAPS; k++) {
+        total += (k + 1) * (FILT_TAPS - k);
+    }
+    for (uint32_t k = 0; k < FILT_TAPS; k++) {
+        uint32_t weight = (k + 1) * (FILT_TAPS - k);
+        fir_q15[k] = (int16_t)(weight * 32767UL / total);
+        fir_q31[k] = (int32_t)((uint64_t)weight * 0x7FFFFFFFUL / total);
+        fir_f32[k] = (float)weight / (float)total;
+    }
+    for (uint32_t i = 0; i < FILT_STAGES * 5; i++) {
+        biquad_q31[i] = (int32_t)biquad_q14[i] * 65536;
+        biquad_f32[i] = (float)biquad_q14[i] / 16384.0f;
+    }
+}
+
+/* FNV-1a over the output bytes, little endian */
+static uint32_t Filt_Checksum(const void* data, uint32_t bytes) {
+    const uint8_t* p = data;
+    uint32_t hash = 0x811C9DC5UL;
+
+    while (bytes--) {
+        hash = (hash ^ *p++) * 0x01000193UL;
+    }
+    return hash;
+}
+
+static void Filt_Report(const char* kernel, const char* format, uint16_t outputs, uint32_t cycles,
+                        const void* fixed, uint8_t sampleSize) {
+    char line[128];
+    uint32_t centi = (uint32_t)((uint64_t)cycles * 100U / FILT_BLOCK);
+    int len = FMT_Format(line, sizeof(line), "@filt %s,%s,%u,%lu.%02lu,", kernel, format, outputs,
+                         centi / 100, centi % 100);
+
+    if (fixed != NULL) {
+        FMT_Format(line + len, sizeof(line) - len, "%08lx,-,-",
+                   Filt_Checksum(fixed, (uint32_t)outputs * sampleSize));
+    } else {
+        float sum = 0.0f;
+        float power = 0.0f;
+        for (uint16_t i = 0; i < outputs; i++) {
+            sum += out_f32[i];
+            power += out_f32[i] * out_f32[i];
+        }
+        FMT_Format(line + len, sizeof(line) - len, "-,%.7f,%.7f",
+                   sum / outputs, power / outputs);
+    }
+    FMT_Print("%s\r\n", line);
+}
+
+/* Kernels 0-2 FIR, 3-5 decimating FIR, 6-8 biquad; q15, q31, f32 in each */
+static void Filt_RunKernel(uint8_t kernel) {
+    uint8_t format = kernel % 3;
+    uint32_t start;
+    uint32_t cycles;
+    uint16_t outputs;
+
+    if (kernel < 6) {
+        /* FIR and decimating FIR: the same taps, M = 1 and FILT_DECIMATION */
+        uint8_t decimation = (kernel < 3) ? 1 : FILT_DECIMATION;
+        const char* name = (decimation == 1) ? "fir" : "decim";
+
+        if (format == 0) {
+            Filter_FirQ15 q15;
+            Filter_FirQ15Init(&q15, fir_q15, FILT_TAPS, state.q15, decimation);
+            start = DWT->CYCCNT;
+            outputs = Filter_FirQ15Process(&q15, in_q15, out_q15, FILT_BLOCK);
+            cycles = DWT->CYCCNT - start;
+            Filt_Report(name, "q15", outputs, cycles, out_q15, sizeof(out_q15[0]));
+        } else if (format == 1) {
+            Filter_FirQ31 q31;
+            Filter_FirQ31Init(&q31, fir_q31, FILT_TAPS, state.q31, decimation);
+            start = DWT->CYCCNT;
+            outputs = Filter_FirQ31Process(&q31, in_q31, out_q31, FILT_BLOCK);
+            cycles = DWT->CYCCNT - start;
+            Filt_Report(name, "q31", outputs, cycles, out_q31, sizeof(out_q31[0]));
+        } else {
+            Filter_FirF32 f32;
+            Filter_FirF32Init(&f32, fir_f32, FILT_TAPS, state.f32, decimation);
+            start = DWT->CYCCNT;
+            outputs = Filter_FirF32Process(&f32, in_f32, out_f32, FILT_BLOCK);
+            cycles = DWT->CYCCNT - start;
+            Filt_Report(name, "f32", outputs, cycles, NULL, 0);
+        }
+    } else if (format == 0) {
+        Filter_BiquadQ15 bq15;
+        Filter_BiquadQ15Init(&bq15, biquad_q14, FILT_STAGES, state.q15, FILT_POST_SHIFT);
+        start = DWT->CYCCNT;
+        Filter_BiquadQ15Process(&bq15, in_q15, out_q15, FILT_BLOCK);
+        cycles = DWT->CYCCNT - start;
+        Filt_Report("biquad", "q15", FILT_BLOCK, cycles, out_q15, sizeof(out_q15[0]));
+    } else if (format == 1) {
+        Filter_BiquadQ31 bq31;
+        Filter_BiquadQ31Init(&bq31, biquad_q31, FILT_STAGES, state.q31, FILT_POST_SHIFT);
+        start = DWT->CYCCNT;
+        Filter_BiquadQ31Process(&bq31, in_q31, out_q31, FILT_BLOCK);
+        cycles = DWT->CYCCNT - start;
+        Filt_Report("biquad", "q31", FILT_BLOCK, cycles, out_q31, sizeof(out_q31[0]));
+    } else {
+        Filter_BiquadF32 bf32;
+        Filter_BiquadF32Init(&bf32, biquad_f32, FILT_STAGES, state.f32);
+        start = DWT->CYCCNT;
+        Filter_BiquadF32Process(&bf32, in_f32, out_f32, FILT_BLOCK);
+        cycles = DWT->CYCCNT - start;
+        Filt_Report("biquad", "f32", FILT_BLOCK, cycles, NULL, 0);
+    }
+}
+
+bool Filter_BenchmarkStep(uint32_t step) {
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        Filt_MakeInput();
+        Filt_MakeCoefficients();
+
+        FMT_Print("@filt-begin %u %lu %u %u %u %u\r\n", FILT_BLOCK, FILT_SEED, FILT_TAPS,
+                  FILT_DECIMATION, FILT_STAGES, FILT_POST_SHIFT);
+        FMT_Print("@filt-biquad");
+        for (uint8_t i = 0; i < FILT_STAGES * 5; i++) {
+            FMT_Print(" %d", biquad_q14[i]);
+        }
+        FMT_Print("\r\n@filt-header kernel,format,outputs,cycles,checksum,mean,power\r\n");
+        return true;
+    }
+
+    if (step > FILT_KERNELS) {
+        return false;
+    }
+    Filt_RunKernel((uint8_t)(step - 1));
+
+    if (step < FILT_KERNELS) {
+        return true;
+    }
+    FMT_Print("@filt-end\r\n");
+    return false;
+}
+
+void Filter_RunBenchmark(void) {
+    uint32_t step = 0;
+    bool more;
+
+    do {
+        more = Filter_BenchmarkStep(step++);
+        while (!UART_IsTxIdle() || !(USART3->SR & USART_SR_TC));
+    } while (more);
+}
+
+/* One kernel per call */
+static Shell_Status Filt_Cmd(int argc, char* argv[]) {
+    return Filter_BenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("filtbench", "", "FIR/biquad cycles per sample, records for filter_ref.py", Filt_Cmd);
@@ -0,0 +1,431 @@
+/* @fmt.c */
+#include "fmt.h"
+#include "uart.h"
+
+/* Staging buffer FMT_Print keeps on the caller's stack */
+#define FMT_PRINT_SCRATCH   32
+
+/* Format flags */
+#define FMT_FLAG_LEFT       0x01
+#define FMT_FLAG_ZERO       0x02
+
+typedef struct {
+    char* buf;
+    uint16_t cap;           /* Characters buf can hold */
+    uint16_t len;           /* Characters currently in buf */
+    FMT_Sink sink;          /* NULL when writing into a caller buffer */
+    void* context;
+    int total;              /* Characters produced, including truncated ones */
+} FMT_Out;
+
+/* Two digits per division halves the work of the decimal conversion */
+static const char digit_pairs[201] =
+    "00010203040506070809" "10111213141516171819"
+    "20212223242526272829" "30313233343536373839"
+    "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879"
+    "80818283848586878889" "90919293949596979899";
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+static const uint32_t pow10[FMT_MAX_DECIMALS + 1] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+static void FMT_Put(FMT_Out* out, const char* s, uint32_t n) {
+    out->total += n;
+    while (n != 0) {
+        if (out->len == out->cap) {
+            if (out->sink == NULL) {
+                return;     /* Truncated, total keeps counting */
+            }
+            out->sink(out->context, out->buf, out->len);
+            out->len = 0;
+        }
+        out->buf[out->len++] = *s++;
+        n--;
+    }
+}
+
+static void FMT_Pad(FMT_Out* out, char c, int32_t n) {
+    while (n-- > 0) {
+        FMT_Put(out, &c, 1);
+    }
+}
+
+uint8_t FMT_U32Dec(char* out, uint32_t value) {
+    char tmp[10];
+    uint8_t pos = sizeof(tmp);
+
+    while (value >= 100) {
+        uint32_t q = value / 100;
+        uint32_t r = (value - q * 100) * 2;
+        value = q;
+        tmp[--pos] = digit_pairs[r + 1];
+        tmp[--pos] = digit_pairs[r];
+    }
+    if (value >= 10) {
+        tmp[--pos] = digit_pairs[value * 2 + 1];
+        tmp[--pos] = digit_pairs[value * 2];
+    } else {
+        tmp[--pos] = (char)('0' + value);
+    }
+
+    uint8_t len = sizeof(tmp) - pos;
+    for (uint8_t i = 0; i < len; i++) {
+        out[i] = tmp[pos + i];
+    }
+    out[len] = '\0';
+    return len;
+}
+
+uint8_t FMT_I32Dec(char* out, int32_t value) {
+    if (value < 0) {
+        out[0] = '-';
+        /* Negate in unsigned arithmetic so INT32_MIN works */
+        return 1 + FMT_U32Dec(out + 1, 0U - (uint32_t)value);
+    }
+    return FMT_U32Dec(out, (uint32_t)value);
+}
+
+uint8_t FMT_U32Hex(char* out, uint32_t value, uint8_t minDigits, bool upper) {
+    const char* set = upper ? hex_upper : hex_lower;
+    uint8_t len = 1;
+
+    while (len < 8 && (value >> (4 * len)) != 0) {
+        len++;
+    }
+    if (minDigits > 8) {
+        minDigits = 8;
+    }
+    if (len < minDigits) {
+        len = minDigits;
+    }
+
+    for (uint8_t i = len; i != 0; i--) {
+        out[i - 1] = set[value & 0xF];
+        value >>= 4;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+/* Integer part, '.', then the zero-padded fraction */
+static uint8_t FMT_JoinFraction(char* out, uint32_t ipart, uint32_t fpart, uint8_t decimals) {
+    uint8_t len = FMT_U32Dec(out, ipart);
+
+    if (decimals != 0) {
+        out[len++] = '.';
+        for (uint8_t i = decimals; i != 0; i--) {
+            out[len + i - 1] = (char)('0' + fpart % 10);
+            fpart /= 10;
+        }
+        len += decimals;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+uint8_t FMT_Fixed(char* out, int32_t value, uint8_t fracBits, uint8_t decimals) {
+    uint8_t len = 0;
+    uint32_t mag = (uint32_t)value;
+
+    if (decimals > FMT_MAX_DECIMALS) {
+        decimals = FMT_MAX_DECIMALS;
+    }
+    if (fracBits > 31) {
+        fracBits = 31;
+    }
+
+    if (value < 0) {
+        out[len++] = '-';
+        mag = 0U - mag;
+    }
+
+    uint32_t ipart = mag >> fracBits;
+    uint32_t mask = (fracBits == 0) ? 0 : (0xFFFFFFFFUL >> (32 - fracBits));
+    uint64_t scaled = (uint64_t)(mag & mask) * pow10[decimals];
+    uint32_t fpart = (uint32_t)((scaled + ((1ULL << fracBits) >> 1)) >> fracBits);
+
+    /* Rounding may carry into the integer part */
+    if (fpart >= pow10[decimals]) {
+        fpart -= pow10[decimals];
+        ipart++;
+    }
+
+    return len + FMT_JoinFraction(out + len, ipart, fpart, decimals);
+}
+
+/* Integer part beyond 32 bits: split into 9-digit groups */
+static uint8_t FMT_U64Dec(char* out, uint64_t value) {
+    if (value <= 0xFFFFFFFFULL) {
+        return FMT_U32Dec(out, (uint32_t)value);
+    }
+
+    uint32_t low = (uint32_t)(value % 1000000000ULL);
+    uint8_t len = FMT_U64Dec(out, value / 1000000000ULL);
+    for (uint8_t i = 9; i != 0; i--) {
+        out[len + i - 1] = (char)('0' + low % 10);
+        low /= 10;
+    }
+    len += 9;
+    out[len] = '\0';
+    return len;
+}
+
+uint8_t FMT_Float(char* out, float value, uint8_t decimals) {
+    uint8_t len = 0;
+
+    if (decimals > FMT_MAX_DECIMALS) {
+        decimals = FMT_MAX_DECIMALS;
+    }
+
+    if (value != value) {
+        out[0] = 'n'; out[1] = 'a'; out[2] = 'n'; out[3] = '\0';
+        return 3;
+    }
+
+    if (value < 0.0f) {
+        out[len++] = '-';
+        value = -value;
+    }
+
+    if (value >= 1e19f) {
+        const char* text = (value > 3.4028235e38f) ? "inf" : "ovf";
+        for (uint8_t i = 0; i < 3; i++) {
+            out[len++] = text[i];
+        }
+        out[len] = '\0';
+        return len;
+    }
+
+    /* Round once on the whole value so 0.9999 -> "1.00" carries correctly */
+    value += 0.5f / (float)pow10[decimals];
+
+    if (value < 4294967296.0f) {
+        uint32_t ipart = (uint32_t)value;
+        uint32_t fpart = (uint32_t)((value - (float)ipart) * (float)pow10[decimals]);
+        if (fpart >= pow10[decimals]) {
+            fpart = pow10[decimals] - 1;
+        }
+        return len + FMT_JoinFraction(out + len, ipart, fpart, decimals);
+    }
+
+    /* Above 2^32 a float has no fractional bits left */
+    len += FMT_U64Dec(out + len, (uint64_t)value);
+    if (decimals != 0) {
+        out[len++] = '.';
+        for (uint8_t i = 0; i < decimals; i++) {
+            out[len++] = '0';
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+/* Emit a converted field with sign, width and flags applied */
+static void FMT_Field(FMT_Out* out, const char* sign, const char* body, uint8_t len,
+                      uint8_t flags, int32_t width) {
+    uint8_t signLen = (sign != NULL) ? 1 : 0;
+    int32_t pad = width - len - signLen;
+
+    if (!(flags & FMT_FLAG_LEFT) && !(flags & FMT_FLAG_ZERO)) {
+        FMT_Pad(out, ' ', pad);
+    }
+    if (sign != NULL) {
+        FMT_Put(out, sign, 1);
+    }
+    if (!(flags & FMT_FLAG_LEFT) && (flags & FMT_FLAG_ZERO)) {
+        FMT_Pad(out, '0', pad);
+    }
+    FMT_Put(out, body, len);
+    if (flags & FMT_FLAG_LEFT) {
+        FMT_Pad(out, ' ', pad);
+    }
+}
+
+static void FMT_Run(FMT_Out* out, const char* fmt, va_list args) {
+    char tmp[FMT_FLOAT_SIZE];
+
+    while (*fmt != '\0') {
+        /* Copy literal runs in one go */
+        const char* start = fmt;
+        while (*fmt != '\0' && *fmt != '%') {
+            fmt++;
+        }
+        if (fmt != start) {
+            FMT_Put(out, start, (uint32_t)(fmt - start));
+        }
+        if (*fmt == '\0') {
+            break;
+        }
+        fmt++;
+
+        uint8_t flags = 0;
+        int32_t width = 0;
+        int32_t precision = -1;
+
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                flags |= FMT_FLAG_LEFT;
+            } else if (*fmt == '0') {
+                flags |= FMT_FLAG_ZERO;
+            } else {
+                break;
+            }
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            width = width * 10 + (*fmt++ - '0');
+        }
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            while (*fmt >= '0' && *fmt <= '9') {
+                precision = precision * 10 + (*fmt++ - '0');
+            }
+        }
+        while (*fmt == 'l' || *fmt == 'h') {
+            fmt++;
+        }
+
+        const char* sign = NULL;
+        uint8_t len;
+
+        switch (*fmt) {
+            case 'd':
+            case 'i': {
+                int32_t value = va_arg(args, int32_t);
+                if (value < 0) {
+                    sign = "-";
+                    len = FMT_U32Dec(tmp, 0U - (uint32_t)value);
+                } else {
+                    len = FMT_U32Dec(tmp, (uint32_t)value);
+                }
+                FMT_Field(out, sign, tmp, len, flags, width);
+                break;
+            }
+
+            case 'u':
+                len = FMT_U32Dec(tmp, va_arg(args, uint32_t));
+                FMT_Field(out, NULL, tmp, len, flags, width);
+                break;
+
+            case 'x':
+            case 'X':
+                len = FMT_U32Hex(tmp, va_arg(args, uint32_t), 0, *fmt == 'X');
+                FMT_Field(out, NULL, tmp, len, flags, width);
+                break;
+
+            case 'p':
+                tmp[0] = '0';
+                tmp[1] = 'x';
+                len = 2 + FMT_U32Hex(tmp + 2, (uint32_t)(uintptr_t)va_arg(args, void*), 8, false);
+                FMT_Field(out, NULL, tmp, len, flags, width);
+                break;
+
+            case 'c':
+                tmp[0] = (char)va_arg(args, int);
+                FMT_Field(out, NULL, tmp, 1, flags & FMT_FLAG_LEFT, width);
+                break;
+
+            case 's': {
+                const char* str = va_arg(args, const char*);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                uint32_t n = 0;
+                while (str[n] != '\0' && (precision < 0 || n < (uint32_t)precision)) {
+                    n++;
+                }
+                int32_t pad = width - (int32_t)n;
+                if (!(flags & FMT_FLAG_LEFT)) {
+                    FMT_Pad(out, ' ', pad);
+                }
+                FMT_Put(out, str, n);
+                if (flags & FMT_FLAG_LEFT) {
+                    FMT_Pad(out, ' ', pad);
+                }
+                break;
+            }
+
+            case 'f': {
+                /* Varargs promote to double; narrow once and stay on the FPU */
+                float value = (float)va_arg(args, double);
+                if (value < 0.0f) {
+                    sign = "-";
+                    value = -value;
+                }
+                len = FMT_Float(tmp, value, (precision < 0) ? 6 : (uint8_t)precision);
+                FMT_Field(out, sign, tmp, len, flags, width);
+                break;
+            }
+
+            case '%':
+                FMT_Put(out, "%", 1);
+                break;
+
+            case '\0':
+                return;
+
+            default:
+                /* Unknown conversion, show it verbatim */
+                FMT_Put(out, fmt - 1, 2);
+                break;
+        }
+        fmt++;
+    }
+}
+
+int FMT_VFormat(char* buf, size_t size, const char* fmt, va_list args) {
+    FMT_Out out = { buf, 0, 0, NULL, NULL, 0 };
+
+    if (buf == NULL || size == 0) {
+        out.buf = NULL;
+    } else {
+        out.cap = (size > 0xFFFF) ? 0xFFFE : (uint16_t)(size - 1);
+    }
+
+    FMT_Run(&out, fmt, args);
+
+    if (out.buf != NULL) {
+        out.buf[out.len] = '\0';
+    }
+    return out.total;
+}
+
+int FMT_Format(char* buf, size_t size, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = FMT_VFormat(buf, size, fmt, args);
+    va_end(args);
+    return len;
+}
+
+int FMT_VFormatTo(FMT_Sink sink, void* context, char* scratch, uint16_t size,
+                  const char* fmt, va_list args) {
+    FMT_Out out = { scratch, size, 0, sink, context, 0 };
+
+    FMT_Run(&out, fmt, args);
+
+    if (out.len != 0) {
+        sink(context, out.buf, out.len);
+    }
+    return out.total;
+}
+
+static void FMT_UartSink(void* context, const char* data, uint16_t length) {
+    (void)context;
+    UART_WriteAsync((const uint8_t*)data, length);
+}
+
+int FMT_Print(const char* fmt, ...) {
+    char scratch[FMT_PRINT_SCRATCH];
+    va_list args;
+
+    va_start(args, fmt);
+    int len = FMT_VFormatTo(FMT_UartSink, NULL, scratch, sizeof(scratch), fmt, args);
+    va_end(args);
+    return len;
+}
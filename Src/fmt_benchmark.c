@@ -0,0 +1,102 @@
+/* @fmt_benchmark.c - FMT_Format vs newlib sprintf */
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_ITERATIONS    100
+
+typedef enum {
+    BENCH_ARG_U32,
+    BENCH_ARG_4INT,
+    BENCH_ARG_CHAR,
+    BENCH_ARG_FLOAT
+} Bench_ArgKind;
+
+typedef struct {
+    const char* fmt;
+    Bench_ArgKind kind;
+} Bench_Case;
+
+/* The format strings the diagnostics and test suite actually use */
+static const Bench_Case cases[] = {
+    { "USART3->CR1: 0x%04X\r\n",                        BENCH_ARG_U32 },
+    { "AHB1ENR: 0x%08X\r\n",                            BENCH_ARG_U32 },
+    { "Counter: %lu\r\n",                               BENCH_ARG_U32 },
+    { "Transmitted 1000 bytes in %lu ms\r\n",           BENCH_ARG_U32 },
+    { "  Baud: %lu, Word: %d, Stop: %d, Parity: %d\r\n", BENCH_ARG_4INT },
+    { "Received '%c' (ASCII: %d)\r\n",                  BENCH_ARG_CHAR },
+    { "Temperature: %.2f C\r\n",                        BENCH_ARG_FLOAT }
+};
+
+/* Keeps the compiler from dropping the calls under test */
+static volatile int sink_len;
+
+static uint32_t Bench_Run(const Bench_Case* c, uint8_t useFmt, char* buf, size_t size) {
+    uint32_t value = USART3->CR1 | 0x12345;
+    uint32_t start = DWT->CYCCNT;
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        switch (c->kind) {
+            case BENCH_ARG_U32:
+                sink_len = useFmt ? FMT_Format(buf, size, c->fmt, value)
+                                  : sprintf(buf, c->fmt, value);
+                break;
+            case BENCH_ARG_4INT:
+                sink_len = useFmt ? FMT_Format(buf, size, c->fmt, value, 8, 1, 0)
+                                  : sprintf(buf, c->fmt, value, 8, 1, 0);
+                break;
+            case BENCH_ARG_CHAR:
+                sink_len = useFmt ? FMT_Format(buf, size, c->fmt, 'A', 'A')
+                                  : sprintf(buf, c->fmt, 'A', 'A');
+                break;
+            case BENCH_ARG_FLOAT:
+                /* nano.specs needs -u _printf_float for newlib to print this */
+                sink_len = useFmt ? FMT_Format(buf, size, c->fmt, 23.75f)
+                                  : sprintf(buf, c->fmt, 23.75f);
+                break;
+        }
+    }
+
+    return (DWT->CYCCNT - start) / BENCH_ITERATIONS;
+}
+
+bool FMT_RunBenchmark(uint32_t step) {
+    char out[64];
+
+    if (step >= sizeof(cases) / sizeof(cases[0])) {
+        return false;
+    }
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        FMT_Print("\r\n=== FORMATTER BENCHMARK (cycles per call) ===\r\n");
+        FMT_Print("  newlib     fmt  speedup  format\r\n");
+    }
+
+    const Bench_Case* c = &cases[step];
+    uint32_t newlib = Bench_Run(c, 0, out, sizeof(out));
+    uint32_t fast = Bench_Run(c, 1, out, sizeof(out));
+    uint32_t speedup = (fast != 0) ? (newlib * 10 / fast) : 0;
+
+    FMT_Print("%8lu %7lu %5lu.%lux  ", newlib, fast, speedup / 10, speedup % 10);
+
+    /* Show the format with its line ending stripped */
+    UART_WriteAsync((const uint8_t*)c->fmt, (uint16_t)strcspn(c->fmt, "\r"));
+    FMT_Print("\r\n");
+
+    if (step + 1 < sizeof(cases) / sizeof(cases[0])) {
+        return true;
+    }
+    FMT_Print("Code size: run Tools/size_report.py on the ELF\r\n");
+    return false;
+}
+
+/* One format string per call */
+static Shell_Status Bench_Cmd(int argc, char* argv[]) {
+    return FMT_RunBenchmark(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("fmtbench", "", "Formatter against newlib snprintf, in cycles", Bench_Cmd);
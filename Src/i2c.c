@@ -0,0 +1,735 @@
+/* @i2c.c */
+#include "i2c.h"
+#include "fmt.h"
+#include "shell.h"
+#include "systick.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* I2C1-3 run from APB1, which is HCLK at the reset clock setup */
+#define I2C_PCLK_HZ             16000000UL
+#define I2C_PCLK_MHZ            (I2C_PCLK_HZ / 1000000UL)
+
+/* Slowest bus clock I2C_Init accepts */
+#define I2C_SPEED_MIN           10000UL
+
+/* Rise time limits (I2C spec): 1000 ns standard, 300 ns fast mode */
+#define I2C_TRISE_FAST_NS       300UL
+
+/* Bus clearing: nine clocks free a slave stuck in the middle of a byte */
+#define I2C_CLEAR_PULSES        9
+#define I2C_CLEAR_HALF_CYCLES   (I2C_PCLK_HZ / I2C_SPEED_STANDARD / 2U)
+
+/* Bounded wait for the previous STOP before the next START; the STOP
+ * takes well under a bit time */
+#define I2C_STOP_SPIN           1000U
+
+/* Error flags of SR1; all are cleared by writing 0 */
+#define I2C_SR1_ERRORS          (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | \
+                                 I2C_SR1_OVR | I2C_SR1_TIMEOUT)
+
+/* AF4 on every SCL/SDA pin used here */
+#define I2C_PIN_AF              4U
+
+/* DMA1 stream 2 is the only RX stream of I2C3 and an RX stream of I2C2;
+ * stream 3, the other one I2C2 could use, carries USART3 TX */
+#define I2C_SHARED_STREAM       2U
+
+/* Flags of one stream in DMA1 LISR/HISR, shifted down to bit 0 */
+#define I2C_DMA_FEIF            (1UL << 0)
+#define I2C_DMA_DMEIF           (1UL << 2)
+#define I2C_DMA_TEIF            (1UL << 3)
+#define I2C_DMA_HTIF            (1UL << 4)
+#define I2C_DMA_TCIF            (1UL << 5)
+#define I2C_DMA_ALL             (I2C_DMA_FEIF | I2C_DMA_DMEIF | I2C_DMA_TEIF | \
+                                 I2C_DMA_HTIF | I2C_DMA_TCIF)
+
+typedef struct {
+    GPIO_TypeDef* port;
+    uint8_t pin;
+} I2C_Pin;
+
+/* Fixed hardware of each bus; DMA1 request channels per RM0090 table 42 */
+typedef struct {
+    I2C_TypeDef* regs;
+    DMA_Stream_TypeDef* rxStream;
+    DMA_Stream_TypeDef* txStream;
+    uint8_t rxIndex;
+    uint8_t txIndex;
+    uint8_t dmaChannel;
+    IRQn_Type evIrq;
+    IRQn_Type erIrq;
+    IRQn_Type rxIrq;
+    IRQn_Type txIrq;
+    uint32_t clock;             /* RCC_APB1ENR bit */
+    I2C_Pin scl;
+    I2C_Pin sda;
+} I2C_Hw;
+
+static const I2C_Hw i2c_hw[I2C_BUSES] = {
+    { I2C1, DMA1_Stream0, DMA1_Stream6, 0, 6, 1, I2C1_EV_IRQn, I2C1_ER_IRQn,
+      DMA1_Stream0_IRQn, DMA1_Stream6_IRQn, RCC_APB1ENR_I2C1EN, { GPIOB, 8 }, { GPIOB, 9 } },
+    { I2C2, DMA1_Stream2, DMA1_Stream7, 2, 7, 7, I2C2_EV_IRQn, I2C2_ER_IRQn,
+      DMA1_Stream2_IRQn, DMA1_Stream7_IRQn, RCC_APB1ENR_I2C2EN, { GPIOF, 1 }, { GPIOF, 0 } },
+    { I2C3, DMA1_Stream2, DMA1_Stream4, 2, 4, 3, I2C3_EV_IRQn, I2C3_ER_IRQn,
+      DMA1_Stream2_IRQn, DMA1_Stream4_IRQn, RCC_APB1ENR_I2C3EN, { GPIOA, 8 }, { GPIOC, 9 } },
+};
+
+/* Bit position of each stream's flags in LISR/HISR */
+static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+typedef struct {
+    I2C_Transaction* head;      /* Running or next transaction */
+    I2C_Transaction* tail;
+    uint32_t speedHz;
+    uint32_t startMs;           /* systick_counter at the START of head */
+    bool ready;
+    volatile bool active;       /* head is on the bus */
+    volatile bool waiting;      /* head needs the shared RX stream */
+    bool reading;               /* head is in its read phase */
+    I2C_Stats stats;
+} I2C_Bus;
+
+static I2C_Bus buses[I2C_BUSES];
+static int8_t shared_rx_owner = -1;     /* Bus index holding stream 2 */
+
+static void I2C_Start(uint8_t index);
+
+static uint32_t I2C_DmaFlags(uint8_t stream) {
+    volatile uint32_t* isr = (stream < 4) ? &DMA1->LISR : &DMA1->HISR;
+    return (*isr >> flag_shift[stream & 3]) & I2C_DMA_ALL;
+}
+
+static void I2C_DmaClear(uint8_t stream, uint32_t flags) {
+    volatile uint32_t* ifcr = (stream < 4) ? &DMA1->LIFCR : &DMA1->HIFCR;
+    *ifcr = flags << flag_shift[stream & 3];
+}
+
+static void I2C_DmaDisable(DMA_Stream_TypeDef* stream, uint8_t streamIndex) {
+    stream->CR &= ~DMA_SxCR_EN;
+    while (stream->CR & DMA_SxCR_EN);
+    I2C_DmaClear(streamIndex, I2C_DMA_ALL);
+}
+
+/* One-shot byte transfer between memory and DR. The I2C raises requests
+ * only once CR2.DMAEN is set, so the stream can be armed early. */
+static void I2C_DmaArm(uint8_t index, bool transmit, uint8_t* memory, uint16_t length) {
+    const I2C_Hw* hw = &i2c_hw[index];
+    DMA_Stream_TypeDef* stream = transmit ? hw->txStream : hw->rxStream;
+
+    I2C_DmaDisable(stream, transmit ? hw->txIndex : hw->rxIndex);
+    stream->PAR = (uint32_t)&hw->regs->DR;
+    stream->M0AR = (uint32_t)memory;
+    stream->NDTR = length;
+    stream->FCR = 0;    /* Direct mode */
+    stream->CR = ((uint32_t)hw->dmaChannel << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_0 |
+                 DMA_SxCR_MINC | DMA_SxCR_TEIE |
+                 (transmit ? DMA_SxCR_DIR_0 : DMA_SxCR_TCIE);
+    stream->CR |= DMA_SxCR_EN;
+}
+
+static void I2C_DelayCycles(uint32_t cycles) {
+    uint32_t start = DWT->CYCCNT;
+    while (DWT->CYCCNT - start < cycles);
+}
+
+static void I2C_PinMode(const I2C_Pin* pin, uint32_t mode) {
+    pin->port->MODER = (pin->port->MODER & ~(3UL << (pin->pin * 2U))) | (mode << (pin->pin * 2U));
+}
+
+static void I2C_ConfigurePin(const I2C_Pin* pin) {
+    uint32_t shift = (pin->pin & 7U) * 4U;
+    volatile uint32_t* afr = &pin->port->AFR[pin->pin >> 3];
+
+    RCC->AHB1ENR |= 1UL << (((uint32_t)pin->port - GPIOA_BASE) / 0x400UL);
+    pin->port->ODR |= 1UL << pin->pin;
+    pin->port->OTYPER |= 1UL << pin->pin;                  /* Open drain */
+    pin->port->OSPEEDR |= 2UL << (pin->pin * 2U);          /* Fast */
+    pin->port->PUPDR = (pin->port->PUPDR & ~(3UL << (pin->pin * 2U))) | (1UL << (pin->pin * 2U));
+    *afr = (*afr & ~(0xFUL << shift)) | (I2C_PIN_AF << shift);
+    I2C_PinMode(pin, 2U);
+}
+
+/* Timing registers from the bus speed; the peripheral must be disabled */
+static void I2C_Configure(uint8_t index) {
+    I2C_TypeDef* regs = i2c_hw[index].regs;
+    uint32_t speed = buses[index].speedHz;
+    uint32_t ccr;
+
+    regs->CR1 = I2C_CR1_SWRST;
+    regs->CR1 = 0;
+    regs->CR2 = I2C_PCLK_MHZ | I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+    if (speed > I2C_SPEED_STANDARD) {
+        /* Fast mode, duty 2:1: rounding up keeps the clock at or below speed */
+        ccr = (I2C_PCLK_HZ + 3U * speed - 1U) / (3U * speed);
+        regs->CCR = I2C_CCR_FS | ((ccr < 1U) ? 1U : ccr);
+        regs->TRISE = I2C_PCLK_MHZ * I2C_TRISE_FAST_NS / 1000U + 1U;
+    } else {
+        ccr = (I2C_PCLK_HZ + 2U * speed - 1U) / (2U * speed);
+        regs->CCR = (ccr < 4U) ? 4U : ccr;
+        regs->TRISE = I2C_PCLK_MHZ + 1U;
+    }
+    regs->CR1 = I2C_CR1_PE;
+}
+
+/* Free a bus held low by a slave that lost track of the transfer: clock
+ * SCL until it releases SDA, end with a STOP, then reset the peripheral.
+ * Runs with the bit timing of standard mode (about 100 us). */
+static void I2C_ClearBus(uint8_t index) {
+    const I2C_Hw* hw = &i2c_hw[index];
+    uint32_t scl = 1UL << hw->scl.pin;
+    uint32_t sda = 1UL << hw->sda.pin;
+
+    hw->regs->CR1 = 0;
+    hw->scl.port->BSRR = scl;
+    hw->sda.port->BSRR = sda;
+    I2C_PinMode(&hw->scl, 1U);
+    I2C_PinMode(&hw->sda, 1U);
+    I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+
+    for (uint8_t i = 0; i < I2C_CLEAR_PULSES && !(hw->sda.port->IDR & sda); i++) {
+        hw->scl.port->BSRR = scl << 16;
+        I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+        hw->scl.port->BSRR = scl;
+        I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+    }
+
+    /* STOP: SDA rises while SCL is high */
+    hw->scl.port->BSRR = scl << 16;
+    I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+    hw->sda.port->BSRR = sda << 16;
+    I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+    hw->scl.port->BSRR = scl;
+    I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+    hw->sda.port->BSRR = sda;
+    I2C_DelayCycles(I2C_CLEAR_HALF_CYCLES);
+
+    I2C_PinMode(&hw->scl, 2U);
+    I2C_PinMode(&hw->sda, 2U);
+    I2C_Configure(index);
+    buses[index].stats.recoveries++;
+}
+
+/* Stop both streams and the DMA/buffer requests of the peripheral */
+static void I2C_Quiesce(uint8_t index) {
+    const I2C_Hw* hw = &i2c_hw[index];
+
+    hw->regs->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST | I2C_CR2_ITBUFEN);
+    I2C_DmaDisable(hw->txStream, hw->txIndex);
+    if (shared_rx_owner < 0 || shared_rx_owner == (int8_t)index || hw->rxIndex != I2C_SHARED_STREAM) {
+        I2C_DmaDisable(hw->rxStream, hw->rxIndex);
+    }
+}
+
+/* Retire head with its final status and move on to the next one */
+static void I2C_Finish(uint8_t index, I2C_Status status) {
+    I2C_Bus* bus = &buses[index];
+    I2C_Transaction* txn = bus->head;
+
+    I2C_Quiesce(index);
+    bus->active = false;
+    bus->reading = false;
+
+    /* Hand the shared stream to the other bus if it is waiting for it */
+    if (shared_rx_owner == (int8_t)index) {
+        shared_rx_owner = -1;
+        uint8_t other = (uint8_t)(3U - index);
+        if (buses[other].waiting) {
+            buses[other].waiting = false;
+            I2C_Start(other);
+        }
+    }
+
+    bus->head = txn->next;
+    if (bus->head == NULL) {
+        bus->tail = NULL;
+    }
+    txn->next = NULL;
+    txn->status = status;
+    bus->stats.transactions++;
+
+    /* The callback may submit more; I2C_Submit starts an idle bus itself */
+    if (txn->callback != NULL) {
+        txn->callback(txn);
+    }
+    if (!bus->active && !bus->waiting && bus->head != NULL) {
+        I2C_Start(index);
+    }
+}
+
+/* Error path: NACKs end the transaction, everything else resets the bus
+ * and retries while attempts are left */
+static void I2C_Fail(uint8_t index, I2C_Status status) {
+    I2C_Bus* bus = &buses[index];
+    I2C_Transaction* txn = bus->head;
+    I2C_TypeDef* regs = i2c_hw[index].regs;
+
+    switch (status) {
+        case I2C_STATUS_NACK:       bus->stats.nacks++; break;
+        case I2C_STATUS_ARB_LOST:   bus->stats.arbitrationLost++; break;
+        case I2C_STATUS_TIMEOUT:    bus->stats.timeouts++; break;
+        default:                    bus->stats.busErrors++; break;
+    }
+
+    if (status == I2C_STATUS_NACK) {
+        regs->CR1 |= I2C_CR1_STOP;
+        I2C_Finish(index, status);
+        return;
+    }
+
+    /* After lost arbitration the peripheral is already back in slave mode
+     * and the bus belongs to the other master */
+    I2C_Quiesce(index);
+    if (status != I2C_STATUS_ARB_LOST) {
+        I2C_ClearBus(index);
+    }
+
+    if (txn->retries < I2C_MAX_RETRIES) {
+        txn->retries++;
+        bus->active = false;
+        bus->reading = false;
+        I2C_Start(index);
+    } else {
+        I2C_Finish(index, status);
+    }
+}
+
+/* Put head on the bus; the event interrupt takes it from the START on */
+static void I2C_Start(uint8_t index) {
+    const I2C_Hw* hw = &i2c_hw[index];
+    I2C_Bus* bus = &buses[index];
+    I2C_Transaction* txn = bus->head;
+
+    if (txn->rxLength >= 2 && hw->rxIndex == I2C_SHARED_STREAM) {
+        if (shared_rx_owner >= 0 && shared_rx_owner != (int8_t)index) {
+            bus->waiting = true;
+            return;
+        }
+        shared_rx_owner = (int8_t)index;
+    }
+
+    bus->reading = (txn->txLength == 0 && txn->rxLength > 0);
+    if (txn->txLength > 0) {
+        I2C_DmaArm(index, true, (uint8_t*)txn->txData, txn->txLength);
+    } else if (txn->rxLength >= 2) {
+        I2C_DmaArm(index, false, txn->rxData, txn->rxLength);
+    }
+
+    /* A START requested while the previous STOP is still pending is lost */
+    for (uint32_t spin = 0; (hw->regs->CR1 & I2C_CR1_STOP) && spin < I2C_STOP_SPIN; spin++);
+
+    bus->active = true;
+    bus->startMs = systick_counter;
+    hw->regs->CR1 |= I2C_CR1_START;
+}
+
+static bool I2C_BufferOk(const void* data, uint16_t length) {
+    uint32_t addr = (uint32_t)data;
+
+    return length == 0 || (data != NULL && !(addr >= 0x10000000UL && addr < 0x10010000UL));
+}
+
+I2C_Error I2C_Init(uint8_t bus, uint32_t speedHz) {
+    if (bus < 1 || bus > I2C_BUSES || speedHz < I2C_SPEED_MIN || speedHz > I2C_SPEED_FAST) {
+        return I2C_ERROR_PARAM;
+    }
+    uint8_t index = (uint8_t)(bus - 1);
+    const I2C_Hw* hw = &i2c_hw[index];
+    I2C_Bus* state = &buses[index];
+
+    NVIC_DisableIRQ(hw->evIrq);
+    NVIC_DisableIRQ(hw->erIrq);
+
+    /* Bus clearing is timed with the cycle counter */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    RCC->APB1ENR |= hw->clock;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    I2C_ConfigurePin(&hw->scl);
+    I2C_ConfigurePin(&hw->sda);
+
+    if (shared_rx_owner == (int8_t)index) {
+        shared_rx_owner = -1;
+    }
+    memset(state, 0, sizeof(*state));
+    state->speedHz = speedHz;
+    I2C_ClearBus(index);
+    state->stats.recoveries = 0;
+    state->ready = true;
+
+    NVIC_EnableIRQ(hw->evIrq);
+    NVIC_EnableIRQ(hw->erIrq);
+    NVIC_EnableIRQ(hw->rxIrq);
+    NVIC_EnableIRQ(hw->txIrq);
+    return I2C_OK;
+}
+
+I2C_Error I2C_Submit(uint8_t bus, I2C_Transaction* txn) {
+    if (bus < 1 || bus > I2C_BUSES || txn == NULL) {
+        return I2C_ERROR_PARAM;
+    }
+    uint8_t index = (uint8_t)(bus - 1);
+    I2C_Bus* state = &buses[index];
+    if (!state->ready) {
+        return I2C_ERROR_NOT_READY;
+    }
+
+    /* Check the whole chain before any of it is queued */
+    I2C_Transaction* last = txn;
+    for (I2C_Transaction* t = txn; t != NULL; t = t->next) {
+        if (t->address > 0x7F || !I2C_BufferOk(t->txData, t->txLength) ||
+            !I2C_BufferOk(t->rxData, t->rxLength)) {
+            return I2C_ERROR_PARAM;
+        }
+        last = t;
+    }
+    for (I2C_Transaction* t = txn; t != NULL; t = t->next) {
+        t->status = I2C_STATUS_PENDING;
+        t->retries = 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (state->head == NULL) {
+        state->head = txn;
+        state->tail = last;
+        I2C_Start(index);
+    } else {
+        state->tail->next = txn;
+        state->tail = last;
+    }
+    __set_PRIMASK(primask);
+
+    return I2C_OK;
+}
+
+bool I2C_IsBusy(uint8_t bus) {
+    if (bus < 1 || bus > I2C_BUSES) {
+        return false;
+    }
+    return buses[bus - 1].head != NULL;
+}
+
+void I2C_Process(void) {
+    for (uint8_t i = 0; i < I2C_BUSES; i++) {
+        I2C_Bus* bus = &buses[i];
+        if (!bus->active) {
+            continue;
+        }
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (bus->active && systick_counter - bus->startMs > I2C_TIMEOUT_MS) {
+            I2C_Fail(i, I2C_STATUS_TIMEOUT);
+        }
+        __set_PRIMASK(primask);
+    }
+}
+
+void I2C_GetStats(uint8_t bus, I2C_Stats* stats) {
+    if (stats == NULL || bus < 1 || bus > I2C_BUSES) {
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = buses[bus - 1].stats;
+    __set_PRIMASK(primask);
+}
+
+/* Master events: SB, ADDR, BTF at the end of a DMA write, RXNE for a
+ * single-byte read. ADDR is cleared by reading SR1 then SR2, and DMAEN,
+ * LAST and ACK must be set before that. */
+static void I2C_EventIrq(uint8_t index) {
+    const I2C_Hw* hw = &i2c_hw[index];
+    I2C_TypeDef* regs = hw->regs;
+    I2C_Bus* bus = &buses[index];
+    I2C_Transaction* txn = bus->head;
+    uint32_t sr1 = regs->SR1;
+
+    bus->stats.interrupts++;
+    if (!bus->active) {
+        (void)regs->SR2;
+        return;
+    }
+
+    if (sr1 & I2C_SR1_SB) {
+        regs->DR = (uint32_t)(txn->address << 1) | (bus->reading ? 1U : 0U);
+        return;
+    }
+
+    if (sr1 & I2C_SR1_ADDR) {
+        if (!bus->reading) {
+            if (txn->txLength == 0) {
+                /* Address probe */
+                (void)regs->SR2;
+                regs->CR1 |= I2C_CR1_STOP;
+                I2C_Finish(index, I2C_STATUS_DONE);
+                return;
+            }
+            regs->CR2 |= I2C_CR2_DMAEN;
+            (void)regs->SR2;
+        } else if (txn->rxLength == 1) {
+            /* DMA cannot NACK a single byte; the STOP goes out after it */
+            regs->CR1 &= ~I2C_CR1_ACK;
+            (void)regs->SR2;
+            regs->CR1 |= I2C_CR1_STOP;
+            regs->CR2 |= I2C_CR2_ITBUFEN;
+        } else {
+            /* LAST makes the peripheral NACK the byte after the DMA's
+             * second-to-last request */
+            regs->CR1 |= I2C_CR1_ACK;
+            regs->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
+            (void)regs->SR2;
+        }
+        return;
+    }
+
+    if ((sr1 & I2C_SR1_RXNE) && bus->reading && txn->rxLength == 1) {
+        txn->rxData[0] = (uint8_t)regs->DR;
+        I2C_Finish(index, I2C_STATUS_DONE);
+        return;
+    }
+
+    /* BTF after the DMA has fed the last byte: the write phase is done */
+    if ((sr1 & I2C_SR1_BTF) && !bus->reading && hw->txStream->NDTR == 0) {
+        regs->CR2 &= ~I2C_CR2_DMAEN;
+        if (txn->rxLength == 0) {
+            regs->CR1 |= I2C_CR1_STOP;
+            I2C_Finish(index, I2C_STATUS_DONE);
+            return;
+        }
+        bus->reading = true;
+        if (txn->rxLength >= 2) {
+            I2C_DmaArm(index, false, txn->rxData, txn->rxLength);
+        }
+        regs->CR1 |= I2C_CR1_START;
+    }
+}
+
+static void I2C_ErrorIrq(uint8_t index) {
+    I2C_TypeDef* regs = i2c_hw[index].regs;
+    uint32_t errors = regs->SR1 & I2C_SR1_ERRORS;
+
+    buses[index].stats.interrupts++;
+    regs->SR1 = ~errors & 0xFFFFUL;
+    if (!buses[index].active || errors == 0) {
+        return;
+    }
+
+    if (errors & I2C_SR1_AF) {
+        I2C_Fail(index, I2C_STATUS_NACK);
+    } else if (errors & I2C_SR1_ARLO) {
+        I2C_Fail(index, I2C_STATUS_ARB_LOST);
+    } else {
+        I2C_Fail(index, I2C_STATUS_BUS_ERROR);
+    }
+}
+
+/* RX complete: the last byte has been NACKed, end with a STOP */
+static void I2C_DmaRxIrq(uint8_t index) {
+    uint8_t stream = i2c_hw[index].rxIndex;
+    uint32_t flags = I2C_DmaFlags(stream);
+
+    I2C_DmaClear(stream, flags);
+    buses[index].stats.interrupts++;
+    if (!buses[index].active) {
+        return;
+    }
+    if (flags & I2C_DMA_TEIF) {
+        I2C_Fail(index, I2C_STATUS_BUS_ERROR);
+    } else if ((flags & I2C_DMA_TCIF) && buses[index].reading) {
+        i2c_hw[index].regs->CR1 |= I2C_CR1_STOP;
+        I2C_Finish(index, I2C_STATUS_DONE);
+    }
+}
+
+/* TX streams only interrupt on errors; BTF ends the write phase */
+static void I2C_DmaTxIrq(uint8_t index) {
+    uint8_t stream = i2c_hw[index].txIndex;
+    uint32_t flags = I2C_DmaFlags(stream);
+
+    I2C_DmaClear(stream, flags);
+    buses[index].stats.interrupts++;
+    if (buses[index].active && (flags & I2C_DMA_TEIF)) {
+        I2C_Fail(index, I2C_STATUS_BUS_ERROR);
+    }
+}
+
+void I2C1_EV_IRQHandler(void) {
+    I2C_EventIrq(0);
+}
+
+void I2C1_ER_IRQHandler(void) {
+    I2C_ErrorIrq(0);
+}
+
+void I2C2_EV_IRQHandler(void) {
+    I2C_EventIrq(1);
+}
+
+void I2C2_ER_IRQHandler(void) {
+    I2C_ErrorIrq(1);
+}
+
+void I2C3_EV_IRQHandler(void) {
+    I2C_EventIrq(2);
+}
+
+void I2C3_ER_IRQHandler(void) {
+    I2C_ErrorIrq(2);
+}
+
+void DMA1_Stream0_IRQHandler(void) {
+    I2C_DmaRxIrq(0);
+}
+
+void DMA1_Stream6_IRQHandler(void) {
+    I2C_DmaTxIrq(0);
+}
+
+/* Shared by I2C2 and I2C3 reads */
+void DMA1_Stream2_IRQHandler(void) {
+    if (shared_rx_owner >= 0) {
+        I2C_DmaRxIrq((uint8_t)shared_rx_owner);
+    } else {
+        I2C_DmaClear(I2C_SHARED_STREAM, I2C_DMA_ALL);
+    }
+}
+
+void DMA1_Stream7_IRQHandler(void) {
+    I2C_DmaTxIrq(1);
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+    I2C_DmaTxIrq(2);
+}
+
+/* ---- Shell command ---- */
+
+#define I2C_SCAN_FIRST          0x08U
+#define I2C_SCAN_LAST           0x77U
+#define I2C_SCAN_BATCH          16U
+#define I2C_READ_MAX            16U
+
+/* Probes go out as one chain per batch */
+static I2C_Transaction i2c_cmd_txn[I2C_SCAN_BATCH];
+static uint8_t i2c_cmd_reg;
+static uint8_t i2c_cmd_data[I2C_READ_MAX];
+
+/* Submit, bringing the bus up at standard speed on first use */
+static bool I2C_CmdSubmit(uint8_t bus, I2C_Transaction* txn) {
+    I2C_Error error = I2C_Submit(bus, txn);
+
+    if (error == I2C_ERROR_NOT_READY && I2C_Init(bus, I2C_SPEED_STANDARD) == I2C_OK) {
+        error = I2C_Submit(bus, txn);
+    }
+    return error == I2C_OK;
+}
+
+static Shell_Status I2C_CmdScan(uint8_t bus) {
+    static uint8_t next;
+    static uint8_t found;
+
+    if (Shell_GetStep() == 0) {
+        next = I2C_SCAN_FIRST;
+        found = 0;
+    } else if (I2C_IsBusy(bus)) {
+        return SHELL_MORE;
+    } else {
+        /* Report the batch that just finished */
+        for (uint8_t i = 0; i < I2C_SCAN_BATCH && i2c_cmd_txn[i].address != 0; i++) {
+            if (i2c_cmd_txn[i].status == I2C_STATUS_DONE) {
+                FMT_Print("  0x%02X\r\n", i2c_cmd_txn[i].address);
+                found++;
+            }
+        }
+        if (next > I2C_SCAN_LAST) {
+            FMT_Print("%u device(s) on I2C%u\r\n", found, bus);
+            return SHELL_OK;
+        }
+    }
+
+    memset(i2c_cmd_txn, 0, sizeof(i2c_cmd_txn));
+    for (uint8_t i = 0; i < I2C_SCAN_BATCH && next <= I2C_SCAN_LAST; i++, next++) {
+        i2c_cmd_txn[i].address = next;
+        if (i > 0) {
+            i2c_cmd_txn[i - 1].next = &i2c_cmd_txn[i];
+        }
+    }
+    if (!I2C_CmdSubmit(bus, &i2c_cmd_txn[0])) {
+        FMT_Print("I2C%u is not available\r\n", bus);
+        return SHELL_ERROR_FAILED;
+    }
+    return SHELL_MORE;
+}
+
+static Shell_Status I2C_CmdRead(uint8_t bus, int argc, char* argv[]) {
+    I2C_Transaction* txn = &i2c_cmd_txn[0];
+
+    if (Shell_GetStep() == 0) {
+        uint32_t address;
+        uint32_t reg;
+        uint32_t count = 1;
+        if (argc < 5 || argc > 6 || !Shell_ParseU32(argv[3], &address) || address > 0x7F ||
+            !Shell_ParseU32(argv[4], &reg) || reg > 0xFF ||
+            (argc == 6 && (!Shell_ParseU32(argv[5], &count) || count == 0 || count > I2C_READ_MAX))) {
+            return SHELL_ERROR_USAGE;
+        }
+        memset(txn, 0, sizeof(*txn));
+        i2c_cmd_reg = (uint8_t)reg;
+        txn->address = (uint8_t)address;
+        txn->txData = &i2c_cmd_reg;
+        txn->txLength = 1;
+        txn->rxData = i2c_cmd_data;
+        txn->rxLength = (uint16_t)count;
+        if (!I2C_CmdSubmit(bus, txn)) {
+            FMT_Print("I2C%u is not available\r\n", bus);
+            return SHELL_ERROR_FAILED;
+        }
+        return SHELL_MORE;
+    }
+
+    if (txn->status == I2C_STATUS_PENDING) {
+        return SHELL_MORE;
+    }
+    if (txn->status != I2C_STATUS_DONE) {
+        static const char* const names[] = { "idle", "pending", "done", "NACK", "bus error",
+                                             "arbitration lost", "timeout" };
+        FMT_Print("failed: %s after %u retries\r\n", names[txn->status], txn->retries);
+        return SHELL_ERROR_FAILED;
+    }
+    FMT_Print("0x%02X:", i2c_cmd_reg);
+    for (uint16_t i = 0; i < txn->rxLength; i++) {
+        FMT_Print(" %02X", i2c_cmd_data[i]);
+    }
+    FMT_Print("\r\n");
+    return SHELL_OK;
+}
+
+static Shell_Status I2C_Cmd(int argc, char* argv[]) {
+    uint32_t bus;
+
+    if (argc < 3 || !Shell_ParseU32(argv[1], &bus) || bus < 1 || bus > I2C_BUSES) {
+        return SHELL_ERROR_USAGE;
+    }
+
+    if (strcmp(argv[2], "stats") == 0 && argc == 3) {
+        I2C_Stats stats;
+        I2C_GetStats((uint8_t)bus, &stats);
+        FMT_Print("I2C%lu  %lu transactions, %lu interrupts, %lu NACKs, %lu bus errors, "
+                  "%lu arbitration lost, %lu timeouts, %lu recoveries\r\n",
+                  bus, stats.transactions, stats.interrupts, stats.nacks, stats.busErrors,
+                  stats.arbitrationLost, stats.timeouts, stats.recoveries);
+        return SHELL_OK;
+    }
+    if (strcmp(argv[2], "scan") == 0 && argc == 3) {
+        return I2C_CmdScan((uint8_t)bus);
+    }
+    if (strcmp(argv[2], "read") == 0) {
+        return I2C_CmdRead((uint8_t)bus, argc, argv);
+    }
+    return SHELL_ERROR_USAGE;
+}
+SHELL_COMMAND("i2c", "<1-3> scan|stats|read <addr> <reg> [count]",
+              "Probe, read or show the counters of an I2C bus", I2C_Cmd);
@@ -0,0 +1,201 @@
+/* @imu.c */
+#include "imu.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+
+#define IMU_EXTI_BIT            (1UL << IMU_EXTI_LINE)
+
+/* Largest burst, with the headroom, that IMU_MAX_SEGMENTS hold */
+#define IMU_MAX_BYTES           (IMU_MAX_SEGMENTS * PBUF_SEGMENT_SIZE)
+
+static Imu_Config imu_config;
+static GPIO_TypeDef* imu_port;
+static volatile bool imu_running = false;
+static volatile bool imu_busy = false;      /* A burst is on the bus */
+static PBuf* imu_burst;                     /* Chain being filled */
+
+/* Address byte, then one transfer per segment */
+static uint8_t imu_command;
+static Spi_Transfer imu_xfer[1 + IMU_MAX_SEGMENTS];
+
+static volatile uint32_t imu_bursts;
+static volatile uint32_t imu_bytes;
+static volatile uint32_t imu_no_buffer;
+static volatile uint32_t imu_errors;
+
+static void Imu_StartBurst(void);
+
+static bool Imu_Asserted(void) {
+    bool high = (imu_port->IDR & IMU_EXTI_BIT) != 0;
+    return high == imu_config.activeHigh;
+}
+
+/* Last transfer of a burst done: hand the chain over, and go again if the
+ * FIFO is already back above the watermark */
+static void Imu_BurstDone(Spi_Transfer* xfer) {
+    PBuf* burst = imu_burst;
+
+    imu_burst = NULL;
+    imu_busy = false;
+    if (xfer->status != SPI_STATUS_DONE) {
+        imu_errors++;
+        PBuf_Free(burst);
+    } else {
+        imu_bursts++;
+        imu_bytes += burst->totLen;
+        imu_config.callback(burst);
+    }
+
+    if (imu_running && Imu_Asserted()) {
+        Imu_StartBurst();
+    }
+}
+
+/* Interrupt context, or the main loop with interrupts masked */
+static void Imu_StartBurst(void) {
+    PBuf* burst = PBuf_Alloc(imu_config.burstBytes, imu_config.headroom);
+    if (burst == NULL) {
+        imu_no_buffer++;
+        return;
+    }
+
+    imu_command = imu_config.fifoRegister | IMU_READ_BIT;
+    imu_xfer[0].device = imu_config.device;
+    imu_xfer[0].txData = &imu_command;
+    imu_xfer[0].rxData = NULL;
+    imu_xfer[0].length = 1;
+    imu_xfer[0].flags = SPI_HOLD_CS;
+    imu_xfer[0].callback = NULL;
+
+    /* The chain is submitted as one unit, so nothing else on the bus can
+     * come between its transfers and the chip select stays low */
+    uint8_t n = 1;
+    for (PBuf* segment = burst; segment != NULL; segment = segment->next, n++) {
+        imu_xfer[n].device = imu_config.device;
+        imu_xfer[n].txData = NULL;
+        imu_xfer[n].rxData = segment->payload;
+        imu_xfer[n].length = segment->len;
+        imu_xfer[n].flags = SPI_HOLD_CS;
+        imu_xfer[n].callback = NULL;
+        imu_xfer[n - 1].next = &imu_xfer[n];
+    }
+    imu_xfer[n - 1].flags = 0;
+    imu_xfer[n - 1].callback = Imu_BurstDone;
+    imu_xfer[n - 1].next = NULL;
+
+    imu_burst = burst;
+    imu_busy = true;
+    if (Spi_Submit(&imu_xfer[0]) != SPI_OK) {
+        imu_busy = false;
+        imu_burst = NULL;
+        imu_errors++;
+        PBuf_Free(burst);
+    }
+}
+
+Imu_Error Imu_Start(const Imu_Config* config) {
+    if (config == NULL || config->device == NULL || config->callback == NULL ||
+        config->burstBytes == 0 || config->headroom >= PBUF_SEGMENT_SIZE ||
+        config->burstBytes + config->headroom > IMU_MAX_BYTES ||
+        config->intPort < 'A' || config->intPort > 'K') {
+        return IMU_ERROR_PARAM;
+    }
+    if (imu_running) {
+        return IMU_ERROR_BUSY;
+    }
+
+    imu_config = *config;
+    imu_port = (GPIO_TypeDef*)(GPIOA_BASE + (uint32_t)(config->intPort - 'A') * 0x400UL);
+    imu_bursts = 0;
+    imu_bytes = 0;
+    imu_no_buffer = 0;
+    imu_errors = 0;
+
+    /* Input on line IMU_EXTI_LINE of the chosen port, edge into the
+     * asserted level */
+    uint32_t portIndex = (uint32_t)(config->intPort - 'A');
+    uint32_t shift = (IMU_EXTI_LINE % 4U) * 4U;
+    RCC->AHB1ENR |= 1UL << portIndex;
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    imu_port->MODER &= ~(3UL << (IMU_EXTI_LINE * 2U));
+    SYSCFG->EXTICR[IMU_EXTI_LINE / 4] = (SYSCFG->EXTICR[IMU_EXTI_LINE / 4] & ~(0xFUL << shift)) |
+                                        (portIndex << shift);
+    if (config->activeHigh) {
+        EXTI->RTSR |= IMU_EXTI_BIT;
+        EXTI->FTSR &= ~IMU_EXTI_BIT;
+    } else {
+        EXTI->FTSR |= IMU_EXTI_BIT;
+        EXTI->RTSR &= ~IMU_EXTI_BIT;
+    }
+    EXTI->PR = IMU_EXTI_BIT;
+    EXTI->IMR |= IMU_EXTI_BIT;
+
+    imu_running = true;
+    NVIC_EnableIRQ(EXTI4_IRQn);
+
+    /* The FIFO may already be over the watermark; no edge will come */
+    NVIC_SetPendingIRQ(EXTI4_IRQn);
+    return IMU_OK;
+}
+
+void Imu_Stop(void) {
+    EXTI->IMR &= ~IMU_EXTI_BIT;
+    NVIC_DisableIRQ(EXTI4_IRQn);
+    imu_running = false;
+}
+
+void Imu_Process(void) {
+    if (!imu_running || imu_busy) {
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (imu_running && !imu_busy && Imu_Asserted()) {
+        Imu_StartBurst();
+    }
+    __set_PRIMASK(primask);
+}
+
+void Imu_GetStats(Imu_Stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->bursts = imu_bursts;
+    stats->bytes = imu_bytes;
+    stats->noBuffer = imu_no_buffer;
+    stats->errors = imu_errors;
+    stats->running = imu_running;
+}
+
+void EXTI4_IRQHandler(void) {
+    EXTI->PR = IMU_EXTI_BIT;
+    if (imu_running && !imu_busy && Imu_Asserted()) {
+        Imu_StartBurst();
+    }
+}
+
+/* ---- Shell command ---- */
+
+static Shell_Status Imu_Cmd(int argc, char* argv[]) {
+    (void)argv;
+    if (argc != 1) {
+        return SHELL_ERROR_USAGE;
+    }
+
+    Imu_Stats stats;
+    Imu_GetStats(&stats);
+    FMT_Print("IMU %s  %lu bursts, %lu bytes, %lu postponed (pool empty), %lu errors, %u segments free\r\n",
+              stats.running ? "on " : "off", stats.bursts, stats.bytes, stats.noBuffer,
+              stats.errors, PBuf_GetFreeCount());
+
+    if (imu_config.device != NULL) {
+        Spi_Stats spi;
+        Spi_GetStats(imu_config.device->bus, &spi);
+        FMT_Print("SPI%u  %lu transfers, %lu bytes, %lu DMA errors\r\n",
+                  imu_config.device->bus, spi.transfers, spi.bytes, spi.dmaErrors);
+    }
+    return SHELL_OK;
+}
+SHELL_COMMAND("imu", "", "IMU burst and SPI counters", Imu_Cmd);
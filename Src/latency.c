@@ -0,0 +1,663 @@
+/* @latency.c - Interrupt latency and jitter harness */
+#include "latency.h"
+#include "uart.h"
+#include "systick.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+#define LAT_CPU_HZ              16000000UL
+#define LAT_MIN_GAP             1000U       /* Cycles between events, plus up to */
+#define LAT_GAP_SPREAD          7000U       /* this much so loads don't phase-lock */
+#define LAT_TIMEOUT_CYCLES      (LAT_CPU_HZ / 10)
+#define LAT_RX_TIMEOUT_CYCLES   (LAT_CPU_HZ / 250)  /* Several frames at 9600 baud */
+#define LAT_RX_CALIBRATE        8
+#define LAT_ERASE_TIMEOUT_MS    4000
+#define LAT_EXTI_BIT            (1UL << LATENCY_EXTI_LINE)
+#define LAT_FLASH_KEY1          0x45670123UL
+#define LAT_FLASH_KEY2          0xCDEF89ABUL
+#define LAT_FLASH_ERRORS        (FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+                                 FLASH_SR_PGPERR | FLASH_SR_PGSERR | FLASH_SR_RDERR)
+#define LAT_NO_LOOPBACK         0xFFFFFFFFUL
+#define LAT_BINS_PER_STEP       12          /* Histogram bins printed per Latency_Step() */
+
+typedef enum {
+    LAT_IDLE = 0,
+    LAT_ARMED,              /* Event triggered, handler not run yet */
+    LAT_HANDLED,            /* Handler ran and pended PendSV */
+    LAT_WOKEN               /* PendSV ran */
+} Lat_State;
+
+/* What the next Latency_Step() does */
+typedef enum {
+    LAT_PHASE_CASE = 0,     /* Run the next case, print the entry summary */
+    LAT_PHASE_ENTRY_BINS,   /* Entry histogram, then the wakeup summary */
+    LAT_PHASE_WAKEUP_BINS,  /* Wakeup histogram */
+    LAT_PHASE_DONE
+} Lat_Phase;
+
+static const char* const event_names[LATENCY_EVENT_COUNT] = { "timer", "exti", "uart_rx" };
+static const char* const load_names[LATENCY_LOAD_COUNT] = { "none", "flash", "uart_tx", "churn" };
+static const char* const stage_names[LATENCY_STAGE_COUNT] = { "entry", "wakeup" };
+
+static const char csv_header[] =
+    "event,load,stage,samples,missed,min,p50,p90,p99,p99_9,max,mean";
+
+/* One line per TX ring refill under the UART load */
+static const char filler[] =
+    "latency harness UART TX load ..................................\r\n";
+
+static volatile uint8_t lat_state = LAT_IDLE;
+static volatile uint8_t lat_event = LATENCY_EVENT_TIMER;
+static volatile uint32_t lat_handled = 0;   /* CYCCNT at handler entry */
+static volatile uint32_t lat_woken = 0;     /* CYCCNT at PendSV entry */
+static volatile uint8_t churn_pending = 0;
+
+static bool lat_ready = false;
+static uint32_t lat_random = 0x2545F491UL;
+static uint32_t rx_delay = LAT_NO_LOOPBACK; /* DR write to RXNE, measured by polling */
+static uint32_t flash_next = 0;             /* Next word to program, 0 = load off */
+
+static Latency_Hist hist_entry;
+static Latency_Hist hist_wakeup;
+
+/* Matrix being run by Latency_Step() */
+static Latency_Config run_config;
+static uint8_t run_next = 0;                /* event * LATENCY_LOAD_COUNT + load */
+static uint8_t run_phase = LAT_PHASE_DONE;
+static uint16_t run_bin = 0;
+static int32_t run_missed = 0;
+static uint32_t run_records = 0;
+static bool run_receiveIT = false;
+
+/* Histogram */
+
+void Latency_HistReset(Latency_Hist* hist) {
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT32_MAX;
+}
+
+uint16_t Latency_HistBin(uint32_t cycles) {
+    if (cycles < (2U << LATENCY_HIST_SUB_BITS)) {
+        return (uint16_t)cycles;
+    }
+
+    /* Keep the top LATENCY_HIST_SUB_BITS + 1 bits: 16 bins per octave */
+    uint32_t shift = (31U - __CLZ(cycles)) - LATENCY_HIST_SUB_BITS;
+    uint32_t bin = ((shift + 1U) << LATENCY_HIST_SUB_BITS) +
+                   ((cycles >> shift) - (1U << LATENCY_HIST_SUB_BITS));
+
+    return (bin < LATENCY_HIST_BINS) ? (uint16_t)bin : (uint16_t)(LATENCY_HIST_BINS - 1);
+}
+
+uint32_t Latency_HistBinMax(uint16_t bin) {
+    if (bin < (2U << LATENCY_HIST_SUB_BITS)) {
+        return bin;
+    }
+    if (bin >= LATENCY_HIST_BINS - 1) {
+        return UINT32_MAX;      /* Everything clamped into the last bin */
+    }
+
+    uint32_t shift = ((uint32_t)bin >> LATENCY_HIST_SUB_BITS) - 1U;
+    uint32_t lower = ((1U << LATENCY_HIST_SUB_BITS) +
+                      (bin & ((1U << LATENCY_HIST_SUB_BITS) - 1U))) << shift;
+    return lower + (1U << shift) - 1U;
+}
+
+void Latency_HistAdd(Latency_Hist* hist, uint32_t cycles) {
+    hist->bins[Latency_HistBin(cycles)]++;
+    hist->count++;
+    hist->sum += cycles;
+    if (cycles < hist->min) {
+        hist->min = cycles;
+    }
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+}
+
+uint32_t Latency_HistPercentile(const Latency_Hist* hist, uint16_t permyriad) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    uint32_t rank = (uint32_t)(((uint64_t)hist->count * permyriad + 9999U) / 10000U);
+    uint32_t seen = 0;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    for (uint16_t bin = 0; bin < LATENCY_HIST_BINS; bin++) {
+        seen += hist->bins[bin];
+        if (seen >= rank) {
+            uint32_t value = Latency_HistBinMax(bin);
+            if (value > hist->max) {
+                value = hist->max;
+            }
+            if (value < hist->min) {
+                value = hist->min;
+            }
+            return value;
+        }
+    }
+    return hist->max;
+}
+
+void Latency_HistSummarize(const Latency_Hist* hist, Latency_Summary* summary) {
+    summary->samples = hist->count;
+    summary->min = (hist->count != 0) ? hist->min : 0;
+    summary->p50 = Latency_HistPercentile(hist, 5000);
+    summary->p90 = Latency_HistPercentile(hist, 9000);
+    summary->p99 = Latency_HistPercentile(hist, 9900);
+    summary->p999 = Latency_HistPercentile(hist, 9990);
+    summary->max = hist->max;
+    summary->mean = (hist->count != 0) ? (uint32_t)(hist->sum / hist->count) : 0;
+}
+
+/* Event side */
+
+static uint32_t Lat_Random(void) {
+    /* xorshift32 */
+    lat_random ^= lat_random << 13;
+    lat_random ^= lat_random >> 17;
+    lat_random ^= lat_random << 5;
+    return lat_random;
+}
+
+static void Lat_Spin(uint32_t cycles) {
+    uint32_t start = DWT->CYCCNT;
+    while ((DWT->CYCCNT - start) < cycles);
+}
+
+/* Common tail of every event handler: record entry, wake the task */
+static void Lat_Handled(uint32_t now) {
+    if (lat_state == LAT_ARMED) {
+        lat_handled = now;
+        lat_state = LAT_HANDLED;
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+}
+
+void TIM2_IRQHandler(void) {
+    uint32_t now = DWT->CYCCNT;
+
+    TIM2->DIER = 0;
+    TIM2->SR = ~TIM_SR_CC1IF;
+    Lat_Handled(now);
+}
+
+void EXTI1_IRQHandler(void) {
+    uint32_t now = DWT->CYCCNT;
+
+    EXTI->PR = LAT_EXTI_BIT;
+    Lat_Handled(now);
+}
+
+/* Runs at the end of USART3_IRQHandler, after the byte is in the ring */
+static void Lat_UartRx(void) {
+    uint32_t now = DWT->CYCCNT;
+
+    if (lat_event == LATENCY_EVENT_UART_RX) {
+        Lat_Handled(now);
+    }
+}
+
+/* Lowest priority: where an RTOS would switch to the woken task */
+void PendSV_Handler(void) {
+    uint32_t now = DWT->CYCCNT;
+
+    if (lat_state == LAT_HANDLED) {
+        lat_woken = now;
+        lat_state = LAT_WOKEN;
+    }
+    if (churn_pending) {
+        churn_pending = 0;
+        Lat_Spin(LATENCY_CHURN_CYCLES);
+    }
+}
+
+void TIM3_IRQHandler(void) {
+    TIM3->SR = ~TIM_SR_UIF;
+    churn_pending = 1;
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* TIM2 counts at the APB1 timer clock, which equals HCLK while the APB1
+ * prescaler is 1 (reset clocks), so CCR1 tells the cycle of the match */
+static uint32_t Lat_ArmTimer(uint32_t delay) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t before = TIM2->CNT;
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t after = TIM2->CNT;
+
+    /* Counter value at the CYCCNT read: halfway between the two bus reads */
+    TIM2->CCR1 = before + (after - before) / 2U + delay;
+    TIM2->SR = ~TIM_SR_CC1IF;
+    TIM2->DIER = TIM_DIER_CC1IE;
+
+    __set_PRIMASK(primask);
+    return cycles + delay;
+}
+
+/* DR write to RXNE over the PD8-PD9 jumper, polled with interrupts off.
+ * The fastest of a few tries; LAT_NO_LOOPBACK if nothing comes back. */
+static uint32_t Lat_CalibrateRx(void) {
+    uint32_t best = LAT_NO_LOOPBACK;
+
+    UART_StopReceiveIT();
+    for (int i = 0; i < LAT_RX_CALIBRATE; i++) {
+        while (!(USART3->SR & USART_SR_TC));
+        (void)USART3->SR;
+        (void)USART3->DR;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t start = DWT->CYCCNT;
+        USART3->DR = 0x55;
+        while (!(USART3->SR & USART_SR_RXNE) && (DWT->CYCCNT - start) < LAT_RX_TIMEOUT_CYCLES);
+        uint32_t elapsed = DWT->CYCCNT - start;
+        bool received = (USART3->SR & USART_SR_RXNE) != 0;
+        (void)USART3->DR;
+        __set_PRIMASK(primask);
+
+        if (!received) {
+            return LAT_NO_LOOPBACK;
+        }
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/* Background loads */
+
+static bool Lat_FlashWait(uint32_t timeoutMs) {
+    uint32_t start = systick_counter;
+
+    while (FLASH->SR & FLASH_SR_BSY) {
+        if ((systick_counter - start) > timeoutMs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void Lat_FlashStart(void) {
+    if (FLASH->CR & FLASH_CR_LOCK) {
+        FLASH->KEYR = LAT_FLASH_KEY1;
+        FLASH->KEYR = LAT_FLASH_KEY2;
+    }
+    FLASH->SR = FLASH_SR_EOP | LAT_FLASH_ERRORS;
+
+    /* Erase once per case so every word programmed below starts blank */
+    bool ok = Lat_FlashWait(LAT_ERASE_TIMEOUT_MS);
+    if (ok) {
+        FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_SER | (LATENCY_FLASH_SNB << FLASH_CR_SNB_Pos);
+        FLASH->CR |= FLASH_CR_STRT;
+        ok = Lat_FlashWait(LAT_ERASE_TIMEOUT_MS) && !(FLASH->SR & LAT_FLASH_ERRORS);
+    }
+
+    FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+    flash_next = ok ? LATENCY_FLASH_BASE : 0;
+}
+
+static void Lat_FlashStep(void) {
+    if (flash_next == 0 || flash_next >= LATENCY_FLASH_BASE + LATENCY_FLASH_SIZE) {
+        return;
+    }
+    *(volatile uint32_t*)flash_next = flash_next;
+    flash_next += 4;
+    while (FLASH->SR & FLASH_SR_BSY);
+}
+
+static void Lat_FlashStop(void) {
+    FLASH->CR = 0;
+    FLASH->CR = FLASH_CR_LOCK;
+    flash_next = 0;
+}
+
+static void Lat_ChurnStart(void) {
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    TIM3->CR1 = 0;
+    TIM3->PSC = 0;
+    TIM3->ARR = LAT_CPU_HZ / LATENCY_CHURN_HZ - 1U;
+    TIM3->EGR = TIM_EGR_UG;
+    TIM3->SR = 0;
+    TIM3->DIER = TIM_DIER_UIE;
+    NVIC_EnableIRQ(TIM3_IRQn);
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+static void Lat_ChurnStop(void) {
+    TIM3->CR1 = 0;
+    TIM3->DIER = 0;
+    TIM3->SR = 0;
+    NVIC_DisableIRQ(TIM3_IRQn);
+    churn_pending = 0;
+}
+
+static void Lat_LoadStart(Latency_Load load) {
+    switch (load) {
+        case LATENCY_LOAD_FLASH:   Lat_FlashStart(); break;
+        case LATENCY_LOAD_CHURN:   Lat_ChurnStart(); break;
+        default: break;
+    }
+}
+
+/* One slice of foreground work between and while waiting for events */
+static void Lat_LoadStep(Latency_Load load) {
+    switch (load) {
+        case LATENCY_LOAD_FLASH:
+            Lat_FlashStep();
+            break;
+        case LATENCY_LOAD_UART_TX:
+            if (UART_GetTxFree() >= sizeof(filler) - 1) {
+                UART_WriteAsync((const uint8_t*)filler, sizeof(filler) - 1);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void Lat_LoadStop(Latency_Load load) {
+    switch (load) {
+        case LATENCY_LOAD_FLASH:   Lat_FlashStop(); break;
+        case LATENCY_LOAD_CHURN:   Lat_ChurnStop(); break;
+        case LATENCY_LOAD_UART_TX: while (!UART_IsTxIdle()); break;
+        default: break;
+    }
+}
+
+static void Lat_Wait(Latency_Load load, uint32_t cycles) {
+    uint32_t start = DWT->CYCCNT;
+    while ((DWT->CYCCNT - start) < cycles) {
+        Lat_LoadStep(load);
+    }
+}
+
+static void Lat_Setup(void) {
+    if (lat_ready) {
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* Below every event handler, so a wakeup is never a preemption */
+    NVIC_SetPriority(PendSV_IRQn, (1UL << __NVIC_PRIO_BITS) - 1UL);
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    TIM2->CR1 = 0;
+    TIM2->PSC = 0;
+    TIM2->ARR = 0xFFFFFFFFUL;
+    TIM2->DIER = 0;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM2->CR1 = TIM_CR1_CEN;
+    NVIC_EnableIRQ(TIM2_IRQn);
+
+    EXTI->PR = LAT_EXTI_BIT;
+    EXTI->IMR |= LAT_EXTI_BIT;
+    NVIC_EnableIRQ(EXTI1_IRQn);
+
+    UART_SetRxCallback(Lat_UartRx);
+    rx_delay = Lat_CalibrateRx();
+
+    lat_ready = true;
+}
+
+static void Lat_Teardown(void) {
+    TIM2->CR1 = 0;
+    TIM2->DIER = 0;
+    NVIC_DisableIRQ(TIM2_IRQn);
+    EXTI->IMR &= ~LAT_EXTI_BIT;
+    NVIC_DisableIRQ(EXTI1_IRQn);
+    UART_SetRxCallback(NULL);
+    lat_ready = false;
+}
+
+void Latency_DefaultConfig(Latency_Config* config) {
+    config->samples = LATENCY_DEFAULT_SAMPLES;
+    config->eventMask = (1U << LATENCY_EVENT_COUNT) - 1U;
+    config->loadMask = (1U << LATENCY_LOAD_COUNT) - 1U;
+}
+
+int32_t Latency_RunCase(Latency_Event event, Latency_Load load, uint16_t samples,
+                        Latency_Hist* entry, Latency_Hist* wakeup) {
+    uint8_t scratch[16];
+    int32_t missed = 0;
+
+    Lat_Setup();
+
+    /* The UART load's own bytes would come back through the loopback too */
+    if (event == LATENCY_EVENT_UART_RX &&
+        (rx_delay == LAT_NO_LOOPBACK || load == LATENCY_LOAD_UART_TX)) {
+        return -1;
+    }
+
+    Latency_HistReset(entry);
+    Latency_HistReset(wakeup);
+
+    if (event == LATENCY_EVENT_UART_RX) {
+        UART_StartReceiveIT();
+    } else {
+        UART_StopReceiveIT();
+    }
+    lat_event = (uint8_t)event;
+    Lat_LoadStart(load);
+
+    for (uint16_t i = 0; i < samples; i++) {
+        uint32_t gap = LAT_MIN_GAP + Lat_Random() % LAT_GAP_SPREAD;
+        uint32_t expected;
+
+        switch (event) {
+            case LATENCY_EVENT_TIMER:
+                lat_state = LAT_ARMED;
+                expected = Lat_ArmTimer(gap);
+                break;
+
+            case LATENCY_EVENT_EXTI:
+                Lat_Wait(load, gap);
+                lat_state = LAT_ARMED;
+                expected = DWT->CYCCNT;
+                EXTI->SWIER = LAT_EXTI_BIT;
+                break;
+
+            case LATENCY_EVENT_UART_RX:
+            default:
+                Lat_Wait(load, gap);
+                while (!(USART3->SR & USART_SR_TC));
+                lat_state = LAT_ARMED;
+                /* Same sequence as Lat_CalibrateRx */
+                expected = DWT->CYCCNT;
+                USART3->DR = 0x55;
+                expected += rx_delay;
+                break;
+        }
+
+        uint32_t start = DWT->CYCCNT;
+        while (lat_state != LAT_WOKEN && (DWT->CYCCNT - start) < LAT_TIMEOUT_CYCLES) {
+            Lat_LoadStep(load);
+        }
+
+        if (lat_state == LAT_WOKEN) {
+            int32_t toEntry = (int32_t)(lat_handled - expected);
+            Latency_HistAdd(entry, (toEntry > 0) ? (uint32_t)toEntry : 0U);
+            Latency_HistAdd(wakeup, lat_woken - lat_handled);
+        } else {
+            missed++;
+            TIM2->DIER = 0;
+        }
+        lat_state = LAT_IDLE;
+
+        if (event == LATENCY_EVENT_UART_RX) {
+            while (UART_ReadAsync(scratch, sizeof(scratch)) != 0);
+        }
+    }
+
+    Lat_LoadStop(load);
+    return missed;
+}
+
+/* Report */
+
+static void Lat_Emit(const char* text) {
+    FMT_Print("\r\n" LATENCY_PREFIX "%s\r\n", text);
+}
+
+static void Lat_EmitSummary(Latency_Event event, Latency_Load load, Latency_Stage stage,
+                            int32_t missed, const Latency_Hist* hist) {
+    Latency_Summary s;
+    char line[128];
+
+    Latency_HistSummarize(hist, &s);
+    FMT_Format(line, sizeof(line), " %s,%s,%s,%lu,%ld,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+               event_names[event], load_names[load], stage_names[stage],
+               s.samples, missed, s.min, s.p50, s.p90, s.p99, s.p999, s.max, s.mean);
+    Lat_Emit(line);
+
+    /* Sparse histogram: bin:count for every non-empty bin, continued by
+     * Lat_EmitBins() */
+    FMT_Print("\r\n" LATENCY_PREFIX "-hist %s,%s,%s",
+              event_names[event], load_names[load], stage_names[stage]);
+}
+
+/* Up to LAT_BINS_PER_STEP non-empty bins from *bin on; true when done */
+static bool Lat_EmitBins(const Latency_Hist* hist, uint16_t* bin) {
+    uint8_t printed = 0;
+
+    for (; *bin < LATENCY_HIST_BINS; (*bin)++) {
+        if (hist->bins[*bin] == 0) {
+            continue;
+        }
+        if (printed == LAT_BINS_PER_STEP) {
+            return false;
+        }
+        FMT_Print(" %u:%lu", *bin, hist->bins[*bin]);
+        printed++;
+    }
+    FMT_Print("\r\n");
+    return true;
+}
+
+void Latency_Start(const Latency_Config* config) {
+    char line[128];
+
+    if (config == NULL) {
+        Latency_DefaultConfig(&run_config);
+    } else {
+        run_config = *config;
+    }
+    run_next = 0;
+    run_records = 0;
+    run_phase = LAT_PHASE_CASE;
+
+    run_receiveIT = (USART3->CR1 & USART_CR1_RXNEIE) != 0;
+    Lat_Setup();
+
+    FMT_Format(line, sizeof(line), "-begin %u %u %lu %s", run_config.samples,
+               (rx_delay != LAT_NO_LOOPBACK) ? 1U : 0U,
+               (rx_delay != LAT_NO_LOOPBACK) ? rx_delay : 0UL, LATENCY_BUILD_ID);
+    Lat_Emit(line);
+    FMT_Format(line, sizeof(line), "-header %s", csv_header);
+    Lat_Emit(line);
+}
+
+/* Release the timers and the RX hook, and put the console back */
+static void Lat_Finish(void) {
+    Lat_Teardown();
+    if (run_receiveIT) {
+        UART_StartReceiveIT();
+    } else {
+        UART_StopReceiveIT();
+    }
+    run_phase = LAT_PHASE_DONE;
+}
+
+bool Latency_Step(void) {
+    Latency_Event event = (Latency_Event)(run_next / LATENCY_LOAD_COUNT);
+    Latency_Load load = (Latency_Load)(run_next % LATENCY_LOAD_COUNT);
+    char line[128];
+
+    switch (run_phase) {
+        case LAT_PHASE_CASE:
+            /* Flat index over event x load, loads varying fastest */
+            for (; run_next < LATENCY_EVENT_COUNT * LATENCY_LOAD_COUNT; run_next++) {
+                event = (Latency_Event)(run_next / LATENCY_LOAD_COUNT);
+                load = (Latency_Load)(run_next % LATENCY_LOAD_COUNT);
+                if ((run_config.eventMask & (1U << event)) && (run_config.loadMask & (1U << load))) {
+                    break;
+                }
+            }
+            if (run_next == LATENCY_EVENT_COUNT * LATENCY_LOAD_COUNT) {
+                Lat_Finish();
+                FMT_Format(line, sizeof(line), "-end %lu", run_records);
+                Lat_Emit(line);
+                return false;
+            }
+
+            run_missed = Latency_RunCase(event, load, run_config.samples, &hist_entry, &hist_wakeup);
+            if (run_missed < 0) {
+                FMT_Format(line, sizeof(line), "-skip %s,%s", event_names[event], load_names[load]);
+                Lat_Emit(line);
+                run_next++;
+                return true;
+            }
+            Lat_EmitSummary(event, load, LATENCY_STAGE_ENTRY, run_missed, &hist_entry);
+            run_bin = 0;
+            run_phase = LAT_PHASE_ENTRY_BINS;
+            return true;
+
+        case LAT_PHASE_ENTRY_BINS:
+            if (Lat_EmitBins(&hist_entry, &run_bin)) {
+                Lat_EmitSummary(event, load, LATENCY_STAGE_WAKEUP, run_missed, &hist_wakeup);
+                run_bin = 0;
+                run_phase = LAT_PHASE_WAKEUP_BINS;
+            }
+            return true;
+
+        case LAT_PHASE_WAKEUP_BINS:
+            if (Lat_EmitBins(&hist_wakeup, &run_bin)) {
+                run_records += 2;
+                run_next++;
+                run_phase = LAT_PHASE_CASE;
+            }
+            return true;
+
+        case LAT_PHASE_DONE:
+        default:
+            return false;
+    }
+}
+
+uint32_t Latency_Run(const Latency_Config* config) {
+    Latency_Start(config);
+    do {
+        while (!UART_IsTxIdle());
+    } while (Latency_Step());
+
+    return run_records;
+}
+
+/* One case, or one piece of its histograms, per call. The report is
+ * framed for the host tool. */
+static Shell_Status Lat_Cmd(int argc, char* argv[]) {
+    /* Cases drive the UART themselves, so the console must be quiet */
+    if (!UART_IsTxIdle() || !(USART3->SR & USART_SR_TC)) {
+        return SHELL_MORE;
+    }
+    if (run_phase == LAT_PHASE_DONE) {
+        Latency_Start(NULL);
+        /* Ctrl-C leaves the run unfinished; the next one starts over */
+        Shell_SetAbortHandler(Lat_Finish);
+        return SHELL_MORE;
+    }
+    return Latency_Step() ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("latency", "", "Interrupt latency matrix, see Tools/latency_report.py", Lat_Cmd);
@@ -0,0 +1,346 @@
+/* @lz.c */
+#include "lz.h"
+#include "uart.h"
+#include <string.h>
+
+/* Not loaded and not cleared by the startup code; Lz_Init clears the hash */
+#define LZ_CCM                  __attribute__((section(".ccm_noinit")))
+
+#define LZ_BUFFER_SIZE          (2U << LZ_MAX_WINDOW_BITS)
+#define LZ_HASH_SIZE            (1U << LZ_HASH_BITS)
+
+/* Lz_Process hands out at most this much per Lz_Compress call */
+#define LZ_CHUNK                64
+
+static uint8_t buffer[LZ_BUFFER_SIZE] LZ_CCM;
+static uint16_t head[LZ_HASH_SIZE] LZ_CCM;  /* Low 16 bits of the last position per hash */
+
+/* Stream positions count bytes from Lz_Init: buffer[0] holds base, bytes
+ * before pos are coded (the last `literals` of them not yet handed out),
+ * bytes from pos to fill wait for coding. */
+static uint32_t base;
+static uint32_t pos;
+static uint32_t fill;
+static uint16_t window;
+static uint8_t window_bits;
+static uint8_t literals;
+static bool flushing;
+static bool header_pending;
+
+/* Decoder */
+typedef enum {
+    LZ_DEC_MAGIC,
+    LZ_DEC_BITS,
+    LZ_DEC_TOKEN,
+    LZ_DEC_LITERALS,
+    LZ_DEC_OFFSET,
+    LZ_DEC_LENGTH
+} Lz_DecState;
+
+static uint8_t* dec_out;
+static uint32_t dec_capacity;
+static uint32_t dec_size;
+static uint16_t dec_window;
+static uint16_t dec_count;      /* Literals left */
+static uint16_t dec_offset;
+static uint8_t dec_token;
+static Lz_DecState dec_state;
+static Lz_Error dec_error;
+
+Lz_Error Lz_Init(uint8_t windowBits) {
+    if (windowBits < LZ_MIN_WINDOW_BITS || windowBits > LZ_MAX_WINDOW_BITS) {
+        return LZ_ERROR_PARAM;
+    }
+    /* Stale entries would still code correctly (every match is checked),
+     * but the output would then depend on what ran before */
+    memset(head, 0, sizeof(head));
+    base = 0;
+    pos = 0;
+    fill = 0;
+    window = (uint16_t)(1U << windowBits);
+    window_bits = windowBits;
+    literals = 0;
+    flushing = false;
+    header_pending = true;
+    return LZ_OK;
+}
+
+uint16_t Lz_Write(const uint8_t* data, uint16_t size) {
+    /* Slide the buffer down to the window behind pos; pending literals are
+     * always inside it, as LZ_MAX_LITERALS < the smallest window */
+    if (fill - base + size > LZ_BUFFER_SIZE && pos - base > window) {
+        uint32_t shift = pos - window - base;
+        memmove(buffer, buffer + shift, fill - base - shift);
+        base += shift;
+    }
+
+    uint32_t room = LZ_BUFFER_SIZE - (fill - base);
+    if (size > room) {
+        size = (uint16_t)room;
+    }
+    memcpy(buffer + (fill - base), data, size);
+    fill += size;
+    return size;
+}
+
+static inline uint32_t Lz_Hash(const uint8_t* p) {
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (uint32_t)(v * 2654435761UL) >> (32 - LZ_HASH_BITS);
+}
+
+/* Word compares; the first differing byte is the lowest set byte of the
+ * XOR on this little-endian core */
+static inline uint32_t Lz_MatchLength(const uint8_t* a, const uint8_t* b, uint32_t max) {
+    uint32_t len = 0;
+
+    while (len + 4 <= max) {
+        uint32_t x, y;
+        memcpy(&x, a + len, 4);
+        memcpy(&y, b + len, 4);
+        if (x != y) {
+            return len + ((uint32_t)__builtin_ctz(x ^ y) >> 3);
+        }
+        len += 4;
+    }
+    while (len < max && a[len] == b[len]) {
+        len++;
+    }
+    return len;
+}
+
+/* As many pending literals as fit, oldest first */
+static uint8_t* Lz_EmitLiterals(uint8_t* p, const uint8_t* end) {
+    uint32_t n = literals;
+    uint32_t room = (uint32_t)(end - p);
+
+    if (n == 0 || room < 2) {
+        return p;
+    }
+    if (n > room - 1) {
+        n = room - 1;
+    }
+    *p++ = (uint8_t)(n - 1);
+    memcpy(p, buffer + (pos - literals - base), n);
+    literals -= (uint8_t)n;
+    return p + n;
+}
+
+/* Whether Lz_Write could take another byte */
+static inline bool Lz_CanWrite(void) {
+    return fill - base < LZ_BUFFER_SIZE || pos - base > window;
+}
+
+uint16_t Lz_Compress(uint8_t* out, uint16_t size) {
+    uint8_t* p = out;
+    const uint8_t* end = out + size;
+
+    if (header_pending) {
+        if (size < 2) {
+            return 0;
+        }
+        *p++ = LZ_MAGIC;
+        *p++ = window_bits;
+        header_pending = false;
+    }
+
+    for (;;) {
+        uint32_t pending = fill - pos;
+
+        if (pending < LZ_MAX_MATCH && !flushing && Lz_CanWrite()) {
+            break;
+        }
+        if (pending == 0) {
+            p = Lz_EmitLiterals(p, end);
+            if (literals == 0) {
+                flushing = false;
+            }
+            break;
+        }
+
+        const uint8_t* cur = buffer + (pos - base);
+        uint32_t hash = 0;
+        uint32_t len = 0;
+        uint32_t offset = 0;
+
+        if (pending >= LZ_MIN_MATCH) {
+            hash = Lz_Hash(cur);
+            /* Any 16-bit alias that lands in the window is checked byte
+             * for byte like a real candidate */
+            offset = (uint16_t)(pos - head[hash]);
+            if (offset != 0 && offset <= window && offset <= pos - base) {
+                len = Lz_MatchLength(cur - offset, cur,
+                                     (pending < LZ_MAX_MATCH) ? pending : LZ_MAX_MATCH);
+            }
+        }
+
+        if (len >= LZ_MIN_MATCH) {
+            uint32_t code = len - LZ_MIN_MATCH;
+            uint32_t need = (literals ? 1U + literals : 0U) + ((code >= 7) ? 3U : 2U);
+            if ((uint32_t)(end - p) < need) {
+                p = Lz_EmitLiterals(p, end);
+                break;
+            }
+            p = Lz_EmitLiterals(p, end);
+
+            offset--;
+            *p++ = (uint8_t)(0x80U | (((code >= 7) ? 7U : code) << 4) | (offset >> 8));
+            *p++ = (uint8_t)offset;
+            if (code >= 7) {
+                *p++ = (uint8_t)(code - 7);
+            }
+
+            /* Every position in the match goes into the table, as far as
+             * three bytes are known */
+            uint32_t last = (pending - len >= 2) ? len : pending - 2;
+            for (uint32_t i = 0; i < last; i++) {
+                head[Lz_Hash(cur + i)] = (uint16_t)(pos + i);
+            }
+            pos += len;
+        } else {
+            if (literals == LZ_MAX_LITERALS) {
+                p = Lz_EmitLiterals(p, end);
+                if (literals == LZ_MAX_LITERALS) {
+                    break;
+                }
+            }
+            if (pending >= LZ_MIN_MATCH) {
+                head[hash] = (uint16_t)pos;
+            }
+            literals++;
+            pos++;
+        }
+    }
+
+    return (uint16_t)(p - out);
+}
+
+void Lz_Flush(void) {
+    flushing = true;
+}
+
+bool Lz_IsIdle(void) {
+    return !header_pending && pos == fill && literals == 0;
+}
+
+uint16_t Lz_Process(void) {
+    uint8_t chunk[LZ_CHUNK];
+    uint16_t queued = 0;
+
+    for (;;) {
+        uint16_t room = UART_GetTxFree();
+        if (room > sizeof(chunk)) {
+            room = sizeof(chunk);
+        }
+        uint16_t len = Lz_Compress(chunk, room);
+        if (len == 0) {
+            break;
+        }
+        UART_WriteAsync(chunk, len);
+        queued += len;
+    }
+    return queued;
+}
+
+void Lz_DecodeStart(uint8_t* out, uint32_t capacity) {
+    dec_out = out;
+    dec_capacity = capacity;
+    dec_size = 0;
+    dec_state = LZ_DEC_MAGIC;
+    dec_error = LZ_OK;
+}
+
+/* Front to back, so a match that overlaps its own output repeats it */
+static Lz_Error Lz_Copy(uint32_t len) {
+    if (dec_offset > dec_window || dec_offset > dec_size) {
+        return LZ_ERROR_FORMAT;
+    }
+    if (len > dec_capacity - dec_size) {
+        return LZ_ERROR_OVERFLOW;
+    }
+
+    uint8_t* dst = dec_out + dec_size;
+    const uint8_t* src = dst - dec_offset;
+    if (dec_offset >= len) {
+        memcpy(dst, src, len);
+    } else {
+        for (uint32_t i = 0; i < len; i++) {
+            dst[i] = src[i];
+        }
+    }
+    dec_size += len;
+    return LZ_OK;
+}
+
+Lz_Error Lz_Decode(const uint8_t* data, uint32_t size) {
+    const uint8_t* end = data + size;
+
+    while (data < end && dec_error == LZ_OK) {
+        switch (dec_state) {
+        case LZ_DEC_MAGIC:
+            dec_error = (*data++ == LZ_MAGIC) ? LZ_OK : LZ_ERROR_FORMAT;
+            dec_state = LZ_DEC_BITS;
+            break;
+
+        case LZ_DEC_BITS: {
+            uint8_t bits = *data++;
+            if (bits < LZ_MIN_WINDOW_BITS || bits > 12) {
+                dec_error = LZ_ERROR_FORMAT;
+            }
+            dec_window = (uint16_t)(1U << (bits & 0x0F));
+            dec_state = LZ_DEC_TOKEN;
+            break;
+        }
+
+        case LZ_DEC_TOKEN:
+            dec_token = *data++;
+            if (dec_token < 0x80U) {
+                dec_count = (uint16_t)(dec_token + 1U);
+                dec_state = LZ_DEC_LITERALS;
+            } else {
+                dec_state = LZ_DEC_OFFSET;
+            }
+            break;
+
+        case LZ_DEC_LITERALS: {
+            uint32_t n = (uint32_t)(end - data);
+            if (n > dec_count) {
+                n = dec_count;
+            }
+            if (n > dec_capacity - dec_size) {
+                dec_error = LZ_ERROR_OVERFLOW;
+                break;
+            }
+            memcpy(dec_out + dec_size, data, n);
+            dec_size += n;
+            data += n;
+            dec_count -= (uint16_t)n;
+            if (dec_count == 0) {
+                dec_state = LZ_DEC_TOKEN;
+            }
+            break;
+        }
+
+        case LZ_DEC_OFFSET: {
+            uint32_t code = (dec_token >> 4) & 7U;
+            dec_offset = (uint16_t)((((uint32_t)dec_token & 0x0FU) << 8 | *data++) + 1U);
+            if (code == 7) {
+                dec_state = LZ_DEC_LENGTH;
+            } else {
+                dec_error = Lz_Copy(code + LZ_MIN_MATCH);
+                dec_state = LZ_DEC_TOKEN;
+            }
+            break;
+        }
+
+        case LZ_DEC_LENGTH:
+            dec_error = Lz_Copy(*data++ + 7U + LZ_MIN_MATCH);
+            dec_state = LZ_DEC_TOKEN;
+            break;
+        }
+    }
+    return dec_error;
+}
+
+uint32_t Lz_DecodedSize(void) {
+    return dec_size;
+}
@@ -0,0 +1,136 @@
+/* @lz_bench.c - Cycles and ratio of lz.c on generated telemetry text */
+#include "lz.h"
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+#define LZB_SEED                4242UL
+#define LZB_CORPUS              4096
+#define LZB_PIECE               64      /* Write and compress sizes, as Lz_Process uses */
+#define LZB_MHZ                 180UL   /* Throughput quoted at the F429's top clock */
+
+static char corpus[LZB_CORPUS];
+/* Room for incompressible input, literal runs cut by the pieces */
+static uint8_t packed[LZB_CORPUS + LZB_CORPUS / (LZB_PIECE - 1) + 2 * LZB_PIECE];
+static uint8_t unpacked[LZB_CORPUS];
+
+static uint32_t Lzb_Random(uint32_t* seed, uint32_t range) {
+    *seed = *seed * 1664525UL + 1013904223UL;
+    return (*seed >> 16) % range;
+}
+
+/* Sensor records once a second with a log line now and then, the mix the
+ * uplink carries: repeated keys, slowly changing values, noisy digits */
+static uint32_t Lzb_Corpus(void) {
+    static const char* const events[] = { "wifi: rssi low", "mqtt: publish ok", "adc: dma restart",
+                                          "imu: fifo overrun", "mqtt: publish ok" };
+    uint32_t seed = LZB_SEED;
+    uint32_t len = 0;
+    uint32_t temp = 2350, humidity = 452, pressure = 101325;
+
+    for (uint32_t t = 1000; len + 128 < LZB_CORPUS; t++) {
+        temp += Lzb_Random(&seed, 5) - 2;
+        humidity += Lzb_Random(&seed, 3) - 1;
+        pressure += Lzb_Random(&seed, 7) - 3;
+        len += (uint32_t)FMT_Format(corpus + len, LZB_CORPUS - len,
+                                    "@tel %lu t=%lu.%02lu rh=%lu.%lu p=%lu ax=%ld ay=%ld az=%ld "
+                                    "bat=%lu rssi=-%lu\r\n", t, temp / 100, temp % 100,
+                                    humidity / 10, humidity % 10, pressure,
+                                    (int32_t)Lzb_Random(&seed, 41) - 20,
+                                    (int32_t)Lzb_Random(&seed, 41) - 20,
+                                    16384 + (int32_t)Lzb_Random(&seed, 21) - 10,
+                                    3700 + Lzb_Random(&seed, 4), 55 + Lzb_Random(&seed, 12));
+        if (Lzb_Random(&seed, 8) == 0) {
+            len += (uint32_t)FMT_Format(corpus + len, LZB_CORPUS - len, "I (%lu) %s\r\n", t * 1000,
+                                        events[Lzb_Random(&seed, 5)]);
+        }
+    }
+    return len;
+}
+
+/* Written and handed out a piece at a time, as the TX ring drains */
+static uint32_t Lzb_Compress(uint32_t len) {
+    uint32_t in = 0;
+    uint32_t out = 0;
+
+    for (;;) {
+        if (in < len) {
+            in += Lz_Write((const uint8_t*)corpus + in,
+                           (uint16_t)((len - in < LZB_PIECE) ? len - in : LZB_PIECE));
+            if (in == len) {
+                Lz_Flush();
+            }
+        }
+        uint32_t room = sizeof(packed) - out;
+        uint16_t n = Lz_Compress(packed + out, (uint16_t)((room < LZB_PIECE) ? room : LZB_PIECE));
+        out += n;
+        if ((in == len && n == 0 && Lz_IsIdle()) || room == 0) {
+            return out;
+        }
+    }
+}
+
+static Lz_Error Lzb_Decompress(uint32_t size) {
+    Lz_Error result = LZ_OK;
+
+    Lz_DecodeStart(unpacked, sizeof(unpacked));
+    for (uint32_t at = 0; at < size && result == LZ_OK; at += LZB_PIECE) {
+        result = Lz_Decode(packed + at, (size - at < LZB_PIECE) ? size - at : LZB_PIECE);
+    }
+    return result;
+}
+
+bool Lz_BenchmarkStep(uint32_t step) {
+    static uint32_t len;
+    uint8_t bits = (uint8_t)(LZ_MIN_WINDOW_BITS + 2 * (step - 1));
+
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        len = Lzb_Corpus();
+        FMT_Print("lz: %lu bytes of telemetry text in %u-byte pieces, "
+                  "%lu MHz figures scaled from cycles\r\n", len, LZB_PIECE, LZB_MHZ);
+        FMT_Print("window  bytes  ratio   compress cycles/B  MB/s   decompress cycles/B  MB/s\r\n");
+        return true;
+    }
+    if (bits > LZ_MAX_WINDOW_BITS) {
+        return false;
+    }
+
+    Lz_Init(bits);
+    uint32_t start = DWT->CYCCNT;
+    uint32_t size = Lzb_Compress(len);
+    uint32_t compressCycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    Lz_Error result = Lzb_Decompress(size);
+    uint32_t decompressCycles = DWT->CYCCNT - start;
+    bool ok = result == LZ_OK && Lz_DecodedSize() == len && memcmp(unpacked, corpus, len) == 0;
+
+    uint32_t ratio = (uint32_t)((uint64_t)len * 100U / size);
+    uint32_t cc = (uint32_t)((uint64_t)compressCycles * 100U / len);
+    uint32_t dc = (uint32_t)((uint64_t)decompressCycles * 100U / len);
+    uint32_t cm = (uint32_t)((uint64_t)LZB_MHZ * 100U * len / compressCycles);
+    uint32_t dm = (uint32_t)((uint64_t)LZB_MHZ * 100U * len / decompressCycles);
+    FMT_Print("%6u  %5lu  %lu.%02lu  %10lu.%02lu  %3lu.%02lu  %12lu.%02lu  %3lu.%02lu  %s\r\n",
+              1U << bits, size, ratio / 100, ratio % 100, cc / 100, cc % 100,
+              cm / 100, cm % 100, dc / 100, dc % 100, dm / 100, dm % 100,
+              ok ? "ok" : "MISMATCH");
+    return bits + 2 <= LZ_MAX_WINDOW_BITS;
+}
+
+void Lz_RunBenchmark(void) {
+    for (uint32_t step = 0; Lz_BenchmarkStep(step); step++) {
+        while (UART_GetTxFree() < SHELL_TX_RESERVE);
+    }
+}
+
+/* One window size per call */
+static Shell_Status Lzb_Cmd(int argc, char* argv[]) {
+    return Lz_BenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("lzbench", "", "LZ compression cycles, MB/s at 180 MHz and ratio on telemetry text",
+              Lzb_Cmd);
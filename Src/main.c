@@ -3,54 +3,85 @@
 #include "stm32f4xx.h"
 #include "uart.h"
 #include "systick.h"
-#include <stdio.h>
+#include "stack_monitor.h"
+#include "pbuf.h"
+#include "binlog.h"
+#include "fmt.h"
+#include "retarget.h"
+#include "latency.h"
+#include "trace.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "shell.h"
+#include "i2c.h"
+#include "imu.h"
 
 int main(void)
 {
+    /* Paint the stack and arm its MPU guard before anything else runs */
+    StackMon_Init();
+
     /* Initialize SysTick and UART */
     SysTick_Init();
     UART_Init(115200);
 
+    /* printf/scanf through the UART rings instead of per-character polling */
+    Retarget_Init();
+
+    /* Segment pool shared by the UART, network and storage layers */
+    PBuf_Init();
+
+    /* Deferred binary log, decoded on the host by Tools/binlog_decode.py */
+    BinLog_Init();
+
+    /* Event trace, started with the 'trace' command and converted by
+     * Tools/trace_convert.py */
+    Trace_Init();
+
+    /* DWT event counters, charged to the main loop regions below */
+    uint8_t region_idle, region_shell, region_output;
+    PerfCnt_Init();
+    PerfCnt_AddRegion("idle", &region_idle);
+    PerfCnt_AddRegion("shell", &region_shell);
+    PerfCnt_AddRegion("output", &region_output);
+
     /* Test 1: Basic send functionality */
     UART_SendString("\r\n=== UART Driver Phase 1.2 Demo ===\r\n");
     UART_SendString("UART initialized successfully!\r\n");
 
-    /* Test 2: Printf-style formatting */
-    char buffer[100];
-    sprintf(buffer, "System Clock: %lu Hz\r\n", 16000000UL);
-    UART_SendString(buffer);
+    /* Test 2: Deferred logging - only the ID and the value go out */
+    BINLOG("System Clock: %lu Hz\r\n", 16000000UL);
+    BinLog_Process();
 
-    /* Test 3: Bidirectional test */
-    UART_SendString("\r\nType a character and it will be echoed back: ");
+    /* Commands come from modules through SHELL_COMMAND(), 'help' lists them */
+    UART_SendString("Type 'help' for the commands\r\n");
+    Shell_Init();
 
     while(1)
     {
-        if(UART_IsDataAvailable()) {
-            uint8_t received = UART_ReceiveByte();
+        /* Line editing and command output, never waits on the UART */
+        PerfCnt_Enter(region_shell);
+        bool busy = Shell_Process();
+        PerfCnt_Exit();
 
-            // Echo back with formatting
-            sprintf(buffer, "\r\nYou typed: '%c' (ASCII: %d)\r\n", received, received);
-            UART_SendString(buffer);
+        /* Ship queued log records and trace frames while idle */
+        PerfCnt_Enter(region_output);
+        BinLog_Process();
+        Trace_Process();
+        PerfCnt_Exit();
 
-            // Simple command handling
-            if(received == 'q' || received == 'Q') {
-                UART_SendString("Exiting to Phase 1.3...\r\n");
-                break;
-            }
+        /* A stuck I2C bus raises no interrupts; time its transaction out */
+        I2C_Process();
 
-            UART_SendString("Type another character (or 'q' to quit): ");
-        }
-
-        /* This delay prevents CPU overload while waiting */
-        SysTick_Delay(10);
-    }
+        /* Catch up on an IMU burst skipped while the pbuf pool was empty */
+        Imu_Process();
 
-    /* Move to Phase 1.3 setup */
-    UART_SendString("\r\n=== Ready for Phase 1.3: Simple Task Scheduler ===\r\n");
-
-    while(1) {
-        /* Main loop for Phase 1.3 */
-        SysTick_Delay(100);
+        /* Sleep between polls unless a command is still printing */
+        if(!busy) {
+            PerfCnt_Enter(region_idle);
+            SysTick_Delay(10);
+            PerfCnt_Exit();
+        }
     }
 
     return 0;
@@ -0,0 +1,314 @@
+/* @nn.c */
+#include "nn.h"
+#include "stm32f4xx.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Four int8 values as one word; windows and rows start at any byte, and
+ * the M4 allows unaligned LDR/STR */
+#define NN_WORD(p)              __UNALIGNED_UINT32_READ(p)
+#define NN_ALIGN4(n)            (((n) + 3U) & ~3UL)
+
+#define NN_LUT_SIZE             256
+
+/* Rescale, round to nearest, offset and clamp (the fused activation) */
+static inline int8_t Nn_Requantize(int32_t acc, const Nn_LayerDesc* d) {
+    uint32_t shift = 31U + d->shift;
+    int64_t product = (int64_t)acc * d->multiplier + ((int64_t)1 << (shift - 1U));
+    int32_t value = (int32_t)(product >> shift) + d->outZero;
+
+    if (value < d->actMin) {
+        return d->actMin;
+    }
+    if (value > d->actMax) {
+        return d->actMax;
+    }
+    return (int8_t)value;
+}
+
+/* acc += w . x over n values. SXTB16 sign-extends bytes 0 and 2 into a
+ * halfword pair, and after ROR 8 bytes 1 and 3; SMLAD multiplies both
+ * pairs and adds. The pairing is the same for w and x, so the order of
+ * the products does not matter. */
+static inline int32_t Nn_Dot(const int8_t* x, const int8_t* w, uint32_t n, int32_t acc) {
+    for (uint32_t k = n >> 2; k != 0; k--) {
+        uint32_t xw = NN_WORD(x);
+        uint32_t ww = NN_WORD(w);
+        acc = (int32_t)__SMLAD(__SXTB16(ww), __SXTB16(xw), (uint32_t)acc);
+        acc = (int32_t)__SMLAD(__SXTB16(__ROR(ww, 8)), __SXTB16(__ROR(xw, 8)), (uint32_t)acc);
+        x += 4;
+        w += 4;
+    }
+    for (uint32_t k = n & 3U; k != 0; k--) {
+        acc += (int32_t)*w++ * *x++;
+    }
+    return acc;
+}
+
+/* Two rows against the same x: each input word is loaded and spread once */
+static inline void Nn_Dot2(const int8_t* x, const int8_t* w0, const int8_t* w1, uint32_t n,
+                           int32_t* acc0, int32_t* acc1) {
+    int32_t a0 = *acc0;
+    int32_t a1 = *acc1;
+
+    for (uint32_t k = n >> 2; k != 0; k--) {
+        uint32_t xw = NN_WORD(x);
+        uint32_t x02 = __SXTB16(xw);
+        uint32_t x13 = __SXTB16(__ROR(xw, 8));
+        uint32_t ww = NN_WORD(w0);
+        a0 = (int32_t)__SMLAD(__SXTB16(ww), x02, (uint32_t)a0);
+        a0 = (int32_t)__SMLAD(__SXTB16(__ROR(ww, 8)), x13, (uint32_t)a0);
+        ww = NN_WORD(w1);
+        a1 = (int32_t)__SMLAD(__SXTB16(ww), x02, (uint32_t)a1);
+        a1 = (int32_t)__SMLAD(__SXTB16(__ROR(ww, 8)), x13, (uint32_t)a1);
+        x += 4;
+        w0 += 4;
+        w1 += 4;
+    }
+    for (uint32_t k = n & 3U; k != 0; k--) {
+        a0 += (int32_t)*w0++ * *x;
+        a1 += (int32_t)*w1++ * *x++;
+    }
+    *acc0 = a0;
+    *acc1 = a1;
+}
+
+/* All units of a dense layer, or of one conv position: rows of n weights */
+static void Nn_MatVec(const Nn_Layer* l, const int8_t* x, uint32_t n, int8_t* out) {
+    const Nn_LayerDesc* d = l->desc;
+    const int8_t* w = l->weights;
+    uint16_t units = d->units;
+    uint16_t o = 0;
+
+    for (; o + 1U < units; o += 2) {
+        int32_t acc0 = l->bias[o];
+        int32_t acc1 = l->bias[o + 1U];
+        Nn_Dot2(x, w, w + n, n, &acc0, &acc1);
+        out[o] = Nn_Requantize(acc0, d);
+        out[o + 1U] = Nn_Requantize(acc1, d);
+        w += 2U * n;
+    }
+    if (o < units) {
+        out[o] = Nn_Requantize(Nn_Dot(x, w, n, l->bias[o]), d);
+    }
+}
+
+static void Nn_Conv1d(const Nn_Layer* l, const int8_t* in, int8_t* out) {
+    uint32_t window = (uint32_t)l->desc->kernel * l->inChannels;
+    uint32_t step = (uint32_t)l->desc->stride * l->inChannels;
+
+    for (uint16_t p = 0; p < l->outLength; p++) {
+        Nn_MatVec(l, in, window, out);
+        in += step;
+        out += l->outChannels;
+    }
+}
+
+/* SSUB8 sets the GE flag of each byte where the new value is not below
+ * the maximum so far, SEL takes those bytes */
+static void Nn_MaxPool(const Nn_Layer* l, const int8_t* in, int8_t* out) {
+    uint16_t channels = l->inChannels;
+    uint16_t kernel = l->desc->kernel;
+    uint32_t step = (uint32_t)l->desc->stride * channels;
+
+    for (uint16_t p = 0; p < l->outLength; p++) {
+        uint16_t c = 0;
+        for (; c + 4U <= channels; c += 4) {
+            uint32_t max = NN_WORD(in + c);
+            for (uint16_t k = 1; k < kernel; k++) {
+                uint32_t v = NN_WORD(in + (uint32_t)k * channels + c);
+                (void)__SSUB8(v, max);
+                max = __SEL(v, max);
+            }
+            __UNALIGNED_UINT32_WRITE(out + c, max);
+        }
+        for (; c < channels; c++) {
+            int8_t max = in[c];
+            for (uint16_t k = 1; k < kernel; k++) {
+                int8_t v = in[(uint32_t)k * channels + c];
+                max = (v > max) ? v : max;
+            }
+            out[c] = max;
+        }
+        in += step;
+        out += channels;
+    }
+}
+
+/* Mean of the raw values, rounded half away from zero */
+static void Nn_AvgPool(const Nn_Layer* l, const int8_t* in, int8_t* out) {
+    uint16_t channels = l->inChannels;
+    uint16_t kernel = l->desc->kernel;
+    uint32_t step = (uint32_t)l->desc->stride * channels;
+    int32_t half = kernel / 2;
+
+    for (uint16_t p = 0; p < l->outLength; p++) {
+        for (uint16_t c = 0; c < channels; c++) {
+            int32_t sum = 0;
+            for (uint16_t k = 0; k < kernel; k++) {
+                sum += in[(uint32_t)k * channels + c];
+            }
+            out[c] = (int8_t)(((sum >= 0) ? sum + half : sum - half) / kernel);
+        }
+        in += step;
+        out += channels;
+    }
+}
+
+static void Nn_Lut(const Nn_Layer* l, const int8_t* in, int8_t* out) {
+    const int8_t* table = l->weights;
+    uint32_t count = (uint32_t)l->outLength * l->outChannels;
+
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = table[(uint8_t)(in[i] + 128)];
+    }
+}
+
+/* ---- Loader ---- */
+
+static bool Nn_InBlob(uint32_t offset, uint64_t bytes, uint32_t size) {
+    return offset <= size && bytes <= size - offset;
+}
+
+/* Output shape, weights and bias of one layer; false if the record does
+ * not fit its input or the blob */
+static bool Nn_PlanLayer(Nn_Layer* l, const uint8_t* base, uint32_t size) {
+    const Nn_LayerDesc* d = l->desc;
+    uint32_t window = (uint32_t)l->inLength * l->inChannels;
+
+    l->macs = 0;
+    switch (d->type) {
+    case NN_LAYER_DENSE:
+        l->outLength = 1;
+        l->outChannels = d->units;
+        break;
+    case NN_LAYER_CONV1D:
+    case NN_LAYER_MAXPOOL:
+    case NN_LAYER_AVGPOOL:
+        if (d->kernel == 0 || d->stride == 0 || d->kernel > l->inLength) {
+            return false;
+        }
+        l->outLength = (uint16_t)((l->inLength - d->kernel) / d->stride + 1U);
+        l->outChannels = (d->type == NN_LAYER_CONV1D) ? d->units : l->inChannels;
+        window = (uint32_t)d->kernel * l->inChannels;
+        break;
+    case NN_LAYER_LUT:
+        if (!Nn_InBlob(d->weights, NN_LUT_SIZE, size)) {
+            return false;
+        }
+        l->outLength = l->inLength;
+        l->outChannels = l->inChannels;
+        l->weights = (const int8_t*)(base + d->weights);
+        return true;
+    default:
+        return false;
+    }
+
+    if (d->type == NN_LAYER_DENSE || d->type == NN_LAYER_CONV1D) {
+        if (d->units == 0 || d->multiplier <= 0 || d->shift > 31U || d->actMin > d->actMax ||
+            !Nn_InBlob(d->weights, (uint64_t)d->units * window, size) || (d->bias & 3U) != 0 ||
+            !Nn_InBlob(d->bias, 4ULL * d->units, size)) {
+            return false;
+        }
+        l->weights = (const int8_t*)(base + d->weights);
+        l->bias = (const int32_t*)(const void*)(base + d->bias);
+        l->macs = (uint32_t)l->outLength * d->units * window;
+    }
+    return true;
+}
+
+Nn_Error Nn_Load(Nn_Model* model, const void* blob, uint32_t size, int8_t* arena,
+                 uint32_t arenaSize) {
+    const Nn_ModelHeader* header = blob;
+
+    if (model == NULL || blob == NULL || arena == NULL || ((uintptr_t)blob & 3U) != 0 ||
+        ((uintptr_t)arena & 3U) != 0) {
+        return NN_ERROR_PARAM;
+    }
+    if (size < sizeof(Nn_ModelHeader) || header->magic != NN_MAGIC ||
+        header->version != NN_VERSION || header->size != size || header->layerCount == 0 ||
+        header->layerCount > NN_MAX_LAYERS || header->inputLength == 0 ||
+        header->inputChannels == 0 ||
+        !Nn_InBlob(sizeof(Nn_ModelHeader), (uint64_t)header->layerCount * sizeof(Nn_LayerDesc),
+                   size)) {
+        return NN_ERROR_FORMAT;
+    }
+
+    /* Shapes, and the largest input plus output of a layer */
+    const Nn_LayerDesc* desc = (const Nn_LayerDesc*)(header + 1);
+    uint16_t length = header->inputLength;
+    uint16_t channels = header->inputChannels;
+    uint32_t need = 0;
+    for (uint8_t i = 0; i < header->layerCount; i++) {
+        Nn_Layer* l = &model->layer[i];
+        l->desc = &desc[i];
+        l->inLength = length;
+        l->inChannels = channels;
+        if (!Nn_PlanLayer(l, blob, size)) {
+            return NN_ERROR_FORMAT;
+        }
+        uint32_t pair = NN_ALIGN4((uint32_t)length * channels) +
+                        NN_ALIGN4((uint32_t)l->outLength * l->outChannels);
+        need = (pair > need) ? pair : need;
+        length = l->outLength;
+        channels = l->outChannels;
+    }
+    if (need > arenaSize) {
+        return NN_ERROR_ARENA;
+    }
+
+    /* Even layers read from the bottom of the arena and write at the top,
+     * odd layers the other way round */
+    for (uint8_t i = 0; i < header->layerCount; i++) {
+        Nn_Layer* l = &model->layer[i];
+        uint32_t inBytes = NN_ALIGN4((uint32_t)l->inLength * l->inChannels);
+        uint32_t outBytes = NN_ALIGN4((uint32_t)l->outLength * l->outChannels);
+        l->inOffset = (i & 1U) ? need - inBytes : 0;
+        l->outOffset = (i & 1U) ? 0 : need - outBytes;
+    }
+
+    model->header = header;
+    model->layerCount = (uint8_t)header->layerCount;
+    model->arena = arena;
+    model->arenaUsed = need;
+    return NN_OK;
+}
+
+int8_t* Nn_GetInput(const Nn_Model* model) {
+    return model->arena + model->layer[0].inOffset;
+}
+
+const int8_t* Nn_GetOutput(const Nn_Model* model, uint8_t index) {
+    return model->arena + model->layer[index].outOffset;
+}
+
+void Nn_RunLayer(const Nn_Model* model, uint8_t index) {
+    const Nn_Layer* l = &model->layer[index];
+    const int8_t* in = model->arena + l->inOffset;
+    int8_t* out = model->arena + l->outOffset;
+
+    switch (l->desc->type) {
+    case NN_LAYER_DENSE:
+        Nn_MatVec(l, in, (uint32_t)l->inLength * l->inChannels, out);
+        break;
+    case NN_LAYER_CONV1D:
+        Nn_Conv1d(l, in, out);
+        break;
+    case NN_LAYER_MAXPOOL:
+        Nn_MaxPool(l, in, out);
+        break;
+    case NN_LAYER_AVGPOOL:
+        Nn_AvgPool(l, in, out);
+        break;
+    default:
+        Nn_Lut(l, in, out);
+        break;
+    }
+}
+
+const int8_t* Nn_Invoke(const Nn_Model* model) {
+    for (uint8_t i = 0; i < model->layerCount; i++) {
+        Nn_RunLayer(model, i);
+    }
+    return Nn_GetOutput(model, model->layerCount - 1U);
+}
@@ -0,0 +1,110 @@
+/* @nn_bench.c - Cycles per layer and reference records for nn.c */
+#include "nn.h"
+#include "fmt.h"
+#include "uart.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+
+/* The input: a triangle wave per axis plus LCG noise. Tools/nn_ref.py
+ * rebuilds it from the seed in "@nn-begin"; Tools/nn_model.py calibrates
+ * the example model on it. */
+#define NNB_SEED                4242UL
+#define NNB_ARENA_SIZE          1024
+
+static int8_t arena[NNB_ARENA_SIZE] __attribute__((aligned(4)));
+static Nn_Model model;
+
+static void Nnb_MakeInput(int8_t* x, uint16_t length, uint16_t channels) {
+    uint32_t seed = NNB_SEED;
+
+    for (uint16_t i = 0; i < length; i++) {
+        for (uint16_t c = 0; c < channels; c++) {
+            uint32_t phase = (i * (c + 2U)) & 31U;
+            int32_t v = (int32_t)((phase < 16U) ? phase : 32U - phase) * 6 - 48;
+            seed = seed * 1664525UL + 1013904223UL;
+            *x++ = (int8_t)(v + ((int32_t)seed >> 27));
+        }
+    }
+}
+
+/* FNV-1a over the bytes */
+static uint32_t Nnb_Checksum(const void* data, uint32_t bytes) {
+    const uint8_t* p = data;
+    uint32_t hash = 0x811C9DC5UL;
+
+    while (bytes--) {
+        hash = (hash ^ *p++) * 0x01000193UL;
+    }
+    return hash;
+}
+
+bool Nn_BenchmarkStep(uint32_t step) {
+    static const char* const names[] = { "dense", "conv1d", "maxpool", "avgpool", "lut" };
+    const Nn_ModelHeader* header;
+
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        Nn_Error result = Nn_Load(&model, nn_model_accel, nn_model_accel_size, arena,
+                                  sizeof(arena));
+        if (result != NN_OK) {
+            FMT_Print("@nn-error %u\r\n", result);
+            return false;
+        }
+        header = model.header;
+
+        FMT_Print("@nn-begin %lu %08lx %lu %lu\r\n", nn_model_accel_size,
+                  Nnb_Checksum(nn_model_accel, nn_model_accel_size), model.arenaUsed, NNB_SEED);
+        FMT_Print("@nn-header layer,type,length,channels,cycles,checksum\r\n");
+
+        /* Each layer timed on its own, in order, one per step */
+        Nnb_MakeInput(Nn_GetInput(&model), header->inputLength, header->inputChannels);
+        return true;
+    }
+    header = model.header;
+
+    if (step <= model.layerCount) {
+        uint8_t i = (uint8_t)(step - 1);
+        const Nn_Layer* l = &model.layer[i];
+        uint32_t t = DWT->CYCCNT;
+        Nn_RunLayer(&model, i);
+        uint32_t cycles = DWT->CYCCNT - t;
+
+        FMT_Print("@nn %u,%s,%u,%u,%lu,%08lx\r\n", i, names[l->desc->type], l->outLength,
+                  l->outChannels, cycles,
+                  Nnb_Checksum(Nn_GetOutput(&model, i), (uint32_t)l->outLength * l->outChannels));
+        return true;
+    }
+
+    /* The whole model; the input was overwritten by then */
+    Nnb_MakeInput(Nn_GetInput(&model), header->inputLength, header->inputChannels);
+    uint32_t t = DWT->CYCCNT;
+    const int8_t* out = Nn_Invoke(&model);
+    uint32_t cycles = DWT->CYCCNT - t;
+    const Nn_Layer* last = &model.layer[model.layerCount - 1U];
+
+    FMT_Print("@nn-total %lu\r\n@nn-output", cycles);
+    for (uint16_t i = 0; i < last->outLength * last->outChannels; i++) {
+        FMT_Print(" %d", out[i]);
+    }
+    FMT_Print("\r\n@nn-end\r\n");
+    return false;
+}
+
+void Nn_RunBenchmark(void) {
+    uint32_t step = 0;
+    bool more;
+
+    do {
+        more = Nn_BenchmarkStep(step++);
+        while (!UART_IsTxIdle() || !(USART3->SR & USART_SR_TC));
+    } while (more);
+}
+
+/* One layer per call */
+static Shell_Status Nnb_Cmd(int argc, char* argv[]) {
+    return Nn_BenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("nnbench", "", "int8 model cycles per layer and output checksums, for nn_ref.py",
+              Nnb_Cmd);
@@ -0,0 +1,327 @@
+/* @nn_model.c - Generated by Tools/nn_model.py, do not edit */
+#include "nn.h"
+
+/* Input 64 x 3, zero point 0
+ * conv1d 8 x 5 / 1, ReLU   -> 60 x 8
+ * maxpool 2 / 2            -> 30 x 8
+ * conv1d 16 x 3 / 2, ReLU  -> 14 x 16
+ * avgpool 2 / 2            -> 7 x 16
+ * dense 32, ReLU           -> 1 x 32
+ * dense 5                  -> 1 x 5
+ * sigmoid table            -> 1 x 5
+ * 4964 bytes, FNV-1a 6acbdfd3 */
+const uint8_t nn_model_accel[] __attribute__((aligned(4))) = {
+    0x4E, 0x4E, 0x30, 0x31, 0x01, 0x00, 0x07, 0x00, 0x40, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x64, 0x13, 0x00, 0x00, 0x01, 0x80, 0x80, 0x7F, 0x08, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0xE0, 0xB1, 0x36, 0x61, 0x06, 0x00, 0x00, 0x00, 0xD8, 0x00, 0x00, 0x00, 0x50, 0x01, 0x00, 0x00,
+    0x02, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x80, 0x80, 0x7F,
+    0x10, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x42, 0x2C, 0x3E, 0x60, 0x08, 0x00, 0x00, 0x00,
+    0x70, 0x01, 0x00, 0x00, 0xF0, 0x02, 0x00, 0x00, 0x03, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x02, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x7F, 0x20, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x7F, 0xD7, 0x93, 0x57, 0x08, 0x00, 0x00, 0x00, 0x30, 0x03, 0x00, 0x00, 0x30, 0x11, 0x00, 0x00,
+    0x00, 0x00, 0x80, 0x7F, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x5A, 0xBC, 0xF6, 0x5D,
+    0x08, 0x00, 0x00, 0x00, 0xB0, 0x11, 0x00, 0x00, 0x50, 0x12, 0x00, 0x00, 0x04, 0x80, 0x80, 0x7F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x64, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB6, 0x34, 0xBF, 0x58, 0xCD, 0x4C, 0x3E, 0x2C,
+    0x43, 0x79, 0xB1, 0xCB, 0x0F, 0x6D, 0xC3, 0xAD, 0xB3, 0x11, 0xD6, 0xEE, 0x53, 0x12, 0x77, 0xBC,
+    0xE1, 0x75, 0x8D, 0x2E, 0xCF, 0xE5, 0x72, 0x71, 0x19, 0xAA, 0x59, 0x4C, 0x9F, 0x85, 0xA8, 0x5E,
+    0x21, 0xE2, 0x1F, 0x9F, 0x55, 0x10, 0xFA, 0xFE, 0xDC, 0x76, 0x76, 0x2F, 0x24, 0xFD, 0x48, 0xF7,
+    0x70, 0x1E, 0x09, 0x9A, 0x8F, 0x47, 0x9B, 0x25, 0x07, 0x8D, 0x07, 0xC9, 0xB1, 0xE6, 0x60, 0x78,
+    0x19, 0x4F, 0xA4, 0x78, 0x0F, 0x9F, 0xAE, 0xA6, 0x49, 0xFA, 0xA9, 0x8E, 0xFF, 0x14, 0xA0, 0xA6,
+    0xD5, 0xB5, 0x14, 0x3F, 0x99, 0x3B, 0xBB, 0x00, 0x8A, 0x07, 0xC8, 0x06, 0x3F, 0x0E, 0x6A, 0xED,
+    0x5B, 0xFB, 0x52, 0x6C, 0xB1, 0x9D, 0x84, 0x43, 0x76, 0x91, 0xB2, 0x9C, 0xAF, 0x62, 0xE5, 0x33,
+    0xDC, 0xFC, 0xFF, 0xFF, 0xE3, 0xE0, 0xFF, 0xFF, 0x9C, 0x10, 0x00, 0x00, 0xEE, 0xF2, 0xFF, 0xFF,
+    0xFE, 0x0B, 0x00, 0x00, 0x5A, 0xFC, 0xFF, 0xFF, 0x4C, 0x06, 0x00, 0x00, 0xE0, 0xF6, 0xFF, 0xFF,
+    0x10, 0x55, 0xA3, 0x6F, 0x25, 0xF0, 0x0E, 0xA2, 0xFF, 0xB9, 0xBE, 0x42, 0xCF, 0x63, 0xE5, 0x67,
+    0x42, 0x42, 0xD8, 0x1F, 0xA3, 0x42, 0xC4, 0x7E, 0x93, 0x63, 0xAB, 0xA1, 0xBD, 0x6A, 0xC1, 0x82,
+    0x6A, 0xC7, 0x9E, 0xA1, 0xE6, 0xD3, 0xDB, 0xF0, 0xFF, 0xEF, 0x03, 0x76, 0x27, 0x1D, 0x01, 0x98,
+    0xEF, 0x26, 0x64, 0x0E, 0xF1, 0x67, 0x2B, 0xDA, 0x62, 0xC4, 0xEA, 0xD7, 0xCE, 0x7D, 0x84, 0xB5,
+    0xCC, 0xC1, 0xC8, 0x71, 0xA6, 0x53, 0xA1, 0xA4, 0x39, 0x95, 0xBD, 0x38, 0x96, 0xCB, 0xC8, 0x52,
+    0x25, 0x6D, 0xA6, 0x98, 0x4F, 0xD4, 0x4D, 0x0F, 0xEF, 0xAB, 0x1F, 0x36, 0x13, 0xD4, 0xF6, 0x28,
+    0xD1, 0xBD, 0x2F, 0xE4, 0x31, 0x5D, 0x75, 0x01, 0x6F, 0x3A, 0x0E, 0x6B, 0x1E, 0x41, 0xF2, 0x02,
+    0xF0, 0x59, 0xF1, 0x1C, 0x1A, 0xE5, 0xA1, 0x58, 0xAF, 0xAF, 0xED, 0x3C, 0x61, 0xEC, 0x6D, 0x85,
+    0x76, 0x47, 0xEA, 0x37, 0xF4, 0x37, 0xB0, 0xBB, 0x47, 0x00, 0x9B, 0xA8, 0xE8, 0x28, 0xF7, 0x0A,
+    0xBF, 0x41, 0x99, 0x30, 0x51, 0x45, 0xE2, 0x65, 0xFB, 0xFC, 0x7D, 0x1B, 0xB1, 0x19, 0x08, 0x67,
+    0x1B, 0x00, 0x0F, 0xD7, 0x00, 0x76, 0xEF, 0xFB, 0x4D, 0x9C, 0x8F, 0x3B, 0x3D, 0xFC, 0x16, 0xC2,
+    0x64, 0x90, 0xFB, 0x9D, 0x98, 0xF5, 0x10, 0x59, 0x0E, 0x51, 0x78, 0xB9, 0x20, 0x7F, 0xA5, 0x60,
+    0x87, 0x9C, 0xBD, 0x68, 0x0B, 0x05, 0x13, 0x60, 0xED, 0x57, 0x96, 0x23, 0x8D, 0x0C, 0x52, 0x74,
+    0x18, 0xC3, 0x75, 0x60, 0x37, 0x4C, 0x6C, 0xCB, 0x08, 0x02, 0x0F, 0xB1, 0xED, 0x1A, 0xE9, 0xF2,
+    0xE2, 0xE4, 0x13, 0xC0, 0x70, 0x25, 0x42, 0xFA, 0x7B, 0x0F, 0xE2, 0x15, 0x6A, 0x7E, 0x70, 0x5E,
+    0x76, 0x6F, 0x68, 0xA9, 0x19, 0xF2, 0x7F, 0xC6, 0xEF, 0xF7, 0xF6, 0x4F, 0x7F, 0xB8, 0x3B, 0x98,
+    0xBA, 0xB5, 0x36, 0xEB, 0x2C, 0x68, 0xE4, 0x4F, 0x2C, 0x37, 0x29, 0x78, 0x8B, 0x48, 0xFA, 0xB2,
+    0x7C, 0x39, 0x3D, 0xDD, 0xCE, 0xE4, 0x14, 0xCB, 0xAA, 0xAA, 0x64, 0x96, 0x5E, 0xFA, 0xC8, 0xBC,
+    0xFF, 0xFF, 0x4E, 0x27, 0xE0, 0xB6, 0xA6, 0x59, 0x1C, 0xD3, 0xA5, 0x68, 0xCB, 0x38, 0x3E, 0x97,
+    0x8E, 0xDD, 0x5C, 0x96, 0x8B, 0x74, 0x38, 0xCD, 0x05, 0x2D, 0x14, 0x3B, 0x36, 0x57, 0x81, 0xC1,
+    0x09, 0xC7, 0x88, 0xE8, 0xD2, 0x49, 0x7A, 0x84, 0x47, 0x7E, 0x12, 0xB6, 0x28, 0xED, 0x4E, 0x27,
+    0x74, 0x28, 0x35, 0xA0, 0x26, 0x46, 0x40, 0x33, 0xB2, 0x23, 0x46, 0xA9, 0xD9, 0x1A, 0x16, 0xF9,
+    0x8E, 0x26, 0x15, 0xD4, 0xED, 0xB0, 0x94, 0xB3, 0x91, 0x64, 0xB2, 0xE4, 0xC5, 0xDC, 0x01, 0x71,
+    0x59, 0xFD, 0x3B, 0xFC, 0x1C, 0x53, 0xC2, 0xD8, 0x43, 0xC3, 0xBE, 0xFE, 0x3B, 0x5F, 0x03, 0xAD,
+    0x80, 0x75, 0x00, 0x00, 0x43, 0x04, 0xFF, 0xFF, 0xF4, 0xB3, 0xFF, 0xFF, 0xF7, 0xB1, 0xFF, 0xFF,
+    0xBA, 0x23, 0x01, 0x00, 0x84, 0xDE, 0xFF, 0xFF, 0xEB, 0x02, 0x01, 0x00, 0xB3, 0x4B, 0x00, 0x00,
+    0xBA, 0xB8, 0x00, 0x00, 0xBC, 0x38, 0x01, 0x00, 0xF0, 0xFB, 0x00, 0x00, 0x7B, 0x11, 0x00, 0x00,
+    0x19, 0x99, 0xFF, 0xFF, 0x23, 0x73, 0x00, 0x00, 0x8A, 0xC7, 0xFF, 0xFF, 0xFD, 0x3D, 0x00, 0x00,
+    0xCB, 0x54, 0xE3, 0xDF, 0x8C, 0xEA, 0x9A, 0x0C, 0x32, 0xD9, 0xC3, 0x0B, 0x75, 0x19, 0x83, 0x1B,
+    0xE8, 0x6F, 0xFD, 0xCC, 0x77, 0xDE, 0xC3, 0xE4, 0x7E, 0x81, 0x27, 0x78, 0x00, 0x5A, 0x79, 0x30,
+    0xBF, 0x37, 0xA9, 0xB2, 0x3B, 0xAB, 0xE6, 0x92, 0xDB, 0xC4, 0x20, 0x56, 0xC4, 0x0F, 0x96, 0x71,
+    0x23, 0xEE, 0xCC, 0x2B, 0xEE, 0x66, 0x96, 0xEC, 0x5A, 0xF4, 0x12, 0x69, 0x98, 0xF7, 0xBE, 0x86,
+    0x8C, 0xC4, 0x0B, 0x12, 0x90, 0x8B, 0x0A, 0xA1, 0x7D, 0x79, 0x26, 0x1A, 0x88, 0xDB, 0x00, 0xD5,
+    0xA8, 0x2E, 0xD9, 0x58, 0x9B, 0x48, 0x2C, 0x06, 0xC5, 0x23, 0x5F, 0x52, 0x62, 0xE5, 0xA6, 0x56,
+    0xEC, 0x2E, 0x8B, 0xD0, 0x96, 0xD3, 0xAC, 0xE6, 0x3E, 0x7E, 0xA7, 0x44, 0x46, 0xEA, 0x49, 0x5F,
+    0x23, 0xAC, 0x66, 0x00, 0x9E, 0xB6, 0x0D, 0x56, 0x16, 0x1E, 0xE3, 0x3C, 0x37, 0xBE, 0xDB, 0x75,
+    0xFF, 0xBC, 0xB0, 0xF0, 0xFE, 0x21, 0xB8, 0x7F, 0x26, 0xF0, 0xFC, 0x75, 0xA8, 0x81, 0xBC, 0x1C,
+    0xA7, 0xF8, 0xBD, 0xFF, 0xB8, 0x38, 0x07, 0x75, 0x87, 0x8B, 0xF7, 0xE3, 0x11, 0xED, 0xC9, 0xA7,
+    0x49, 0xC9, 0x04, 0xAC, 0x1B, 0x65, 0x5C, 0x00, 0x20, 0x7F, 0xFF, 0x05, 0x7A, 0xB1, 0x6B, 0x0B,
+    0xA8, 0xB8, 0x2B, 0x6B, 0x4F, 0xA8, 0x2B, 0x71, 0x36, 0xA4, 0x79, 0xB6, 0x0F, 0xB3, 0xA5, 0xA9,
+    0xB0, 0xC2, 0x17, 0x71, 0xE5, 0xE6, 0x0C, 0x70, 0xFD, 0x6D, 0x11, 0xFC, 0xAC, 0x69, 0x28, 0x22,
+    0x01, 0xA4, 0xFF, 0x88, 0x6C, 0x37, 0xCD, 0xCC, 0x27, 0x35, 0xCB, 0xD9, 0x73, 0x24, 0x62, 0x27,
+    0x81, 0x2C, 0x7A, 0xDF, 0xF9, 0x3B, 0x7E, 0x4B, 0x72, 0x92, 0x14, 0x1A, 0x54, 0x65, 0x8D, 0x48,
+    0xED, 0x88, 0x8F, 0xD4, 0xBD, 0x66, 0x87, 0x7B, 0x3E, 0xA2, 0xD1, 0x25, 0xA4, 0x28, 0xBD, 0xC4,
+    0x69, 0x9B, 0xC4, 0xCB, 0x95, 0x52, 0xAF, 0x81, 0x17, 0x5B, 0x70, 0xCE, 0xAA, 0x38, 0xF4, 0x5A,
+    0x0F, 0x46, 0x32, 0xFB, 0x95, 0x0E, 0x35, 0xE7, 0x47, 0xDF, 0xF7, 0x24, 0x2E, 0x7B, 0x31, 0x17,
+    0x7D, 0xBC, 0x90, 0x3E, 0x9D, 0x6D, 0xDC, 0x73, 0x67, 0xC7, 0x12, 0x41, 0x0B, 0x47, 0x7F, 0x29,
+    0x6B, 0xD2, 0x46, 0xE1, 0xE8, 0x59, 0xF9, 0xEE, 0xEF, 0x76, 0x28, 0x18, 0xBF, 0xAD, 0x03, 0xAA,
+    0x34, 0x4C, 0x7C, 0x76, 0x9A, 0x20, 0x88, 0xFA, 0xC4, 0x69, 0x68, 0x4B, 0xF8, 0xCD, 0x11, 0x78,
+    0x6B, 0x34, 0x2A, 0x9E, 0x51, 0xC7, 0x38, 0xE0, 0xC9, 0x86, 0xD7, 0xF4, 0x29, 0x23, 0x37, 0xFC,
+    0x69, 0x1F, 0x2A, 0xE2, 0xB6, 0x55, 0x7C, 0x62, 0x71, 0x6A, 0x66, 0x7A, 0x15, 0xD8, 0x51, 0x01,
+    0xDD, 0x89, 0x44, 0x7C, 0x0D, 0x2A, 0x9B, 0x85, 0x4B, 0xBE, 0xFA, 0x5F, 0x64, 0x14, 0x98, 0x7F,
+    0x5B, 0x1B, 0x42, 0x28, 0xC3, 0x49, 0xC1, 0x69, 0x97, 0x84, 0x83, 0x10, 0x2C, 0x4B, 0xAE, 0x6F,
+    0xF1, 0x02, 0xFC, 0xF9, 0xFF, 0xAA, 0x0E, 0x14, 0xD0, 0x66, 0x09, 0xB6, 0x8A, 0x8D, 0xB3, 0x99,
+    0xAE, 0x3B, 0x6D, 0x21, 0x33, 0x8C, 0xA7, 0x43, 0x42, 0x08, 0xBB, 0x04, 0x29, 0xDA, 0x55, 0x64,
+    0x3C, 0xE4, 0xBF, 0xC9, 0xAB, 0xC2, 0xC3, 0x3B, 0x96, 0x56, 0x02, 0x09, 0xDA, 0x6E, 0xDB, 0xA5,
+    0x69, 0x8C, 0x5B, 0xDA, 0x1E, 0x05, 0xC1, 0x98, 0x62, 0xD8, 0x8E, 0xFE, 0x1D, 0x12, 0x3B, 0x73,
+    0xB9, 0x86, 0xFC, 0xD3, 0x3C, 0x41, 0x30, 0x1C, 0xBE, 0xFD, 0x67, 0x1B, 0xB7, 0x6B, 0x26, 0xF1,
+    0xF7, 0x33, 0xBD, 0x94, 0x41, 0xEB, 0xE5, 0x83, 0xCC, 0x6E, 0xFF, 0x5E, 0x3D, 0x4E, 0x19, 0x25,
+    0xC4, 0x57, 0x29, 0x31, 0x81, 0x4B, 0x0C, 0x4D, 0x50, 0x5D, 0x3D, 0x64, 0xA7, 0x0C, 0x6E, 0xC0,
+    0x28, 0x66, 0x4B, 0xC3, 0xFA, 0xCE, 0x30, 0x93, 0x38, 0xD4, 0x95, 0x35, 0xE1, 0xC3, 0x6A, 0xF6,
+    0x1F, 0xD6, 0xBE, 0x33, 0xE8, 0x56, 0x55, 0xD5, 0x35, 0x09, 0x0F, 0x11, 0x56, 0xAE, 0x50, 0x48,
+    0x2E, 0x6F, 0xBF, 0x11, 0x4E, 0x8C, 0x00, 0xCC, 0x43, 0xAA, 0x5C, 0x48, 0x86, 0x76, 0x6F, 0x57,
+    0xEF, 0x98, 0x38, 0x5C, 0x8A, 0x2E, 0x4C, 0x34, 0x3C, 0x2E, 0xE8, 0x02, 0x92, 0x81, 0x30, 0xB3,
+    0xA1, 0xAC, 0xD7, 0x59, 0xE5, 0x5D, 0xF7, 0xA5, 0x6B, 0x24, 0xE4, 0x12, 0xCE, 0x40, 0x2A, 0xAC,
+    0xBD, 0x46, 0x17, 0x61, 0x21, 0xF1, 0x76, 0x5A, 0x18, 0x87, 0x5C, 0xC9, 0x4E, 0x87, 0x32, 0x20,
+    0x7D, 0x92, 0x56, 0xAF, 0x0A, 0xC8, 0xFE, 0x09, 0x17, 0x09, 0x41, 0xC1, 0x7C, 0xD1, 0x66, 0x4D,
+    0x76, 0x9D, 0xE0, 0x2F, 0x08, 0x13, 0x9C, 0xAD, 0x5D, 0x67, 0x7F, 0xB0, 0xA1, 0x9B, 0x41, 0xA1,
+    0x20, 0xA5, 0x02, 0x55, 0xAD, 0xAB, 0x3F, 0x58, 0x8D, 0xB6, 0x09, 0x36, 0x7A, 0xAB, 0xAC, 0x88,
+    0x6C, 0x6C, 0x1B, 0xE4, 0x43, 0x5C, 0xCB, 0x06, 0x88, 0xB4, 0xEB, 0xB1, 0xC5, 0x67, 0x0B, 0x3D,
+    0x4E, 0x82, 0xA7, 0xC5, 0x62, 0x38, 0x28, 0x66, 0xFB, 0x19, 0x58, 0x08, 0xD4, 0x23, 0x4E, 0x9B,
+    0x54, 0x99, 0x54, 0xD3, 0x78, 0xE6, 0x54, 0xB2, 0xF5, 0xE6, 0xBD, 0x7D, 0x1A, 0x6D, 0x02, 0xED,
+    0x2F, 0xD6, 0x11, 0xAD, 0x60, 0xF2, 0x6E, 0x7A, 0x71, 0xB6, 0xCE, 0x81, 0xBC, 0x64, 0x60, 0xBD,
+    0x47, 0x1D, 0x1D, 0x83, 0xEF, 0x20, 0xCC, 0x74, 0xE8, 0x0D, 0x97, 0x78, 0x22, 0x00, 0x5C, 0xA2,
+    0x4D, 0x65, 0x15, 0xEC, 0x84, 0xB5, 0x07, 0x4E, 0xE2, 0xA6, 0x8E, 0x9C, 0x85, 0x6B, 0xB9, 0x14,
+    0xC3, 0x04, 0x0A, 0xAF, 0x97, 0xCD, 0x0C, 0x7F, 0x86, 0xC8, 0x9F, 0xBA, 0x83, 0x49, 0x13, 0x3C,
+    0x97, 0x04, 0x89, 0x98, 0x4D, 0xAB, 0x2E, 0x13, 0x28, 0x93, 0x40, 0x0E, 0xA9, 0x0C, 0xF5, 0xBE,
+    0xA9, 0x6E, 0xB3, 0x46, 0x02, 0x06, 0x32, 0x7F, 0xDA, 0x4F, 0x7F, 0x0F, 0x09, 0x43, 0xE5, 0x92,
+    0x62, 0x9F, 0x46, 0xFA, 0xDF, 0x58, 0x62, 0x6D, 0xFE, 0xBE, 0x10, 0x3D, 0xC5, 0xEC, 0x76, 0xCB,
+    0x3E, 0x91, 0xB4, 0x6A, 0x65, 0x34, 0x9E, 0x8F, 0xD2, 0x6A, 0x62, 0xF6, 0xA3, 0xBF, 0x55, 0x6F,
+    0x64, 0x34, 0x2D, 0x8E, 0x01, 0x90, 0x67, 0x71, 0x05, 0xF9, 0xAC, 0x41, 0x99, 0x85, 0x5E, 0x40,
+    0x2C, 0xB5, 0xB0, 0x73, 0x9A, 0x17, 0xF5, 0x43, 0x41, 0x78, 0xFC, 0xA3, 0x62, 0x61, 0xA7, 0x91,
+    0xB8, 0xD6, 0x1E, 0x06, 0x21, 0x7B, 0x43, 0xAC, 0xC0, 0xAD, 0x49, 0xE9, 0x0A, 0x26, 0x95, 0x14,
+    0x7F, 0x37, 0x49, 0xEB, 0x1F, 0xC3, 0x20, 0x9E, 0xDC, 0x69, 0x82, 0xFF, 0x7F, 0xA1, 0xE7, 0xAA,
+    0xDE, 0xAB, 0x01, 0x46, 0x4C, 0x98, 0x41, 0x1E, 0x99, 0xD6, 0x9E, 0xB7, 0x21, 0xF0, 0xC8, 0x34,
+    0xA9, 0x87, 0x28, 0x91, 0x16, 0x9E, 0x4D, 0x1B, 0x3E, 0xC5, 0xAD, 0xA4, 0x54, 0xCC, 0xE1, 0x61,
+    0xBA, 0xEF, 0xC0, 0x68, 0x38, 0xB8, 0xF0, 0x39, 0xDC, 0x02, 0xE6, 0xE1, 0x0B, 0xDB, 0x67, 0x81,
+    0x81, 0x2A, 0xFB, 0x59, 0x45, 0x63, 0xEC, 0xA6, 0xE5, 0xA3, 0xBA, 0xE4, 0x5F, 0x01, 0x29, 0x51,
+    0x91, 0xEF, 0x4A, 0xB8, 0x3B, 0xFF, 0x24, 0xE5, 0xB9, 0x56, 0xE1, 0x50, 0x18, 0xAF, 0xA6, 0xCF,
+    0x3C, 0xB9, 0x71, 0x69, 0x14, 0x22, 0xB2, 0xA2, 0x34, 0xB3, 0x6C, 0xC2, 0x43, 0x34, 0x15, 0x07,
+    0x11, 0x0F, 0x92, 0xB7, 0x52, 0xE7, 0xF3, 0x7E, 0x43, 0x8A, 0xD3, 0xA3, 0xBD, 0x0B, 0x7C, 0xE6,
+    0x7A, 0xE0, 0x3F, 0x1C, 0x93, 0x3E, 0x99, 0xE3, 0x71, 0x35, 0x08, 0xF6, 0xC7, 0x2E, 0xBD, 0x07,
+    0x47, 0xC6, 0x8D, 0x1A, 0x1D, 0x3C, 0xB9, 0xD2, 0x74, 0xE8, 0x83, 0x2B, 0x94, 0x62, 0xA6, 0x83,
+    0x3D, 0x60, 0x1E, 0x01, 0x72, 0x6D, 0xDD, 0xB3, 0xC5, 0xFF, 0x57, 0xEC, 0xD7, 0x8B, 0x01, 0xC5,
+    0xA8, 0x9D, 0x37, 0xCA, 0xDE, 0x21, 0x14, 0x26, 0x28, 0x51, 0x3C, 0xEF, 0x58, 0xF9, 0xA4, 0x56,
+    0xEA, 0x0D, 0xCA, 0xDC, 0x08, 0xBC, 0x00, 0xD0, 0x40, 0x7C, 0xA6, 0xC4, 0x81, 0xBB, 0x82, 0xAE,
+    0x0B, 0x33, 0x8D, 0xE4, 0x7F, 0x0A, 0xE8, 0x30, 0x1F, 0x38, 0xCF, 0xA7, 0xEA, 0xEB, 0xBA, 0x04,
+    0x49, 0xD1, 0x04, 0xA1, 0x4E, 0x89, 0xC6, 0x6A, 0xD4, 0xA8, 0xC9, 0x51, 0xF5, 0x02, 0xA7, 0x1F,
+    0xAA, 0x3C, 0x93, 0xB8, 0x8A, 0xC0, 0x5B, 0x1C, 0xFD, 0xA5, 0x8E, 0xC3, 0x50, 0x26, 0xF0, 0x25,
+    0x88, 0xA8, 0x8F, 0x7E, 0xE3, 0x88, 0x39, 0x28, 0x57, 0x15, 0x13, 0x1C, 0x8E, 0x79, 0x99, 0x6B,
+    0x25, 0x7D, 0x4F, 0xCC, 0x30, 0x61, 0xD8, 0x8A, 0x4B, 0x34, 0x52, 0x64, 0xB2, 0x6B, 0x11, 0x45,
+    0x38, 0xA2, 0x36, 0xD0, 0x07, 0xBF, 0xA5, 0x22, 0x82, 0xE9, 0x5F, 0x60, 0xC4, 0x0B, 0x46, 0xD8,
+    0x81, 0xD2, 0xCB, 0xD9, 0x45, 0x5D, 0x0F, 0x8C, 0x74, 0x14, 0x75, 0x5F, 0x5D, 0x52, 0xAF, 0xE5,
+    0x4F, 0xE5, 0xC3, 0x2B, 0xA1, 0x8A, 0x9C, 0xE7, 0xF6, 0xDD, 0x09, 0x0E, 0x38, 0x78, 0x61, 0xA0,
+    0x21, 0x28, 0x16, 0xCB, 0x3F, 0x7A, 0xF3, 0xAB, 0xCA, 0x08, 0xD7, 0x40, 0xC2, 0x43, 0x1D, 0x7A,
+    0x26, 0xA9, 0x09, 0x55, 0x3B, 0x98, 0xF2, 0x77, 0x33, 0x40, 0xF4, 0xC8, 0xAB, 0x56, 0x5F, 0xF2,
+    0xD4, 0x84, 0x43, 0xC4, 0x3C, 0xD1, 0xBB, 0xE1, 0x81, 0x6A, 0xDD, 0x43, 0x75, 0x7F, 0x72, 0x6A,
+    0x79, 0x3A, 0xDB, 0x49, 0x02, 0xEC, 0xC2, 0x47, 0xA0, 0xF3, 0x86, 0xE9, 0x04, 0x0B, 0x7B, 0xF1,
+    0xC9, 0xFB, 0x68, 0x18, 0xFA, 0xD0, 0xE1, 0x9F, 0xAF, 0x23, 0x6C, 0x5B, 0x2F, 0x15, 0x8C, 0x14,
+    0x6C, 0xF9, 0x11, 0x37, 0xC8, 0xDD, 0x66, 0x42, 0x87, 0x6B, 0xA7, 0x7A, 0x4F, 0xD5, 0xB3, 0xB2,
+    0x92, 0xB8, 0x9F, 0x50, 0xDD, 0x36, 0x24, 0xC6, 0x52, 0xB4, 0xF2, 0x2E, 0xCE, 0xEE, 0x0A, 0xC8,
+    0x81, 0x5C, 0x89, 0x81, 0x03, 0x16, 0x82, 0xC5, 0x17, 0xB2, 0xC5, 0x3C, 0xB9, 0xC3, 0xC8, 0x41,
+    0x27, 0xFA, 0x08, 0x2A, 0xEE, 0x1B, 0x89, 0xB0, 0x4B, 0x31, 0x5D, 0x15, 0x51, 0xC2, 0x50, 0xC9,
+    0xA4, 0xE9, 0x23, 0xBE, 0xCC, 0x97, 0xF9, 0xA1, 0x62, 0x66, 0xD1, 0xA3, 0x96, 0xB9, 0x40, 0x9B,
+    0xE2, 0x13, 0xC4, 0x95, 0xD7, 0xE5, 0x55, 0x27, 0x5D, 0x41, 0x21, 0x1E, 0xDE, 0x21, 0x86, 0x51,
+    0x21, 0x3F, 0xC3, 0xB9, 0xE2, 0xB3, 0xF5, 0x1B, 0x5E, 0xB9, 0x42, 0xD7, 0x5D, 0x70, 0x67, 0xB3,
+    0x85, 0x6A, 0xFA, 0xB7, 0xEA, 0x54, 0x14, 0x6B, 0x32, 0x20, 0x35, 0x0B, 0xBD, 0x6B, 0x98, 0x8B,
+    0xA9, 0x0E, 0x53, 0x71, 0xA6, 0x10, 0xE3, 0xED, 0xE5, 0x70, 0x11, 0xB4, 0xA8, 0x74, 0x49, 0x6F,
+    0x31, 0x7A, 0xD6, 0xE9, 0x19, 0x77, 0x95, 0x2F, 0x54, 0x9D, 0x15, 0x53, 0x5B, 0xD8, 0x36, 0x98,
+    0x52, 0x1B, 0xBD, 0x18, 0x1E, 0xAB, 0x74, 0x45, 0xB6, 0xE4, 0xBA, 0xC9, 0x36, 0x24, 0xB9, 0xAB,
+    0x6D, 0xD1, 0x84, 0xB8, 0xFD, 0xB4, 0xEB, 0x9A, 0x35, 0x1C, 0xC1, 0x1F, 0x49, 0x71, 0xD5, 0x8D,
+    0x96, 0x3D, 0xF4, 0x16, 0xF4, 0xD2, 0x9C, 0xC3, 0x74, 0x05, 0x41, 0x5B, 0xEA, 0xB6, 0x4C, 0x33,
+    0x26, 0x12, 0x38, 0xE4, 0xD0, 0xC5, 0x6D, 0x48, 0x28, 0x96, 0xBC, 0x4D, 0x3C, 0x15, 0xAC, 0x71,
+    0x50, 0x63, 0xEC, 0x06, 0x76, 0x28, 0x96, 0x7D, 0xA3, 0x52, 0x2A, 0x61, 0xCA, 0x31, 0x5D, 0xCB,
+    0xAB, 0xF4, 0x29, 0x63, 0x74, 0xB6, 0xB5, 0x49, 0x66, 0x94, 0x0D, 0x6E, 0x0D, 0x76, 0xB7, 0x42,
+    0xC4, 0x8B, 0x9C, 0xB6, 0x94, 0xA4, 0xDD, 0xFD, 0xAF, 0xE2, 0x7F, 0x88, 0x02, 0x71, 0x0B, 0x29,
+    0xAE, 0x41, 0x90, 0x5E, 0x6B, 0xE9, 0xA4, 0x1F, 0x0B, 0x38, 0x40, 0xCA, 0xB8, 0x1A, 0xB6, 0xF0,
+    0x95, 0xCC, 0x02, 0x2A, 0xE6, 0x92, 0x33, 0x3F, 0xE6, 0x5E, 0xCD, 0x2E, 0xE0, 0x27, 0x35, 0xF7,
+    0x47, 0xD8, 0xAD, 0x30, 0xDE, 0x12, 0x5B, 0xC3, 0x18, 0x34, 0x66, 0x59, 0x5D, 0x5B, 0x2E, 0x5E,
+    0xCD, 0x4E, 0x1E, 0x98, 0xA5, 0x91, 0x9E, 0xB6, 0x7A, 0x04, 0x26, 0x69, 0xD6, 0xD6, 0x84, 0xD4,
+    0xF2, 0xAC, 0xC2, 0x6C, 0x98, 0x3B, 0x43, 0x9F, 0x71, 0xD1, 0x10, 0xCA, 0x43, 0x67, 0x67, 0x67,
+    0xDA, 0x4D, 0xF5, 0x6B, 0xAE, 0x94, 0x65, 0x47, 0x81, 0xA7, 0x1F, 0x00, 0x7D, 0xD8, 0x61, 0x53,
+    0x8D, 0xC3, 0x15, 0xD7, 0x09, 0xC1, 0x05, 0x92, 0xDE, 0xEA, 0x57, 0x7E, 0xD1, 0x41, 0x6B, 0xD5,
+    0x8C, 0x1B, 0x8F, 0x43, 0x84, 0xE2, 0x17, 0x4B, 0xF7, 0xAA, 0xD3, 0x70, 0x8E, 0x57, 0xFA, 0xF9,
+    0x5C, 0x37, 0xF1, 0x68, 0x44, 0x56, 0x92, 0xF2, 0x0B, 0xEF, 0xD6, 0x8C, 0x95, 0xBE, 0x0D, 0x69,
+    0x1A, 0x1B, 0xF9, 0xF1, 0x4C, 0x16, 0x83, 0x8F, 0xB8, 0x09, 0xDD, 0xE6, 0xE8, 0x55, 0x41, 0x40,
+    0x07, 0x39, 0xA5, 0x4D, 0x03, 0xFE, 0x1B, 0x84, 0x89, 0xE3, 0xAD, 0xBD, 0x3F, 0x89, 0xDE, 0xD8,
+    0x1C, 0xC6, 0x43, 0x7D, 0xCF, 0x1F, 0xC0, 0x56, 0x87, 0x50, 0x61, 0x49, 0x8F, 0xA4, 0xEB, 0x99,
+    0x97, 0x0A, 0x82, 0xE7, 0xA0, 0x12, 0x19, 0x84, 0xCB, 0x5E, 0x7F, 0x8F, 0xA3, 0x20, 0x39, 0xCA,
+    0x8F, 0xAA, 0x82, 0x22, 0x7D, 0x41, 0x26, 0x53, 0x0B, 0xA2, 0x04, 0x30, 0xA8, 0xEF, 0x74, 0x64,
+    0x7E, 0x00, 0xE1, 0xCB, 0x1B, 0x3F, 0x46, 0xA1, 0x2B, 0x8B, 0x74, 0x35, 0xBC, 0xD4, 0x37, 0xDC,
+    0xD5, 0x66, 0xCE, 0x4F, 0x66, 0x13, 0x52, 0xB2, 0xCE, 0xB3, 0xEF, 0xE6, 0x7F, 0xB0, 0x19, 0xF9,
+    0x8D, 0x87, 0x1A, 0xC2, 0x18, 0x88, 0xA2, 0x00, 0xE4, 0x2B, 0x38, 0x93, 0xA5, 0xCD, 0xBB, 0x9E,
+    0xB4, 0xB0, 0x44, 0xA7, 0x41, 0x81, 0x25, 0x0E, 0x3D, 0xCF, 0xCF, 0x6B, 0x82, 0x37, 0xDC, 0xA1,
+    0xFD, 0x1E, 0x8D, 0xC8, 0xDF, 0x41, 0x6E, 0x37, 0x17, 0x92, 0xF9, 0x45, 0x9F, 0x05, 0x67, 0x94,
+    0x54, 0x50, 0x05, 0x00, 0x67, 0xC6, 0xC4, 0x7B, 0xAD, 0xD1, 0xD6, 0x74, 0x45, 0xAA, 0x83, 0x9B,
+    0x69, 0x56, 0x9C, 0x0F, 0x5B, 0x12, 0x33, 0x52, 0xC8, 0xA5, 0x6C, 0x97, 0x10, 0x49, 0xA3, 0x37,
+    0x42, 0x22, 0x34, 0x66, 0xD6, 0x7A, 0x99, 0x7C, 0x52, 0x2D, 0xBA, 0x68, 0x7E, 0x00, 0x98, 0x1A,
+    0xCF, 0xD7, 0xAE, 0xFB, 0x1C, 0xFA, 0xBB, 0xD0, 0xDF, 0xE2, 0xC8, 0x8C, 0x7F, 0x3B, 0x9C, 0xF3,
+    0x71, 0x18, 0xFB, 0x17, 0x2F, 0x83, 0x50, 0x0C, 0x46, 0xE7, 0xB5, 0x64, 0x07, 0x05, 0x69, 0x43,
+    0x93, 0x5B, 0x2D, 0x25, 0x57, 0x49, 0x15, 0xA4, 0x29, 0x58, 0xC8, 0xDA, 0x9A, 0x53, 0x42, 0x29,
+    0x35, 0x36, 0x86, 0x86, 0xB9, 0x1A, 0xDA, 0x97, 0x89, 0x9A, 0x83, 0x36, 0xE0, 0x59, 0x09, 0x32,
+    0x7D, 0xB0, 0x88, 0x5B, 0xE3, 0xA5, 0x95, 0x37, 0x56, 0xAB, 0xAC, 0xEA, 0x31, 0xD9, 0x49, 0x2C,
+    0x47, 0x94, 0x05, 0x5A, 0x5D, 0xD1, 0x6D, 0x00, 0xFD, 0x73, 0x66, 0x64, 0x2B, 0x71, 0x4D, 0xF4,
+    0xB7, 0xBB, 0x31, 0x9D, 0x3B, 0x07, 0xD1, 0x63, 0xFA, 0x12, 0x38, 0xDB, 0x3A, 0xED, 0x29, 0x46,
+    0xC6, 0x60, 0xAE, 0x6F, 0xA9, 0x89, 0x81, 0x9B, 0x67, 0x33, 0x24, 0x24, 0x2F, 0x95, 0xCF, 0x8D,
+    0xD2, 0x70, 0x9F, 0x20, 0x7F, 0xBC, 0xA4, 0x78, 0x8D, 0x59, 0xB3, 0x7E, 0xCD, 0x81, 0x1D, 0xB3,
+    0x31, 0xDA, 0xB8, 0xD2, 0xCF, 0x7A, 0xD4, 0x32, 0x73, 0x30, 0x07, 0x64, 0x57, 0xE1, 0xED, 0xF2,
+    0xC0, 0xDB, 0x4C, 0x4C, 0x74, 0x64, 0x2E, 0x39, 0x6C, 0xDF, 0xE9, 0x5A, 0x26, 0x58, 0x26, 0xA3,
+    0x6F, 0x56, 0x60, 0xC7, 0xA4, 0x2F, 0x66, 0x03, 0xAD, 0x55, 0xDB, 0xC2, 0x32, 0x44, 0xCA, 0x0E,
+    0xD8, 0x1B, 0xB7, 0xC0, 0x81, 0xF6, 0xD2, 0xDD, 0xD7, 0x99, 0x28, 0xA8, 0xA7, 0x10, 0x08, 0x3A,
+    0xC9, 0x3E, 0xE7, 0xC6, 0xA3, 0x88, 0x7C, 0xBE, 0x8A, 0x1D, 0xF3, 0x93, 0x72, 0x84, 0x4B, 0xBF,
+    0xD6, 0x62, 0x63, 0x4B, 0xB1, 0xBA, 0x36, 0x11, 0xF2, 0x0D, 0x45, 0x56, 0xD4, 0x16, 0x4B, 0x92,
+    0xEB, 0x0D, 0x91, 0x78, 0xE9, 0xB7, 0xA1, 0x8A, 0x5E, 0x9D, 0x23, 0xDE, 0xEF, 0x38, 0x1B, 0xD8,
+    0xD9, 0xF7, 0xD5, 0xF4, 0xB5, 0x4E, 0x45, 0xF3, 0xC6, 0x59, 0x98, 0x05, 0x57, 0xAC, 0x3B, 0xB6,
+    0xE8, 0x56, 0xA6, 0xBC, 0x38, 0x43, 0x9F, 0xFF, 0x64, 0x78, 0xC7, 0x60, 0xA2, 0xCD, 0xA7, 0x1F,
+    0x65, 0x34, 0x99, 0xF1, 0xE1, 0xA2, 0x2F, 0x17, 0x3F, 0x2A, 0xFB, 0x0D, 0xFB, 0xE7, 0xE7, 0xA7,
+    0x34, 0xBB, 0x74, 0xA6, 0xF6, 0x09, 0x89, 0x2C, 0xBB, 0xE8, 0xBA, 0x88, 0xAC, 0x82, 0x21, 0x4F,
+    0x60, 0x88, 0x3D, 0xB1, 0x2B, 0xFC, 0x67, 0x84, 0x2D, 0xC5, 0xCF, 0x77, 0xB2, 0xB3, 0x25, 0x59,
+    0xA9, 0xF6, 0x4B, 0x7D, 0x2C, 0x36, 0xB4, 0x90, 0x65, 0xBC, 0x5E, 0x7B, 0x4D, 0x6D, 0x81, 0x15,
+    0x16, 0x76, 0x54, 0xD5, 0x31, 0xF5, 0xA3, 0xB6, 0x44, 0x02, 0xF6, 0x00, 0x90, 0xCE, 0x8C, 0xB4,
+    0x84, 0xD4, 0x7F, 0xBA, 0x89, 0x4E, 0xB9, 0x23, 0x48, 0x55, 0x9A, 0x0F, 0xEF, 0x74, 0x7E, 0x15,
+    0x37, 0x94, 0x74, 0x31, 0x31, 0x7A, 0xDF, 0x9C, 0x1D, 0x4C, 0xD9, 0x1B, 0xCF, 0xC9, 0x78, 0x96,
+    0x67, 0x36, 0x69, 0x0E, 0x5E, 0x29, 0x74, 0x4D, 0x2E, 0xA8, 0xD7, 0xD2, 0x1A, 0x54, 0x98, 0xE5,
+    0xD5, 0x8D, 0x37, 0xCE, 0x0F, 0xCD, 0x5A, 0x99, 0x34, 0xA3, 0x62, 0xEE, 0xCB, 0x0A, 0x09, 0xCE,
+    0x56, 0x0F, 0x65, 0x5C, 0xA0, 0xF1, 0x07, 0xEC, 0xC5, 0x3F, 0x01, 0x03, 0x7E, 0x9D, 0x11, 0x0E,
+    0x67, 0x20, 0x3C, 0xE9, 0x54, 0x82, 0x96, 0x86, 0xE9, 0x9A, 0x02, 0x52, 0x04, 0xCD, 0x23, 0x21,
+    0xBB, 0x68, 0xD4, 0xB9, 0xEA, 0x25, 0xD6, 0x50, 0xA1, 0x39, 0x8B, 0x96, 0xEE, 0xB4, 0xEE, 0x11,
+    0xCA, 0x20, 0x26, 0xF3, 0x2B, 0x83, 0x5B, 0xAC, 0x81, 0x5A, 0xAC, 0xD5, 0x20, 0x1E, 0x6E, 0x47,
+    0x63, 0x5F, 0x1B, 0x71, 0x79, 0x99, 0x8C, 0x41, 0x37, 0x45, 0x6B, 0x32, 0x61, 0xD1, 0xFA, 0x5E,
+    0x3C, 0x72, 0x9B, 0x91, 0x63, 0x0C, 0xB4, 0xCC, 0x23, 0x9D, 0xD7, 0xBA, 0xE8, 0xE1, 0x56, 0xED,
+    0x81, 0x24, 0xA1, 0x03, 0x30, 0x74, 0x14, 0xF6, 0xE1, 0xAB, 0x19, 0x35, 0xF0, 0xFF, 0xC3, 0x5D,
+    0x61, 0x12, 0x46, 0x9C, 0x72, 0xAF, 0xF0, 0x1A, 0xDC, 0xB4, 0x7F, 0xF6, 0x47, 0xCB, 0x0C, 0xB3,
+    0xA7, 0xFB, 0xD4, 0x22, 0x94, 0x31, 0xA0, 0x1D, 0xDE, 0x44, 0x93, 0xAC, 0xDC, 0x20, 0x9A, 0x67,
+    0x40, 0x0E, 0xD6, 0x21, 0x6D, 0x52, 0xA2, 0x3C, 0x9D, 0x82, 0x24, 0x33, 0x50, 0x67, 0x83, 0x2E,
+    0xD1, 0x3D, 0x24, 0xB5, 0xCE, 0x9F, 0xA5, 0xD8, 0x50, 0x7D, 0x5B, 0x5E, 0x87, 0xE6, 0x96, 0xCC,
+    0x44, 0x8A, 0xFC, 0x60, 0x12, 0x2C, 0xA0, 0x4D, 0x39, 0x7E, 0xC9, 0xCF, 0x36, 0x12, 0x73, 0xE5,
+    0x5B, 0x58, 0x06, 0xD6, 0xAD, 0xE1, 0xDC, 0xBC, 0x3D, 0x58, 0x76, 0xC1, 0x77, 0xDB, 0x91, 0xCD,
+    0x3C, 0xBB, 0x6F, 0xCF, 0xBF, 0xCC, 0x07, 0xDE, 0x6A, 0xB5, 0xF5, 0xDB, 0x53, 0xFF, 0x58, 0x56,
+    0x06, 0xCA, 0xF2, 0xD5, 0xA2, 0x6F, 0x42, 0xD3, 0x8F, 0x6B, 0x6F, 0x01, 0x57, 0x5A, 0x29, 0xA1,
+    0x5D, 0xEC, 0xEA, 0x16, 0x7A, 0x13, 0x34, 0xF2, 0xCA, 0xC7, 0xB5, 0x1F, 0x23, 0x34, 0x73, 0xF0,
+    0xF9, 0x2A, 0x64, 0x34, 0xC4, 0x14, 0x17, 0x9A, 0x16, 0xDF, 0x51, 0xFE, 0xF7, 0x93, 0xC0, 0x73,
+    0x3C, 0x7D, 0x2C, 0x12, 0xE8, 0x35, 0xCB, 0x00, 0xDC, 0xE6, 0x97, 0x13, 0x47, 0x8B, 0xC7, 0x18,
+    0xBC, 0x20, 0xDD, 0xAA, 0xCB, 0xEE, 0xE2, 0x02, 0x83, 0x73, 0xB0, 0x4D, 0x49, 0x8B, 0x7B, 0x60,
+    0xD5, 0xDF, 0xF6, 0xD5, 0x57, 0xBC, 0xB4, 0xF3, 0x01, 0xDA, 0xAF, 0xE6, 0x84, 0xB2, 0x1C, 0x27,
+    0x3C, 0x68, 0xE2, 0x23, 0x16, 0x71, 0x6B, 0x70, 0x6C, 0x77, 0xA0, 0x35, 0x63, 0x1A, 0x45, 0x7B,
+    0x88, 0x99, 0x10, 0xA3, 0xB7, 0x85, 0x18, 0x2C, 0x84, 0xFF, 0x95, 0x7A, 0xC3, 0x2C, 0xFF, 0x69,
+    0xCB, 0xD3, 0xFC, 0xBC, 0xA6, 0x64, 0xBF, 0xBF, 0x4C, 0xD2, 0xBB, 0xB1, 0x81, 0xEC, 0xCD, 0xCC,
+    0x19, 0x46, 0x44, 0xF5, 0x9A, 0xC1, 0x68, 0x7C, 0x91, 0x46, 0x64, 0x63, 0x0F, 0x4E, 0xBF, 0x1E,
+    0x1E, 0x46, 0xB6, 0xCA, 0x21, 0xE3, 0x2F, 0x3C, 0x81, 0xFC, 0x1E, 0x73, 0x01, 0x81, 0x83, 0x4B,
+    0xAD, 0x95, 0x60, 0x79, 0x38, 0xF6, 0x55, 0x2D, 0x37, 0x30, 0xBC, 0xEE, 0x9C, 0x43, 0x71, 0x7B,
+    0x4E, 0xB9, 0xA1, 0xD3, 0xD2, 0x5C, 0x50, 0xA7, 0x4D, 0x05, 0x6C, 0xDD, 0x66, 0x2E, 0x9E, 0xE7,
+    0xD0, 0x48, 0x38, 0x0D, 0x6E, 0xFC, 0xD8, 0xF8, 0x6A, 0xD7, 0xC1, 0x16, 0xBC, 0x09, 0xEC, 0xA8,
+    0xD9, 0x39, 0x52, 0x91, 0xA5, 0x92, 0xFB, 0x37, 0xD6, 0x8C, 0xC9, 0x08, 0x58, 0x1A, 0x19, 0x84,
+    0x73, 0x36, 0xA1, 0xC9, 0xBB, 0x01, 0x2B, 0x0E, 0x04, 0xE5, 0x19, 0x8F, 0xE9, 0x72, 0xCD, 0xC2,
+    0xA0, 0xE7, 0x62, 0xF4, 0x2D, 0x9E, 0x4D, 0x94, 0x28, 0xC9, 0xDF, 0xC0, 0x9F, 0x41, 0xB0, 0xF7,
+    0xE7, 0x49, 0x76, 0xF5, 0x43, 0x85, 0xCD, 0x13, 0xC1, 0x9B, 0xF0, 0xBD, 0xBF, 0x24, 0x74, 0xD8,
+    0xE8, 0xF8, 0x6C, 0x1F, 0x9F, 0xE9, 0xA8, 0xDD, 0x2F, 0x85, 0xDC, 0x84, 0x2D, 0x75, 0xE7, 0x0A,
+    0xE5, 0x81, 0x95, 0x0D, 0xCE, 0x5F, 0x81, 0x1C, 0x40, 0xCB, 0xF7, 0xBC, 0x00, 0x9A, 0x04, 0xF0,
+    0x5A, 0xB3, 0x12, 0x69, 0xD6, 0x33, 0xB0, 0xA2, 0xBF, 0x1C, 0x70, 0x88, 0x12, 0x58, 0x02, 0x7C,
+    0x87, 0xEF, 0xE2, 0xC2, 0xC7, 0xB6, 0x4F, 0xB6, 0x06, 0xDE, 0x60, 0x58, 0x8F, 0x21, 0x66, 0x01,
+    0x04, 0x76, 0xF8, 0x5C, 0x4E, 0x8F, 0x4E, 0xE9, 0x8D, 0x82, 0xD3, 0xB5, 0x86, 0x64, 0x0D, 0x00,
+    0x4E, 0xBB, 0x43, 0xFA, 0x3F, 0x09, 0x81, 0xE1, 0x7C, 0xD0, 0xE2, 0x14, 0x77, 0xDC, 0x45, 0xF9,
+    0x57, 0xB2, 0xC6, 0xB7, 0x2A, 0x65, 0xAF, 0x2C, 0x35, 0x3B, 0xBD, 0xA6, 0xE4, 0xE3, 0xD5, 0x3C,
+    0x1B, 0x20, 0xA2, 0xCE, 0xE9, 0x28, 0xA6, 0x0F, 0xED, 0x30, 0xBB, 0x26, 0xE3, 0xC1, 0x12, 0xB8,
+    0x29, 0xEB, 0x29, 0x6E, 0x2F, 0x6F, 0x45, 0x57, 0x34, 0x62, 0x6B, 0xAB, 0xAB, 0xF7, 0xEC, 0xCA,
+    0x37, 0x6B, 0xED, 0x89, 0x1C, 0x39, 0x91, 0x28, 0x8A, 0x21, 0xA8, 0x78, 0x25, 0x99, 0x01, 0x11,
+    0xB1, 0xB9, 0xD2, 0xA6, 0xC8, 0xBD, 0xC4, 0xCD, 0xEC, 0xA4, 0xA0, 0xC9, 0x7D, 0x94, 0xA9, 0x39,
+    0x4C, 0xFF, 0x18, 0xAE, 0xD5, 0xB5, 0x5A, 0x87, 0x67, 0x5B, 0xEE, 0xA7, 0xB1, 0x04, 0x0A, 0xCE,
+    0x8F, 0xC9, 0x74, 0xBC, 0x02, 0xB1, 0x26, 0x62, 0xA4, 0x42, 0xA1, 0xB6, 0x21, 0x81, 0x25, 0x0B,
+    0x6A, 0x54, 0x19, 0xF1, 0xB4, 0x68, 0x5C, 0xFD, 0x7C, 0x2B, 0x53, 0x05, 0x20, 0x73, 0xE8, 0xAA,
+    0xC3, 0xDD, 0xCA, 0x3E, 0x8E, 0x04, 0xA7, 0x60, 0x86, 0x12, 0x37, 0xDF, 0x82, 0x5C, 0x3E, 0xB6,
+    0x05, 0xF4, 0xEA, 0x3A, 0xFC, 0x75, 0x35, 0xCB, 0xA6, 0x6F, 0x25, 0x99, 0x2F, 0x2C, 0x1C, 0x57,
+    0xB2, 0xC8, 0x8E, 0xEF, 0xC3, 0xC0, 0xC8, 0x85, 0xA0, 0x7F, 0xB0, 0x64, 0xAF, 0x93, 0x96, 0xA5,
+    0xF3, 0x7D, 0x8A, 0xA8, 0x95, 0x4F, 0xC8, 0xAA, 0xA6, 0x9B, 0x32, 0x1C, 0xBE, 0x4B, 0xEA, 0x78,
+    0x26, 0x74, 0x82, 0xC5, 0x9B, 0x44, 0x4F, 0x01, 0xE5, 0x85, 0xDD, 0x18, 0xDA, 0x6C, 0x94, 0x36,
+    0x70, 0xA2, 0xFB, 0x8A, 0x0A, 0xC1, 0x3D, 0xC5, 0x1E, 0xB7, 0xCD, 0xFB, 0xD2, 0xBB, 0x5A, 0xA6,
+    0x4C, 0xDC, 0x6A, 0xEC, 0xB2, 0x43, 0x44, 0x7B, 0x2B, 0xB6, 0x14, 0x84, 0x5A, 0xFD, 0x61, 0xBD,
+    0x1B, 0x2A, 0x45, 0x66, 0x8C, 0xE8, 0xFE, 0xBC, 0x98, 0x5F, 0xCE, 0x5A, 0x95, 0x41, 0x38, 0x6E,
+    0xB5, 0x12, 0x0F, 0xC3, 0x4C, 0xC5, 0xF6, 0x0B, 0x2D, 0x38, 0x2F, 0xE3, 0xAA, 0x35, 0xEC, 0x7E,
+    0xF8, 0xEF, 0x70, 0xF5, 0xEF, 0x34, 0xBB, 0xA1, 0x81, 0xC2, 0x92, 0x0E, 0x53, 0x72, 0x14, 0x4F,
+    0x57, 0x3A, 0x3D, 0xDD, 0x4D, 0x25, 0xF3, 0x3F, 0x87, 0xC5, 0x8B, 0x26, 0x69, 0xD2, 0xE6, 0xB5,
+    0x6D, 0xE0, 0x8D, 0x23, 0xA9, 0x6B, 0x67, 0xFD, 0x26, 0xA3, 0xF6, 0xA1, 0x7C, 0xB8, 0x42, 0xBF,
+    0x8B, 0x8E, 0xC5, 0x00, 0x40, 0x11, 0x12, 0x19, 0xBE, 0xA9, 0x09, 0xF0, 0x5A, 0x69, 0xC6, 0x8F,
+    0x46, 0x00, 0xAD, 0x11, 0xD8, 0xA6, 0x38, 0xCA, 0xBE, 0x5C, 0x5F, 0x51, 0xA6, 0x52, 0xDA, 0x26,
+    0x0D, 0x58, 0x7C, 0x27, 0x52, 0x8E, 0x6C, 0x0E, 0x36, 0xC8, 0x0F, 0x9A, 0x63, 0x61, 0xC5, 0x31,
+    0xB3, 0x66, 0xE8, 0x15, 0x3A, 0x52, 0xAA, 0x79, 0x61, 0xD6, 0xB5, 0x0F, 0x89, 0x51, 0xB8, 0xDF,
+    0x00, 0xFB, 0x39, 0x81, 0x55, 0xF2, 0x5E, 0x07, 0x3B, 0x96, 0x87, 0x2E, 0x8F, 0xF8, 0xE2, 0xAE,
+    0x46, 0x3C, 0x57, 0xB6, 0x34, 0x31, 0x7B, 0xEC, 0x0B, 0x93, 0x63, 0x81, 0x02, 0x9C, 0x7C, 0x3C,
+    0xE9, 0xEB, 0xD9, 0x72, 0xBF, 0xE8, 0x88, 0x62, 0xFA, 0x1E, 0xDE, 0x6D, 0x0D, 0x3E, 0xDE, 0x13,
+    0xF6, 0xC0, 0x19, 0xB3, 0xCD, 0x57, 0xAF, 0x7A, 0x9D, 0xA5, 0x57, 0x02, 0x12, 0xED, 0x8A, 0x81,
+    0xB0, 0xB1, 0x3E, 0x8F, 0xAA, 0x70, 0xD0, 0xEF, 0x86, 0xFC, 0x06, 0xCC, 0x30, 0x15, 0x40, 0x5E,
+    0x20, 0x46, 0x51, 0xFC, 0xB0, 0x2D, 0x8D, 0xF0, 0xD9, 0xB4, 0x07, 0xA0, 0xDD, 0xD1, 0x0A, 0xE5,
+    0xA4, 0xE8, 0x4A, 0xA5, 0xD3, 0xDD, 0x5F, 0xF5, 0xD6, 0x63, 0x73, 0x71, 0x6E, 0x37, 0x51, 0x81,
+    0x82, 0x33, 0x25, 0xB6, 0x2F, 0x71, 0xA0, 0x8D, 0x6A, 0xFB, 0x6A, 0x1C, 0xAD, 0xAC, 0xE9, 0x97,
+    0x76, 0x43, 0xE8, 0xB1, 0x9C, 0xD5, 0xA2, 0x2D, 0xC3, 0x18, 0x21, 0x39, 0x63, 0x30, 0x21, 0x61,
+    0x40, 0x04, 0xBF, 0x3A, 0x3C, 0x35, 0xB7, 0x04, 0xDB, 0x4C, 0xFA, 0xEC, 0xEE, 0xB3, 0xD6, 0xB6,
+    0x3A, 0x85, 0x04, 0xE8, 0x0B, 0x54, 0x49, 0xC5, 0x0B, 0x74, 0x8C, 0xB3, 0xCD, 0x60, 0x81, 0xDB,
+    0xE1, 0x45, 0x4F, 0x15, 0x70, 0xDC, 0xE4, 0x7C, 0x9C, 0x08, 0xB8, 0x3A, 0x31, 0xF1, 0x45, 0x56,
+    0x6A, 0x87, 0x8D, 0xAF, 0xCA, 0xAA, 0x4A, 0x5D, 0x52, 0x67, 0xB5, 0x24, 0x8E, 0xFB, 0x05, 0xBC,
+    0x50, 0x9B, 0x07, 0x07, 0x06, 0x20, 0x81, 0x91, 0x01, 0x28, 0x26, 0xE4, 0x2A, 0x43, 0x6E, 0x81,
+    0xE3, 0x36, 0x79, 0xA1, 0x27, 0x79, 0xDF, 0x0B, 0x1D, 0x70, 0x23, 0x84, 0xAE, 0x0A, 0x09, 0xC6,
+    0xA0, 0x26, 0xFF, 0xFF, 0x79, 0x6F, 0x00, 0x00, 0xE3, 0x77, 0x02, 0x00, 0xF3, 0x18, 0x01, 0x00,
+    0xF3, 0xB5, 0x02, 0x00, 0xF7, 0x67, 0x00, 0x00, 0xA7, 0x1D, 0xFF, 0xFF, 0x55, 0xBA, 0x01, 0x00,
+    0x9D, 0x8C, 0xFE, 0xFF, 0x21, 0x48, 0xFE, 0xFF, 0x10, 0xB3, 0x00, 0x00, 0x80, 0xBB, 0xFF, 0xFF,
+    0xF3, 0xB5, 0x00, 0x00, 0x3C, 0x81, 0x00, 0x00, 0xEB, 0xF9, 0x00, 0x00, 0xB3, 0xEB, 0xFD, 0xFF,
+    0xF7, 0x83, 0xFE, 0xFF, 0xA7, 0xBB, 0x01, 0x00, 0x85, 0x4C, 0x00, 0x00, 0x25, 0xB5, 0xFD, 0xFF,
+    0xC8, 0x2C, 0x01, 0x00, 0x12, 0x58, 0x00, 0x00, 0x4A, 0x3F, 0x00, 0x00, 0x4F, 0xF7, 0x01, 0x00,
+    0xA2, 0x7C, 0xFF, 0xFF, 0x0F, 0xF6, 0xFC, 0xFF, 0xE7, 0xC9, 0xFF, 0xFF, 0x7E, 0x0E, 0xFD, 0xFF,
+    0x6F, 0xA2, 0xFF, 0xFF, 0xED, 0x34, 0x00, 0x00, 0x08, 0x0E, 0xFF, 0xFF, 0xBA, 0x4D, 0x00, 0x00,
+    0x39, 0x71, 0xCC, 0x39, 0x7B, 0x0A, 0xB0, 0x44, 0x81, 0x57, 0xB9, 0x47, 0xC9, 0xC3, 0xA3, 0x57,
+    0x1B, 0xB1, 0x5E, 0x78, 0x24, 0xB3, 0xF8, 0x43, 0xCC, 0xB2, 0x76, 0x72, 0xD9, 0xC4, 0xCE, 0x25,
+    0x7E, 0x9B, 0x52, 0x00, 0x06, 0xC5, 0x48, 0x5C, 0xB5, 0x38, 0x78, 0x41, 0x8B, 0xD0, 0xF3, 0xD9,
+    0x89, 0xBA, 0x55, 0x97, 0x93, 0x08, 0x43, 0x3C, 0x32, 0xD3, 0xFA, 0x74, 0xA5, 0xA5, 0x16, 0xC3,
+    0x27, 0x2B, 0xF2, 0xEA, 0x4A, 0x4A, 0x51, 0x07, 0xC8, 0x24, 0x1F, 0x16, 0x3F, 0xB2, 0x86, 0x8F,
+    0x9C, 0xEB, 0xA8, 0x55, 0x40, 0xAC, 0xAD, 0x29, 0x1D, 0xD9, 0x01, 0x4C, 0x53, 0x62, 0xEE, 0x1C,
+    0x12, 0x28, 0xF3, 0xBB, 0xB7, 0xF6, 0x77, 0x24, 0x81, 0xF6, 0xC4, 0x28, 0x4E, 0x6C, 0x67, 0x45,
+    0x28, 0x94, 0x61, 0x51, 0xAB, 0xE5, 0xC3, 0x63, 0x87, 0x2B, 0xA3, 0x76, 0x9E, 0x27, 0x84, 0xB6,
+    0x83, 0xAE, 0x9F, 0x6E, 0x61, 0x7A, 0xAA, 0x06, 0x8D, 0x1E, 0x03, 0x8E, 0x44, 0xD4, 0x66, 0xBB,
+    0x60, 0x19, 0x8B, 0x5E, 0xFA, 0x4E, 0x57, 0xB7, 0x50, 0xC1, 0x7F, 0x22, 0x64, 0xF3, 0xCA, 0x0C,
+    0x6A, 0xA0, 0x00, 0x00, 0x9E, 0xBD, 0xFF, 0xFF, 0x9C, 0x55, 0x00, 0x00, 0x73, 0xFF, 0xFF, 0xFF,
+    0x7D, 0x6A, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+    0x81, 0x81, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x84, 0x84, 0x84, 0x84, 0x85, 0x85, 0x85, 0x86, 0x86, 0x86, 0x87, 0x87, 0x88, 0x88, 0x88, 0x89,
+    0x8A, 0x8A, 0x8B, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x8F, 0x90, 0x91, 0x92, 0x93, 0x95, 0x96, 0x97,
+    0x98, 0x9A, 0x9B, 0x9D, 0x9F, 0xA0, 0xA2, 0xA4, 0xA6, 0xA8, 0xAA, 0xAC, 0xAF, 0xB1, 0xB4, 0xB6,
+    0xB9, 0xBC, 0xBF, 0xC2, 0xC5, 0xC8, 0xCB, 0xCF, 0xD2, 0xD6, 0xD9, 0xDD, 0xE1, 0xE4, 0xE8, 0xEC,
+    0xF0, 0xF4, 0xF8, 0xFC, 0x00, 0x04, 0x08, 0x0C, 0x10, 0x14, 0x18, 0x1C, 0x1F, 0x23, 0x27, 0x2A,
+    0x2E, 0x31, 0x35, 0x38, 0x3B, 0x3E, 0x41, 0x44, 0x47, 0x4A, 0x4C, 0x4F, 0x51, 0x54, 0x56, 0x58,
+    0x5A, 0x5C, 0x5E, 0x60, 0x61, 0x63, 0x65, 0x66, 0x68, 0x69, 0x6A, 0x6B, 0x6D, 0x6E, 0x6F, 0x70,
+    0x71, 0x71, 0x72, 0x73, 0x74, 0x75, 0x75, 0x76, 0x76, 0x77, 0x78, 0x78, 0x78, 0x79, 0x79, 0x7A,
+    0x7A, 0x7A, 0x7B, 0x7B, 0x7B, 0x7C, 0x7C, 0x7C, 0x7C, 0x7D, 0x7D, 0x7D, 0x7D, 0x7D, 0x7E, 0x7E,
+    0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+    0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+    0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+    0x7F, 0x7F, 0x7F, 0x7F,
+};
+
+const uint32_t nn_model_accel_size = sizeof(nn_model_accel);
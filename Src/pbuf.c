@@ -0,0 +1,241 @@
+/* @pbuf.c */
+#include "pbuf.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+static PBuf pool[PBUF_POOL_SIZE];
+static PBuf* free_list = NULL;
+static uint8_t free_count = 0;
+
+void PBuf_Init(void) {
+    free_list = NULL;
+    for (uint8_t i = 0; i < PBUF_POOL_SIZE; i++) {
+        pool[i].next = free_list;
+        pool[i].ref = 0;
+        free_list = &pool[i];
+    }
+    free_count = PBUF_POOL_SIZE;
+}
+
+PBuf* PBuf_Alloc(uint16_t length, uint16_t headroom) {
+    if (headroom >= PBUF_SEGMENT_SIZE ||
+        length > (uint32_t)PBUF_POOL_SIZE * PBUF_SEGMENT_SIZE - headroom) {
+        return NULL;
+    }
+
+    /* Segments needed: the first one loses the headroom */
+    uint16_t first = PBUF_SEGMENT_SIZE - headroom;
+    uint16_t needed = 1;
+    if (length > first) {
+        needed += (length - first + PBUF_SEGMENT_SIZE - 1) / PBUF_SEGMENT_SIZE;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (needed > free_count) {
+        __set_PRIMASK(primask);
+        return NULL;
+    }
+
+    PBuf* head = free_list;
+    PBuf* last = head;
+    for (uint16_t i = 1; i < needed; i++) {
+        last = last->next;
+    }
+    free_list = last->next;
+    free_count -= needed;
+    last->next = NULL;
+
+    __set_PRIMASK(primask);
+
+    /* Segments are private to this caller from here on */
+    uint16_t remaining = length;
+    uint16_t offset = headroom;
+    for (PBuf* p = head; p != NULL; p = p->next) {
+        uint16_t room = PBUF_SEGMENT_SIZE - offset;
+        p->payload = p->data + offset;
+        p->len = (remaining < room) ? remaining : room;
+        p->totLen = remaining;
+        p->ref = 1;
+        remaining -= p->len;
+        offset = 0;
+    }
+
+    return head;
+}
+
+void PBuf_Ref(PBuf* p) {
+    if (p == NULL) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    p->ref++;
+    __set_PRIMASK(primask);
+}
+
+uint8_t PBuf_Free(PBuf* p) {
+    uint8_t freed = 0;
+
+    while (p != NULL) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        if (--p->ref != 0) {
+            /* Still owned by another chain or consumer */
+            __set_PRIMASK(primask);
+            break;
+        }
+
+        PBuf* next = p->next;
+        p->next = free_list;
+        free_list = p;
+        free_count++;
+
+        __set_PRIMASK(primask);
+
+        freed++;
+        p = next;
+    }
+
+    return freed;
+}
+
+PBuf_Error PBuf_Header(PBuf* p, int16_t delta) {
+    if (p == NULL) {
+        return PBUF_ERROR_PARAM;
+    }
+
+    /* Only the head segment changes; with several references the other
+     * holders see the new header too, so prepend before sharing */
+    if (delta > 0) {
+        if (p->payload - p->data < delta) {
+            return PBUF_ERROR_NO_ROOM;
+        }
+    } else if (-delta > p->len) {
+        return PBUF_ERROR_NO_ROOM;
+    }
+
+    p->payload -= delta;
+    p->len += delta;
+    p->totLen += delta;
+
+    return PBUF_OK;
+}
+
+PBuf_Error PBuf_Trim(PBuf* p, uint16_t length) {
+    if (p == NULL || length > p->totLen) {
+        return PBUF_ERROR_PARAM;
+    }
+
+    uint16_t remaining = length;
+    while (remaining > p->len) {
+        p->totLen = remaining;
+        remaining -= p->len;
+        p = p->next;
+    }
+    p->len = remaining;
+    p->totLen = remaining;
+
+    if (p->next != NULL) {
+        PBuf_Free(p->next);
+        p->next = NULL;
+    }
+
+    return PBUF_OK;
+}
+
+PBuf_Error PBuf_Cat(PBuf* head, PBuf* tail) {
+    if (head == NULL || tail == NULL) {
+        return PBUF_ERROR_PARAM;
+    }
+
+    PBuf* p = head;
+    for (; p->next != NULL; p = p->next) {
+        p->totLen += tail->totLen;
+    }
+    p->totLen += tail->totLen;
+    p->next = tail;
+
+    return PBUF_OK;
+}
+
+PBuf_Error PBuf_Chain(PBuf* head, PBuf* tail) {
+    PBuf_Error result = PBuf_Cat(head, tail);
+    if (result == PBUF_OK) {
+        PBuf_Ref(tail);
+    }
+    return result;
+}
+
+uint16_t PBuf_Write(PBuf* p, uint16_t offset, const void* src, uint16_t length) {
+    const uint8_t* in = (const uint8_t*)src;
+    uint16_t done = 0;
+
+    for (; p != NULL && done < length; p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+
+        uint16_t chunk = p->len - offset;
+        if (chunk > length - done) {
+            chunk = length - done;
+        }
+        memcpy(p->payload + offset, in + done, chunk);
+        done += chunk;
+        offset = 0;
+    }
+
+    return done;
+}
+
+uint16_t PBuf_Read(const PBuf* p, uint16_t offset, void* dst, uint16_t length) {
+    uint8_t* out = (uint8_t*)dst;
+    uint16_t done = 0;
+
+    for (; p != NULL && done < length; p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+
+        uint16_t chunk = p->len - offset;
+        if (chunk > length - done) {
+            chunk = length - done;
+        }
+        memcpy(out + done, p->payload + offset, chunk);
+        done += chunk;
+        offset = 0;
+    }
+
+    return done;
+}
+
+void PBuf_IterInit(PBuf_Iterator* it, const PBuf* p) {
+    it->segment = p;
+}
+
+uint8_t PBuf_IterNext(PBuf_Iterator* it, const uint8_t** addr, uint16_t* len) {
+    /* Empty segments (e.g. a fully stripped header) are skipped, a DMA
+     * stream cannot be started with NDTR = 0 */
+    while (it->segment != NULL && it->segment->len == 0) {
+        it->segment = it->segment->next;
+    }
+
+    if (it->segment == NULL) {
+        return 0;
+    }
+
+    *addr = it->segment->payload;
+    *len = it->segment->len;
+    it->segment = it->segment->next;
+
+    return 1;
+}
+
+uint8_t PBuf_GetFreeCount(void) {
+    return free_count;
+}
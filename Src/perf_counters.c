@@ -0,0 +1,421 @@
+/* @perf_counters.c */
+#include "perf_counters.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* TIM6 runs from APB1, which is HCLK at the reset clock setup */
+#define PERF_TIMER_HZ           16000000UL
+
+#define PERF_EVENT_ENABLE       (DWT_CTRL_CPIEVTENA_Msk | DWT_CTRL_EXCEVTENA_Msk | \
+                                 DWT_CTRL_SLEEPEVTENA_Msk | DWT_CTRL_LSUEVTENA_Msk | \
+                                 DWT_CTRL_FOLDEVTENA_Msk)
+
+/* Flash sweep: iterations of the workload, accumulated one by one */
+#define PERF_SWEEP_ITERATIONS   512
+#define PERF_SWEEP_MAX_WS       7
+#define PERF_ACR_ART            (FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN)
+
+typedef struct {
+    const char* name;
+    PerfCnt_Totals totals;
+} PerfCnt_Region;
+
+static PerfCnt_Region regions[PERFCNT_MAX_REGIONS];
+static uint8_t region_count = 0;
+
+/* Region stack; entry 0 is the base and never popped */
+static uint8_t stack[PERFCNT_MAX_DEPTH];
+static uint8_t depth = 1;
+
+/* Counter values at the last fold */
+static uint32_t last_cycles = 0;
+static uint8_t last_events[PERFCNT_EVENT_COUNT];
+
+/* Caller holds interrupts off */
+static void Perf_Fold(void) {
+    uint32_t cycles = DWT->CYCCNT;
+    uint8_t now[PERFCNT_EVENT_COUNT];
+
+    now[PERFCNT_CPI] = (uint8_t)DWT->CPICNT;
+    now[PERFCNT_EXC] = (uint8_t)DWT->EXCCNT;
+    now[PERFCNT_SLEEP] = (uint8_t)DWT->SLEEPCNT;
+    now[PERFCNT_LSU] = (uint8_t)DWT->LSUCNT;
+    now[PERFCNT_FOLD] = (uint8_t)DWT->FOLDCNT;
+
+    PerfCnt_Totals* totals = &regions[stack[depth - 1]].totals;
+    uint32_t elapsed = cycles - last_cycles;
+    totals->cycles += elapsed;
+    for (uint32_t i = 0; i < PERFCNT_EVENT_COUNT; i++) {
+        totals->events[i] += (uint8_t)(now[i] - last_events[i]);
+        last_events[i] = now[i];
+    }
+    if (elapsed >= 256) {
+        totals->wrapRisk++;
+    }
+    last_cycles = cycles;
+}
+
+void PerfCnt_Init(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    memset(regions, 0, sizeof(regions));
+    regions[PERFCNT_REGION_OTHER].name = "other";
+    region_count = 1;
+    stack[0] = PERFCNT_REGION_OTHER;
+    depth = 1;
+
+    /* CYCCNT keeps running for binlog and trace; the event counters
+     * start from zero */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CPICNT = 0;
+    DWT->EXCCNT = 0;
+    DWT->SLEEPCNT = 0;
+    DWT->LSUCNT = 0;
+    DWT->FOLDCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk | PERF_EVENT_ENABLE;
+
+    memset(last_events, 0, sizeof(last_events));
+    last_cycles = DWT->CYCCNT;
+
+    __set_PRIMASK(primask);
+}
+
+PerfCnt_Error PerfCnt_AddRegion(const char* name, uint8_t* id) {
+    if (name == NULL || id == NULL) {
+        return PERFCNT_ERROR_PARAM;
+    }
+    if (region_count == PERFCNT_MAX_REGIONS) {
+        return PERFCNT_ERROR_FULL;
+    }
+
+    regions[region_count].name = name;
+    *id = region_count++;
+    return PERFCNT_OK;
+}
+
+PerfCnt_Error PerfCnt_Enter(uint8_t id) {
+    if (id >= region_count) {
+        return PERFCNT_ERROR_PARAM;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (depth == PERFCNT_MAX_DEPTH) {
+        __set_PRIMASK(primask);
+        return PERFCNT_ERROR_DEPTH;
+    }
+    Perf_Fold();
+    stack[depth++] = id;
+    regions[id].totals.entries++;
+
+    __set_PRIMASK(primask);
+    return PERFCNT_OK;
+}
+
+PerfCnt_Error PerfCnt_Exit(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (depth == 1) {
+        __set_PRIMASK(primask);
+        return PERFCNT_ERROR_DEPTH;
+    }
+    Perf_Fold();
+    depth--;
+
+    __set_PRIMASK(primask);
+    return PERFCNT_OK;
+}
+
+PerfCnt_Error PerfCnt_Switch(uint8_t id) {
+    if (id >= region_count) {
+        return PERFCNT_ERROR_PARAM;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    Perf_Fold();
+    stack[depth - 1] = id;
+    regions[id].totals.entries++;
+
+    __set_PRIMASK(primask);
+    return PERFCNT_OK;
+}
+
+void PerfCnt_Accumulate(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Perf_Fold();
+    __set_PRIMASK(primask);
+}
+
+void TIM6_DAC_IRQHandler(void) {
+    TIM6->SR = ~TIM_SR_UIF;
+    PerfCnt_Accumulate();
+}
+
+PerfCnt_Error PerfCnt_StartPolling(uint32_t hz) {
+    if (hz == 0 || hz > PERFCNT_MAX_POLL_HZ) {
+        return PERFCNT_ERROR_PARAM;
+    }
+
+    /* Smallest prescaler that fits the period into the 16-bit ARR */
+    uint32_t prescaler = (PERF_TIMER_HZ / hz) / 0x10000UL + 1;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM6EN;
+    TIM6->CR1 = 0;
+    TIM6->PSC = prescaler - 1;
+    TIM6->ARR = (PERF_TIMER_HZ / prescaler) / hz - 1;
+    TIM6->CNT = 0;
+    TIM6->EGR = TIM_EGR_UG;
+    TIM6->SR = 0;
+    TIM6->DIER = TIM_DIER_UIE;
+
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+    NVIC_EnableIRQ(TIM6_DAC_IRQn);
+    TIM6->CR1 = TIM_CR1_CEN;
+
+    return PERFCNT_OK;
+}
+
+void PerfCnt_StopPolling(void) {
+    TIM6->CR1 = 0;
+    TIM6->DIER = 0;
+    NVIC_DisableIRQ(TIM6_DAC_IRQn);
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+}
+
+void PerfCnt_Reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    Perf_Fold();
+    for (uint8_t i = 0; i < region_count; i++) {
+        memset(&regions[i].totals, 0, sizeof(regions[i].totals));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+const PerfCnt_Totals* PerfCnt_GetTotals(uint8_t id) {
+    if (id >= region_count) {
+        return NULL;
+    }
+    return &regions[id].totals;
+}
+
+uint64_t PerfCnt_Instructions(const PerfCnt_Totals* totals) {
+    uint64_t stalls = totals->events[PERFCNT_CPI] + totals->events[PERFCNT_EXC] +
+                      totals->events[PERFCNT_SLEEP] + totals->events[PERFCNT_LSU];
+    uint64_t busy = totals->cycles + totals->events[PERFCNT_FOLD];
+
+    return (busy > stalls) ? busy - stalls : 0;
+}
+
+/* FMT_Format has no 64-bit conversions */
+static const char* Perf_U64(char* buf, uint64_t value) {
+    char* p = buf + 20;
+    *p = '\0';
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return p;
+}
+
+/* part / whole in tenths of a percent */
+static uint32_t Perf_Permille(uint64_t part, uint64_t whole) {
+    return (whole == 0) ? 0 : (uint32_t)((part * 1000) / whole);
+}
+
+static void Perf_PrintRow(const char* name, const PerfCnt_Totals* totals) {
+    char line[112];
+    char cycles[21];
+    char instructions[21];
+    uint64_t count = PerfCnt_Instructions(totals);
+    uint32_t pm[PERFCNT_EVENT_COUNT];
+
+    for (uint32_t i = 0; i < PERFCNT_EVENT_COUNT; i++) {
+        pm[i] = Perf_Permille(totals->events[i], totals->cycles);
+    }
+    uint32_t cpi = (count == 0) ? 0 : (uint32_t)((totals->cycles * 100) / count);
+
+    FMT_Format(line, sizeof(line),
+               "%-10s %8lu %14s %14s %2lu.%02lu %3lu.%lu %3lu.%lu %3lu.%lu %3lu.%lu %3lu.%lu%s\r\n",
+               name, totals->entries, Perf_U64(cycles, totals->cycles),
+               Perf_U64(instructions, count), cpi / 100, cpi % 100,
+               pm[PERFCNT_CPI] / 10, pm[PERFCNT_CPI] % 10,
+               pm[PERFCNT_EXC] / 10, pm[PERFCNT_EXC] % 10,
+               pm[PERFCNT_SLEEP] / 10, pm[PERFCNT_SLEEP] % 10,
+               pm[PERFCNT_LSU] / 10, pm[PERFCNT_LSU] % 10,
+               pm[PERFCNT_FOLD] / 10, pm[PERFCNT_FOLD] % 10,
+               (totals->wrapRisk != 0) ? " *" : "");
+    FMT_Print("%s", line);
+}
+
+bool PerfCnt_Report(uint32_t row) {
+    static PerfCnt_Totals sum;
+    static bool risky = false;
+
+    if (row == 0) {
+        PerfCnt_Accumulate();
+        memset(&sum, 0, sizeof(sum));
+        risky = false;
+
+        FMT_Print("\r\nRegion      entries         cycles   instructions   CPI  cpi%%  exc%% "
+                  " slp%%  lsu%% fold%%\r\n");
+        return true;
+    }
+
+    if (row <= region_count) {
+        const PerfCnt_Totals* totals = &regions[row - 1].totals;
+        Perf_PrintRow(regions[row - 1].name, totals);
+
+        sum.cycles += totals->cycles;
+        for (uint32_t e = 0; e < PERFCNT_EVENT_COUNT; e++) {
+            sum.events[e] += totals->events[e];
+        }
+        sum.entries += totals->entries;
+        sum.wrapRisk += totals->wrapRisk;
+        risky |= (totals->wrapRisk != 0);
+        return true;
+    }
+    Perf_PrintRow("total", &sum);
+
+    if (risky) {
+        FMT_Print("* folded after 256+ cycles, stall counts may be low; "
+                  "add regions or PerfCnt_StartPolling()\r\n");
+    }
+    return false;
+}
+
+/* Branchy flash-resident work: table lookups, a data-dependent branch and
+ * a call, so fetch, literal and data accesses all go through the flash */
+static const uint16_t sweep_table[64] = {
+    0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108,
+    0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF, 0x1231,
+    0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6, 0x9339,
+    0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE, 0x2462,
+    0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485, 0xA56A,
+    0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D, 0x3653,
+    0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4, 0xB75B,
+    0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC, 0x48C4
+};
+
+static uint32_t __attribute__((noinline)) Perf_SweepStep(uint32_t state) {
+    uint32_t value = sweep_table[state & 63] ^ (state >> 3);
+    if (value & 1) {
+        value = (value >> 1) ^ 0xA001;
+    } else {
+        value = value * 3 + 7;
+    }
+    return value;
+}
+
+PerfCnt_Error PerfCnt_FlashSweep(uint8_t step) {
+    static const uint32_t art_modes[2] = { PERF_ACR_ART, 0 };
+    static uint32_t base_cycles = 0;
+    uint8_t region;
+    uint32_t saved_acr = FLASH->ACR;
+    volatile uint32_t sink = 0;
+
+    if (step >= PERFCNT_SWEEP_STEPS) {
+        return PERFCNT_ERROR_PARAM;
+    }
+
+    /* The sweep has a region of its own, reused between calls */
+    region = PERFCNT_MAX_REGIONS;
+    for (uint8_t i = 0; i < region_count; i++) {
+        if (regions[i].name != NULL && strcmp(regions[i].name, "flash-sweep") == 0) {
+            region = i;
+        }
+    }
+    if (region == PERFCNT_MAX_REGIONS) {
+        PerfCnt_Error status = PerfCnt_AddRegion("flash-sweep", &region);
+        if (status != PERFCNT_OK) {
+            return status;
+        }
+    }
+
+    if (step == 0) {
+        base_cycles = 0;
+        FMT_Print("\r\nWS  ART  cycles/iter   vs 0WS  cpi%%  wrap\r\n");
+    }
+    uint32_t a = step / (PERF_SWEEP_MAX_WS + 1);
+    uint32_t ws = step % (PERF_SWEEP_MAX_WS + 1);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* Caches are reset while disabled so every mode starts cold */
+    FLASH->ACR = ws;
+    FLASH->ACR = ws | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR = ws | art_modes[a];
+    while ((FLASH->ACR & FLASH_ACR_LATENCY) != ws);
+
+    memset(&regions[region].totals, 0, sizeof(regions[region].totals));
+    PerfCnt_Enter(region);
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < PERF_SWEEP_ITERATIONS; i++) {
+        state = Perf_SweepStep(state);
+        PerfCnt_Accumulate();
+    }
+    PerfCnt_Exit();
+    sink = state;
+
+    FLASH->ACR = saved_acr;
+    __set_PRIMASK(primask);
+
+    const PerfCnt_Totals* totals = &regions[region].totals;
+    uint32_t per_iter = (uint32_t)(totals->cycles / PERF_SWEEP_ITERATIONS);
+    if (base_cycles == 0) {
+        base_cycles = per_iter;
+    }
+    uint32_t pm = Perf_Permille(totals->events[PERFCNT_CPI], totals->cycles);
+    FMT_Print("%2lu  %-3s  %11lu  %3lu.%02lux  %2lu.%lu  %4lu\r\n",
+              ws, (a == 0) ? "on" : "off", per_iter,
+              per_iter / base_cycles, (per_iter * 100 / base_cycles) % 100,
+              pm / 10, pm % 10, totals->wrapRisk);
+    (void)sink;
+    return PERFCNT_OK;
+}
+
+static Shell_Status Perf_Cmd(int argc, char* argv[]) {
+    uint32_t hz;
+
+    if (argc == 1) {
+        /* One region per call, reset once all are printed */
+        if (PerfCnt_Report(Shell_GetStep())) {
+            return SHELL_MORE;
+        }
+        PerfCnt_Reset();
+    } else if (argc == 2 && strcmp(argv[1], "sweep") == 0) {
+        /* One flash configuration per call */
+        uint32_t step = Shell_GetStep();
+        if (PerfCnt_FlashSweep((uint8_t)step) != PERFCNT_OK) {
+            FMT_Print("flash sweep: no free region\r\n");
+            return SHELL_ERROR_FAILED;
+        }
+        if (step + 1 < PERFCNT_SWEEP_STEPS) {
+            return SHELL_MORE;
+        }
+    } else if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        PerfCnt_Reset();
+    } else if (argc == 3 && strcmp(argv[1], "poll") == 0) {
+        if (strcmp(argv[2], "off") == 0) {
+            PerfCnt_StopPolling();
+        } else if (!Shell_ParseU32(argv[2], &hz) || PerfCnt_StartPolling(hz) != PERFCNT_OK) {
+            return SHELL_ERROR_USAGE;
+        }
+    } else {
+        return SHELL_ERROR_USAGE;
+    }
+    return SHELL_OK;
+}
+SHELL_COMMAND("perf", "[sweep|reset|poll <hz|off>]", "Cycles and stalls per region since the last report", Perf_Cmd);
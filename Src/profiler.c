@@ -0,0 +1,220 @@
+/* @profiler.c */
+#include "profiler.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* TIM7 runs from APB1, which is HCLK at the reset clock setup */
+#define PROF_TIMER_HZ           16000000UL
+
+/* Exception frame words: r0-r3, r12, lr, pc, xpsr */
+#define PROF_FRAME_LR           5
+#define PROF_FRAME_PC           6
+
+/* "@prof" lines per Profiler_Dump() step, within the shell's TX reserve */
+#define PROF_DUMP_ROWS          6
+
+static Profiler_Slot slots[PROFILER_SLOTS];
+static volatile uint32_t prof_samples = 0;
+static volatile uint32_t prof_lost = 0;
+static volatile uint16_t prof_used = 0;
+static uint32_t prof_rate = 0;
+static uint32_t prof_period = 0;        /* Timer counts per sample, on average */
+static uint32_t prof_spread = 0;        /* Dither range, a power of two minus one */
+static uint32_t prof_random = 0x6A09E667UL;
+static bool prof_running = false;
+
+/* Called from TIM7_IRQHandler with the stacked exception frame */
+static void __attribute__((used)) Prof_Sample(const uint32_t* frame) {
+    TIM7->SR = ~TIM_SR_UIF;
+
+    uint32_t pc = frame[PROF_FRAME_PC];
+    uint32_t lr = frame[PROF_FRAME_LR];
+    uint32_t index = ((pc ^ (lr << 7)) * 2654435761UL) >> (32 - PROFILER_SLOTS_BITS);
+
+    prof_samples++;
+    for (uint32_t probe = 0; probe < PROFILER_MAX_PROBE; probe++) {
+        Profiler_Slot* slot = &slots[(index + probe) & (PROFILER_SLOTS - 1)];
+        if (slot->count == 0) {
+            slot->pc = pc;
+            slot->lr = lr;
+            slot->count = 1;
+            prof_used++;
+            break;
+        }
+        if (slot->pc == pc && slot->lr == lr) {
+            slot->count++;
+            break;
+        }
+        if (probe == PROFILER_MAX_PROBE - 1) {
+            prof_lost++;
+        }
+    }
+
+    /* Vary the next period so periodic work (SysTick, DMA blocks) is not
+     * always caught at the same phase. ARR is not preloaded, so this
+     * applies to the period that just started. */
+    prof_random ^= prof_random << 13;
+    prof_random ^= prof_random >> 17;
+    prof_random ^= prof_random << 5;
+    TIM7->ARR = prof_period - (prof_spread >> 1) + (prof_random & prof_spread) - 1;
+}
+
+/* Find the frame on whichever stack the interrupted code was using and
+ * tail-call the sampler, which then returns straight from the exception */
+__attribute__((naked)) void TIM7_IRQHandler(void) {
+    __asm volatile (
+        "tst   lr, #4       \n"
+        "ite   eq           \n"
+        "mrseq r0, msp      \n"
+        "mrsne r0, psp      \n"
+        "b     Prof_Sample  \n"
+    );
+}
+
+Profiler_Error Profiler_Start(uint32_t rateHz) {
+    if (rateHz < PROFILER_MIN_HZ || rateHz > PROFILER_MAX_HZ) {
+        return PROFILER_ERROR_PARAM;
+    }
+    if (prof_running) {
+        return PROFILER_ERROR_BUSY;
+    }
+
+    prof_rate = rateHz;
+    prof_period = PROF_TIMER_HZ / rateHz;
+
+    /* Dither by +-1/32 to +-1/16 of the period */
+    prof_spread = 1;
+    while (prof_spread < prof_period / 8) {
+        prof_spread = (prof_spread << 1) | 1;
+    }
+    prof_spread >>= 1;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+    TIM7->CR1 = 0;
+    TIM7->PSC = 0;
+    TIM7->ARR = prof_period - 1;
+    TIM7->CNT = 0;
+    TIM7->EGR = TIM_EGR_UG;
+    TIM7->SR = 0;
+    TIM7->DIER = TIM_DIER_UIE;
+
+    /* Handlers at a lower priority (higher number) are sampled inside;
+     * those left at the reset priority 0 delay the sample to their exit */
+    NVIC_SetPriority(TIM7_IRQn, 0);
+    NVIC_ClearPendingIRQ(TIM7_IRQn);
+    NVIC_EnableIRQ(TIM7_IRQn);
+
+    prof_running = true;
+    TIM7->CR1 = TIM_CR1_CEN;
+
+    return PROFILER_OK;
+}
+
+void Profiler_Stop(void) {
+    TIM7->CR1 = 0;
+    TIM7->DIER = 0;
+    NVIC_DisableIRQ(TIM7_IRQn);
+    NVIC_ClearPendingIRQ(TIM7_IRQn);
+    prof_running = false;
+}
+
+bool Profiler_IsRunning(void) {
+    return prof_running;
+}
+
+void Profiler_Reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    memset(slots, 0, sizeof(slots));
+    prof_samples = 0;
+    prof_lost = 0;
+    prof_used = 0;
+
+    __set_PRIMASK(primask);
+}
+
+void Profiler_GetStats(Profiler_Stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->rateHz = prof_rate;
+    stats->samples = prof_samples;
+    stats->lost = prof_lost;
+    stats->used = prof_used;
+}
+
+bool Profiler_Dump(uint32_t step) {
+    static uint32_t next = 0;
+    static uint16_t printed = 0;
+
+    if (step == 0) {
+        next = 0;
+        printed = 0;
+        FMT_Print("\r\n" PROFILER_PREFIX "-begin %lu %lu %lu %u\r\n",
+                  prof_rate, prof_samples, prof_lost, prof_used);
+        return true;
+    }
+
+    for (uint8_t rows = 0; rows < PROF_DUMP_ROWS && next < PROFILER_SLOTS; next++) {
+        if (slots[next].count == 0) {
+            continue;
+        }
+        FMT_Print(PROFILER_PREFIX " %08lx %08lx %lu\r\n",
+                  slots[next].pc, slots[next].lr, slots[next].count);
+        printed++;
+        rows++;
+    }
+    if (next < PROFILER_SLOTS) {
+        return true;
+    }
+
+    FMT_Print(PROFILER_PREFIX "-end %u\r\n", printed);
+    return false;
+}
+
+static Shell_Status Prof_Cmd(int argc, char* argv[]) {
+    uint32_t rate = PROFILER_DEFAULT_HZ;
+    const char* action;
+
+    /* Only a dump asks to be called again: carry on with it */
+    if (Shell_GetStep() != 0) {
+        return Profiler_Dump(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+    }
+
+    /* Without an argument start, or stop and dump: Tools/profile_report.py
+     * sends the bare command twice */
+    if (argc == 1) {
+        action = prof_running ? "stop" : "start";
+    } else if (argc == 2 || (argc == 3 && Shell_ParseU32(argv[2], &rate))) {
+        action = argv[1];
+    } else {
+        return SHELL_ERROR_USAGE;
+    }
+
+    if (strcmp(action, "start") == 0) {
+        /* Refused starts keep the profile taken so far */
+        if (Profiler_IsRunning()) {
+            FMT_Print("already running\r\n");
+            return SHELL_ERROR_FAILED;
+        }
+        if (rate < PROFILER_MIN_HZ || rate > PROFILER_MAX_HZ) {
+            FMT_Print("rate must be %u-%u Hz\r\n", PROFILER_MIN_HZ, PROFILER_MAX_HZ);
+            return SHELL_ERROR_FAILED;
+        }
+        Profiler_Reset();
+        (void)Profiler_Start(rate);
+    } else if (argc <= 2 && strcmp(action, "stop") == 0) {
+        Profiler_Stop();
+        return Profiler_Dump(0) ? SHELL_MORE : SHELL_OK;
+    } else if (argc == 2 && strcmp(action, "dump") == 0) {
+        return Profiler_Dump(0) ? SHELL_MORE : SHELL_OK;
+    } else {
+        return SHELL_ERROR_USAGE;
+    }
+    return SHELL_OK;
+}
+SHELL_COMMAND("prof", "[start [hz]|stop|dump]", "PC sampling, toggles without an argument", Prof_Cmd);
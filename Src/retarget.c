@@ -0,0 +1,88 @@
+/* @retarget.c - newlib stdio on top of the UART rings */
+#include "retarget.h"
+#include "uart.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <errno.h>
+
+/* stdout line buffer: one printf line = one ring write */
+#define RETARGET_STDOUT_BUFFER  128
+
+volatile uint32_t retarget_dropped = 0;
+
+static char stdout_buffer[RETARGET_STDOUT_BUFFER];
+
+/* stdin, stdout, stderr; stderr defaults to non-blocking so fault
+ * messages can never wedge the system */
+static Retarget_Policy policies[3] = {
+    RETARGET_BLOCKING, RETARGET_BLOCKING, RETARGET_NONBLOCKING
+};
+
+void Retarget_Init(void) {
+    UART_StartReceiveIT();
+
+    setvbuf(stdout, stdout_buffer, _IOLBF, sizeof(stdout_buffer));
+    setvbuf(stderr, NULL, _IONBF, 0);
+    setvbuf(stdin, NULL, _IONBF, 0);
+}
+
+void Retarget_SetPolicy(int fd, Retarget_Policy policy) {
+    if (fd >= 0 && fd <= 2) {
+        policies[fd] = policy;
+    }
+}
+
+/* Waiting for the ISR is impossible with interrupts masked and unsafe
+ * from inside another handler; treat those callers as non-blocking */
+static int Retarget_CanBlock(int fd) {
+    return policies[fd] == RETARGET_BLOCKING && __get_PRIMASK() == 0 && __get_IPSR() == 0;
+}
+
+/* Overrides the weak per-character version in syscalls.c */
+int _write(int file, char *ptr, int len) {
+    if (file != 1 && file != 2) {
+        errno = EBADF;
+        return -1;
+    }
+
+    const uint8_t* data = (const uint8_t*)ptr;
+    int remaining = len;
+    int block = Retarget_CanBlock(file);
+
+    do {
+        uint16_t chunk = (remaining > 0xFFFF) ? 0xFFFF : (uint16_t)remaining;
+        uint16_t sent = UART_WriteAsync(data, chunk);
+        data += sent;
+        remaining -= sent;
+    } while (remaining > 0 && block);
+
+    /* Report the whole buffer as written, stdio would otherwise retry */
+    retarget_dropped += remaining;
+    return len;
+}
+
+/* Overrides the weak per-character version in syscalls.c */
+int _read(int file, char *ptr, int len) {
+    if (file != 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (len <= 0) {
+        return 0;
+    }
+
+    uint16_t want = (len > 0xFFFF) ? 0xFFFF : (uint16_t)len;
+    uint16_t got = UART_ReadAsync((uint8_t*)ptr, want);
+
+    /* Return as soon as anything arrived, like a terminal in raw mode */
+    while (got == 0) {
+        if (!Retarget_CanBlock(file)) {
+            errno = EAGAIN;
+            return -1;
+        }
+        got = UART_ReadAsync((uint8_t*)ptr, want);
+    }
+
+    return got;
+}
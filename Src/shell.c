@@ -0,0 +1,684 @@
+/* @shell.c */
+#include "shell.h"
+#include "uart.h"
+#include "fmt.h"
+#include "systick.h"
+#include "trace.h"
+#include "pbuf.h"
+#include "binlog.h"
+#include "retarget.h"
+#include "stack_monitor.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Escape sequence parser states */
+#define SHELL_ESC_NONE          0
+#define SHELL_ESC_START         1       /* ESC seen */
+#define SHELL_ESC_CSI           2       /* ESC [ seen, waiting for the final byte */
+
+/* Control characters */
+#define SHELL_KEY_CTRL_C        0x03
+#define SHELL_KEY_BACKSPACE     0x08
+#define SHELL_KEY_TAB           0x09
+#define SHELL_KEY_CTRL_U        0x15
+#define SHELL_KEY_ESC           0x1B
+#define SHELL_KEY_DELETE        0x7F
+
+/* Erase the terminal line and redraw the prompt */
+#define SHELL_REDRAW            "\r\033[K" SHELL_PROMPT
+
+/* Bytes per "md" line and lines per handler call */
+#define SHELL_MD_WIDTH          16
+#define SHELL_MD_LINES          2
+#define SHELL_MD_MAX            4096
+
+/* Commands live between these, placed by the linker scripts */
+extern const Shell_Command __start_shell_cmd[];
+extern const Shell_Command __stop_shell_cmd[];
+
+/* Memory "md" may read; everything else can fault or has side effects */
+typedef struct {
+    uint32_t base;
+    uint32_t size;
+} Shell_Region;
+
+static const Shell_Region readable[] = {
+    { 0x08000000UL, 0x00200000UL },     /* Flash */
+    { 0x10000000UL, 0x00010000UL },     /* CCM RAM */
+    { 0x1FFF0000UL, 0x00007800UL },     /* System memory */
+    { 0x1FFF7800UL, 0x0000021CUL },     /* OTP, lock bytes and unique ID */
+    { 0x20000000UL, 0x00030000UL },     /* SRAM1-3 */
+};
+
+/* Register blocks for "regs". Words with their bit set in skip are not
+ * read, because reading them changes state (data registers, DMA bursts). */
+typedef struct {
+    const char* name;
+    uint32_t base;
+    uint8_t words;
+    uint32_t skip;
+} Shell_RegBlock;
+
+static const Shell_RegBlock reg_blocks[] = {
+    { "rcc",     RCC_BASE,      36, 0 },
+    { "flash",   FLASH_R_BASE,  7,  0 },
+    { "gpioa",   GPIOA_BASE,    10, 0 },
+    { "gpiob",   GPIOB_BASE,    10, 0 },
+    { "gpiod",   GPIOD_BASE,    10, 0 },
+    { "exti",    EXTI_BASE,     6,  0 },
+    { "syscfg",  SYSCFG_BASE,   9,  (1UL << 6) | (1UL << 7) },
+    { "usart3",  USART3_BASE,   7,  (1UL << 1) },
+    { "dma1",    DMA1_BASE,     52, 0 },
+    { "dma2",    DMA2_BASE,     52, 0 },
+    { "tim2",    TIM2_BASE,     21, (1UL << 19) },
+    { "tim3",    TIM3_BASE,     21, (1UL << 19) },
+    { "tim6",    TIM6_BASE,     12, (1UL << 2) | (7UL << 6) },
+    { "tim7",    TIM7_BASE,     12, (1UL << 2) | (7UL << 6) },
+    { "scb",     SCB_BASE,      16, 0 },
+    { "nvic",    NVIC_BASE,     3,  0 },
+    { "systick", SysTick_BASE,  4,  0 },
+    { "dwt",     DWT_BASE,      7,  0 },
+};
+
+/* Line editor */
+static char line[SHELL_LINE_MAX + 1];
+static uint8_t line_len = 0;
+static uint8_t esc_state = SHELL_ESC_NONE;
+static bool last_cr = false;
+
+/* History ring; history_pos counts back from the newest while browsing */
+static char history[SHELL_HISTORY][SHELL_LINE_MAX + 1];
+static uint8_t history_count = 0;
+static uint8_t history_next = 0;
+static uint8_t history_pos = 0;
+
+/* The running command, its arguments point into line */
+static const Shell_Command* running = NULL;
+static char* run_argv[SHELL_MAX_ARGS];
+static int run_argc = 0;
+static uint32_t run_step = 0;
+static bool run_timed = false;
+static uint32_t run_cycles = 0;
+static uint32_t run_start_ms = 0;
+static Shell_AbortHandler run_abort = NULL;
+
+static Shell_Status Shell_CmdTime(int argc, char* argv[]);
+
+static void Shell_Write(const char* text, uint16_t length) {
+    UART_WriteAsync((const uint8_t*)text, length);
+}
+
+static void Shell_WriteString(const char* text) {
+    Shell_Write(text, (uint16_t)strlen(text));
+}
+
+static void Shell_Prompt(void) {
+    line_len = 0;
+    line[0] = '\0';
+    history_pos = 0;
+    Shell_WriteString(SHELL_PROMPT);
+}
+
+static void Shell_Redraw(void) {
+    Shell_WriteString(SHELL_REDRAW);
+    Shell_Write(line, line_len);
+}
+
+const Shell_Command* Shell_Find(const char* name) {
+    for (const Shell_Command* cmd = __start_shell_cmd; cmd < __stop_shell_cmd; cmd++) {
+        if (strcmp(cmd->name, name) == 0) {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+bool Shell_ParseU32(const char* text, uint32_t* value) {
+    uint32_t result = 0;
+    uint32_t base = 10;
+
+    if (text == NULL || value == NULL || *text == '\0') {
+        return false;
+    }
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+        if (*text == '\0') {
+            return false;
+        }
+    }
+
+    for (; *text != '\0'; text++) {
+        uint32_t digit;
+        if (*text >= '0' && *text <= '9') {
+            digit = (uint32_t)(*text - '0');
+        } else if (base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = (uint32_t)(*text - 'a' + 10);
+        } else if (base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = (uint32_t)(*text - 'A' + 10);
+        } else {
+            return false;
+        }
+        if (result > (0xFFFFFFFFUL - digit) / base) {
+            return false;
+        }
+        result = result * base + digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+uint32_t Shell_GetStep(void) {
+    return run_step;
+}
+
+void Shell_SetAbortHandler(Shell_AbortHandler abort) {
+    run_abort = abort;
+}
+
+static void Shell_Finish(Shell_Status status) {
+    if (status == SHELL_ERROR_USAGE) {
+        FMT_Print("usage: %s %s\r\n", running->name, running->usage);
+    }
+    if (run_timed) {
+        FMT_Print("time: %lu cycles in %lu calls, %lu ms elapsed\r\n",
+                  run_cycles, run_step, systick_counter - run_start_ms);
+    }
+    running = NULL;
+    run_abort = NULL;
+
+    /* Commands that reconfigure the UART may leave the RX interrupt off */
+    if (!(USART3->CR1 & USART_CR1_RXNEIE)) {
+        UART_StartReceiveIT();
+    }
+    Shell_Prompt();
+}
+
+/* Ctrl-C anywhere in the typeahead; it and what came before are dropped */
+static bool Shell_Interrupted(void) {
+    const uint8_t* data;
+    uint16_t offset = 0;
+    uint16_t n;
+
+    while ((n = UART_PeekRxAt(offset, &data)) != 0) {
+        const uint8_t* key = memchr(data, SHELL_KEY_CTRL_C, n);
+        if (key != NULL) {
+            UART_ConsumeRx(offset + (uint16_t)(key - data) + 1U);
+            return true;
+        }
+        offset += n;
+    }
+    return false;
+}
+
+/* One handler call, only when the output it may produce fits */
+static void Shell_Continue(void) {
+    if (UART_GetTxFree() < SHELL_TX_RESERVE) {
+        return;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    TRACE_BEGIN(TRACE_MARK_COMMAND);
+    Shell_Status status = running->handler(run_argc, run_argv);
+    TRACE_END(TRACE_MARK_COMMAND);
+    run_cycles += DWT->CYCCNT - start;
+    run_step++;
+
+    if (status != SHELL_MORE) {
+        Shell_Finish(status);
+    }
+}
+
+static void Shell_HistoryAdd(void) {
+    if (history_count != 0) {
+        uint8_t newest = (uint8_t)((history_next + SHELL_HISTORY - 1) % SHELL_HISTORY);
+        if (strcmp(history[newest], line) == 0) {
+            return;
+        }
+    }
+    memcpy(history[history_next], line, line_len + 1U);
+    history_next = (uint8_t)((history_next + 1) % SHELL_HISTORY);
+    if (history_count < SHELL_HISTORY) {
+        history_count++;
+    }
+}
+
+/* pos 1 is the newest entry, 0 the empty line being typed */
+static void Shell_HistoryRecall(uint8_t pos) {
+    history_pos = pos;
+    if (pos == 0) {
+        line_len = 0;
+    } else {
+        uint8_t index = (uint8_t)((history_next + SHELL_HISTORY - pos) % SHELL_HISTORY);
+        line_len = (uint8_t)strlen(history[index]);
+        memcpy(line, history[index], line_len);
+    }
+    line[line_len] = '\0';
+    Shell_Redraw();
+}
+
+static void Shell_Execute(void) {
+    Shell_WriteString("\r\n");
+
+    if (line_len == 0) {
+        Shell_Prompt();
+        return;
+    }
+    Shell_HistoryAdd();
+
+    /* Split on spaces in place */
+    int argc = 0;
+    char* p = line;
+    while (*p != '\0') {
+        while (*p == ' ') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (argc == SHELL_MAX_ARGS) {
+            FMT_Print("too many arguments, at most %d\r\n", SHELL_MAX_ARGS - 1);
+            Shell_Prompt();
+            return;
+        }
+        run_argv[argc++] = p;
+        while (*p != '\0' && *p != ' ') {
+            p++;
+        }
+    }
+    if (argc == 0) {
+        Shell_Prompt();
+        return;
+    }
+
+    /* "time" wraps the command that follows it */
+    char** argv = run_argv;
+    const Shell_Command* cmd = Shell_Find(argv[0]);
+    run_timed = false;
+    while (cmd != NULL && cmd->handler == Shell_CmdTime && argc > 1) {
+        run_timed = true;
+        argv++;
+        argc--;
+        cmd = Shell_Find(argv[0]);
+    }
+    if (cmd == NULL) {
+        FMT_Print("unknown command '%s', try 'help'\r\n", argv[0]);
+        Shell_Prompt();
+        return;
+    }
+
+    memmove(run_argv, argv, (size_t)argc * sizeof(run_argv[0]));
+    run_argc = argc;
+    run_step = 0;
+    run_cycles = 0;
+    run_start_ms = systick_counter;
+    run_abort = NULL;
+    running = cmd;
+    Shell_Continue();
+}
+
+/* Complete the command name; on ambiguity extend to the common prefix,
+ * or list the candidates when there is nothing to add */
+static void Shell_Complete(void) {
+    if (memchr(line, ' ', line_len) != NULL) {
+        return;
+    }
+
+    const Shell_Command* first = NULL;
+    uint8_t common = 0;
+    uint16_t matches = 0;
+    for (const Shell_Command* cmd = __start_shell_cmd; cmd < __stop_shell_cmd; cmd++) {
+        if (strncmp(cmd->name, line, line_len) != 0) {
+            continue;
+        }
+        if (first == NULL) {
+            first = cmd;
+            common = (uint8_t)strlen(cmd->name);
+        } else {
+            uint8_t i = line_len;
+            while (i < common && cmd->name[i] == first->name[i]) {
+                i++;
+            }
+            common = i;
+        }
+        matches++;
+    }
+    if (matches == 0) {
+        return;
+    }
+
+    if (common > SHELL_LINE_MAX - 1) {
+        common = SHELL_LINE_MAX - 1;
+    }
+    if (common > line_len) {
+        Shell_Write(first->name + line_len, (uint16_t)(common - line_len));
+        memcpy(line + line_len, first->name + line_len, (size_t)(common - line_len));
+        line_len = common;
+    }
+    if (matches == 1) {
+        line[line_len++] = ' ';
+        Shell_Write(" ", 1);
+    } else if (common == line_len) {
+        Shell_WriteString("\r\n");
+        for (const Shell_Command* cmd = __start_shell_cmd; cmd < __stop_shell_cmd; cmd++) {
+            if (strncmp(cmd->name, line, line_len) == 0) {
+                FMT_Print("%s  ", cmd->name);
+            }
+        }
+        Shell_WriteString("\r\n" SHELL_PROMPT);
+        Shell_Write(line, line_len);
+    }
+    line[line_len] = '\0';
+}
+
+static void Shell_Key(uint8_t c) {
+    /* Arrow keys arrive as ESC [ A / ESC [ B */
+    if (esc_state == SHELL_ESC_START) {
+        esc_state = (c == '[') ? SHELL_ESC_CSI : SHELL_ESC_NONE;
+        return;
+    }
+    if (esc_state == SHELL_ESC_CSI) {
+        if (c >= 0x40 && c <= 0x7E) {
+            esc_state = SHELL_ESC_NONE;
+            if (c == 'A' && history_pos < history_count) {
+                Shell_HistoryRecall((uint8_t)(history_pos + 1));
+            } else if (c == 'B' && history_pos > 0) {
+                Shell_HistoryRecall((uint8_t)(history_pos - 1));
+            }
+        }
+        return;
+    }
+
+    /* CR, LF and CR LF all end a line */
+    bool was_cr = last_cr;
+    last_cr = (c == '\r');
+    if (c == '\n' && was_cr) {
+        return;
+    }
+
+    switch (c) {
+    case '\r':
+    case '\n':
+        line[line_len] = '\0';
+        Shell_Execute();
+        break;
+
+    case SHELL_KEY_CTRL_C:
+        /* Also the way out of a trace stream */
+        if (Trace_IsRunning()) {
+            Trace_Stop();
+        }
+        Shell_WriteString("^C\r\n");
+        Shell_Prompt();
+        break;
+
+    case SHELL_KEY_CTRL_U:
+        line_len = 0;
+        line[0] = '\0';
+        Shell_Redraw();
+        break;
+
+    case SHELL_KEY_BACKSPACE:
+    case SHELL_KEY_DELETE:
+        if (line_len > 0) {
+            line[--line_len] = '\0';
+            Shell_WriteString("\b \b");
+        }
+        break;
+
+    case SHELL_KEY_TAB:
+        Shell_Complete();
+        break;
+
+    case SHELL_KEY_ESC:
+        esc_state = SHELL_ESC_START;
+        break;
+
+    default:
+        if (c < 0x20 || c > 0x7E) {
+            break;
+        }
+        if (line_len >= SHELL_LINE_MAX) {
+            Shell_WriteString("\a");
+            break;
+        }
+        line[line_len++] = (char)c;
+        line[line_len] = '\0';
+        Shell_Write((const char*)&c, 1);
+        break;
+    }
+}
+
+void Shell_Init(void) {
+    /* Cycle counter for "time" */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    esc_state = SHELL_ESC_NONE;
+    last_cr = false;
+    history_count = 0;
+    history_next = 0;
+    running = NULL;
+
+    if (!(USART3->CR1 & USART_CR1_RXNEIE)) {
+        UART_StartReceiveIT();
+    }
+
+    Shell_WriteString("\r\n");
+    Shell_Prompt();
+}
+
+bool Shell_Process(void) {
+    /* Typeahead stays in the RX ring until the running command is done */
+    for (uint16_t i = 0; i < SHELL_RX_BUDGET && running == NULL; i++) {
+        uint8_t c;
+        if (UART_ReadAsync(&c, 1) == 0) {
+            break;
+        }
+        Shell_Key(c);
+        if (running != NULL) {
+            return true;
+        }
+    }
+
+    if (running != NULL && Shell_Interrupted()) {
+        if (run_abort != NULL) {
+            run_abort();
+        }
+        Shell_WriteString("^C\r\n");
+        Shell_Finish(SHELL_OK);
+    } else if (running != NULL) {
+        Shell_Continue();
+    }
+    return running != NULL;
+}
+
+/* ---- Built-in commands ---- */
+
+static Shell_Status Shell_CmdHelp(int argc, char* argv[]) {
+    static const Shell_Command* last;
+
+    if (argc > 2) {
+        return SHELL_ERROR_USAGE;
+    }
+    if (argc == 2) {
+        const Shell_Command* cmd = Shell_Find(argv[1]);
+        if (cmd == NULL) {
+            FMT_Print("no command '%s'\r\n", argv[1]);
+            return SHELL_ERROR_FAILED;
+        }
+        FMT_Print("%s %s\r\n  %s\r\n", cmd->name, cmd->usage, cmd->help);
+        return SHELL_OK;
+    }
+
+    /* Two lines per call in name order; the section is in link order */
+    if (Shell_GetStep() == 0) {
+        last = NULL;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        const Shell_Command* next = NULL;
+        for (const Shell_Command* cmd = __start_shell_cmd; cmd < __stop_shell_cmd; cmd++) {
+            if ((last == NULL || strcmp(cmd->name, last->name) > 0) &&
+                (next == NULL || strcmp(cmd->name, next->name) < 0)) {
+                next = cmd;
+            }
+        }
+        if (next == NULL) {
+            return SHELL_OK;
+        }
+        FMT_Print("%-9s %-22s %s\r\n", next->name, next->usage, next->help);
+        last = next;
+    }
+    return SHELL_MORE;
+}
+SHELL_COMMAND("help", "[command]", "List commands, or show one in full", Shell_CmdHelp);
+
+/* Only called when there is nothing to time; Shell_Execute() unwraps it */
+static Shell_Status Shell_CmdTime(int argc, char* argv[]) {
+    return SHELL_ERROR_USAGE;
+}
+SHELL_COMMAND("time", "<command> [args]", "Run a command, print its cycles and elapsed time", Shell_CmdTime);
+
+static Shell_Status Shell_CmdUptime(int argc, char* argv[]) {
+    uint32_t ms = systick_counter;
+    uint32_t s = ms / 1000;
+
+    FMT_Print("up %lud %02lu:%02lu:%02lu.%03lu, CYCCNT %lu\r\n",
+              s / 86400, (s / 3600) % 24, (s / 60) % 60, s % 60, ms % 1000, DWT->CYCCNT);
+    return SHELL_OK;
+}
+SHELL_COMMAND("uptime", "", "Time since reset and the cycle counter", Shell_CmdUptime);
+
+static Shell_Status Shell_CmdStats(int argc, char* argv[]) {
+    FMT_Print("uart   rx %u queued, %lu overflowed; tx %u free, %lu dropped by stdio\r\n",
+              UART_GetRxCount(), uart_rx_overflows, UART_GetTxFree(), retarget_dropped);
+    FMT_Print("binlog %lu dropped; trace %s, %lu dropped\r\n",
+              binlog_dropped, Trace_IsRunning() ? "running" : "stopped", trace_dropped);
+    FMT_Print("pbuf   %u free; stack guard %s\r\n",
+              PBuf_GetFreeCount(), stackmon_overflow ? "HIT" : "ok");
+    return SHELL_OK;
+}
+SHELL_COMMAND("stats", "", "Ring fill, drop counters and pool usage", Shell_CmdStats);
+
+static bool Shell_Readable(uint32_t addr, uint32_t length) {
+    bool inside = false;
+
+    for (uint32_t i = 0; i < sizeof(readable) / sizeof(readable[0]); i++) {
+        if (addr >= readable[i].base && addr - readable[i].base < readable[i].size &&
+            length <= readable[i].size - (addr - readable[i].base)) {
+            inside = true;
+            break;
+        }
+    }
+    if (!inside) {
+        return false;
+    }
+
+    /* Reading a stack guard would be reported as an overflow */
+    for (uint8_t i = 0; i < StackMon_GetCount(); i++) {
+        uint32_t guard = (uint32_t)StackMon_GetStack(i)->base;
+        if (addr < guard + STACKMON_GUARD_SIZE && guard < addr + length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Shell_Status Shell_CmdMemDump(int argc, char* argv[]) {
+    static uint32_t addr;
+    static uint32_t end;
+    char text[SHELL_MD_WIDTH + 1];
+
+    if (Shell_GetStep() == 0) {
+        uint32_t length = 64;
+        if (argc < 2 || argc > 3 || !Shell_ParseU32(argv[1], &addr) ||
+            (argc == 3 && !Shell_ParseU32(argv[2], &length))) {
+            return SHELL_ERROR_USAGE;
+        }
+        if (length == 0 || length > SHELL_MD_MAX) {
+            FMT_Print("length must be 1-%d\r\n", SHELL_MD_MAX);
+            return SHELL_ERROR_FAILED;
+        }
+        if (!Shell_Readable(addr, length)) {
+            FMT_Print("%08lx+%lu is outside flash, system memory, CCM and SRAM, or covers a "
+                      "stack guard\r\n", addr, length);
+            return SHELL_ERROR_FAILED;
+        }
+        end = addr + length;
+    }
+
+    for (uint8_t n = 0; n < SHELL_MD_LINES && addr < end; n++) {
+        FMT_Print("%08lx:", addr);
+        uint8_t count = 0;
+        for (; count < SHELL_MD_WIDTH && addr < end; count++, addr++) {
+            uint8_t byte = *(const volatile uint8_t*)addr;
+            FMT_Print(" %02x", byte);
+            text[count] = (byte >= 0x20 && byte <= 0x7E) ? (char)byte : '.';
+        }
+        text[count] = '\0';
+        for (uint8_t pad = count; pad < SHELL_MD_WIDTH; pad++) {
+            Shell_WriteString("   ");
+        }
+        FMT_Print("  %s\r\n", text);
+    }
+    return (addr < end) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("md", "<addr> [bytes]", "Hex dump of flash or RAM, 64 bytes by default", Shell_CmdMemDump);
+
+static Shell_Status Shell_CmdRegs(int argc, char* argv[]) {
+    static const Shell_RegBlock* block;
+    static uint8_t word;
+
+    if (Shell_GetStep() == 0) {
+        if (argc != 2) {
+            Shell_WriteString("blocks:");
+            for (uint32_t i = 0; i < sizeof(reg_blocks) / sizeof(reg_blocks[0]); i++) {
+                FMT_Print(" %s", reg_blocks[i].name);
+            }
+            Shell_WriteString("\r\n");
+            return (argc == 1) ? SHELL_OK : SHELL_ERROR_USAGE;
+        }
+
+        block = NULL;
+        for (uint32_t i = 0; i < sizeof(reg_blocks) / sizeof(reg_blocks[0]); i++) {
+            if (strcmp(reg_blocks[i].name, argv[1]) == 0) {
+                block = &reg_blocks[i];
+            }
+        }
+        if (block == NULL) {
+            FMT_Print("no block '%s', 'regs' lists them\r\n", argv[1]);
+            return SHELL_ERROR_FAILED;
+        }
+        word = 0;
+        FMT_Print("%s @ %08lx\r\n", block->name, block->base);
+    }
+
+    /* One line of four registers per call */
+    FMT_Print("  +%03x ", (unsigned int)(word * 4U));
+    for (uint8_t n = 0; n < 4 && word < block->words; n++, word++) {
+        if (word < 32 && (block->skip & (1UL << word))) {
+            Shell_WriteString(" --------");
+        } else {
+            FMT_Print(" %08lx", *(const volatile uint32_t*)(block->base + word * 4U));
+        }
+    }
+    Shell_WriteString("\r\n");
+    return (word < block->words) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("regs", "[block]", "Dump a peripheral or core register block", Shell_CmdRegs);
+
+/* Resets once the message has left, polled like any other output */
+static Shell_Status Shell_CmdReset(int argc, char* argv[]) {
+    if (Shell_GetStep() == 0) {
+        Shell_WriteString("resetting\r\n");
+        return SHELL_MORE;
+    }
+    if (!UART_IsTxIdle() || !(USART3->SR & USART_SR_TC)) {
+        return SHELL_MORE;
+    }
+    NVIC_SystemReset();
+    return SHELL_OK;
+}
+SHELL_COMMAND("reset", "", "Software reset", Shell_CmdReset);
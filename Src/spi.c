@@ -0,0 +1,385 @@
+/* @spi.c */
+#include "spi.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Flags of one stream in DMA2 LISR/HISR, shifted down to bit 0 */
+#define SPI_DMA_FEIF            (1UL << 0)
+#define SPI_DMA_DMEIF           (1UL << 2)
+#define SPI_DMA_TEIF            (1UL << 3)
+#define SPI_DMA_HTIF            (1UL << 4)
+#define SPI_DMA_TCIF            (1UL << 5)
+#define SPI_DMA_ALL             (SPI_DMA_FEIF | SPI_DMA_DMEIF | SPI_DMA_TEIF | \
+                                 SPI_DMA_HTIF | SPI_DMA_TCIF)
+
+/* Clocked out when a transfer has no transmit data */
+#define SPI_FILL_BYTE           0xFFU
+
+typedef struct {
+    GPIO_TypeDef* port;
+    uint8_t pin;
+} Spi_Pin;
+
+/* Fixed hardware of each bus; DMA2 request channels per RM0090 table 43 */
+typedef struct {
+    SPI_TypeDef* regs;
+    DMA_Stream_TypeDef* rxStream;   /* NULL: one byte per SPI interrupt */
+    DMA_Stream_TypeDef* txStream;
+    uint8_t rxIndex;
+    uint8_t txIndex;
+    uint8_t dmaChannel;
+    IRQn_Type irq;                  /* RX stream, or the SPI without DMA */
+    bool apb2;
+    uint32_t clock;                 /* RCC_APB1ENR or RCC_APB2ENR bit */
+    uint8_t af;
+    Spi_Pin sck;
+    Spi_Pin miso;
+    Spi_Pin mosi;
+} Spi_Hw;
+
+static const Spi_Hw spi_hw[SPI_BUSES] = {
+    { SPI1, DMA2_Stream0, DMA2_Stream3, 0, 3, 3, DMA2_Stream0_IRQn, true, RCC_APB2ENR_SPI1EN, 5,
+      { GPIOA, 5 }, { GPIOA, 6 }, { GPIOB, 5 } },
+    { SPI2, NULL, NULL, 0, 0, 0, SPI2_IRQn, false, RCC_APB1ENR_SPI2EN, 5,
+      { GPIOB, 10 }, { GPIOC, 2 }, { GPIOC, 3 } },
+    { SPI3, NULL, NULL, 0, 0, 0, SPI3_IRQn, false, RCC_APB1ENR_SPI3EN, 6,
+      { GPIOC, 10 }, { GPIOC, 11 }, { GPIOC, 12 } },
+    { SPI4, DMA2_Stream0, DMA2_Stream1, 0, 1, 4, DMA2_Stream0_IRQn, true, RCC_APB2ENR_SPI4EN, 5,
+      { GPIOE, 2 }, { GPIOE, 5 }, { GPIOE, 6 } },
+    { SPI5, DMA2_Stream5, DMA2_Stream6, 5, 6, 7, DMA2_Stream5_IRQn, true, RCC_APB2ENR_SPI5EN, 5,
+      { GPIOF, 7 }, { GPIOF, 8 }, { GPIOF, 9 } },
+    { SPI6, DMA2_Stream6, DMA2_Stream5, 6, 5, 1, DMA2_Stream6_IRQn, true, RCC_APB2ENR_SPI6EN, 5,
+      { GPIOG, 13 }, { GPIOG, 12 }, { GPIOG, 14 } },
+};
+
+/* Bit position of each stream's flags in LISR/HISR */
+static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+typedef struct {
+    Spi_Transfer* head;         /* Running transfer, NULL when idle */
+    Spi_Transfer* tail;
+    const Spi_Device* selected; /* Chip select held low */
+    uint16_t position;          /* Next byte, without DMA */
+    bool ready;
+    Spi_Stats stats;
+} Spi_Bus;
+
+static Spi_Bus buses[SPI_BUSES];
+static uint8_t dma_claimed = 0;         /* DMA2 streams held by initialised buses */
+static int8_t rx_stream_bus[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+
+static const uint8_t spi_fill = SPI_FILL_BYTE;
+static uint8_t spi_sink;
+
+static void Spi_Start(uint8_t index);
+
+static uint32_t Spi_DmaFlags(uint8_t stream) {
+    volatile uint32_t* isr = (stream < 4) ? &DMA2->LISR : &DMA2->HISR;
+    return (*isr >> flag_shift[stream & 3]) & SPI_DMA_ALL;
+}
+
+static void Spi_DmaClear(uint8_t stream, uint32_t flags) {
+    volatile uint32_t* ifcr = (stream < 4) ? &DMA2->LIFCR : &DMA2->HIFCR;
+    *ifcr = flags << flag_shift[stream & 3];
+}
+
+static void Spi_DmaDisable(DMA_Stream_TypeDef* stream, uint8_t streamIndex) {
+    stream->CR &= ~DMA_SxCR_EN;
+    while (stream->CR & DMA_SxCR_EN);
+    Spi_DmaClear(streamIndex, SPI_DMA_ALL);
+}
+
+/* Byte transfer between memory and DR through the stream FIFO, which
+ * rides out AHB contention; without a buffer the address stays put */
+static void Spi_DmaArm(DMA_Stream_TypeDef* stream, uint8_t streamIndex, uint8_t channel,
+                       uint32_t dr, const uint8_t* memory, bool increment, uint16_t length,
+                       bool transmit) {
+    Spi_DmaDisable(stream, streamIndex);
+    stream->PAR = dr;
+    stream->M0AR = (uint32_t)memory;
+    stream->NDTR = length;
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0;
+    stream->CR = ((uint32_t)channel << DMA_SxCR_CHSEL_Pos) |
+                 (increment ? DMA_SxCR_MINC : 0) |
+                 (transmit ? (DMA_SxCR_DIR_0 | DMA_SxCR_PL_1)
+                           : (DMA_SxCR_PL | DMA_SxCR_TCIE | DMA_SxCR_TEIE));
+    stream->CR |= DMA_SxCR_EN;
+}
+
+static GPIO_TypeDef* Spi_Port(char letter) {
+    return (GPIO_TypeDef*)(GPIOA_BASE + (uint32_t)(letter - 'A') * 0x400UL);
+}
+
+static void Spi_ConfigurePin(const Spi_Pin* pin, uint8_t af) {
+    uint32_t shift = (pin->pin & 7U) * 4U;
+    volatile uint32_t* afr = &pin->port->AFR[pin->pin >> 3];
+
+    RCC->AHB1ENR |= 1UL << (((uint32_t)pin->port - GPIOA_BASE) / 0x400UL);
+    pin->port->OSPEEDR |= 3UL << (pin->pin * 2U);          /* Very high */
+    *afr = (*afr & ~(0xFUL << shift)) | ((uint32_t)af << shift);
+    pin->port->MODER = (pin->port->MODER & ~(3UL << (pin->pin * 2U))) | (2UL << (pin->pin * 2U));
+}
+
+static void Spi_Deselect(const Spi_Device* device) {
+    Spi_Port(device->csPort)->BSRR = 1UL << device->csPin;
+}
+
+/* Retire head and move on to the next transfer */
+static void Spi_Finish(uint8_t index, Spi_Status status) {
+    const Spi_Hw* hw = &spi_hw[index];
+    Spi_Bus* bus = &buses[index];
+    Spi_Transfer* xfer = bus->head;
+
+    /* The last byte is in, but SCK may still be finishing its edge */
+    while (hw->regs->SR & SPI_SR_BSY);
+    hw->regs->CR2 = 0;
+    if (hw->rxStream != NULL) {
+        Spi_DmaDisable(hw->txStream, hw->txIndex);
+        Spi_DmaDisable(hw->rxStream, hw->rxIndex);
+    }
+
+    if (!(xfer->flags & SPI_HOLD_CS) || status != SPI_STATUS_DONE) {
+        Spi_Deselect(xfer->device);
+        bus->selected = NULL;
+    }
+
+    bus->head = xfer->next;
+    if (bus->head == NULL) {
+        bus->tail = NULL;
+    }
+    xfer->next = NULL;
+    xfer->status = status;
+    bus->stats.transfers++;
+    bus->stats.bytes += xfer->length;
+
+    /* The callback may submit more; Spi_Submit starts an idle bus itself */
+    Spi_Transfer* before = bus->head;
+    if (xfer->callback != NULL) {
+        xfer->callback(xfer);
+    }
+    if (before != NULL && bus->head == before) {
+        Spi_Start(index);
+    }
+}
+
+/* Select the device, set its clock and mode, and start clocking */
+static void Spi_Start(uint8_t index) {
+    const Spi_Hw* hw = &spi_hw[index];
+    Spi_Bus* bus = &buses[index];
+    Spi_Transfer* xfer = bus->head;
+    const Spi_Device* device = xfer->device;
+    SPI_TypeDef* regs = hw->regs;
+
+    if (bus->selected != NULL && bus->selected != device) {
+        Spi_Deselect(bus->selected);
+    }
+    if (regs->CR1 != (device->cr1 | SPI_CR1_SPE)) {
+        regs->CR1 = device->cr1;
+        regs->CR1 = device->cr1 | SPI_CR1_SPE;
+    }
+    Spi_Port(device->csPort)->BSRR = 1UL << (device->csPin + 16U);
+    bus->selected = device;
+
+    /* Drop a stale byte and overrun flag */
+    (void)regs->DR;
+    (void)regs->SR;
+
+    if (hw->rxStream == NULL) {
+        bus->position = 0;
+        regs->CR2 = SPI_CR2_RXNEIE;
+        regs->DR = (xfer->txData != NULL) ? xfer->txData[0] : SPI_FILL_BYTE;
+        return;
+    }
+
+    /* RX first, so no received byte finds the stream unarmed */
+    Spi_DmaArm(hw->rxStream, hw->rxIndex, hw->dmaChannel, (uint32_t)&regs->DR,
+               (xfer->rxData != NULL) ? xfer->rxData : &spi_sink, xfer->rxData != NULL,
+               xfer->length, false);
+    Spi_DmaArm(hw->txStream, hw->txIndex, hw->dmaChannel, (uint32_t)&regs->DR,
+               (xfer->txData != NULL) ? xfer->txData : &spi_fill, xfer->txData != NULL,
+               xfer->length, true);
+    regs->CR2 = SPI_CR2_RXDMAEN;
+    regs->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+static bool Spi_BufferOk(const void* data) {
+    uint32_t addr = (uint32_t)data;
+
+    return !(addr >= 0x10000000UL && addr < 0x10010000UL);
+}
+
+Spi_Error Spi_Init(uint8_t bus) {
+    if (bus < 1 || bus > SPI_BUSES) {
+        return SPI_ERROR_PARAM;
+    }
+    uint8_t index = (uint8_t)(bus - 1);
+    const Spi_Hw* hw = &spi_hw[index];
+    Spi_Bus* state = &buses[index];
+
+    if (hw->rxStream != NULL) {
+        uint8_t streams = (uint8_t)((1U << hw->rxIndex) | (1U << hw->txIndex));
+        if (!state->ready && (dma_claimed & streams)) {
+            return SPI_ERROR_BUSY;
+        }
+        dma_claimed |= streams;
+        rx_stream_bus[hw->rxIndex] = (int8_t)index;
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    }
+
+    NVIC_DisableIRQ(hw->irq);
+    if (hw->apb2) {
+        RCC->APB2ENR |= hw->clock;
+    } else {
+        RCC->APB1ENR |= hw->clock;
+    }
+    Spi_ConfigurePin(&hw->sck, hw->af);
+    Spi_ConfigurePin(&hw->miso, hw->af);
+    Spi_ConfigurePin(&hw->mosi, hw->af);
+
+    memset(state, 0, sizeof(*state));
+    hw->regs->CR1 = 0;
+    hw->regs->CR2 = 0;
+    state->ready = true;
+    NVIC_EnableIRQ(hw->irq);
+    return SPI_OK;
+}
+
+Spi_Error Spi_AddDevice(Spi_Device* device) {
+    if (device == NULL || device->bus < 1 || device->bus > SPI_BUSES || device->csPort < 'A' ||
+        device->csPort > 'K' || device->csPin > 15 || device->mode > 3 || device->maxHz == 0) {
+        return SPI_ERROR_PARAM;
+    }
+    uint32_t pclk = spi_hw[device->bus - 1].apb2 ? SPI_APB2_HZ : SPI_APB1_HZ;
+    uint32_t br = 0;
+
+    /* SCK = PCLK / 2^(BR + 1) */
+    while (br < 7 && (pclk >> (br + 1)) > device->maxHz) {
+        br++;
+    }
+    device->cr1 = (uint16_t)((br << SPI_CR1_BR_Pos) | SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI |
+                             device->mode);
+
+    GPIO_TypeDef* port = Spi_Port(device->csPort);
+    RCC->AHB1ENR |= 1UL << (uint32_t)(device->csPort - 'A');
+    port->BSRR = 1UL << device->csPin;
+    port->OSPEEDR |= 2UL << (device->csPin * 2U);
+    port->MODER = (port->MODER & ~(3UL << (device->csPin * 2U))) | (1UL << (device->csPin * 2U));
+    return SPI_OK;
+}
+
+Spi_Error Spi_Submit(Spi_Transfer* xfer) {
+    if (xfer == NULL || xfer->device == NULL || xfer->device->bus < 1 ||
+        xfer->device->bus > SPI_BUSES) {
+        return SPI_ERROR_PARAM;
+    }
+    uint8_t index = (uint8_t)(xfer->device->bus - 1);
+    Spi_Bus* bus = &buses[index];
+    if (!bus->ready) {
+        return SPI_ERROR_NOT_READY;
+    }
+
+    /* Check the whole chain before any of it is queued */
+    Spi_Transfer* last = xfer;
+    for (Spi_Transfer* t = xfer; t != NULL; t = t->next) {
+        if (t->device == NULL || t->device->bus != xfer->device->bus || t->length == 0 ||
+            !Spi_BufferOk(t->txData) || !Spi_BufferOk(t->rxData)) {
+            return SPI_ERROR_PARAM;
+        }
+        last = t;
+    }
+    for (Spi_Transfer* t = xfer; t != NULL; t = t->next) {
+        t->status = SPI_STATUS_PENDING;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (bus->head == NULL) {
+        bus->head = xfer;
+        bus->tail = last;
+        Spi_Start(index);
+    } else {
+        bus->tail->next = xfer;
+        bus->tail = last;
+    }
+    __set_PRIMASK(primask);
+
+    return SPI_OK;
+}
+
+bool Spi_IsBusy(uint8_t bus) {
+    if (bus < 1 || bus > SPI_BUSES) {
+        return false;
+    }
+    return buses[bus - 1].head != NULL;
+}
+
+void Spi_GetStats(uint8_t bus, Spi_Stats* stats) {
+    if (stats == NULL || bus < 1 || bus > SPI_BUSES) {
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = buses[bus - 1].stats;
+    __set_PRIMASK(primask);
+}
+
+/* The receive stream finishes last: every byte has been clocked both ways */
+static void Spi_DmaIrq(uint8_t stream) {
+    int8_t owner = rx_stream_bus[stream];
+    uint32_t flags = Spi_DmaFlags(stream);
+
+    Spi_DmaClear(stream, flags);
+    if (owner < 0 || buses[owner].head == NULL) {
+        return;
+    }
+    if (flags & SPI_DMA_TEIF) {
+        buses[owner].stats.dmaErrors++;
+        Spi_Finish((uint8_t)owner, SPI_STATUS_DMA_ERROR);
+    } else if (flags & SPI_DMA_TCIF) {
+        Spi_Finish((uint8_t)owner, SPI_STATUS_DONE);
+    }
+}
+
+/* SPI2/SPI3: one byte in flight, the next goes out when it returns */
+static void Spi_ByteIrq(uint8_t index) {
+    SPI_TypeDef* regs = spi_hw[index].regs;
+    Spi_Bus* bus = &buses[index];
+    Spi_Transfer* xfer = bus->head;
+    uint8_t byte = (uint8_t)regs->DR;
+
+    if (xfer == NULL) {
+        regs->CR2 = 0;
+        return;
+    }
+    if (xfer->rxData != NULL) {
+        xfer->rxData[bus->position] = byte;
+    }
+    bus->position++;
+    if (bus->position < xfer->length) {
+        regs->DR = (xfer->txData != NULL) ? xfer->txData[bus->position] : SPI_FILL_BYTE;
+    } else {
+        Spi_Finish(index, SPI_STATUS_DONE);
+    }
+}
+
+/* SPI1 or SPI4 */
+void DMA2_Stream0_IRQHandler(void) {
+    Spi_DmaIrq(0);
+}
+
+void DMA2_Stream5_IRQHandler(void) {
+    Spi_DmaIrq(5);
+}
+
+void DMA2_Stream6_IRQHandler(void) {
+    Spi_DmaIrq(6);
+}
+
+void SPI2_IRQHandler(void) {
+    Spi_ByteIrq(1);
+}
+
+void SPI3_IRQHandler(void) {
+    Spi_ByteIrq(2);
+}
@@ -0,0 +1,185 @@
+/* @stack_monitor.c */
+#include "stack_monitor.h"
+#include "stm32f4xx.h"
+#include "mpu_armv7.h"
+#include "fmt.h"
+#include "shell.h"
+#include <stddef.h>
+
+/* Bytes below the current SP left unpainted at boot, covers the frame of
+ * the painting loop itself */
+#define STACKMON_PAINT_MARGIN   64
+
+/* Normal memory, no access at any privilege level, never executable */
+#define STACKMON_GUARD_RASR \
+    ARM_MPU_RASR(1U, ARM_MPU_AP_NONE, 0U, 0U, 1U, 1U, 0x00U, ARM_MPU_REGION_SIZE_32B)
+
+volatile uint8_t stackmon_overflow = 0;
+
+static StackMon_Stack stacks[STACKMON_MAX_STACKS];
+static uint8_t stack_count = 0;
+
+static void StackMon_Paint(uint32_t* from, uint32_t* to) {
+    while (from < to) {
+        *from++ = STACKMON_PAINT_PATTERN;
+    }
+}
+
+static void StackMon_InstallGuard(uint8_t region, uint32_t* base) {
+    /* Region writes must not race with an access to the old layout */
+    ARM_MPU_Disable();
+    ARM_MPU_SetRegion(ARM_MPU_RBAR(region, (uint32_t)base), STACKMON_GUARD_RASR);
+
+    /* PRIVDEFENA keeps the default memory map for everything else */
+    ARM_MPU_Enable(MPU_CTRL_PRIVDEFENA_Msk);
+
+    /* Without MEMFAULTENA a guard hit escalates to HardFault */
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    __DSB();
+    __ISB();
+}
+
+static void StackMon_Scan(StackMon_Stack* stack) {
+    uint32_t* word = stack->base + (STACKMON_GUARD_SIZE / 4);
+
+    /* Usage only grows downwards, so only the words below the previous
+     * mark can have changed since the last scan */
+    while (word < stack->mark && *word == STACKMON_PAINT_PATTERN) {
+        word++;
+    }
+    stack->mark = word;
+    stack->peakUsed = (uint32_t)((uint8_t*)stack->base + stack->size - (uint8_t*)word);
+}
+
+StackMon_Error StackMon_Init(void) {
+    extern uint8_t _estack;          /* Symbol defined in the linker script */
+    extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+    uint32_t size = (uint32_t)&_Min_Stack_Size;
+    uint32_t* base = (uint32_t*)((uint32_t)&_estack - size);
+    uint32_t* sp = (uint32_t*)(__get_MSP() - STACKMON_PAINT_MARGIN);
+
+    if (stack_count != 0) {
+        return STACKMON_ERROR_FULL;
+    }
+
+    /* Everything between the guard and the live frames is unused so far */
+    StackMon_Paint(base + (STACKMON_GUARD_SIZE / 4), sp);
+
+    stacks[0].name = "main";
+    stacks[0].base = base;
+    stacks[0].size = size;
+    stacks[0].mark = sp;
+    stack_count = 1;
+    StackMon_Scan(&stacks[0]);
+
+    StackMon_InstallGuard(0, base);
+
+    return STACKMON_OK;
+}
+
+StackMon_Error StackMon_RegisterTask(const char* name, uint32_t* base, uint32_t size) {
+    if (base == NULL || size <= STACKMON_GUARD_SIZE || (size & 3U) != 0) {
+        return STACKMON_ERROR_PARAM;
+    }
+
+    /* MPU regions must be aligned to their own size */
+    if (((uint32_t)base & (STACKMON_GUARD_SIZE - 1U)) != 0) {
+        return STACKMON_ERROR_ALIGN;
+    }
+
+    if (stack_count >= STACKMON_MAX_STACKS) {
+        return STACKMON_ERROR_FULL;
+    }
+
+    StackMon_Paint(base + (STACKMON_GUARD_SIZE / 4), base + (size / 4));
+
+    StackMon_Stack* stack = &stacks[stack_count];
+    stack->name = name;
+    stack->base = base;
+    stack->size = size;
+    stack->mark = base + (size / 4);
+    stack->peakUsed = 0;
+
+    StackMon_InstallGuard(stack_count, base);
+    stack_count++;
+
+    return STACKMON_OK;
+}
+
+void StackMon_Update(void) {
+    for (uint8_t i = 0; i < stack_count; i++) {
+        StackMon_Scan(&stacks[i]);
+    }
+}
+
+uint8_t StackMon_GetCount(void) {
+    return stack_count;
+}
+
+const StackMon_Stack* StackMon_GetStack(uint8_t index) {
+    if (index >= stack_count) {
+        return NULL;
+    }
+    return &stacks[index];
+}
+
+bool StackMon_Report(uint32_t row) {
+    if (row == 0) {
+        StackMon_Update();
+        FMT_Print("\r\nStack       Size   Peak  Use%%\r\n");
+    } else if (row <= stack_count) {
+        const StackMon_Stack* stack = &stacks[row - 1];
+        FMT_Print("%-10s %5lu  %5lu  %3lu%%\r\n", stack->name, stack->size, stack->peakUsed,
+                  stack->peakUsed * 100UL / stack->size);
+    }
+    return row < stack_count;
+}
+
+/* The TX interrupt never runs at this priority and the DMA may be stopped
+ * mid-block, so write the data register directly */
+static void StackMon_FaultPrint(const char* str) {
+    while (*str) {
+        while (!(USART3->SR & USART_SR_TXE));
+        USART3->DR = (uint8_t)*str++;
+    }
+}
+
+void MemManage_Handler(void) {
+    const char* name = "main";
+    uint32_t cfsr = SCB->CFSR;
+
+    /* A faulting data access reports its address; a failed exception
+     * entry (MSTKERR) does not, and can only come from the active stack */
+    if (cfsr & SCB_CFSR_MMARVALID_Msk) {
+        uint32_t addr = SCB->MMFAR;
+        for (uint8_t i = 0; i < stack_count; i++) {
+            uint32_t guard = (uint32_t)stacks[i].base;
+            if (addr >= guard && addr < guard + STACKMON_GUARD_SIZE) {
+                name = stacks[i].name;
+                break;
+            }
+        }
+    }
+
+    stackmon_overflow = 1;
+
+    /* The report below runs on the overflowed stack, let it spill */
+    ARM_MPU_Disable();
+    SCB->CFSR = cfsr;
+
+    /* Whatever is still queued in the TX ring is dropped */
+    USART3->CR1 &= ~USART_CR1_TXEIE;
+    USART3->CR3 &= ~USART_CR3_DMAT;
+
+    StackMon_FaultPrint("\r\n*** STACK OVERFLOW: ");
+    StackMon_FaultPrint(name);
+    StackMon_FaultPrint(" ***\r\n");
+
+    while (1);  /* Stop here */
+}
+
+static Shell_Status StackMon_Cmd(int argc, char* argv[]) {
+    /* One stack per call */
+    return StackMon_Report(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("stack", "", "Stack high-watermarks and guard hits", StackMon_Cmd);
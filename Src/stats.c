@@ -0,0 +1,331 @@
+/* @stats.c */
+#include "stats.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define STATS_PAIRS             (STATS_MAX_CHANNELS / 2)
+
+/* Closed panes kept, a power of 2: a window plus room for panes closing
+ * while a snapshot copies it */
+#define STATS_RING              (2 * STATS_MAX_PANES)
+
+#define STATS_SNAPSHOT_TRIES    4
+
+/* Two channels' samples as one word, channel 2p low */
+#define STATS_PAIR(p)           __UNALIGNED_UINT32_READ(p)
+
+/* Empty min and max, both lanes */
+#define STATS_MIN_INIT          0x7FFF7FFFUL
+#define STATS_MAX_INIT          0x80008000UL
+
+/* Not loaded and not cleared by the startup code; Stats_Init clears it */
+#define STATS_CCM               __attribute__((section(".ccm_noinit")))
+
+/* Current pane */
+static int32_t cur_sum[STATS_MAX_CHANNELS] STATS_CCM;
+static int64_t cur_squares[STATS_MAX_CHANNELS] STATS_CCM;
+static uint32_t cur_min[STATS_PAIRS] STATS_CCM;
+static uint32_t cur_max[STATS_PAIRS] STATS_CCM;
+
+/* Closed panes, slot = pane number % STATS_RING */
+static float pane_mean[STATS_RING][STATS_MAX_CHANNELS] STATS_CCM;
+static float pane_m2[STATS_RING][STATS_MAX_CHANNELS] STATS_CCM;   /* Sum of squared deviations */
+static uint32_t pane_min[STATS_RING][STATS_PAIRS] STATS_CCM;
+static uint32_t pane_max[STATS_RING][STATS_PAIRS] STATS_CCM;
+
+static Stats_Config stats_config;
+static uint16_t cur_count;
+static volatile uint32_t panes_closed;
+
+static void Stats_ResetPane(void) {
+    memset(cur_sum, 0, sizeof(cur_sum));
+    memset(cur_squares, 0, sizeof(cur_squares));
+    for (uint8_t p = 0; p < STATS_PAIRS; p++) {
+        cur_min[p] = STATS_MIN_INIT;
+        cur_max[p] = STATS_MAX_INIT;
+    }
+    cur_count = 0;
+}
+
+Stats_Error Stats_Init(const Stats_Config* config) {
+    if (config == NULL || config->channels == 0 || config->channels > STATS_MAX_CHANNELS ||
+        config->paneSamples == 0 || config->panes == 0 || config->panes > STATS_MAX_PANES ||
+        config->mode > STATS_TUMBLING) {
+        return STATS_ERROR_PARAM;
+    }
+    stats_config = *config;
+    memset(pane_mean, 0, sizeof(pane_mean));
+    memset(pane_m2, 0, sizeof(pane_m2));
+    memset(pane_min, 0, sizeof(pane_min));
+    memset(pane_max, 0, sizeof(pane_max));
+    Stats_ResetPane();
+    panes_closed = 0;
+    return STATS_OK;
+}
+
+/* n * sum of squares - sum^2 is exact in 64 bits: both are below 2^62
+ * for 65535 samples of 16 bits */
+static void Stats_ClosePane(void) {
+    uint32_t slot = panes_closed % STATS_RING;
+    int64_t n = cur_count;
+    float scale = 1.0f / (float)n;
+
+    for (uint8_t c = 0; c < stats_config.channels; c++) {
+        int64_t sum = cur_sum[c];
+        pane_mean[slot][c] = (float)sum * scale;
+        pane_m2[slot][c] = (float)(n * cur_squares[c] - sum * sum) * scale;
+    }
+    memcpy(pane_min[slot], cur_min, sizeof(cur_min));
+    memcpy(pane_max[slot], cur_max, sizeof(cur_max));
+    Stats_ResetPane();
+
+    /* The pane is complete before the count says so */
+    __DMB();
+    panes_closed++;
+}
+
+/* Min and max of both lanes at once: SSUB16 sets the GE flag of each lane
+ * where the new sample is not below the old value, SEL picks by it */
+static inline void Stats_AddPair(uint8_t p, uint32_t pair) {
+    int32_t lo = (int16_t)pair;
+    int32_t hi = (int32_t)pair >> 16;
+
+    cur_sum[2U * p] += lo;
+    cur_sum[2U * p + 1U] += hi;
+    cur_squares[2U * p] += lo * lo;
+    cur_squares[2U * p + 1U] += hi * hi;
+    (void)__SSUB16(pair, cur_min[p]);
+    cur_min[p] = __SEL(cur_min[p], pair);
+    (void)__SSUB16(pair, cur_max[p]);
+    cur_max[p] = __SEL(pair, cur_max[p]);
+}
+
+void Stats_Update(const int16_t* frame) {
+    uint8_t pairs = stats_config.channels >> 1;
+
+    for (uint8_t p = 0; p < pairs; p++) {
+        Stats_AddPair(p, STATS_PAIR(frame + 2U * p));
+    }
+    if (stats_config.channels & 1U) {
+        /* The lone last channel in both lanes; the high lane is never read */
+        uint16_t last = (uint16_t)frame[2U * pairs];
+        Stats_AddPair(pairs, last | ((uint32_t)last << 16));
+    }
+    if (++cur_count == stats_config.paneSamples) {
+        Stats_ClosePane();
+    }
+}
+
+void Stats_UpdateBlock(const int16_t* frames, uint16_t count) {
+    uint8_t channels = stats_config.channels;
+
+    for (uint16_t i = 0; i < count; i++) {
+        Stats_Update(frames);
+        frames += channels;
+    }
+}
+
+uint32_t Stats_GetPaneCount(void) {
+    return panes_closed;
+}
+
+/* Two passes over the pane means: equal panes make the window mean their
+ * average, and each pane adds n * (its mean - window mean)^2 */
+static void Stats_Merge(uint32_t end, Stats_Channel* channels) {
+    uint8_t panes = stats_config.panes;
+    float n = stats_config.paneSamples;
+    uint32_t first = end - panes;
+
+    for (uint8_t c = 0; c < stats_config.channels; c++) {
+        float sum = 0.0f;
+        for (uint8_t i = 0; i < panes; i++) {
+            sum += pane_mean[(first + i) % STATS_RING][c];
+        }
+        float mean = sum / panes;
+
+        float m2 = 0.0f;
+        int16_t min = INT16_MAX;
+        int16_t max = INT16_MIN;
+        uint8_t shift = (c & 1U) ? 16 : 0;
+        for (uint8_t i = 0; i < panes; i++) {
+            uint32_t slot = (first + i) % STATS_RING;
+            float d = pane_mean[slot][c] - mean;
+            int16_t lo = (int16_t)(pane_min[slot][c >> 1] >> shift);
+            int16_t hi = (int16_t)(pane_max[slot][c >> 1] >> shift);
+            m2 += pane_m2[slot][c] + n * d * d;
+            min = (lo < min) ? lo : min;
+            max = (hi > max) ? hi : max;
+        }
+
+        channels[c].mean = mean;
+        channels[c].variance = m2 / (n * panes);
+        channels[c].rms = sqrtf(mean * mean + channels[c].variance);
+        channels[c].min = min;
+        channels[c].max = max;
+    }
+}
+
+/* The slot of pane q is overwritten while pane q + STATS_RING fills, so
+ * the copy is good if fewer than STATS_RING - panes panes closed after
+ * the window's end by the time it is finished */
+Stats_Error Stats_Snapshot(Stats_Channel* channels, Stats_Window* window) {
+    uint8_t panes = stats_config.panes;
+
+    if (channels == NULL || panes == 0) {
+        return STATS_ERROR_PARAM;
+    }
+    for (uint8_t attempt = 0; attempt < STATS_SNAPSHOT_TRIES; attempt++) {
+        uint32_t closed = panes_closed;
+        uint32_t end = (stats_config.mode == STATS_TUMBLING) ? closed - closed % panes : closed;
+        if (end < panes) {
+            return STATS_ERROR_EMPTY;
+        }
+
+        __DMB();
+        Stats_Merge(end, channels);
+        __DMB();
+
+        if (panes_closed - end < (uint32_t)(STATS_RING - panes)) {
+            if (window != NULL) {
+                window->endPane = end;
+                window->samples = (uint32_t)panes * stats_config.paneSamples;
+            }
+            return STATS_OK;
+        }
+    }
+    return STATS_ERROR_BUSY;
+}
+
+/* ---- Shell command ---- */
+
+#define STATS_BENCH_SEED        777UL
+#define STATS_BENCH_BLOCK       16
+
+static int16_t bench_frames[STATS_BENCH_BLOCK * STATS_MAX_CHANNELS];
+static Stats_Channel bench_result[STATS_MAX_CHANNELS];
+
+/* Channel c: offset (c - 16) * 1000 plus noise of a different width per
+ * channel, from one LCG stepped once per sample */
+static int16_t Stats_BenchSample(uint32_t* seed, uint8_t c) {
+    *seed = *seed * 1664525UL + 1013904223UL;
+    return (int16_t)((c - 16) * 1000 + ((int32_t)*seed >> (18 + c % 6)));
+}
+
+/* Feeds a known stream through a fresh configuration, times it and checks
+ * the sliding window against exact sums over the same samples */
+static void Stats_Bench(uint8_t channels, uint16_t paneSamples, uint8_t panes) {
+    Stats_Config config = { channels, paneSamples, panes, STATS_SLIDING };
+    uint32_t frames = (uint32_t)paneSamples * (panes + 2U) + paneSamples / 2U;
+    uint32_t seed = STATS_BENCH_SEED;
+    uint32_t cycles = 0;
+
+    Stats_Init(&config);
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t done = 0; done < frames; ) {
+        uint16_t block = (frames - done < STATS_BENCH_BLOCK) ? (uint16_t)(frames - done)
+                                                              : STATS_BENCH_BLOCK;
+        for (uint16_t i = 0; i < block * channels; i++) {
+            bench_frames[i] = Stats_BenchSample(&seed, (uint8_t)(i % channels));
+        }
+        uint32_t start = DWT->CYCCNT;
+        Stats_UpdateBlock(bench_frames, block);
+        cycles += DWT->CYCCNT - start;
+        done += block;
+    }
+
+    Stats_Window window;
+    uint32_t start = DWT->CYCCNT;
+    Stats_Error result = Stats_Snapshot(bench_result, &window);
+    uint32_t snapshotCycles = DWT->CYCCNT - start;
+    if (result != STATS_OK) {
+        FMT_Print("winstats: snapshot failed (%u)\r\n", result);
+        return;
+    }
+
+    /* Exact sums over the window's frames, replayed from the seed */
+    uint32_t firstFrame = (window.endPane - panes) * paneSamples;
+    float worstMean = 0.0f;
+    float worstVariance = 0.0f;
+    uint8_t extremes = 0;
+    for (uint8_t c = 0; c < channels; c++) {
+        int64_t sum = 0;
+        int64_t squares = 0;
+        int16_t min = INT16_MAX;
+        int16_t max = INT16_MIN;
+        seed = STATS_BENCH_SEED;
+        for (uint32_t f = 0; f < firstFrame + window.samples; f++) {
+            for (uint8_t k = 0; k < channels; k++) {
+                int16_t v = Stats_BenchSample(&seed, k);
+                if (k == c && f >= firstFrame) {
+                    sum += v;
+                    squares += (int32_t)v * v;
+                    min = (v < min) ? v : min;
+                    max = (v > max) ? v : max;
+                }
+            }
+        }
+        float mean = (float)sum / window.samples;
+        float variance = (float)(squares - sum * sum / (int64_t)window.samples) / window.samples;
+        float e = fabsf(bench_result[c].mean - mean) / (fabsf(mean) + 1.0f);
+        worstMean = (e > worstMean) ? e : worstMean;
+        e = fabsf(bench_result[c].variance - variance) / (variance + 1.0f);
+        worstVariance = (e > worstVariance) ? e : worstVariance;
+        extremes += (bench_result[c].min == min && bench_result[c].max == max);
+    }
+
+    uint32_t centi = (uint32_t)((uint64_t)cycles * 100U / (frames * channels));
+    FMT_Print("winstats: %u channels, %u x %u panes, %lu frames: %lu.%02lu cycles/sample, "
+              "snapshot %lu cycles\r\n", channels, panes, paneSamples, frames,
+              centi / 100, centi % 100, snapshotCycles);
+    FMT_Print("  vs exact sums: mean error %.7f, variance error %.7f, min/max %u/%u equal\r\n",
+              worstMean, worstVariance, extremes, channels);
+}
+
+/* Table rows per shell step, within SHELL_TX_RESERVE */
+#define STATS_ROWS_PER_STEP     4
+
+static Shell_Status Stats_Cmd(int argc, char* argv[]) {
+    static uint8_t next;
+
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        uint32_t channels = STATS_MAX_CHANNELS;
+        if (argc > 3 || (argc == 3 && (!Shell_ParseU32(argv[2], &channels) || channels == 0 ||
+                                       channels > STATS_MAX_CHANNELS))) {
+            return SHELL_ERROR_USAGE;
+        }
+        Stats_Bench((uint8_t)channels, 256, 8);
+        return SHELL_OK;
+    }
+    if (argc != 1) {
+        return SHELL_ERROR_USAGE;
+    }
+
+    /* One snapshot, printed over several steps */
+    if (Shell_GetStep() == 0) {
+        Stats_Window window;
+        Stats_Error result = (stats_config.channels == 0) ? STATS_ERROR_EMPTY
+                                                          : Stats_Snapshot(bench_result, &window);
+        if (result != STATS_OK) {
+            FMT_Print("no complete window (%lu panes closed)\r\n", panes_closed);
+            return (result == STATS_ERROR_EMPTY) ? SHELL_OK : SHELL_ERROR_FAILED;
+        }
+        FMT_Print("window to pane %lu, %lu samples\r\n"
+                  " ch      mean    stddev       rms    min    max\r\n",
+                  window.endPane, window.samples);
+        next = 0;
+    }
+    for (uint8_t n = 0; n < STATS_ROWS_PER_STEP && next < stats_config.channels; n++, next++) {
+        const Stats_Channel* ch = &bench_result[next];
+        FMT_Print("%3u %9.2f %9.2f %9.2f %6d %6d\r\n", next, ch->mean, sqrtf(ch->variance),
+                  ch->rms, ch->min, ch->max);
+    }
+    return (next < stats_config.channels) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("winstats", "[bench [channels]]", "Window statistics snapshot, or a timed self-check",
+              Stats_Cmd);
@@ -0,0 +1,317 @@
+/* @trace.c */
+#include "trace.h"
+#include "uart.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+/* Core clock for the stream header (16 MHz HSI) */
+#define TRACE_CPU_HZ            16000000UL
+
+/* Every payload starts with a continuation byte followed by 0x00, which
+ * never begins a binlog frame, so both can share the UART */
+#define TRACE_MAGIC0            0xFEU
+#define TRACE_MAGIC1            0x00U
+#define TRACE_VERSION           1U
+
+/* Frame kinds, the byte after the magic */
+#define TRACE_KIND_HEADER       'H'     /* version, CPU Hz, base timestamp */
+#define TRACE_KIND_NAME         'N'     /* kind, id, name */
+#define TRACE_KIND_DROPPED      'D'     /* varint count */
+#define TRACE_KIND_EVENTS       'E'     /* type, id, varint delta, varint arg */
+#define TRACE_KIND_STOP         'S'     /* varint events recorded */
+
+#define TRACE_NAME_MAX          32
+
+/* Magic, kind and sequence, then the body. An event takes at most
+ * 2 + 5 + 3 bytes. COBS adds one byte per 254 plus two delimiters. */
+#define TRACE_PAYLOAD_MAX       (4 + TRACE_FRAME_EVENTS * 10)
+#define TRACE_WIRE_MAX          (TRACE_PAYLOAD_MAX + 4)
+
+typedef struct {
+    const char* name;
+    uint8_t kind;
+    uint8_t id;
+} Trace_Name;
+
+Trace_Event trace_ring[TRACE_RING_SLOTS];
+volatile uint32_t trace_head = 0;
+volatile uint32_t trace_tail = 0;
+volatile uint32_t trace_dropped = 0;
+volatile uint8_t trace_enabled = 0;
+
+static Trace_Name names[TRACE_MAX_NAMES];
+static uint8_t name_count = 0;
+
+/* Stream state, owned by Trace_Process() */
+static uint8_t header_pending = 0;
+static uint8_t stop_pending = 0;
+static uint8_t names_sent = 0;
+static uint8_t sequence = 0;
+static uint32_t base_timestamp = 0;
+static uint32_t last_timestamp = 0;
+static uint32_t reported_dropped = 0;
+static uint32_t session_events = 0;
+
+void Trace_Init(void) {
+    /* Cycle counter for timestamps; left running for binlog */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    trace_enabled = 0;
+    trace_head = 0;
+    trace_tail = 0;
+    trace_dropped = 0;
+    header_pending = 0;
+    stop_pending = 0;
+    name_count = 0;
+
+    Trace_SetName(TRACE_NAME_QUEUE, TRACE_QUEUE_UART_RX, "uart_rx");
+    Trace_SetName(TRACE_NAME_MARK, TRACE_MARK_COMMAND, "command");
+    Trace_SetName(TRACE_NAME_IRQ, (uint8_t)(DMA1_Stream3_IRQn + 16), "DMA1_Stream3");
+}
+
+bool Trace_SetName(Trace_NameKind kind, uint8_t id, const char* name) {
+    uint8_t i;
+
+    for (i = 0; i < name_count; i++) {
+        if (names[i].kind == kind && names[i].id == id) {
+            break;
+        }
+    }
+    if (i == TRACE_MAX_NAMES || name == NULL) {
+        return false;
+    }
+
+    names[i].name = name;
+    names[i].kind = (uint8_t)kind;
+    names[i].id = id;
+    if (i == name_count) {
+        name_count++;
+    }
+
+    /* Resend from here if the stream already carried the old table */
+    if (names_sent > i) {
+        names_sent = i;
+    }
+    return true;
+}
+
+void Trace_Start(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    trace_head = 0;
+    trace_tail = 0;
+    trace_dropped = 0;
+    reported_dropped = 0;
+    session_events = 0;
+    names_sent = 0;
+    sequence = 0;
+    base_timestamp = DWT->CYCCNT;
+    last_timestamp = base_timestamp;
+    header_pending = 1;
+    stop_pending = 0;
+    trace_enabled = 1;
+
+    __set_PRIMASK(primask);
+}
+
+void Trace_Stop(void) {
+    if (trace_enabled) {
+        trace_enabled = 0;
+        stop_pending = 1;
+    }
+}
+
+bool Trace_IsRunning(void) {
+    return trace_enabled != 0;
+}
+
+static uint8_t Trace_PutVarint(uint8_t* out, uint32_t value) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint8_t Trace_PutWord(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return 4;
+}
+
+static uint8_t Trace_Begin(uint8_t* payload, uint8_t kind) {
+    payload[0] = TRACE_MAGIC0;
+    payload[1] = TRACE_MAGIC1;
+    payload[2] = kind;
+    payload[3] = sequence;
+    return 4;
+}
+
+/* COBS-encode between two 0x00 delimiters, as binlog.c does, and queue the
+ * frame only if all of it fits */
+static bool Trace_Send(const uint8_t* payload, uint8_t len) {
+    uint8_t frame[TRACE_WIRE_MAX];
+    uint8_t n = 0;
+
+    frame[n++] = 0x00;
+    uint8_t code_pos = n++;
+    uint8_t code = 1;
+    for (uint8_t i = 0; i < len; i++) {
+        if (payload[i] == 0) {
+            frame[code_pos] = code;
+            code_pos = n++;
+            code = 1;
+        } else {
+            frame[n++] = payload[i];
+            code++;
+        }
+    }
+    frame[code_pos] = code;
+    frame[n++] = 0x00;
+
+    if (UART_GetTxFree() < n) {
+        return false;
+    }
+    UART_WriteAsync(frame, n);
+    sequence++;
+    return true;
+}
+
+uint16_t Trace_Process(void) {
+    uint8_t payload[TRACE_PAYLOAD_MAX];
+    uint8_t len;
+    uint16_t sent = 0;
+
+    if (header_pending) {
+        len = Trace_Begin(payload, TRACE_KIND_HEADER);
+        payload[len++] = TRACE_VERSION;
+        len += Trace_PutWord(&payload[len], TRACE_CPU_HZ);
+        len += Trace_PutWord(&payload[len], base_timestamp);
+        if (!Trace_Send(payload, len)) {
+            return 0;
+        }
+        header_pending = 0;
+    }
+
+    while (names_sent < name_count) {
+        const Trace_Name* entry = &names[names_sent];
+        len = Trace_Begin(payload, TRACE_KIND_NAME);
+        payload[len++] = entry->kind;
+        payload[len++] = entry->id;
+        for (uint8_t i = 0; i < TRACE_NAME_MAX && entry->name[i] != '\0'; i++) {
+            payload[len++] = (uint8_t)entry->name[i];
+        }
+        if (!Trace_Send(payload, len)) {
+            return 0;
+        }
+        names_sent++;
+    }
+
+    /* Tell the host how many records it is missing before the next ones */
+    uint32_t dropped = trace_dropped;
+    if (dropped != reported_dropped) {
+        len = Trace_Begin(payload, TRACE_KIND_DROPPED);
+        len += Trace_PutVarint(&payload[len], dropped - reported_dropped);
+        if (!Trace_Send(payload, len)) {
+            return 0;
+        }
+        reported_dropped = dropped;
+    }
+
+    uint32_t head = trace_head;
+    while (trace_tail != head) {
+        uint32_t tail = trace_tail;
+        uint32_t timestamp = last_timestamp;
+        uint8_t count = 0;
+
+        len = Trace_Begin(payload, TRACE_KIND_EVENTS);
+        while (tail != head && count < TRACE_FRAME_EVENTS) {
+            const Trace_Event* ev = &trace_ring[tail & (TRACE_RING_SLOTS - 1)];
+            payload[len++] = (uint8_t)ev->info;
+            payload[len++] = (uint8_t)(ev->info >> 8);
+            len += Trace_PutVarint(&payload[len], ev->timestamp - timestamp);
+            len += Trace_PutVarint(&payload[len], ev->info >> 16);
+            timestamp = ev->timestamp;
+            tail++;
+            count++;
+        }
+
+        if (!Trace_Send(payload, len)) {
+            break;
+        }
+        last_timestamp = timestamp;
+        trace_tail = tail;
+        session_events += count;
+        sent += count;
+    }
+
+    if (stop_pending && trace_tail == trace_head) {
+        len = Trace_Begin(payload, TRACE_KIND_STOP);
+        len += Trace_PutVarint(&payload[len], session_events);
+        if (Trace_Send(payload, len)) {
+            stop_pending = 0;
+        }
+    }
+
+    return sent;
+}
+
+uint32_t Trace_MeasureCost(void) {
+    uint8_t was_enabled = trace_enabled;
+    uint32_t best = UINT32_MAX;
+
+    trace_enabled = 1;
+    for (uint32_t attempt = 0; attempt < 8; attempt++) {
+        trace_head = 0;
+        trace_tail = 0;
+
+        /* Interrupts may land in any attempt, keep the fastest */
+        uint32_t start = DWT->CYCCNT;
+        uint32_t empty = DWT->CYCCNT - start;
+        start = DWT->CYCCNT;
+        TRACE_MARK(TRACE_MARK_USER, attempt);
+        TRACE_MARK(TRACE_MARK_USER, attempt);
+        TRACE_MARK(TRACE_MARK_USER, attempt);
+        TRACE_MARK(TRACE_MARK_USER, attempt);
+        uint32_t cycles = (DWT->CYCCNT - start - empty) / 4;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+
+    trace_head = 0;
+    trace_tail = 0;
+    trace_enabled = was_enabled;
+    return best;
+}
+
+static Shell_Status Trace_Cmd(int argc, char* argv[]) {
+    bool start;
+
+    if (argc == 1) {
+        start = !Trace_IsRunning();
+    } else if (argc == 2 && strcmp(argv[1], "start") == 0) {
+        start = true;
+    } else if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+        start = false;
+    } else {
+        return SHELL_ERROR_USAGE;
+    }
+
+    if (start && !Trace_IsRunning()) {
+        FMT_Print("Tracing, %lu cycles per event\r\n", Trace_MeasureCost());
+        Trace_Start();
+    } else if (!start && Trace_IsRunning()) {
+        Trace_Stop();
+    }
+    return SHELL_OK;
+}
+SHELL_COMMAND("trace", "[start|stop]", "Stream trace frames, toggles without an argument", Trace_Cmd);
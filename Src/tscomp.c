@@ -0,0 +1,161 @@
+/* @tscomp.c */
+#include "tscomp.h"
+#include <stddef.h>
+#include <string.h>
+
+static Tsc_Config tsc_config;
+static Tsc_Stats tsc_stats;
+
+static uint8_t packet[TSC_MAX_PACKET];
+static uint16_t pos;
+static uint16_t count;
+static uint8_t sequence;
+static uint16_t max_sample;
+
+/* Coding state, back to zero with each packet */
+static uint32_t first_ts;
+static uint32_t prev_ts;
+static uint32_t prev_delta;
+static uint32_t prev_value[TSC_MAX_CHANNELS];
+
+static void Tsc_Start(void) {
+    pos = TSC_HEADER_SIZE;
+    count = 0;
+    prev_ts = 0;
+    prev_delta = 0;
+    memset(prev_value, 0, sizeof(prev_value));
+}
+
+Tsc_Error Tsc_Init(const Tsc_Config* config) {
+    if (config == NULL || config->callback == NULL || config->channels == 0 ||
+        config->channels > TSC_MAX_CHANNELS || config->packetSize > TSC_MAX_PACKET ||
+        config->packetSize < TSC_MIN_PACKET ||
+        config->packetSize < TSC_HEADER_SIZE + TSC_MAX_SAMPLE(config->channels) ||
+        (config->channels < 16 && (config->floatMask >> config->channels) != 0)) {
+        return TSC_ERROR_PARAM;
+    }
+    tsc_config = *config;
+    max_sample = (uint16_t)TSC_MAX_SAMPLE(config->channels);
+    memset(&tsc_stats, 0, sizeof(tsc_stats));
+    sequence = 0;
+    Tsc_Start();
+    return TSC_OK;
+}
+
+static inline uint8_t* Tsc_Varint(uint8_t* p, uint32_t value) {
+    while (value >= 0x80U) {
+        *p++ = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+/* Signed to unsigned with the sign in bit 0: 0, -1, 1, -2 -> 0, 1, 2, 3 */
+static inline uint32_t Tsc_Zigzag(uint32_t value) {
+    return (value << 1) ^ (uint32_t)((int32_t)value >> 31);
+}
+
+/* CLZ, and RBIT + CLZ on the M4, give the zero bytes at either end */
+static inline uint8_t* Tsc_Xor(uint8_t* p, uint32_t x) {
+    if (x == 0) {
+        *p++ = 0;
+        return p;
+    }
+    uint32_t trail = (uint32_t)__builtin_ctz(x) >> 3;
+    uint32_t bytes = 4U - ((uint32_t)__builtin_clz(x) >> 3) - trail;
+    *p++ = (uint8_t)((trail << 4) | bytes);
+    x >>= 8U * trail;
+    do {
+        *p++ = (uint8_t)x;
+        x >>= 8;
+    } while (--bytes != 0);
+    return p;
+}
+
+static uint8_t* Tsc_Encode(uint8_t* p, uint32_t timestamp, const uint32_t* values) {
+    if (count == 0) {
+        first_ts = timestamp;
+        p = Tsc_Varint(p, timestamp);
+    } else {
+        uint32_t delta = timestamp - prev_ts;
+        p = Tsc_Varint(p, Tsc_Zigzag(delta - prev_delta));
+        prev_delta = delta;
+    }
+    prev_ts = timestamp;
+
+    uint32_t floats = tsc_config.floatMask;
+    for (uint8_t c = 0; c < tsc_config.channels; c++, floats >>= 1) {
+        uint32_t v = values[c];
+        if (floats & 1U) {
+            p = Tsc_Xor(p, v ^ prev_value[c]);
+        } else {
+            p = Tsc_Varint(p, Tsc_Zigzag(v - prev_value[c]));
+        }
+        prev_value[c] = v;
+    }
+    return p;
+}
+
+static void Tsc_Send(void) {
+    uint16_t size = tsc_config.packetSize;
+
+    packet[0] = TSC_MAGIC;
+    packet[1] = sequence++;
+    packet[2] = (uint8_t)pos;
+    packet[3] = (uint8_t)(pos >> 8);
+    packet[4] = (uint8_t)count;
+    packet[5] = (uint8_t)(count >> 8);
+    packet[6] = tsc_config.channels;
+    packet[7] = 0;
+    packet[8] = (uint8_t)tsc_config.floatMask;
+    packet[9] = (uint8_t)(tsc_config.floatMask >> 8);
+    memset(packet + pos, 0, size - pos);
+
+    tsc_stats.packets++;
+    tsc_stats.usedBytes += pos;
+    tsc_stats.sentBytes += size;
+    tsc_config.callback(packet, size);
+    Tsc_Start();
+}
+
+void Tsc_Flush(void) {
+    if (count != 0) {
+        Tsc_Send();
+    }
+}
+
+void Tsc_Poll(uint32_t now) {
+    if (count != 0 && tsc_config.flushTicks != 0 && now - first_ts >= tsc_config.flushTicks) {
+        tsc_stats.latencyFlushes++;
+        Tsc_Send();
+    }
+}
+
+void Tsc_Add(uint32_t timestamp, const uint32_t* values) {
+    Tsc_Poll(timestamp);
+
+    /* Straight into the packet when even the longest sample fits, else
+     * through scratch, and into a new packet if it did not fit after all.
+     * Coding against the new packet's zero state replaces the state the
+     * failed attempt left. */
+    if (tsc_config.packetSize - pos >= max_sample) {
+        pos = (uint16_t)(Tsc_Encode(packet + pos, timestamp, values) - packet);
+    } else {
+        uint8_t scratch[TSC_MAX_SAMPLE(TSC_MAX_CHANNELS)];
+        uint16_t size = (uint16_t)(Tsc_Encode(scratch, timestamp, values) - scratch);
+        if (size <= tsc_config.packetSize - pos) {
+            memcpy(packet + pos, scratch, size);
+            pos += size;
+        } else {
+            Tsc_Send();
+            pos = (uint16_t)(Tsc_Encode(packet + pos, timestamp, values) - packet);
+        }
+    }
+    count++;
+    tsc_stats.samples++;
+}
+
+void Tsc_GetStats(Tsc_Stats* stats) {
+    *stats = tsc_stats;
+}
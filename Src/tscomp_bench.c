@@ -0,0 +1,95 @@
+/* @tscomp_bench.c - Cycles and compression of tscomp.c on a generated stream */
+#include "tscomp.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+
+/* Three accelerometer axes at 1 kHz in ms: gravity on z, a 40 Hz
+ * vibration on x, LCG noise of +-8 counts, and a late sample every 64 */
+#define TSCB_SEED               31337UL
+#define TSCB_SAMPLES            4000
+#define TSCB_CHUNK              500
+#define TSCB_CHANNELS           3
+#define TSCB_PACKET             128
+#define TSCB_FLUSH_MS           250
+#define TSCB_BAUD               115200UL
+
+static uint32_t tscb_checksum;
+
+/* Stands in for the uplink: FNV-1a over every packet byte */
+static void Tscb_Packet(const uint8_t* data, uint16_t size) {
+    while (size--) {
+        tscb_checksum = (tscb_checksum ^ *data++) * 0x01000193UL;
+    }
+}
+
+static void Tscb_Sample(uint32_t n, uint32_t* seed, uint32_t* values) {
+    int32_t phase = (int32_t)(n % 25);
+    int32_t vibration = ((phase < 13) ? phase : 25 - phase) * 40 - 240;
+
+    for (uint8_t c = 0; c < TSCB_CHANNELS; c++) {
+        *seed = *seed * 1664525UL + 1013904223UL;
+        values[c] = (uint32_t)((int32_t)*seed >> 28);
+    }
+    values[0] += (uint32_t)vibration;
+    values[2] += 16384U;
+}
+
+bool Tsc_BenchmarkStep(uint32_t step) {
+    static Tsc_Config config = { TSCB_CHANNELS, 0, TSCB_PACKET, TSCB_FLUSH_MS, Tscb_Packet };
+    static uint32_t seed;
+    static uint32_t cycles;
+    uint32_t values[TSCB_CHANNELS];
+    Tsc_Stats stats;
+
+    if (step == 0) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        tscb_checksum = 0x811C9DC5UL;
+        seed = TSCB_SEED;
+        cycles = 0;
+        Tsc_Init(&config);
+    }
+
+    /* TSCB_CHUNK samples per step */
+    if (step < TSCB_SAMPLES / TSCB_CHUNK) {
+        for (uint32_t n = step * TSCB_CHUNK; n < (step + 1) * TSCB_CHUNK; n++) {
+            Tscb_Sample(n, &seed, values);
+            uint32_t start = DWT->CYCCNT;
+            Tsc_Add(n + ((n % 64U) == 63U), values);
+            cycles += DWT->CYCCNT - start;
+        }
+        return true;
+    }
+
+    if (step == TSCB_SAMPLES / TSCB_CHUNK) {
+        Tsc_Flush();
+    }
+    Tsc_GetStats(&stats);
+
+    /* Raw: a 32-bit timestamp and 16 bits per axis */
+    uint32_t raw = stats.samples * (4U + 2U * TSCB_CHANNELS);
+    if (step == TSCB_SAMPLES / TSCB_CHUNK) {
+        uint32_t centi = (uint32_t)((uint64_t)cycles * 100U / stats.samples);
+        uint32_t perSample = (uint32_t)((uint64_t)stats.sentBytes * 100U / stats.samples);
+        FMT_Print("tscomp: %lu samples x %u axes, %lu.%02lu cycles/sample\r\n", stats.samples,
+                  TSCB_CHANNELS, centi / 100, centi % 100);
+        FMT_Print("  %lu packets of %u bytes (%lu used), %lu.%02lu bytes/sample, "
+                  "%lu raw: ratio %lu.%02lu\r\n", stats.packets, TSCB_PACKET, stats.usedBytes,
+                  perSample / 100, perSample % 100, raw, raw / stats.sentBytes,
+                  (uint32_t)((uint64_t)raw * 100U / stats.sentBytes) % 100);
+        return true;
+    }
+    FMT_Print("  %lu samples/s fit %lu baud (%lu raw), packets %08lx\r\n",
+              (uint32_t)((uint64_t)TSCB_BAUD / 10U * stats.samples / stats.sentBytes), TSCB_BAUD,
+              (uint32_t)(TSCB_BAUD / 10U * stats.samples / raw), tscb_checksum);
+    return false;
+}
+
+/* One chunk of samples, or part of the report, per call */
+static Shell_Status Tscb_Cmd(int argc, char* argv[]) {
+    return Tsc_BenchmarkStep(Shell_GetStep()) ? SHELL_MORE : SHELL_OK;
+}
+SHELL_COMMAND("tscbench", "", "Time-series compression cycles and ratio on a generated stream",
+              Tscb_Cmd);
@@ -1,9 +1,150 @@
 #include "uart.h"
 #include "systick.h"
+#include "trace.h"
 #include <stddef.h>
 
-/* Global variable for SysTick counter */
+/* TX ring: head is advanced by writers, tail by the TXE or DMA interrupt */
+static volatile uint8_t tx_ring[UART_TX_RING_SIZE];
+static volatile uint16_t tx_head = 0;
+static volatile uint16_t tx_tail = 0;
 
+/* RX ring: head is advanced by the RXNE or DMA interrupt, tail by readers */
+static volatile uint8_t rx_ring[UART_RX_RING_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+
+volatile uint32_t uart_rx_overflows = 0;
+
+static volatile UART_RxCallback rx_callback = NULL;
+
+/* USART3_TX is DMA1 Stream 3 channel 4 (RM0090 table 42) */
+#define UART_TX_DMA_STREAM      DMA1_Stream3
+#define UART_TX_DMA_CHANNEL     4U
+#define UART_TX_DMA_FLAGS       (DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | \
+                                 DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3)
+
+/* USART3_RX is DMA1 Stream 1 channel 4 */
+#define UART_RX_DMA_STREAM      DMA1_Stream1
+#define UART_RX_DMA_CHANNEL     4U
+#define UART_RX_DMA_FLAGS       (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 | \
+                                 DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1)
+
+/* Ring blocks handed to the TX stream; half the ring, so writers can fill
+ * one half while the other goes out */
+#define UART_TX_DMA_BLOCK       (UART_TX_RING_SIZE / 2)
+
+static volatile uint8_t tx_dma_busy = 0;
+
+/* Chain being sent by UART_WriteChainDMA: the iterator is past the segment
+ * in flight, and the chain is freed after the last */
+static PBuf* volatile tx_chain = NULL;
+static PBuf_Iterator tx_chain_it;
+
+/* TX ring drained by DMA: tx_dma_len bytes from tx_tail are in flight */
+static volatile uint8_t tx_ring_dma = 0;
+static volatile uint16_t tx_dma_len = 0;
+
+/* RX ring filled by DMA: the stream writes [rx_head, rx_head + rx_dma_len)
+ * and stops at the ring's wrap or the reader's tail. rx_dma_len is 0 while
+ * the ring is full; RXNE then stays set, which holds RTS off. */
+static volatile uint8_t rx_ring_dma = 0;
+static volatile uint16_t rx_dma_len = 0;
+
+/* Received bytes so far, those the running RX transfer has stored included */
+static uint16_t Uart_RxHead(void) {
+    if (!rx_ring_dma) {
+        return rx_head;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint16_t head = rx_head;
+    if (rx_dma_len != 0) {
+        head += rx_dma_len - (uint16_t)UART_RX_DMA_STREAM->NDTR;
+    }
+    __set_PRIMASK(primask);
+    return head;
+}
+
+/* Next RX transfer, into the free part of the ring up to its wrap; with
+ * interrupts off or from the stream's interrupt */
+static void Uart_RxDmaStart(void) {
+    uint16_t index = rx_head & (UART_RX_RING_SIZE - 1);
+    uint16_t len = UART_RX_RING_SIZE - index;
+    uint16_t space = UART_RX_RING_SIZE - (uint16_t)(rx_head - rx_tail);
+
+    if (len > space) {
+        len = space;
+    }
+    rx_dma_len = len;
+    if (len == 0) {
+        return;
+    }
+
+    DMA1->LIFCR = UART_RX_DMA_FLAGS;
+    UART_RX_DMA_STREAM->M0AR = (uint32_t)&rx_ring[index];
+    UART_RX_DMA_STREAM->NDTR = len;
+    UART_RX_DMA_STREAM->CR = (UART_RX_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) |
+                             DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    UART_RX_DMA_STREAM->CR |= DMA_SxCR_EN;
+    /* Setting DMAR again requests a byte already waiting in DR */
+    USART3->CR3 |= USART_CR3_DMAR;
+}
+
+/* After a read made room: restart a transfer stopped by a full ring */
+static void Uart_RxDmaResume(void) {
+    if (rx_ring_dma && rx_dma_len == 0) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (rx_dma_len == 0) {
+            Uart_RxDmaStart();
+        }
+        __set_PRIMASK(primask);
+    }
+}
+
+/* Start DMA1 Stream 3 on size bytes; the caller has checked it is idle */
+static void Uart_TxDmaStart(const volatile uint8_t* data, uint16_t size) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+
+    /* The stream only accepts a new setup once EN reads back as 0 */
+    UART_TX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (UART_TX_DMA_STREAM->CR & DMA_SxCR_EN);
+    DMA1->LIFCR = UART_TX_DMA_FLAGS;
+
+    UART_TX_DMA_STREAM->PAR = (uint32_t)&USART3->DR;
+    UART_TX_DMA_STREAM->M0AR = (uint32_t)data;
+    UART_TX_DMA_STREAM->NDTR = size;
+    UART_TX_DMA_STREAM->FCR = 0;  /* Direct mode, byte to byte */
+    UART_TX_DMA_STREAM->CR = (UART_TX_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) |
+                             DMA_SxCR_MINC | DMA_SxCR_DIR_0 |
+                             DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+
+    tx_dma_busy = 1;
+    NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+
+    UART_TX_DMA_STREAM->CR |= DMA_SxCR_EN;
+    USART3->CR3 |= USART_CR3_DMAT;
+}
+
+/* Next block of the TX ring, up to its wrap; with interrupts off or from
+ * the stream's interrupt */
+static void Uart_TxRingKick(void) {
+    uint16_t index = tx_tail & (UART_TX_RING_SIZE - 1);
+    uint16_t len = UART_TX_RING_SIZE - index;
+    uint16_t count = (uint16_t)(tx_head - tx_tail);
+
+    if (len > count) {
+        len = count;
+    }
+    if (len > UART_TX_DMA_BLOCK) {
+        len = UART_TX_DMA_BLOCK;
+    }
+    if (len != 0) {
+        tx_dma_len = len;
+        Uart_TxDmaStart(&tx_ring[index], len);
+    }
+}
 
 /**
  * @file uart.c
@@ -59,6 +200,9 @@ void UART_Init(uint32_t baud)
     USART3->CR1 |= USART_CR1_UE;
 }
 void UART_SendString(const char* str) {
+    /* Let queued asynchronous output go first so the two never interleave */
+    while (tx_head != tx_tail || tx_dma_busy);
+
     /* Send characters until null terminator is reached */
     while (*str) {
         /* Wait until transmit data register is empty */
@@ -90,6 +234,20 @@ UART_Error UART_InitConfig(UART_Config* config) {
     GPIOD->AFR[1] |= (7 << 0); /* PD8 = AF7 (USART3_TX) */
     GPIOD->AFR[1] |= (7 << 4); /* PD9 = AF7 (USART3_RX) */
 
+    /* Flow control pins, only when used: PD11 may be wired to something else */
+    if (config->hwFlowControl & UART_HWCONTROL_CTS) {
+        GPIOD->MODER &= ~GPIO_MODER_MODER11_0;
+        GPIOD->MODER |= GPIO_MODER_MODER11_1;
+        GPIOD->AFR[1] &= ~(0xF << 12); /* Clear PD11 AF bits */
+        GPIOD->AFR[1] |= (7 << 12); /* PD11 = AF7 (USART3_CTS) */
+    }
+    if (config->hwFlowControl & UART_HWCONTROL_RTS) {
+        GPIOD->MODER &= ~GPIO_MODER_MODER12_0;
+        GPIOD->MODER |= GPIO_MODER_MODER12_1;
+        GPIOD->AFR[1] &= ~(0xF << 16); /* Clear PD12 AF bits */
+        GPIOD->AFR[1] |= (7 << 16); /* PD12 = AF7 (USART3_RTS) */
+    }
+
     /* Disable USART before configuration */
     USART3->CR1 &= ~USART_CR1_UE;
 
@@ -208,6 +366,18 @@ UART_Error UART_Receive(char* buffer, uint16_t size, uint32_t timeout) {
     /* Record start time for timeout */
     uint32_t startTime = systick_counter;
 
+    /* With the RX interrupt or DMA running, collect from the ring instead */
+    if ((USART3->CR1 & USART_CR1_RXNEIE) || rx_ring_dma) {
+        uint16_t received = 0;
+        while (received < size) {
+            received += UART_ReadAsync((uint8_t*)&buffer[received], size - received);
+            if (received < size && (systick_counter - startTime) > timeout) {
+                return UART_ERROR_TIMEOUT;
+            }
+        }
+        return UART_OK;
+    }
+
     /* Receive data byte by byte */
     for (uint16_t i = 0; i < size; i++) {
         /* Wait for RXNE flag with timeout */
@@ -237,6 +407,10 @@ UART_Error UART_Receive(char* buffer, uint16_t size, uint32_t timeout) {
     return UART_OK;
 }
 bool UART_IsDataAvailable(void) {
+    /* With the RX interrupt running, the ISR owns DR */
+    if ((USART3->CR1 & USART_CR1_RXNEIE) || rx_ring_dma) {
+        return Uart_RxHead() != rx_tail;
+    }
     return (USART3->SR & USART_SR_RXNE) ? true : false;
 }
 
@@ -266,6 +440,17 @@ UART_Error UART_SendByte(uint8_t byte) {
 /* Returns 0 on timeout - check UART_IsDataAvailable() first for safety */
 uint8_t UART_ReceiveByte(void) {
     uint32_t startTime = systick_counter;
+
+    if ((USART3->CR1 & USART_CR1_RXNEIE) || rx_ring_dma) {
+        uint8_t byte;
+        while (UART_ReadAsync(&byte, 1) == 0) {
+            if ((systick_counter - startTime) > 1000) {
+                return 0;  /* Timeout - could be valid data or error */
+            }
+        }
+        return byte;
+    }
+
     while (!(USART3->SR & USART_SR_RXNE)) {
         if ((systick_counter - startTime) > 1000) {
             return 0;  /* Timeout - could be valid data or error */
@@ -366,3 +551,308 @@ UART_Error UART_UpdateBaudRate(uint32_t newBaudRate) {
     return UART_OK;
 }
 
+uint16_t UART_WriteAsync(const uint8_t* data, uint16_t size) {
+    if (data == NULL || size == 0) {
+        return 0;
+    }
+
+    /* Writers may be preempted by other writers (ISRs), so claim the
+     * space and copy in one go */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint16_t space = UART_TX_RING_SIZE - (uint16_t)(tx_head - tx_tail);
+    if (size > space) {
+        size = space;
+    }
+
+    uint16_t head = tx_head;
+    for (uint16_t i = 0; i < size; i++) {
+        tx_ring[(head + i) & (UART_TX_RING_SIZE - 1)] = data[i];
+    }
+    tx_head = head + size;
+
+    /* A DMA transfer owns DR; its completion interrupt starts the ring */
+    if (size != 0 && !tx_dma_busy) {
+        if (tx_ring_dma) {
+            Uart_TxRingKick();
+        } else {
+            USART3->CR1 |= USART_CR1_TXEIE;
+            NVIC_EnableIRQ(USART3_IRQn);
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return size;
+}
+
+uint16_t UART_GetTxFree(void) {
+    return UART_TX_RING_SIZE - (uint16_t)(tx_head - tx_tail);
+}
+
+bool UART_IsTxIdle(void) {
+    return tx_head == tx_tail;
+}
+
+void UART_StartReceiveIT(void) {
+    rx_tail = rx_head;
+    USART3->CR1 |= USART_CR1_RXNEIE;
+    NVIC_EnableIRQ(USART3_IRQn);
+}
+
+uint16_t UART_ReadAsync(uint8_t* buffer, uint16_t size) {
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    uint16_t count = (uint16_t)(Uart_RxHead() - rx_tail);
+    if (size > count) {
+        size = count;
+    }
+
+    uint16_t tail = rx_tail;
+    for (uint16_t i = 0; i < size; i++) {
+        buffer[i] = rx_ring[(tail + i) & (UART_RX_RING_SIZE - 1)];
+    }
+    rx_tail = tail + size;
+
+    if (size != 0) {
+        TRACE_QUEUE_RECV(TRACE_QUEUE_UART_RX, rx_head - rx_tail);
+        Uart_RxDmaResume();
+    }
+
+    return size;
+}
+
+uint16_t UART_GetRxCount(void) {
+    return (uint16_t)(Uart_RxHead() - rx_tail);
+}
+
+uint16_t UART_PeekRx(const uint8_t** data) {
+    return UART_PeekRxAt(0, data);
+}
+
+uint16_t UART_PeekRxAt(uint16_t offset, const uint8_t** data) {
+    uint16_t tail = rx_tail;
+    uint16_t count = (uint16_t)(Uart_RxHead() - tail);
+    uint16_t index = (uint16_t)(tail + offset) & (UART_RX_RING_SIZE - 1);
+
+    count = (offset < count) ? count - offset : 0;
+
+    /* The ISR and the DMA only write past the head, so these bytes stay put */
+    if (count > UART_RX_RING_SIZE - index) {
+        count = UART_RX_RING_SIZE - index;
+    }
+    *data = (const uint8_t*)&rx_ring[index];
+    return count;
+}
+
+void UART_ConsumeRx(uint16_t size) {
+    rx_tail += size;
+    if (size != 0) {
+        TRACE_QUEUE_RECV(TRACE_QUEUE_UART_RX, rx_head - rx_tail);
+        Uart_RxDmaResume();
+    }
+}
+
+void UART_StopReceiveIT(void) {
+    USART3->CR1 &= ~USART_CR1_RXNEIE;
+}
+
+UART_Error UART_WriteDMA(const uint8_t* data, uint16_t size) {
+    if (data == NULL || size == 0) {
+        return UART_ERROR_BUSY;
+    }
+
+    if (tx_dma_busy || tx_head != tx_tail) {
+        return UART_ERROR_BUSY;
+    }
+
+    Uart_TxDmaStart(data, size);
+    return UART_OK;
+}
+
+UART_Error UART_WriteChainDMA(PBuf* chain) {
+    const uint8_t* addr;
+    uint16_t len;
+
+    if (chain == NULL) {
+        return UART_ERROR_BUSY;
+    }
+
+    if (tx_dma_busy || tx_head != tx_tail) {
+        return UART_ERROR_BUSY;
+    }
+
+    PBuf_IterInit(&tx_chain_it, chain);
+    if (!PBuf_IterNext(&tx_chain_it, &addr, &len)) {
+        /* Nothing in it to send */
+        PBuf_Free(chain);
+        return UART_OK;
+    }
+    tx_chain = chain;
+    Uart_TxDmaStart(addr, len);
+    return UART_OK;
+}
+
+bool UART_IsTxDmaBusy(void) {
+    return tx_dma_busy != 0;
+}
+
+void UART_SetRxCallback(UART_RxCallback callback) {
+    rx_callback = callback;
+}
+
+void UART_StartTransmitDMA(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* Whatever the TXE interrupt has not sent yet goes by DMA */
+    USART3->CR1 &= ~USART_CR1_TXEIE;
+    tx_ring_dma = 1;
+    if (!tx_dma_busy) {
+        Uart_TxRingKick();
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void UART_StopTransmitDMA(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* A block in flight finishes; its interrupt hands the rest to TXE */
+    tx_ring_dma = 0;
+    if (!tx_dma_busy && tx_head != tx_tail) {
+        USART3->CR1 |= USART_CR1_TXEIE;
+        NVIC_EnableIRQ(USART3_IRQn);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void UART_StartReceiveDMA(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    USART3->CR1 &= ~USART_CR1_RXNEIE;
+
+    UART_RX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (UART_RX_DMA_STREAM->CR & DMA_SxCR_EN);
+    UART_RX_DMA_STREAM->PAR = (uint32_t)&USART3->DR;
+    UART_RX_DMA_STREAM->FCR = 0;  /* Direct mode, byte to byte */
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    rx_ring_dma = 1;
+    Uart_RxDmaStart();
+    __set_PRIMASK(primask);
+
+    NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+}
+
+void UART_StopReceiveDMA(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    USART3->CR3 &= ~USART_CR3_DMAR;
+    UART_RX_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    while (UART_RX_DMA_STREAM->CR & DMA_SxCR_EN);
+
+    /* Keep what the stopped transfer stored */
+    rx_head = Uart_RxHead();
+    rx_dma_len = 0;
+    rx_ring_dma = 0;
+    DMA1->LIFCR = UART_RX_DMA_FLAGS;
+
+    __set_PRIMASK(primask);
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+    const uint8_t* addr;
+    uint16_t len;
+
+    TRACE_ISR_ENTER();
+
+    /* Transfer complete or bus error: either way the stream has stopped */
+    DMA1->LIFCR = UART_TX_DMA_FLAGS;
+    USART3->CR3 &= ~USART_CR3_DMAT;
+    tx_dma_busy = 0;
+
+    /* A block of the ring has been sent */
+    tx_tail += tx_dma_len;
+    tx_dma_len = 0;
+
+    /* The next segment of a chain; ring output waits for its end */
+    if (tx_chain != NULL && PBuf_IterNext(&tx_chain_it, &addr, &len)) {
+        Uart_TxDmaStart(addr, len);
+    } else {
+        if (tx_chain != NULL) {
+            PBuf_Free(tx_chain);
+            tx_chain = NULL;
+        }
+
+        /* Ring output queued during the transfer goes out now */
+        if (tx_head != tx_tail) {
+            if (tx_ring_dma) {
+                Uart_TxRingKick();
+            } else {
+                USART3->CR1 |= USART_CR1_TXEIE;
+            }
+        }
+    }
+
+    TRACE_ISR_EXIT();
+}
+
+void DMA1_Stream1_IRQHandler(void) {
+    TRACE_ISR_ENTER();
+
+    /* The transfer reached the wrap or the reader's tail, or hit a bus
+     * error; UART_StopReceiveDMA may have taken it already */
+    DMA1->LIFCR = UART_RX_DMA_FLAGS;
+    if (rx_dma_len != 0) {
+        rx_head += rx_dma_len - (uint16_t)UART_RX_DMA_STREAM->NDTR;
+        TRACE_QUEUE_SEND(TRACE_QUEUE_UART_RX, rx_head - rx_tail);
+        Uart_RxDmaStart();
+        if (rx_callback != NULL) {
+            rx_callback();
+        }
+    }
+
+    TRACE_ISR_EXIT();
+}
+
+void USART3_IRQHandler(void) {
+    uint32_t sr = USART3->SR;
+
+    /* Move received bytes into the RX ring; reading DR also clears ORE */
+    if ((sr & (USART_SR_RXNE | USART_SR_ORE)) && (USART3->CR1 & USART_CR1_RXNEIE)) {
+        uint8_t byte = (uint8_t)(USART3->DR & 0xFF);
+        if ((uint16_t)(rx_head - rx_tail) < UART_RX_RING_SIZE) {
+            rx_ring[rx_head & (UART_RX_RING_SIZE - 1)] = byte;
+            rx_head++;
+            TRACE_QUEUE_SEND(TRACE_QUEUE_UART_RX, rx_head - rx_tail);
+            if (rx_callback != NULL) {
+                rx_callback();
+            }
+        } else {
+            uart_rx_overflows++;
+        }
+    }
+
+    /* Handle TC interrupt - not used by the driver, keep it from re-firing */
+    if ((sr & USART_SR_TC) && (USART3->CR1 & USART_CR1_TCIE)) {
+        USART3->CR1 &= ~USART_CR1_TCIE;
+    }
+
+    /* Feed the transmitter from the TX ring */
+    if ((sr & USART_SR_TXE) && (USART3->CR1 & USART_CR1_TXEIE)) {
+        if (tx_tail != tx_head) {
+            USART3->DR = tx_ring[tx_tail & (UART_TX_RING_SIZE - 1)];
+            tx_tail++;
+        } else {
+            /* Ring drained, stop TXE from firing continuously */
+            USART3->CR1 &= ~USART_CR1_TXEIE;
+        }
+    }
+}
@@ -0,0 +1,351 @@
+/* @uart_bench.c - Non-interactive UART benchmark matrix with CSV/JSON records */
+#include "uart_bench.h"
+#include "uart.h"
+#include "systick.h"
+#include "fmt.h"
+#include "shell.h"
+#include "stm32f4xx.h"
+
+#define BENCH_CPU_HZ            16000000UL
+#define BENCH_TIMEOUT_MS        10000
+#define BENCH_SETTLE_MS         3       /* Covers the last looped-back frame at 9600 baud */
+#define BENCH_CALIBRATE_PASSES  2000
+#define BENCH_FRAME_BITS        10      /* 8N1 */
+
+static const uint32_t default_bauds[] = { 115200, 460800, 921600 };
+static const uint16_t default_chunks[] = { 1, 16, 64, 256, 1024, 4096 };
+
+static const char* const mode_names[UART_BENCH_MODE_COUNT] = { "polling", "irq", "dma" };
+
+static const char csv_header[] =
+    "mode,baud,chunk,bytes,elapsed_us,throughput_Bps,line_pct,cpu_pct,call_cycles,calls,"
+    "rx_lost,rx_loss_pct";
+
+/* Sent by every driver call; in SRAM so DMA1 can read it */
+static uint8_t payload[UART_BENCH_MAX_CHUNK];
+static uint8_t rx_scratch[64];
+
+/* Cycles one idle pass takes, 24.8 fixed point */
+static uint32_t idle_cycles_q8 = 0;
+static bool loopback = false;
+
+/* Matrix being run by UartBench_Step() */
+static UartBench_Config bench_config;
+static uint32_t bench_next = 0;
+static uint32_t bench_cases = 0;
+static bool bench_ended = false;
+static bool bench_started = false;      /* The "bench" command's run */
+
+typedef struct {
+    uint32_t idle;          /* Passes that found nothing to do */
+    uint32_t received;      /* Bytes read back so far */
+} Bench_Loop;
+
+static uint32_t Bench_DrainRx(UartBench_Mode mode) {
+    uint32_t count = 0;
+
+    if (mode == UART_BENCH_POLLING) {
+        /* RXNEIE is off, so these read SR/DR directly */
+        while (UART_IsDataAvailable()) {
+            (void)UART_ReceiveByte();
+            count++;
+        }
+    } else {
+        uint16_t got;
+        while ((got = UART_ReadAsync(rx_scratch, sizeof(rx_scratch))) != 0) {
+            count += got;
+        }
+    }
+    return count;
+}
+
+/* What the CPU does while waiting on the driver: read RX, otherwise idle.
+ * Calibration times exactly this with nothing arriving. */
+static void Bench_Idle(Bench_Loop* loop, UartBench_Mode mode) {
+    uint32_t got = Bench_DrainRx(mode);
+    loop->received += got;
+    if (got == 0) {
+        loop->idle++;
+    }
+}
+
+static void Bench_Calibrate(void) {
+    Bench_Loop loop = { 0, 0 };
+
+    UART_StartReceiveIT();
+    uint32_t start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < BENCH_CALIBRATE_PASSES; i++) {
+        Bench_Idle(&loop, UART_BENCH_IRQ);
+    }
+    uint32_t elapsed = DWT->CYCCNT - start;
+
+    idle_cycles_q8 = (elapsed << 8) / BENCH_CALIBRATE_PASSES;
+}
+
+static bool Bench_DetectLoopback(void) {
+    UART_StartReceiveIT();
+    UART_SendByte(0x55);
+    SysTick_Delay(BENCH_SETTLE_MS);
+
+    bool looped = Bench_DrainRx(UART_BENCH_IRQ) != 0;
+    return looped;
+}
+
+void UartBench_DefaultConfig(UartBench_Config* config) {
+    config->bauds = default_bauds;
+    config->baudCount = sizeof(default_bauds) / sizeof(default_bauds[0]);
+    config->chunks = default_chunks;
+    config->chunkCount = sizeof(default_chunks) / sizeof(default_chunks[0]);
+    config->modeMask = (1U << UART_BENCH_MODE_COUNT) - 1U;
+    config->bytesPerCase = UART_BENCH_DEFAULT_BYTES;
+    config->consoleBaud = 115200;
+    config->format = UART_BENCH_CSV;
+}
+
+void UartBench_RunCase(UartBench_Mode mode, uint16_t chunk, uint32_t bytes, UartBench_Result* result) {
+    Bench_Loop loop = { 0, 0 };
+    uint32_t calls = 0;
+    uint32_t callCycles = 0;
+    uint32_t sent = 0;
+    uint32_t t0;
+
+    if (chunk == 0 || chunk > UART_BENCH_MAX_CHUNK) {
+        chunk = UART_BENCH_MAX_CHUNK;
+    }
+
+    /* Polling mode reads RX by polling too */
+    if (mode == UART_BENCH_POLLING) {
+        UART_StopReceiveIT();
+    } else {
+        UART_StartReceiveIT();
+    }
+    (void)Bench_DrainRx(mode);
+
+    uint32_t start = DWT->CYCCNT;
+
+    while (sent < bytes) {
+        uint16_t n = (bytes - sent < chunk) ? (uint16_t)(bytes - sent) : chunk;
+
+        switch (mode) {
+            case UART_BENCH_POLLING:
+                t0 = DWT->CYCCNT;
+                UART_Transmit((const char*)payload, n, BENCH_TIMEOUT_MS);
+                callCycles += DWT->CYCCNT - t0;
+                calls++;
+                break;
+
+            case UART_BENCH_IRQ:
+                /* Submit once the rest of the chunk fits, or in ring-sized
+                 * pieces for chunks larger than the ring */
+                for (uint16_t done = 0; done < n; ) {
+                    uint16_t want = n - done;
+                    uint16_t space = UART_GetTxFree();
+                    if (space < want && space < UART_TX_RING_SIZE / 2) {
+                        Bench_Idle(&loop, mode);
+                        continue;
+                    }
+                    t0 = DWT->CYCCNT;
+                    done += UART_WriteAsync(payload + done, want);
+                    callCycles += DWT->CYCCNT - t0;
+                    calls++;
+                }
+                break;
+
+            case UART_BENCH_DMA:
+            default:
+                while (UART_IsTxDmaBusy()) {
+                    Bench_Idle(&loop, mode);
+                }
+                t0 = DWT->CYCCNT;
+                UART_WriteDMA(payload, n);
+                callCycles += DWT->CYCCNT - t0;
+                calls++;
+                break;
+        }
+        sent += n;
+        loop.received += Bench_DrainRx(mode);
+    }
+
+    /* Done when the last stop bit has left */
+    while (!UART_IsTxIdle() || UART_IsTxDmaBusy()) {
+        Bench_Idle(&loop, mode);
+    }
+    while (!(USART3->SR & USART_SR_TC));
+    uint32_t elapsed = DWT->CYCCNT - start;
+
+    /* Looped-back bytes still on the wire */
+    SysTick_Delay(BENCH_SETTLE_MS);
+    loop.received += Bench_DrainRx(mode);
+
+    uint32_t idleCycles = (uint32_t)(((uint64_t)loop.idle * idle_cycles_q8) >> 8);
+    uint32_t busy = (idleCycles < elapsed) ? elapsed - idleCycles : 0;
+    uint32_t baud = (USART3->BRR != 0) ? BENCH_CPU_HZ / USART3->BRR : 0;
+
+    result->mode = mode;
+    result->baud = baud;
+    result->chunk = chunk;
+    result->bytes = bytes;
+    result->elapsedUs = elapsed / (BENCH_CPU_HZ / 1000000UL);
+    result->throughput = (elapsed != 0) ? (uint32_t)((uint64_t)bytes * BENCH_CPU_HZ / elapsed) : 0;
+    result->linePermille = (baud != 0) ?
+        (uint16_t)((uint64_t)result->throughput * BENCH_FRAME_BITS * 1000U / baud) : 0;
+    result->cpuPermille = (elapsed != 0) ? (uint16_t)((uint64_t)busy * 1000U / elapsed) : 0;
+    result->callCycles = (calls != 0) ? callCycles / calls : 0;
+    result->calls = calls;
+    result->loopback = loopback;
+    result->rxLost = (loop.received < sent) ? sent - loop.received : 0;
+}
+
+int UartBench_FormatResult(char* buf, size_t size, const UartBench_Result* result,
+                           UartBench_Format format) {
+    /* Loss in hundredths of a percent */
+    uint32_t loss = (result->bytes != 0) ?
+        (uint32_t)((uint64_t)result->rxLost * 10000U / result->bytes) : 0;
+    char rx[32];
+
+    if (!result->loopback) {
+        FMT_Format(rx, sizeof(rx), (format == UART_BENCH_JSON) ?
+                   "\"rx_lost\":null,\"rx_loss_pct\":null" : ",");
+    } else if (format == UART_BENCH_JSON) {
+        FMT_Format(rx, sizeof(rx), "\"rx_lost\":%lu,\"rx_loss_pct\":%lu.%02lu",
+                   result->rxLost, loss / 100, loss % 100);
+    } else {
+        FMT_Format(rx, sizeof(rx), "%lu,%lu.%02lu", result->rxLost, loss / 100, loss % 100);
+    }
+
+    if (format == UART_BENCH_JSON) {
+        return FMT_Format(buf, size,
+                          "{\"mode\":\"%s\",\"baud\":%lu,\"chunk\":%u,\"bytes\":%lu,"
+                          "\"elapsed_us\":%lu,\"throughput_Bps\":%lu,\"line_pct\":%u.%u,"
+                          "\"cpu_pct\":%u.%u,\"call_cycles\":%lu,\"calls\":%lu,%s}",
+                          mode_names[result->mode], result->baud, result->chunk, result->bytes,
+                          result->elapsedUs, result->throughput,
+                          result->linePermille / 10, result->linePermille % 10,
+                          result->cpuPermille / 10, result->cpuPermille % 10,
+                          result->callCycles, result->calls, rx);
+    }
+
+    return FMT_Format(buf, size, "%s,%lu,%u,%lu,%lu,%lu,%u.%u,%u.%u,%lu,%lu,%s",
+                      mode_names[result->mode], result->baud, result->chunk, result->bytes,
+                      result->elapsedUs, result->throughput,
+                      result->linePermille / 10, result->linePermille % 10,
+                      result->cpuPermille / 10, result->cpuPermille % 10,
+                      result->callCycles, result->calls, rx);
+}
+
+static void Bench_Emit(const char* text) {
+    FMT_Print("\r\n" UART_BENCH_PREFIX "%s\r\n", text);
+}
+
+/* Records go out through the TX ring at the console rate; the last stop
+ * bit must have left before the next case changes the baud rate */
+static bool Bench_ConsoleIdle(void) {
+    return UART_IsTxIdle() && (USART3->SR & USART_SR_TC);
+}
+
+void UartBench_Start(const UartBench_Config* config) {
+    char line[256];
+
+    if (config == NULL) {
+        UartBench_DefaultConfig(&bench_config);
+    } else {
+        bench_config = *config;
+    }
+    bench_next = 0;
+    bench_cases = 0;
+    bench_ended = false;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < UART_BENCH_MAX_CHUNK; i++) {
+        payload[i] = (uint8_t)('A' + (i % 26));
+    }
+
+    UART_Init(bench_config.consoleBaud);
+    loopback = Bench_DetectLoopback();
+    Bench_Calibrate();
+
+    FMT_Format(line, sizeof(line), "-begin %s %u",
+               (bench_config.format == UART_BENCH_JSON) ? "json" : "csv", loopback ? 1U : 0U);
+    Bench_Emit(line);
+    if (bench_config.format == UART_BENCH_CSV) {
+        FMT_Format(line, sizeof(line), "-header %s", csv_header);
+        Bench_Emit(line);
+    }
+}
+
+bool UartBench_Step(void) {
+    const UartBench_Config* config = &bench_config;
+    uint32_t total = (uint32_t)config->baudCount * UART_BENCH_MODE_COUNT * config->chunkCount;
+    char line[256];
+
+    /* Flat index over baud x mode x chunk, chunks varying fastest */
+    while (bench_next < total) {
+        uint32_t i = bench_next++;
+        uint8_t c = (uint8_t)(i % config->chunkCount);
+        uint8_t m = (uint8_t)((i / config->chunkCount) % UART_BENCH_MODE_COUNT);
+        uint8_t b = (uint8_t)(i / config->chunkCount / UART_BENCH_MODE_COUNT);
+        if (!(config->modeMask & (1U << m))) {
+            continue;
+        }
+
+        UartBench_Result result;
+        uint16_t chunk = config->chunks[c];
+        uint32_t bytes = (config->bytesPerCase > chunk) ? config->bytesPerCase : chunk;
+
+        UART_Init(config->bauds[b]);
+        UartBench_RunCase((UartBench_Mode)m, chunk, bytes, &result);
+        /* Report the configured rate, not the one BRR rounds to */
+        result.baud = config->bauds[b];
+
+        UART_Init(config->consoleBaud);
+        line[0] = ' ';
+        UartBench_FormatResult(line + 1, sizeof(line) - 1, &result, config->format);
+        Bench_Emit(line);
+        bench_cases++;
+        return true;
+    }
+
+    if (!bench_ended) {
+        bench_ended = true;
+        UART_StopReceiveIT();
+        FMT_Format(line, sizeof(line), "-end %lu", bench_cases);
+        Bench_Emit(line);
+    }
+    return false;
+}
+
+uint32_t UartBench_Run(const UartBench_Config* config) {
+    UartBench_Start(config);
+    do {
+        while (!Bench_ConsoleIdle());
+    } while (UartBench_Step());
+    while (!Bench_ConsoleIdle());
+
+    return bench_cases;
+}
+
+/* Ctrl-C between cases: the next run starts over */
+static void Bench_Abort(void) {
+    bench_started = false;
+}
+
+/* One case per call, each once the previous record has left */
+static Shell_Status Bench_Cmd(int argc, char* argv[]) {
+    Shell_SetAbortHandler(Bench_Abort);
+    if (!Bench_ConsoleIdle()) {
+        return SHELL_MORE;
+    }
+    if (!bench_started) {
+        UartBench_Start(NULL);
+        bench_started = true;
+        return SHELL_MORE;
+    }
+    if (UartBench_Step()) {
+        return SHELL_MORE;
+    }
+    bench_started = false;
+    return SHELL_OK;
+}
+SHELL_COMMAND("bench", "", "UART throughput matrix, see Tools/uart_bench.py", Bench_Cmd);
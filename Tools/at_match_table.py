@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""Generate Src/at_match_table.c, the response matcher tables for Src/at.c.
+
+PATTERNS lists every line the ESP-AT firmware sends that the engine tells
+apart: final results, URCs and the prefixes of information lines. A
+pattern ending in '*' matches the start of a line, the rest is its
+payload; otherwise it must be the whole line. A leading "#," stands for
+"<link>," with link 0 .. LINKS - 1.
+
+The patterns form a prefix trie. Its branching and accepting nodes are
+the states of a DFA over byte classes; the single-child runs between
+them are labels, compared byte for byte:
+
+    in a label:  c == at_match_chars[label] ? label++ : state = at_match_fail[state]
+    otherwise:   state = at_match_next[state][at_match_class[c]]
+
+Either way one step per byte, no backtracking, no line buffer. State 0 is
+dead (no pattern can match any more), state 1 is the root. Where a line
+leaves the trie after a prefix pattern has matched, it enters that
+pattern's sink state and stays there, so the final state alone gives the
+result: at_match_token[state] (AT_MATCH_LINKED for "#," patterns) and
+at_match_depth[state], the payload offset. A whole-line match beats a
+prefix, a longer prefix beats a shorter one.
+
+at_match_patterns[] holds the same list, whole lines first and prefixes
+longest first, so a linear scan that stops at the first hit agrees with
+the DFA; 'atmbench' times one against the other.
+
+Usage:
+    at_match_table.py > Src/at_match_table.c
+    at_match_table.py -o Src/at_match_table.c
+"""
+
+import argparse
+import sys
+
+LINKS = 5           # AT_MAX_LINKS
+MAX_CLASSES = 64
+
+PATTERNS = [
+    # Final results
+    ("OK", "AT_TOKEN_OK"),
+    ("SEND OK", "AT_TOKEN_SEND_OK"),
+    ("ERROR", "AT_TOKEN_ERROR"),
+    ("FAIL", "AT_TOKEN_FAIL"),
+    ("SEND FAIL", "AT_TOKEN_SEND_FAIL"),
+    ("busy *", "AT_TOKEN_BUSY"),
+    ("AT*", "AT_TOKEN_ECHO"),
+    # URCs
+    ("ready", "AT_TOKEN_READY"),
+    ("WIFI CONNECTED", "AT_TOKEN_WIFI_CONNECTED"),
+    ("WIFI GOT IP", "AT_TOKEN_WIFI_GOT_IP"),
+    ("WIFI DISCONNECT", "AT_TOKEN_WIFI_DISCONNECT"),
+    ("CONNECT", "AT_TOKEN_CONNECT"),
+    ("#,CONNECT", "AT_TOKEN_CONNECT"),
+    ("CONNECT FAIL", "AT_TOKEN_CONNECT_FAIL"),
+    ("#,CONNECT FAIL", "AT_TOKEN_CONNECT_FAIL"),
+    ("CLOSED", "AT_TOKEN_CLOSED"),
+    ("#,CLOSED", "AT_TOKEN_CLOSED"),
+    ("+IPD,*", "AT_TOKEN_IPD"),
+    ("+STA_CONNECTED:*", "AT_TOKEN_STA_CONNECTED"),
+    ("+STA_DISCONNECTED:*", "AT_TOKEN_STA_DISCONNECTED"),
+    ("+DIST_STA_IP:*", "AT_TOKEN_DIST_STA_IP"),
+    ("+LINK_CONN:*", "AT_TOKEN_LINK_CONN"),
+    # Information and diagnostics
+    ("Recv *", "AT_TOKEN_RECV"),
+    ("ALREADY CONNECTED", "AT_TOKEN_ALREADY_CONNECTED"),
+    ("link is not valid", "AT_TOKEN_LINK_INVALID"),
+    ("no change", "AT_TOKEN_NO_CHANGE"),
+    ("DNS Fail", "AT_TOKEN_DNS_FAIL"),
+    ("ERR CODE:*", "AT_TOKEN_ERR_CODE"),
+    ("STATUS:*", "AT_TOKEN_STATUS"),
+    ("+CIPSTATUS:*", "AT_TOKEN_CIPSTATUS"),
+    ("+CIFSR:*", "AT_TOKEN_CIFSR"),
+    ("+CWJAP:*", "AT_TOKEN_CWJAP"),
+    ("+CWLAP:*", "AT_TOKEN_CWLAP"),
+    ("+CWMODE:*", "AT_TOKEN_CWMODE"),
+    ("+CWSTATE:*", "AT_TOKEN_CWSTATE"),
+    ("+CIPMUX:*", "AT_TOKEN_CIPMUX"),
+    ("+CIPSTA:*", "AT_TOKEN_CIPSTA"),
+    ("+CIPSTAMAC:*", "AT_TOKEN_CIPSTAMAC"),
+    ("+CIPDOMAIN:*", "AT_TOKEN_CIPDOMAIN"),
+    ("+CIPSNTPTIME:*", "AT_TOKEN_CIPSNTPTIME"),
+    ("+CIPRECVDATA:*", "AT_TOKEN_CIPRECVDATA"),
+    ("+CIPRECVLEN:*", "AT_TOKEN_CIPRECVLEN"),
+    ("+CIPMODE:*", "AT_TOKEN_CIPMODE"),
+    ("+PING:*", "AT_TOKEN_PING"),
+    ("+UART_CUR:*", "AT_TOKEN_UART_CUR"),
+    ("AT version:*", "AT_TOKEN_VERSION"),
+    ("SDK version:*", "AT_TOKEN_SDK_VERSION"),
+    ("compile time*", "AT_TOKEN_COMPILE_TIME"),
+    ("Bin version*", "AT_TOKEN_BIN_VERSION"),
+]
+
+
+class Node:
+    def __init__(self, depth):
+        self.edges = {}         # byte or '#' -> Node
+        self.exact = None       # Token of a whole-line pattern ending here
+        self.prefix = None      # Token of a prefix pattern ending here
+        self.depth = depth
+        self.state = None
+        self.sink = None
+
+
+def symbols(text):
+    if text.startswith("#,"):
+        return ["#"] + list(text[1:].encode())
+    return list(text.encode())
+
+
+def build_trie():
+    root = Node(0)
+    for text, token in PATTERNS:
+        prefix = text.endswith("*")
+        node = root
+        for sym in symbols(text.rstrip("*")):
+            if sym not in node.edges:
+                node.edges[sym] = Node(node.depth + 1)
+            node = node.edges[sym]
+        value = (token, text.startswith("#,"))
+        if prefix:
+            if node.prefix is not None:
+                sys.exit("at_match_table: duplicate pattern %r" % text)
+            node.prefix = value
+        else:
+            if node.exact is not None:
+                sys.exit("at_match_table: duplicate pattern %r" % text)
+            node.exact = value
+    # Link digits and literal digits must not share a node's edges
+    stack = [root]
+    while stack:
+        node = stack.pop()
+        if "#" in node.edges and any(b in node.edges for b in range(0x30, 0x30 + LINKS)):
+            sys.exit("at_match_table: '#' and a digit at the same position")
+        stack.extend(node.edges.values())
+    return root
+
+
+def edge(node, byte):
+    if byte in node.edges:
+        return node.edges[byte]
+    if 0x30 <= byte < 0x30 + LINKS:
+        return node.edges.get("#")
+    return None
+
+
+def kept(node, root):
+    """Nodes that are states; the others are label bytes."""
+    return node is root or len(node.edges) != 1 or node.exact is not None or \
+        node.prefix is not None
+
+
+def follow(node, root):
+    """The label bytes after an edge into node and the state they lead to."""
+    label = []
+    while not kept(node, root):
+        sym, child = next(iter(node.edges.items()))
+        if sym == "#":
+            sys.exit("at_match_table: '#' only at the start of a pattern")
+        label.append(sym)
+        node = child
+    return label, node
+
+
+def build_dfa(root):
+    """Rows of next states per byte; fail state, token, depth and label
+    per state."""
+    nodes = []
+    queue = [root]
+    while queue:
+        node = queue.pop(0)
+        nodes.append(node)
+        for sym in sorted(node.edges, key=str):
+            queue.append(follow(node.edges[sym], root)[1])
+
+    sinks = [node for node in nodes if node.prefix is not None]
+    count = 1 + len(nodes) + len(sinks)
+    if count > 256:
+        sys.exit("at_match_table: %d states do not fit uint8_t" % count)
+    for i, node in enumerate(nodes):
+        node.state = 1 + i
+    for i, node in enumerate(sinks):
+        node.sink = 1 + len(nodes) + i
+
+    rows = [[0] * 256 for _ in range(count)]
+    fail = [0] * count
+    token = [0] * count
+    depth = [0] * count
+    labels = [[] for _ in range(count)]
+
+    def walk(node, above):
+        # above: the deepest prefix pattern on the path before node
+        s = node.state
+        fallback = above
+        fail[s] = above.sink if above is not None else 0
+        if node.prefix is not None:
+            fallback = node
+            rows[node.sink] = [node.sink] * 256
+            fail[node.sink] = node.sink
+            token[node.sink] = node.prefix
+            depth[node.sink] = node.depth
+        if node.exact is not None:
+            token[s] = node.exact
+            depth[s] = node.depth
+        elif fallback is not None and node is not root:
+            token[s] = fallback.prefix
+            depth[s] = fallback.depth
+
+        targets = {}
+        for sym, child in node.edges.items():
+            label, target = follow(child, root)
+            labels[target.state] = label
+            targets[sym] = target
+        for byte in range(256):
+            child = edge(node, byte)
+            if child is not None:
+                rows[s][byte] = targets[byte if byte in node.edges else "#"].state
+            elif fallback is not None:
+                rows[s][byte] = fallback.sink
+        for target in targets.values():
+            walk(target, fallback)
+
+    walk(root, None)
+    return rows, fail, token, depth, labels
+
+
+def byte_classes(rows):
+    """Bytes with identical columns share a class; class 0 is the class of
+    bytes no pattern starts a branch with."""
+    columns = {}
+    classes = [0] * 256
+    columns[tuple(row[0x00] for row in rows)] = 0
+    for byte in range(256):
+        column = tuple(row[byte] for row in rows)
+        if column not in columns:
+            columns[column] = len(columns)
+        classes[byte] = columns[column]
+    table = [[0] * len(columns) for _ in rows]
+    for column, cls in columns.items():
+        for state, value in enumerate(column):
+            table[state][cls] = value
+    return classes, table
+
+
+def scan_order():
+    """Whole lines first, then prefixes longest first, for a first-hit scan."""
+    exact = [p for p in PATTERNS if not p[0].endswith("*")]
+    prefix = [p for p in PATTERNS if p[0].endswith("*")]
+    prefix.sort(key=lambda p: -len(p[0]))
+    return exact + prefix
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def rows_text(values, per_row, width):
+    out = []
+    for i in range(0, len(values), per_row):
+        out.append("    " + ", ".join("%*s" % (width, v) for v in values[i:i + per_row]) + ",")
+    return "\n".join(out)
+
+
+def token_text(value):
+    if value == 0:
+        return "AT_TOKEN_NONE"
+    name, linked = value
+    return name + (" | AT_MATCH_LINKED" if linked else "")
+
+
+def naive(line):
+    """First hit in scan order, as the strncmp chain in atmbench does."""
+    for text, name in scan_order():
+        linked = text.startswith("#,")
+        body = text[2:] if linked else text
+        rest = line
+        if linked:
+            if len(line) < 2 or not 0x30 <= line[0] < 0x30 + LINKS or line[1] != 0x2C:
+                continue
+            rest = line[2:]
+        pattern = body.rstrip("*").encode()
+        if rest == pattern or (body.endswith("*") and rest.startswith(pattern)):
+            return ((name, linked), len(line) - len(rest) + len(pattern))
+    return (0, 0)
+
+
+def run(tables, line):
+    classes, table, fail, token, depth, labels = tables
+    chars = [c for label in labels for c in label]
+    offsets = [sum(len(l) for l in labels[:s]) for s in range(len(labels))]
+    state, at, left = 1, 0, 0
+    for c in line:
+        if left:
+            if c == chars[at]:
+                at += 1
+                left -= 1
+            else:
+                state, left = fail[state], 0
+        else:
+            state = table[state][classes[c]]
+            at, left = offsets[state], len(labels[state])
+    if left:
+        state = fail[state]
+    return (token[state], depth[state])
+
+
+def check(tables):
+    """Every pattern, cut short, extended and with payloads, against naive()."""
+    lines = set()
+    for text, _ in PATTERNS:
+        for link in (b"0,", b"4,", b"5,", b"x,") if text.startswith("#,") else (b"",):
+            body = link + text.lstrip("#,").rstrip("*").encode() if text.startswith("#,") else \
+                text.rstrip("*").encode()
+            for cut in range(len(body) + 1):
+                lines.add(body[:cut])
+            for tail in (b"1", b"x", b":", b" ", b"0,CLOSED", b"\xff"):
+                lines.add(body + tail)
+                lines.add(body[:-1] + tail)
+    for line in sorted(lines):
+        if line and run(tables, line) != naive(line):
+            sys.exit("at_match_table: %r matches %r, the scan %r"
+                     % (line, run(tables, line), naive(line)))
+
+
+def generate():
+    root = build_trie()
+    rows, fail, token, depth, labels = build_dfa(root)
+    classes, table = byte_classes(rows)
+    if len(table[0]) > MAX_CLASSES:
+        sys.exit("at_match_table: %d byte classes, more than %d" % (len(table[0]), MAX_CLASSES))
+    check((classes, table, fail, token, depth, labels))
+
+    states = len(table)
+    chars = sum(len(label) for label in labels)
+    size = 256 + states * (len(table[0]) + 6) + chars
+    counts = (len(table[0]), states, len(PATTERNS))
+    out = []
+    out.append("/* @at_match_table.c - Generated by Tools/at_match_table.py, do not edit */")
+    out.append('#include "at_match.h"')
+    out.append("")
+    out.append("#if AT_MATCH_CLASSES != %d || AT_MATCH_STATES != %d || AT_MATCH_PATTERNS != %d"
+               % counts)
+    out.append('#error "set AT_MATCH_CLASSES %d, AT_MATCH_STATES %d and AT_MATCH_PATTERNS %d '
+               'in Inc/at_match.h"' % counts)
+    out.append("#endif")
+    out.append("")
+    out.append("/* %d patterns, %d states, %d byte classes, %d bytes of tables */"
+               % (len(PATTERNS), states, len(table[0]), size))
+    out.append("")
+    out.append("const uint8_t at_match_class[256] = {")
+    out.append(rows_text(classes, 16, 2))
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t at_match_next[AT_MATCH_STATES][AT_MATCH_CLASSES] = {")
+    for row in table:
+        out.append("    { " + ", ".join("%3d" % v for v in row) + " },")
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t at_match_fail[AT_MATCH_STATES] = {")
+    out.append(rows_text(fail, 16, 3))
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t at_match_token[AT_MATCH_STATES] = {")
+    out.extend("    %s,  /* %d */" % (token_text(t), i) for i, t in enumerate(token))
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t at_match_depth[AT_MATCH_STATES] = {")
+    out.append(rows_text(depth, 16, 2))
+    out.append("};")
+    out.append("")
+    offsets, at = [], 0
+    for label in labels:
+        offsets.append(at)
+        at += len(label)
+    out.append("/* Label of each state: the bytes after the edge into it */")
+    out.append("const uint16_t at_match_label[AT_MATCH_STATES] = {")
+    out.append(rows_text(offsets, 16, 3))
+    out.append("};")
+    out.append("")
+    out.append("const uint8_t at_match_length[AT_MATCH_STATES] = {")
+    out.append(rows_text([len(label) for label in labels], 16, 2))
+    out.append("};")
+    out.append("")
+    out.append("const char at_match_chars[] =")
+    pieces = [(i, label) for i, label in enumerate(labels) if label]
+    for n, (state, label) in enumerate(pieces):
+        text = c_string(bytes(label).decode()) + (";" if n == len(pieces) - 1 else "")
+        out.append("    %-22s /* %d */" % (text, state))
+    out.append("")
+    out.append("const At_MatchPattern at_match_patterns[AT_MATCH_PATTERNS] = {")
+    for text, name in scan_order():
+        linked = text.startswith("#,")
+        body = text[2:] if linked else text
+        flags = []
+        if body.endswith("*"):
+            flags.append("AT_MATCH_PREFIX")
+        if linked:
+            flags.append("AT_MATCH_LINKED")
+        out.append("    { %s, %s, %s }," % (c_string(body.rstrip("*")), name,
+                                           " | ".join(flags) if flags else "0"))
+    out.append("};")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("-o", "--output", help="write here instead of stdout")
+    args = parser.parse_args()
+
+    text = generate()
+    if args.output:
+        with open(args.output, "w", newline="\n") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
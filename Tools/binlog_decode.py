@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Decode the deferred binary log (Inc/binlog.h) back into text.
+
+The firmware sends COBS frames between 0x00 delimiters, interleaved with
+ordinary console text. Each frame holds varints: format ID (offset into the
+.binlog_fmt section of the ELF), timestamp delta in CPU cycles, then one
+value per conversion in the format string.
+
+Usage:
+    binlog_decode.py embeddedC_gpio1234.elf /dev/ttyACM0 [--baud 115200]
+    binlog_decode.py embeddedC_gpio1234.elf capture.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from elf32 import Elf32  # noqa: E402
+
+ID_DROPPED = 0
+FRAME_MAX = 32
+
+SPEC = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diuxXcsfFeEgGp%])")
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varints(data):
+    values = []
+    value = shift = 0
+    for b in data:
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            values.append(value & 0xFFFFFFFF)
+            value = shift = 0
+        elif shift > 35:
+            return None
+    if shift:
+        return None
+    return values
+
+
+class Decoder:
+    def __init__(self, elf, clock_hz):
+        self.elf = elf
+        self.clock_hz = clock_hz
+        self.strings = elf.section_data(".binlog_fmt")
+        if self.strings is None:
+            raise SystemExit("no .binlog_fmt section in ELF (built without binlog?)")
+        self.cycles = 0
+        self.formats = {}
+
+    def format_at(self, fmt_id):
+        if fmt_id not in self.formats:
+            if fmt_id <= 0 or fmt_id >= len(self.strings):
+                return None
+            end = self.strings.find(b"\x00", fmt_id)
+            self.formats[fmt_id] = self.strings[fmt_id:end].decode("latin-1")
+        return self.formats[fmt_id]
+
+    def render(self, fmt, args):
+        args = list(args)
+
+        def convert(m):
+            flags, width, prec, _length, conv = m.groups()
+            if conv == "%":
+                return "%"
+            if not args:
+                raise ValueError("too few arguments")
+            word = args.pop(0)
+            spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+            if conv in "di":
+                return (spec + "d") % (word - (1 << 32) if word & 0x80000000 else word)
+            if conv in "uxX":
+                return (spec + conv.replace("u", "d")) % word
+            if conv == "p":
+                return "0x%08x" % word
+            if conv == "c":
+                return (spec + "c") % chr(word & 0xFF)
+            if conv in "fFeEgG":
+                return (spec + conv) % struct.unpack("<f", struct.pack("<I", word))[0]
+            if conv == "s":
+                text = self.elf.read_cstr(word)
+                return (spec + "s") % (text if text is not None else "<0x%08x>" % word)
+            return m.group(0)
+
+        text = SPEC.sub(convert, fmt)
+        if args:
+            raise ValueError("too many arguments")
+        return text
+
+    def frame(self, payload):
+        """Text for one frame, or None if it does not decode."""
+        raw = cobs_decode(payload)
+        if raw is None:
+            return None
+        values = varints(raw)
+        if values is None or len(values) < 2:
+            return None
+
+        fmt_id, delta, args = values[0], values[1], values[2:]
+        if fmt_id == ID_DROPPED:
+            text = "*** %d log records dropped ***\n" % (args[0] if args else 0)
+        else:
+            fmt = self.format_at(fmt_id)
+            if fmt is None:
+                return None
+            try:
+                text = self.render(fmt, args)
+            except (ValueError, TypeError):
+                return None
+
+        self.cycles += delta
+        stamp = "[%12.6f] " % (self.cycles / self.clock_hz)
+        return stamp + text.replace("\r", "")
+
+    def run(self, stream, out):
+        in_frame = False
+        buf = bytearray()
+
+        while True:
+            chunk = stream.read1(256) if hasattr(stream, "read1") else stream.read(256)
+            if not chunk:
+                break
+            for b in chunk:
+                if not in_frame:
+                    if b == 0:
+                        in_frame = True
+                        buf.clear()
+                    else:
+                        out.write(chr(b).replace("\r", ""))
+                    continue
+
+                if b != 0:
+                    buf.append(b)
+                    if len(buf) > FRAME_MAX:
+                        # Joined mid-stream: this was console text
+                        out.write(buf.decode("latin-1").replace("\r", ""))
+                        in_frame = False
+                    continue
+
+                if not buf:
+                    continue
+                text = self.frame(bytes(buf))
+                if text is not None:
+                    out.write(text)
+                    in_frame = False
+                else:
+                    # Not a frame; the delimiter just seen opens the next one
+                    out.write(buf.decode("latin-1").replace("\r", ""))
+                    buf.clear()
+            out.flush()
+
+
+def open_input(path, baud):
+    if path == "-":
+        return sys.stdin.buffer
+    stream = open(path, "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    return stream
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("elf", help="firmware ELF the log was produced by")
+    parser.add_argument("input", help="serial device, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--clock", type=float, default=16e6, help="CPU clock in Hz for timestamps")
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf32(args.elf), args.clock)
+    try:
+        decoder.run(open_input(args.input, args.baud), sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
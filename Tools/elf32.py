@@ -0,0 +1,108 @@
+"""Minimal reader for the 32-bit little-endian ELF files the firmware build
+produces. Only what the host tools need: section contents, loadable memory
+and the function symbol table. No third-party dependencies."""
+
+import bisect
+import struct
+
+
+class Section:
+    def __init__(self, name, sh_type, flags, addr, offset, size, link, entsize):
+        self.name = name
+        self.type = sh_type
+        self.flags = flags
+        self.addr = addr
+        self.offset = offset
+        self.size = size
+        self.link = link
+        self.entsize = entsize
+
+
+class Elf32:
+    SHT_SYMTAB = 2
+    SHT_NOBITS = 8
+    SHF_ALLOC = 0x2
+    STT_FUNC = 2
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s: not a 32-bit little-endian ELF" % path)
+
+        (shoff,) = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+
+        raw = []
+        for i in range(shnum):
+            raw.append(struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize))
+
+        names = raw[shstrndx]
+        self.sections = []
+        for (name, sh_type, flags, addr, offset, size, link, _info, _align, entsize) in raw:
+            self.sections.append(Section(self._cstr(names[4] + name), sh_type, flags,
+                                         addr, offset, size, link, entsize))
+        self._symbols = None
+
+    def _cstr(self, offset):
+        end = self.data.index(b"\x00", offset)
+        return self.data[offset:end].decode("latin-1")
+
+    def section(self, name):
+        for s in self.sections:
+            if s.name == name:
+                return s
+        return None
+
+    def section_data(self, name):
+        s = self.section(name)
+        if s is None or s.type == self.SHT_NOBITS:
+            return None
+        return self.data[s.offset:s.offset + s.size]
+
+    def read(self, addr, size):
+        """Bytes at a target address, from any section loaded into memory."""
+        for s in self.sections:
+            if (s.flags & self.SHF_ALLOC) and s.type != self.SHT_NOBITS \
+                    and s.addr <= addr and addr + size <= s.addr + s.size:
+                start = s.offset + addr - s.addr
+                return self.data[start:start + size]
+        return None
+
+    def read_cstr(self, addr, limit=256):
+        for s in self.sections:
+            if (s.flags & self.SHF_ALLOC) and s.type != self.SHT_NOBITS \
+                    and s.addr <= addr < s.addr + s.size:
+                start = s.offset + addr - s.addr
+                end = min(s.offset + s.size, start + limit)
+                raw = self.data[start:end]
+                return raw.split(b"\x00", 1)[0].decode("latin-1")
+        return None
+
+    def functions(self):
+        """Sorted list of (address, size, name) for every function symbol."""
+        if self._symbols is None:
+            syms = []
+            for s in self.sections:
+                if s.type != self.SHT_SYMTAB:
+                    continue
+                strtab = self.sections[s.link]
+                for off in range(s.offset, s.offset + s.size, s.entsize):
+                    name, value, size, info, _other, _shndx = struct.unpack_from("<IIIBBH", self.data, off)
+                    if (info & 0xF) == self.STT_FUNC:
+                        # Thumb functions carry bit 0 set in their address
+                        syms.append((value & ~1, size, self._cstr(strtab.offset + name)))
+            syms.sort()
+            self._symbols = syms
+        return self._symbols
+
+    def symbolize(self, addr):
+        """Name of the function containing addr, or None."""
+        syms = self.functions()
+        i = bisect.bisect_right(syms, (addr, 0xFFFFFFFF, "")) - 1
+        if i >= 0:
+            start, size, name = syms[i]
+            if start <= addr < start + max(size, 1):
+                return name
+        return None
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""Fake ESP8266/ESP32 AT modem on a pseudo-terminal, for testing Src/at.c
+on the host.
+
+Answers the subset of the ESP-AT command set the engine uses, with the
+module's timing and quirks: command echo until ATE0, "WIFI CONNECTED" and
+"WIFI GOT IP" before AT+CWJAP's OK, "<link>,CONNECT"/"<link>,CLOSED", the
+'>' prompt and "Recv N bytes"/"SEND OK" for AT+CIPSEND. Every payload is
+echoed back from the far end as "+IPD,<link>,<length>:" packets of at most
+1460 bytes, as a TCP echo server would; after AT+CIPDINFO=1 the header
+carries the far end's address too, unquoted as on the ESP8266:
+"+IPD,<link>,<length>,10.0.0.1,8080:". AT+TESTHANG (fake only) never
+answers, for timeouts.
+
+After AT+CIPMODE=1 (single connection only), AT+CIPSEND without a length
+answers '>' and enters transparent mode: bytes are gathered into packets
+that end after 20 ms of quiet or at 2920 bytes, and each packet is echoed
+back raw. A packet that is exactly "+++" leaves transparent mode; for the
+next second the module does not listen, so commands sent too early are
+lost.
+
+With --busy, a command arriving while another one is executing gets
+"busy p..." and is dropped, as on the real module; otherwise commands
+queue. With --split, output goes out in random pieces so lines and
+payloads break anywhere.
+
+Given a command, runs it with the terminal's path as its last argument
+and exits with its status; otherwise prints the path and serves until
+Ctrl-C.
+
+Usage:
+    fake_esp.py [--busy] [--split] [--seed N] -- Sim/build/at_test
+    fake_esp.py --busy
+"""
+
+import argparse
+import os
+import random
+import re
+import select
+import subprocess
+import sys
+import time
+import tty
+
+MAX_IPD = 1460
+PACKET_GAP = 0.02           # Transparent mode sends what it has after this much quiet
+PACKET_MAX = 2920
+ESCAPE_DEAF = 1.0           # After "+++", before commands are heard
+
+
+class FakeEsp:
+    def __init__(self, fd, busy, split, rng):
+        self.fd = fd
+        self.busy_mode = busy
+        self.split = split
+        self.rng = rng
+        self.echo = True
+        self.mux = False
+        self.dinfo = False          # AT+CIPDINFO=1: +IPD carries the remote address
+        self.links = set()
+        self.pending = b""          # Received bytes not yet parsed
+        self.commands = []          # Queued command lines
+        self.busy_until = 0.0
+        self.events = []            # (time, bytes), sent in order
+        self.out = b""              # Due output still to write, with --split
+        self.payload = None         # (link, length) while reading AT+CIPSEND data
+        self.cipmode = False
+        self.transparent = False
+        self.packet = b""           # Transparent bytes not yet sent on
+        self.packet_at = 0.0        # Arrival of the last of them
+        self.deaf_until = 0.0
+
+    def emit(self, delay, data):
+        start = max([t for t, _ in self.events] + [time.monotonic()])
+        self.events.append((start + delay, data))
+
+    def respond(self, steps):
+        """Steps of (delay in s, text); the module is busy until the last."""
+        for delay, text in steps:
+            self.emit(delay, text.encode() if isinstance(text, str) else text)
+        self.busy_until = max(t for t, _ in self.events) if self.events else time.monotonic()
+
+    def execute(self, command):
+        ok = "\r\nOK\r\n"
+        m = re.fullmatch(r"AT\+CIPSTART=(?:(\d),)?\"TCP\",\"[^\"]+\",\d+", command)
+        if command in ("AT", "AT+CWMODE=1", "AT+CWMODE=3"):
+            self.respond([(0.002, ok)])
+        elif command in ("AT+CIPDINFO=0", "AT+CIPDINFO=1"):
+            self.dinfo = command.endswith("1")
+            self.respond([(0.002, ok)])
+        elif command in ("ATE0", "ATE1"):
+            self.echo = command == "ATE1"
+            self.respond([(0.002, ok)])
+        elif command.startswith("AT+CIPMUX="):
+            self.mux = command.endswith("1")
+            self.respond([(0.002, ok)])
+        elif command in ("AT+CIPMODE=0", "AT+CIPMODE=1"):
+            if self.mux and command.endswith("1"):
+                self.respond([(0.002, "\r\nERROR\r\n")])
+            else:
+                self.cipmode = command.endswith("1")
+                self.respond([(0.002, ok)])
+        elif command == "AT+CIPSEND":
+            if not self.cipmode or 0 not in self.links:
+                self.respond([(0.002, "\r\nERROR\r\n")])
+            else:
+                self.respond([(0.002, ok + "\r\n>")])
+                self.transparent = True
+        elif command == "AT+RST":
+            self.links.clear()
+            self.respond([(0.002, ok), (0.2, "\r\nready\r\n")])
+        elif command.startswith("AT+CWJAP="):
+            if '"wrong"' in command:
+                self.respond([(0.3, "+CWJAP:1\r\n\r\nFAIL\r\n")])
+            else:
+                self.respond([(0.3, "WIFI CONNECTED\r\n"), (0.1, "WIFI GOT IP\r\n"), (0.01, ok)])
+        elif command == "AT+CWQAP":
+            self.links.clear()
+            self.respond([(0.01, ok), (0.01, "WIFI DISCONNECT\r\n")])
+        elif command == "AT+CIFSR":
+            self.respond([(0.005, '+CIFSR:STAIP,"192.168.4.2"\r\n'
+                                  '+CIFSR:STAMAC,"de:ad:be:ef:00:01"\r\n' + ok)])
+        elif command == "AT+CIPSTATUS":
+            lines = "".join('+CIPSTATUS:%d,"TCP","10.0.0.1",8080,%d,0\r\n' % (link, 4000 + link)
+                            for link in sorted(self.links))
+            self.respond([(0.005, "STATUS:%d\r\n" % (3 if self.links else 2) + lines + ok)])
+        elif m:
+            link = int(m.group(1) or 0)
+            prefix = "%d," % link if self.mux else ""
+            if link in self.links:
+                self.respond([(0.01, "ALREADY CONNECTED\r\n\r\nERROR\r\n")])
+            else:
+                self.links.add(link)
+                self.respond([(0.05, prefix + "CONNECT\r\n" + ok)])
+        elif re.fullmatch(r"AT\+CIPSEND=(\d,)?\d+", command):
+            args = [int(v) for v in command.split("=")[1].split(",")]
+            link, length = (args[0], args[1]) if len(args) == 2 else (0, args[0])
+            if link not in self.links or not 0 < length <= 2048:
+                self.respond([(0.002, "link is not valid\r\n\r\nERROR\r\n")])
+            else:
+                self.respond([(0.002, ok + "> ")])
+                self.payload = (link, length)
+                self.busy_until = float("inf")
+        elif (m := re.fullmatch(r"AT\+CIPCLOSE=(\d)", command)):
+            link = int(m.group(1))
+            self.links.discard(link)
+            self.respond([(0.01, "%d,CLOSED\r\n" % link + ok)])
+        elif command == "AT+TESTHANG":
+            pass
+        else:
+            self.respond([(0.002, "\r\nERROR\r\n")])
+
+    def sent(self, link, data):
+        """AT+CIPSEND data complete: confirm it, then the echo comes back."""
+        self.respond([(0.001, "\r\nRecv %d bytes\r\n" % len(data)), (0.01, "\r\nSEND OK\r\n")])
+        for at in range(0, len(data), MAX_IPD):
+            part = data[at:at + MAX_IPD]
+            header = "\r\n+IPD,%d,%d" % (link, len(part)) if self.mux else \
+                "\r\n+IPD,%d" % len(part)
+            header += ",10.0.0.1,8080:" if self.dinfo else ":"
+            self.emit(0.02, header.encode() + part)
+
+    def receive(self, data):
+        now = time.monotonic()
+        if self.transparent:
+            self.packet += data
+            self.packet_at = now
+            while len(self.packet) >= PACKET_MAX:
+                self.emit(0.0, self.packet[:PACKET_MAX])
+                self.packet = self.packet[PACKET_MAX:]
+            return
+        if now < self.deaf_until:
+            return
+        self.pending += data
+        while self.pending:
+            if self.payload:
+                link, length = self.payload
+                if len(self.pending) < length:
+                    return
+                body, self.pending = self.pending[:length], self.pending[length:]
+                self.payload = None
+                self.sent(link, body)
+                continue
+            if b"\n" not in self.pending:
+                return
+            raw, self.pending = self.pending.split(b"\n", 1)
+            command = raw.rstrip(b"\r").decode("latin-1")
+            if not command:
+                continue
+            # Echo and "busy p..." come out at once, ahead of pending results
+            if self.echo:
+                os.write(self.fd, (command + "\r\n").encode())
+            if self.busy_mode and time.monotonic() < self.busy_until:
+                os.write(self.fd, b"busy p...\r\n")
+            else:
+                self.commands.append(command)
+
+    def run_queue(self):
+        while self.commands and time.monotonic() >= self.busy_until and not self.payload:
+            self.execute(self.commands.pop(0))
+            if self.transparent:
+                break
+
+    def send_packet(self):
+        """Transparent mode: the gathered bytes go on after a quiet gap."""
+        now = time.monotonic()
+        if not self.packet or now - self.packet_at < PACKET_GAP:
+            return
+        if self.packet == b"+++":
+            self.transparent = False
+            self.deaf_until = self.packet_at + ESCAPE_DEAF
+            self.busy_until = now
+        else:
+            self.emit(0.0, self.packet)
+        self.packet = b""
+
+    def flush(self):
+        now = time.monotonic()
+        while self.events and self.events[0][0] <= now:
+            self.out += self.events.pop(0)[1]
+        if not self.out:
+            return
+        if not self.split:
+            os.write(self.fd, self.out)
+            self.out = b""
+            return
+        # One piece per pass, so input is still read as it arrives
+        n = self.rng.randint(1, 40)
+        os.write(self.fd, self.out[:n])
+        self.out = self.out[n:]
+
+    def next_timeout(self):
+        if self.out:
+            return self.rng.random() * 0.0001
+        times = [t for t, _ in self.events]
+        if self.packet:
+            times.append(self.packet_at + PACKET_GAP)
+        if self.commands and self.busy_until != float("inf"):
+            times.append(self.busy_until)
+        return max(0.0, min(times) - time.monotonic()) if times else 0.05
+
+    def serve(self, child=None):
+        while child is None or child.poll() is None:
+            readable, _, _ = select.select([self.fd], [], [], min(self.next_timeout(), 0.05))
+            if readable:
+                try:
+                    self.receive(os.read(self.fd, 4096))
+                except OSError:
+                    break
+            self.run_queue()
+            self.send_packet()
+            self.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--busy", action="store_true", help="reject commands while executing")
+    parser.add_argument("--split", action="store_true", help="send output in random pieces")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("command", nargs=argparse.REMAINDER, help="-- program to run")
+    args = parser.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    path = os.ttyname(slave)
+    modem = FakeEsp(master, args.busy, args.split, random.Random(args.seed))
+
+    command = [c for c in args.command if c != "--"]
+    if not command:
+        print(path, flush=True)
+        try:
+            modem.serve()
+        except KeyboardInterrupt:
+            pass
+        return 0
+
+    child = subprocess.Popen(command + [path])
+    modem.serve(child)
+    return child.wait()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""Check the FFT benchmark (Src/fft_bench.c) against a reference.
+
+The firmware prints "@fft-begin <max_size> <rate_hz> <window>",
+"@fft-signal <seed> <dc> <noise_shift> (<coef> <first>)...", "@fft-bands"
+with the band edges in Hz, a CSV header, one "@fft <record>" per format,
+radix and size, and "@fft-end". This script rebuilds the signal, repeats
+the fixed-point transforms step for step (halving adds, truncating
+twiddle products, the same tables as Tools/fft_tables.py) and compares
+their checksums exactly. Features of every record are compared with a
+double-precision transform of the same windowed block, within a tolerance
+that is looser for Q15. The load/fft/power/features columns are cycles;
+the table also shows the FFT time at 16 MHz and at 180 MHz. The exit
+status is 1 on any mismatch.
+
+Usage:
+    fft_ref.py /dev/ttyACM0 --trigger fftbench
+    fft_ref.py capture.txt
+    make -C Sim fft
+"""
+
+import argparse
+import cmath
+import csv
+import io
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fft_tables  # noqa: E402
+
+PREFIX = "@fft"
+COLUMNS = ["format", "radix", "size", "load", "fft", "power", "features", "checksum",
+           "rms", "peak_hz", "peak_amplitude", "bands"]
+CLOCKS_MHZ = (16, 180)
+
+HANN, HAMMING = 1, 2
+
+# Relative tolerance of the features, and of the band energies against the
+# total; peak frequency in bins
+TOLERANCE = {"q15": (3e-3, 1e-3, 0.02), "q31": (1e-4, 1e-5, 0.002), "f32": (1e-4, 1e-5, 0.002)}
+
+
+def parse(lines):
+    report = {"records": []}
+    header = COLUMNS
+    started = ended = False
+
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            fields = [int(v) for v in line.split()[1:4]]
+            report["max_size"], report["rate"], report["window"] = fields
+            started = True
+        elif line.startswith("-signal"):
+            fields = [int(v) for v in line.split()[1:]]
+            report["seed"], report["dc"], report["noise_shift"] = fields[:3]
+            report["tones"] = list(zip(fields[3::2], fields[4::2]))
+        elif line.startswith("-bands"):
+            report["edges"] = [float(v) for v in line.split()[1:]]
+        elif line.startswith("-header"):
+            header = line.split(None, 1)[1].split(",")
+        elif line.startswith("-end"):
+            ended = True
+            break
+        elif line.startswith(" ") and started:
+            values = next(csv.reader([line.strip()]))
+            report["records"].append(dict(zip(header, values)))
+
+    if not started:
+        raise ValueError("no report found")
+    if not ended:
+        raise ValueError("report ended after %d records" % len(report["records"]))
+    return report
+
+
+def read_input(path, baud, trigger):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+def s32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def sat(v, bits):
+    hi = (1 << (bits - 1)) - 1
+    return max(-hi - 1, min(hi, v))
+
+
+def fnv1a(values, size):
+    h = 0x811C9DC5
+    for v in values:
+        for b in (v & ((1 << (8 * size)) - 1)).to_bytes(size, "little"):
+            h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+# ---- Signal, window and load, as in Src/fft_bench.c and Src/fft.c ----
+
+def make_signal(report):
+    seed = report["seed"]
+    y1 = [first for _, first in report["tones"]]
+    y2 = [0] * len(y1)
+    out = []
+    for _ in range(report["max_size"]):
+        v = report["dc"]
+        for t, (coef, _) in enumerate(report["tones"]):
+            v += y2[t] >> 15
+            y2[t], y1[t] = y1[t], ((coef * y1[t]) >> 30) - y2[t]
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        v += s32(seed) >> report["noise_shift"]
+        out.append(sat(v, 16))
+    return out
+
+
+def window(size, kind, cos_q15):
+    stride = len(cos_q15) * 4 // 3 // size
+    out = []
+    for i in range(size):
+        c = cos_q15[min(i, size - i) * stride][0]
+        if kind == HANN:
+            w = (32768 - c) >> 1
+        elif kind == HAMMING:
+            w = 17695 - ((15073 * c) >> 15)
+        else:
+            w = 32768
+        out.append(min(w, 32767) if kind else w)
+    return out
+
+
+def load_fixed(samples, win, bits):
+    size = len(win)
+    mean = (sum(samples) + size // 2) >> (size.bit_length() - 1)
+    return [[(sat(s - mean, bits) * w) >> 15, 0] for s, w in zip(samples, win)]
+
+
+# ---- Fixed-point transforms, as in Src/fft.c ----
+
+def mul(d, w, bits):
+    shift = bits - 1
+    dr, di = d
+    c, s = w
+    return [(dr * c + di * s) >> shift, (di * c - dr * s) >> shift]
+
+
+def radix2(x, length, stride, tw, bits):
+    half = length // 2
+    for j in range(half):
+        for g in range(j, len(x), length):
+            a, b = x[g], x[g + half]
+            x[g] = [(a[0] + b[0]) >> 1, (a[1] + b[1]) >> 1]
+            d = [(a[0] - b[0]) >> 1, (a[1] - b[1]) >> 1]
+            x[g + half] = d if j == 0 else mul(d, tw[j * stride], bits)
+
+
+def radix4(x, length, stride, tw, bits):
+    q = length // 4
+    for j in range(q):
+        for g in range(j, len(x), length):
+            a, b, c, d = x[g], x[g + q], x[g + 2 * q], x[g + 3 * q]
+            t0 = [(a[0] + c[0]) >> 1, (a[1] + c[1]) >> 1]
+            t1 = [(a[0] - c[0]) >> 1, (a[1] - c[1]) >> 1]
+            t2 = [(b[0] + d[0]) >> 1, (b[1] + d[1]) >> 1]
+            t3 = [(b[0] - d[0]) >> 1, (b[1] - d[1]) >> 1]
+            y1 = [(t1[0] + t3[1]) >> 1, (t1[1] - t3[0]) >> 1]
+            y2 = [(t0[0] - t2[0]) >> 1, (t0[1] - t2[1]) >> 1]
+            y3 = [(t1[0] - t3[1]) >> 1, (t1[1] + t3[0]) >> 1]
+            x[g] = [(t0[0] + t2[0]) >> 1, (t0[1] + t2[1]) >> 1]
+            if j == 0:
+                x[g + q], x[g + 2 * q], x[g + 3 * q] = y2, y1, y3
+            else:
+                x[g + q] = mul(y2, tw[2 * j * stride], bits)
+                x[g + 2 * q] = mul(y1, tw[j * stride], bits)
+                x[g + 3 * q] = mul(y3, tw[3 * j * stride], bits)
+
+
+def fft_fixed(x, radix, max_size, tw, bits):
+    size = len(x)
+    log2 = size.bit_length() - 1
+    length, stride = size, max_size // size
+    if radix == 2 or log2 & 1:
+        radix2(x, length, stride, tw, bits)
+        length, stride = length // 2, stride * 2
+    while length >= radix:
+        if radix == 2:
+            radix2(x, length, stride, tw, bits)
+        else:
+            radix4(x, length, stride, tw, bits)
+        length, stride = length // radix, stride * radix
+    rev = [int(format(i, "0%db" % log2)[::-1], 2) for i in range(size)]
+    return [x[rev[i]] for i in range(size)]
+
+
+# ---- Features in double precision, as Fft_GetFeatures ----
+
+def dft(x):
+    size = len(x)
+    if size == 1:
+        return list(x)
+    even, odd = dft(x[0::2]), dft(x[1::2])
+    out = [0j] * size
+    for k in range(size // 2):
+        t = cmath.exp(-2j * math.pi * k / size) * odd[k]
+        out[k], out[k + size // 2] = even[k] + t, even[k] - t
+    return out
+
+
+def features(samples, win, rate, edges):
+    size = len(win)
+    values = [s / 32768.0 for s in samples]
+    mean = sum(values) / size
+    spectrum = dft([(v - mean) * w / 32768.0 for v, w in zip(values, win)])
+    last = size // 2
+    power = [abs(spectrum[k] / size) ** 2 * (1 if k in (0, last) else 2) for k in range(last + 1)]
+    coherent = sum(win) / (32768.0 * size)
+    power_gain = sum(w * w for w in win) / (32768.0 * 32768.0 * size)
+    bin_hz = rate / size
+
+    peak = max(range(1, last + 1), key=lambda k: power[k])
+    offset = 0.0
+    if 1 < peak < last:
+        a, b, c = (math.sqrt(power[k]) for k in (peak - 1, peak, peak + 1))
+        if a - 2 * b + c < 0:
+            offset = 0.5 * (a - c) / (a - 2 * b + c)
+    bands = []
+    for lo, hi in zip(edges, edges[1:]):
+        bands.append(sum(p for k, p in enumerate(power) if lo <= k * bin_hz < hi) / power_gain)
+    return {"rms": math.sqrt(sum(power[1:]) / power_gain),
+            "peak_hz": (peak + offset) * bin_hz,
+            "peak_amplitude": math.sqrt(2 * power[peak]) / coherent,
+            "bands": bands, "bin_hz": bin_hz}
+
+
+# ---- Comparison ----
+
+class Reference:
+    def __init__(self, report):
+        self.report = report
+        self.signal = make_signal(report)
+        self.cos_q15 = fft_tables.twiddles(report["max_size"], 16)
+        self.tw = {"q15": self.cos_q15, "q31": fft_tables.twiddles(report["max_size"], 32)}
+        self.cache = {}
+
+    def window(self, size):
+        return window(size, self.report["window"], self.cos_q15)
+
+    def checksum(self, fmt, radix, size):
+        bits = 16 if fmt == "q15" else 32
+        samples = self.signal[:size]
+        if fmt == "q31":
+            samples = [s * 65536 for s in samples]
+        x = load_fixed(samples, self.window(size), bits)
+        out = fft_fixed(x, radix, self.report["max_size"], self.tw[fmt], bits)
+        return fnv1a([v for pair in out for v in pair], bits // 8)
+
+    def features(self, size):
+        if size not in self.cache:
+            self.cache[size] = features(self.signal[:size], self.window(size), self.report["rate"],
+                                        self.report["edges"])
+        return self.cache[size]
+
+
+def close(measured, expected, rel, floor=0.0):
+    return abs(measured - expected) <= rel * abs(expected) + floor
+
+
+def check_record(ref, r):
+    fmt, radix, size = r["format"], int(r["radix"]), int(r["size"])
+    if fmt not in TOLERANCE or radix not in (2, 4):
+        return ["unknown format or radix"]
+    rel, band_floor, bins = TOLERANCE[fmt]
+    problems = []
+
+    if fmt != "f32":
+        expected = ref.checksum(fmt, radix, size)
+        if int(r["checksum"], 16) != expected:
+            problems.append("checksum %s, expected %08x" % (r["checksum"], expected))
+
+    f = ref.features(size)
+    if not close(float(r["rms"]), f["rms"], rel):
+        problems.append("rms %s, expected %.6f" % (r["rms"], f["rms"]))
+    if not close(float(r["peak_hz"]), f["peak_hz"], 0.0, bins * f["bin_hz"]):
+        problems.append("peak %s Hz, expected %.3f" % (r["peak_hz"], f["peak_hz"]))
+    if not close(float(r["peak_amplitude"]), f["peak_amplitude"], rel):
+        problems.append("amplitude %s, expected %.6f" % (r["peak_amplitude"], f["peak_amplitude"]))
+    total = f["rms"] ** 2
+    for i, (m, e) in enumerate(zip(r["bands"].split(";"), f["bands"])):
+        if not close(float(m), e, rel, band_floor * total):
+            problems.append("band %d %s, expected %.9f" % (i, m, e))
+    return problems
+
+
+def check(report, out):
+    """Print one line per record, return the number of mismatches."""
+    ref = Reference(report)
+    failures = 0
+
+    out.write("window %d, %d Hz sampling, bands %s Hz\n" %
+              (report["window"], report["rate"], " ".join("%g" % e for e in report["edges"])))
+    out.write("%-4s %5s %5s %9s %9s %9s %9s %9s %10s %10s  %s\n" %
+              ("fmt", "radix", "size", "load", "fft", "power", "features", "us@16MHz",
+               "us@180MHz", "peak Hz", "result"))
+    for r in report["records"]:
+        problems = check_record(ref, r)
+        failures += bool(problems)
+        fft = int(r["fft"])
+        out.write("%-4s %5s %5s %9s %9s %9s %9s %9.1f %10.1f %10s  %s\n" %
+                  (r["format"], r["radix"], r["size"], r["load"], r["fft"], r["power"],
+                   r["features"], fft / CLOCKS_MHZ[0], fft / CLOCKS_MHZ[1], r["peak_hz"],
+                   "; ".join(problems) or "ok"))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command to send first, e.g. fftbench")
+    args = parser.parse_args()
+
+    try:
+        report = parse(read_input(args.input, args.baud, args.trigger))
+    except (OSError, ValueError) as e:
+        sys.exit("fft_ref: %s" % e)
+
+    failures = check(report, sys.stdout)
+    if failures:
+        print("%d mismatch%s" % (failures, "es" if failures > 1 else ""))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Generate Src/fft_tables.c, the FFT twiddle and bit-reversal tables.
+
+The twiddles are W^k = cos(2 pi k / N) - j sin(2 pi k / N) for the largest
+size N = FFT_MAX_SIZE, stored as (cos, sin) pairs, k = 0 .. 3N/4 - 1;
+smaller transforms step through them. Fixed-point values are rounded to
+nearest and clamped to the positive maximum. Tools/fft_ref.py imports the
+same functions, so its reference transform uses identical values.
+
+Usage:
+    fft_tables.py > Src/fft_tables.c
+    fft_tables.py --size 1024 -o Src/fft_tables.c
+"""
+
+import argparse
+import math
+import struct
+import sys
+
+MAX_SIZE = 1024
+
+
+def twiddle_count(size):
+    return 3 * size // 4
+
+
+def quantize(value, bits):
+    scale = 1 << (bits - 1)
+    return min(scale - 1, int(math.floor(value * scale + 0.5)))
+
+
+def twiddles(size, bits):
+    """(cos, sin) pairs; bits 16 or 32 for Q15/Q31, 0 for float32."""
+    table = []
+    for k in range(twiddle_count(size)):
+        angle = 2.0 * math.pi * k / size
+        c, s = math.cos(angle), math.sin(angle)
+        if bits:
+            table.append((quantize(c, bits), quantize(s, bits)))
+        else:
+            table.append(tuple(struct.unpack("<f", struct.pack("<f", v))[0] for v in (c, s)))
+    return table
+
+
+def bit_reverse(size):
+    bits = size.bit_length() - 1
+    return [int(format(i, "0%db" % bits)[::-1], 2) for i in range(size)]
+
+
+def rows(values, per_row, fmt):
+    out = []
+    for i in range(0, len(values), per_row):
+        out.append("    " + ", ".join(fmt % v for v in values[i:i + per_row]) + ",")
+    return "\n".join(out)
+
+
+def float_literal(v):
+    text = "%.9g" % v
+    if "." not in text and "e" not in text:
+        text += ".0"
+    return text + "f"
+
+
+def generate(size):
+    flat = lambda table: [v for pair in table for v in pair]  # noqa: E731
+    q15 = flat(twiddles(size, 16))
+    q31 = flat(twiddles(size, 32))
+    f32 = [float_literal(v) for v in flat(twiddles(size, 0))]
+
+    return "\n".join([
+        "/* @fft_tables.c - Generated by Tools/fft_tables.py, do not edit */",
+        '#include "fft.h"',
+        "",
+        "#if FFT_MAX_SIZE != %d" % size,
+        "#error \"regenerate with Tools/fft_tables.py --size FFT_MAX_SIZE\"",
+        "#endif",
+        "",
+        "const int16_t fft_twiddle_q15[2 * FFT_TWIDDLES] = {",
+        rows(q15, 8, "%d"),
+        "};",
+        "",
+        "const int32_t fft_twiddle_q31[2 * FFT_TWIDDLES] = {",
+        rows(q31, 4, "%d"),
+        "};",
+        "",
+        "const float fft_twiddle_f32[2 * FFT_TWIDDLES] = {",
+        rows(f32, 4, "%s"),
+        "};",
+        "",
+        "const uint16_t fft_bit_reverse[FFT_MAX_SIZE] = {",
+        rows(bit_reverse(size), 12, "%d"),
+        "};",
+        "",
+    ])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--size", type=int, default=MAX_SIZE, help="FFT_MAX_SIZE, a power of 2")
+    parser.add_argument("-o", "--output", help="write here instead of stdout")
+    args = parser.parse_args()
+
+    if args.size < 16 or args.size & (args.size - 1):
+        sys.exit("fft_tables: size must be a power of 2, 16 or more")
+    text = generate(args.size)
+    if args.output:
+        with open(args.output, "w", newline="\n") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
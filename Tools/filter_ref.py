@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Check the filter benchmark (Src/filter_bench.c) against a reference.
+
+The firmware prints "@filt-begin <block> <seed> <taps> <decimation>
+<stages> <post_shift>", "@filt-biquad" with the Q14 section coefficients,
+a CSV header, one "@filt <record>" per kernel and format, and "@filt-end".
+This script rebuilds the same input and coefficients, runs every kernel
+in Python, and compares: fixed-point outputs by their FNV-1a checksum,
+which must match exactly, and float outputs by mean and mean square,
+within a tolerance (the target fuses multiply-adds and sums in a different
+order). The exit status is 1 on any mismatch.
+
+Usage:
+    filter_ref.py /dev/ttyACM0 --trigger filtbench
+    filter_ref.py capture.txt
+    make -C Sim filter
+"""
+
+import argparse
+import csv
+import io
+import os
+import struct
+import sys
+
+PREFIX = "@filt"
+COLUMNS = ["kernel", "format", "outputs", "cycles", "checksum", "mean", "power"]
+
+REL_TOLERANCE = 1e-4
+ABS_TOLERANCE = 2e-6
+
+
+def parse(lines):
+    report = {"records": []}
+    header = COLUMNS
+    started = ended = False
+
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            fields = [int(v) for v in line.split()[1:7]]
+            (report["block"], report["seed"], report["taps"], report["decimation"],
+             report["stages"], report["post_shift"]) = fields
+            started = True
+        elif line.startswith("-biquad"):
+            report["biquad"] = [int(v) for v in line.split()[1:]]
+        elif line.startswith("-header"):
+            header = line.split(None, 1)[1].split(",")
+        elif line.startswith("-end"):
+            ended = True
+            break
+        elif line.startswith(" ") and started:
+            values = next(csv.reader([line.strip()]))
+            report["records"].append(dict(zip(header, values)))
+
+    if not started:
+        raise ValueError("no report found")
+    if not ended:
+        raise ValueError("report ended after %d records" % len(report["records"]))
+    return report
+
+
+def read_input(path, baud, trigger):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+# ---- Fixed-point helpers, as in Src/filter.c ----
+
+def s32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def sat(v, bits):
+    hi = (1 << (bits - 1)) - 1
+    return max(-hi - 1, min(hi, v))
+
+
+def f32(v):
+    """Round to float32, like the target's coefficient table."""
+    return struct.unpack("<f", struct.pack("<f", v))[0]
+
+
+def fnv1a(values, size):
+    h = 0x811C9DC5
+    for v in values:
+        for b in (v & ((1 << (8 * size)) - 1)).to_bytes(size, "little"):
+            h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+# ---- Test signal and coefficients, as in Src/filter_bench.c ----
+
+def make_input(block, seed):
+    q31, q15 = [], []
+    for _ in range(block):
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        q31.append(s32(seed) >> 1)
+        q15.append(q31[-1] >> 16)
+    return {"q15": q15, "q31": q31, "f32": [v / 32768.0 for v in q15]}
+
+
+def make_fir(taps):
+    weights = [(k + 1) * (taps - k) for k in range(taps)]
+    total = sum(weights)
+    return {"q15": [w * 32767 // total for w in weights],
+            "q31": [w * 0x7FFFFFFF // total for w in weights],
+            "f32": [f32(w / total) for w in weights]}
+
+
+def make_biquad(q14):
+    return {"q15": q14, "q31": [c * 65536 for c in q14], "f32": [c / 16384.0 for c in q14]}
+
+
+# ---- Kernels ----
+
+def fir(x, coeffs, decimation, fmt):
+    taps = len(coeffs)
+    history = [0] * (taps - 1) + list(x)
+    out = []
+    for i in range(decimation - 1, len(x), decimation):
+        acc = sum(c * v for c, v in zip(coeffs, history[i:i + taps]))
+        if fmt == "q15":
+            out.append(sat(acc >> 15, 16))
+        elif fmt == "q31":
+            out.append(sat(acc >> 31, 32))
+        else:
+            out.append(acc)
+    return out
+
+
+def biquad(x, coeffs, stages, post_shift, fmt):
+    bits = 16 if fmt == "q15" else 32
+    shift = bits - 1 - post_shift
+    for s in range(stages):
+        b0, b1, b2, a1, a2 = coeffs[5 * s:5 * s + 5]
+        x1 = x2 = y1 = y2 = 0
+        y = []
+        for x0 in x:
+            acc = b0 * x0 + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2
+            y0 = acc if fmt == "f32" else sat(acc >> shift, bits)
+            x2, x1, y2, y1 = x1, x0, y1, y0
+            y.append(y0)
+        x = y
+    return x
+
+
+def reference(report):
+    signal = make_input(report["block"], report["seed"])
+    taps = make_fir(report["taps"])
+    sections = make_biquad(report["biquad"])
+    results = {}
+    for fmt in ("q15", "q31", "f32"):
+        results[("fir", fmt)] = fir(signal[fmt], taps[fmt], 1, fmt)
+        results[("decim", fmt)] = fir(signal[fmt], taps[fmt], report["decimation"], fmt)
+        results[("biquad", fmt)] = biquad(signal[fmt], sections[fmt], report["stages"],
+                                          report["post_shift"], fmt)
+    return results
+
+
+def close(measured, expected):
+    return abs(measured - expected) <= ABS_TOLERANCE + REL_TOLERANCE * abs(expected)
+
+
+def check(report, out):
+    """Print one line per record, return the number of mismatches."""
+    results = reference(report)
+    failures = 0
+
+    out.write("block %d, seed %d, %d taps, decimation %d, %d biquad stages (post shift %d)\n" %
+              (report["block"], report["seed"], report["taps"], report["decimation"],
+               report["stages"], report["post_shift"]))
+    out.write("%-7s %-6s %7s %12s  %s\n" % ("kernel", "format", "outputs", "cycles/in", "result"))
+    for r in report["records"]:
+        expected = results.get((r["kernel"], r["format"]))
+        if expected is None:
+            out.write("%-7s %-6s unknown kernel\n" % (r["kernel"], r["format"]))
+            failures += 1
+            continue
+
+        problems = []
+        if int(r["outputs"]) != len(expected):
+            problems.append("%s outputs, expected %d" % (r["outputs"], len(expected)))
+        elif r["format"] == "f32":
+            mean = sum(expected) / len(expected)
+            power = sum(v * v for v in expected) / len(expected)
+            if not close(float(r["mean"]), mean):
+                problems.append("mean %s, expected %.7f" % (r["mean"], mean))
+            if not close(float(r["power"]), power):
+                problems.append("power %s, expected %.7f" % (r["power"], power))
+        else:
+            checksum = fnv1a(expected, 2 if r["format"] == "q15" else 4)
+            if int(r["checksum"], 16) != checksum:
+                problems.append("checksum %s, expected %08x" % (r["checksum"], checksum))
+
+        failures += bool(problems)
+        out.write("%-7s %-6s %7s %12s  %s\n" % (r["kernel"], r["format"], r["outputs"],
+                                               r["cycles"], "; ".join(problems) or "ok"))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command to send first, e.g. filtbench")
+    args = parser.parse_args()
+
+    try:
+        report = parse(read_input(args.input, args.baud, args.trigger))
+    except (OSError, ValueError) as e:
+        sys.exit("filter_ref: %s" % e)
+
+    failures = check(report, sys.stdout)
+    if failures:
+        print("%d mismatch%s" % (failures, "es" if failures > 1 else ""))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Summarize and compare interrupt latency reports (Inc/latency.h).
+
+The firmware prints "@lat" lines: "@lat-begin <samples> <loopback>
+<rx_delay> <build>", a CSV header, one "@lat <record>" per event, load and
+stage, each followed by "@lat-hist <event>,<load>,<stage> bin:count ...",
+"@lat-skip" for combinations that cannot be measured, and "@lat-end".
+All values are CPU cycles (16 MHz). Save a run with -o and pass it as
+--baseline when testing the next build; the exit status is 1 if p50 or p99
+got worse by more than the tolerance.
+
+Usage:
+    latency_report.py /dev/ttyACM0 --trigger latency -o build42.json
+    latency_report.py capture.txt --hist
+    latency_report.py /dev/ttyACM0 --trigger latency --baseline build42.json
+"""
+
+import argparse
+import csv
+import io
+import json
+import os
+import sys
+
+PREFIX = "@lat"
+COLUMNS = ["event", "load", "stage", "samples", "missed", "min", "p50", "p90", "p99",
+           "p99_9", "max", "mean"]
+KEY = ("event", "load", "stage")
+COMPARED = ("p50", "p99")
+
+SUB_BITS = 4
+BINS = 336
+CPU_HZ = 16e6
+
+
+def bin_range(b):
+    """Smallest and largest cycle count in a firmware histogram bin."""
+    if b < (2 << SUB_BITS):
+        return b, b
+    shift = (b >> SUB_BITS) - 1
+    lower = ((1 << SUB_BITS) + (b & ((1 << SUB_BITS) - 1))) << shift
+    if b >= BINS - 1:
+        return lower, float("inf")
+    return lower, lower + (1 << shift) - 1
+
+
+def parse(lines):
+    report = {"build": None, "samples": None, "loopback": None, "rx_delay": None,
+              "records": [], "skipped": []}
+    header = COLUMNS
+    records = {}
+    started = ended = False
+
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            fields = line.split(None, 4)
+            report["samples"] = int(fields[1])
+            report["loopback"] = fields[2] == "1"
+            report["rx_delay"] = int(fields[3])
+            report["build"] = fields[4] if len(fields) > 4 else ""
+            started = True
+        elif line.startswith("-header"):
+            header = line.split(None, 1)[1].split(",")
+        elif line.startswith("-hist"):
+            fields = line.split()
+            key = tuple(fields[1].split(","))
+            hist = {}
+            for item in fields[2:]:
+                b, count = item.split(":")
+                hist[int(b)] = int(count)
+            if key in records:
+                records[key]["hist"] = hist
+        elif line.startswith("-skip"):
+            report["skipped"].append(line.split()[1])
+        elif line.startswith("-end"):
+            ended = True
+        elif line.startswith(" ") and started:
+            values = next(csv.reader([line.strip()]))
+            record = dict(zip(header, values))
+            for k in COLUMNS[3:]:
+                record[k] = int(record[k])
+            record["hist"] = {}
+            records[tuple(record[k] for k in KEY)] = record
+            report["records"].append(record)
+
+    if not started:
+        raise ValueError("no report found")
+    if not ended:
+        raise ValueError("report ended after %d records" % len(report["records"]))
+    return report
+
+
+def read_input(path, baud, trigger):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+def read_until_done(stream):
+    """Stop at @lat-end on a live port instead of waiting for EOF."""
+    for line in stream:
+        yield line
+        if PREFIX + "-end" in line:
+            return
+
+
+def load(path):
+    if path.endswith(".json"):
+        with open(path) as f:
+            report = json.load(f)
+        for r in report["records"]:
+            r["hist"] = {int(b): c for b, c in r["hist"].items()}
+        return report
+    with open(path, encoding="latin-1", newline="") as f:
+        return parse(f)
+
+
+def print_table(report, out):
+    out.write("build %s, %d samples per case, UART loopback %s (RX delay %d cycles)\n" %
+              (report["build"], report["samples"], "yes" if report["loopback"] else "no",
+               report["rx_delay"]))
+    out.write("%-8s %-8s %-7s %7s %6s %6s %6s %6s %6s %7s %7s %6s\n" %
+              ("event", "load", "stage", "samples", "missed", "min", "p50", "p90", "p99",
+               "p99.9", "max", "mean"))
+    for r in report["records"]:
+        out.write("%-8s %-8s %-7s %7d %6d %6d %6d %6d %6d %7d %7d %6d\n" %
+                  tuple(r[k] for k in COLUMNS))
+    for s in report["skipped"]:
+        out.write("skipped: %s\n" % s)
+    out.write("(cycles at %.0f MHz)\n" % (CPU_HZ / 1e6))
+
+
+def print_hist(record, out, width=50):
+    """Bars over the occupied bins, merged into about 20 rows."""
+    hist = record["hist"]
+    if not hist:
+        return
+    out.write("\n%s / %s / %s\n" % (record["event"], record["load"], record["stage"]))
+
+    bins = sorted(hist)
+    step = max(1, -(-(bins[-1] - bins[0] + 1) // 20))
+    rows = []
+    for first in range(bins[0], bins[-1] + 1, step):
+        count = sum(hist.get(b, 0) for b in range(first, first + step))
+        lo = bin_range(first)[0]
+        hi = bin_range(min(first + step - 1, BINS - 1))[1]
+        rows.append((lo, hi, count))
+
+    peak = max(c for _, _, c in rows)
+    for lo, hi, count in rows:
+        bar = "#" * int(round(width * count / peak)) if count else ""
+        label = ("%d" % lo) if lo == hi else ("%d-%s" % (lo, "inf" if hi == float("inf") else hi))
+        out.write("%14s %7d %s\n" % (label, count, bar))
+
+
+def write(report, out, fmt):
+    if fmt == "json":
+        data = dict(report)
+        data["records"] = [dict(r, hist={str(b): c for b, c in r["hist"].items()})
+                           for r in report["records"]]
+        json.dump(data, out, indent=1)
+        out.write("\n")
+        return
+    writer = csv.DictWriter(out, fieldnames=COLUMNS, extrasaction="ignore", lineterminator="\n")
+    writer.writeheader()
+    for r in report["records"]:
+        writer.writerow(r)
+
+
+def compare(report, baseline, tolerance, slack, out):
+    """Print the change of every compared percentile, return the regressions."""
+    base = {tuple(r[k] for k in KEY): r for r in baseline["records"]}
+    problems = []
+
+    out.write("\nagainst %s:\n" % baseline["build"])
+    for r in report["records"]:
+        key = tuple(r[k] for k in KEY)
+        b = base.get(key)
+        if b is None:
+            continue
+        changes = []
+        for col in COMPARED:
+            old, new = b[col], r[col]
+            changes.append("%s %d -> %d" % (col, old, new))
+            if new > old * (1 + tolerance / 100.0) + slack:
+                problems.append("%s: %s %d cycles, baseline %d" % ("/".join(key), col, new, old))
+        if r["missed"] > b["missed"]:
+            problems.append("%s: %d events missed, baseline %d" % ("/".join(key), r["missed"],
+                                                                  b["missed"]))
+        out.write("  %-26s %s\n" % ("/".join(key), ", ".join(changes)))
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial device, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command sent to a serial device to start the run ('latency')")
+    parser.add_argument("--hist", action="store_true", help="draw the histograms")
+    parser.add_argument("--format", choices=("csv", "json"),
+                        help="format for -o (default: from the extension)")
+    parser.add_argument("-o", "--output", help="save the report, JSON keeps the histograms")
+    parser.add_argument("--baseline", help="earlier report (saved JSON or capture) to compare")
+    parser.add_argument("--tolerance", type=float, default=10.0,
+                        help="allowed increase in percent (default 10)")
+    parser.add_argument("--slack", type=int, default=8,
+                        help="allowed increase in cycles on top of the tolerance (default 8)")
+    args = parser.parse_args()
+
+    try:
+        report = parse(read_until_done(read_input(args.input, args.baud, args.trigger)))
+    except KeyboardInterrupt:
+        return 1
+    except ValueError as e:
+        sys.stderr.write("latency_report: %s\n" % e)
+        return 1
+
+    print_table(report, sys.stdout)
+    if args.hist:
+        for r in report["records"]:
+            print_hist(r, sys.stdout)
+
+    if args.output:
+        fmt = args.format or ("csv" if args.output.endswith(".csv") else "json")
+        with open(args.output, "w", newline="") as out:
+            write(report, out, fmt)
+
+    if args.baseline:
+        problems = compare(report, load(args.baseline), args.tolerance, args.slack, sys.stdout)
+        for p in problems:
+            sys.stderr.write("regression: %s\n" % p)
+        return 1 if problems else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Compress and decompress the LZ stream of Src/lz.c on the host.
+
+Decompression takes the target's uplink stream (a capture file, a serial
+port or stdin); --check compares the result with the original and reports
+the ratio. Compression writes the same format for inbound data such as
+configuration blobs, which the target decompresses with Lz_Decode. The
+compressor is greedy like the target's but looks at the last position of
+each 3-byte string rather than a hash table, so its output is valid
+rather than byte-identical. The exit status is 1 on a format error or a
+--check mismatch.
+
+Usage:
+    lz_codec.py -d uplink.lz -o uplink.txt
+    lz_codec.py -d uplink.lz --check telemetry.txt
+    lz_codec.py config.json -o config.lz --window 10
+"""
+
+import argparse
+import os
+import sys
+
+MAGIC = 0x5A
+MIN_WINDOW_BITS = 8
+MAX_WINDOW_BITS = 12
+MIN_MATCH = 3
+MAX_MATCH = MIN_MATCH + 7 + 255
+MAX_LITERALS = 128
+
+
+class FormatError(Exception):
+    pass
+
+
+def decompress(data):
+    if len(data) < 2 or data[0] != MAGIC:
+        raise FormatError("no stream header")
+    bits = data[1]
+    if not MIN_WINDOW_BITS <= bits <= MAX_WINDOW_BITS:
+        raise FormatError("window bits %d" % bits)
+    window = 1 << bits
+    out = bytearray()
+    p = 2
+    while p < len(data):
+        token = data[p]
+        p += 1
+        if token < 0x80:
+            n = token + 1
+            if p + n > len(data):
+                raise FormatError("literals run past the end at offset %d" % (p - 1))
+            out += data[p:p + n]
+            p += n
+            continue
+        code = (token >> 4) & 7
+        if p + (2 if code == 7 else 1) > len(data):
+            raise FormatError("match cut off at offset %d" % (p - 1))
+        offset = ((token & 0x0F) << 8 | data[p]) + 1
+        p += 1
+        length = code + MIN_MATCH
+        if code == 7:
+            length += data[p]
+            p += 1
+        if offset > window or offset > len(out):
+            raise FormatError("offset %d at output %d, window %d" % (offset, len(out), window))
+        start = len(out) - offset
+        for i in range(length):
+            out.append(out[start + i])
+    return bytes(out), bits
+
+
+def compress(data, bits):
+    window = 1 << bits
+    out = bytearray([MAGIC, bits])
+    last = {}
+    literal_start = pos = 0
+
+    def literals(end):
+        for at in range(literal_start, end, MAX_LITERALS):
+            n = min(MAX_LITERALS, end - at)
+            out.append(n - 1)
+            out.extend(data[at:at + n])
+
+    while pos < len(data):
+        key = data[pos:pos + MIN_MATCH]
+        length = 0
+        if len(key) == MIN_MATCH:
+            candidate = last.get(key)
+            if candidate is not None and pos - candidate <= window:
+                limit = min(MAX_MATCH, len(data) - pos)
+                while length < limit and data[candidate + length] == data[pos + length]:
+                    length += 1
+            last[key] = pos
+        if length < MIN_MATCH:
+            pos += 1
+            continue
+        literals(pos)
+        offset, code = pos - candidate - 1, length - MIN_MATCH
+        out.append(0x80 | min(code, 7) << 4 | offset >> 8)
+        out.append(offset & 0xFF)
+        if code >= 7:
+            out.append(code - 7)
+        for i in range(1, length):
+            if pos + i + MIN_MATCH <= len(data):
+                last[data[pos + i:pos + i + MIN_MATCH]] = pos + i
+        pos += length
+        literal_start = pos
+    literals(len(data))
+    return bytes(out)
+
+
+def read_input(path, baud):
+    if path == "-":
+        return sys.stdin.buffer.read()
+    with open(path, "rb", buffering=0) as stream:
+        if os.isatty(stream.fileno()):
+            import termios
+            import tty
+            tty.setraw(stream.fileno())
+            attrs = termios.tcgetattr(stream.fileno())
+            attrs[4] = attrs[5] = getattr(termios, "B%d" % baud)
+            termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+            chunks = []
+            try:
+                while True:
+                    chunks.append(stream.read(4096))
+            except KeyboardInterrupt:
+                pass
+            return b"".join(chunks)
+        return stream.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="file, serial port (until Ctrl-C), or - for stdin")
+    parser.add_argument("-d", "--decompress", action="store_true")
+    parser.add_argument("-o", "--output", help="output file, default stdout")
+    parser.add_argument("--window", type=int, default=10, help="window bits, %d to %d" %
+                        (MIN_WINDOW_BITS, MAX_WINDOW_BITS))
+    parser.add_argument("--check", metavar="ORIGINAL", help="file the stream must decompress to")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    try:
+        data = read_input(args.input, args.baud)
+    except OSError as e:
+        sys.exit("lz_codec: %s" % e)
+
+    if args.decompress:
+        try:
+            result, bits = decompress(data)
+        except FormatError as e:
+            sys.exit("lz_codec: %s: %s" % (args.input, e))
+    else:
+        if not MIN_WINDOW_BITS <= args.window <= MAX_WINDOW_BITS:
+            parser.error("--window must be %d to %d" % (MIN_WINDOW_BITS, MAX_WINDOW_BITS))
+        result, bits = compress(data, args.window), args.window
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(result)
+    elif not args.check:
+        sys.stdout.buffer.write(result)
+
+    if args.check:
+        with open(args.check, "rb") as f:
+            expected = f.read()
+        packed = data if args.decompress else result
+        same = decompress(packed)[0] == expected
+        print("%s: %d bytes -> %d with a %d-byte window, ratio %.2f" %
+              (os.path.basename(args.check), len(expected), len(packed), 1 << bits,
+               len(expected) / max(len(packed), 1)))
+        print("  %s" % ("decompressed stream matches" if same else "decompressed stream DIFFERS"))
+        sys.exit(0 if same else 1)
+
+
+if __name__ == "__main__":
+    main()
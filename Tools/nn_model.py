@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Generate Src/nn_model.c, the example int8 model for Src/nn.c.
+
+The model classifies a 64 x 3 accelerometer window into 5 scores:
+
+    conv1d 8 x 5, ReLU -> maxpool 2 -> conv1d 16 x 3 / 2, ReLU
+    -> avgpool 2 -> dense 32, ReLU -> dense 5 -> sigmoid table
+
+It stands in for a trained network: the weights and biases come from an
+LCG, and each layer's multiplier is calibrated on the benchmark input
+(Tools/nn_ref.py make_input, seed INPUT_SEED) so that its outputs use the
+int8 range, as post-training quantization would. The shapes and the
+arithmetic are those of a real model; its scores mean nothing.
+
+Blob layout (see Inc/nn.h): the 20-byte header, one 28-byte record per
+layer, then per layer its int8 weights and, 4-byte aligned, its int32
+biases with -input zero * row sum folded in. The sigmoid table reads the
+last dense output as logits in steps of 1/16.
+
+Usage:
+    nn_model.py > Src/nn_model.c
+    nn_model.py -o Src/nn_model.c
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import nn_ref  # noqa: E402
+
+INPUT = (64, 3)
+INPUT_ZERO = 0
+WEIGHT_SEED = 1234
+
+LOGIT_STEP = 1.0 / 16
+
+# (type, units, kernel, stride, relu)
+LAYERS = [
+    ("conv1d", 8, 5, 1, True),
+    ("maxpool", 0, 2, 2, False),
+    ("conv1d", 16, 3, 2, True),
+    ("avgpool", 0, 2, 2, False),
+    ("dense", 32, 0, 1, True),
+    ("dense", 5, 0, 1, False),
+    ("lut", 0, 0, 0, False),
+]
+
+# Calibration targets: the largest output of a ReLU layer above its zero
+# point, and the largest magnitude of a linear one
+RELU_RANGE = 250
+LINEAR_RANGE = 100
+
+
+class Lcg:
+    def __init__(self, seed):
+        self.seed = seed
+
+    def next(self):
+        self.seed = nn_ref.lcg(self.seed)
+        return nn_ref.s32(self.seed)
+
+    def weight(self):
+        return max(-127, self.next() >> 24)
+
+
+def quantize_multiplier(scale):
+    """Q31 multiplier in [2^30, 2^31) and shift, scale = m / 2^(31 + shift)."""
+    shift = 0
+    while scale * (1 << (31 + shift)) < (1 << 30):
+        shift += 1
+    if shift > 31:
+        raise ValueError("scale %g too small" % scale)
+    return min((1 << 31) - 1, int(math.floor(scale * (1 << (31 + shift)) + 0.5))), shift
+
+
+def build_layers():
+    """Layer dicts as Tools/nn_ref.py parses them, calibrated in order."""
+    rng = Lcg(WEIGHT_SEED)
+    x = nn_ref.make_input(nn_ref.INPUT_SEED, *INPUT)
+    shape, zero = INPUT, INPUT_ZERO
+    layers = []
+
+    for kind, units, kernel, stride, relu in LAYERS:
+        length, channels = shape
+        layer = {"type": kind, "units": units, "kernel": kernel, "stride": stride,
+                 "in": shape, "out_zero": zero, "act_min": -128, "act_max": 127,
+                 "multiplier": 0, "shift": 0}
+        if kind == "dense":
+            layer["kernel"], layer["out"] = length, (1, units)
+        elif kind == "lut":
+            layer["out"] = shape
+        else:
+            layer["out"] = ((length - kernel) // stride + 1,
+                            units if kind == "conv1d" else channels)
+
+        if kind in ("dense", "conv1d"):
+            window = layer["kernel"] * channels
+            weights = [rng.weight() for _ in range(units * window)]
+            bias = []
+            for o in range(units):
+                row_sum = sum(weights[o * window:(o + 1) * window])
+                bias.append((rng.next() >> 18) - zero * row_sum)
+            layer["weights"], layer["bias"] = weights, bias
+
+            acc = nn_ref.accumulate(layer, x)
+            if relu:
+                zero = -128
+                scale = RELU_RANGE / max(max(acc), 1)
+                layer["act_min"] = zero
+            else:
+                zero = 0
+                scale = LINEAR_RANGE / max(max(abs(a) for a in acc), 1)
+            layer["out_zero"] = zero
+            layer["multiplier"], layer["shift"] = quantize_multiplier(scale)
+        elif kind == "lut":
+            table = []
+            for q in range(-128, 128):
+                y = 1.0 / (1.0 + math.exp(-(q - zero) * LOGIT_STEP))
+                table.append(max(-128, min(127, int(math.floor(y * 256 + 0.5)) - 128)))
+            zero = -128
+            layer["table"], layer["out_zero"] = table, zero
+
+        x = nn_ref.run_layer(layer, x)
+        shape = layer["out"]
+        layers.append(layer)
+    return layers
+
+
+def pack(layers):
+    data = bytearray()
+    records = []
+    base = nn_ref.HEADER.size + len(layers) * nn_ref.LAYER.size
+
+    def append(blob):
+        while len(data) % 4:
+            data.append(0)
+        offset = base + len(data)
+        data.extend(blob)
+        return offset
+
+    for layer in layers:
+        weights = bias = 0
+        if "weights" in layer:
+            weights = append(bytes(w & 0xFF for w in layer["weights"]))
+            bias = append(struct.pack("<%di" % len(layer["bias"]), *layer["bias"]))
+        elif "table" in layer:
+            weights = append(bytes(v & 0xFF for v in layer["table"]))
+        kernel = 0 if layer["type"] == "dense" else layer["kernel"]
+        records.append(nn_ref.LAYER.pack(
+            nn_ref.TYPES.index(layer["type"]), layer["out_zero"], layer["act_min"],
+            layer["act_max"], layer["units"], kernel, layer["stride"], 0, layer["multiplier"],
+            layer["shift"], weights, bias))
+    while len(data) % 4:
+        data.append(0)
+
+    size = base + len(data)
+    header = nn_ref.HEADER.pack(nn_ref.MAGIC, nn_ref.VERSION, len(layers), INPUT[0], INPUT[1],
+                                INPUT_ZERO, size)
+    return header + b"".join(records) + bytes(data)
+
+
+def describe(layer):
+    kind = layer["type"]
+    if kind == "conv1d":
+        text = "conv1d %d x %d / %d" % (layer["units"], layer["kernel"], layer["stride"])
+    elif kind == "dense":
+        text = "dense %d" % layer["units"]
+    elif kind == "lut":
+        text = "sigmoid table"
+    else:
+        text = "%s %d / %d" % (kind, layer["kernel"], layer["stride"])
+    if layer["act_min"] == layer["out_zero"] and kind in ("conv1d", "dense"):
+        text += ", ReLU"
+    return "%-24s -> %d x %d" % (text, layer["out"][0], layer["out"][1])
+
+
+def generate():
+    layers = build_layers()
+    blob = pack(layers)
+    rows = []
+    for i in range(0, len(blob), 16):
+        rows.append("    " + ", ".join("0x%02X" % b for b in blob[i:i + 16]) + ",")
+
+    return "\n".join([
+        "/* @nn_model.c - Generated by Tools/nn_model.py, do not edit */",
+        '#include "nn.h"',
+        "",
+        "/* Input %d x %d, zero point %d" % (INPUT[0], INPUT[1], INPUT_ZERO),
+    ] + [" * %s" % describe(layer) for layer in layers] + [
+        " * %d bytes, FNV-1a %08x */" % (len(blob), nn_ref.fnv1a(blob)),
+        "const uint8_t nn_model_accel[] __attribute__((aligned(4))) = {",
+    ] + rows + [
+        "};",
+        "",
+        "const uint32_t nn_model_accel_size = sizeof(nn_model_accel);",
+        "",
+    ])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("-o", "--output", help="write here instead of stdout")
+    args = parser.parse_args()
+
+    text = generate()
+    if args.output:
+        with open(args.output, "w", newline="\n") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
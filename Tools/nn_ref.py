@@ -0,0 +1,327 @@
+#!/usr/bin/env python3
+"""Check the int8 inference benchmark (Src/nn_bench.c) against a reference.
+
+The firmware prints "@nn-begin <model_bytes> <model_fnv> <arena_used>
+<seed>", a CSV header, one "@nn <record>" per layer with its cycles and
+an FNV-1a checksum of its output, "@nn-total <cycles>" for a whole
+Nn_Invoke, "@nn-output" with the final values, and "@nn-end". This script
+reads the same model blob from Src/nn_model.c (and checks its size and
+checksum), parses it independently of Src/nn.c, rebuilds the input from
+the seed and runs every layer in integer arithmetic: exact dot products,
+the same rounding requantization, clamps, pooling and tables. Every layer
+output must match bit for bit. The table shows MACs, cycles per MAC and
+the time at 16 MHz and at 180 MHz. The exit status is 1 on any mismatch.
+
+Tools/nn_model.py imports the kernels here to calibrate the model it
+generates.
+
+Usage:
+    nn_ref.py /dev/ttyACM0 --trigger nnbench
+    nn_ref.py capture.txt
+    make -C Sim nn
+"""
+
+import argparse
+import csv
+import io
+import os
+import re
+import struct
+import sys
+
+PREFIX = "@nn"
+COLUMNS = ["layer", "type", "length", "channels", "cycles", "checksum"]
+CLOCKS_MHZ = (16, 180)
+
+MODEL_C = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Src", "nn_model.c")
+MAGIC = 0x31304E4E
+VERSION = 1
+HEADER = struct.Struct("<IHHHHb3xI")
+LAYER = struct.Struct("<BbbbHHHHiIII")
+TYPES = ["dense", "conv1d", "maxpool", "avgpool", "lut"]
+LUT_SIZE = 256
+
+INPUT_SEED = 4242
+
+
+def parse(lines):
+    report = {"records": []}
+    header = COLUMNS
+    started = ended = False
+
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            fields = line.split()[1:5]
+            report["bytes"], report["arena"], report["seed"] = (int(fields[0]), int(fields[2]),
+                                                                int(fields[3]))
+            report["fnv"] = int(fields[1], 16)
+            started = True
+        elif line.startswith("-error"):
+            raise ValueError("firmware could not load the model: %s" % line.split(None, 1)[1])
+        elif line.startswith("-header"):
+            header = line.split(None, 1)[1].split(",")
+        elif line.startswith("-total"):
+            report["total"] = int(line.split()[1])
+        elif line.startswith("-output"):
+            report["output"] = [int(v) for v in line.split()[1:]]
+        elif line.startswith("-end"):
+            ended = True
+            break
+        elif line.startswith(" ") and started:
+            values = next(csv.reader([line.strip()]))
+            report["records"].append(dict(zip(header, values)))
+
+    if not started:
+        raise ValueError("no report found")
+    if not ended:
+        raise ValueError("report ended after %d records" % len(report["records"]))
+    return report
+
+
+def read_input(path, baud, trigger):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+def s32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def s8(v):
+    v &= 0xFF
+    return v - 256 if v & 0x80 else v
+
+
+def fnv1a(data):
+    h = 0x811C9DC5
+    for b in data:
+        h = ((h ^ (b & 0xFF)) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def lcg(seed):
+    return (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+
+
+# ---- Input, as Nnb_MakeInput in Src/nn_bench.c ----
+
+def make_input(seed, length, channels):
+    """Triangle waves of a different period per axis plus LCG noise."""
+    out = []
+    for i in range(length):
+        for c in range(channels):
+            phase = (i * (c + 2)) & 31
+            v = (phase if phase < 16 else 32 - phase) * 6 - 48
+            seed = lcg(seed)
+            out.append(v + (s32(seed) >> 27))
+    return out
+
+
+# ---- Model blob ----
+
+def load_blob(path=MODEL_C):
+    """The bytes of nn_model_accel[] in a generated C file."""
+    with open(path) as f:
+        text = f.read()
+    body = re.search(r"nn_model_accel\[\][^{]*\{([^}]*)\}", text)
+    if not body:
+        raise ValueError("%s: no nn_model_accel array" % path)
+    return bytes(int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]+", body.group(1)))
+
+
+def parse_model(blob):
+    """Header and layers with their shapes, weights, biases and tables."""
+    magic, version, count, length, channels, zero, size = HEADER.unpack_from(blob, 0)
+    if magic != MAGIC or version != VERSION or size != len(blob):
+        raise ValueError("bad model header")
+    model = {"input": (length, channels), "input_zero": zero, "layers": []}
+    for i in range(count):
+        (kind, out_zero, act_min, act_max, units, kernel, stride, _, multiplier, shift, weights,
+         bias) = LAYER.unpack_from(blob, HEADER.size + i * LAYER.size)
+        if kind >= len(TYPES):
+            raise ValueError("layer %d: unknown type %d" % (i, kind))
+        layer = {"type": TYPES[kind], "out_zero": out_zero, "act_min": act_min,
+                 "act_max": act_max, "units": units, "kernel": kernel, "stride": stride,
+                 "multiplier": multiplier, "shift": shift,
+                 "in": (length, channels)}
+        if layer["type"] == "dense":
+            layer["kernel"], layer["stride"] = length, 1
+        if layer["type"] in ("dense", "conv1d"):
+            window = layer["kernel"] * channels
+            layer["weights"] = [s8(b) for b in blob[weights:weights + units * window]]
+            layer["bias"] = list(struct.unpack_from("<%di" % units, blob, bias))
+        elif layer["type"] == "lut":
+            layer["table"] = [s8(b) for b in blob[weights:weights + LUT_SIZE]]
+        if layer["type"] == "dense":
+            out = (1, units)
+        elif layer["type"] == "lut":
+            out = (length, channels)
+        else:
+            out = ((length - kernel) // stride + 1,
+                   units if layer["type"] == "conv1d" else channels)
+        layer["out"] = out
+        length, channels = out
+        model["layers"].append(layer)
+    return model
+
+
+def arena_plan(model):
+    """Largest input plus output of a layer, each rounded up to words."""
+    words = lambda shape: (shape[0] * shape[1] + 3) & ~3  # noqa: E731
+    return max(words(l["in"]) + words(l["out"]) for l in model["layers"])
+
+
+# ---- Kernels, as Src/nn.c ----
+
+def accumulate(layer, x):
+    """Bias plus dot product for every output position and unit."""
+    length, channels = layer["in"]
+    window = layer["kernel"] * channels
+    w, bias = layer["weights"], layer["bias"]
+    acc = []
+    for p in range(layer["out"][0]):
+        xs = x[p * layer["stride"] * channels:][:window]
+        for o in range(layer["units"]):
+            row = w[o * window:(o + 1) * window]
+            acc.append(bias[o] + sum(a * b for a, b in zip(row, xs)))
+    return acc
+
+
+def requantize(acc, layer):
+    shift = 31 + layer["shift"]
+    value = ((acc * layer["multiplier"] + (1 << (shift - 1))) >> shift) + layer["out_zero"]
+    return max(layer["act_min"], min(layer["act_max"], value))
+
+
+def pool(layer, x, average):
+    length, channels = layer["in"]
+    kernel, stride = layer["kernel"], layer["stride"]
+    out = []
+    for p in range(layer["out"][0]):
+        for c in range(channels):
+            values = [x[(p * stride + k) * channels + c] for k in range(kernel)]
+            if not average:
+                out.append(max(values))
+                continue
+            total = sum(values)
+            rounded = abs(total) + kernel // 2
+            out.append(rounded // kernel if total >= 0 else -(rounded // kernel))
+    return out
+
+
+def run_layer(layer, x):
+    kind = layer["type"]
+    if kind in ("dense", "conv1d"):
+        return [requantize(a, layer) for a in accumulate(layer, x)]
+    if kind in ("maxpool", "avgpool"):
+        return pool(layer, x, kind == "avgpool")
+    return [layer["table"][v + 128] for v in x]
+
+
+def run(model, x):
+    """Output of every layer."""
+    outputs = []
+    for layer in model["layers"]:
+        x = run_layer(layer, x)
+        outputs.append(x)
+    return outputs
+
+
+# ---- Comparison ----
+
+def check(report, blob, out):
+    """Print one line per layer, return the number of mismatches."""
+    failures = 0
+    if report["bytes"] != len(blob) or report["fnv"] != fnv1a(blob):
+        out.write("model differs: %d bytes %08x on the target, %d bytes %08x here\n" %
+                  (report["bytes"], report["fnv"], len(blob), fnv1a(blob)))
+        return 1
+
+    model = parse_model(blob)
+    outputs = run(model, make_input(report["seed"], *model["input"]))
+    arena = arena_plan(model)
+    out.write("model %d bytes, %d layers, arena %d bytes%s\n" %
+              (len(blob), len(model["layers"]), report["arena"],
+               "" if arena == report["arena"] else " (expected %d)" % arena))
+    failures += arena != report["arena"]
+    if len(report["records"]) != len(model["layers"]):
+        out.write("%d records for %d layers\n" % (len(report["records"]), len(model["layers"])))
+        return failures + 1
+
+    out.write("%5s %-8s %9s %8s %9s %10s %9s %10s  %s\n" %
+              ("layer", "type", "shape", "macs", "cycles", "cycles/mac", "us@16MHz", "us@180MHz",
+               "result"))
+    macs_total = 0
+    for r, layer, values in zip(report["records"], model["layers"], outputs):
+        problems = []
+        shape = (int(r["length"]), int(r["channels"]))
+        if r["type"] != layer["type"] or shape != layer["out"]:
+            problems.append("%s %dx%d, expected %s %dx%d" %
+                            ((r["type"],) + shape + (layer["type"],) + layer["out"]))
+        expected = fnv1a(values)
+        if int(r["checksum"], 16) != expected:
+            problems.append("checksum %s, expected %08x" % (r["checksum"], expected))
+        failures += bool(problems)
+
+        macs = len(values) * layer["kernel"] * layer["in"][1] if layer.get("weights") else 0
+        macs_total += macs
+        cycles = int(r["cycles"])
+        out.write("%5s %-8s %9s %8d %9d %10s %9.1f %10.1f  %s\n" %
+                  (r["layer"], layer["type"], "%dx%d" % layer["out"], macs, cycles,
+                   "%.2f" % (cycles / macs) if macs else "-", cycles / CLOCKS_MHZ[0],
+                   cycles / CLOCKS_MHZ[1], "; ".join(problems) or "ok"))
+
+    total = report.get("total", 0)
+    output_ok = report.get("output") == outputs[-1]
+    failures += not output_ok
+    out.write("%5s %-8s %9s %8d %9d %10.2f %9.1f %10.1f  %s\n" %
+              ("all", "invoke", "", macs_total, total, total / max(macs_total, 1),
+               total / CLOCKS_MHZ[0], total / CLOCKS_MHZ[1],
+               "ok" if output_ok else "output %s, expected %s" % (report.get("output"),
+                                                                  outputs[-1])))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial port, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command to send first, e.g. nnbench")
+    parser.add_argument("--model", default=MODEL_C, help="generated model source")
+    args = parser.parse_args()
+
+    try:
+        blob = load_blob(args.model)
+        report = parse(read_input(args.input, args.baud, args.trigger))
+    except (OSError, ValueError) as e:
+        sys.exit("nn_ref: %s" % e)
+
+    failures = check(report, blob, sys.stdout)
+    if failures:
+        print("%d mismatch%s" % (failures, "es" if failures > 1 else ""))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Symbolize PC-sampling profiles (Inc/profiler.h) into a flat profile or flame graph.
+
+The firmware prints "@prof-begin <rate> <samples> <lost> <slots>", one
+"@prof <pc> <lr> <count>" line per distinct (PC, LR) pair and
+"@prof-end <lines>". PCs are resolved against the function symbols of the
+ELF. The stacked LR names the caller only while the sampled function has
+not called anything itself; when it points back into the same function,
+or is an EXC_RETURN value, the caller is left out.
+
+Usage:
+    profile_report.py Debug/embeddedC_gpio1234.elf /dev/ttyACM0 --trigger prof --duration 10
+    profile_report.py Debug/embeddedC_gpio1234.elf capture.txt --top 30
+    profile_report.py app.elf capture.txt --folded out.folded --svg flame.svg
+"""
+
+import argparse
+import html
+import io
+import os
+import sys
+import time
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from elf32 import Elf32  # noqa: E402
+
+PREFIX = "@prof"
+
+
+def parse(lines):
+    """Return (info, samples) with samples a list of (pc, lr, count)."""
+    info = None
+    samples = []
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            rate, total, lost, used = (int(v) for v in line.split()[1:5])
+            info = {"rate": rate, "samples": total, "lost": lost, "slots": used}
+            samples = []
+        elif line.startswith("-end"):
+            if info is None:
+                continue
+            expected = int(line.split()[1])
+            if expected != len(samples):
+                raise ValueError("dump ended with %d of %d lines" % (len(samples), expected))
+            return info, samples
+        elif line.startswith(" ") and info is not None:
+            pc, lr, count = line.split()
+            samples.append((int(pc, 16), int(lr, 16), int(count)))
+
+    raise ValueError("no complete profile found")
+
+
+def read_input(path, baud, trigger, duration):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+        termios.tcflush(stream.fileno(), termios.TCIFLUSH)
+    if trigger:
+        # The bare command toggles: start, let the workload run, stop and dump
+        stream.write((trigger + "\r").encode())
+        time.sleep(duration)
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+class Symbolizer:
+    def __init__(self, elf):
+        self.elf = elf
+        self.cache = {}
+
+    def function(self, addr):
+        addr &= ~1
+        if addr not in self.cache:
+            name = self.elf.symbolize(addr)
+            self.cache[addr] = name if name is not None else "0x%08x" % addr
+        return self.cache[addr]
+
+    def stack(self, pc, lr):
+        """Frames from outermost to the sampled function."""
+        leaf = self.function(pc)
+        if (lr & 0xFFFFFF00) == 0xFFFFFF00:
+            return [leaf]
+        caller = self.function(lr)
+        if caller == leaf:
+            return [leaf]
+        return [caller, leaf]
+
+
+def flat(samples, sym):
+    """Self samples per function, and samples with the function anywhere
+    on the (at most two frame) stack."""
+    self_counts = {}
+    total_counts = {}
+    for pc, lr, count in samples:
+        frames = sym.stack(pc, lr)
+        self_counts[frames[-1]] = self_counts.get(frames[-1], 0) + count
+        for name in set(frames):
+            total_counts[name] = total_counts.get(name, 0) + count
+    return self_counts, total_counts
+
+
+def print_flat(info, samples, sym, top, out):
+    self_counts, total_counts = flat(samples, sym)
+    total = sum(c for _, _, c in samples) or 1
+    out.write("%d samples at %d Hz (%.2f s), %d lost to a full table, %d slots\n" %
+              (info["samples"], info["rate"], info["samples"] / float(info["rate"]),
+               info["lost"], info["slots"]))
+    out.write("%8s %7s %7s %8s %7s  %s\n" % ("self", "self%", "cum%", "total", "total%", "function"))
+    cumulative = 0
+    order = sorted(total_counts, key=lambda n: (-self_counts.get(n, 0), -total_counts[n], n))
+    for name in order[:top]:
+        count = self_counts.get(name, 0)
+        cumulative += count
+        out.write("%8d %6.2f%% %6.2f%% %8d %6.2f%%  %s\n" %
+                  (count, 100.0 * count / total, 100.0 * cumulative / total,
+                   total_counts[name], 100.0 * total_counts[name] / total, name))
+
+
+def folded(samples, sym):
+    stacks = {}
+    for pc, lr, count in samples:
+        key = ";".join(sym.stack(pc, lr))
+        stacks[key] = stacks.get(key, 0) + count
+    return stacks
+
+
+def write_svg(stacks, out, title, width=1200, row=18):
+    """Minimal flame graph: one rectangle per frame, widths by sample count."""
+    root = {"name": "all", "count": 0, "children": {}}
+    for key, count in stacks.items():
+        node = root
+        node["count"] += count
+        for frame in key.split(";"):
+            node = node["children"].setdefault(frame, {"name": frame, "count": 0, "children": {}})
+            node["count"] += count
+
+    def depth(node):
+        return 1 + max((depth(c) for c in node["children"].values()), default=0)
+
+    levels = depth(root)
+    height = (levels + 2) * row
+    scale = (width - 20) / float(root["count"] or 1)
+    rects = []
+
+    def place(node, x, level):
+        w = node["count"] * scale
+        y = height - (level + 1) * row - row
+        hue = zlib.crc32(node["name"].encode()) % 60
+        label = html.escape(node["name"])
+        tip = "%s (%d samples, %.2f%%)" % (label, node["count"],
+                                           100.0 * node["count"] / (root["count"] or 1))
+        text = label if w > 7 * len(node["name"]) else ""
+        rects.append('<g><title>%s</title><rect x="%.1f" y="%d" width="%.1f" height="%d" '
+                     'fill="hsl(%d,90%%,60%%)" stroke="white"/><text x="%.1f" y="%d">%s</text></g>' %
+                     (tip, x, y, w, row - 1, hue, x + 3, y + row - 5, text))
+        for child in sorted(node["children"].values(), key=lambda c: c["name"]):
+            place(child, x, level + 1)
+            x += child["count"] * scale
+
+    place(root, 10, 0)
+    out.write('<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+              'font-family="monospace" font-size="11">\n' % (width, height))
+    out.write('<text x="10" y="14">%s</text>\n' % html.escape(title))
+    out.write("\n".join(rects))
+    out.write("\n</svg>\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("elf", help="firmware ELF the profile was taken with")
+    parser.add_argument("input", help="serial device, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command sent to start and again to stop ('prof')")
+    parser.add_argument("--duration", type=float, default=5.0,
+                        help="seconds between the two triggers (default 5)")
+    parser.add_argument("--top", type=int, default=25, help="functions in the flat profile")
+    parser.add_argument("--folded", help="write folded stacks (flamegraph.pl, speedscope)")
+    parser.add_argument("--svg", help="write a flame graph")
+    args = parser.parse_args()
+
+    sym = Symbolizer(Elf32(args.elf))
+    try:
+        info, samples = parse(read_input(args.input, args.baud, args.trigger, args.duration))
+    except KeyboardInterrupt:
+        return 1
+    except ValueError as e:
+        sys.stderr.write("profile_report: %s\n" % e)
+        return 1
+
+    print_flat(info, samples, sym, args.top, sys.stdout)
+
+    stacks = folded(samples, sym)
+    if args.folded:
+        with open(args.folded, "w") as f:
+            for key, count in sorted(stacks.items()):
+                f.write("%s %d\n" % (key, count))
+    if args.svg:
+        with open(args.svg, "w") as f:
+            write_svg(stacks, f, "%s, %d samples at %d Hz" %
+                      (os.path.basename(args.elf), info["samples"], info["rate"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
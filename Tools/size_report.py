@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""Sum code size per group of functions in the firmware ELF.
+
+By default compares the in-tree formatter (Src/fmt.c) against the newlib
+printf machinery it replaces:
+
+    size_report.py Debug/embeddedC_gpio1234.elf
+    size_report.py Debug/embeddedC_gpio1234.elf --group dsp='^DSP_'
+"""
+
+import argparse
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from elf32 import Elf32  # noqa: E402
+
+DEFAULT_GROUPS = [
+    ("fmt", r"^FMT_(?!RunBenchmark)"),
+    ("newlib printf", r"printf|^_?_?s?v?fiprintf|^_printf_|^__sprint_r|^_svfprintf|^_dtoa_r|"
+                      r"^__[a-z]*2d$|^__mprec|^_malloc_r|^_free_r|^_sbrk_r|^__ssputs_r|^__sfputs_r"),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("elf")
+    parser.add_argument("--group", action="append", default=[], metavar="NAME=REGEX",
+                        help="report another group of functions (may repeat)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="list each function")
+    args = parser.parse_args()
+
+    groups = DEFAULT_GROUPS if not args.group else [g.split("=", 1) for g in args.group]
+    functions = Elf32(args.elf).functions()
+
+    for name, pattern in groups:
+        regex = re.compile(pattern)
+        members = [(size, fn) for (_addr, size, fn) in functions if regex.search(fn)]
+        total = sum(size for size, _fn in members)
+        print("%-16s %7d bytes  %3d functions" % (name, total, len(members)))
+        if args.verbose:
+            for size, fn in sorted(members, reverse=True):
+                print("    %7d  %s" % (size, fn))
+
+
+if __name__ == "__main__":
+    main()
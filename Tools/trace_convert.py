@@ -0,0 +1,377 @@
+#!/usr/bin/env python3
+"""Convert the event trace stream (Inc/trace.h) to Chrome/Perfetto JSON or CTF.
+
+The firmware sends COBS frames between 0x00 delimiters, interleaved with
+console text and binlog frames. Trace payloads start with 0xFE 0x00, a
+kind byte and a sequence number:
+
+    H  version, CPU Hz (u32), base timestamp (u32)
+    N  name kind (task, queue, mark, irq), id, name
+    D  varint records dropped on the device
+    E  events: type, id, varint cycle delta, varint argument
+    S  varint events in the session; recording has stopped
+
+The JSON output opens in ui.perfetto.dev or chrome://tracing. The CTF
+output is a directory (metadata + one stream) for babeltrace2 or Trace
+Compass.
+
+Usage:
+    trace_convert.py /dev/ttyACM0 --trigger "trace start" -o trace.json
+    trace_convert.py capture.bin --format ctf -o trace_ctf
+    trace_convert.py capture.bin --elf Debug/embeddedC_gpio1234.elf -o trace.json
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from elf32 import Elf32  # noqa: E402
+
+MAGIC = b"\xfe\x00"
+FRAME_MAX = 256
+
+ISR_ENTER, ISR_EXIT, TASK_SWITCH, QUEUE_SEND, QUEUE_RECV, MARK, BEGIN, END = range(1, 9)
+DROPPED = 9
+
+NAME_TASK, NAME_QUEUE, NAME_MARK, NAME_IRQ = range(4)
+EXCEPTIONS = {2: "NMI", 3: "HardFault", 4: "MemManage", 5: "BusFault", 6: "UsageFault",
+              11: "SVCall", 12: "DebugMon", 14: "PendSV", 15: "SysTick"}
+
+# Chrome trace thread IDs
+TID_TASKS, TID_IRQ, TID_MARKS = 1, 2, 3
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varint(data, pos):
+    value = shift = 0
+    while True:
+        if pos >= len(data) or shift > 28:
+            raise ValueError("truncated varint")
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value & 0xFFFFFFFF, pos
+
+
+class Trace:
+    """Events with absolute cycle counts, rebuilt from the frames."""
+
+    def __init__(self, elf=None):
+        self.elf = elf
+        self.hz = None
+        self.cycles = 0
+        self.stamp = 0          # Device timestamp of self.cycles
+        self.names = {}
+        self.events = []        # (cycles, type, id, arg)
+        self.sequence = None
+        self.lost_frames = 0
+        self.dropped = 0
+        self.stopped = False
+
+    def frame(self, payload):
+        """Handle one decoded payload; False if it is not a trace frame."""
+        if len(payload) < 4 or payload[:2] != MAGIC:
+            return False
+        kind, seq, body = chr(payload[2]), payload[3], payload[4:]
+
+        if kind == "H":
+            _version, hz, base = struct.unpack_from("<BII", body)
+            # Later sessions continue on the same time axis
+            if self.hz is not None:
+                self.cycles += (base - self.stamp) & 0xFFFFFFFF
+            self.hz, self.stamp = hz, base
+            self.sequence = seq
+            self.stopped = False
+            self.events.append((self.cycles, "start", 0, 0))
+            return True
+        if self.sequence is None:
+            # Joined mid-session, nothing to anchor the deltas to
+            return True
+
+        expected = (self.sequence + 1) & 0xFF
+        if seq != expected:
+            self.lost_frames += (seq - expected) & 0xFF
+        self.sequence = seq
+
+        if kind == "N":
+            self.names[(body[0], body[1])] = body[2:].decode("latin-1")
+        elif kind == "D":
+            count, _ = varint(body, 0)
+            self.dropped += count
+            self.events.append((self.cycles, DROPPED, 0, count))
+        elif kind == "E":
+            pos = 0
+            while pos < len(body):
+                ev_type, ev_id = body[pos], body[pos + 1]
+                delta, pos = varint(body, pos + 2)
+                arg, pos = varint(body, pos)
+                self.cycles += delta
+                self.stamp = (self.stamp + delta) & 0xFFFFFFFF
+                self.events.append((self.cycles, ev_type, ev_id, arg))
+        elif kind == "S":
+            self.stopped = True
+        return True
+
+    def run(self, stream, stop_at_end):
+        in_frame = False
+        buf = bytearray()
+        while True:
+            chunk = stream.read1(256) if hasattr(stream, "read1") else stream.read(256)
+            if not chunk:
+                return
+            for b in chunk:
+                if b != 0:
+                    if in_frame:
+                        buf.append(b)
+                        if len(buf) > FRAME_MAX:
+                            in_frame = False
+                    continue
+                if in_frame and buf:
+                    payload = cobs_decode(bytes(buf))
+                    if payload is not None:
+                        try:
+                            self.frame(payload)
+                        except (ValueError, IndexError, struct.error):
+                            pass
+                    if self.stopped and stop_at_end:
+                        return
+                in_frame = True
+                buf.clear()
+
+    def name(self, kind, ident):
+        name = self.names.get((kind, ident))
+        if name is not None:
+            return name
+        if kind == NAME_IRQ:
+            if self.elf is not None:
+                name = self.vector_name(ident)
+                if name is not None:
+                    return name
+            return EXCEPTIONS.get(ident, "IRQ%d" % (ident - 16))
+        return "%s %d" % (("task", "queue", "mark")[kind], ident)
+
+    def vector_name(self, exception):
+        section = self.elf.section(".isr_vector")
+        if section is None:
+            return None
+        word = self.elf.read(section.addr + 4 * exception, 4)
+        if word is None:
+            return None
+        return self.elf.symbolize(struct.unpack("<I", word)[0] & ~1)
+
+    def us(self, cycles):
+        return cycles * 1e6 / self.hz
+
+
+def to_chrome(trace):
+    out = [
+        {"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "STM32F429"}},
+        {"ph": "M", "pid": 1, "tid": TID_TASKS, "name": "thread_name", "args": {"name": "Tasks"}},
+        {"ph": "M", "pid": 1, "tid": TID_IRQ, "name": "thread_name", "args": {"name": "Interrupts"}},
+        {"ph": "M", "pid": 1, "tid": TID_MARKS, "name": "thread_name", "args": {"name": "Markers"}},
+    ]
+    current_task = None
+
+    for cycles, ev_type, ident, arg in trace.events:
+        ts = trace.us(cycles)
+        if ev_type == "start":
+            out.append({"ph": "i", "s": "g", "pid": 1, "tid": TID_MARKS, "ts": ts,
+                        "name": "trace start"})
+        elif ev_type == ISR_ENTER:
+            out.append({"ph": "B", "pid": 1, "tid": TID_IRQ, "ts": ts,
+                        "name": trace.name(NAME_IRQ, ident)})
+        elif ev_type == ISR_EXIT:
+            out.append({"ph": "E", "pid": 1, "tid": TID_IRQ, "ts": ts})
+        elif ev_type == TASK_SWITCH:
+            if current_task is not None:
+                out.append({"ph": "E", "pid": 1, "tid": TID_TASKS, "ts": ts})
+            out.append({"ph": "B", "pid": 1, "tid": TID_TASKS, "ts": ts,
+                        "name": trace.name(NAME_TASK, ident),
+                        "args": {"from": trace.name(NAME_TASK, arg & 0xFF)}})
+            current_task = ident
+        elif ev_type in (QUEUE_SEND, QUEUE_RECV):
+            out.append({"ph": "C", "pid": 1, "ts": ts, "name": trace.name(NAME_QUEUE, ident),
+                        "args": {"items": arg}})
+        elif ev_type == MARK:
+            out.append({"ph": "i", "s": "t", "pid": 1, "tid": TID_MARKS, "ts": ts,
+                        "name": trace.name(NAME_MARK, ident), "args": {"value": arg}})
+        elif ev_type == BEGIN:
+            out.append({"ph": "B", "pid": 1, "tid": TID_MARKS, "ts": ts,
+                        "name": trace.name(NAME_MARK, ident)})
+        elif ev_type == END:
+            out.append({"ph": "E", "pid": 1, "tid": TID_MARKS, "ts": ts})
+        elif ev_type == DROPPED:
+            out.append({"ph": "i", "s": "g", "pid": 1, "tid": TID_MARKS, "ts": ts,
+                        "name": "%d events dropped" % arg})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns",
+            "otherData": {"cpu_hz": trace.hz, "dropped": trace.dropped,
+                          "lost_frames": trace.lost_frames}}
+
+
+CTF_METADATA = """/* CTF 1.8 */
+
+typealias integer { size = 8; align = 8; signed = false; } := uint8_t;
+typealias integer { size = 16; align = 8; signed = false; } := uint16_t;
+typealias integer { size = 32; align = 8; signed = false; } := uint32_t;
+typealias integer { size = 64; align = 8; signed = false; } := uint64_t;
+
+trace {
+    major = 1;
+    minor = 8;
+    byte_order = le;
+    packet.header := struct {
+        uint32_t magic;
+    };
+};
+
+env {
+    target = "STM32F429";
+};
+
+clock {
+    name = cpu;
+    freq = %(hz)d;
+};
+
+typealias integer { size = 64; align = 8; signed = false; map = clock.cpu.value; } := cpu_cycles_t;
+
+stream {
+    packet.context := struct {
+        cpu_cycles_t timestamp_begin;
+        cpu_cycles_t timestamp_end;
+        uint64_t content_size;
+        uint64_t packet_size;
+    };
+    event.header := struct {
+        uint8_t id;
+        cpu_cycles_t timestamp;
+    };
+};
+
+event { name = "isr_enter"; id = 1; fields := struct { uint8_t irq; string name; }; };
+event { name = "isr_exit"; id = 2; fields := struct { uint8_t irq; string name; }; };
+event { name = "task_switch"; id = 3; fields := struct { uint8_t next; uint8_t prev; string next_name; string prev_name; }; };
+event { name = "queue_send"; id = 4; fields := struct { uint8_t queue; uint16_t items; string name; }; };
+event { name = "queue_recv"; id = 5; fields := struct { uint8_t queue; uint16_t items; string name; }; };
+event { name = "mark"; id = 6; fields := struct { uint8_t id; uint16_t value; string name; }; };
+event { name = "span_begin"; id = 7; fields := struct { uint8_t id; string name; }; };
+event { name = "span_end"; id = 8; fields := struct { uint8_t id; string name; }; };
+event { name = "dropped"; id = 9; fields := struct { uint32_t count; }; };
+"""
+
+
+def to_ctf(trace, directory):
+    def cstr(text):
+        return text.encode("utf-8") + b"\x00"
+
+    body = bytearray()
+    first = last = None
+    for cycles, ev_type, ident, arg in trace.events:
+        if ev_type == "start":
+            continue
+        body += struct.pack("<BQ", ev_type, cycles)
+        if ev_type in (ISR_ENTER, ISR_EXIT):
+            body += struct.pack("<B", ident) + cstr(trace.name(NAME_IRQ, ident))
+        elif ev_type == TASK_SWITCH:
+            body += struct.pack("<BB", ident, arg & 0xFF)
+            body += cstr(trace.name(NAME_TASK, ident)) + cstr(trace.name(NAME_TASK, arg & 0xFF))
+        elif ev_type in (QUEUE_SEND, QUEUE_RECV):
+            body += struct.pack("<BH", ident, arg) + cstr(trace.name(NAME_QUEUE, ident))
+        elif ev_type == MARK:
+            body += struct.pack("<BH", ident, arg) + cstr(trace.name(NAME_MARK, ident))
+        elif ev_type in (BEGIN, END):
+            body += struct.pack("<B", ident) + cstr(trace.name(NAME_MARK, ident))
+        elif ev_type == DROPPED:
+            body += struct.pack("<I", arg)
+        if first is None:
+            first = cycles
+        last = cycles
+
+    header_size = 4 + 8 * 4
+    size_bits = (header_size + len(body)) * 8
+    packet = struct.pack("<IQQQQ", 0xC1FC1FC1, first or 0, last or 0, size_bits, size_bits) + body
+
+    os.makedirs(directory, exist_ok=True)
+    with open(os.path.join(directory, "metadata"), "w") as f:
+        f.write(CTF_METADATA % {"hz": trace.hz})
+    with open(os.path.join(directory, "stream_0"), "wb") as f:
+        f.write(packet)
+
+
+def open_input(path, baud, trigger):
+    if path == "-":
+        return sys.stdin.buffer
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return stream
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial device, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command sent to a serial device first ('trace start')")
+    parser.add_argument("--elf", help="firmware ELF, names interrupts from its vector table")
+    parser.add_argument("--format", choices=("chrome", "ctf"),
+                        help="output format (default: ctf if -o has no .json extension)")
+    parser.add_argument("-o", "--output", required=True, help="JSON file or CTF directory")
+    args = parser.parse_args()
+
+    fmt = args.format or ("chrome" if args.output.endswith(".json") else "ctf")
+    trace = Trace(Elf32(args.elf) if args.elf else None)
+    stream = open_input(args.input, args.baud, args.trigger)
+    try:
+        # A live port never ends; stop at the S frame (send 't' again)
+        trace.run(stream, stop_at_end=os.isatty(stream.fileno()))
+    except KeyboardInterrupt:
+        pass
+
+    if trace.hz is None:
+        sys.stderr.write("trace_convert: no trace header found\n")
+        return 1
+
+    if fmt == "chrome":
+        with open(args.output, "w") as f:
+            json.dump(to_chrome(trace), f)
+    else:
+        to_ctf(trace, args.output)
+
+    span = trace.events[-1][0] if trace.events else 0
+    sys.stderr.write("trace_convert: %d events over %.3f ms, %d dropped on the device, "
+                     "%d frames lost\n" % (sum(1 for e in trace.events if e[1] != "start"),
+                                           trace.us(span) / 1e3, trace.dropped,
+                                           trace.lost_frames))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
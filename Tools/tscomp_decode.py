@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Decode the time-series packets of Src/tscomp.c.
+
+Reads back-to-back packets from a file, a serial port or stdin, skipping
+the zero padding between them, and writes the samples as CSV: a timestamp
+column, then one column per channel, floats for the channels in the float
+mask. Sequence gaps are reported. With --check, the samples must equal a
+trace CSV (as written by Tools/tscomp_trace.py, ":f" marking float
+columns) value for value, floats bit for bit; the summary compares the
+packet bytes with the CSV text and with 32 bits per timestamp and value.
+The exit status is 1 on a decoding error or mismatch.
+
+Usage:
+    tscomp_decode.py packets.bin -o samples.csv
+    tscomp_decode.py packets.bin --check trace.csv
+    tscomp_decode.py /dev/ttyUSB0 --baud 115200 > samples.csv
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+MAGIC = 0x54
+HEADER_SIZE = 10
+MASK32 = 0xFFFFFFFF
+
+
+class DecodeError(Exception):
+    pass
+
+
+def s32(v):
+    v &= MASK32
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def varint(data, p):
+    value = shift = 0
+    while True:
+        if p >= len(data) or shift > 28:
+            raise DecodeError("varint runs past the packet")
+        b = data[p]
+        p += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value & MASK32, p
+
+
+def decode_packet(data):
+    """(sequence, float mask, samples) of one packet; a sample is
+    (timestamp, [value words])."""
+    if len(data) < HEADER_SIZE or data[0] != MAGIC:
+        raise DecodeError("no packet header")
+    sequence = data[1]
+    used, count = struct.unpack_from("<HH", data, 2)
+    channels, mask = data[6], struct.unpack_from("<H", data, 8)[0]
+    if used < HEADER_SIZE or used > len(data) or not 1 <= channels <= 16:
+        raise DecodeError("bad header: %d bytes used, %d channels" % (used, channels))
+
+    body = data[:used]
+    p = HEADER_SIZE
+    ts = delta = 0
+    prev = [0] * channels
+    samples = []
+    for i in range(count):
+        z, p = varint(body, p)
+        if i == 0:
+            ts = z
+        else:
+            delta = (delta + unzigzag(z)) & MASK32
+            ts = (ts + delta) & MASK32
+        for c in range(channels):
+            if mask >> c & 1:
+                if p >= used:
+                    raise DecodeError("sample %d runs past the packet" % i)
+                control = body[p]
+                p += 1
+                size, trail = control & 0x0F, control >> 4
+                if control and not (1 <= size <= 4 and size + trail <= 4 and p + size <= used):
+                    raise DecodeError("bad XOR control byte %02x" % control)
+                prev[c] ^= int.from_bytes(body[p:p + size], "little") << (8 * trail)
+                p += size
+            else:
+                z, p = varint(body, p)
+                prev[c] = (prev[c] + unzigzag(z)) & MASK32
+        samples.append((ts, list(prev)))
+    if p != used:
+        raise DecodeError("%d bytes used, samples end at %d" % (used, p))
+    return sequence, mask, samples, used
+
+
+def decode_stream(data):
+    """Packets in order: dicts with sequence, mask, samples, offset, used."""
+    packets = []
+    p = 0
+    while p < len(data):
+        if data[p] == 0:
+            p += 1
+            continue
+        try:
+            sequence, mask, samples, used = decode_packet(data[p:])
+        except DecodeError as e:
+            raise DecodeError("packet at offset %d: %s" % (p, e))
+        packets.append({"sequence": sequence, "mask": mask, "samples": samples, "offset": p,
+                        "used": used})
+        p += used
+    return packets
+
+
+def value_text(word, is_float):
+    if is_float:
+        return repr(struct.unpack("<f", struct.pack("<I", word))[0])
+    return str(s32(word))
+
+
+def read_trace(path):
+    """Header names, float flags and (timestamp, [words]) rows of a trace CSV."""
+    with open(path, newline="") as f:
+        rows = list(csv.reader(f))
+    names = rows[0][1:]
+    floats = [n.endswith(":f") for n in names]
+    samples = []
+    for row in rows[1:]:
+        words = []
+        for text, is_float in zip(row[1:], floats):
+            if is_float:
+                words.append(struct.unpack("<I", struct.pack("<f", float(text)))[0])
+            else:
+                words.append(int(text) & MASK32)
+        samples.append((int(row[0]) & MASK32, words))
+    return names, floats, samples, os.path.getsize(path)
+
+
+def read_input(path, baud):
+    if path == "-":
+        return sys.stdin.buffer.read()
+    with open(path, "rb", buffering=0) as stream:
+        if os.isatty(stream.fileno()):
+            import termios
+            import tty
+            tty.setraw(stream.fileno())
+            attrs = termios.tcgetattr(stream.fileno())
+            attrs[4] = attrs[5] = getattr(termios, "B%d" % baud)
+            termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+            chunks = []
+            try:
+                while True:
+                    chunks.append(stream.read(4096))
+            except KeyboardInterrupt:
+                pass
+            return b"".join(chunks)
+        return stream.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="packet file, serial port (until Ctrl-C), or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("-o", "--output", help="CSV file, default stdout")
+    parser.add_argument("--check", metavar="TRACE", help="trace CSV the packets must reproduce")
+    args = parser.parse_args()
+
+    try:
+        data = read_input(args.input, args.baud)
+        packets = decode_stream(data)
+    except (OSError, DecodeError) as e:
+        sys.exit("tscomp_decode: %s" % e)
+
+    samples = [s for packet in packets for s in packet["samples"]]
+    mask = packets[0]["mask"] if packets else 0
+    gaps = sum((b["sequence"] - a["sequence"]) & 0xFF != 1 for a, b in zip(packets, packets[1:]))
+    if gaps:
+        sys.stderr.write("tscomp_decode: %d sequence gap%s\n" % (gaps, "s" if gaps > 1 else ""))
+
+    if not args.check:
+        out = open(args.output, "w", newline="") if args.output else sys.stdout
+        writer = csv.writer(out, lineterminator="\n")
+        channels = len(samples[0][1]) if samples else 0
+        writer.writerow(["timestamp"] + ["ch%d%s" % (c, ":f" if mask >> c & 1 else "")
+                                         for c in range(channels)])
+        for ts, words in samples:
+            writer.writerow([ts] + [value_text(w, mask >> c & 1) for c, w in enumerate(words)])
+        sys.exit(1 if gaps else 0)
+
+    try:
+        names, floats, expected, csv_bytes = read_trace(args.check)
+    except (OSError, ValueError, IndexError) as e:
+        sys.exit("tscomp_decode: %s: %s" % (args.check, e))
+    mismatch = None
+    if len(samples) != len(expected):
+        mismatch = "%d samples decoded, %d in the trace" % (len(samples), len(expected))
+    elif [bool(mask >> c & 1) for c in range(len(floats))] != floats:
+        mismatch = "float mask %04x does not match the trace columns" % mask
+    else:
+        for i, (got, want) in enumerate(zip(samples, expected)):
+            if got != want:
+                mismatch = "sample %d: %s, expected %s" % (i, got, want)
+                break
+
+    raw = len(expected) * 4 * (1 + len(names))
+    print("%s: %d samples x %d channels in %d packets of %d bytes (%d used)" %
+          (os.path.basename(args.check), len(samples), len(names), len(packets),
+           len(data) // max(len(packets), 1), sum(p["used"] for p in packets)))
+    print("  %.2f bytes/sample; ratio %.1f against the CSV, %.1f against 32-bit words" %
+          (len(data) / max(len(samples), 1), csv_bytes / max(len(data), 1),
+           raw / max(len(data), 1)))
+    print("  %s" % (mismatch or "decoded samples match the trace"))
+    sys.exit(1 if mismatch or gaps else 0)
+
+
+if __name__ == "__main__":
+    main()
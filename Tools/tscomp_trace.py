@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Write sensor traces for the host time-series compression benchmark.
+
+The repository holds no recorded traces, so these stand in for them with
+the properties that matter to the coder: sampling jitter, quantized
+readings, slow drift and noise. Any recording works in their place: a
+header row "timestamp,name,..." with ":f" after float channel names, then
+one row per sample, the timestamp a non-negative integer, integer channels
+int32, float channels anything that rounds to a float32.
+
+    accel   3 axes, 16-bit counts at 1 kHz, ms timestamps; gravity on z,
+            40 Hz and 120 Hz vibration on x and y, sensor noise, and a
+            sample taken a tick late now and then
+    env     temperature and humidity (floats, sensor resolution 0.01 C
+            and 0.1 %) and pressure in Pa, once a second in Unix seconds
+            with occasional missed readings
+    adc     2 channels, 12-bit counts at 1 kHz in us timestamps from a
+            free-running timer: an internal temperature sensor and VREFINT
+
+Usage:
+    tscomp_trace.py accel -o accel.csv
+    tscomp_trace.py env --samples 3600 --seed 7 > env.csv
+"""
+
+import argparse
+import math
+import random
+import struct
+import sys
+
+KINDS = ("accel", "env", "adc")
+DEFAULT_SAMPLES = {"accel": 20000, "env": 3600, "adc": 20000}
+
+
+def f32(value):
+    """The float32 nearest value, printed so it reads back to the same bits."""
+    return repr(struct.unpack("<f", struct.pack("<f", value))[0])
+
+
+def accel(n, rng):
+    yield ["timestamp", "ax", "ay", "az"]
+    ts = 0
+    for i in range(n):
+        t = i / 1000.0
+        late = 1 if rng.random() < 0.02 else 0
+        x = 900 * math.sin(2 * math.pi * 40 * t) + 120 * math.sin(2 * math.pi * 120 * t)
+        y = 400 * math.sin(2 * math.pi * 40 * t + 1.0)
+        z = 16384 + 60 * math.sin(2 * math.pi * 0.5 * t)
+        yield [ts + late] + [int(round(v + rng.gauss(0, 6))) for v in (x, y, z)]
+        ts += 1
+
+
+def env(n, rng):
+    yield ["timestamp", "temperature:f", "humidity:f", "pressure"]
+    ts = 1700000000
+    temp, humidity, pressure = 21.5, 45.0, 101325.0
+    for _ in range(n):
+        temp += rng.gauss(0, 0.01)
+        humidity += rng.gauss(0, 0.05)
+        pressure += rng.gauss(0, 2)
+        yield [ts, f32(round(temp, 2)), f32(round(humidity, 1)), int(round(pressure))]
+        ts += 2 if rng.random() < 0.01 else 1
+
+
+def adc(n, rng):
+    yield ["timestamp", "temp_sensor", "vrefint"]
+    ts = rng.randrange(1 << 32)
+    for i in range(n):
+        drift = 8 * math.sin(2 * math.pi * i / 20000.0)
+        sensor = 940 + drift + rng.gauss(0, 1.5)
+        vref = 1500 + rng.gauss(0, 1.0)
+        yield [ts] + [max(0, min(4095, int(round(v)))) for v in (sensor, vref)]
+        ts = (ts + 1000 + rng.choice((-1, 0, 0, 0, 1))) & 0xFFFFFFFF
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("kind", choices=KINDS)
+    parser.add_argument("--samples", type=int)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("-o", "--output", help="CSV file, default stdout")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    rows = globals()[args.kind](args.samples or DEFAULT_SAMPLES[args.kind], rng)
+    out = open(args.output, "w") if args.output else sys.stdout
+    for row in rows:
+        out.write(",".join(str(v) for v in row) + "\n")
+
+
+if __name__ == "__main__":
+    main()
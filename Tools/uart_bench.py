@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""Collect UART benchmark records (Inc/uart_bench.h) into CSV or JSON.
+
+The firmware prints "@ub" lines between the benchmark payload: a
+"@ub-begin <format> <loopback>" line, a CSV header, one "@ub <record>" per
+case and "@ub-end <count>". Several runs may follow each other, as the
+simulation does with one process per baud rate. With --baseline the results
+are compared per (mode, baud, chunk) and the exit status is 1 if throughput
+dropped or RX loss grew by more than the tolerance.
+
+Usage:
+    uart_bench.py /dev/ttyACM0 --trigger bench -o results.csv
+    make -C Sim bench
+    uart_bench.py capture.txt --format json
+    uart_bench.py capture.txt --baseline Sim/uart_bench_baseline.csv
+"""
+
+import argparse
+import csv
+import io
+import json
+import os
+import sys
+
+PREFIX = "@ub"
+COLUMNS = ["mode", "baud", "chunk", "bytes", "elapsed_us", "throughput_Bps", "line_pct",
+           "cpu_pct", "call_cycles", "calls", "rx_lost", "rx_loss_pct"]
+KEY = ("mode", "baud", "chunk")
+
+
+def convert(value):
+    if value in ("", None):
+        return None
+    if isinstance(value, (int, float)):
+        return value
+    try:
+        return int(value)
+    except ValueError:
+        pass
+    try:
+        return float(value)
+    except ValueError:
+        return value
+
+
+def parse(lines):
+    """Yield one dict per record; raises ValueError on a truncated run."""
+    fmt = None
+    header = COLUMNS
+    count = 0
+
+    for raw in lines:
+        line = raw.strip()
+        pos = line.find(PREFIX)
+        if pos < 0:
+            continue
+        line = line[pos + len(PREFIX):]
+
+        if line.startswith("-begin"):
+            if fmt is not None:
+                raise ValueError("run restarted after %d records" % count)
+            fmt = line.split()[1]
+            count = 0
+        elif line.startswith("-header"):
+            header = line.split(None, 1)[1].split(",")
+        elif line.startswith("-end"):
+            expected = int(line.split()[1])
+            if expected != count:
+                raise ValueError("run ended with %d of %d records" % (count, expected))
+            fmt = None
+        elif line.startswith(" ") and fmt is not None:
+            body = line.strip()
+            if fmt == "json":
+                record = json.loads(body)
+            else:
+                record = dict(zip(header, next(csv.reader([body]))))
+            count += 1
+            yield {k: convert(record.get(k)) for k in COLUMNS}
+
+    if fmt is not None:
+        raise ValueError("input ended inside a run after %d records" % count)
+
+
+def read_input(path, baud, trigger):
+    if path == "-":
+        return io.TextIOWrapper(sys.stdin.buffer, encoding="latin-1", newline="")
+
+    stream = open(path, "r+b" if trigger else "rb", buffering=0)
+    if os.isatty(stream.fileno()):
+        import termios
+        import tty
+        tty.setraw(stream.fileno())
+        attrs = termios.tcgetattr(stream.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(stream.fileno(), termios.TCSANOW, attrs)
+    if trigger:
+        # A shell command line, Enter runs it
+        stream.write((trigger + "\r").encode())
+    return io.TextIOWrapper(io.BufferedReader(stream), encoding="latin-1", newline="")
+
+
+def read_until_done(stream):
+    """Stop at the last @ub-end on a live port instead of waiting for EOF."""
+    depth = 0
+    for line in stream:
+        yield line
+        if PREFIX + "-begin" in line:
+            depth += 1
+        elif PREFIX + "-end" in line:
+            depth -= 1
+            if depth == 0 and stream.isatty():
+                return
+
+
+def write(records, out, fmt):
+    if fmt == "json":
+        json.dump(records, out, indent=1)
+        out.write("\n")
+        return
+    writer = csv.DictWriter(out, fieldnames=COLUMNS, lineterminator="\n")
+    writer.writeheader()
+    for r in records:
+        writer.writerow({k: "" if r[k] is None else r[k] for k in COLUMNS})
+
+
+def load(path):
+    with open(path, newline="") as f:
+        if path.endswith(".json"):
+            rows = json.load(f)
+        else:
+            rows = list(csv.DictReader(f))
+    return [{k: convert(r.get(k)) for k in COLUMNS} for r in rows]
+
+
+def compare(records, baseline, tolerance):
+    """Return regression messages: throughput or RX loss worse than tolerance percent."""
+    base = {tuple(r[k] for k in KEY): r for r in baseline}
+    problems = []
+
+    for r in records:
+        key = tuple(r[k] for k in KEY)
+        b = base.get(key)
+        if b is None:
+            continue
+        name = "%s %d baud, %d byte chunks" % key
+        if b["throughput_Bps"] and r["throughput_Bps"] < b["throughput_Bps"] * (1 - tolerance / 100.0):
+            problems.append("%s: throughput %d B/s, baseline %d B/s" %
+                            (name, r["throughput_Bps"], b["throughput_Bps"]))
+        if r["rx_loss_pct"] is not None and b["rx_loss_pct"] is not None and \
+                r["rx_loss_pct"] > b["rx_loss_pct"] + tolerance:
+            problems.append("%s: RX loss %.2f%%, baseline %.2f%%" %
+                            (name, r["rx_loss_pct"], b["rx_loss_pct"]))
+
+    missing = set(base) - {tuple(r[k] for k in KEY) for r in records}
+    for key in sorted(missing, key=str):
+        problems.append("%s %d baud, %d byte chunks: not measured" % key)
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="serial device, capture file, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--trigger", help="shell command sent to a serial device to start the benchmark ('bench')")
+    parser.add_argument("--format", choices=("csv", "json"),
+                        help="output format (default: from -o extension, else csv)")
+    parser.add_argument("-o", "--output", help="write results here instead of stdout")
+    parser.add_argument("--baseline", help="CSV or JSON results to compare against")
+    parser.add_argument("--tolerance", type=float, default=5.0,
+                        help="allowed regression in percent (default 5)")
+    args = parser.parse_args()
+
+    try:
+        records = list(parse(read_until_done(read_input(args.input, args.baud, args.trigger))))
+    except KeyboardInterrupt:
+        return 1
+    except ValueError as e:
+        sys.stderr.write("uart_bench: %s\n" % e)
+        return 1
+    if not records:
+        sys.stderr.write("uart_bench: no records found\n")
+        return 1
+
+    fmt = args.format or ("json" if args.output and args.output.endswith(".json") else "csv")
+    if args.output:
+        with open(args.output, "w", newline="") as out:
+            write(records, out, fmt)
+    elif not args.baseline:
+        write(records, sys.stdout, fmt)
+
+    if args.baseline:
+        problems = compare(records, load(args.baseline), args.tolerance)
+        for p in problems:
+            sys.stderr.write("regression: %s\n" % p)
+        sys.stderr.write("uart_bench: %d cases, %d regressions against %s\n" %
+                         (len(records), len(problems), args.baseline))
+        return 1 if problems else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())